@@ -24,6 +24,7 @@ limitations under the License.
 #include <memory>
 
 #include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/memory_placement.h"
 
 namespace tflite {
 
@@ -56,17 +57,36 @@ class Allocation {
   const Type type_;
 };
 
+// Options of MMAPAllocation.
+struct MMapOptions {
+  // Huge pages and NUMA node for the model. If either is requested, the file
+  // is read into anonymous memory placed accordingly instead of being mapped,
+  // as page cache pages can neither come from the hugetlbfs pool nor be bound
+  // to a node. This costs a copy of the file at load time and memory that is
+  // no longer shared with other processes mapping the same model.
+  MemoryPlacement placement;
+  // Maps the file with MAP_POPULATE, reading all of it and mapping its pages
+  // at load time rather than faulting them in on first use. See
+  // WeightPrefetcher to fault the weights in the order the nodes use them, or
+  // in the background while they run.
+  bool populate = false;
+};
+
 // Note that not all platforms support MMAP-based allocation.
 // Use `IsSupported()` to check.
 class MMAPAllocation : public Allocation {
  public:
   // Loads and maps the provided file to a memory region.
   MMAPAllocation(const char* filename, ErrorReporter* error_reporter);
+  MMAPAllocation(const char* filename, const MMapOptions& options,
+                 ErrorReporter* error_reporter);
 
   // Maps the provided file descriptor to a memory region.
   // Note: The provided file descriptor will be dup'ed for usage; the caller
   // retains ownership of the provided descriptor and should close accordingly.
   MMAPAllocation(int fd, ErrorReporter* error_reporter);
+  MMAPAllocation(int fd, const MMapOptions& options,
+                 ErrorReporter* error_reporter);
 
   virtual ~MMAPAllocation();
   const void* base() const override;
@@ -82,10 +102,16 @@ class MMAPAllocation : public Allocation {
   int mmap_fd_ = -1;  // mmap file descriptor
   const void* mmapped_buffer_;
   size_t buffer_size_bytes_ = 0;
+  // Holds the contents of the file instead of a mapping when placed.
+  std::unique_ptr<PlacedMemory> placed_buffer_;
 
  private:
   // Assumes ownership of the provided `owned_fd` instance.
-  MMAPAllocation(ErrorReporter* error_reporter, int owned_fd);
+  MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
+                 const MMapOptions& options);
+
+  // Reads the file into `placed_buffer_`.
+  bool ReadIntoPlacedMemory(const MemoryPlacement& placement);
 };
 
 class FileCopyAllocation : public Allocation {
@@ -18,6 +18,8 @@ limitations under the License.
 #include <fcntl.h>
 #endif
 
+#include <string.h>
+
 #include <string>
 
 #include <gtest/gtest.h>
@@ -79,6 +81,27 @@ TEST(MMAPAllocation, TestValidFileDescriptor) {
 
   close(fd);
 }
+
+TEST(MMAPAllocation, TestPlacedFileMatchesMapping) {
+  if (!MMAPAllocation::IsSupported()) {
+    return;
+  }
+
+  TestErrorReporter error_reporter;
+  MMAPAllocation mapped("tensorflow/lite/testdata/empty_model.bin",
+                        &error_reporter);
+  MMapOptions options;
+  options.placement.huge_pages = HugePageMode::kTransparent;
+  options.placement.numa_node = kCurrentNumaNode;
+  MMAPAllocation placed("tensorflow/lite/testdata/empty_model.bin", options,
+                        &error_reporter);
+  ASSERT_TRUE(mapped.valid());
+  ASSERT_TRUE(placed.valid());
+  EXPECT_GT(placed.fd(), 0);
+  ASSERT_EQ(placed.bytes(), mapped.bytes());
+  EXPECT_NE(placed.base(), mapped.base());
+  EXPECT_EQ(memcmp(placed.base(), mapped.base(), mapped.bytes()), 0);
+}
 #endif
 
 }  // namespace tflite
@@ -0,0 +1,144 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/arena_memory_pool.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace tflite {
+
+ArenaMemoryPool::ArenaMemoryPool(void* region, size_t region_size)
+    : region_(static_cast<char*>(region)), region_size_(region_size) {
+  if (region_ != nullptr && region_size_ > 0) {
+    free_blocks_[0] = region_size_;
+  }
+}
+
+void* ArenaMemoryPool::Allocate(size_t size, size_t alignment) {
+  if (size == 0) size = 1;
+  if (alignment == 0) alignment = 1;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = free_blocks_.begin(); it != free_blocks_.end(); ++it) {
+    const size_t block_offset = it->first;
+    const size_t block_size = it->second;
+    const uintptr_t address =
+        reinterpret_cast<uintptr_t>(region_) + block_offset;
+    const size_t padding = (alignment - address % alignment) % alignment;
+    if (padding > block_size || block_size - padding < size) continue;
+
+    // Keep the padding and the tail of the block free.
+    const size_t offset = block_offset + padding;
+    free_blocks_.erase(it);
+    if (padding > 0) free_blocks_[block_offset] = padding;
+    if (block_size - padding > size) {
+      free_blocks_[offset + size] = block_size - padding - size;
+    }
+    used_blocks_[offset] = size;
+    in_use_bytes_ += size;
+    high_water_mark_bytes_ = std::max(high_water_mark_bytes_, in_use_bytes_);
+    return region_ + offset;
+  }
+  return nullptr;
+}
+
+void ArenaMemoryPool::Deallocate(void* buffer) {
+  if (buffer == nullptr) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto used = used_blocks_.find(static_cast<char*>(buffer) - region_);
+  if (used == used_blocks_.end()) return;
+  size_t offset = used->first;
+  size_t size = used->second;
+  used_blocks_.erase(used);
+  in_use_bytes_ -= size;
+
+  // Merge with the free blocks on either side.
+  auto next = free_blocks_.lower_bound(offset);
+  if (next != free_blocks_.end() && offset + size == next->first) {
+    size += next->second;
+    next = free_blocks_.erase(next);
+  }
+  if (next != free_blocks_.begin()) {
+    auto previous = std::prev(next);
+    if (previous->first + previous->second == offset) {
+      previous->second += size;
+      return;
+    }
+  }
+  free_blocks_[offset] = size;
+}
+
+ArenaMemoryStats ArenaMemoryPool::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ArenaMemoryStats stats;
+  stats.capacity_bytes = region_size_;
+  stats.in_use_bytes = in_use_bytes_;
+  stats.high_water_mark_bytes = high_water_mark_bytes_;
+  for (const auto& block : free_blocks_) {
+    stats.largest_free_block_bytes =
+        std::max(stats.largest_free_block_bytes, block.second);
+  }
+  return stats;
+}
+
+PlacedArenaAllocator::PlacedArenaAllocator(const MemoryPlacement& placement,
+                                           ErrorReporter* error_reporter)
+    : placement_(placement), error_reporter_(error_reporter) {}
+
+void* PlacedArenaAllocator::Allocate(size_t size, size_t alignment) {
+  std::unique_ptr<PlacedMemory> memory(
+      new PlacedMemory(size, placement_, error_reporter_));
+  if (!memory->valid()) return nullptr;
+  // Mappings are page aligned, which covers any arena alignment in practice.
+  if (alignment > 0 &&
+      reinterpret_cast<uintptr_t>(memory->data()) % alignment != 0) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Arena alignment %zu exceeds the page alignment.",
+                         alignment);
+    return nullptr;
+  }
+  void* data = memory->data();
+  std::lock_guard<std::mutex> lock(mutex_);
+  buffers_[data] = std::move(memory);
+  return data;
+}
+
+void PlacedArenaAllocator::Deallocate(void* buffer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  buffers_.erase(buffer);
+}
+
+PageStats PlacedArenaAllocator::page_stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  PageStats total;
+  for (const auto& buffer : buffers_) {
+    PageStats stats;
+    if (!GetPageStats(buffer.first, buffer.second->size(), &stats)) continue;
+    total.mapped_bytes += stats.mapped_bytes;
+    total.resident_bytes += stats.resident_bytes;
+    total.huge_page_bytes += stats.huge_page_bytes;
+    if (total.numa_node_bytes.size() < stats.numa_node_bytes.size()) {
+      total.numa_node_bytes.resize(stats.numa_node_bytes.size(), 0);
+    }
+    for (size_t node = 0; node < stats.numa_node_bytes.size(); ++node) {
+      total.numa_node_bytes[node] += stats.numa_node_bytes[node];
+    }
+  }
+  return total;
+}
+
+}  // namespace tflite
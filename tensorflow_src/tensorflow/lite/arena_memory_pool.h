@@ -0,0 +1,115 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_ARENA_MEMORY_POOL_H_
+#define TENSORFLOW_LITE_ARENA_MEMORY_POOL_H_
+
+#include <stddef.h>
+
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/memory_placement.h"
+#include "tensorflow/lite/simple_memory_arena.h"
+
+namespace tflite {
+
+// Statistics of an ArenaMemoryPool, in bytes.
+struct ArenaMemoryStats {
+  // Size of the region.
+  size_t capacity_bytes = 0;
+  // Bytes handed out to arenas, including alignment padding.
+  size_t in_use_bytes = 0;
+  // Peak of in_use_bytes.
+  size_t high_water_mark_bytes = 0;
+  // Largest free block, i.e. the largest arena buffer that would still fit
+  // before alignment.
+  size_t largest_free_block_bytes = 0;
+};
+
+// Serves arena buffers from one memory region owned by the caller, e.g. a
+// hugepage-backed mapping, shared memory or memory reserved at startup, so that
+// several interpreters in a process draw from a single preallocated pool (see
+// Interpreter::SetArenaBufferAllocator). Buffers are placed first-fit and
+// adjacent free blocks are merged when released.
+//
+// The region must outlive the pool, and the pool the interpreters using it.
+// The pool is thread-safe, so interpreters running on different threads can
+// share it. Growing an arena needs its old and new buffers at the same time,
+// so leave some headroom over the sum of the arena sizes.
+class ArenaMemoryPool : public ArenaBufferAllocator {
+ public:
+  ArenaMemoryPool(void* region, size_t region_size);
+
+  ArenaMemoryPool(const ArenaMemoryPool&) = delete;
+  ArenaMemoryPool& operator=(const ArenaMemoryPool&) = delete;
+
+  void* Allocate(size_t size, size_t alignment) override;
+  void Deallocate(void* buffer) override;
+
+  ArenaMemoryStats stats() const;
+
+ private:
+  char* const region_;
+  const size_t region_size_;
+
+  mutable std::mutex mutex_;
+  // Free blocks, and blocks in use, as offset in the region to size.
+  std::map<size_t, size_t> free_blocks_;
+  std::map<size_t, size_t> used_blocks_;
+  size_t in_use_bytes_ = 0;
+  size_t high_water_mark_bytes_ = 0;
+};
+
+// Maps each arena buffer separately with a MemoryPlacement, e.g. in huge
+// pages and on the NUMA node of the thread that first allocates the tensors:
+//
+//   MemoryPlacement placement;
+//   placement.huge_pages = HugePageMode::kTransparent;
+//   placement.numa_node = kCurrentNumaNode;
+//   PlacedArenaAllocator allocator(placement);
+//   interpreter->SetArenaBufferAllocator(&allocator);
+//
+// With kCurrentNumaNode each buffer is bound to the node of the thread calling
+// AllocateTensors() (or resizing the arenas), so call it from the worker
+// thread that will run the interpreter. Thread-safe; must outlive the
+// interpreters using it.
+class PlacedArenaAllocator : public ArenaBufferAllocator {
+ public:
+  explicit PlacedArenaAllocator(
+      const MemoryPlacement& placement,
+      ErrorReporter* error_reporter = DefaultErrorReporter());
+
+  PlacedArenaAllocator(const PlacedArenaAllocator&) = delete;
+  PlacedArenaAllocator& operator=(const PlacedArenaAllocator&) = delete;
+
+  void* Allocate(size_t size, size_t alignment) override;
+  void Deallocate(void* buffer) override;
+
+  // Page statistics summed over the buffers currently allocated.
+  PageStats page_stats() const;
+
+ private:
+  const MemoryPlacement placement_;
+  ErrorReporter* const error_reporter_;
+
+  mutable std::mutex mutex_;
+  std::map<void*, std::unique_ptr<PlacedMemory>> buffers_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_ARENA_MEMORY_POOL_H_
@@ -0,0 +1,140 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/arena_memory_pool.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+TEST(ArenaMemoryPoolTest, AllocatesAlignedBuffersWithinRegion) {
+  alignas(64) static char region[4096];
+  ArenaMemoryPool pool(region, sizeof(region));
+
+  char* first = static_cast<char*>(pool.Allocate(100, 64));
+  char* second = static_cast<char*>(pool.Allocate(100, 64));
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % 64, 0);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % 64, 0);
+  EXPECT_EQ(first, region);
+  EXPECT_EQ(second, region + 128);
+  EXPECT_EQ(pool.stats().in_use_bytes, 200);
+  EXPECT_EQ(pool.stats().capacity_bytes, 4096);
+
+  // Too large for what is left.
+  EXPECT_EQ(pool.Allocate(4000, 64), nullptr);
+}
+
+TEST(ArenaMemoryPoolTest, MergesReleasedBlocks) {
+  alignas(64) static char region[1024];
+  ArenaMemoryPool pool(region, sizeof(region));
+
+  void* a = pool.Allocate(256, 64);
+  void* b = pool.Allocate(256, 64);
+  void* c = pool.Allocate(256, 64);
+  ASSERT_NE(c, nullptr);
+  EXPECT_EQ(pool.stats().largest_free_block_bytes, 256);
+
+  // Releasing the outer blocks leaves two holes too small for 512 bytes.
+  pool.Deallocate(a);
+  pool.Deallocate(c);
+  EXPECT_EQ(pool.stats().largest_free_block_bytes, 512);
+  EXPECT_EQ(pool.Allocate(768, 64), nullptr);
+
+  // Releasing the middle one merges everything back.
+  pool.Deallocate(b);
+  ArenaMemoryStats stats = pool.stats();
+  EXPECT_EQ(stats.in_use_bytes, 0);
+  EXPECT_EQ(stats.high_water_mark_bytes, 768);
+  EXPECT_EQ(stats.largest_free_block_bytes, 1024);
+  EXPECT_EQ(pool.Allocate(1024, 64), region);
+}
+
+TEST(ArenaMemoryPoolTest, ReusesFirstFittingHole) {
+  alignas(64) static char region[1024];
+  ArenaMemoryPool pool(region, sizeof(region));
+
+  void* a = pool.Allocate(128, 64);
+  void* b = pool.Allocate(128, 64);
+  ASSERT_NE(b, nullptr);
+  pool.Deallocate(a);
+  EXPECT_EQ(pool.Allocate(64, 64), a);
+  // Does not fit the 64 bytes left in front of `b`.
+  EXPECT_EQ(pool.Allocate(128, 64), region + 256);
+}
+
+TEST(ArenaMemoryPoolTest, SharedAcrossThreads) {
+  alignas(64) static char region[64 * 1024];
+  ArenaMemoryPool pool(region, sizeof(region));
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&pool, t]() {
+      for (int i = 0; i < 1000; ++i) {
+        char* buffer = static_cast<char*>(pool.Allocate(64 * (1 + t), 64));
+        ASSERT_NE(buffer, nullptr);
+        buffer[0] = static_cast<char>(t);
+        pool.Deallocate(buffer);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(pool.stats().in_use_bytes, 0);
+  EXPECT_EQ(pool.stats().largest_free_block_bytes, sizeof(region));
+}
+
+TEST(PlacedArenaAllocatorTest, MapsEachBuffer) {
+  MemoryPlacement placement;
+  placement.huge_pages = HugePageMode::kTransparent;
+  placement.numa_node = kCurrentNumaNode;
+  PlacedArenaAllocator allocator(placement);
+
+  constexpr size_t kSize = 3 * 1024 * 1024;
+  char* first = static_cast<char*>(allocator.Allocate(kSize, 64));
+  char* second = static_cast<char*>(allocator.Allocate(100, 64));
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % 64, 0);
+  memset(first, 1, kSize);
+  second[99] = 1;
+
+  PageStats stats = allocator.page_stats();
+  // Zero if the platform has no page statistics.
+  if (stats.mapped_bytes > 0) {
+    EXPECT_EQ(stats.mapped_bytes, kSize + 100);
+    EXPECT_GE(stats.resident_bytes, kSize);
+  }
+
+  allocator.Deallocate(first);
+  allocator.Deallocate(second);
+  EXPECT_EQ(allocator.page_stats().mapped_bytes, 0);
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -37,11 +37,12 @@ constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
                            bool preserve_inputs, bool preserve_intermediates,
-                           int tensor_alignment)
+                           int tensor_alignment,
+                           ArenaBufferAllocator* buffer_allocator)
     : context_(context),
       graph_info_(std::move(graph_info)),
-      arena_(kDefaultArenaAlignment),
-      persistent_arena_(kDefaultArenaAlignment),
+      arena_(kDefaultArenaAlignment, buffer_allocator),
+      persistent_arena_(kDefaultArenaAlignment, buffer_allocator),
       preserve_inputs_(preserve_inputs),
       preserve_intermediates_(preserve_intermediates),
       tensor_alignment_(tensor_alignment) {}
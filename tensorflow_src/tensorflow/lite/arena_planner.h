@@ -48,10 +48,13 @@ class ArenaPlanner : public MemoryPlanner {
   // Ownership of 'context' is not taken and it must remain util the
   // ArenaPlanner is destroyed. If 'preserve_inputs' is true the inputs to the
   // graph will not share memory with any other tensor, effectively preserving
-  // them until the end of inference.
+  // them until the end of inference. If 'buffer_allocator' is not null, both
+  // arenas take their memory from it instead of the heap, and it must outlive
+  // the ArenaPlanner.
   ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info,
                bool preserve_inputs, bool preserve_intermediates,
-               int tensor_alignment);
+               int tensor_alignment,
+               ArenaBufferAllocator* buffer_allocator = nullptr);
   ~ArenaPlanner() override;
   ArenaPlanner(const ArenaPlanner&) = delete;
   ArenaPlanner& operator=(const ArenaPlanner&) = delete;
@@ -18,12 +18,47 @@ limitations under the License.
 #include <stdint.h>
 
 #include <memory>
+#include <vector>
 
 #include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/c/c_api.h"
 #include "tensorflow/lite/c/c_api_internal.h"
 #include "tensorflow/lite/interpreter.h"
 
+namespace {
+
+// Points the tensor at `tensor_index` at caller-owned memory. Only the size
+// needs checking here; Interpreter::SetCustomAllocationForTensor checks the
+// alignment and the allocation type.
+TfLiteStatus BindTensorBuffer(TfLiteInterpreter* interpreter,
+                              int tensor_index,
+                              const TfLiteCustomAllocation& allocation) {
+  tflite::Interpreter* impl = interpreter->impl.get();
+  const TfLiteTensor* tensor = impl->tensor(tensor_index);
+  if (allocation.bytes < tensor->bytes) {
+    TF_LITE_REPORT_ERROR(impl->error_reporter(),
+                         "Buffer of %zu bytes is too small for tensor %d "
+                         "which needs %zu bytes.",
+                         allocation.bytes, tensor_index, tensor->bytes);
+    return kTfLiteError;
+  }
+  return impl->SetCustomAllocationForTensor(tensor_index, allocation);
+}
+
+TfLiteStatus BindTensorBuffers(TfLiteInterpreter* interpreter,
+                               const std::vector<int>& tensor_indices,
+                               const TfLiteCustomAllocation* allocations) {
+  if (allocations == nullptr) return kTfLiteOk;
+  for (size_t i = 0; i < tensor_indices.size(); ++i) {
+    if (allocations[i].data == nullptr) continue;
+    TF_LITE_ENSURE_STATUS(
+        BindTensorBuffer(interpreter, tensor_indices[i], allocations[i]));
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace
+
 extern "C" {
 
 TfLiteStatus TfLiteInterpreterResetVariableTensors(
@@ -80,4 +115,48 @@ void TfLiteInterpreterOptionsSetEnableDelegateFallback(
   options->enable_delegate_fallback = enable;
 }
 
+TfLiteStatus TfLiteInterpreterSetInputBuffer(TfLiteInterpreter* interpreter,
+                                             int32_t input_index, void* data,
+                                             size_t size) {
+  const std::vector<int>& inputs = interpreter->impl->inputs();
+  if (input_index < 0 || input_index >= static_cast<int32_t>(inputs.size())) {
+    return kTfLiteError;
+  }
+  return BindTensorBuffer(interpreter, inputs[input_index], {data, size});
+}
+
+TfLiteStatus TfLiteInterpreterSetOutputBuffer(TfLiteInterpreter* interpreter,
+                                              int32_t output_index, void* data,
+                                              size_t size) {
+  const std::vector<int>& outputs = interpreter->impl->outputs();
+  if (output_index < 0 ||
+      output_index >= static_cast<int32_t>(outputs.size())) {
+    return kTfLiteError;
+  }
+  return BindTensorBuffer(interpreter, outputs[output_index], {data, size});
+}
+
+TfLiteStatus TfLiteInterpreterInvokeBatch(TfLiteInterpreter* interpreter,
+                                          const TfLiteIoBuffers* requests,
+                                          int32_t num_requests) {
+  const std::vector<int>& inputs = interpreter->impl->inputs();
+  const std::vector<int>& outputs = interpreter->impl->outputs();
+  for (int32_t i = 0; i < num_requests; ++i) {
+    TfLiteStatus status =
+        BindTensorBuffers(interpreter, inputs, requests[i].inputs);
+    if (status == kTfLiteOk) {
+      status = BindTensorBuffers(interpreter, outputs, requests[i].outputs);
+    }
+    if (status == kTfLiteOk) {
+      status = TfLiteInterpreterInvoke(interpreter);
+    }
+    if (status != kTfLiteOk) {
+      TF_LITE_REPORT_ERROR(interpreter->impl->error_reporter(),
+                           "Request %d of the batch failed.", i);
+      return status;
+    }
+  }
+  return kTfLiteOk;
+}
+
 }  // extern "C"
@@ -146,6 +146,62 @@ TFL_CAPI_EXPORT extern void TfLiteInterpreterOptionsSetUseNNAPI(
 TFL_CAPI_EXPORT extern void TfLiteInterpreterOptionsSetEnableDelegateFallback(
     TfLiteInterpreterOptions* options, bool enable);
 
+/// Binds caller-owned memory to the input tensor at `input_index`, so that
+/// the model reads it in place instead of from a copy made with
+/// `TfLiteTensorCopyFromBuffer`. Rebinding a tensor just swaps the pointer.
+///
+/// * `data` must be aligned to 64 bytes and hold at least `size` bytes.
+/// * `size` must be no smaller than `TfLiteTensorByteSize` of the tensor. The
+///   check is repeated by `TfLiteInterpreterAllocateTensors` if the input is
+///   later resized.
+/// * The caller retains ownership of `data`, which must stay valid until the
+///   tensor is rebound or the interpreter is deleted.
+///
+/// The tensor's data pointer is updated immediately; there is no need to call
+/// `TfLiteInterpreterAllocateTensors` again. Delegates that keep their own
+/// copy of the tensor (through buffer handles) are not supported.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInterpreterSetInputBuffer(
+    TfLiteInterpreter* interpreter, int32_t input_index, void* data,
+    size_t size);
+
+/// Binds caller-owned memory to the output tensor at `output_index`, so that
+/// the model writes its result there directly instead of into the arena.
+/// `data` must be writable and follows the same rules as in
+/// `TfLiteInterpreterSetInputBuffer`. Outputs whose shape is only known at
+/// invocation time (dynamic tensors) cannot be bound.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInterpreterSetOutputBuffer(
+    TfLiteInterpreter* interpreter, int32_t output_index, void* data,
+    size_t size);
+
+/// The buffers of one request in a `TfLiteInterpreterInvokeBatch` call.
+///
+/// `inputs` and `outputs` hold one entry per model input and output, in the
+/// order of `TfLiteInterpreterGetInputTensor` and
+/// `TfLiteInterpreterGetOutputTensor`. Either may be null, and entries with a
+/// null `data` pointer are skipped, to keep the current binding of the tensor.
+typedef struct TfLiteIoBuffers {
+  const TfLiteCustomAllocation* inputs;
+  const TfLiteCustomAllocation* outputs;
+} TfLiteIoBuffers;
+
+/// Runs `num_requests` inferences back to back, binding the buffers of each
+/// request as with `TfLiteInterpreterSetInputBuffer` and
+/// `TfLiteInterpreterSetOutputBuffer` before invoking the interpreter. The
+/// input shapes must already be allocated; every request must fit them.
+///
+/// Stops at the first request that fails to bind or invoke and returns its
+/// status; results of the earlier requests are already in their buffers. The
+/// tensors stay bound to the buffers of the last request attempted.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInterpreterInvokeBatch(
+    TfLiteInterpreter* interpreter, const TfLiteIoBuffers* requests,
+    int32_t num_requests);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
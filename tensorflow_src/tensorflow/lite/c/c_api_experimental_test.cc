@@ -169,6 +169,91 @@ TEST(CApiExperimentalTest, SetOpResolver) {
   TfLiteModelDelete(model);
 }
 
+TEST(CApiExperimentalTest, InvokeBatchUsesCallerBuffers) {
+  TfLiteModel* model =
+      TfLiteModelCreateFromFile("tensorflow/lite/testdata/add.bin");
+  ASSERT_NE(model, nullptr);
+  TfLiteInterpreter* interpreter = TfLiteInterpreterCreate(model, nullptr);
+  ASSERT_NE(interpreter, nullptr);
+  std::array<int, 1> input_dims = {2};
+  ASSERT_EQ(TfLiteInterpreterResizeInputTensor(
+                interpreter, 0, input_dims.data(), input_dims.size()),
+            kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterAllocateTensors(interpreter), kTfLiteOk);
+
+  // Each row is one 64-byte aligned buffer.
+  alignas(64) float inputs[3][16] = {{1.f, 3.f}, {2.f, 4.f}, {-1.f, 0.5f}};
+  alignas(64) float outputs[3][16] = {};
+  TfLiteCustomAllocation input_buffers[3];
+  TfLiteCustomAllocation output_buffers[3];
+  TfLiteIoBuffers requests[3];
+  for (int i = 0; i < 3; ++i) {
+    input_buffers[i] = {inputs[i], sizeof(inputs[i])};
+    output_buffers[i] = {outputs[i], sizeof(outputs[i])};
+    requests[i] = {&input_buffers[i], &output_buffers[i]};
+  }
+  ASSERT_EQ(TfLiteInterpreterInvokeBatch(interpreter, requests, 3), kTfLiteOk);
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(outputs[i][0], 3 * inputs[i][0]);
+    EXPECT_EQ(outputs[i][1], 3 * inputs[i][1]);
+  }
+  EXPECT_EQ(TfLiteTensorData(TfLiteInterpreterGetInputTensor(interpreter, 0)),
+            inputs[2]);
+  EXPECT_EQ(TfLiteTensorData(TfLiteInterpreterGetOutputTensor(interpreter, 0)),
+            outputs[2]);
+
+  // A null entry keeps the current binding, so only the input moves here.
+  TfLiteIoBuffers input_only = {&input_buffers[0], nullptr};
+  ASSERT_EQ(TfLiteInterpreterInvokeBatch(interpreter, &input_only, 1),
+            kTfLiteOk);
+  EXPECT_EQ(outputs[2][0], 3.f);
+  EXPECT_EQ(outputs[2][1], 9.f);
+
+  TfLiteInterpreterDelete(interpreter);
+  TfLiteModelDelete(model);
+}
+
+TEST(CApiExperimentalTest, SetBufferRejectsInvalidBuffers) {
+  TfLiteModel* model =
+      TfLiteModelCreateFromFile("tensorflow/lite/testdata/add.bin");
+  ASSERT_NE(model, nullptr);
+  TfLiteInterpreter* interpreter = TfLiteInterpreterCreate(model, nullptr);
+  ASSERT_NE(interpreter, nullptr);
+  std::array<int, 1> input_dims = {2};
+  ASSERT_EQ(TfLiteInterpreterResizeInputTensor(
+                interpreter, 0, input_dims.data(), input_dims.size()),
+            kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterAllocateTensors(interpreter), kTfLiteOk);
+
+  alignas(64) float buffer[32] = {};
+  // Too small.
+  EXPECT_EQ(TfLiteInterpreterSetInputBuffer(interpreter, 0, buffer,
+                                            sizeof(float)),
+            kTfLiteError);
+  // Misaligned.
+  EXPECT_EQ(TfLiteInterpreterSetOutputBuffer(interpreter, 0, buffer + 1,
+                                             2 * sizeof(float)),
+            kTfLiteError);
+  // Out of range.
+  EXPECT_EQ(TfLiteInterpreterSetInputBuffer(interpreter, 1, buffer,
+                                            sizeof(buffer)),
+            kTfLiteError);
+
+  // Growing the input past the bound buffer is caught on reallocation.
+  ASSERT_EQ(TfLiteInterpreterSetInputBuffer(interpreter, 0, buffer,
+                                            2 * sizeof(float)),
+            kTfLiteOk);
+  input_dims[0] = 4;
+  ASSERT_EQ(TfLiteInterpreterResizeInputTensor(
+                interpreter, 0, input_dims.data(), input_dims.size()),
+            kTfLiteOk);
+  EXPECT_EQ(TfLiteInterpreterAllocateTensors(interpreter), kTfLiteError);
+
+  TfLiteInterpreterDelete(interpreter);
+  TfLiteModelDelete(model);
+}
+
 void AllocateAndSetInputs(TfLiteInterpreter* interpreter) {
   std::array<int, 1> input_dims = {2};
   ASSERT_EQ(TfLiteInterpreterResizeInputTensor(
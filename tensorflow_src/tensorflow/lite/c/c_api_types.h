@@ -76,6 +76,8 @@ typedef enum {
   kTfLiteResource = 14,
   kTfLiteVariant = 15,
   kTfLiteUInt32 = 16,
+  // 17 is kTfLiteUInt16 in upstream TensorFlow Lite, not supported here.
+  kTfLiteInt4 = 18,
 } TfLiteType;
 
 // Legacy. Will be deprecated in favor of TfLiteAffineQuantization.
@@ -80,9 +80,20 @@ TfLiteFloatArray* TfLiteFloatArrayCreate(int size) {
 
 void TfLiteFloatArrayFree(TfLiteFloatArray* a) { free(a); }
 
+// Returns the allocator serving the data of `t`, or NULL for malloc.
+static TfLiteDynamicAllocator* GetDynamicAllocator(const TfLiteTensor* t) {
+  if (t->allocation_type != kTfLiteDynamic || !t->allocation) return NULL;
+  TfLiteDynamicAllocator* allocator = (TfLiteDynamicAllocator*)t->allocation;
+  if (allocator->magic != kTfLiteDynamicAllocatorMagic) return NULL;
+  return allocator;
+}
+
 void TfLiteTensorDataFree(TfLiteTensor* t) {
-  if (t->allocation_type == kTfLiteDynamic ||
-      t->allocation_type == kTfLitePersistentRo) {
+  TfLiteDynamicAllocator* allocator = GetDynamicAllocator(t);
+  if (allocator) {
+    allocator->Free(allocator, t);
+  } else if (t->allocation_type == kTfLiteDynamic ||
+             t->allocation_type == kTfLitePersistentRo) {
     free(t->data.raw);
   }
   t->data.raw = NULL;
@@ -174,18 +185,27 @@ void TfLiteTensorReset(TfLiteType type, const char* name, TfLiteIntArray* dims,
   tensor->quantization.params = NULL;
 }
 
-void TfLiteTensorRealloc(size_t num_bytes, TfLiteTensor* tensor) {
+TfLiteStatus TfLiteTensorRealloc(size_t num_bytes, TfLiteTensor* tensor) {
   if (tensor->allocation_type != kTfLiteDynamic &&
       tensor->allocation_type != kTfLitePersistentRo) {
-    return;
+    return kTfLiteOk;
+  }
+  TfLiteDynamicAllocator* allocator = GetDynamicAllocator(tensor);
+  if (allocator) {
+    return allocator->Realloc(allocator, num_bytes, tensor);
   }
   // TODO(b/145340303): Tensor data should be aligned.
   if (!tensor->data.raw) {
-    tensor->data.raw = malloc(num_bytes);
+    char* data = (char*)malloc(num_bytes);
+    if (!data && num_bytes > 0) return kTfLiteError;
+    tensor->data.raw = data;
   } else if (num_bytes > tensor->bytes) {
-    tensor->data.raw = realloc(tensor->data.raw, num_bytes);
+    char* data = (char*)realloc(tensor->data.raw, num_bytes);
+    if (!data) return kTfLiteError;
+    tensor->data.raw = data;
   }
   tensor->bytes = num_bytes;
+  return kTfLiteOk;
 }
 #endif  // TF_LITE_STATIC_MEMORY
 
@@ -205,6 +225,8 @@ const char* TfLiteTypeGetName(TfLiteType type) {
       return "UINT8";
     case kTfLiteInt8:
       return "INT8";
+    case kTfLiteInt4:
+      return "INT4";
     case kTfLiteInt64:
       return "INT64";
     case kTfLiteUInt64:
@@ -403,7 +403,8 @@ typedef struct TfLiteTensor {
   // bytes = sizeof(float) * 3 * 2 = 4 * 3 * 2 = 24.
   size_t bytes;
 
-  // An opaque pointer to a tflite::MMapAllocation
+  // An opaque pointer to a tflite::MMapAllocation, or for kTfLiteDynamic
+  // tensors to the TfLiteDynamicAllocator serving their data, if any.
   const void* allocation;
 
   // Null-terminated name of this tensor.
@@ -580,6 +581,26 @@ typedef struct TfLiteEvalTensor {
 } TfLiteEvalTensor;
 
 #ifndef TF_LITE_STATIC_MEMORY
+// Value of TfLiteDynamicAllocator::magic.
+#define kTfLiteDynamicAllocatorMagic 0x41594E44u
+
+// Allocator of the data of kTfLiteDynamic tensors, used instead of
+// malloc/realloc/free by TfLiteTensorRealloc and TfLiteTensorDataFree when the
+// `allocation` of a kTfLiteDynamic tensor points to it.
+// WARNING: This is an experimental interface that is subject to change.
+typedef struct TfLiteDynamicAllocator {
+  // Must be kTfLiteDynamicAllocatorMagic. Tells the allocator apart from
+  // anything else delegates or custom ops point `allocation` to.
+  uint32_t magic;
+  // Resizes the data of `tensor` to `num_bytes`, preserving its contents, and
+  // sets `tensor->bytes`. Returns kTfLiteError, leaving the tensor unchanged,
+  // if out of memory or over a limit of the allocator.
+  TfLiteStatus (*Realloc)(struct TfLiteDynamicAllocator* allocator,
+                          size_t num_bytes, TfLiteTensor* tensor);
+  // Releases the data of `tensor`, which may be null.
+  void (*Free)(struct TfLiteDynamicAllocator* allocator, TfLiteTensor* tensor);
+} TfLiteDynamicAllocator;
+
 // Free data memory of tensor `t`.
 void TfLiteTensorDataFree(TfLiteTensor* t);
 
@@ -600,8 +621,10 @@ void TfLiteTensorReset(TfLiteType type, const char* name, TfLiteIntArray* dims,
                        TfLiteTensor* tensor);
 
 // Resize the allocated data of a (dynamic) tensor. Tensors with allocation
-// types other than kTfLiteDynamic will be ignored.
-void TfLiteTensorRealloc(size_t num_bytes, TfLiteTensor* tensor);
+// types other than kTfLiteDynamic and kTfLitePersistentRo will be ignored.
+// The allocation is never shrunk. Returns kTfLiteError, leaving the tensor
+// unchanged, if the data cannot be allocated.
+TfLiteStatus TfLiteTensorRealloc(size_t num_bytes, TfLiteTensor* tensor);
 #endif  // TF_LITE_STATIC_MEMORY
 
 // WARNING: This is an experimental interface that is subject to change.
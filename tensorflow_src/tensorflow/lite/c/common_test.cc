@@ -138,6 +138,37 @@ TEST(Sparsity, TestSparsityFree) {
   TfLiteTensorFree(&t);
 }
 
+TEST(TensorRealloc, TestNeverShrinks) {
+  TfLiteTensor t = {};
+  t.allocation_type = kTfLiteDynamic;
+  ASSERT_EQ(TfLiteTensorRealloc(64, &t), kTfLiteOk);
+  ASSERT_NE(t.data.raw, nullptr);
+  EXPECT_EQ(t.bytes, 64);
+  const char* data = t.data.raw;
+
+  ASSERT_EQ(TfLiteTensorRealloc(16, &t), kTfLiteOk);
+  EXPECT_EQ(t.data.raw, data);
+  EXPECT_EQ(t.bytes, 16);
+
+  ASSERT_EQ(TfLiteTensorRealloc(128, &t), kTfLiteOk);
+  ASSERT_NE(t.data.raw, nullptr);
+  EXPECT_EQ(t.bytes, 128);
+
+  TfLiteTensorFree(&t);
+  EXPECT_EQ(t.data.raw, nullptr);
+}
+
+TEST(TensorRealloc, TestFailureLeavesTensorUnchanged) {
+  TfLiteTensor t = {};
+  t.allocation_type = kTfLiteDynamic;
+  ASSERT_EQ(TfLiteTensorRealloc(64, &t), kTfLiteOk);
+  const char* data = t.data.raw;
+  EXPECT_EQ(TfLiteTensorRealloc(SIZE_MAX, &t), kTfLiteError);
+  EXPECT_EQ(t.data.raw, data);
+  EXPECT_EQ(t.bytes, 64);
+  TfLiteTensorFree(&t);
+}
+
 }  // namespace tflite
 
 int main(int argc, char** argv) {
@@ -867,6 +867,9 @@ TfLiteStatus ConvertTensorType(TensorType tensor_type, TfLiteType* type,
     case TensorType_INT8:
       *type = kTfLiteInt8;
       return kTfLiteOk;
+    case TensorType_INT4:
+      *type = kTfLiteInt4;
+      return kTfLiteOk;
     case TensorType_INT64:
       *type = kTfLiteInt64;
       return kTfLiteOk;
@@ -155,6 +155,22 @@ TEST_F(FlatbufferConversionsTest, TestConvertTensorTypeFloat16) {
   EXPECT_EQ(kTfLiteFloat16, type);
 }
 
+TEST_F(FlatbufferConversionsTest, TestConvertTensorTypeInt4) {
+  // The values upstream TensorFlow Lite assigned, so that models with int4
+  // weights are read the same by either runtime.
+  EXPECT_EQ(17, TensorType_INT4);
+  EXPECT_EQ(18, kTfLiteInt4);
+  TfLiteType type;
+  EXPECT_EQ(kTfLiteOk,
+            ConvertTensorType(TensorType_INT4, &type, &mock_reporter_));
+  EXPECT_EQ(kTfLiteInt4, type);
+  // UINT16 upstream.
+  EXPECT_EQ(kTfLiteError, ConvertTensorType(static_cast<TensorType>(16), &type,
+                                            &mock_reporter_));
+  EXPECT_STREQ("", EnumNameTensorType(static_cast<TensorType>(16)));
+  EXPECT_STREQ("INT4", EnumNameTensorType(TensorType_INT4));
+}
+
 }  // namespace tflite
 
 int main(int argc, char** argv) {
@@ -46,6 +46,18 @@ class Profiler {
     // event_metadata fields. In particular, the delegate status is encoded
     // as DelegateStatus::full_status().
     GENERAL_RUNTIME_INSTRUMENTATION_EVENT = 8,
+
+    // The event is a task run by the CPU backend thread pool on behalf of an
+    // operator, e.g. a slice of a matrix multiplication. The event_metadata
+    // field is the index of the task among the tasks run together. These
+    // events are reported through AddEvent() on the thread that runs the
+    // operator, once all its tasks are done.
+    CPU_BACKEND_TASK_EVENT = 16,
+
+    // The event is the preparation of an operator, i.e. the prepare function
+    // of its kernel, when tensors are allocated or resized. The event_metadata
+    // field is the index of the operator node.
+    OPERATOR_PREPARE_EVENT = 32,
   };
 
   virtual ~Profiler() {}
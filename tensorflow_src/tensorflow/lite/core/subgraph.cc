@@ -645,6 +645,11 @@ TfLiteStatus Subgraph::BytesRequired(TfLiteType type, const int* dims,
         MultiplyAndCheckOverflow(old_count, dims[k], &count) == kTfLiteOk,
         "BytesRequired number of elements overflowed.\n");
   }
+  // Packed two to a byte, the last byte of an odd count being half used.
+  if (type == kTfLiteInt4) {
+    *bytes = (count + 1) / 2;
+    return kTfLiteOk;
+  }
   size_t type_size = 0;
   TF_LITE_ENSURE_OK(&context_, GetSizeOfType(&context_, type, &type_size));
   TF_LITE_ENSURE_MSG(
@@ -902,6 +907,11 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
     const TfLiteRegistration& registration =
         nodes_and_registration_[node_index].second;
     EnsureTensorsVectorCapacity();
+    const char* op_name = nullptr;
+    if (profiler_) op_name = GetTFLiteOpName(registration);
+    ScopedProfile profile(profiler_.get(), op_name,
+                          Profiler::EventType::OPERATOR_PREPARE_EVENT,
+                          node_index);
     if (OpPrepare(registration, &node) != kTfLiteOk) {
       return ReportOpError(&context_, node, registration, node_index,
                            "failed to prepare");
@@ -925,7 +935,10 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
     memory_planner_.reset(new ArenaPlanner(
         &context_, std::unique_ptr<GraphInfo>(new InterpreterInfo(this)),
         /*preserve_inputs=*/true, /*preserve_intermediates*/ false,
-        kDefaultTensorAlignment));
+        kDefaultTensorAlignment, arena_buffer_allocator_));
+    ScopedProfile profile(
+        profiler_.get(), "PlanAllocations",
+        Profiler::EventType::GENERAL_RUNTIME_INSTRUMENTATION_EVENT, -1);
     memory_planner_->PlanAllocations();
   }
 
@@ -959,9 +972,15 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
   next_execution_plan_index_to_prepare_ = last_exec_plan_index_prepared + 1;
 
   // Execute arena allocations.
-  TF_LITE_ENSURE_STATUS(memory_planner_->ExecuteAllocations(
-      next_execution_plan_index_to_plan_allocation_,
-      last_exec_plan_index_prepared));
+  {
+    ScopedProfile profile(
+        profiler_.get(), "ExecuteAllocations",
+        Profiler::EventType::GENERAL_RUNTIME_INSTRUMENTATION_EVENT,
+        next_execution_plan_index_to_plan_allocation_);
+    TF_LITE_ENSURE_STATUS(memory_planner_->ExecuteAllocations(
+        next_execution_plan_index_to_plan_allocation_,
+        last_exec_plan_index_prepared));
+  }
 
   // Ensure custom allocations are large enough for applicable tensors.
   // This causes some extra validations for cases with dynamic tensors, but the
@@ -1283,7 +1302,11 @@ TfLiteStatus Subgraph::SetTensorParametersReadWrite(
   TfLiteTensorReset(type, name, ConvertArrayToTfLiteIntArray(rank, dims),
                     GetLegacyQuantization(quantization),
                     /*buffer=*/nullptr, required_bytes, allocation_type,
-                    nullptr, is_variable, &tensor);
+                    allocation_type == kTfLiteDynamic
+                        ? static_cast<TfLiteDynamicAllocator*>(
+                              dynamic_memory_pool_)
+                        : nullptr,
+                    is_variable, &tensor);
   // TODO(suharshs): Update TfLiteTensorReset to include the new quantization
   // if there are other required callers.
   tensor.quantization = *scoped_quantization.release();
@@ -1311,6 +1334,13 @@ TfLiteStatus Subgraph::ResizeTensorImpl(TfLiteTensor* tensor,
       tensor->allocation_type == kTfLiteCustom) {
     tensor_resized_since_op_invoke_ |=
         TfLiteIntArrayEqual(tensor->dims, new_size) == 0;
+    // Dynamic tensors kernels allocate themselves use the pool from their
+    // first resize on.
+    const TfLiteDynamicAllocator* pool = dynamic_memory_pool_;
+    if (pool && tensor->allocation_type == kTfLiteDynamic &&
+        !tensor->allocation) {
+      tensor->allocation = pool;
+    }
     if (tensor->type != kTfLiteString && tensor->type != kTfLiteResource &&
         tensor->type != kTfLiteVariant) {
       size_t bytesRequired;
@@ -1320,9 +1350,23 @@ TfLiteStatus Subgraph::ResizeTensorImpl(TfLiteTensor* tensor,
         TfLiteIntArrayFree(new_size);
         return kTfLiteError;
       }
-
       // Realloc space for heap-allocated tensors.
-      TfLiteTensorRealloc(bytesRequired, tensor);
+      if (TfLiteTensorRealloc(bytesRequired, tensor) != kTfLiteOk) {
+        TfLiteIntArrayFree(new_size);
+        if (pool && tensor->allocation_type == kTfLiteDynamic &&
+            tensor->allocation == pool &&
+            !dynamic_memory_pool_->CanResize(*tensor, bytesRequired)) {
+          ReportError(
+              "Resizing tensor %s to %zu bytes exceeds the dynamic memory "
+              "limit of %zu bytes.",
+              tensor->name ? tensor->name : "", bytesRequired,
+              dynamic_memory_pool_->memory_limit());
+        } else {
+          ReportError("Failed to allocate %zu bytes for tensor %s.",
+                      bytesRequired, tensor->name ? tensor->name : "");
+        }
+        return kTfLiteError;
+      }
       tensor->bytes = bytesRequired;
     }
     if (tensor->dims) TfLiteIntArrayFree(tensor->dims);
@@ -1616,6 +1660,23 @@ TfLiteStatus Subgraph::SetCustomAllocationForTensor(
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::SetArenaBufferAllocator(
+    ArenaBufferAllocator* allocator) {
+  if (allocator == arena_buffer_allocator_) return kTfLiteOk;
+  arena_buffer_allocator_ = allocator;
+  if (!memory_planner_) return kTfLiteOk;
+
+  // The arenas live as long as their planner, so replan from scratch in the
+  // new memory, keeping the graph immutable if it was.
+  const State previous_state = state_;
+  memory_planner_.reset();
+  state_ = kStateUninvokable;
+  if (previous_state == kStateUninvokable) return kTfLiteOk;
+  TF_LITE_ENSURE_STATUS(AllocateTensors());
+  state_ = previous_state;
+  return kTfLiteOk;
+}
+
 void Subgraph::SetName(const char* name) {
   if (name) {
     name_ = name;
@@ -30,8 +30,10 @@ limitations under the License.
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/macros.h"
+#include "tensorflow/lite/dynamic_memory_pool.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/memory_planner.h"
+#include "tensorflow/lite/simple_memory_arena.h"
 #include "tensorflow/lite/util.h"
 
 namespace tflite {
@@ -315,6 +317,20 @@ class Subgraph {
 
   Profiler* GetProfiler() { return profiler_.get(); }
 
+  // Serves the data of dynamic tensors from `pool`, which must outlive this
+  // subgraph. Tensors resized after this call use the pool, and resizing them
+  // fails once the pool exceeds its memory limit.
+  // WARNING: This is an experimental API and subject to change.
+  void SetDynamicMemoryPool(DynamicMemoryPool* pool) {
+    dynamic_memory_pool_ = pool;
+  }
+
+  // Takes the memory of the arenas from `allocator`, which must outlive this
+  // subgraph, or from the heap if null. Tensors already allocated are moved to
+  // the new memory right away, which resets variable tensors.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetArenaBufferAllocator(ArenaBufferAllocator* allocator);
+
   // Returns a pointer to vector of subgraphs.
   // WARNING: This is an experimental API and subject to change.
   std::vector<std::unique_ptr<Subgraph>>* GetSubgraphs() { return subgraphs_; }
@@ -722,6 +738,13 @@ class Subgraph {
   // A pointer to vector of subgraphs. The vector is owned by the interpreter.
   std::vector<std::unique_ptr<Subgraph>>* subgraphs_ = nullptr;
 
+  // Pool serving the data of dynamic tensors, owned by the interpreter. Null
+  // for malloc.
+  DynamicMemoryPool* dynamic_memory_pool_ = nullptr;
+
+  // Source of the memory of the arenas, not owned. Null for the heap.
+  ArenaBufferAllocator* arena_buffer_allocator_ = nullptr;
+
   // True if all tensors in the graph has static size after calling
   // `PrepareOpsStartingAt` function (which is called by the `AllocateTensors`
   // public function).
@@ -0,0 +1,1274 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/utils/fusion_delegate/fusion_delegate.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/builtin_ops.h"
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/delegates/utils/simple_delegate.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+namespace fusion {
+namespace {
+
+// A set of nodes, in execution order, that is executed as one fused op.
+struct FusionGroup {
+  std::vector<int> nodes;
+  std::vector<TfLiteFusionPattern> patterns;
+};
+
+const TfLiteTensor* Tensor(TfLiteContext* context, int index) {
+  return index >= 0 ? &context->tensors[index] : nullptr;
+}
+
+bool IsFloat(TfLiteContext* context, int index) {
+  const TfLiteTensor* tensor = Tensor(context, index);
+  return tensor && tensor->type == kTfLiteFloat32;
+}
+
+bool IsConstant(TfLiteContext* context, int index) {
+  const TfLiteTensor* tensor = Tensor(context, index);
+  return tensor && IsConstantTensor(tensor);
+}
+
+bool IsOptionalConstantFloat(TfLiteContext* context, int index) {
+  return index < 0 || (IsFloat(context, index) && IsConstant(context, index));
+}
+
+bool SameDims(const TfLiteTensor* a, const TfLiteTensor* b) {
+  return TfLiteIntArrayEqual(a->dims, b->dims);
+}
+
+// Returns true when `operand` can be broadcast against `input` by the
+// elementwise op: same size, a scalar or one value per innermost channel.
+bool IsBroadcastableOperand(const TfLiteTensor* input,
+                            const TfLiteTensor* operand) {
+  if (SameDims(input, operand)) return true;
+  // A broadcast operand of higher rank would change the output shape.
+  const int rank = NumDimensions(input);
+  const int operand_rank = NumDimensions(operand);
+  if (operand_rank > rank) return false;
+  const int64_t size = NumElements(operand);
+  if (size == 1) return true;
+  // Broadcasts along the last dimension: all other dimensions are 1, as in
+  // [C] or [1, 1, 1, C].
+  return rank > 0 && operand_rank > 0 &&
+         size == SizeOfDimension(input, rank - 1) &&
+         size == SizeOfDimension(operand, operand_rank - 1);
+}
+
+float ActivationMin(TfLiteFusedActivation activation) {
+  float min, max;
+  CalculateActivationRange(activation, &min, &max);
+  return min;
+}
+
+float ActivationMax(TfLiteFusedActivation activation) {
+  float min, max;
+  CalculateActivationRange(activation, &min, &max);
+  return max;
+}
+
+TfLiteStatus ResizeOutput(TfLiteContext* context, int index,
+                          const RuntimeShape& shape,
+                          const std::set<int>& partition_outputs) {
+  TfLiteTensor* tensor = &context->tensors[index];
+  // Tensors passed between fused ops of the same partition are not planned
+  // by the arena, as no remaining node in the execution plan touches them.
+  if (partition_outputs.count(index) == 0) SetTensorToDynamic(tensor);
+  TfLiteIntArray* dims = TfLiteIntArrayCreate(shape.DimensionsCount());
+  for (int i = 0; i < shape.DimensionsCount(); ++i) {
+    dims->data[i] = shape.Dims(i);
+  }
+  return context->ResizeTensor(context, tensor, dims);
+}
+
+// An op executed by the delegate kernel. It is built from one or several
+// TFLite nodes and only stores tensor indices, as node pointers are not stable
+// while the delegate is being applied.
+class FusedOp {
+ public:
+  virtual ~FusedOp() {}
+  virtual TfLiteStatus Prepare(TfLiteContext* context,
+                               const std::set<int>& partition_outputs) = 0;
+  virtual TfLiteStatus Eval(TfLiteContext* context) = 0;
+};
+
+// PAD, CONV_2D, ADD, RELU and RELU6 nodes, in this order. All but the
+// convolution are optional.
+class ConvOp : public FusedOp {
+ public:
+  ConvOp(TfLiteContext* context, const std::vector<int>& nodes) {
+    for (int node_index : nodes) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      context->GetNodeAndRegistration(context, node_index, &node,
+                                      &registration);
+      switch (registration->builtin_code) {
+        case kTfLiteBuiltinPad:
+          input_ = node->inputs->data[0];
+          paddings_ = node->inputs->data[1];
+          break;
+        case kTfLiteBuiltinConv2d:
+          if (paddings_ < 0) input_ = node->inputs->data[0];
+          filter_ = node->inputs->data[1];
+          bias_ = node->inputs->size > 2 ? node->inputs->data[2] : -1;
+          params_ = *reinterpret_cast<TfLiteConvParams*>(node->builtin_data);
+          break;
+        case kTfLiteBuiltinAdd:
+          residual_ = node->inputs->data[0] == output_ ? node->inputs->data[1]
+                                                       : node->inputs->data[0];
+          residual_activation_ =
+              reinterpret_cast<TfLiteAddParams*>(node->builtin_data)
+                  ->activation;
+          break;
+        case kTfLiteBuiltinRelu:
+          clamp_min_ = std::max(clamp_min_, 0.0f);
+          break;
+        case kTfLiteBuiltinRelu6:
+          clamp_min_ = std::max(clamp_min_, 0.0f);
+          clamp_max_ = std::min(clamp_max_, 6.0f);
+          break;
+      }
+      output_ = node->outputs->data[0];
+    }
+  }
+
+  TfLiteStatus Prepare(TfLiteContext* context,
+                       const std::set<int>& partition_outputs) override {
+    const TfLiteTensor* input = Tensor(context, input_);
+    const TfLiteTensor* filter = Tensor(context, filter_);
+    TF_LITE_ENSURE_EQ(context, NumDimensions(input), 4);
+    TF_LITE_ENSURE_EQ(context, NumDimensions(filter), 4);
+    TF_LITE_ENSURE_EQ(context, SizeOfDimension(input, 3),
+                      SizeOfDimension(filter, 3));
+
+    pad_top_ = pad_left_ = pad_bottom_ = pad_right_ = 0;
+    if (paddings_ >= 0) {
+      const int32_t* paddings =
+          GetTensorData<int32_t>(Tensor(context, paddings_));
+      pad_top_ = paddings[2];
+      pad_bottom_ = paddings[3];
+      pad_left_ = paddings[4];
+      pad_right_ = paddings[5];
+    }
+    const int batches = SizeOfDimension(input, 0);
+    const int height = SizeOfDimension(input, 1) + pad_top_ + pad_bottom_;
+    const int width = SizeOfDimension(input, 2) + pad_left_ + pad_right_;
+    const int filter_height = SizeOfDimension(filter, 1);
+    const int filter_width = SizeOfDimension(filter, 2);
+    int out_height, out_width;
+    padding_ = ComputePaddingHeightWidth(
+        params_.stride_height, params_.stride_width,
+        params_.dilation_height_factor, params_.dilation_width_factor, height,
+        width, filter_height, filter_width, params_.padding, &out_height,
+        &out_width);
+    // The explicit padding becomes part of the convolution padding; the im2col
+    // transform zero-fills every tap that falls outside the real input.
+    padding_.height += pad_top_;
+    padding_.width += pad_left_;
+
+    const RuntimeShape output_shape(
+        {batches, out_height, out_width, SizeOfDimension(filter, 0)});
+    if (residual_ >= 0) {
+      const RuntimeShape residual_shape =
+          GetTensorShape(Tensor(context, residual_));
+      TF_LITE_ENSURE(context, residual_shape == output_shape);
+    }
+
+    const int input_depth = SizeOfDimension(input, 3);
+    const bool need_im2col =
+        params_.stride_width != 1 || params_.stride_height != 1 ||
+        params_.dilation_width_factor != 1 ||
+        params_.dilation_height_factor != 1 || filter_width != 1 ||
+        filter_height != 1;
+    TF_LITE_ENSURE(context, need_im2col || paddings_ < 0);
+    if (need_im2col) {
+      im2col_shape_.BuildFrom({batches, out_height, out_width,
+                               input_depth * filter_height * filter_width});
+      im2col_.resize(im2col_shape_.FlatSize());
+    } else {
+      im2col_shape_.Resize(0);
+      im2col_.clear();
+    }
+    return ResizeOutput(context, output_, output_shape, partition_outputs);
+  }
+
+  TfLiteStatus Eval(TfLiteContext* context) override {
+    const TfLiteTensor* input = Tensor(context, input_);
+    const TfLiteTensor* filter = Tensor(context, filter_);
+    const TfLiteTensor* bias = Tensor(context, bias_);
+    TfLiteTensor* output = &context->tensors[output_];
+
+    ConvParams op_params;
+    op_params.padding_type = PaddingType::kSame;
+    op_params.padding_values.width = padding_.width;
+    op_params.padding_values.height = padding_.height;
+    op_params.stride_width = params_.stride_width;
+    op_params.stride_height = params_.stride_height;
+    op_params.dilation_width_factor = params_.dilation_width_factor;
+    op_params.dilation_height_factor = params_.dilation_height_factor;
+    op_params.float_activation_min = ActivationMin(params_.activation);
+    op_params.float_activation_max = ActivationMax(params_.activation);
+    if (residual_ < 0) {
+      op_params.float_activation_min =
+          std::max(op_params.float_activation_min, clamp_min_);
+      op_params.float_activation_max =
+          std::min(op_params.float_activation_max, clamp_max_);
+    }
+    optimized_ops::Conv(op_params, GetTensorShape(input),
+                        GetTensorData<float>(input), GetTensorShape(filter),
+                        GetTensorData<float>(filter), GetTensorShape(bias),
+                        GetTensorData<float>(bias), GetTensorShape(output),
+                        GetTensorData<float>(output), im2col_shape_,
+                        im2col_.empty() ? nullptr : im2col_.data(),
+                        CpuBackendContext::GetFromContext(context));
+
+    if (residual_ >= 0) {
+      // The residual add runs on the convolution output while it is still in
+      // cache, instead of through a separate arena tensor.
+      const float min =
+          std::max(ActivationMin(residual_activation_), clamp_min_);
+      const float max =
+          std::min(ActivationMax(residual_activation_), clamp_max_);
+      const float* residual = GetTensorData<float>(Tensor(context, residual_));
+      float* output_data = GetTensorData<float>(output);
+      const int size = NumElements(output);
+      for (int i = 0; i < size; ++i) {
+        output_data[i] = std::min(std::max(output_data[i] + residual[i], min),
+                                  max);
+      }
+    }
+    return kTfLiteOk;
+  }
+
+ private:
+  int input_ = -1;
+  int paddings_ = -1;
+  int filter_ = -1;
+  int bias_ = -1;
+  int residual_ = -1;
+  int output_ = -1;
+  TfLiteConvParams params_;
+  TfLiteFusedActivation residual_activation_ = kTfLiteActNone;
+  float clamp_min_ = std::numeric_limits<float>::lowest();
+  float clamp_max_ = std::numeric_limits<float>::max();
+  int pad_top_ = 0;
+  int pad_left_ = 0;
+  int pad_bottom_ = 0;
+  int pad_right_ = 0;
+  TfLitePaddingValues padding_;
+  RuntimeShape im2col_shape_;
+  std::vector<float> im2col_;
+};
+
+// A PAD node that could not be folded into its convolution.
+class PadOp : public FusedOp {
+ public:
+  PadOp(TfLiteContext* context, int node_index) {
+    TfLiteNode* node;
+    TfLiteRegistration* registration;
+    context->GetNodeAndRegistration(context, node_index, &node, &registration);
+    input_ = node->inputs->data[0];
+    paddings_ = node->inputs->data[1];
+    output_ = node->outputs->data[0];
+  }
+
+  TfLiteStatus Prepare(TfLiteContext* context,
+                       const std::set<int>& partition_outputs) override {
+    const TfLiteTensor* input = Tensor(context, input_);
+    TF_LITE_ENSURE_EQ(context, NumDimensions(input), 4);
+    const int32_t* paddings =
+        GetTensorData<int32_t>(Tensor(context, paddings_));
+    RuntimeShape output_shape(4);
+    for (int i = 0; i < 4; ++i) {
+      output_shape.SetDim(i, SizeOfDimension(input, i) + paddings[2 * i] +
+                                 paddings[2 * i + 1]);
+    }
+    return ResizeOutput(context, output_, output_shape, partition_outputs);
+  }
+
+  TfLiteStatus Eval(TfLiteContext* context) override {
+    const TfLiteTensor* input = Tensor(context, input_);
+    const int32_t* paddings =
+        GetTensorData<int32_t>(Tensor(context, paddings_));
+    TfLiteTensor* output = &context->tensors[output_];
+    PadParams op_params;
+    op_params.left_padding_count = 4;
+    op_params.right_padding_count = 4;
+    for (int i = 0; i < 4; ++i) {
+      op_params.left_padding[i] = paddings[2 * i];
+      op_params.right_padding[i] = paddings[2 * i + 1];
+    }
+    op_params.resizing_category = ResizingCategory::kGenericResize;
+    const float pad_value = 0.0f;
+    optimized_ops::Pad(op_params, GetTensorShape(input),
+                       GetTensorData<float>(input), &pad_value,
+                       GetTensorShape(output), GetTensorData<float>(output));
+    return kTfLiteOk;
+  }
+
+ private:
+  int input_;
+  int paddings_;
+  int output_;
+};
+
+// output = clamp(input * scale + shift), built from a MUL and/or an ADD node,
+// or from a lone RELU/RELU6.
+class ElementwiseOp : public FusedOp {
+ public:
+  ElementwiseOp(TfLiteContext* context, const std::vector<int>& nodes) {
+    for (int node_index : nodes) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      context->GetNodeAndRegistration(context, node_index, &node,
+                                      &registration);
+      const int lhs = node->inputs->size > 0 ? node->inputs->data[0] : -1;
+      const int rhs = node->inputs->size > 1 ? node->inputs->data[1] : -1;
+      switch (registration->builtin_code) {
+        case kTfLiteBuiltinMul: {
+          SplitOperands(context, lhs, rhs, &scale_);
+          Clamp(reinterpret_cast<TfLiteMulParams*>(node->builtin_data)
+                    ->activation);
+          break;
+        }
+        case kTfLiteBuiltinAdd: {
+          if (input_ < 0) {
+            SplitOperands(context, lhs, rhs, &shift_);
+          } else {
+            shift_ = lhs == output_ ? rhs : lhs;
+          }
+          Clamp(reinterpret_cast<TfLiteAddParams*>(node->builtin_data)
+                    ->activation);
+          break;
+        }
+        case kTfLiteBuiltinRelu:
+          if (input_ < 0) input_ = lhs;
+          Clamp(kTfLiteActRelu);
+          break;
+        case kTfLiteBuiltinRelu6:
+          if (input_ < 0) input_ = lhs;
+          Clamp(kTfLiteActRelu6);
+          break;
+      }
+      output_ = node->outputs->data[0];
+    }
+  }
+
+  TfLiteStatus Prepare(TfLiteContext* context,
+                       const std::set<int>& partition_outputs) override {
+    const TfLiteTensor* input = Tensor(context, input_);
+    for (int operand : {scale_, shift_}) {
+      if (operand >= 0) {
+        TF_LITE_ENSURE(context, IsBroadcastableOperand(
+                                    input, Tensor(context, operand)));
+      }
+    }
+    return ResizeOutput(context, output_, GetTensorShape(input),
+                        partition_outputs);
+  }
+
+  TfLiteStatus Eval(TfLiteContext* context) override {
+    const TfLiteTensor* input = Tensor(context, input_);
+    const TfLiteTensor* scale = Tensor(context, scale_);
+    const TfLiteTensor* shift = Tensor(context, shift_);
+    const float* input_data = GetTensorData<float>(input);
+    float* output_data = GetTensorData<float>(&context->tensors[output_]);
+    const int size = NumElements(input);
+    const int scale_size = scale ? NumElements(scale) : 0;
+    const int shift_size = shift ? NumElements(shift) : 0;
+    const float* scale_data = GetTensorData<float>(scale);
+    const float* shift_data = GetTensorData<float>(shift);
+    for (int i = 0; i < size; ++i) {
+      float value = input_data[i];
+      if (scale_data) value *= scale_data[scale_size == 1 ? 0 : i % scale_size];
+      if (shift_data) value += shift_data[shift_size == 1 ? 0 : i % shift_size];
+      output_data[i] = std::min(std::max(value, min_), max_);
+    }
+    return kTfLiteOk;
+  }
+
+ private:
+  // Picks the non-constant (or the larger) operand of a binary node as the
+  // data input and the other one as the broadcast operand.
+  void SplitOperands(TfLiteContext* context, int lhs, int rhs, int* operand) {
+    if (input_ >= 0) {
+      *operand = lhs == output_ ? rhs : lhs;
+      return;
+    }
+    const bool swap =
+        IsConstant(context, lhs) ||
+        NumElements(Tensor(context, lhs)) < NumElements(Tensor(context, rhs));
+    input_ = swap ? rhs : lhs;
+    *operand = swap ? lhs : rhs;
+  }
+
+  void Clamp(TfLiteFusedActivation activation) {
+    min_ = std::max(min_, ActivationMin(activation));
+    max_ = std::min(max_, ActivationMax(activation));
+  }
+
+  int input_ = -1;
+  int scale_ = -1;
+  int shift_ = -1;
+  int output_ = -1;
+  float min_ = std::numeric_limits<float>::lowest();
+  float max_ = std::numeric_limits<float>::max();
+};
+
+// One FULLY_CONNECTED node, or two chained ones whose weights are multiplied
+// together at prepare time.
+class FullyConnectedOp : public FusedOp {
+ public:
+  FullyConnectedOp(TfLiteContext* context, const std::vector<int>& nodes) {
+    for (int node_index : nodes) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      context->GetNodeAndRegistration(context, node_index, &node,
+                                      &registration);
+      if (input_ < 0) input_ = node->inputs->data[0];
+      weights_.push_back(node->inputs->data[1]);
+      biases_.push_back(node->inputs->size > 2 ? node->inputs->data[2] : -1);
+      activation_ = reinterpret_cast<TfLiteFullyConnectedParams*>(
+                        node->builtin_data)
+                        ->activation;
+      output_ = node->outputs->data[0];
+    }
+  }
+
+  TfLiteStatus Prepare(TfLiteContext* context,
+                       const std::set<int>& partition_outputs) override {
+    const TfLiteTensor* first_weights = Tensor(context, weights_.front());
+    const TfLiteTensor* last_weights = Tensor(context, weights_.back());
+    const int input_size = SizeOfDimension(first_weights, 1);
+    const int output_size = SizeOfDimension(last_weights, 0);
+    if (weights_.size() > 1 && folded_weights_.empty()) {
+      TF_LITE_ENSURE_STATUS(Fold(context));
+    }
+    const TfLiteTensor* input = Tensor(context, input_);
+    TF_LITE_ENSURE_EQ(context, NumElements(input) % input_size, 0);
+    weights_shape_.BuildFrom({output_size, input_size});
+    return ResizeOutput(
+        context, output_,
+        RuntimeShape({static_cast<int>(NumElements(input) / input_size),
+                      output_size}),
+        partition_outputs);
+  }
+
+  TfLiteStatus Eval(TfLiteContext* context) override {
+    const TfLiteTensor* input = Tensor(context, input_);
+    TfLiteTensor* output = &context->tensors[output_];
+    const bool folded = !folded_weights_.empty();
+    const float* weights =
+        folded ? folded_weights_.data()
+               : GetTensorData<float>(Tensor(context, weights_[0]));
+    const float* bias = folded
+                            ? folded_bias_.data()
+                            : GetTensorData<float>(Tensor(context, biases_[0]));
+    FullyConnectedParams op_params;
+    op_params.float_activation_min = ActivationMin(activation_);
+    op_params.float_activation_max = ActivationMax(activation_);
+    op_params.lhs_cacheable = true;
+    op_params.rhs_cacheable = false;
+    op_params.weights_format = FullyConnectedWeightsFormat::kDefault;
+    const int output_size = weights_shape_.Dims(0);
+    optimized_ops::FullyConnected(
+        op_params, GetTensorShape(input), GetTensorData<float>(input),
+        weights_shape_, weights, RuntimeShape({output_size}), bias,
+        GetTensorShape(output), GetTensorData<float>(output),
+        CpuBackendContext::GetFromContext(context));
+    return kTfLiteOk;
+  }
+
+ private:
+  // W = W2 * W1 and b = W2 * b1 + b2, all weights being [out, in] row-major.
+  TfLiteStatus Fold(TfLiteContext* context) {
+    const TfLiteTensor* w1 = Tensor(context, weights_[0]);
+    const TfLiteTensor* w2 = Tensor(context, weights_[1]);
+    const int in = SizeOfDimension(w1, 1);
+    const int hidden = SizeOfDimension(w1, 0);
+    const int out = SizeOfDimension(w2, 0);
+    TF_LITE_ENSURE_EQ(context, SizeOfDimension(w2, 1), hidden);
+    const float* w1_data = GetTensorData<float>(w1);
+    const float* w2_data = GetTensorData<float>(w2);
+    const float* b1_data = GetTensorData<float>(Tensor(context, biases_[0]));
+    const float* b2_data = GetTensorData<float>(Tensor(context, biases_[1]));
+    folded_weights_.assign(static_cast<size_t>(out) * in, 0.0f);
+    folded_bias_.assign(out, 0.0f);
+    for (int o = 0; o < out; ++o) {
+      float* row = &folded_weights_[static_cast<size_t>(o) * in];
+      float bias = b2_data ? b2_data[o] : 0.0f;
+      for (int h = 0; h < hidden; ++h) {
+        const float w = w2_data[o * hidden + h];
+        const float* w1_row = &w1_data[static_cast<size_t>(h) * in];
+        for (int i = 0; i < in; ++i) row[i] += w * w1_row[i];
+        if (b1_data) bias += w * b1_data[h];
+      }
+      folded_bias_[o] = bias;
+    }
+    return kTfLiteOk;
+  }
+
+  int input_ = -1;
+  int output_ = -1;
+  std::vector<int> weights_;
+  std::vector<int> biases_;
+  TfLiteFusedActivation activation_ = kTfLiteActNone;
+  RuntimeShape weights_shape_;
+  std::vector<float> folded_weights_;
+  std::vector<float> folded_bias_;
+};
+
+// A chain of TRANSPOSE nodes applied as a single composed permutation.
+class TransposeOp : public FusedOp {
+ public:
+  TransposeOp(TfLiteContext* context, const std::vector<int>& nodes) {
+    for (int node_index : nodes) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      context->GetNodeAndRegistration(context, node_index, &node,
+                                      &registration);
+      if (input_ < 0) input_ = node->inputs->data[0];
+      perms_.push_back(node->inputs->data[1]);
+      output_ = node->outputs->data[0];
+    }
+  }
+
+  TfLiteStatus Prepare(TfLiteContext* context,
+                       const std::set<int>& partition_outputs) override {
+    const TfLiteTensor* input = Tensor(context, input_);
+    const int rank = NumDimensions(input);
+    TF_LITE_ENSURE(context, rank <= 5);
+    // Transposing by p1 then p2 reads input dimension p1[p2[i]] for output
+    // dimension i.
+    std::vector<int> composed(rank);
+    for (int i = 0; i < rank; ++i) composed[i] = i;
+    for (int perm_index : perms_) {
+      const TfLiteTensor* perm = Tensor(context, perm_index);
+      TF_LITE_ENSURE_EQ(context, NumElements(perm), rank);
+      const int32_t* perm_data = GetTensorData<int32_t>(perm);
+      std::vector<int> next(rank);
+      for (int i = 0; i < rank; ++i) {
+        const int axis = perm_data[i] < 0 ? perm_data[i] + rank : perm_data[i];
+        TF_LITE_ENSURE(context, axis >= 0 && axis < rank);
+        next[i] = composed[axis];
+      }
+      composed.swap(next);
+    }
+    params_.perm_count = rank;
+    is_identity_ = true;
+    RuntimeShape output_shape(rank);
+    for (int i = 0; i < rank; ++i) {
+      params_.perm[i] = composed[i];
+      is_identity_ &= composed[i] == i;
+      output_shape.SetDim(i, SizeOfDimension(input, composed[i]));
+    }
+    return ResizeOutput(context, output_, output_shape, partition_outputs);
+  }
+
+  TfLiteStatus Eval(TfLiteContext* context) override {
+    const TfLiteTensor* input = Tensor(context, input_);
+    TfLiteTensor* output = &context->tensors[output_];
+    if (is_identity_) {
+      std::memcpy(output->data.raw, input->data.raw, input->bytes);
+      return kTfLiteOk;
+    }
+    optimized_ops::Transpose(params_, GetTensorShape(input),
+                             GetTensorData<float>(input),
+                             GetTensorShape(output),
+                             GetTensorData<float>(output));
+    return kTfLiteOk;
+  }
+
+ private:
+  int input_ = -1;
+  int output_ = -1;
+  std::vector<int> perms_;
+  TransposeParams params_;
+  bool is_identity_ = false;
+};
+
+// SOFTMAX, TOPK_V2, or both fused. The fused op computes every probability of
+// a row into a per-row buffer and ranks them as TOPK_V2 does; only the top k
+// are written, the softmax output tensor is never allocated.
+class SoftmaxTopKOp : public FusedOp {
+ public:
+  SoftmaxTopKOp(TfLiteContext* context, const std::vector<int>& nodes) {
+    for (int node_index : nodes) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      context->GetNodeAndRegistration(context, node_index, &node,
+                                      &registration);
+      if (input_ < 0) input_ = node->inputs->data[0];
+      if (registration->builtin_code == kTfLiteBuiltinSoftmax) {
+        beta_ = reinterpret_cast<TfLiteSoftmaxParams*>(node->builtin_data)
+                    ->beta;
+        softmax_ = true;
+        values_ = node->outputs->data[0];
+      } else {
+        k_ = node->inputs->data[1];
+        values_ = node->outputs->data[0];
+        indices_ = node->outputs->data[1];
+      }
+    }
+  }
+
+  TfLiteStatus Prepare(TfLiteContext* context,
+                       const std::set<int>& partition_outputs) override {
+    const TfLiteTensor* input = Tensor(context, input_);
+    const int rank = NumDimensions(input);
+    TF_LITE_ENSURE(context, rank >= 1);
+    // The fast exp of the fused op only takes the non-positive
+    // (logit - max) * beta.
+    TF_LITE_ENSURE(context, !softmax_ || k_ < 0 || beta_ > 0.f);
+    RuntimeShape output_shape = GetTensorShape(input);
+    if (k_ >= 0) {
+      const int depth = output_shape.Dims(rank - 1);
+      order_.resize(depth);
+      if (softmax_) probabilities_.resize(depth);
+      const int k = *GetTensorData<int32_t>(Tensor(context, k_));
+      TF_LITE_ENSURE(context, k >= 0 && k <= output_shape.Dims(rank - 1));
+      output_shape.SetDim(rank - 1, k);
+      TF_LITE_ENSURE_STATUS(
+          ResizeOutput(context, indices_, output_shape, partition_outputs));
+    }
+    return ResizeOutput(context, values_, output_shape, partition_outputs);
+  }
+
+  TfLiteStatus Eval(TfLiteContext* context) override {
+    const TfLiteTensor* input = Tensor(context, input_);
+    const RuntimeShape input_shape = GetTensorShape(input);
+    float* values = GetTensorData<float>(&context->tensors[values_]);
+    if (k_ < 0) {
+      // Unfused SOFTMAX, same kernel as the builtin op.
+      SoftmaxParams op_params;
+      op_params.beta = beta_;
+      optimized_ops::Softmax(op_params, input_shape,
+                             GetTensorData<float>(input), input_shape, values,
+                             CpuBackendContext::GetFromContext(context));
+      return kTfLiteOk;
+    }
+
+    const int depth = input_shape.Dims(input_shape.DimensionsCount() - 1);
+    const int rows = depth == 0 ? 0 : input_shape.FlatSize() / depth;
+    const int k = *GetTensorData<int32_t>(Tensor(context, k_));
+    int32_t* indices = GetTensorData<int32_t>(&context->tensors[indices_]);
+    for (int row = 0; row < rows; ++row) {
+      const float* scores = GetTensorData<float>(input) + row * depth;
+      if (softmax_) {
+        // TOPK_V2 ranks the probabilities, which tie where they underflow or
+        // round to the same value even if the logits differ.
+        const float* logits = scores;
+        const float max = *std::max_element(logits, logits + depth);
+        float sum = 0.f;
+        for (int i = 0; i < depth; ++i) {
+          probabilities_[i] = optimized_ops::ExpPolynomialNonPositive(
+              (logits[i] - max) * beta_);
+          sum += probabilities_[i];
+        }
+        const float inv_sum = 1.f / sum;
+        for (int i = 0; i < depth; ++i) probabilities_[i] *= inv_sum;
+        scores = probabilities_.data();
+      }
+      // Same order as TOPK_V2: larger values first, lower index on ties.
+      for (int i = 0; i < depth; ++i) order_[i] = i;
+      std::partial_sort(order_.begin(), order_.begin() + k, order_.end(),
+                        [scores](int32_t a, int32_t b) {
+                          return scores[a] > scores[b] ||
+                                 (scores[a] == scores[b] && a < b);
+                        });
+      std::copy(order_.begin(), order_.begin() + k, indices + row * k);
+      float* row_values = values + row * k;
+      for (int i = 0; i < k; ++i) row_values[i] = scores[order_[i]];
+    }
+    return kTfLiteOk;
+  }
+
+ private:
+  int input_ = -1;
+  int k_ = -1;
+  int values_ = -1;
+  int indices_ = -1;
+  bool softmax_ = false;
+  float beta_ = 1.f;
+  // Per-row buffers, sized in Prepare().
+  std::vector<int32_t> order_;
+  std::vector<float> probabilities_;
+};
+
+std::unique_ptr<FusedOp> CreateOp(TfLiteContext* context,
+                                  const std::vector<int>& nodes) {
+  TfLiteNode* node;
+  TfLiteRegistration* registration;
+  context->GetNodeAndRegistration(context, nodes.front(), &node,
+                                  &registration);
+  switch (registration->builtin_code) {
+    case kTfLiteBuiltinPad:
+      if (nodes.size() == 1) return std::make_unique<PadOp>(context, nodes[0]);
+      return std::make_unique<ConvOp>(context, nodes);
+    case kTfLiteBuiltinConv2d:
+      return std::make_unique<ConvOp>(context, nodes);
+    case kTfLiteBuiltinAdd:
+    case kTfLiteBuiltinMul:
+    case kTfLiteBuiltinRelu:
+    case kTfLiteBuiltinRelu6:
+      return std::make_unique<ElementwiseOp>(context, nodes);
+    case kTfLiteBuiltinFullyConnected:
+      return std::make_unique<FullyConnectedOp>(context, nodes);
+    case kTfLiteBuiltinTranspose:
+      return std::make_unique<TransposeOp>(context, nodes);
+    case kTfLiteBuiltinSoftmax:
+    case kTfLiteBuiltinTopkV2:
+      return std::make_unique<SoftmaxTopKOp>(context, nodes);
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+// Finds the fusable patterns once per graph and remembers which group every
+// claimed node belongs to.
+class FusionDelegate : public SimpleDelegateInterface {
+ public:
+  explicit FusionDelegate(const FusionDelegateOptions& options)
+      : options_(options) {}
+
+  bool IsNodeSupportedByDelegate(const TfLiteRegistration* registration,
+                                 const TfLiteNode* node,
+                                 TfLiteContext* context) const override {
+    return claimed_nodes_.count(node) != 0;
+  }
+
+  TfLiteStatus Initialize(TfLiteContext* context) override {
+    groups_.clear();
+    group_of_node_.clear();
+    claimed_nodes_.clear();
+    std::fill(std::begin(fusion_counts_), std::end(fusion_counts_), 0);
+
+    TfLiteIntArray* plan;
+    TF_LITE_ENSURE_STATUS(context->GetExecutionPlan(context, &plan));
+    consumers_.assign(context->tensors_size, std::vector<int>());
+    for (int i = 0; i < plan->size; ++i) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      TF_LITE_ENSURE_STATUS(context->GetNodeAndRegistration(
+          context, plan->data[i], &node, &registration));
+      for (int j = 0; j < node->inputs->size; ++j) {
+        const int tensor = node->inputs->data[j];
+        if (tensor >= 0) consumers_[tensor].push_back(plan->data[i]);
+      }
+    }
+
+    for (int i = 0; i < plan->size; ++i) {
+      const int node_index = plan->data[i];
+      if (group_of_node_.count(node_index)) continue;
+      FusionGroup group;
+      if (MatchConvGroup(context, node_index, &group) ||
+          MatchMulAdd(context, node_index, &group) ||
+          MatchFullyConnectedPair(context, node_index, &group) ||
+          MatchTransposeChain(context, node_index, &group) ||
+          MatchSoftmaxTopK(context, node_index, &group)) {
+        for (int member : group.nodes) {
+          TfLiteNode* node;
+          TfLiteRegistration* registration;
+          context->GetNodeAndRegistration(context, member, &node,
+                                          &registration);
+          group_of_node_[member] = groups_.size();
+          claimed_nodes_.insert(node);
+        }
+        groups_.push_back(std::move(group));
+      }
+    }
+    consumers_.clear();
+    return kTfLiteOk;
+  }
+
+  const char* Name() const override {
+    static constexpr char kName[] = "FusionDelegate";
+    return kName;
+  }
+
+  std::unique_ptr<SimpleDelegateKernelInterface> CreateDelegateKernelInterface()
+      override;
+
+  SimpleDelegateInterface::Options DelegateOptions() const override {
+    // Use default options.
+    return SimpleDelegateInterface::Options();
+  }
+
+  const FusionGroup* GroupOf(int node_index) const {
+    auto it = group_of_node_.find(node_index);
+    return it == group_of_node_.end() ? nullptr : &groups_[it->second];
+  }
+
+  void RecordFusion(const FusionGroup& group) {
+    for (TfLiteFusionPattern pattern : group.patterns) {
+      ++fusion_counts_[pattern];
+      if (options_.log_report) {
+        TFLITE_LOG_PROD(TFLITE_LOG_INFO, "%s: fused %s (nodes %d to %d).",
+                        Name(), TfLiteFusionPatternName(pattern),
+                        group.nodes.front(), group.nodes.back());
+      }
+    }
+  }
+
+  int FusionCount(TfLiteFusionPattern pattern) const {
+    return fusion_counts_[pattern];
+  }
+
+ private:
+  int SoleConsumer(int tensor) const {
+    return consumers_[tensor].size() == 1 ? consumers_[tensor][0] : -1;
+  }
+
+  bool IsFree(int node_index) const {
+    return node_index >= 0 && group_of_node_.count(node_index) == 0;
+  }
+
+  static int BuiltinCode(TfLiteContext* context, int node_index,
+                         TfLiteNode** node) {
+    TfLiteRegistration* registration;
+    if (context->GetNodeAndRegistration(context, node_index, node,
+                                        &registration) != kTfLiteOk) {
+      return -1;
+    }
+    return registration->builtin_code;
+  }
+
+  // [PAD] -> CONV_2D [-> ADD] [-> RELU/RELU6 ...]
+  bool MatchConvGroup(TfLiteContext* context, int node_index,
+                      FusionGroup* group) const {
+    TfLiteNode* node;
+    int code = BuiltinCode(context, node_index, &node);
+    int conv_index = node_index;
+    if (code == kTfLiteBuiltinPad) {
+      if (!options_.fuse_pad_conv || !IsFoldablePad(context, node)) {
+        return false;
+      }
+      conv_index = SoleConsumer(node->outputs->data[0]);
+      TfLiteNode* conv;
+      if (!IsFree(conv_index) ||
+          BuiltinCode(context, conv_index, &conv) != kTfLiteBuiltinConv2d ||
+          conv->inputs->data[0] != node->outputs->data[0] ||
+          !IsSupportedConv(context, conv) || !NeedsIm2col(context, conv)) {
+        return false;
+      }
+      group->nodes.push_back(node_index);
+      group->patterns.push_back(kTfLiteFusionPadConv);
+    } else if (code != kTfLiteBuiltinConv2d ||
+               !IsSupportedConv(context, node)) {
+      return false;
+    }
+    group->nodes.push_back(conv_index);
+
+    if (options_.fuse_conv_add_activation) {
+      TfLiteNode* conv;
+      BuiltinCode(context, conv_index, &conv);
+      int output = conv->outputs->data[0];
+      bool fused_tail = false;
+      int next = SoleConsumer(output);
+      TfLiteNode* next_node;
+      if (IsFree(next) &&
+          BuiltinCode(context, next, &next_node) == kTfLiteBuiltinAdd &&
+          IsResidualAdd(context, next_node, output)) {
+        group->nodes.push_back(next);
+        output = next_node->outputs->data[0];
+        fused_tail = true;
+        next = SoleConsumer(output);
+      }
+      while (IsFree(next)) {
+        code = BuiltinCode(context, next, &next_node);
+        if ((code != kTfLiteBuiltinRelu && code != kTfLiteBuiltinRelu6) ||
+            !IsFloat(context, next_node->inputs->data[0])) {
+          break;
+        }
+        group->nodes.push_back(next);
+        output = next_node->outputs->data[0];
+        fused_tail = true;
+        next = SoleConsumer(output);
+      }
+      if (fused_tail) group->patterns.push_back(kTfLiteFusionConvAddActivation);
+    }
+    if (group->patterns.empty()) {
+      // A lone CONV_2D is left to the builtin kernel, and the next patterns
+      // are tried on an empty group.
+      group->nodes.clear();
+      return false;
+    }
+    return true;
+  }
+
+  // MUL by a constant followed by ADD of a constant.
+  bool MatchMulAdd(TfLiteContext* context, int node_index,
+                   FusionGroup* group) const {
+    TfLiteNode* mul;
+    if (!options_.fuse_mul_add ||
+        BuiltinCode(context, node_index, &mul) != kTfLiteBuiltinMul ||
+        reinterpret_cast<TfLiteMulParams*>(mul->builtin_data)->activation !=
+            kTfLiteActNone ||
+        !IsBroadcastWithConstant(context, mul->inputs->data[0],
+                                 mul->inputs->data[1])) {
+      return false;
+    }
+    const int mul_output = mul->outputs->data[0];
+    const int add_index = SoleConsumer(mul_output);
+    TfLiteNode* add;
+    if (!IsFree(add_index) ||
+        BuiltinCode(context, add_index, &add) != kTfLiteBuiltinAdd) {
+      return false;
+    }
+    const int shift = add->inputs->data[0] == mul_output ? add->inputs->data[1]
+                                                         : add->inputs->data[0];
+    if (!IsBroadcastWithConstant(context, mul_output, shift)) return false;
+    group->nodes = {node_index, add_index};
+    group->patterns.push_back(kTfLiteFusionMulAdd);
+    return true;
+  }
+
+  // FULLY_CONNECTED -> FULLY_CONNECTED, folded only when the product of the
+  // two weight matrices is cheaper to apply than the pair.
+  bool MatchFullyConnectedPair(TfLiteContext* context, int node_index,
+                               FusionGroup* group) const {
+    TfLiteNode* first;
+    if (!options_.fuse_fully_connected_pair ||
+        BuiltinCode(context, node_index, &first) !=
+            kTfLiteBuiltinFullyConnected ||
+        !IsFoldableFullyConnected(context, first) ||
+        reinterpret_cast<TfLiteFullyConnectedParams*>(first->builtin_data)
+                ->activation != kTfLiteActNone) {
+      return false;
+    }
+    const int second_index = SoleConsumer(first->outputs->data[0]);
+    TfLiteNode* second;
+    if (!IsFree(second_index) ||
+        BuiltinCode(context, second_index, &second) !=
+            kTfLiteBuiltinFullyConnected ||
+        second->inputs->data[0] != first->outputs->data[0] ||
+        !IsFoldableFullyConnected(context, second)) {
+      return false;
+    }
+    const TfLiteTensor* w1 = Tensor(context, first->inputs->data[1]);
+    const TfLiteTensor* w2 = Tensor(context, second->inputs->data[1]);
+    const int64_t in = SizeOfDimension(w1, 1);
+    const int64_t hidden = SizeOfDimension(w1, 0);
+    const int64_t out = SizeOfDimension(w2, 0);
+    if (SizeOfDimension(w2, 1) != hidden || out * in >= hidden * (in + out)) {
+      return false;
+    }
+    group->nodes = {node_index, second_index};
+    group->patterns.push_back(kTfLiteFusionFullyConnectedPair);
+    return true;
+  }
+
+  bool MatchTransposeChain(TfLiteContext* context, int node_index,
+                           FusionGroup* group) const {
+    TfLiteNode* node;
+    if (!options_.fuse_transpose_chain ||
+        BuiltinCode(context, node_index, &node) != kTfLiteBuiltinTranspose ||
+        !IsSupportedTranspose(context, node)) {
+      return false;
+    }
+    group->nodes.push_back(node_index);
+    int next = SoleConsumer(node->outputs->data[0]);
+    TfLiteNode* next_node;
+    while (IsFree(next) &&
+           BuiltinCode(context, next, &next_node) == kTfLiteBuiltinTranspose &&
+           IsSupportedTranspose(context, next_node)) {
+      group->nodes.push_back(next);
+      next = SoleConsumer(next_node->outputs->data[0]);
+    }
+    if (group->nodes.size() < 2) {
+      group->nodes.clear();
+      return false;
+    }
+    group->patterns.push_back(kTfLiteFusionTransposeChain);
+    return true;
+  }
+
+  // SOFTMAX -> TOPK_V2 with a constant k and int32 indices.
+  bool MatchSoftmaxTopK(TfLiteContext* context, int node_index,
+                        FusionGroup* group) const {
+    TfLiteNode* softmax;
+    if (!options_.fuse_softmax_top_k ||
+        BuiltinCode(context, node_index, &softmax) != kTfLiteBuiltinSoftmax ||
+        !IsFloat(context, softmax->inputs->data[0]) ||
+        NumDimensions(Tensor(context, softmax->inputs->data[0])) < 1 ||
+        reinterpret_cast<TfLiteSoftmaxParams*>(softmax->builtin_data)->beta <=
+            0.f) {
+      return false;
+    }
+    const int top_k_index = SoleConsumer(softmax->outputs->data[0]);
+    TfLiteNode* top_k;
+    if (!IsFree(top_k_index) ||
+        BuiltinCode(context, top_k_index, &top_k) != kTfLiteBuiltinTopkV2 ||
+        top_k->inputs->data[0] != softmax->outputs->data[0] ||
+        top_k->outputs->size != 2 ||
+        !IsConstant(context, top_k->inputs->data[1])) {
+      return false;
+    }
+    const TfLiteTensor* k = Tensor(context, top_k->inputs->data[1]);
+    if (k->type != kTfLiteInt32 || NumElements(k) != 1 ||
+        Tensor(context, top_k->outputs->data[1])->type != kTfLiteInt32) {
+      return false;
+    }
+    group->nodes = {node_index, top_k_index};
+    group->patterns.push_back(kTfLiteFusionSoftmaxTopK);
+    return true;
+  }
+
+  // Zero padding of the spatial dimensions of a float NHWC tensor.
+  static bool IsFoldablePad(TfLiteContext* context, const TfLiteNode* node) {
+    if (node->inputs->size != 2 || !IsFloat(context, node->inputs->data[0]) ||
+        !IsConstant(context, node->inputs->data[1])) {
+      return false;
+    }
+    const TfLiteTensor* paddings = Tensor(context, node->inputs->data[1]);
+    if (paddings->type != kTfLiteInt32 || NumElements(paddings) != 8 ||
+        NumDimensions(Tensor(context, node->inputs->data[0])) != 4) {
+      return false;
+    }
+    const int32_t* data = GetTensorData<int32_t>(paddings);
+    return data[0] == 0 && data[1] == 0 && data[6] == 0 && data[7] == 0 &&
+           std::all_of(data, data + 8, [](int32_t v) { return v >= 0; });
+  }
+
+  static bool IsSupportedConv(TfLiteContext* context, const TfLiteNode* node) {
+    return node->inputs->size >= 2 && IsFloat(context, node->inputs->data[0]) &&
+           IsFloat(context, node->inputs->data[1]) &&
+           IsConstant(context, node->inputs->data[1]) &&
+           NumDimensions(Tensor(context, node->inputs->data[1])) == 4 &&
+           (node->inputs->size < 3 ||
+            IsOptionalConstantFloat(context, node->inputs->data[2]));
+  }
+
+  // 1x1 stride-1 convolutions skip im2col, which is what applies the padding.
+  static bool NeedsIm2col(TfLiteContext* context, const TfLiteNode* node) {
+    const auto* params =
+        reinterpret_cast<const TfLiteConvParams*>(node->builtin_data);
+    const TfLiteTensor* filter = Tensor(context, node->inputs->data[1]);
+    return params->stride_width != 1 || params->stride_height != 1 ||
+           params->dilation_width_factor != 1 ||
+           params->dilation_height_factor != 1 ||
+           SizeOfDimension(filter, 1) != 1 || SizeOfDimension(filter, 2) != 1;
+  }
+
+  static bool IsResidualAdd(TfLiteContext* context, const TfLiteNode* add,
+                            int conv_output) {
+    const int residual = add->inputs->data[0] == conv_output
+                             ? add->inputs->data[1]
+                             : add->inputs->data[0];
+    return residual != conv_output && IsFloat(context, residual) &&
+           SameDims(Tensor(context, residual), Tensor(context, conv_output));
+  }
+
+  static bool IsBroadcastWithConstant(TfLiteContext* context, int lhs,
+                                      int rhs) {
+    if (!IsFloat(context, lhs) || !IsFloat(context, rhs)) return false;
+    if (IsConstant(context, lhs)) std::swap(lhs, rhs);
+    return !IsConstant(context, lhs) && IsConstant(context, rhs) &&
+           IsBroadcastableOperand(Tensor(context, lhs), Tensor(context, rhs));
+  }
+
+  static bool IsFoldableFullyConnected(TfLiteContext* context,
+                                       const TfLiteNode* node) {
+    const auto* params =
+        reinterpret_cast<const TfLiteFullyConnectedParams*>(node->builtin_data);
+    return node->inputs->size >= 2 && node->outputs->size == 1 &&
+           !params->keep_num_dims &&
+           params->weights_format ==
+               kTfLiteFullyConnectedWeightsFormatDefault &&
+           IsFloat(context, node->inputs->data[0]) &&
+           IsFloat(context, node->inputs->data[1]) &&
+           IsConstant(context, node->inputs->data[1]) &&
+           NumDimensions(Tensor(context, node->inputs->data[1])) == 2 &&
+           (node->inputs->size < 3 ||
+            IsOptionalConstantFloat(context, node->inputs->data[2]));
+  }
+
+  static bool IsSupportedTranspose(TfLiteContext* context,
+                                   const TfLiteNode* node) {
+    return IsFloat(context, node->inputs->data[0]) &&
+           IsConstant(context, node->inputs->data[1]) &&
+           Tensor(context, node->inputs->data[1])->type == kTfLiteInt32;
+  }
+
+  const FusionDelegateOptions options_;
+  std::vector<FusionGroup> groups_;
+  std::unordered_map<int, size_t> group_of_node_;
+  std::set<const TfLiteNode*> claimed_nodes_;
+  // Consumers of every tensor; only valid during Initialize().
+  std::vector<std::vector<int>> consumers_;
+  int fusion_counts_[kTfLiteFusionNumPatterns] = {};
+};
+
+// Runs the nodes of one partition. A group is executed as a single fused op
+// when the partitioner kept all of its nodes together and none of its
+// intermediate tensors is needed outside the partition; otherwise its nodes
+// are run one by one.
+class FusionDelegateKernel : public SimpleDelegateKernelInterface {
+ public:
+  explicit FusionDelegateKernel(FusionDelegate* delegate)
+      : delegate_(delegate) {}
+
+  TfLiteStatus Init(TfLiteContext* context,
+                    const TfLiteDelegateParams* params) override {
+    const std::set<int> nodes(
+        params->nodes_to_replace->data,
+        params->nodes_to_replace->data + params->nodes_to_replace->size);
+    partition_outputs_ = std::set<int>(
+        params->output_tensors->data,
+        params->output_tensors->data + params->output_tensors->size);
+
+    std::map<const FusionGroup*, bool> fused;
+    for (int node_index : nodes) {
+      const FusionGroup* group = delegate_->GroupOf(node_index);
+      TF_LITE_ENSURE(context, group != nullptr);
+      auto it = fused.find(group);
+      if (it == fused.end()) {
+        it = fused.emplace(group, CanFuse(context, *group, nodes)).first;
+      }
+      std::unique_ptr<FusedOp> op;
+      if (!it->second) {
+        op = CreateOp(context, {node_index});
+      } else if (node_index == group->nodes.back()) {
+        // Run the group at its last node, once every input is available.
+        op = CreateOp(context, group->nodes);
+        delegate_->RecordFusion(*group);
+      } else {
+        continue;
+      }
+      TF_LITE_ENSURE(context, op != nullptr);
+      ops_.push_back(std::move(op));
+    }
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) override {
+    for (auto& op : ops_) {
+      TF_LITE_ENSURE_STATUS(op->Prepare(context, partition_outputs_));
+    }
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) override {
+    for (auto& op : ops_) {
+      TF_LITE_ENSURE_STATUS(op->Eval(context));
+    }
+    return kTfLiteOk;
+  }
+
+ private:
+  bool CanFuse(TfLiteContext* context, const FusionGroup& group,
+               const std::set<int>& nodes) const {
+    for (size_t i = 0; i < group.nodes.size(); ++i) {
+      if (nodes.count(group.nodes[i]) == 0) return false;
+      if (i + 1 == group.nodes.size()) break;
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      context->GetNodeAndRegistration(context, group.nodes[i], &node,
+                                      &registration);
+      if (partition_outputs_.count(node->outputs->data[0])) return false;
+    }
+    return true;
+  }
+
+  FusionDelegate* const delegate_;
+  std::set<int> partition_outputs_;
+  std::vector<std::unique_ptr<FusedOp>> ops_;
+};
+
+std::unique_ptr<SimpleDelegateKernelInterface>
+FusionDelegate::CreateDelegateKernelInterface() {
+  return std::make_unique<FusionDelegateKernel>(this);
+}
+
+}  // namespace fusion
+}  // namespace tflite
+
+FusionDelegateOptions TfLiteFusionDelegateOptionsDefault() {
+  FusionDelegateOptions options = {0};
+  options.fuse_pad_conv = true;
+  options.fuse_conv_add_activation = true;
+  options.fuse_mul_add = true;
+  options.fuse_fully_connected_pair = true;
+  options.fuse_transpose_chain = true;
+  options.fuse_softmax_top_k = true;
+  return options;
+}
+
+// Creates a new delegate instance that need to be destroyed with
+// `TfLiteFusionDelegateDelete` when delegate is no longer used by TFLite.
+// When `options` is set to `nullptr`, the above default values are used:
+TfLiteDelegate* TfLiteFusionDelegateCreate(
+    const FusionDelegateOptions* options) {
+  std::unique_ptr<tflite::fusion::FusionDelegate> fusion(
+      new tflite::fusion::FusionDelegate(
+          options ? *options : TfLiteFusionDelegateOptionsDefault()));
+  return tflite::TfLiteDelegateFactory::CreateSimpleDelegate(std::move(fusion));
+}
+
+// Destroys a delegate created with `TfLiteFusionDelegateCreate` call.
+void TfLiteFusionDelegateDelete(TfLiteDelegate* delegate) {
+  tflite::TfLiteDelegateFactory::DeleteSimpleDelegate(delegate);
+}
+
+int TfLiteFusionDelegateGetFusionCount(const TfLiteDelegate* delegate,
+                                       TfLiteFusionPattern pattern) {
+  if (delegate == nullptr || pattern < 0 ||
+      pattern >= kTfLiteFusionNumPatterns) {
+    return 0;
+  }
+  // The factory stores the SimpleDelegateInterface, cast down from it.
+  return static_cast<const tflite::fusion::FusionDelegate*>(
+             static_cast<const tflite::SimpleDelegateInterface*>(
+                 delegate->data_))
+      ->FusionCount(pattern);
+}
+
+const char* TfLiteFusionPatternName(TfLiteFusionPattern pattern) {
+  switch (pattern) {
+    case kTfLiteFusionPadConv:
+      return "PAD+CONV_2D";
+    case kTfLiteFusionConvAddActivation:
+      return "CONV_2D+ADD+ACTIVATION";
+    case kTfLiteFusionMulAdd:
+      return "MUL+ADD";
+    case kTfLiteFusionFullyConnectedPair:
+      return "FULLY_CONNECTED+FULLY_CONNECTED";
+    case kTfLiteFusionTransposeChain:
+      return "TRANSPOSE+TRANSPOSE";
+    case kTfLiteFusionSoftmaxTopK:
+      return "SOFTMAX+TOPK_V2";
+    default:
+      return "unknown";
+  }
+}
@@ -0,0 +1,96 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_UTILS_FUSION_DELEGATE_FUSION_DELEGATE_H_
+#define TENSORFLOW_LITE_DELEGATES_UTILS_FUSION_DELEGATE_FUSION_DELEGATE_H_
+
+#include <memory>
+
+#include "tensorflow/lite/c/common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Operator patterns the fusion delegate knows how to rewrite. All of them are
+// float32 only.
+typedef enum {
+  // PAD -> CONV_2D: the explicit zero padding is folded into the convolution
+  // padding, so the padded input is never materialized.
+  kTfLiteFusionPadConv = 0,
+  // CONV_2D -> ADD (residual) and/or -> RELU/RELU6: the residual add and the
+  // activation are applied on the convolution output in place.
+  kTfLiteFusionConvAddActivation,
+  // MUL (constant) -> ADD (constant), e.g. unfolded batch-norm: a single
+  // scale-and-shift pass.
+  kTfLiteFusionMulAdd,
+  // FULLY_CONNECTED -> FULLY_CONNECTED without activation in between: the two
+  // weight matrices are multiplied once at prepare time.
+  kTfLiteFusionFullyConnectedPair,
+  // TRANSPOSE -> TRANSPOSE -> ...: the permutations are composed and applied
+  // once.
+  kTfLiteFusionTransposeChain,
+  // SOFTMAX -> TOPK_V2 with a constant k, e.g. a classifier head: the
+  // probabilities of a row are ranked in a per-row buffer and only the top k
+  // are written.
+  kTfLiteFusionSoftmaxTopK,
+  kTfLiteFusionNumPatterns,
+} TfLiteFusionPattern;
+
+typedef struct {
+  // Enables the individual patterns listed in `TfLiteFusionPattern`.
+  bool fuse_pad_conv;
+  bool fuse_conv_add_activation;
+  bool fuse_mul_add;
+  bool fuse_fully_connected_pair;
+  bool fuse_transpose_chain;
+  bool fuse_softmax_top_k;
+  // Logs the fusions that fired once the delegate has been applied.
+  bool log_report;
+} FusionDelegateOptions;
+
+// Returns a structure with the default delegate options: all patterns enabled,
+// no logging.
+FusionDelegateOptions TfLiteFusionDelegateOptionsDefault();
+
+// Creates a new delegate instance that needs to be destroyed with
+// `TfLiteFusionDelegateDelete` when delegate is no longer used by TFLite.
+// When `options` is set to `nullptr`, the above default values are used.
+TfLiteDelegate* TfLiteFusionDelegateCreate(
+    const FusionDelegateOptions* options);
+
+// Destroys a delegate created with `TfLiteFusionDelegateCreate` call.
+void TfLiteFusionDelegateDelete(TfLiteDelegate* delegate);
+
+// Returns how many instances of `pattern` were fused the last time `delegate`
+// was applied to a graph.
+int TfLiteFusionDelegateGetFusionCount(const TfLiteDelegate* delegate,
+                                       TfLiteFusionPattern pattern);
+
+// Returns the name used for `pattern` in the fusion report.
+const char* TfLiteFusionPatternName(TfLiteFusionPattern pattern);
+#ifdef __cplusplus
+}
+#endif  // __cplusplus
+
+// A convenient wrapper that returns C++ std::unique_ptr for automatic memory
+// management.
+inline std::unique_ptr<TfLiteDelegate, void (*)(TfLiteDelegate*)>
+TfLiteFusionDelegateCreateUnique(const FusionDelegateOptions* options) {
+  return std::unique_ptr<TfLiteDelegate, void (*)(TfLiteDelegate*)>(
+      TfLiteFusionDelegateCreate(options), TfLiteFusionDelegateDelete);
+}
+
+#endif  // TENSORFLOW_LITE_DELEGATES_UTILS_FUSION_DELEGATE_FUSION_DELEGATE_H_
@@ -0,0 +1,66 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <string>
+
+#include "tensorflow/lite/delegates/utils/fusion_delegate/fusion_delegate.h"
+#include "tensorflow/lite/tools/delegates/delegate_provider.h"
+
+namespace tflite {
+namespace tools {
+
+class FusionDelegateProvider : public DelegateProvider {
+ public:
+  FusionDelegateProvider() {
+    default_params_.AddParam("use_fusion_delegate",
+                             ToolParam::Create<bool>(false));
+  }
+
+  std::vector<Flag> CreateFlags(ToolParams* params) const final;
+
+  void LogParams(const ToolParams& params, bool verbose) const final;
+
+  TfLiteDelegatePtr CreateTfLiteDelegate(const ToolParams& params) const final;
+
+  std::string GetName() const final { return "FusionDelegate"; }
+};
+REGISTER_DELEGATE_PROVIDER(FusionDelegateProvider);
+
+std::vector<Flag> FusionDelegateProvider::CreateFlags(
+    ToolParams* params) const {
+  std::vector<Flag> flags = {
+      CreateFlag<bool>("use_fusion_delegate", params,
+                       "use the operator fusion delegate.")};
+  return flags;
+}
+
+void FusionDelegateProvider::LogParams(const ToolParams& params,
+                                       bool verbose) const {
+  LOG_TOOL_PARAM(params, bool, "use_fusion_delegate",
+                 "Use operator fusion delegate", verbose);
+}
+
+TfLiteDelegatePtr FusionDelegateProvider::CreateTfLiteDelegate(
+    const ToolParams& params) const {
+  if (params.Get<bool>("use_fusion_delegate")) {
+    auto options = TfLiteFusionDelegateOptionsDefault();
+    // Tools print which fusions fired.
+    options.log_report = true;
+    return TfLiteFusionDelegateCreateUnique(&options);
+  }
+  return TfLiteDelegatePtr(nullptr, [](TfLiteDelegate*) {});
+}
+
+}  // namespace tools
+}  // namespace tflite
@@ -0,0 +1,481 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/utils/fusion_delegate/fusion_delegate.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/builtin_ops.h"
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+
+namespace tflite {
+namespace {
+
+// Describes a small float graph so that it can be instantiated once with the
+// builtin kernels and once with the fusion delegate applied.
+class GraphBuilder {
+ public:
+  int AddInput(const std::vector<int>& shape) {
+    inputs_.push_back(AddTensor(shape, kTfLiteFloat32, nullptr, 0));
+    return inputs_.back();
+  }
+
+  int AddTensor(const std::vector<int>& shape,
+                TfLiteType type = kTfLiteFloat32) {
+    return AddTensor(shape, type, nullptr, 0);
+  }
+
+  int AddConstant(const std::vector<int>& shape) {
+    std::vector<float> data(ShapeSize(shape));
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (float& value : data) value = dist(rng_);
+    return AddConstant(shape, data);
+  }
+
+  int AddConstant(const std::vector<int>& shape,
+                  const std::vector<float>& data) {
+    buffers_.emplace_back(reinterpret_cast<const char*>(data.data()),
+                          data.size() * sizeof(float));
+    return AddTensor(shape, kTfLiteFloat32, buffers_.back().data(),
+                     buffers_.back().size());
+  }
+
+  int AddInt32Constant(const std::vector<int>& shape,
+                       const std::vector<int32_t>& data) {
+    buffers_.emplace_back(reinterpret_cast<const char*>(data.data()),
+                          data.size() * sizeof(int32_t));
+    return AddTensor(shape, kTfLiteInt32, buffers_.back().data(),
+                     buffers_.back().size());
+  }
+
+  template <typename Params>
+  void AddNode(TfLiteBuiltinOperator op, const std::vector<int>& inputs,
+               const std::vector<int>& outputs, const Params& params) {
+    nodes_.push_back({op, inputs, outputs, [params]() {
+                        void* data = malloc(sizeof(Params));
+                        std::memcpy(data, &params, sizeof(Params));
+                        return data;
+                      }});
+  }
+
+  void AddNode(TfLiteBuiltinOperator op, const std::vector<int>& inputs,
+               const std::vector<int>& outputs) {
+    nodes_.push_back({op, inputs, outputs, []() { return nullptr; }});
+  }
+
+  void SetOutputs(const std::vector<int>& outputs) { outputs_ = outputs; }
+
+  // Feeds `values` to `input` instead of pseudo-random ones.
+  void SetInputValues(int input, const std::vector<float>& values) {
+    input_values_[input] = values;
+  }
+
+  std::unique_ptr<Interpreter> Build() const {
+    std::unique_ptr<Interpreter> interpreter(new Interpreter);
+    interpreter->AddTensors(tensors_.size());
+    interpreter->SetInputs(inputs_);
+    interpreter->SetOutputs(outputs_);
+    for (size_t i = 0; i < tensors_.size(); ++i) {
+      const TensorDef& tensor = tensors_[i];
+      TfLiteQuantization quant = {kTfLiteNoQuantization, nullptr};
+      if (tensor.buffer) {
+        interpreter->SetTensorParametersReadOnly(
+            i, tensor.type, "", tensor.shape, quant, tensor.buffer,
+            tensor.bytes);
+      } else {
+        interpreter->SetTensorParametersReadWrite(i, tensor.type, "",
+                                                  tensor.shape, quant);
+      }
+    }
+    ops::builtin::BuiltinOpResolver resolver;
+    for (const NodeDef& node : nodes_) {
+      const TfLiteRegistration* registration =
+          resolver.FindOp(static_cast<BuiltinOperator>(node.op), 1);
+      interpreter->AddNodeWithParameters(node.inputs, node.outputs, nullptr, 0,
+                                         node.make_params(), registration);
+    }
+    return interpreter;
+  }
+
+  // Fills the inputs of `interpreter` with the same pseudo-random values on
+  // every call.
+  void FillInputs(Interpreter* interpreter) const {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-2.0f, 2.0f);
+    for (int input : inputs_) {
+      float* data = interpreter->typed_tensor<float>(input);
+      auto values = input_values_.find(input);
+      if (values != input_values_.end()) {
+        std::copy(values->second.begin(), values->second.end(), data);
+        continue;
+      }
+      for (int i = 0; i < ShapeSize(tensors_[input].shape); ++i) {
+        data[i] = dist(rng);
+      }
+    }
+  }
+
+ private:
+  struct TensorDef {
+    std::vector<int> shape;
+    TfLiteType type;
+    const char* buffer;
+    size_t bytes;
+  };
+  struct NodeDef {
+    TfLiteBuiltinOperator op;
+    std::vector<int> inputs;
+    std::vector<int> outputs;
+    std::function<void*()> make_params;
+  };
+
+  static int ShapeSize(const std::vector<int>& shape) {
+    int size = 1;
+    for (int dim : shape) size *= dim;
+    return size;
+  }
+
+  int AddTensor(const std::vector<int>& shape, TfLiteType type,
+                const char* buffer, size_t bytes) {
+    tensors_.push_back({shape, type, buffer, bytes});
+    return tensors_.size() - 1;
+  }
+
+  std::mt19937 rng_{1234};
+  std::vector<TensorDef> tensors_;
+  std::vector<NodeDef> nodes_;
+  std::vector<int> inputs_;
+  std::vector<int> outputs_;
+  std::map<int, std::vector<float>> input_values_;
+  // Backing storage of the constant tensors, with stable addresses.
+  std::deque<std::string> buffers_;
+};
+
+class FusionDelegateTest : public ::testing::Test {
+ protected:
+  // Runs `graph` with and without the delegate and checks that the outputs
+  // match.
+  void RunAndCompare(const GraphBuilder& graph,
+                     const FusionDelegateOptions& options) {
+    reference_ = graph.Build();
+    ASSERT_EQ(reference_->AllocateTensors(), kTfLiteOk);
+    graph.FillInputs(reference_.get());
+    ASSERT_EQ(reference_->Invoke(), kTfLiteOk);
+
+    delegate_ = TfLiteFusionDelegateCreateUnique(&options);
+    interpreter_ = graph.Build();
+    ASSERT_EQ(interpreter_->ModifyGraphWithDelegate(delegate_.get()),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+    graph.FillInputs(interpreter_.get());
+    ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+
+    for (int output : reference_->outputs()) {
+      const TfLiteTensor* expected = reference_->tensor(output);
+      const TfLiteTensor* actual = interpreter_->tensor(output);
+      ASSERT_TRUE(TfLiteIntArrayEqual(expected->dims, actual->dims));
+      ASSERT_EQ(expected->type, actual->type);
+      if (expected->type == kTfLiteInt32) {
+        EXPECT_EQ(0, std::memcmp(expected->data.raw, actual->data.raw,
+                                 expected->bytes));
+        continue;
+      }
+      const int size = expected->bytes / sizeof(float);
+      for (int i = 0; i < size; ++i) {
+        EXPECT_NEAR(expected->data.f[i], actual->data.f[i], 1e-4f) << i;
+      }
+    }
+  }
+
+  int FusionCount(TfLiteFusionPattern pattern) const {
+    return TfLiteFusionDelegateGetFusionCount(delegate_.get(), pattern);
+  }
+
+  std::unique_ptr<TfLiteDelegate, void (*)(TfLiteDelegate*)> delegate_{
+      nullptr, TfLiteFusionDelegateDelete};
+  std::unique_ptr<Interpreter> reference_;
+  std::unique_ptr<Interpreter> interpreter_;
+};
+
+TEST_F(FusionDelegateTest, PadConvAddRelu) {
+  GraphBuilder graph;
+  const int input = graph.AddInput({1, 6, 6, 3});
+  const int residual = graph.AddInput({1, 6, 6, 4});
+  const int paddings =
+      graph.AddInt32Constant({4, 2}, {0, 0, 1, 1, 1, 1, 0, 0});
+  const int filter = graph.AddConstant({4, 3, 3, 3});
+  const int bias = graph.AddConstant({4});
+  const int padded = graph.AddTensor({1, 8, 8, 3});
+  const int conv = graph.AddTensor({1, 6, 6, 4});
+  const int sum = graph.AddTensor({1, 6, 6, 4});
+  const int output = graph.AddTensor({1, 6, 6, 4});
+  graph.AddNode(kTfLiteBuiltinPad, {input, paddings}, {padded},
+                TfLitePadParams());
+  TfLiteConvParams conv_params = {kTfLitePaddingValid, 1, 1, kTfLiteActNone,
+                                  1, 1};
+  graph.AddNode(kTfLiteBuiltinConv2d, {padded, filter, bias}, {conv},
+                conv_params);
+  TfLiteAddParams add_params = {kTfLiteActNone};
+  graph.AddNode(kTfLiteBuiltinAdd, {conv, residual}, {sum}, add_params);
+  graph.AddNode(kTfLiteBuiltinRelu6, {sum}, {output});
+  graph.SetOutputs({output});
+
+  RunAndCompare(graph, TfLiteFusionDelegateOptionsDefault());
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+  EXPECT_EQ(FusionCount(kTfLiteFusionPadConv), 1);
+  EXPECT_EQ(FusionCount(kTfLiteFusionConvAddActivation), 1);
+  // The intermediate tensors are never materialized.
+  EXPECT_EQ(interpreter_->tensor(padded)->data.raw, nullptr);
+  EXPECT_EQ(interpreter_->tensor(conv)->data.raw, nullptr);
+  EXPECT_EQ(interpreter_->tensor(sum)->data.raw, nullptr);
+}
+
+TEST_F(FusionDelegateTest, MulAdd) {
+  GraphBuilder graph;
+  const int input = graph.AddInput({1, 4, 4, 8});
+  const int scale = graph.AddConstant({8});
+  const int shift = graph.AddConstant({8});
+  const int scaled = graph.AddTensor({1, 4, 4, 8});
+  const int output = graph.AddTensor({1, 4, 4, 8});
+  TfLiteMulParams mul_params = {kTfLiteActNone};
+  graph.AddNode(kTfLiteBuiltinMul, {input, scale}, {scaled}, mul_params);
+  TfLiteAddParams add_params = {kTfLiteActRelu};
+  graph.AddNode(kTfLiteBuiltinAdd, {shift, scaled}, {output}, add_params);
+  graph.SetOutputs({output});
+
+  RunAndCompare(graph, TfLiteFusionDelegateOptionsDefault());
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+  EXPECT_EQ(FusionCount(kTfLiteFusionMulAdd), 1);
+  EXPECT_EQ(interpreter_->tensor(scaled)->data.raw, nullptr);
+}
+
+// Per-channel operands are often stored with the rank of the input.
+TEST_F(FusionDelegateTest, MulAddWithChannelOperandsOfInputRank) {
+  GraphBuilder graph;
+  const int input = graph.AddInput({1, 4, 4, 8});
+  const int scale = graph.AddConstant({1, 1, 1, 8});
+  const int shift = graph.AddConstant({1, 1, 8});
+  const int scaled = graph.AddTensor({1, 4, 4, 8});
+  const int output = graph.AddTensor({1, 4, 4, 8});
+  TfLiteMulParams mul_params = {kTfLiteActNone};
+  graph.AddNode(kTfLiteBuiltinMul, {scale, input}, {scaled}, mul_params);
+  TfLiteAddParams add_params = {kTfLiteActNone};
+  graph.AddNode(kTfLiteBuiltinAdd, {scaled, shift}, {output}, add_params);
+  graph.SetOutputs({output});
+
+  RunAndCompare(graph, TfLiteFusionDelegateOptionsDefault());
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+  EXPECT_EQ(FusionCount(kTfLiteFusionMulAdd), 1);
+}
+
+// Operands that broadcast along another dimension are left to the builtin
+// kernels.
+TEST_F(FusionDelegateTest, MulAddAlongOtherDimensionIsNotFused) {
+  GraphBuilder graph;
+  const int input = graph.AddInput({1, 4, 8, 8});
+  const int scale = graph.AddConstant({8, 1});
+  const int shift = graph.AddConstant({8});
+  const int scaled = graph.AddTensor({1, 4, 8, 8});
+  const int output = graph.AddTensor({1, 4, 8, 8});
+  TfLiteMulParams mul_params = {kTfLiteActNone};
+  graph.AddNode(kTfLiteBuiltinMul, {input, scale}, {scaled}, mul_params);
+  TfLiteAddParams add_params = {kTfLiteActNone};
+  graph.AddNode(kTfLiteBuiltinAdd, {scaled, shift}, {output}, add_params);
+  graph.SetOutputs({output});
+
+  RunAndCompare(graph, TfLiteFusionDelegateOptionsDefault());
+  EXPECT_EQ(interpreter_->execution_plan().size(), 2);
+  EXPECT_EQ(FusionCount(kTfLiteFusionMulAdd), 0);
+}
+
+TEST_F(FusionDelegateTest, FullyConnectedPair) {
+  GraphBuilder graph;
+  const int input = graph.AddInput({3, 8});
+  const int weights1 = graph.AddConstant({32, 8});
+  const int bias1 = graph.AddConstant({32});
+  const int weights2 = graph.AddConstant({4, 32});
+  const int bias2 = graph.AddConstant({4});
+  const int hidden = graph.AddTensor({3, 32});
+  const int output = graph.AddTensor({3, 4});
+  TfLiteFullyConnectedParams params = {};
+  params.activation = kTfLiteActNone;
+  graph.AddNode(kTfLiteBuiltinFullyConnected, {input, weights1, bias1},
+                {hidden}, params);
+  params.activation = kTfLiteActRelu;
+  graph.AddNode(kTfLiteBuiltinFullyConnected, {hidden, weights2, bias2},
+                {output}, params);
+  graph.SetOutputs({output});
+
+  RunAndCompare(graph, TfLiteFusionDelegateOptionsDefault());
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+  EXPECT_EQ(FusionCount(kTfLiteFusionFullyConnectedPair), 1);
+}
+
+TEST_F(FusionDelegateTest, TransposeChain) {
+  GraphBuilder graph;
+  const int input = graph.AddInput({2, 3, 4, 5});
+  const int perm1 = graph.AddInt32Constant({4}, {0, 2, 3, 1});
+  const int perm2 = graph.AddInt32Constant({4}, {3, 1, 0, 2});
+  const int perm3 = graph.AddInt32Constant({4}, {1, 0, 3, 2});
+  const int first = graph.AddTensor({2, 4, 5, 3});
+  const int second = graph.AddTensor({3, 4, 2, 5});
+  const int output = graph.AddTensor({4, 3, 5, 2});
+  TfLiteTransposeParams params = {};
+  graph.AddNode(kTfLiteBuiltinTranspose, {input, perm1}, {first}, params);
+  graph.AddNode(kTfLiteBuiltinTranspose, {first, perm2}, {second}, params);
+  graph.AddNode(kTfLiteBuiltinTranspose, {second, perm3}, {output}, params);
+  graph.SetOutputs({output});
+
+  RunAndCompare(graph, TfLiteFusionDelegateOptionsDefault());
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+  EXPECT_EQ(FusionCount(kTfLiteFusionTransposeChain), 1);
+}
+
+TEST_F(FusionDelegateTest, SoftmaxTopK) {
+  GraphBuilder graph;
+  const int input = graph.AddInput({3, 1000});
+  const int k = graph.AddInt32Constant({}, {5});
+  const int probabilities = graph.AddTensor({3, 1000});
+  const int values = graph.AddTensor({3, 5});
+  const int indices = graph.AddTensor({3, 5}, kTfLiteInt32);
+  TfLiteSoftmaxParams params = {0.5f};
+  graph.AddNode(kTfLiteBuiltinSoftmax, {input}, {probabilities}, params);
+  graph.AddNode(kTfLiteBuiltinTopkV2, {probabilities, k}, {values, indices});
+  graph.SetOutputs({values, indices});
+
+  RunAndCompare(graph, TfLiteFusionDelegateOptionsDefault());
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+  EXPECT_EQ(FusionCount(kTfLiteFusionSoftmaxTopK), 1);
+  EXPECT_EQ(interpreter_->tensor(probabilities)->data.raw, nullptr);
+}
+
+// Equal probabilities rank by lower index, as in TOPK_V2, including those of
+// distinct logits that underflow.
+TEST_F(FusionDelegateTest, SoftmaxTopKTies) {
+  GraphBuilder graph;
+  const int input = graph.AddInput({2, 6});
+  graph.SetInputValues(input, {0.5f, 2.f, 0.5f, 2.f, 0.5f, 1.f,  //
+                               -300.f, -120.f, 0.f, -200.f, 1.f, -150.f});
+  const int k = graph.AddInt32Constant({}, {4});
+  const int probabilities = graph.AddTensor({2, 6});
+  const int values = graph.AddTensor({2, 4});
+  const int indices = graph.AddTensor({2, 4}, kTfLiteInt32);
+  TfLiteSoftmaxParams params = {1.0f};
+  graph.AddNode(kTfLiteBuiltinSoftmax, {input}, {probabilities}, params);
+  graph.AddNode(kTfLiteBuiltinTopkV2, {probabilities, k}, {values, indices});
+  graph.SetOutputs({values, indices});
+
+  RunAndCompare(graph, TfLiteFusionDelegateOptionsDefault());
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+  EXPECT_EQ(FusionCount(kTfLiteFusionSoftmaxTopK), 1);
+  const int32_t* top = interpreter_->typed_tensor<int32_t>(indices);
+  EXPECT_EQ(std::vector<int32_t>(top, top + 8),
+            std::vector<int32_t>({1, 3, 5, 0, 4, 2, 0, 1}));
+}
+
+TEST_F(FusionDelegateTest, SoftmaxTopKWithProbabilitiesOutput) {
+  GraphBuilder graph;
+  const int input = graph.AddInput({2, 64});
+  const int k = graph.AddInt32Constant({1}, {3});
+  const int probabilities = graph.AddTensor({2, 64});
+  const int values = graph.AddTensor({2, 3});
+  const int indices = graph.AddTensor({2, 3}, kTfLiteInt32);
+  TfLiteSoftmaxParams params = {1.0f};
+  graph.AddNode(kTfLiteBuiltinSoftmax, {input}, {probabilities}, params);
+  graph.AddNode(kTfLiteBuiltinTopkV2, {probabilities, k}, {values, indices});
+  graph.SetOutputs({probabilities, values, indices});
+
+  RunAndCompare(graph, TfLiteFusionDelegateOptionsDefault());
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+  EXPECT_EQ(FusionCount(kTfLiteFusionSoftmaxTopK), 0);
+}
+
+TEST_F(FusionDelegateTest, UnfusedSoftmaxMatchesBuiltin) {
+  GraphBuilder graph;
+  const int input = graph.AddInput({2, 64});
+  const int k = graph.AddInt32Constant({1}, {3});
+  const int probabilities = graph.AddTensor({2, 64});
+  const int values = graph.AddTensor({2, 3});
+  const int indices = graph.AddTensor({2, 3}, kTfLiteInt32);
+  TfLiteSoftmaxParams params = {1.0f};
+  graph.AddNode(kTfLiteBuiltinSoftmax, {input}, {probabilities}, params);
+  graph.AddNode(kTfLiteBuiltinTopkV2, {probabilities, k}, {values, indices});
+  graph.SetOutputs({probabilities, values, indices});
+
+  RunAndCompare(graph, TfLiteFusionDelegateOptionsDefault());
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+  const TfLiteTensor* expected = reference_->tensor(probabilities);
+  const TfLiteTensor* actual = interpreter_->tensor(probabilities);
+  EXPECT_EQ(0, std::memcmp(expected->data.raw, actual->data.raw,
+                           expected->bytes));
+}
+
+TEST_F(FusionDelegateTest, IntermediateGraphOutputIsNotFused) {
+  GraphBuilder graph;
+  const int input = graph.AddInput({1, 5, 5, 2});
+  const int residual = graph.AddInput({1, 5, 5, 3});
+  const int filter = graph.AddConstant({3, 3, 3, 2});
+  const int bias = graph.AddConstant({3});
+  const int conv = graph.AddTensor({1, 5, 5, 3});
+  const int output = graph.AddTensor({1, 5, 5, 3});
+  TfLiteConvParams conv_params = {kTfLitePaddingSame, 1, 1, kTfLiteActNone,
+                                  1, 1};
+  graph.AddNode(kTfLiteBuiltinConv2d, {input, filter, bias}, {conv},
+                conv_params);
+  TfLiteAddParams add_params = {kTfLiteActRelu};
+  graph.AddNode(kTfLiteBuiltinAdd, {residual, conv}, {output}, add_params);
+  // The convolution output is read by the caller, so it must be kept.
+  graph.SetOutputs({conv, output});
+
+  RunAndCompare(graph, TfLiteFusionDelegateOptionsDefault());
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+  EXPECT_EQ(FusionCount(kTfLiteFusionConvAddActivation), 0);
+}
+
+TEST_F(FusionDelegateTest, DisabledPatternsAreNotDelegated) {
+  GraphBuilder graph;
+  const int input = graph.AddInput({1, 4, 4, 8});
+  const int scale = graph.AddConstant({8});
+  const int shift = graph.AddConstant({8});
+  const int scaled = graph.AddTensor({1, 4, 4, 8});
+  const int output = graph.AddTensor({1, 4, 4, 8});
+  TfLiteMulParams mul_params = {kTfLiteActNone};
+  graph.AddNode(kTfLiteBuiltinMul, {input, scale}, {scaled}, mul_params);
+  TfLiteAddParams add_params = {kTfLiteActNone};
+  graph.AddNode(kTfLiteBuiltinAdd, {scaled, shift}, {output}, add_params);
+  graph.SetOutputs({output});
+
+  FusionDelegateOptions options = TfLiteFusionDelegateOptionsDefault();
+  options.fuse_mul_add = false;
+  RunAndCompare(graph, options);
+  ASSERT_EQ(interpreter_->execution_plan().size(), 2);
+  EXPECT_EQ(FusionCount(kTfLiteFusionMulAdd), 0);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -0,0 +1,250 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/dynamic_memory_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace tflite {
+namespace {
+
+constexpr size_t kMinSizeClass = 64;
+// kMinSizeClass, then four size classes per power of two up to SIZE_MAX.
+constexpr int kNumSizeClasses = 1 + 4 * (8 * sizeof(size_t) - 6);
+constexpr size_t kInitialInUseSlots = 64;
+
+size_t HashPointer(const void* pointer) {
+  // Buffers are at least 16 byte aligned, drop the low bits before mixing.
+  const uint64_t value = reinterpret_cast<uintptr_t>(pointer) >> 4;
+  return static_cast<size_t>(value * 0x9E3779B97F4A7C15ull >> 16);
+}
+
+}  // namespace
+
+DynamicMemoryPool::DynamicMemoryPool()
+    : in_use_(kInitialInUseSlots, InUseBuffer{nullptr, 0}),
+      cache_(kNumSizeClasses) {
+  magic = kTfLiteDynamicAllocatorMagic;
+  Realloc = &DynamicMemoryPool::ReallocTensor;
+  Free = &DynamicMemoryPool::FreeTensor;
+}
+
+DynamicMemoryPool::~DynamicMemoryPool() { ReleaseCachedMemory(); }
+
+size_t DynamicMemoryPool::SizeClass(size_t num_bytes) {
+  if (num_bytes <= kMinSizeClass) return kMinSizeClass;
+  // Four size classes per power of two, so that less than a fifth of a buffer
+  // is unused.
+  size_t step = kMinSizeClass / 4;
+  while (step * 8 < num_bytes) step *= 2;
+  return (num_bytes + step - 1) / step * step;
+}
+
+int DynamicMemoryPool::SizeClassIndex(size_t size_class) {
+  if (size_class <= kMinSizeClass) return 0;
+  size_t step = kMinSizeClass / 4;
+  int octave = 0;
+  while (step * 8 < size_class) {
+    step *= 2;
+    ++octave;
+  }
+  // The size classes of an octave are 5, 6, 7 and 8 steps.
+  return 1 + 4 * octave + static_cast<int>(size_class / step) - 5;
+}
+
+size_t DynamicMemoryPool::SizeClassAt(int index) {
+  if (index == 0) return kMinSizeClass;
+  const size_t step = (kMinSizeClass / 4) << ((index - 1) / 4);
+  return ((index - 1) % 4 + 5) * step;
+}
+
+const DynamicMemoryPool::InUseBuffer* DynamicMemoryPool::FindInUse(
+    const void* buffer) const {
+  const size_t mask = in_use_.size() - 1;
+  for (size_t i = HashPointer(buffer) & mask;; i = (i + 1) & mask) {
+    if (in_use_[i].buffer == buffer) return &in_use_[i];
+    if (in_use_[i].buffer == nullptr) return nullptr;
+  }
+}
+
+DynamicMemoryPool::InUseBuffer* DynamicMemoryPool::FindInUse(
+    const void* buffer) {
+  return const_cast<InUseBuffer*>(
+      static_cast<const DynamicMemoryPool*>(this)->FindInUse(buffer));
+}
+
+void DynamicMemoryPool::AddInUse(void* buffer, size_t size_class) {
+  if (2 * (num_in_use_ + 1) > in_use_.size()) {
+    std::vector<InUseBuffer> old_in_use(2 * in_use_.size(),
+                                        InUseBuffer{nullptr, 0});
+    old_in_use.swap(in_use_);
+    num_in_use_ = 0;
+    for (const InUseBuffer& slot : old_in_use) {
+      if (slot.buffer) AddInUse(slot.buffer, slot.size_class);
+    }
+  }
+  const size_t mask = in_use_.size() - 1;
+  size_t i = HashPointer(buffer) & mask;
+  while (in_use_[i].buffer != nullptr) i = (i + 1) & mask;
+  in_use_[i] = {buffer, size_class};
+  ++num_in_use_;
+}
+
+void DynamicMemoryPool::RemoveInUse(InUseBuffer* slot) {
+  // Shifts back the entries probing past the removed one, so that lookups
+  // need no tombstones.
+  const size_t mask = in_use_.size() - 1;
+  size_t hole = slot - in_use_.data();
+  for (size_t i = (hole + 1) & mask; in_use_[i].buffer != nullptr;
+       i = (i + 1) & mask) {
+    const size_t home = HashPointer(in_use_[i].buffer) & mask;
+    // Move the entry into the hole unless its home slot lies cyclically in
+    // (hole, i].
+    if (((i - home) & mask) >= ((i - hole) & mask)) {
+      in_use_[hole] = in_use_[i];
+      hole = i;
+    }
+  }
+  in_use_[hole] = {nullptr, 0};
+  --num_in_use_;
+}
+
+bool DynamicMemoryPool::CanResize(const TfLiteTensor& tensor,
+                                  size_t num_bytes) const {
+  size_t capacity = 0;
+  if (tensor.data.raw) {
+    const InUseBuffer* slot = FindInUse(tensor.data.raw);
+    capacity = slot ? slot->size_class : tensor.bytes;
+    if (num_bytes <= capacity) return true;
+    // The outgrown buffer is cached, or freed if the pool did not allocate
+    // it.
+    if (!slot) capacity = 0;
+  }
+  if (max_bytes_ == 0) return true;
+  return stats_.in_use_bytes - capacity + SizeClass(num_bytes) <= max_bytes_;
+}
+
+void DynamicMemoryPool::ReleaseCachedMemory() {
+  for (std::vector<void*>& buffers : cache_) {
+    for (void* buffer : buffers) free(buffer);
+    buffers.clear();
+  }
+  stats_.cached_bytes = 0;
+}
+
+TfLiteStatus DynamicMemoryPool::ReallocTensor(
+    TfLiteDynamicAllocator* allocator, size_t num_bytes, TfLiteTensor* tensor) {
+  return static_cast<DynamicMemoryPool*>(allocator)->ReallocImpl(num_bytes,
+                                                                 tensor);
+}
+
+void DynamicMemoryPool::FreeTensor(TfLiteDynamicAllocator* allocator,
+                                   TfLiteTensor* tensor) {
+  if (tensor->data.raw) {
+    static_cast<DynamicMemoryPool*>(allocator)->Release(tensor->data.raw);
+  }
+  tensor->data.raw = nullptr;
+}
+
+TfLiteStatus DynamicMemoryPool::ReallocImpl(size_t num_bytes,
+                                            TfLiteTensor* tensor) {
+  void* data = tensor->data.raw;
+  if (data) {
+    const InUseBuffer* slot = FindInUse(data);
+    const size_t capacity = slot ? slot->size_class : tensor->bytes;
+    if (num_bytes <= capacity) {
+      tensor->bytes = num_bytes;
+      return kTfLiteOk;
+    }
+  }
+  // Every caller of TfLiteTensorRealloc gets here, e.g. the string kernels
+  // writing through DynamicBuffer, so the limit is enforced here.
+  if (!CanResize(*tensor, num_bytes)) return kTfLiteError;
+  void* buffer = Allocate(SizeClass(num_bytes));
+  if (!buffer) return kTfLiteError;
+  if (data) {
+    // The buffer only grows, so all of the current data fits.
+    memcpy(buffer, data, tensor->bytes);
+    Release(data);
+  }
+  tensor->data.raw = static_cast<char*>(buffer);
+  tensor->bytes = num_bytes;
+  return kTfLiteOk;
+}
+
+void* DynamicMemoryPool::Allocate(size_t size_class) {
+  void* buffer = nullptr;
+  std::vector<void*>& cached = cache_[SizeClassIndex(size_class)];
+  if (!cached.empty()) {
+    buffer = cached.back();
+    cached.pop_back();
+    stats_.cached_bytes -= size_class;
+    ++stats_.num_reuses;
+  } else {
+    MakeRoom(size_class);
+    buffer = malloc(size_class);
+    if (!buffer && stats_.cached_bytes > 0) {
+      ReleaseCachedMemory();
+      buffer = malloc(size_class);
+    }
+    if (!buffer) return nullptr;
+    ++stats_.num_allocations;
+  }
+  AddInUse(buffer, size_class);
+  stats_.in_use_bytes += size_class;
+  stats_.high_water_mark_bytes =
+      std::max(stats_.high_water_mark_bytes,
+               stats_.in_use_bytes + stats_.cached_bytes);
+  return buffer;
+}
+
+void DynamicMemoryPool::Release(void* buffer) {
+  InUseBuffer* slot = FindInUse(buffer);
+  if (!slot) {
+    free(buffer);
+    return;
+  }
+  const size_t size_class = slot->size_class;
+  RemoveInUse(slot);
+  stats_.in_use_bytes -= size_class;
+  // Only exceeds the limit if it was lowered since the buffer was allocated.
+  if (max_bytes_ != 0 &&
+      stats_.in_use_bytes + stats_.cached_bytes + size_class > max_bytes_) {
+    free(buffer);
+    return;
+  }
+  cache_[SizeClassIndex(size_class)].push_back(buffer);
+  stats_.cached_bytes += size_class;
+}
+
+void DynamicMemoryPool::MakeRoom(size_t num_bytes) {
+  if (max_bytes_ == 0) return;
+  for (int index = kNumSizeClasses - 1;
+       index >= 0 && stats_.cached_bytes > 0 &&
+       stats_.in_use_bytes + stats_.cached_bytes + num_bytes > max_bytes_;
+       --index) {
+    std::vector<void*>& cached = cache_[index];
+    while (!cached.empty() &&
+           stats_.in_use_bytes + stats_.cached_bytes + num_bytes > max_bytes_) {
+      free(cached.back());
+      cached.pop_back();
+      stats_.cached_bytes -= SizeClassAt(index);
+    }
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,125 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_DYNAMIC_MEMORY_POOL_H_
+#define TENSORFLOW_LITE_DYNAMIC_MEMORY_POOL_H_
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+
+// Statistics of a DynamicMemoryPool, in bytes of buffer capacity.
+struct DynamicMemoryStats {
+  // Buffers holding the data of tensors.
+  size_t in_use_bytes = 0;
+  // Buffers kept for reuse.
+  size_t cached_bytes = 0;
+  // Peak of in_use_bytes + cached_bytes, i.e. of the memory held by the pool.
+  size_t high_water_mark_bytes = 0;
+  // Number of buffers allocated from the heap, and taken from the cache.
+  int64_t num_allocations = 0;
+  int64_t num_reuses = 0;
+};
+
+// Serves the data of kTfLiteDynamic tensors from buffers rounded up to a small
+// set of size classes, and keeps the buffers tensors release or outgrow for
+// reuse instead of returning them to the heap. Shapes of dynamic tensors
+// usually cycle through a few sizes across invocations, so after warming up
+// resizing them takes buffers from the cache instead of fragmenting the heap
+// with malloc/realloc of slightly different sizes.
+//
+// Tensors use the pool once their `allocation` points to it, see
+// TfLiteDynamicAllocator. Buffers the pool did not allocate, e.g. allocated
+// with malloc before the tensor used the pool, are freed when outgrown.
+// The pool must outlive the tensors using it, and is not thread-safe.
+//
+// The bookkeeping itself only allocates while the pool warms up: the tables of
+// buffers in use and cached only grow, and keep their capacity.
+class DynamicMemoryPool : public TfLiteDynamicAllocator {
+ public:
+  DynamicMemoryPool();
+  ~DynamicMemoryPool();
+
+  DynamicMemoryPool(const DynamicMemoryPool&) = delete;
+  DynamicMemoryPool& operator=(const DynamicMemoryPool&) = delete;
+
+  // Returns the capacity of the buffer serving `num_bytes`.
+  static size_t SizeClass(size_t num_bytes);
+
+  // Limits the memory held by the pool to `max_bytes`, 0 for no limit. Cached
+  // buffers are released as needed to stay within the limit, see CanResize().
+  void SetMemoryLimit(size_t max_bytes) { max_bytes_ = max_bytes; }
+  size_t memory_limit() const { return max_bytes_; }
+
+  // Returns whether resizing the data of `tensor` to `num_bytes` stays within
+  // the memory limit. Realloc() fails, leaving the tensor unchanged, when it
+  // would not.
+  bool CanResize(const TfLiteTensor& tensor, size_t num_bytes) const;
+
+  // Returns the cached buffers to the heap.
+  void ReleaseCachedMemory();
+
+  const DynamicMemoryStats& stats() const { return stats_; }
+
+ private:
+  static TfLiteStatus ReallocTensor(TfLiteDynamicAllocator* allocator,
+                                    size_t num_bytes, TfLiteTensor* tensor);
+  static void FreeTensor(TfLiteDynamicAllocator* allocator,
+                         TfLiteTensor* tensor);
+
+  // A buffer the pool allocated and that a tensor holds, or an empty slot of
+  // `in_use_` if `buffer` is null.
+  struct InUseBuffer {
+    void* buffer;
+    size_t size_class;
+  };
+
+  // Returns the index in `cache_` of the buffers of `size_class`.
+  static int SizeClassIndex(size_t size_class);
+  static size_t SizeClassAt(int index);
+
+  // Returns the slot of `buffer` in `in_use_`, or nullptr if the pool did not
+  // allocate it.
+  InUseBuffer* FindInUse(const void* buffer);
+  const InUseBuffer* FindInUse(const void* buffer) const;
+  void AddInUse(void* buffer, size_t size_class);
+  void RemoveInUse(InUseBuffer* slot);
+
+  TfLiteStatus ReallocImpl(size_t num_bytes, TfLiteTensor* tensor);
+  // Returns a buffer of `size_class` bytes, or nullptr if out of memory.
+  void* Allocate(size_t size_class);
+  // Caches `buffer` if the pool allocated it, frees it otherwise.
+  void Release(void* buffer);
+  // Releases cached buffers, largest first, until `num_bytes` more fit within
+  // the memory limit or the cache is empty.
+  void MakeRoom(size_t num_bytes);
+
+  size_t max_bytes_ = 0;
+  DynamicMemoryStats stats_;
+  // Open addressing hash table of the buffers in use, with linear probing and
+  // a power of two size kept at most half full.
+  std::vector<InUseBuffer> in_use_;
+  size_t num_in_use_ = 0;
+  // Cached buffers, indexed by SizeClassIndex().
+  std::vector<std::vector<void*>> cache_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DYNAMIC_MEMORY_POOL_H_
@@ -0,0 +1,223 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/dynamic_memory_pool.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+TfLiteTensor DynamicTensor(DynamicMemoryPool* pool) {
+  TfLiteTensor tensor = {};
+  tensor.allocation_type = kTfLiteDynamic;
+  tensor.allocation = static_cast<TfLiteDynamicAllocator*>(pool);
+  return tensor;
+}
+
+TEST(DynamicMemoryPoolTest, SizeClasses) {
+  EXPECT_EQ(DynamicMemoryPool::SizeClass(0), 64);
+  EXPECT_EQ(DynamicMemoryPool::SizeClass(64), 64);
+  EXPECT_EQ(DynamicMemoryPool::SizeClass(65), 80);
+  EXPECT_EQ(DynamicMemoryPool::SizeClass(128), 128);
+  EXPECT_EQ(DynamicMemoryPool::SizeClass(129), 160);
+  EXPECT_EQ(DynamicMemoryPool::SizeClass(1000), 1024);
+  EXPECT_EQ(DynamicMemoryPool::SizeClass(1025), 1280);
+  for (size_t bytes = 65; bytes < 100000; bytes += 7) {
+    const size_t size_class = DynamicMemoryPool::SizeClass(bytes);
+    EXPECT_GE(size_class, bytes);
+    EXPECT_LT(size_class - bytes, size_class / 5) << bytes;
+  }
+}
+
+TEST(DynamicMemoryPoolTest, GrowsWithinCapacityInPlace) {
+  DynamicMemoryPool pool;
+  TfLiteTensor tensor = DynamicTensor(&pool);
+  TfLiteTensorRealloc(100, &tensor);
+  ASSERT_NE(tensor.data.raw, nullptr);
+  EXPECT_EQ(tensor.bytes, 100);
+  memset(tensor.data.raw, 7, 100);
+  char* data = tensor.data.raw;
+
+  TfLiteTensorRealloc(10, &tensor);
+  TfLiteTensorRealloc(112, &tensor);
+  EXPECT_EQ(tensor.data.raw, data);
+  EXPECT_EQ(tensor.bytes, 112);
+
+  TfLiteTensorRealloc(113, &tensor);
+  EXPECT_NE(tensor.data.raw, data);
+  for (int i = 0; i < 10; ++i) EXPECT_EQ(tensor.data.raw[i], 7);
+  EXPECT_EQ(pool.stats().in_use_bytes, 128);
+  EXPECT_EQ(pool.stats().cached_bytes, 112);
+  EXPECT_EQ(pool.stats().num_allocations, 2);
+
+  TfLiteTensorFree(&tensor);
+  EXPECT_EQ(tensor.data.raw, nullptr);
+  EXPECT_EQ(pool.stats().in_use_bytes, 0);
+  EXPECT_EQ(pool.stats().cached_bytes, 240);
+  EXPECT_EQ(pool.stats().high_water_mark_bytes, 240);
+}
+
+TEST(DynamicMemoryPoolTest, ReusesCachedBuffers) {
+  DynamicMemoryPool pool;
+  TfLiteTensor a = DynamicTensor(&pool);
+  TfLiteTensor b = DynamicTensor(&pool);
+  // Cycle through the same shapes as an op producing a dynamic output would.
+  for (int i = 0; i < 10; ++i) {
+    TfLiteTensorRealloc(1000, &a);
+    TfLiteTensorRealloc(3000, &b);
+    TfLiteTensorDataFree(&a);
+    TfLiteTensorRealloc(1000 + i, &b);
+    TfLiteTensorDataFree(&b);
+  }
+  EXPECT_EQ(pool.stats().num_allocations, 2);
+  EXPECT_EQ(pool.stats().num_reuses, 18);
+  EXPECT_EQ(pool.stats().in_use_bytes, 0);
+  EXPECT_EQ(pool.stats().high_water_mark_bytes, 1024 + 3072);
+
+  pool.ReleaseCachedMemory();
+  EXPECT_EQ(pool.stats().cached_bytes, 0);
+  TfLiteTensorRealloc(1000, &a);
+  EXPECT_EQ(pool.stats().num_allocations, 3);
+  TfLiteTensorFree(&a);
+}
+
+TEST(DynamicMemoryPoolTest, TracksManyTensors) {
+  DynamicMemoryPool pool;
+  std::vector<TfLiteTensor> tensors(500, DynamicTensor(&pool));
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    TfLiteTensorRealloc(100 + i, &tensors[i]);
+    memset(tensors[i].data.raw, i % 128, tensors[i].bytes);
+  }
+  // Frees every other tensor, then reallocates them, so that buffers leave
+  // and rejoin the middle of the table of buffers in use.
+  for (size_t i = 0; i < tensors.size(); i += 2) {
+    TfLiteTensorDataFree(&tensors[i]);
+  }
+  const size_t num_allocations = pool.stats().num_allocations;
+  for (size_t i = 0; i < tensors.size(); i += 2) {
+    TfLiteTensorRealloc(100 + i, &tensors[i]);
+    memset(tensors[i].data.raw, i % 128, tensors[i].bytes);
+  }
+  EXPECT_EQ(pool.stats().num_allocations, num_allocations);
+  EXPECT_EQ(pool.stats().cached_bytes, 0);
+
+  size_t in_use_bytes = 0;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    // Grows within the size class, so the pool must still find the buffer.
+    char* data = tensors[i].data.raw;
+    const size_t size_class = DynamicMemoryPool::SizeClass(100 + i);
+    TfLiteTensorRealloc(size_class, &tensors[i]);
+    EXPECT_EQ(tensors[i].data.raw, data) << i;
+    EXPECT_EQ(tensors[i].data.raw[99], static_cast<char>(i % 128)) << i;
+    in_use_bytes += size_class;
+  }
+  EXPECT_EQ(pool.stats().in_use_bytes, in_use_bytes);
+  for (TfLiteTensor& tensor : tensors) TfLiteTensorFree(&tensor);
+  EXPECT_EQ(pool.stats().in_use_bytes, 0);
+  EXPECT_EQ(pool.stats().cached_bytes, in_use_bytes);
+}
+
+TEST(DynamicMemoryPoolTest, AdoptsMallocBuffers) {
+  DynamicMemoryPool pool;
+  TfLiteTensor tensor = DynamicTensor(&pool);
+  tensor.data.raw = static_cast<char*>(malloc(20));
+  tensor.bytes = 20;
+  memcpy(tensor.data.raw, "0123456789abcdefghij", 20);
+
+  TfLiteTensorRealloc(16, &tensor);
+  EXPECT_EQ(pool.stats().num_allocations, 0);
+  TfLiteTensorRealloc(200, &tensor);
+  EXPECT_EQ(memcmp(tensor.data.raw, "0123456789abcdef", 16), 0);
+  EXPECT_EQ(pool.stats().in_use_bytes, 224);
+  // The malloc'ed buffer is freed rather than cached.
+  EXPECT_EQ(pool.stats().cached_bytes, 0);
+  TfLiteTensorFree(&tensor);
+}
+
+TEST(DynamicMemoryPoolTest, MemoryLimit) {
+  DynamicMemoryPool pool;
+  pool.SetMemoryLimit(4096);
+  TfLiteTensor a = DynamicTensor(&pool);
+  TfLiteTensor b = DynamicTensor(&pool);
+  EXPECT_TRUE(pool.CanResize(a, 3000));
+  TfLiteTensorRealloc(3000, &a);
+  EXPECT_FALSE(pool.CanResize(b, 2000));
+  EXPECT_TRUE(pool.CanResize(b, 1000));
+  // Realloc enforces the limit itself and leaves the tensor unchanged.
+  EXPECT_EQ(TfLiteTensorRealloc(2000, &b), kTfLiteError);
+  EXPECT_EQ(b.data.raw, nullptr);
+  EXPECT_EQ(b.bytes, 0);
+  const char* a_data = a.data.raw;
+  EXPECT_EQ(TfLiteTensorRealloc(4097, &a), kTfLiteError);
+  EXPECT_EQ(a.data.raw, a_data);
+  EXPECT_EQ(a.bytes, 3000);
+  // Outgrown buffers do not count, they can be released.
+  EXPECT_TRUE(pool.CanResize(a, 4000));
+  EXPECT_FALSE(pool.CanResize(a, 4097));
+
+  // Caching the buffer of `a` would exceed the limit, so it is released.
+  TfLiteTensorRealloc(4000, &a);
+  EXPECT_EQ(pool.stats().in_use_bytes, 4096);
+  TfLiteTensorDataFree(&a);
+  EXPECT_EQ(pool.stats().cached_bytes, 4096);
+
+  // Cached buffers are released to make room.
+  TfLiteTensorRealloc(1000, &b);
+  EXPECT_EQ(pool.stats().cached_bytes, 0);
+  EXPECT_LE(pool.stats().in_use_bytes + pool.stats().cached_bytes, 4096);
+  TfLiteTensorFree(&b);
+}
+
+TEST(DynamicMemoryPoolTest, IgnoresOtherTensors) {
+  DynamicMemoryPool pool;
+  TfLiteTensor tensor = DynamicTensor(&pool);
+  tensor.allocation_type = kTfLiteArenaRw;
+  TfLiteTensorRealloc(100, &tensor);
+  EXPECT_EQ(tensor.data.raw, nullptr);
+
+  tensor.allocation_type = kTfLitePersistentRo;
+  TfLiteTensorRealloc(100, &tensor);
+  EXPECT_NE(tensor.data.raw, nullptr);
+  EXPECT_EQ(pool.stats().num_allocations, 0);
+  TfLiteTensorFree(&tensor);
+}
+
+TEST(DynamicMemoryPoolTest, IgnoresUntaggedAllocations) {
+  // A dynamic tensor whose allocation is not a TfLiteDynamicAllocator, e.g.
+  // one set by a delegate, is reallocated with malloc.
+  int not_an_allocator[4] = {};
+  TfLiteTensor tensor = {};
+  tensor.allocation_type = kTfLiteDynamic;
+  tensor.allocation = not_an_allocator;
+  EXPECT_EQ(TfLiteTensorRealloc(100, &tensor), kTfLiteOk);
+  EXPECT_NE(tensor.data.raw, nullptr);
+  EXPECT_EQ(tensor.bytes, 100);
+  TfLiteTensorDataFree(&tensor);
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -17,11 +17,8 @@ limitations under the License.
 #define TENSORFLOW_LITE_EXAMPLES_LABEL_IMAGE_BITMAP_HELPERS_IMPL_H_
 
 #include "tensorflow/lite/examples/label_image/label_image.h"
-
-#include "tensorflow/lite/builtin_op_data.h"
-#include "tensorflow/lite/interpreter.h"
-#include "tensorflow/lite/kernels/register.h"
-#include "tensorflow/lite/string_util.h"
+#include "tensorflow/lite/examples/label_image/log.h"
+#include "tensorflow/lite/tools/evaluation/stages/utils/image_preprocessing.h"
 
 namespace tflite {
 namespace label_image {
@@ -30,72 +27,31 @@ template <class T>
 void resize(T* out, uint8_t* in, int image_height, int image_width,
             int image_channels, int wanted_height, int wanted_width,
             int wanted_channels, Settings* s) {
-  int number_of_pixels = image_height * image_width * image_channels;
-  std::unique_ptr<Interpreter> interpreter(new Interpreter);
-
-  int base_index = 0;
-
-  // two inputs: input and new_sizes
-  interpreter->AddTensors(2, &base_index);
-  // one output
-  interpreter->AddTensors(1, &base_index);
-  // set input and output tensors
-  interpreter->SetInputs({0, 1});
-  interpreter->SetOutputs({2});
-
-  // set parameters of tensors
-  TfLiteQuantizationParams quant;
-  interpreter->SetTensorParametersReadWrite(
-      0, kTfLiteFloat32, "input",
-      {1, image_height, image_width, image_channels}, quant);
-  interpreter->SetTensorParametersReadWrite(1, kTfLiteInt32, "new_size", {2},
-                                            quant);
-  interpreter->SetTensorParametersReadWrite(
-      2, kTfLiteFloat32, "output",
-      {1, wanted_height, wanted_width, wanted_channels}, quant);
-
-  ops::builtin::BuiltinOpResolver resolver;
-  const TfLiteRegistration* resize_op =
-      resolver.FindOp(BuiltinOperator_RESIZE_BILINEAR, 1);
-  auto* params = reinterpret_cast<TfLiteResizeBilinearParams*>(
-      malloc(sizeof(TfLiteResizeBilinearParams)));
-  params->align_corners = false;
-  params->half_pixel_centers = false;
-  interpreter->AddNodeWithParameters({0, 1}, {2}, nullptr, 0, params, resize_op,
-                                     nullptr);
-
-  interpreter->AllocateTensors();
-
-  // fill input image
-  // in[] are integers, cannot do memcpy() directly
-  auto input = interpreter->typed_tensor<float>(0);
-  for (int i = 0; i < number_of_pixels; i++) {
-    input[i] = in[i];
+  // Resizes, normalizes and quantizes the image in a single pass, with integer
+  // arithmetic for quantized models.
+  evaluation::image::PreprocessingParams params;
+  params.output_width = wanted_width;
+  params.output_height = wanted_height;
+  params.output_channels = wanted_channels;
+  switch (s->input_type) {
+    case kTfLiteFloat32:
+      params.mean = {s->input_mean};
+      params.scale = 1.0f / s->input_std;
+      break;
+    case kTfLiteInt8:
+      params.mean = {128.0f};
+      params.fixed_point = true;
+      break;
+    case kTfLiteUInt8:
+      params.fixed_point = true;
+      break;
+    default:
+      return;
   }
-
-  // fill new_sizes
-  interpreter->typed_tensor<int>(1)[0] = wanted_height;
-  interpreter->typed_tensor<int>(1)[1] = wanted_width;
-
-  interpreter->Invoke();
-
-  auto output = interpreter->typed_tensor<float>(2);
-  auto output_number_of_pixels = wanted_height * wanted_width * wanted_channels;
-
-  for (int i = 0; i < output_number_of_pixels; i++) {
-    switch (s->input_type) {
-      case kTfLiteFloat32:
-        out[i] = (output[i] - s->input_mean) / s->input_std;
-        break;
-      case kTfLiteInt8:
-        out[i] = static_cast<int8_t>(output[i] - 128);
-        break;
-      case kTfLiteUInt8:
-        out[i] = static_cast<uint8_t>(output[i]);
-        break;
-      default:
-        break;
-    }
+  if (evaluation::image::PreprocessImage(in, image_width, image_height,
+                                         image_channels, params,
+                                         s->input_type, out) != kTfLiteOk) {
+    LOG(ERROR) << "Failed to resize the image";
   }
 }
 
@@ -42,6 +42,7 @@ limitations under the License.
 #include "tensorflow/lite/examples/label_image/get_top_n.h"
 #include "tensorflow/lite/kernels/register.h"
 #include "tensorflow/lite/optional_debug_tools.h"
+#include "tensorflow/lite/profiling/chrome_trace_profiler.h"
 #include "tensorflow/lite/profiling/profiler.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/tools/command_line_flags.h"
@@ -350,7 +351,22 @@ void RunInference(Settings* settings,
       settings->max_profiling_buffer_entries);
   interpreter->SetProfiler(profiler.get());
 
-  if (settings->profiling) profiler->StartProfiling();
+  // The trace replaces the per-op profile: the interpreter takes one profiler.
+  std::ofstream trace_file;
+  std::unique_ptr<profiling::ChromeTraceProfiler> trace_profiler;
+  if (!settings->chrome_trace_file.empty()) {
+    trace_file.open(settings->chrome_trace_file);
+    if (!trace_file) {
+      LOG(ERROR) << "Failed to open " << settings->chrome_trace_file;
+      exit(-1);
+    }
+    trace_profiler =
+        absl::make_unique<profiling::ChromeTraceProfiler>(&trace_file);
+    interpreter->SetProfiler(trace_profiler.get());
+    trace_profiler->StartProfiling();
+  } else if (settings->profiling) {
+    profiler->StartProfiling();
+  }
   if (settings->loop_count > 1) {
     for (int i = 0; i < settings->number_of_warmup_runs; i++) {
       if (interpreter->Invoke() != kTfLiteOk) {
@@ -375,7 +391,11 @@ void RunInference(Settings* settings,
                    (settings->loop_count * 1000)
             << " ms";
 
-  if (settings->profiling) {
+  if (trace_profiler) {
+    interpreter->SetProfiler(nullptr);
+    trace_profiler->Finish();
+    LOG(INFO) << "Chrome trace written to " << settings->chrome_trace_file;
+  } else if (settings->profiling) {
     profiler->StopProfiling();
     auto profile_events = profiler->GetProfileEvents();
     for (int i = 0; i < profile_events.size(); i++) {
@@ -439,6 +459,8 @@ void display_usage() {
       << "label_image\n"
       << "--accelerated, -a: [0|1], use Android NNAPI or not\n"
       << "--allow_fp16, -f: [0|1], allow running fp32 models with fp16 or not\n"
+      << "--chrome_trace_file, -k: write a Chrome trace of all invokes to this "
+         "file\n"
       << "--count, -c: loop interpreter->Invoke() for certain times\n"
       << "--gl_backend, -g: [0|1]: use GL GPU Delegate on Android\n"
       << "--hexagon_delegate, -j: [0|1]: use Hexagon Delegate on Android\n"
@@ -485,13 +507,14 @@ int Main(int argc, char** argv) {
         {"gl_backend", required_argument, nullptr, 'g'},
         {"hexagon_delegate", required_argument, nullptr, 'j'},
         {"xnnpack_delegate", required_argument, nullptr, 'x'},
+        {"chrome_trace_file", required_argument, nullptr, 'k'},
         {nullptr, 0, nullptr, 0}};
 
     /* getopt_long stores the option index here. */
     int option_index = 0;
 
     c = getopt_long(argc, argv,
-                    "a:b:c:d:e:f:g:i:j:l:m:p:r:s:t:v:w:x:", long_options,
+                    "a:b:c:d:e:f:g:i:j:k:l:m:p:r:s:t:v:w:x:", long_options,
                     &option_index);
 
     /* Detect the end of the options. */
@@ -526,6 +549,9 @@ int Main(int argc, char** argv) {
       case 'j':
         s.hexagon_delegate = optarg;
         break;
+      case 'k':
+        s.chrome_trace_file = optarg;
+        break;
       case 'l':
         s.labels_file_name = optarg;
         break;
@@ -41,6 +41,7 @@ struct Settings {
   int number_of_threads = 4;
   int number_of_results = 5;
   int max_profiling_buffer_entries = 1024;
+  string chrome_trace_file;
   int number_of_warmup_runs = 2;
 };
 
@@ -12,9 +12,13 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <vector>
+
 #include "flatbuffers/flexbuffers.h"  // from @flatbuffers
 #include "tensorflow/lite/context.h"
 #include "tensorflow/lite/experimental/microfrontend/lib/frontend.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_batch.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_batch_util.h"
 #include "tensorflow/lite/experimental/microfrontend/lib/frontend_util.h"
 #include "tensorflow/lite/kernels/internal/tensor.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
@@ -29,7 +33,16 @@ constexpr int kOutputTensor = 0;
 
 typedef struct {
   int sample_rate;
+  FrontendConfig config;
   FrontendState* state;
+  // Processes all streams of a [num_samples, num_streams] input at once.
+  // Populated in Prepare, for the number of streams of the input.
+  FrontendBatchState* batch_state;
+  // Frames of each stream of a 2-D input, [num_streams][num_frames]
+  // [num_channels], sized in Prepare so that Eval does not allocate. Only the
+  // one of the output type is used.
+  std::vector<std::vector<std::vector<float>>> float_frame_buffers;
+  std::vector<std::vector<std::vector<int32>>> int_frame_buffers;
   int left_context;
   int right_context;
   int frame_stride;
@@ -46,7 +59,7 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
 
   data->sample_rate = m["sample_rate"].AsInt32();
 
-  struct FrontendConfig config;
+  struct FrontendConfig& config = data->config;
   config.window.size_ms = m["window_size"].AsInt32();
   config.window.step_size_ms = m["window_step"].AsInt32();
   config.filterbank.num_channels = m["num_channels"].AsInt32();
@@ -66,6 +79,7 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
 
   data->state = new FrontendState;
   FrontendPopulateState(&config, data->state, data->sample_rate);
+  data->batch_state = nullptr;
 
   data->left_context = m["left_context"].AsInt32();
   data->right_context = m["right_context"].AsInt32();
@@ -77,10 +91,39 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   return data;
 }
 
+template <typename T>
+std::vector<std::vector<std::vector<T>>>* GetFrameBuffers(
+    TfLiteAudioMicrofrontendParams* data);
+
+template <>
+std::vector<std::vector<std::vector<float>>>* GetFrameBuffers<float>(
+    TfLiteAudioMicrofrontendParams* data) {
+  return &data->float_frame_buffers;
+}
+
+template <>
+std::vector<std::vector<std::vector<int32>>>* GetFrameBuffers<int32>(
+    TfLiteAudioMicrofrontendParams* data) {
+  return &data->int_frame_buffers;
+}
+
+template <typename T>
+void ResizeFrameBuffers(TfLiteAudioMicrofrontendParams* data, int num_frames) {
+  const FrontendBatchState* state = data->batch_state;
+  GetFrameBuffers<T>(data)->assign(
+      state->num_streams,
+      std::vector<std::vector<T>>(
+          num_frames, std::vector<T>(state->filterbank.num_channels)));
+}
+
 void Free(TfLiteContext* context, void* buffer) {
   auto* data = reinterpret_cast<TfLiteAudioMicrofrontendParams*>(buffer);
   FrontendFreeStateContents(data->state);
   delete data->state;
+  if (data->batch_state != nullptr) {
+    FrontendBatchFreeStateContents(data->batch_state);
+    delete data->batch_state;
+  }
   delete data;
 }
 
@@ -97,7 +140,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_OK(context,
                     GetOutputSafe(context, node, kOutputTensor, &output));
 
-  TF_LITE_ENSURE_EQ(context, NumDimensions(input), 1);
+  const int num_dims = NumDimensions(input);
+  TF_LITE_ENSURE(context, num_dims == 1 || num_dims == 2);
 
   TF_LITE_ENSURE_EQ(context, input->type, kTfLiteInt16);
   output->type = kTfLiteInt32;
@@ -105,20 +149,95 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     output->type = kTfLiteFloat32;
   }
 
-  TfLiteIntArray* output_size = TfLiteIntArrayCreate(2);
+  if (num_dims == 2) {
+    const int num_streams = input->dims->data[1];
+    TF_LITE_ENSURE(context, num_streams > 0);
+    if (data->batch_state != nullptr &&
+        data->batch_state->num_streams != num_streams) {
+      FrontendBatchFreeStateContents(data->batch_state);
+      delete data->batch_state;
+      data->batch_state = nullptr;
+    }
+    if (data->batch_state == nullptr) {
+      data->batch_state = new FrontendBatchState;
+      if (!FrontendBatchPopulateState(&data->config, data->batch_state,
+                                      data->sample_rate, num_streams)) {
+        FrontendBatchFreeStateContents(data->batch_state);
+        delete data->batch_state;
+        data->batch_state = nullptr;
+        context->ReportError(context,
+                             "Failed to populate frontend for %d streams.",
+                             num_streams);
+        return kTfLiteError;
+      }
+    }
+
+    const int input_size = input->dims->data[0];
+    const FrontendBatchState* state = data->batch_state;
+    const int num_frames =
+        input_size >= state->window.size
+            ? (input_size - state->window.size) / state->window.step + 1
+            : 0;
+    data->float_frame_buffers.clear();
+    data->int_frame_buffers.clear();
+    if (data->out_float) {
+      ResizeFrameBuffers<float>(data, num_frames);
+    } else {
+      ResizeFrameBuffers<int32>(data, num_frames);
+    }
+  }
+
   int num_frames = 0;
   if (input->dims->data[0] >= data->state->window.size) {
     num_frames = (input->dims->data[0] - data->state->window.size) /
                      data->state->window.step / data->frame_stride +
                  1;
   }
-  output_size->data[0] = num_frames;
-  output_size->data[1] = data->state->filterbank.num_channels *
-                         (1 + data->left_context + data->right_context);
+  const int num_features = data->state->filterbank.num_channels *
+                           (1 + data->left_context + data->right_context);
+
+  TfLiteIntArray* output_size = TfLiteIntArrayCreate(num_dims + 1);
+  if (num_dims == 1) {
+    output_size->data[0] = num_frames;
+    output_size->data[1] = num_features;
+  } else {
+    output_size->data[0] = input->dims->data[1];
+    output_size->data[1] = num_frames;
+    output_size->data[2] = num_features;
+  }
 
   return context->ResizeTensor(context, output, output_size);
 }
 
+// Writes the frames with their left and right context to `output`, and returns
+// the end of what was written.
+template <typename T>
+T* StackFrames(TfLiteAudioMicrofrontendParams* data,
+               const std::vector<std::vector<T>>& frame_buffer, T* output) {
+  std::vector<T> pad(data->state->filterbank.num_channels, 0);
+  int anchor;
+  for (anchor = 0; anchor < frame_buffer.size(); anchor += data->frame_stride) {
+    int frame;
+    for (frame = anchor - data->left_context;
+         frame <= anchor + data->right_context; ++frame) {
+      const std::vector<T>* feature;
+      if (data->zero_padding && (frame < 0 || frame >= frame_buffer.size())) {
+        feature = &pad;
+      } else if (frame < 0) {
+        feature = &frame_buffer[0];
+      } else if (frame >= frame_buffer.size()) {
+        feature = &frame_buffer[frame_buffer.size() - 1];
+      } else {
+        feature = &frame_buffer[frame];
+      }
+      for (auto f : *feature) {
+        *output++ = f;
+      }
+    }
+  }
+  return output;
+}
+
 template <typename T>
 void GenerateFeatures(TfLiteAudioMicrofrontendParams* data,
                       const TfLiteTensor* input, TfLiteTensor* output) {
@@ -154,34 +273,55 @@ void GenerateFeatures(TfLiteAudioMicrofrontendParams* data,
     }
   }
 
-  int index = 0;
-  std::vector<T> pad(data->state->filterbank.num_channels, 0);
-  int anchor;
-  for (anchor = 0; anchor < frame_buffer.size(); anchor += data->frame_stride) {
-    int frame;
-    for (frame = anchor - data->left_context;
-         frame <= anchor + data->right_context; ++frame) {
-      std::vector<T>* feature;
-      if (data->zero_padding && (frame < 0 || frame >= frame_buffer.size())) {
-        feature = &pad;
-      } else if (frame < 0) {
-        feature = &frame_buffer[0];
-      } else if (frame >= frame_buffer.size()) {
-        feature = &frame_buffer[frame_buffer.size() - 1];
-      } else {
-        feature = &frame_buffer[frame];
-      }
-      for (auto f : *feature) {
-        filterbanks_flat[index++] = f;
+  StackFrames(data, frame_buffer, filterbanks_flat);
+}
+
+template <typename T>
+void GenerateBatchFeatures(TfLiteAudioMicrofrontendParams* data,
+                           const TfLiteTensor* input, TfLiteTensor* output) {
+  FrontendBatchState* state = data->batch_state;
+  const int num_streams = state->num_streams;
+  const int num_channels = state->filterbank.num_channels;
+  // Interleaved as the streams of the frontend expect.
+  const int16_t* audio_data = GetTensorData<int16_t>(input);
+  int64_t audio_size = input->dims->data[0];
+
+  T* filterbanks_flat = GetTensorData<T>(output);
+
+  // Sized in Prepare.
+  std::vector<std::vector<std::vector<T>>>& frame_buffers =
+      *GetFrameBuffers<T>(data);
+
+  int frame_index = 0;
+  while (audio_size > 0) {
+    size_t num_samples_read;
+    struct FrontendOutput output = FrontendBatchProcessSamples(
+        state, audio_data, audio_size, &num_samples_read);
+    audio_data += num_samples_read * num_streams;
+    audio_size -= num_samples_read;
+
+    if (output.values != nullptr) {
+      int stream;
+      for (stream = 0; stream < num_streams; ++stream) {
+        const uint16_t* values = output.values + stream * num_channels;
+        std::vector<T>& frame = frame_buffers[stream][frame_index];
+        int i;
+        for (i = 0; i < num_channels; ++i) {
+          frame[i] = static_cast<T>(values[i]) / data->out_scale;
+        }
       }
+      ++frame_index;
     }
   }
+
+  for (const auto& frame_buffer : frame_buffers) {
+    filterbanks_flat = StackFrames(data, frame_buffer, filterbanks_flat);
+  }
 }
 
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   auto* data =
       reinterpret_cast<TfLiteAudioMicrofrontendParams*>(node->user_data);
-  FrontendReset(data->state);
 
   const TfLiteTensor* input;
   TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kInputTensor, &input));
@@ -189,10 +329,20 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_OK(context,
                     GetOutputSafe(context, node, kOutputTensor, &output));
 
-  if (data->out_float) {
-    GenerateFeatures<float>(data, input, output);
+  if (NumDimensions(input) == 2) {
+    FrontendBatchReset(data->batch_state);
+    if (data->out_float) {
+      GenerateBatchFeatures<float>(data, input, output);
+    } else {
+      GenerateBatchFeatures<int32>(data, input, output);
+    }
   } else {
-    GenerateFeatures<int32>(data, input, output);
+    FrontendReset(data->state);
+    if (data->out_float) {
+      GenerateFeatures<float>(data, input, output);
+    } else {
+      GenerateFeatures<int32>(data, input, output);
+    }
   }
 
   return kTfLiteOk;
@@ -88,6 +88,7 @@ class MicroFrontendOpModel : public SingleOpModel {
   }
 
   std::vector<int> GetOutput() { return ExtractVector<int>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
 
   int num_inputs() { return n_input_; }
   int num_frmes() { return n_frame_; }
@@ -193,6 +194,33 @@ TEST_F(TwoConsecutive36InputsMicroFrontendTest, MicroFrontendBlackBoxTest) {
                 &micro_frontend);
 }
 
+TEST_F(TwoConsecutive36InputsMicroFrontendTest, MultipleStreams) {
+  const int n_input = 36;
+  const int n_streams = 3;
+  MicroFrontendOpModel micro_frontend(n_input, 2, 2, 1, 1, 1,
+                                      {
+                                          {n_input, n_streams},
+                                      });
+  std::vector<int16_t> input;
+  for (int16_t sample : micro_frontend_input_) {
+    input.insert(input.end(), n_streams, sample);
+  }
+  micro_frontend.SetInput(input);
+  micro_frontend.Invoke();
+
+  EXPECT_THAT(micro_frontend.GetOutputShape(),
+              ElementsAreArray({n_streams, 2, 6}));
+  // The batched FFT rounds slightly differently from the single stream one.
+  const std::vector<int> expected = {0,   0,   479, 425, 436, 378,
+                                     479, 425, 436, 378, 0,   0};
+  const std::vector<int> output = micro_frontend.GetOutput();
+  for (int stream = 0; stream < n_streams; ++stream) {
+    for (int i = 0; i < expected.size(); ++i) {
+      EXPECT_NEAR(output[stream * expected.size() + i], expected[i], 2);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace custom
 }  // namespace ops
@@ -0,0 +1,209 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/microfrontend/lib/fft_radix4.h"
+
+#include <string.h>
+
+static inline int16_t Saturate16(int32_t value) {
+  if (value > INT16_MAX) {
+    return INT16_MAX;
+  }
+  if (value < INT16_MIN) {
+    return INT16_MIN;
+  }
+  return (int16_t)value;
+}
+
+// Divides by 4 and rounds.
+static inline int16_t Quarter(int32_t value) {
+  return Saturate16((value + 2) >> 2);
+}
+
+static inline int16_t ScaleSample(int16_t sample, int shift) {
+  return (int16_t)((uint16_t)sample << shift);
+}
+
+// Packs pairs of real samples into complex samples, in the digit-reversed
+// order the decimation in time stages expect.
+static void LoadInput(struct FftRadix4State* state, const int16_t* input,
+                      const int* input_scale_shifts) {
+  const int num_streams = state->num_streams;
+  const size_t complex_size = state->fft_size / 2;
+  const size_t input_size = state->input_size;
+  size_t i;
+  int s;
+  for (i = 0; i < complex_size; ++i) {
+    struct complex_int16_t* work =
+        state->work + state->input_positions[i] * num_streams;
+    const int16_t* real = input + 2 * i * num_streams;
+    const int16_t* imag = real + num_streams;
+    if (2 * i + 1 < input_size) {
+      for (s = 0; s < num_streams; ++s) {
+        work[s].real = ScaleSample(real[s], input_scale_shifts[s]);
+        work[s].imag = ScaleSample(imag[s], input_scale_shifts[s]);
+      }
+    } else if (2 * i < input_size) {
+      for (s = 0; s < num_streams; ++s) {
+        work[s].real = ScaleSample(real[s], input_scale_shifts[s]);
+        work[s].imag = 0;
+      }
+    } else {
+      memset(work, 0, num_streams * sizeof(*work));
+    }
+  }
+}
+
+// Combines pairs of 1 point FFTs, so it needs no twiddles.
+static void Radix2Stage(struct complex_int16_t* work, size_t size,
+                        int num_streams) {
+  size_t i;
+  int s;
+  for (i = 0; i < size; i += 2) {
+    struct complex_int16_t* x0 = work + i * num_streams;
+    struct complex_int16_t* x1 = x0 + num_streams;
+    for (s = 0; s < num_streams; ++s) {
+      const int32_t a0_real = x0[s].real;
+      const int32_t a0_imag = x0[s].imag;
+      const int32_t a1_real = x1[s].real;
+      const int32_t a1_imag = x1[s].imag;
+      x0[s].real = Saturate16((a0_real + a1_real + 1) >> 1);
+      x0[s].imag = Saturate16((a0_imag + a1_imag + 1) >> 1);
+      x1[s].real = Saturate16((a0_real - a1_real + 1) >> 1);
+      x1[s].imag = Saturate16((a0_imag - a1_imag + 1) >> 1);
+    }
+  }
+}
+
+// Combines groups of 4 FFTs of `span` points into FFTs of 4 * span points.
+static void Radix4Stage(struct complex_int16_t* work, size_t size, size_t span,
+                        const struct complex_int16_t* twiddles,
+                        int num_streams) {
+  const size_t stride = span * num_streams;
+  size_t block;
+  size_t n;
+  int s;
+  for (block = 0; block < size; block += 4 * span) {
+    for (n = 0; n < span; ++n) {
+      const int32_t w1_real = twiddles[3 * n].real;
+      const int32_t w1_imag = twiddles[3 * n].imag;
+      const int32_t w2_real = twiddles[3 * n + 1].real;
+      const int32_t w2_imag = twiddles[3 * n + 1].imag;
+      const int32_t w3_real = twiddles[3 * n + 2].real;
+      const int32_t w3_imag = twiddles[3 * n + 2].imag;
+      struct complex_int16_t* x0 = work + (block + n) * num_streams;
+      struct complex_int16_t* x1 = x0 + stride;
+      struct complex_int16_t* x2 = x1 + stride;
+      struct complex_int16_t* x3 = x2 + stride;
+      for (s = 0; s < num_streams; ++s) {
+        const int32_t a0_real = x0[s].real;
+        const int32_t a0_imag = x0[s].imag;
+        const int32_t b1_real =
+            (x1[s].real * w1_real - x1[s].imag * w1_imag + (1 << 14)) >> 15;
+        const int32_t b1_imag =
+            (x1[s].real * w1_imag + x1[s].imag * w1_real + (1 << 14)) >> 15;
+        const int32_t b2_real =
+            (x2[s].real * w2_real - x2[s].imag * w2_imag + (1 << 14)) >> 15;
+        const int32_t b2_imag =
+            (x2[s].real * w2_imag + x2[s].imag * w2_real + (1 << 14)) >> 15;
+        const int32_t b3_real =
+            (x3[s].real * w3_real - x3[s].imag * w3_imag + (1 << 14)) >> 15;
+        const int32_t b3_imag =
+            (x3[s].real * w3_imag + x3[s].imag * w3_real + (1 << 14)) >> 15;
+
+        const int32_t t0_real = a0_real + b2_real;
+        const int32_t t0_imag = a0_imag + b2_imag;
+        const int32_t t1_real = a0_real - b2_real;
+        const int32_t t1_imag = a0_imag - b2_imag;
+        const int32_t t2_real = b1_real + b3_real;
+        const int32_t t2_imag = b1_imag + b3_imag;
+        const int32_t t3_real = b1_real - b3_real;
+        const int32_t t3_imag = b1_imag - b3_imag;
+
+        x0[s].real = Quarter(t0_real + t2_real);
+        x0[s].imag = Quarter(t0_imag + t2_imag);
+        // Multiplying by -i and i.
+        x1[s].real = Quarter(t1_real + t3_imag);
+        x1[s].imag = Quarter(t1_imag - t3_real);
+        x2[s].real = Quarter(t0_real - t2_real);
+        x2[s].imag = Quarter(t0_imag - t2_imag);
+        x3[s].real = Quarter(t1_real - t3_imag);
+        x3[s].imag = Quarter(t1_imag + t3_real);
+      }
+    }
+  }
+}
+
+// Turns the FFT Z of the complex samples z[n] = x[2n] + i * x[2n + 1] into the
+// FFT of the real samples x:
+//   X[k] = (Z[k] + conj(Z[N - k]) - i * W^k * (Z[k] - conj(Z[N - k]))) / 2
+// with N the size of Z, and W the twiddle of the real FFT.
+static void SplitOutput(struct FftRadix4State* state) {
+  const int num_streams = state->num_streams;
+  const size_t complex_size = state->fft_size / 2;
+  size_t k;
+  int s;
+  for (k = 0; k <= complex_size; ++k) {
+    const struct complex_int16_t* z =
+        state->work + (k == complex_size ? 0 : k) * num_streams;
+    const struct complex_int16_t* z_mirror =
+        state->work + (k == 0 ? 0 : complex_size - k) * num_streams;
+    const int32_t w_real = state->split_twiddles[k].real;
+    const int32_t w_imag = state->split_twiddles[k].imag;
+    struct complex_int16_t* output = state->output + k * num_streams;
+    for (s = 0; s < num_streams; ++s) {
+      const int32_t f1_real = z[s].real + z_mirror[s].real;
+      const int32_t f1_imag = z[s].imag - z_mirror[s].imag;
+      const int32_t f2_real = z[s].imag + z_mirror[s].imag;
+      const int32_t f2_imag = z_mirror[s].real - z[s].real;
+      const int32_t t_real =
+          (f2_real * w_real - f2_imag * w_imag + (1 << 14)) >> 15;
+      const int32_t t_imag =
+          (f2_real * w_imag + f2_imag * w_real + (1 << 14)) >> 15;
+      // Both Z[k] and the output are scaled by 1 / N, hence dividing by 4.
+      output[s].real = Quarter(f1_real + t_real);
+      output[s].imag = Quarter(f1_imag + t_imag);
+    }
+  }
+}
+
+void FftRadix4Compute(struct FftRadix4State* state, const int16_t* input,
+                      const int* input_scale_shifts) {
+  const size_t complex_size = state->fft_size / 2;
+  LoadInput(state, input, input_scale_shifts);
+
+  const struct complex_int16_t* twiddles = state->twiddles;
+  size_t span = 1;
+  int stage;
+  for (stage = 0; stage < state->num_stages; ++stage) {
+    if (state->stage_radix[stage] == 2) {
+      Radix2Stage(state->work, complex_size, state->num_streams);
+    } else {
+      Radix4Stage(state->work, complex_size, span, twiddles,
+                  state->num_streams);
+      twiddles += 3 * span;
+    }
+    span *= state->stage_radix[stage];
+  }
+
+  SplitOutput(state);
+}
+
+void FftRadix4Reset(struct FftRadix4State* state) {
+  memset(state->work, 0,
+         state->fft_size / 2 * state->num_streams * sizeof(*state->work));
+  memset(state->output, 0,
+         (state->fft_size / 2 + 1) * state->num_streams *
+             sizeof(*state->output));
+}
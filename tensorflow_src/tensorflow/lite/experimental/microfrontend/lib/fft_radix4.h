@@ -0,0 +1,69 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FFT_RADIX4_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FFT_RADIX4_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/fft.h"
+
+#define kFftRadix4MaxStages 16
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fixed point real FFT of `num_streams` streams at once, using only 16x16 bit
+// multiplies so that it is fast on cores without SIMD. The fft_size / 2 point
+// complex FFT runs radix-4 stages, plus a radix-2 one if fft_size / 2 is not a
+// power of 4. All streams share the twiddles, which are loaded once per
+// butterfly for all streams. Like FftCompute, every stage scales its output
+// down so that it stays within 16 bits, and the output is the DFT of the
+// input divided by fft_size.
+struct FftRadix4State {
+  size_t fft_size;
+  size_t input_size;
+  int num_streams;
+
+  int num_stages;
+  // Radix of every stage of the complex FFT, in the order they run.
+  int stage_radix[kFftRadix4MaxStages];
+  // Position of complex input sample i in the digit-reversed work buffer.
+  uint16_t* input_positions;
+  // Twiddles of all stages: (radix - 1) per butterfly column of every stage.
+  struct complex_int16_t* twiddles;
+  // Twiddles splitting the complex FFT into the real FFT, fft_size / 2 + 1.
+  struct complex_int16_t* split_twiddles;
+
+  // Interleaved buffers, holding num_streams values per element.
+  struct complex_int16_t* work;
+  struct complex_int16_t* output;
+};
+
+// Computes the FFT of the num_streams interleaved streams of input_size
+// samples in `input`, scaling up the samples of stream s by
+// input_scale_shifts[s] bits. Writes fft_size / 2 + 1 interleaved complex
+// values per stream to state->output.
+void FftRadix4Compute(struct FftRadix4State* state, const int16_t* input,
+                      const int* input_scale_shifts);
+
+void FftRadix4Reset(struct FftRadix4State* state);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FFT_RADIX4_H_
@@ -0,0 +1,147 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/microfrontend/lib/fft_radix4.h"
+
+#include <math.h>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/fft_radix4_util.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace {
+
+const int16_t kFakeWindow[] = {
+    0, 1151,   0, -5944, 0, 13311,  0, -21448, 0, 28327, 0, -32256, 0, 32255,
+    0, -28328, 0, 21447, 0, -13312, 0, 5943,   0, -1152, 0};
+const int kFakeWindowSize = sizeof(kFakeWindow) / sizeof(kFakeWindow[0]);
+
+// Fills `input` with a deterministic mix of tones and noise.
+void FillTestSignal(int16_t* input, int size, int seed) {
+  unsigned int state = seed;
+  int i;
+  for (i = 0; i < size; ++i) {
+    state = state * 1103515245 + 12345;
+    const int noise = static_cast<int>((state >> 16) & 0x7ff) - 1024;
+    input[i] = 12000 * sin(0.3 * i * (seed + 1)) +
+               8000 * cos(0.07 * i + seed) + noise;
+  }
+}
+
+// Checks the FFT of `input` against a double precision DFT divided by the
+// FFT size.
+void CheckAgainstDft(int size, int16_t tolerance) {
+  int16_t input[1024];
+  FillTestSignal(input, size, size);
+
+  struct FftRadix4State state;
+  TF_LITE_MICRO_EXPECT(FftRadix4PopulateState(&state, size, 1));
+  const int scale_shift = 0;
+  FftRadix4Compute(&state, input, &scale_shift);
+
+  const int fft_size = state.fft_size;
+  int k;
+  for (k = 0; k <= fft_size / 2; ++k) {
+    double real = 0;
+    double imag = 0;
+    int n;
+    for (n = 0; n < size; ++n) {
+      const double angle = 2 * M_PI * k * n / fft_size;
+      real += input[n] * cos(angle);
+      imag -= input[n] * sin(angle);
+    }
+    TF_LITE_MICRO_EXPECT_NEAR(state.output[k].real, real / fft_size,
+                              tolerance);
+    TF_LITE_MICRO_EXPECT_NEAR(state.output[k].imag, imag / fft_size,
+                              tolerance);
+  }
+
+  FftRadix4FreeStateContents(&state);
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(FftRadix4Test_CheckOutputValues) {
+  struct FftRadix4State state;
+  TF_LITE_MICRO_EXPECT(FftRadix4PopulateState(&state, kFakeWindowSize, 1));
+  TF_LITE_MICRO_EXPECT_EQ(state.fft_size, 32);
+
+  const int scale_shift = 0;
+  FftRadix4Compute(&state, kFakeWindow, &scale_shift);
+
+  // The values FftCompute produces, the rounding differs slightly.
+  const struct complex_int16_t expected[] = {
+      {0, 0},    {-10, 9},     {-20, 0},   {-9, -10},     {0, 25},  {-119, 119},
+      {-887, 0}, {3000, 3000}, {0, -6401}, {-3000, 3000}, {886, 0}, {118, 119},
+      {0, 25},   {9, -10},     {19, 0},    {9, 9},        {0, 0}};
+  TF_LITE_MICRO_EXPECT_EQ(state.fft_size / 2 + 1,
+                          sizeof(expected) / sizeof(expected[0]));
+  unsigned int i;
+  for (i = 0; i <= state.fft_size / 2; ++i) {
+    TF_LITE_MICRO_EXPECT_NEAR(state.output[i].real, expected[i].real, 2);
+    TF_LITE_MICRO_EXPECT_NEAR(state.output[i].imag, expected[i].imag, 2);
+  }
+
+  FftRadix4FreeStateContents(&state);
+}
+
+TF_LITE_MICRO_TEST(FftRadix4Test_MatchesDft) {
+  // Covers both a power of 4 and a radix-2 first stage.
+  CheckAgainstDft(2, 1);
+  CheckAgainstDft(25, 2);
+  CheckAgainstDft(64, 2);
+  CheckAgainstDft(400, 3);
+  CheckAgainstDft(512, 3);
+  CheckAgainstDft(1024, 3);
+}
+
+TF_LITE_MICRO_TEST(FftRadix4Test_StreamsAreIndependent) {
+  const int kNumStreams = 3;
+  int16_t input[kFakeWindowSize * kNumStreams];
+  int16_t stream_input[kNumStreams][kFakeWindowSize];
+  const int scale_shifts[kNumStreams] = {0, 1, 3};
+  int s;
+  int i;
+  for (s = 0; s < kNumStreams; ++s) {
+    FillTestSignal(stream_input[s], kFakeWindowSize, s);
+    for (i = 0; i < kFakeWindowSize; ++i) {
+      stream_input[s][i] >>= scale_shifts[s];
+      input[i * kNumStreams + s] = stream_input[s][i];
+    }
+  }
+
+  struct FftRadix4State state;
+  TF_LITE_MICRO_EXPECT(
+      FftRadix4PopulateState(&state, kFakeWindowSize, kNumStreams));
+  FftRadix4Compute(&state, input, scale_shifts);
+
+  for (s = 0; s < kNumStreams; ++s) {
+    struct FftRadix4State single_state;
+    TF_LITE_MICRO_EXPECT(
+        FftRadix4PopulateState(&single_state, kFakeWindowSize, 1));
+    FftRadix4Compute(&single_state, stream_input[s], &scale_shifts[s]);
+    for (i = 0; i <= static_cast<int>(state.fft_size / 2); ++i) {
+      TF_LITE_MICRO_EXPECT_EQ(state.output[i * kNumStreams + s].real,
+                              single_state.output[i].real);
+      TF_LITE_MICRO_EXPECT_EQ(state.output[i * kNumStreams + s].imag,
+                              single_state.output[i].imag);
+    }
+    FftRadix4FreeStateContents(&single_state);
+  }
+
+  FftRadix4FreeStateContents(&state);
+}
+
+TF_LITE_MICRO_TESTS_END
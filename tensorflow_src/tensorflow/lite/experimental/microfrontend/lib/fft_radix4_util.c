@@ -0,0 +1,120 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/microfrontend/lib/fft_radix4_util.h"
+
+#include <math.h>
+#include <stdio.h>
+
+// Input positions are stored as 16 bits.
+#define kFftRadix4MaxSize (1 << 17)
+
+static struct complex_int16_t Twiddle(double turns) {
+  const double angle = 2 * M_PI * turns;
+  struct complex_int16_t twiddle;
+  twiddle.real = floor(0.5 + 32767 * cos(angle));
+  twiddle.imag = floor(0.5 - 32767 * sin(angle));
+  return twiddle;
+}
+
+int FftRadix4PopulateState(struct FftRadix4State* state, size_t input_size,
+                           int num_streams) {
+  state->input_size = input_size;
+  state->num_streams = num_streams;
+  state->fft_size = 2;
+  while (state->fft_size < state->input_size) {
+    state->fft_size <<= 1;
+  }
+  if (state->fft_size > kFftRadix4MaxSize || num_streams < 1) {
+    fprintf(stderr, "Unsupported fft size %zu for %d streams\n",
+            state->fft_size, num_streams);
+    return 0;
+  }
+  const size_t complex_size = state->fft_size / 2;
+
+  // Radix-2 first if needed, so that all radix-4 stages have twiddles.
+  size_t size = 1;
+  state->num_stages = 0;
+  while (size < complex_size) {
+    const int radix =
+        (state->num_stages == 0 && (complex_size & 0x55555555) == 0) ? 2 : 4;
+    state->stage_radix[state->num_stages++] = radix;
+    size *= radix;
+  }
+
+  state->input_positions =
+      malloc(complex_size * sizeof(*state->input_positions));
+  state->twiddles = malloc(complex_size * sizeof(*state->twiddles));
+  state->split_twiddles =
+      malloc((complex_size + 1) * sizeof(*state->split_twiddles));
+  state->work = malloc(complex_size * num_streams * sizeof(*state->work));
+  state->output =
+      malloc((complex_size + 1) * num_streams * sizeof(*state->output));
+  if (state->input_positions == NULL || state->twiddles == NULL ||
+      state->split_twiddles == NULL || state->work == NULL ||
+      state->output == NULL) {
+    fprintf(stderr, "Failed to alloc fft buffers\n");
+    return 0;
+  }
+
+  // The last stage splits the input by its lowest digit, the stage before by
+  // the next digit, and so on.
+  size_t position;
+  for (position = 0; position < complex_size; ++position) {
+    size_t index = 0;
+    size_t digit_weight = 1;
+    size_t remainder = position;
+    size_t span = complex_size;
+    int stage;
+    for (stage = state->num_stages - 1; stage >= 0; --stage) {
+      span /= state->stage_radix[stage];
+      index += remainder / span * digit_weight;
+      remainder %= span;
+      digit_weight *= state->stage_radix[stage];
+    }
+    state->input_positions[index] = position;
+  }
+
+  struct complex_int16_t* twiddle = state->twiddles;
+  size_t span = 1;
+  int stage;
+  for (stage = 0; stage < state->num_stages; ++stage) {
+    if (state->stage_radix[stage] == 4) {
+      size_t n;
+      int j;
+      for (n = 0; n < span; ++n) {
+        for (j = 1; j < 4; ++j) {
+          *twiddle++ = Twiddle((double)(j * n) / (4 * span));
+        }
+      }
+    }
+    span *= state->stage_radix[stage];
+  }
+
+  size_t k;
+  for (k = 0; k <= complex_size; ++k) {
+    state->split_twiddles[k] = Twiddle((double)k / state->fft_size);
+  }
+
+  FftRadix4Reset(state);
+  return 1;
+}
+
+void FftRadix4FreeStateContents(struct FftRadix4State* state) {
+  free(state->input_positions);
+  free(state->twiddles);
+  free(state->split_twiddles);
+  free(state->work);
+  free(state->output);
+}
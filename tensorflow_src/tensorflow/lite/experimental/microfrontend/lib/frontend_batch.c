@@ -0,0 +1,159 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_batch.h"
+
+#include <string.h>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/bits.h"
+
+// Same as WindowProcessSamples, on interleaved streams.
+static int WindowProcessBatchSamples(struct FrontendBatchState* state,
+                                     const int16_t* samples,
+                                     size_t num_samples,
+                                     size_t* num_samples_read) {
+  struct WindowState* window = &state->window;
+  const int num_streams = state->num_streams;
+
+  size_t max_samples_to_copy = window->size - window->input_used;
+  if (max_samples_to_copy > num_samples) {
+    max_samples_to_copy = num_samples;
+  }
+  memcpy(window->input + window->input_used * num_streams, samples,
+         max_samples_to_copy * num_streams * sizeof(*samples));
+  *num_samples_read = max_samples_to_copy;
+  window->input_used += max_samples_to_copy;
+
+  if (window->input_used < window->size) {
+    return 0;
+  }
+
+  int16_t* max_abs_output_values = state->max_abs_output_values;
+  memset(max_abs_output_values, 0,
+         num_streams * sizeof(*max_abs_output_values));
+  const int16_t* input = window->input;
+  int16_t* output = window->output;
+  size_t i;
+  int s;
+  for (i = 0; i < window->size; ++i) {
+    const int32_t coefficient = window->coefficients[i];
+    for (s = 0; s < num_streams; ++s) {
+      int16_t new_value = (input[s] * coefficient) >> kFrontendWindowBits;
+      output[s] = new_value;
+      if (new_value < 0) {
+        new_value = -new_value;
+      }
+      if (new_value > max_abs_output_values[s]) {
+        max_abs_output_values[s] = new_value;
+      }
+    }
+    input += num_streams;
+    output += num_streams;
+  }
+  memmove(window->input, window->input + window->step * num_streams,
+          sizeof(*window->input) * (window->size - window->step) *
+              num_streams);
+  window->input_used -= window->step;
+
+  return 1;
+}
+
+// Same as FilterbankConvertFftComplexToEnergy, writing the energy of the
+// streams one after the other.
+static void ConvertFftComplexToEnergy(struct FrontendBatchState* state) {
+  const int num_streams = state->num_streams;
+  const size_t spectrum_size = state->fft.fft_size / 2 + 1;
+  const int end_index = state->filterbank.end_index;
+  const struct complex_int16_t* fft_output =
+      state->fft.output + state->filterbank.start_index * num_streams;
+  int i;
+  int s;
+  for (i = state->filterbank.start_index; i < end_index; ++i) {
+    int32_t* energy = state->energy + i;
+    for (s = 0; s < num_streams; ++s) {
+      const int32_t real = fft_output[s].real;
+      const int32_t imag = fft_output[s].imag;
+      const uint32_t mag_squared = (real * real) + (imag * imag);
+      *energy = mag_squared;
+      energy += spectrum_size;
+    }
+    fft_output += num_streams;
+  }
+}
+
+struct FrontendOutput FrontendBatchProcessSamples(
+    struct FrontendBatchState* state, const int16_t* samples,
+    size_t num_samples, size_t* num_samples_read) {
+  struct FrontendOutput output;
+  output.values = NULL;
+  output.size = 0;
+
+  // Try to apply the window - if it fails, return and wait for more data.
+  if (!WindowProcessBatchSamples(state, samples, num_samples,
+                                 num_samples_read)) {
+    return output;
+  }
+
+  const int num_streams = state->num_streams;
+  int s;
+  for (s = 0; s < num_streams; ++s) {
+    state->input_shifts[s] =
+        15 - MostSignificantBit32(state->max_abs_output_values[s]);
+  }
+  FftRadix4Compute(&state->fft, state->window.output, state->input_shifts);
+  ConvertFftComplexToEnergy(state);
+
+  const int num_channels = state->filterbank.num_channels;
+  const size_t spectrum_size = state->fft.fft_size / 2 + 1;
+  const int correction_bits =
+      MostSignificantBit32(state->fft.fft_size) - 1 - (kFilterbankBits / 2);
+  for (s = 0; s < num_streams; ++s) {
+    FilterbankAccumulateChannels(&state->filterbank,
+                                 state->energy + s * spectrum_size);
+    uint32_t* scaled_filterbank =
+        FilterbankSqrt(&state->filterbank, state->input_shifts[s]);
+
+    NoiseReductionApply(&state->noise_reduction[s], scaled_filterbank);
+
+    if (state->pcan_gain_control[s].enable_pcan) {
+      PcanGainControlApply(&state->pcan_gain_control[s], scaled_filterbank);
+    }
+
+    uint16_t* logged_filterbank = LogScaleApply(
+        &state->log_scale, scaled_filterbank, num_channels, correction_bits);
+    memcpy(state->output + s * num_channels, logged_filterbank,
+           num_channels * sizeof(*state->output));
+  }
+
+  output.size = num_channels * num_streams;
+  output.values = state->output;
+  return output;
+}
+
+void FrontendBatchReset(struct FrontendBatchState* state) {
+  const int num_streams = state->num_streams;
+  memset(state->window.input, 0,
+         state->window.size * num_streams * sizeof(*state->window.input));
+  memset(state->window.output, 0,
+         state->window.size * num_streams * sizeof(*state->window.output));
+  state->window.input_used = 0;
+  memset(state->max_abs_output_values, 0,
+         num_streams * sizeof(*state->max_abs_output_values));
+  FftRadix4Reset(&state->fft);
+  FilterbankReset(&state->filterbank);
+  int s;
+  for (s = 0; s < num_streams; ++s) {
+    NoiseReductionReset(&state->noise_reduction[s]);
+  }
+}
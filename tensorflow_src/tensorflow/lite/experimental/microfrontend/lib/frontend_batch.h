@@ -0,0 +1,70 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FRONTEND_BATCH_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FRONTEND_BATCH_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/fft_radix4.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/filterbank.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/log_scale.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/noise_reduction.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/pcan_gain_control.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/window.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Runs the frontend on several streams of audio in lockstep, e.g. the channels
+// of a microphone array. The window and FFT stages keep the streams
+// interleaved, so that the coefficients and twiddles are loaded once for all
+// of them, and the filterbank tables and PCAN lookup table are shared. Only
+// the noise estimates are kept per stream.
+struct FrontendBatchState {
+  int num_streams;
+  // The window's input and output hold num_streams interleaved streams.
+  struct WindowState window;
+  int16_t* max_abs_output_values;
+  int* input_shifts;
+  struct FftRadix4State fft;
+  struct FilterbankState filterbank;
+  // Energy of the spectrum of every stream, one after the other.
+  int32_t* energy;
+  struct NoiseReductionState* noise_reduction;
+  struct PcanGainControlState* pcan_gain_control;
+  struct LogScaleState log_scale;
+  uint16_t* output;
+};
+
+// Processes num_samples samples of every stream, interleaved as
+// samples[i * num_streams + stream]. Updates num_samples_read to the number of
+// samples per stream that were consumed. Once a window is complete, returns
+// num_streams feature vectors of filterbank.num_channels values one after the
+// other, otherwise the returned size is 0 and the values pointer is NULL. The
+// output is invalidated by the next call.
+struct FrontendOutput FrontendBatchProcessSamples(
+    struct FrontendBatchState* state, const int16_t* samples,
+    size_t num_samples, size_t* num_samples_read);
+
+void FrontendBatchReset(struct FrontendBatchState* state);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_MICROFRONTEND_LIB_FRONTEND_BATCH_H_
@@ -0,0 +1,115 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Measures how many real time audio streams a single core can run through the
+// batched frontend, for increasing numbers of streams per batch.
+//
+// Usage: frontend_batch_benchmark [max_streams] [audio_seconds]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_batch.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_batch_util.h"
+
+static const int kSampleRate = 16000;
+// Samples per stream handed to every call, as an audio driver would.
+static const size_t kChunkSize = 160;
+
+// Returns the CPU seconds it takes to process the audio, or a negative value
+// on failure.
+static double RunBatch(const struct FrontendConfig* config, int num_streams,
+                       const int16_t* samples, size_t num_samples) {
+  struct FrontendBatchState state;
+  if (!FrontendBatchPopulateState(config, &state, kSampleRate, num_streams)) {
+    FrontendBatchFreeStateContents(&state);
+    return -1;
+  }
+  uint32_t checksum = 0;
+  const clock_t start = clock();
+  size_t i = 0;
+  while (i < num_samples) {
+    size_t num_samples_read;
+    size_t chunk_size = num_samples - i;
+    if (chunk_size > kChunkSize) {
+      chunk_size = kChunkSize;
+    }
+    struct FrontendOutput output = FrontendBatchProcessSamples(
+        &state, samples + i * num_streams, chunk_size, &num_samples_read);
+    if (output.values != NULL) {
+      checksum += output.values[0];
+    }
+    i += num_samples_read;
+  }
+  const clock_t end = clock();
+  FrontendBatchFreeStateContents(&state);
+  // Keeps the work from being optimized away.
+  if (checksum == 0xFFFFFFFF) {
+    printf("\n");
+  }
+  return (double)(end - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char** argv) {
+  const int max_streams = argc > 1 ? atoi(argv[1]) : 16;
+  const double audio_seconds = argc > 2 ? atof(argv[2]) : 30.0;
+  if (max_streams < 1 || audio_seconds <= 0) {
+    fprintf(stderr, "Usage: %s [max_streams] [audio_seconds]\n", argv[0]);
+    return 1;
+  }
+
+  struct FrontendConfig config;
+  FrontendFillConfigWithDefaults(&config);
+  config.filterbank.num_channels = 40;
+
+  const size_t num_samples = audio_seconds * kSampleRate;
+  int16_t* samples = malloc(num_samples * max_streams * sizeof(*samples));
+  if (samples == NULL) {
+    fprintf(stderr, "Failed to allocate %zu samples\n",
+            num_samples * max_streams);
+    return 1;
+  }
+
+  printf("%8s %14s %18s\n", "streams", "cpu seconds", "streams per core");
+  int num_streams;
+  for (num_streams = 1; num_streams <= max_streams; num_streams *= 2) {
+    // Tones with a little noise, different for every stream.
+    unsigned int noise = 1;
+    size_t i;
+    int s;
+    for (i = 0; i < num_samples; ++i) {
+      for (s = 0; s < num_streams; ++s) {
+        noise = noise * 1103515245 + 12345;
+        samples[i * num_streams + s] =
+            8000 * sin(2 * M_PI * 440 * (s + 1) * i / kSampleRate) +
+            (int)((noise >> 16) & 0x3ff) - 512;
+      }
+    }
+
+    const double cpu_seconds =
+        RunBatch(&config, num_streams, samples, num_samples);
+    if (cpu_seconds < 0) {
+      fprintf(stderr, "Failed to populate frontend state\n");
+      free(samples);
+      return 1;
+    }
+    printf("%8d %14.3f %18.1f\n", num_streams, cpu_seconds,
+           num_streams * audio_seconds / cpu_seconds);
+  }
+
+  free(samples);
+  return 0;
+}
@@ -0,0 +1,178 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_batch.h"
+
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_batch_util.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace {
+
+const int kSampleRate = 1000;
+const int kWindowSamples = 25;
+const int kNumChannels = 2;
+const int16_t kFakeAudioData[] = {
+    0, 32767, 0, -32768, 0, 32767, 0, -32768, 0, 32767, 0, -32768,
+    0, 32767, 0, -32768, 0, 32767, 0, -32768, 0, 32767, 0, -32768,
+    0, 32767, 0, -32768, 0, 32767, 0, -32768, 0, 32767, 0, -32768};
+const int kFakeAudioSize = sizeof(kFakeAudioData) / sizeof(kFakeAudioData[0]);
+
+// Same config as the frontend test.
+class FrontendBatchTestConfig {
+ public:
+  FrontendBatchTestConfig() {
+    config_.window.size_ms = 25;
+    config_.window.step_size_ms = 10;
+    config_.filterbank.num_channels = kNumChannels;
+    config_.filterbank.lower_band_limit = 8.0;
+    config_.filterbank.upper_band_limit = 450.0;
+    config_.noise_reduction.smoothing_bits = 10;
+    config_.noise_reduction.even_smoothing = 0.025;
+    config_.noise_reduction.odd_smoothing = 0.06;
+    config_.noise_reduction.min_signal_remaining = 0.05;
+    config_.pcan_gain_control.enable_pcan = true;
+    config_.pcan_gain_control.strength = 0.95;
+    config_.pcan_gain_control.offset = 80.0;
+    config_.pcan_gain_control.gain_bits = 21;
+    config_.log_scale.enable_log = true;
+    config_.log_scale.scale_shift = 6;
+  }
+
+  struct FrontendConfig config_;
+};
+
+// Makes a different stream out of kFakeAudioData for every stream index.
+int16_t StreamSample(int stream, int i) {
+  switch (stream % 3) {
+    case 0:
+      return kFakeAudioData[i];
+    case 1:
+      return kFakeAudioData[i] / (stream + 1);
+    default:
+      return (i * 2654435761u >> 16) & 0x3fff;
+  }
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(FrontendBatchTest_CheckOutputValues) {
+  FrontendBatchTestConfig config;
+  struct FrontendBatchState state;
+  TF_LITE_MICRO_EXPECT(
+      FrontendBatchPopulateState(&config.config_, &state, kSampleRate, 1));
+  size_t num_samples_read;
+
+  struct FrontendOutput output = FrontendBatchProcessSamples(
+      &state, kFakeAudioData, kFakeAudioSize, &num_samples_read);
+  TF_LITE_MICRO_EXPECT_EQ(num_samples_read, kWindowSamples);
+
+  // The values FrontendProcessSamples produces, the FFT rounds differently.
+  const uint16_t expected[] = {479, 425};
+  TF_LITE_MICRO_EXPECT_EQ(output.size, sizeof(expected) / sizeof(expected[0]));
+  int i;
+  for (i = 0; i < output.size; ++i) {
+    TF_LITE_MICRO_EXPECT_NEAR(output.values[i], expected[i], 2);
+  }
+
+  output = FrontendBatchProcessSamples(
+      &state, kFakeAudioData + kWindowSamples, kFakeAudioSize - kWindowSamples,
+      &num_samples_read);
+  const uint16_t expected_consecutive[] = {436, 378};
+  TF_LITE_MICRO_EXPECT_EQ(output.size, sizeof(expected_consecutive) /
+                                           sizeof(expected_consecutive[0]));
+  for (i = 0; i < output.size; ++i) {
+    TF_LITE_MICRO_EXPECT_NEAR(output.values[i], expected_consecutive[i], 2);
+  }
+
+  FrontendBatchFreeStateContents(&state);
+}
+
+TF_LITE_MICRO_TEST(FrontendBatchTest_StreamsMatchSingleStream) {
+  const int kNumStreams = 5;
+  FrontendBatchTestConfig config;
+  struct FrontendBatchState state;
+  TF_LITE_MICRO_EXPECT(FrontendBatchPopulateState(&config.config_, &state,
+                                                  kSampleRate, kNumStreams));
+  struct FrontendBatchState single_states[kNumStreams];
+  int16_t samples[kFakeAudioSize * kNumStreams];
+  int16_t stream_samples[kNumStreams][kFakeAudioSize];
+  int s;
+  int i;
+  for (s = 0; s < kNumStreams; ++s) {
+    TF_LITE_MICRO_EXPECT(FrontendBatchPopulateState(
+        &config.config_, &single_states[s], kSampleRate, 1));
+    for (i = 0; i < kFakeAudioSize; ++i) {
+      stream_samples[s][i] = StreamSample(s, i);
+      samples[i * kNumStreams + s] = stream_samples[s][i];
+    }
+  }
+
+  // Feeds the samples in uneven chunks, so that windows overlap the calls.
+  const int kChunkSize = 7;
+  int num_outputs = 0;
+  for (i = 0; i < kFakeAudioSize;) {
+    int chunk_size = kFakeAudioSize - i;
+    if (chunk_size > kChunkSize) {
+      chunk_size = kChunkSize;
+    }
+    size_t num_samples_read;
+    struct FrontendOutput output = FrontendBatchProcessSamples(
+        &state, samples + i * kNumStreams, chunk_size, &num_samples_read);
+    for (s = 0; s < kNumStreams; ++s) {
+      size_t single_samples_read;
+      struct FrontendOutput single_output =
+          FrontendBatchProcessSamples(&single_states[s], stream_samples[s] + i,
+                                      chunk_size, &single_samples_read);
+      TF_LITE_MICRO_EXPECT_EQ(single_samples_read, num_samples_read);
+      TF_LITE_MICRO_EXPECT_EQ(single_output.size * kNumStreams, output.size);
+      int c;
+      for (c = 0; c < single_output.size; ++c) {
+        TF_LITE_MICRO_EXPECT_EQ(output.values[s * kNumChannels + c],
+                                single_output.values[c]);
+      }
+    }
+    if (output.size > 0) {
+      ++num_outputs;
+    }
+    i += num_samples_read;
+  }
+  TF_LITE_MICRO_EXPECT_EQ(num_outputs, 2);
+
+  for (s = 0; s < kNumStreams; ++s) {
+    FrontendBatchFreeStateContents(&single_states[s]);
+  }
+  FrontendBatchFreeStateContents(&state);
+}
+
+TF_LITE_MICRO_TEST(FrontendBatchTest_CheckNotEnoughSamples) {
+  FrontendBatchTestConfig config;
+  struct FrontendBatchState state;
+  TF_LITE_MICRO_EXPECT(
+      FrontendBatchPopulateState(&config.config_, &state, kSampleRate, 2));
+  int16_t samples[(kWindowSamples - 1) * 2] = {0};
+  size_t num_samples_read;
+
+  struct FrontendOutput output = FrontendBatchProcessSamples(
+      &state, samples, kWindowSamples - 1, &num_samples_read);
+
+  TF_LITE_MICRO_EXPECT_EQ(num_samples_read, kWindowSamples - 1);
+  TF_LITE_MICRO_EXPECT_EQ(output.size, 0);
+  TF_LITE_MICRO_EXPECT(output.values == nullptr);
+
+  FrontendBatchFreeStateContents(&state);
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,133 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_batch_util.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tensorflow/lite/experimental/microfrontend/lib/bits.h"
+
+int FrontendBatchPopulateState(const struct FrontendConfig* config,
+                               struct FrontendBatchState* state,
+                               int sample_rate, int num_streams) {
+  memset(state, 0, sizeof(*state));
+  state->num_streams = num_streams;
+  if (num_streams < 1) {
+    fprintf(stderr, "Invalid number of streams %d\n", num_streams);
+    return 0;
+  }
+
+  if (!WindowPopulateState(&config->window, &state->window, sample_rate)) {
+    fprintf(stderr, "Failed to populate window state\n");
+    return 0;
+  }
+  // Make room for the interleaved streams.
+  const size_t window_size = state->window.size * num_streams;
+  free(state->window.input);
+  free(state->window.output);
+  state->window.input = malloc(window_size * sizeof(*state->window.input));
+  state->window.output = malloc(window_size * sizeof(*state->window.output));
+  state->max_abs_output_values =
+      malloc(num_streams * sizeof(*state->max_abs_output_values));
+  state->input_shifts = malloc(num_streams * sizeof(*state->input_shifts));
+  if (state->window.input == NULL || state->window.output == NULL ||
+      state->max_abs_output_values == NULL || state->input_shifts == NULL) {
+    fprintf(stderr, "Failed to allocate window buffers\n");
+    return 0;
+  }
+
+  if (!FftRadix4PopulateState(&state->fft, state->window.size, num_streams)) {
+    fprintf(stderr, "Failed to populate fft state\n");
+    return 0;
+  }
+
+  const size_t spectrum_size = state->fft.fft_size / 2 + 1;
+  if (!FilterbankPopulateState(&config->filterbank, &state->filterbank,
+                               sample_rate, spectrum_size)) {
+    fprintf(stderr, "Failed to populate filterbank state\n");
+    return 0;
+  }
+  state->energy =
+      calloc(spectrum_size * num_streams, sizeof(*state->energy));
+  state->output = malloc(state->filterbank.num_channels * num_streams *
+                         sizeof(*state->output));
+  state->noise_reduction =
+      calloc(num_streams, sizeof(*state->noise_reduction));
+  state->pcan_gain_control =
+      calloc(num_streams, sizeof(*state->pcan_gain_control));
+  if (state->energy == NULL || state->output == NULL ||
+      state->noise_reduction == NULL || state->pcan_gain_control == NULL) {
+    fprintf(stderr, "Failed to allocate stream buffers\n");
+    return 0;
+  }
+
+  int s;
+  for (s = 0; s < num_streams; ++s) {
+    if (!NoiseReductionPopulateState(&config->noise_reduction,
+                                     &state->noise_reduction[s],
+                                     state->filterbank.num_channels)) {
+      fprintf(stderr, "Failed to populate noise reduction state\n");
+      return 0;
+    }
+  }
+
+  // Only the noise estimates differ between the streams, so they share the
+  // gain lookup table.
+  int input_correction_bits =
+      MostSignificantBit32(state->fft.fft_size) - 1 - (kFilterbankBits / 2);
+  if (!PcanGainControlPopulateState(
+          &config->pcan_gain_control, &state->pcan_gain_control[0],
+          state->noise_reduction[0].estimate, state->filterbank.num_channels,
+          state->noise_reduction[0].smoothing_bits, input_correction_bits)) {
+    fprintf(stderr, "Failed to populate pcan gain control state\n");
+    return 0;
+  }
+  for (s = 1; s < num_streams; ++s) {
+    state->pcan_gain_control[s] = state->pcan_gain_control[0];
+    state->pcan_gain_control[s].noise_estimate =
+        state->noise_reduction[s].estimate;
+  }
+
+  if (!LogScalePopulateState(&config->log_scale, &state->log_scale)) {
+    fprintf(stderr, "Failed to populate log scale state\n");
+    return 0;
+  }
+
+  FrontendBatchReset(state);
+
+  // All good, return a true value.
+  return 1;
+}
+
+void FrontendBatchFreeStateContents(struct FrontendBatchState* state) {
+  WindowFreeStateContents(&state->window);
+  free(state->max_abs_output_values);
+  free(state->input_shifts);
+  FftRadix4FreeStateContents(&state->fft);
+  FilterbankFreeStateContents(&state->filterbank);
+  free(state->energy);
+  int s;
+  if (state->noise_reduction != NULL) {
+    for (s = 0; s < state->num_streams; ++s) {
+      NoiseReductionFreeStateContents(&state->noise_reduction[s]);
+    }
+  }
+  if (state->pcan_gain_control != NULL) {
+    PcanGainControlFreeStateContents(&state->pcan_gain_control[0]);
+  }
+  free(state->noise_reduction);
+  free(state->pcan_gain_control);
+  free(state->output);
+}
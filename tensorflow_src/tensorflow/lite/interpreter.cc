@@ -248,6 +248,8 @@ void Interpreter::AddSubgraphs(int subgraphs_to_add,
   for (int i = 0; i < subgraphs_to_add; ++i) {
     Subgraph* subgraph = new Subgraph(error_reporter_, external_contexts_,
                                       &subgraphs_, &resources_);
+    subgraph->SetDynamicMemoryPool(dynamic_memory_pool_.get());
+    subgraph->SetArenaBufferAllocator(arena_buffer_allocator_);
     subgraphs_.emplace_back(subgraph);
   }
 }
@@ -443,6 +445,25 @@ TfLiteStatus Interpreter::GetBufferHandle(int tensor_index,
   return kTfLiteOk;
 }
 
+void Interpreter::EnableDynamicMemoryPool(size_t max_bytes) {
+  if (!dynamic_memory_pool_) {
+    dynamic_memory_pool_.reset(new DynamicMemoryPool());
+    for (auto& subgraph : subgraphs_) {
+      subgraph->SetDynamicMemoryPool(dynamic_memory_pool_.get());
+    }
+  }
+  dynamic_memory_pool_->SetMemoryLimit(max_bytes);
+}
+
+TfLiteStatus Interpreter::SetArenaBufferAllocator(
+    ArenaBufferAllocator* allocator) {
+  arena_buffer_allocator_ = allocator;
+  for (auto& subgraph : subgraphs_) {
+    TF_LITE_ENSURE_STATUS(subgraph->SetArenaBufferAllocator(allocator));
+  }
+  return kTfLiteOk;
+}
+
 void Interpreter::SetProfiler(Profiler* profiler) {
   // Release resources occupied by owned_profiler_ which is replaced by
   // caller-owned profiler.
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/dynamic_memory_pool.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/memory_planner.h"
@@ -423,6 +424,32 @@ class Interpreter {
   /// WARNING: Experimental interface, subject to change
   TfLiteStatus ReleaseNonPersistentMemory();
 
+  /// Serves the data of dynamic tensors, e.g. string tensors and outputs whose
+  /// shapes depend on the input values, from a pool owned by this interpreter
+  /// instead of malloc/realloc. The pool keeps the buffers tensors release or
+  /// outgrow for reuse in later invocations. `max_bytes` limits the memory
+  /// held by the pool, 0 for no limit; invocations resizing dynamic tensors
+  /// beyond it fail. Calling it again only updates the limit.
+  /// WARNING: Experimental interface, subject to change
+  void EnableDynamicMemoryPool(size_t max_bytes = 0);
+
+  /// Returns the pool enabled by EnableDynamicMemoryPool(), or nullptr.
+  /// WARNING: Experimental interface, subject to change
+  DynamicMemoryPool* dynamic_memory_pool() {
+    return dynamic_memory_pool_.get();
+  }
+
+  /// Takes the memory of the arenas, both the one shared by the tensors of
+  /// consecutive ops and the persistent one, from `allocator` instead of the
+  /// heap, e.g. to place activations in hugepages or on a NUMA node with a
+  /// PlacedArenaAllocator, or to let several interpreters draw from one
+  /// preallocated ArenaMemoryPool.
+  /// `allocator` must outlive the interpreter; nullptr goes back to the heap.
+  /// If tensors are already allocated, they are moved to the new memory right
+  /// away, which resets variable tensors.
+  /// WARNING: Experimental interface, subject to change
+  TfLiteStatus SetArenaBufferAllocator(ArenaBufferAllocator* allocator);
+
   // Update allocations for all tensors. This will redim dependent tensors
   // using the input tensor dimensionality as given. This is relatively
   // expensive. This *must be* called after the interpreter has been created
@@ -607,7 +634,8 @@ class Interpreter {
   //
   // Parameters should satisfy the following conditions:
   // 1. tensor->allocation_type == kTfLiteArenaRw or kTfLiteArenaRwPersistent
-  //    In general, this is true for I/O tensors & variable tensors.
+  //    In general, this is true for I/O tensors, variable tensors and
+  //    intermediate tensors whose shape is known before invocation.
   // 2. allocation->data has the appropriate permissions for runtime access
   //    (Read-only for inputs, Read-Write for others), and outlives Interpreter.
   // 3. allocation->bytes >= tensor->bytes.
@@ -753,6 +781,14 @@ class Interpreter {
   // nullptr if necessary.
   std::unique_ptr<ExternalCpuBackendContext> own_external_cpu_backend_context_;
 
+  // Pool serving the data of dynamic tensors, if enabled. Declared before
+  // `subgraphs_` to outlive their tensors.
+  std::unique_ptr<DynamicMemoryPool> dynamic_memory_pool_;
+
+  // Source of the memory of the arenas of all subgraphs, not owned. Null for
+  // the heap.
+  ArenaBufferAllocator* arena_buffer_allocator_ = nullptr;
+
   // Subgraphs
   std::vector<std::unique_ptr<Subgraph>> subgraphs_;
 
@@ -545,14 +545,46 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
     return kEmptyTensorName;
   };
 
+  // The quantization parameters of the tensors are parsed up front, so that
+  // their parsing is profiled as one "ParseQuantization" event, with the
+  // number of quantized tensors as event metadata. An event per tensor would
+  // cost about as much as parsing.
+  std::vector<TfLiteQuantization> quantizations(tensors->size());
+  std::vector<int> quantized_tensors;
+  for (int i = 0; i < tensors->size(); ++i) {
+    const auto* src_quantization = tensors->Get(i)->quantization();
+    if (src_quantization && src_quantization->scale() &&
+        src_quantization->scale()->size() > 0) {
+      quantized_tensors.push_back(i);
+    }
+  }
+  if (!quantized_tensors.empty()) {
+    ScopedProfile profile(profiler_, "ParseQuantization",
+                          Profiler::EventType::DEFAULT,
+                          quantized_tensors.size());
+    for (int i : quantized_tensors) {
+      const auto* tensor = tensors->Get(i);
+      if (ParseQuantization(tensor->quantization(), &quantizations[i],
+                            FlatBufferIntArrayToVector(tensor->shape())) !=
+          kTfLiteOk) {
+        error_reporter_->Report(
+            "Tensor %d has invalid quantization parameters.", i);
+        status = kTfLiteError;
+      }
+    }
+  }
+
   num_fp32_tensors_ = 0;
   for (int i = 0; i < tensors->size(); ++i) {
     const auto* tensor = tensors->Get(i);
     std::vector<int> dims = FlatBufferIntArrayToVector(tensor->shape());
+    // Owned by the subgraph once its tensor is set.
+    TfLiteQuantization quantization = quantizations[i];
 
     TfLiteType type;
     if (ConvertTensorType(tensor->type(), &type, error_reporter_) !=
         kTfLiteOk) {
+      TfLiteQuantizationFree(&quantization);
       status = kTfLiteError;
       continue;
     }
@@ -584,14 +616,39 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
     };
     size_t buffer_size = 0;
     const char* buffer_ptr;
-    TF_LITE_ENSURE_STATUS(get_readonly_data(&buffer_ptr, &buffer_size));
+    if (get_readonly_data(&buffer_ptr, &buffer_size) != kTfLiteOk) {
+      for (int j = i; j < tensors->size(); ++j) {
+        TfLiteQuantizationFree(&quantizations[j]);
+      }
+      return kTfLiteError;
+    }
 
-    const auto* src_quantization = tensor->quantization();
-    TfLiteQuantization quantization;
-    if (ParseQuantization(src_quantization, &quantization, dims) != kTfLiteOk) {
-      error_reporter_->Report("Tensor %d has invalid quantization parameters.",
-                              i);
-      status = kTfLiteError;
+    // Packed int4 tensors only hold constant weights, which kernels scale
+    // symmetrically, per tensor or per channel of their first dimension.
+    if (type == kTfLiteInt4) {
+      if (!buffer_ptr || tensor->sparsity()) {
+        error_reporter_->Report(
+            "Tensor %d of type INT4 must be dense and constant.", i);
+        status = kTfLiteError;
+      }
+      const auto* affine_quantization =
+          reinterpret_cast<const TfLiteAffineQuantization*>(
+              quantization.params);
+      if (quantization.type != kTfLiteAffineQuantization ||
+          affine_quantization->quantized_dimension != 0) {
+        error_reporter_->Report(
+            "Tensor %d of type INT4 must be quantized along dimension 0.", i);
+        status = kTfLiteError;
+      } else {
+        for (int j = 0; j < affine_quantization->zero_point->size; ++j) {
+          if (affine_quantization->zero_point->data[j] != 0) {
+            error_reporter_->Report(
+                "Tensor %d of type INT4 must have zero points of 0.", i);
+            status = kTfLiteError;
+            break;
+          }
+        }
+      }
     }
 
     std::vector<int> dims_signature = {};
@@ -697,9 +754,12 @@ TfLiteStatus InterpreterBuilder::operator()(
     return cleanup_and_error();
   }
 
-  if (BuildLocalIndexToRegistrationMapping() != kTfLiteOk) {
-    error_reporter_->Report("Registration failed.\n");
-    return cleanup_and_error();
+  {
+    TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_, "ResolveOps");
+    if (BuildLocalIndexToRegistrationMapping() != kTfLiteOk) {
+      error_reporter_->Report("Registration failed.\n");
+      return cleanup_and_error();
+    }
   }
 
   // Flatbuffer model schemas define a list of opcodes independent of the graph.
@@ -752,10 +812,18 @@ TfLiteStatus InterpreterBuilder::operator()(
         FlatBufferIntArrayToVector(subgraph->outputs()));
 
     // Finally setup nodes and tensors
-    if (ParseNodes(operators, modified_subgraph) != kTfLiteOk)
-      return cleanup_and_error();
-    if (ParseTensors(buffers, tensors, modified_subgraph) != kTfLiteOk)
-      return cleanup_and_error();
+    {
+      ScopedProfile profile(profiler_, "ParseNodes",
+                            Profiler::EventType::DEFAULT, subgraph_index);
+      if (ParseNodes(operators, modified_subgraph) != kTfLiteOk)
+        return cleanup_and_error();
+    }
+    {
+      ScopedProfile profile(profiler_, "ParseTensors",
+                            Profiler::EventType::DEFAULT, subgraph_index);
+      if (ParseTensors(buffers, tensors, modified_subgraph) != kTfLiteOk)
+        return cleanup_and_error();
+    }
 
     std::vector<int> variables;
     for (int i = 0; i < modified_subgraph->tensors_size(); ++i) {
@@ -780,7 +848,11 @@ TfLiteStatus InterpreterBuilder::operator()(
         op_resolver_.GetDelegates(num_threads);
   }
 
-  TfLiteStatus status = ApplyDelegates(interpreter->get(), num_threads);
+  TfLiteStatus status;
+  {
+    TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_, "ApplyDelegates");
+    status = ApplyDelegates(interpreter->get(), num_threads);
+  }
   if (status != kTfLiteOk) {
     interpreter->reset();
   }
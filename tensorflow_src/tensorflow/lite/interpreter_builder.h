@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/subgraph.h"
 #include "tensorflow/lite/interpreter.h"
 #include "tensorflow/lite/model_builder.h"
@@ -82,6 +83,17 @@ class InterpreterBuilder {
   /// WARNING: This is an experimental API and subject to change.
   void AddDelegate(TfLiteDelegate* delegate);
 
+  /// Records the phases of operator() in `profiler` as DEFAULT events, e.g.
+  /// "ParseNodes" and "ParseTensors" with the index of the subgraph as event
+  /// metadata, to tell where the time to build an interpreter goes. The
+  /// quantization parameters of the tensors of a subgraph are parsed in one
+  /// "ParseQuantization" event, with the number of quantized tensors as event
+  /// metadata. Unlike Interpreter::SetProfiler(), this does not install
+  /// `profiler` on the built interpreters. `profiler` must outlive the calls to
+  /// operator().
+  /// WARNING: This is an experimental API and subject to change.
+  void SetProfiler(Profiler* profiler) { profiler_ = profiler; }
+
  private:
   TfLiteStatus BuildLocalIndexToRegistrationMapping();
   TfLiteStatus ParseNodes(
@@ -111,6 +123,7 @@ class InterpreterBuilder {
   std::vector<TfLiteRegistration> unresolved_custom_ops_;
   std::vector<BuiltinOperator> flatbuffer_op_index_to_registration_types_;
   const Allocation* allocation_ = nullptr;
+  Profiler* profiler_ = nullptr;
 
   bool has_flex_op_ = false;
   int num_fp32_tensors_ = 0;
@@ -30,6 +30,7 @@ limitations under the License.
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/lite/arena_memory_pool.h"
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/interpreter_test_util.h"
@@ -513,6 +514,43 @@ TEST(BasicInterpreter, ResizingTensors) {
   tensor->data.f[15] = 0.123f;
 }
 
+TEST(BasicInterpreter, ResizingTensorsWithDynamicMemoryPool) {
+  Interpreter interpreter;
+  interpreter.EnableDynamicMemoryPool(/*max_bytes=*/1024);
+  ASSERT_EQ(interpreter.AddTensors(1), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(
+                0, kTfLiteFloat32, "", {3}, TfLiteQuantizationParams()),
+            kTfLiteOk);
+  TfLiteTensor* tensor = interpreter.tensor(0);
+  tensor->allocation_type = kTfLiteDynamic;
+  const DynamicMemoryPool* pool = interpreter.dynamic_memory_pool();
+  ASSERT_NE(pool, nullptr);
+
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {1, 2, 4}), kTfLiteOk);
+  ASSERT_NE(tensor->data.raw, nullptr);
+  tensor->data.f[7] = 0.123f;
+  EXPECT_EQ(pool->stats().in_use_bytes, 64);
+
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {2, 2, 4}), kTfLiteOk);
+  EXPECT_EQ(tensor->data.f[7], 0.123f);
+  EXPECT_EQ(pool->stats().in_use_bytes, 64);
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {2, 2, 8}), kTfLiteOk);
+  EXPECT_EQ(tensor->data.f[7], 0.123f);
+  EXPECT_EQ(pool->stats().in_use_bytes, 128);
+  EXPECT_EQ(pool->stats().cached_bytes, 64);
+
+  // Exceeds the limit of the pool.
+  ASSERT_NE(interpreter.ResizeInputTensor(0, {257}), kTfLiteOk);
+  EXPECT_EQ(tensor->bytes, 32 * sizeof(float));
+
+  // Shrinking keeps the buffer.
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {2}), kTfLiteOk);
+  EXPECT_EQ(pool->stats().in_use_bytes, 128);
+  EXPECT_EQ(pool->stats().num_allocations, 2);
+}
+
 TEST(BasicInterpreter, NoopResizingTensors) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(1), kTfLiteOk);
@@ -1698,6 +1736,49 @@ TEST_F(TestCustomAllocation, CustomAlloc_VariableTensor) {
   }
 }
 
+// Intermediate tensors can be placed in custom memory as well.
+TEST_F(TestCustomAllocation, CustomIntermediateAlloc) {
+  AssignCustomAllocForTensor(2,
+                             /*required_alignment=*/kDefaultTensorAlignment);
+
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  VerifyInvoke();
+  // The intermediate tensor holds input + input.
+  const TfLiteTensor* intermediate = interpreter_->tensor(2);
+  EXPECT_EQ(intermediate->allocation_type, kTfLiteCustom);
+  EXPECT_EQ(intermediate->data.f[2], 6.0f);
+}
+
+TEST_F(TestCustomAllocation, ArenasFromMemoryPool) {
+  alignas(64) static char region[64 * 1024];
+  ArenaMemoryPool pool(region, sizeof(region));
+
+  // Tensors already allocated from the heap move to the pool.
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(interpreter_->SetArenaBufferAllocator(&pool), kTfLiteOk);
+  EXPECT_GT(pool.stats().in_use_bytes, 0);
+  for (int i = 0; i < interpreter_->tensors_size(); ++i) {
+    const char* data = interpreter_->tensor(i)->data.raw;
+    EXPECT_GE(data, region) << i;
+    EXPECT_LT(data, region + sizeof(region)) << i;
+  }
+  VerifyInvoke();
+
+  // And back, returning the memory to the pool.
+  ASSERT_EQ(interpreter_->SetArenaBufferAllocator(nullptr), kTfLiteOk);
+  EXPECT_EQ(pool.stats().in_use_bytes, 0);
+  VerifyInvoke();
+}
+
+TEST_F(TestCustomAllocation, ArenasFromExhaustedMemoryPool) {
+  alignas(64) static char region[256];
+  ArenaMemoryPool pool(region, sizeof(region));
+  ASSERT_EQ(interpreter_->SetArenaBufferAllocator(&pool), kTfLiteOk);
+  pool.Allocate(sizeof(region), 64);
+  EXPECT_EQ(interpreter_->AllocateTensors(), kTfLiteError);
+  ASSERT_EQ(interpreter_->SetArenaBufferAllocator(nullptr), kTfLiteOk);
+}
+
 TEST_F(TestCustomAllocation, ResizeInputsWithoutEnoughMemory) {
   // Set custom allocations for all input tensors.
   AssignCustomAllocForTensor(interpreter_->inputs()[0],
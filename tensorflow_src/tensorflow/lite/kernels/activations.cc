@@ -82,6 +82,9 @@ struct SoftmaxOpData {
                                                         // (1 + x), where x
                                                         // uniform distributed
                                                         // between [0.0 , 1.0]
+  // Set by the fixed-point kernel when 8-bit inputs run on the int16 LUTs.
+  bool use_int16_lut = false;
+  int16_t exp_q15_table[256];
 };
 
 struct LogSoftmaxOpData : public OpData {
@@ -89,6 +92,8 @@ struct LogSoftmaxOpData : public OpData {
   int32_t reverse_scaling_right_shift = 0;
   struct SoftmaxParams params = {};
   float f_table[256];
+  bool use_int16_lut = false;
+  int16_t exp_q15_table[256];
 };
 
 struct LeakyReluOpData : public OpData {
@@ -578,6 +583,7 @@ TfLiteStatus SigmoidPrepare(TfLiteContext* context, TfLiteNode* node) {
                                TfLiteIntArrayCopy(input->dims));
 }
 
+template <KernelType kernel_type>
 TfLiteStatus SoftmaxPrepare(TfLiteContext* context, TfLiteNode* node) {
   auto* params = reinterpret_cast<TfLiteSoftmaxParams*>(node->builtin_data);
   SoftmaxOpData* data = reinterpret_cast<SoftmaxOpData*>(node->user_data);
@@ -646,10 +652,33 @@ TfLiteStatus SoftmaxPrepare(TfLiteContext* context, TfLiteNode* node) {
                        &data->params.input_left_shift);
   }
 
+  // The fixed-point kernel runs 8-bit inputs on int16 exp and reciprocal LUTs,
+  // like the int16 kernel above, instead of the float table. The exp LUT only
+  // covers exp(-beta * scale * d) for d >= 0 below the row maximum, which
+  // saturates for beta <= 0, so those keep the float table.
+  data->use_int16_lut =
+      kernel_type == kFixedPointOptimized && params->beta > 0 &&
+      (input->type == kTfLiteUInt8 || input->type == kTfLiteInt8) &&
+      SizeOfDimension(input, NumDimensions(input) - 1) <=
+          optimized_ops::kSoftmaxInt16LUTMaxDepth;
+  if (data->use_int16_lut) {
+    data->params.exp_q15_table = data->exp_q15_table;
+    optimized_ops::PopulateSoftmaxInt16ExpLookupTable(
+        data->exp_q15_table, input->params.scale, params->beta);
+    data->params.one_over_one_plus_x_lut = data->one_over_one_plus_x_lut;
+    gen_lut([](double value) { return 1.0 / (1.0 + value); }, 0.0, 1.0,
+            data->params.one_over_one_plus_x_lut, data->kInt16LUTArraySize);
+    // Probabilities come out in Q0.15.
+    QuantizeMultiplier(1.0 / (32768.0 * output->params.scale),
+                       &data->params.output_multiplier,
+                       &data->params.output_shift);
+  }
+
   return context->ResizeTensor(context, output,
                                TfLiteIntArrayCopy(input->dims));
 }
 
+template <KernelType kernel_type>
 TfLiteStatus LogSoftmaxPrepare(TfLiteContext* context, TfLiteNode* node) {
   LogSoftmaxOpData* data = reinterpret_cast<LogSoftmaxOpData*>(node->user_data);
 
@@ -675,6 +704,15 @@ TfLiteStatus LogSoftmaxPrepare(TfLiteContext* context, TfLiteNode* node) {
                                               input->params.scale, kBeta);
     data->params.zero_point = output->params.zero_point;
     data->params.scale = output->params.scale;
+
+    data->use_int16_lut = kernel_type == kFixedPointOptimized &&
+                          SizeOfDimension(input, NumDimensions(input) - 1) <=
+                              optimized_ops::kSoftmaxInt16LUTMaxDepth;
+    if (data->use_int16_lut) {
+      data->params.exp_q15_table = data->exp_q15_table;
+      optimized_ops::PopulateSoftmaxInt16ExpLookupTable(
+          data->exp_q15_table, input->params.scale, kBeta);
+    }
   }
 
   return context->ResizeTensor(context, output,
@@ -1047,14 +1085,22 @@ TfLiteStatus SigmoidEval(TfLiteContext* context, TfLiteNode* node) {
   return kTfLiteOk;
 }
 
+template <KernelType kernel_type>
 TfLiteStatus SoftmaxFloat(TfLiteContext* context, const TfLiteTensor* input,
                           TfLiteTensor* output, TfLiteSoftmaxParams* params) {
   SoftmaxParams op_params;
   op_params.beta = params->beta;
-  optimized_ops::Softmax(op_params, GetTensorShape(input),
-                         GetTensorData<float>(input), GetTensorShape(output),
-                         GetTensorData<float>(output),
-                         CpuBackendContext::GetFromContext(context));
+  // The fast exp only takes the non-positive (input - max) * beta.
+  if (kernel_type == kFixedPointOptimized && params->beta > 0) {
+    optimized_ops::SoftmaxFastExp(
+        op_params, GetTensorShape(input), GetTensorData<float>(input),
+        GetTensorShape(output), GetTensorData<float>(output));
+  } else {
+    optimized_ops::Softmax(op_params, GetTensorShape(input),
+                           GetTensorData<float>(input), GetTensorShape(output),
+                           GetTensorData<float>(output),
+                           CpuBackendContext::GetFromContext(context));
+  }
   return kTfLiteOk;
 }
 
@@ -1120,6 +1166,21 @@ TfLiteStatus SoftmaxQuantized<int16, int16>(TfLiteContext* context,
   }
 }
 
+template <KernelType kernel_type, typename In, typename Out>
+TfLiteStatus SoftmaxQuantized8Bit(TfLiteContext* context,
+                                  const TfLiteTensor* input,
+                                  TfLiteTensor* output, SoftmaxOpData* data) {
+  if (kernel_type == kFixedPointOptimized && data->use_int16_lut) {
+    optimized_ops::SoftmaxInt16LUT(data->params, GetTensorShape(input),
+                                   GetTensorData<In>(input),
+                                   GetTensorShape(output),
+                                   GetTensorData<Out>(output));
+    return kTfLiteOk;
+  }
+  return SoftmaxQuantized<In, Out>(context, input, output, data);
+}
+
+template <KernelType kernel_type>
 TfLiteStatus SoftmaxEval(TfLiteContext* context, TfLiteNode* node) {
   auto* params = reinterpret_cast<TfLiteSoftmaxParams*>(node->builtin_data);
   SoftmaxOpData* data = reinterpret_cast<SoftmaxOpData*>(node->user_data);
@@ -1131,16 +1192,16 @@ TfLiteStatus SoftmaxEval(TfLiteContext* context, TfLiteNode* node) {
 
   switch (input->type) {
     case kTfLiteFloat32: {
-      return SoftmaxFloat(context, input, output, params);
+      return SoftmaxFloat<kernel_type>(context, input, output, params);
     }
     case kTfLiteUInt8: {
       switch (output->type) {
         case kTfLiteUInt8:
-          return SoftmaxQuantized<uint8_t, uint8_t>(context, input, output,
-                                                    data);
+          return SoftmaxQuantized8Bit<kernel_type, uint8_t, uint8_t>(
+              context, input, output, data);
         case kTfLiteInt16:
-          return SoftmaxQuantized<uint8_t, int16_t>(context, input, output,
-                                                    data);
+          return SoftmaxQuantized8Bit<kernel_type, uint8_t, int16_t>(
+              context, input, output, data);
         default:
           TF_LITE_KERNEL_LOG(context,
                              "Only uint8_t and int16_t outputs are supported "
@@ -1152,10 +1213,11 @@ TfLiteStatus SoftmaxEval(TfLiteContext* context, TfLiteNode* node) {
     case kTfLiteInt8: {
       switch (output->type) {
         case kTfLiteInt8:
-          return SoftmaxQuantized<int8_t, int8_t>(context, input, output, data);
+          return SoftmaxQuantized8Bit<kernel_type, int8_t, int8_t>(
+              context, input, output, data);
         case kTfLiteInt16:
-          return SoftmaxQuantized<int8_t, int16_t>(context, input, output,
-                                                   data);
+          return SoftmaxQuantized8Bit<kernel_type, int8_t, int16_t>(
+              context, input, output, data);
         default:
           TF_LITE_KERNEL_LOG(context,
                              "Only int8_t and int16_t outputs are supported "
@@ -1192,6 +1254,10 @@ TfLiteStatus LogSoftmaxEval(TfLiteContext* context, TfLiteNode* node) {
         optimized_ops::LogSoftmax(
             op_params, GetTensorShape(input), GetTensorData<float>(input),
             GetTensorShape(output), GetTensorData<float>(output));
+      } else if (kernel_type == kFixedPointOptimized) {
+        optimized_ops::LogSoftmaxFastExp(
+            op_params, GetTensorShape(input), GetTensorData<float>(input),
+            GetTensorShape(output), GetTensorData<float>(output));
       } else {
         reference_ops::LogSoftmax(
             op_params, GetTensorShape(input), GetTensorData<float>(input),
@@ -1201,7 +1267,12 @@ TfLiteStatus LogSoftmaxEval(TfLiteContext* context, TfLiteNode* node) {
     }
     case kTfLiteUInt8: {
       SoftmaxParams op_params = data->params;
-      if (kernel_type == kGenericOptimized) {
+      if (kernel_type == kFixedPointOptimized && data->use_int16_lut) {
+        optimized_ops::LogSoftmaxInt16LUT(
+            op_params, input->params.scale, GetTensorShape(input),
+            GetTensorData<uint8_t>(input), GetTensorShape(output),
+            GetTensorData<uint8_t>(output));
+      } else if (kernel_type != kReference) {
         optimized_ops::LogSoftmax(
             op_params, input->params.scale, GetTensorShape(input),
             GetTensorData<uint8_t>(input), GetTensorShape(output),
@@ -1214,7 +1285,12 @@ TfLiteStatus LogSoftmaxEval(TfLiteContext* context, TfLiteNode* node) {
       return kTfLiteOk;
     }
     case kTfLiteInt8: {
-      if (kernel_type == kGenericOptimized) {
+      if (kernel_type == kFixedPointOptimized && data->use_int16_lut) {
+        optimized_ops::LogSoftmaxInt16LUT(
+            data->params, input->params.scale, GetTensorShape(input),
+            GetTensorData<int8_t>(input), GetTensorShape(output),
+            GetTensorData<int8_t>(output));
+      } else if (kernel_type != kReference) {
         SoftmaxParams op_params = data->params;
         optimized_ops::LogSoftmax(
             op_params, input->params.scale, GetTensorShape(input),
@@ -1539,14 +1615,25 @@ TfLiteRegistration* Register_LOGISTIC() {
 TfLiteRegistration* Register_SOFTMAX() {
   static TfLiteRegistration r = {
       activations::SoftmaxInit, activations::SoftmaxFree,
-      activations::SoftmaxPrepare, activations::SoftmaxEval};
+      activations::SoftmaxPrepare<activations::kGenericOptimized>,
+      activations::SoftmaxEval<activations::kGenericOptimized>};
+  return &r;
+}
+
+// Runs 8-bit inputs on int16 exp and reciprocal lookup tables with integer
+// only arithmetic, and float inputs on a polynomial exp approximation.
+TfLiteRegistration* Register_SOFTMAX_FIXED_POINT_OPT() {
+  static TfLiteRegistration r = {
+      activations::SoftmaxInit, activations::SoftmaxFree,
+      activations::SoftmaxPrepare<activations::kFixedPointOptimized>,
+      activations::SoftmaxEval<activations::kFixedPointOptimized>};
   return &r;
 }
 
 TfLiteRegistration* Register_LOG_SOFTMAX_REF() {
   static TfLiteRegistration r = {
       activations::LogSoftmaxInit, activations::LogSoftmaxFree,
-      activations::LogSoftmaxPrepare,
+      activations::LogSoftmaxPrepare<activations::kReference>,
       activations::LogSoftmaxEval<activations::kReference>};
   return &r;
 }
@@ -1554,11 +1641,19 @@ TfLiteRegistration* Register_LOG_SOFTMAX_REF() {
 TfLiteRegistration* Register_LOG_SOFTMAX() {
   static TfLiteRegistration r = {
       activations::LogSoftmaxInit, activations::LogSoftmaxFree,
-      activations::LogSoftmaxPrepare,
+      activations::LogSoftmaxPrepare<activations::kGenericOptimized>,
       activations::LogSoftmaxEval<activations::kGenericOptimized>};
   return &r;
 }
 
+TfLiteRegistration* Register_LOG_SOFTMAX_FIXED_POINT_OPT() {
+  static TfLiteRegistration r = {
+      activations::LogSoftmaxInit, activations::LogSoftmaxFree,
+      activations::LogSoftmaxPrepare<activations::kFixedPointOptimized>,
+      activations::LogSoftmaxEval<activations::kFixedPointOptimized>};
+  return &r;
+}
+
 TfLiteRegistration* Register_PRELU_REF() {
   static TfLiteRegistration r = {
       activations::PreluInit, activations::PreluFree, activations::PreluPrepare,
@@ -50,6 +50,10 @@ TfLiteRegistration* Register_LOGISTIC_REF();
 TfLiteRegistration* Register_LOGISTIC_GENERIC_OPT();
 TfLiteRegistration* Register_LOGISTIC_FIXED_POINT_OPT();
 
+// Softmax kernel registrations.
+TfLiteRegistration* Register_SOFTMAX_FIXED_POINT_OPT();
+TfLiteRegistration* Register_LOG_SOFTMAX_FIXED_POINT_OPT();
+
 // PRelu kernel registrations.
 TfLiteRegistration* Register_PRELU_REF();
 TfLiteRegistration* Register_PRELU();
@@ -95,7 +99,12 @@ class BaseActivationsOpModel : public SingleOpModel {
 
   // A dedicated constructor for SOFTMAX, which does some options.
   BaseActivationsOpModel(float softmax_beta, TensorData input,
-                         TensorType output_type) {
+                         TensorType output_type)
+      : BaseActivationsOpModel(nullptr, softmax_beta, input, output_type) {}
+
+  // Same as above, with a specific SOFTMAX kernel when `registration` is set.
+  BaseActivationsOpModel(TfLiteRegistration* registration, float softmax_beta,
+                         TensorData input, TensorType output_type) {
     input_ = AddInput(input);
     if (output_type == TensorType_UINT8) {
       output_ = AddOutput({TensorType_UINT8, {}, 0, 0, 1. / 256});
@@ -117,6 +126,10 @@ class BaseActivationsOpModel : public SingleOpModel {
     }
     SetBuiltinOp(BuiltinOperator_SOFTMAX, BuiltinOptions_SoftmaxOptions,
                  CreateSoftmaxOptions(builder_, softmax_beta).Union());
+    if (registration) {
+      resolver_ = absl::make_unique<SingleOpResolver>(BuiltinOperator_SOFTMAX,
+                                                      registration);
+    }
     BuildInterpreter({GetShape(input_)});
   }
 
@@ -2206,6 +2219,213 @@ TEST(QuantizedActivationsOpTest, LogSoftmaxInt8) {
                                      }));
 }
 
+// The fixed-point softmax kernel must stay within one output step of the
+// default kernel for every supported type combination.
+template <typename In, typename Out>
+void TestSoftmaxFixedPointMatchesDefault(TensorType input_type,
+                                         TensorType output_type, float beta,
+                                         int depth, int max_diff,
+                                         std::minstd_rand* random_engine) {
+  std::vector<float> input;
+  GenerateUniformRandomVector(3 * depth, -10.0f, 10.0f, random_engine, &input);
+  const TensorData input_data = {input_type, {3, depth}, -10, 10};
+  QuantizedActivationsOpModel expected(beta, input_data, output_type);
+  QuantizedActivationsOpModel actual(
+      ops::builtin::Register_SOFTMAX_FIXED_POINT_OPT(), beta, input_data,
+      output_type);
+  expected.SetInput<In>(input);
+  actual.SetInput<In>(input);
+  expected.Invoke();
+  actual.Invoke();
+  const std::vector<Out> expected_output = expected.GetOutput<Out>();
+  const std::vector<Out> actual_output = actual.GetOutput<Out>();
+  ASSERT_EQ(expected_output.size(), actual_output.size());
+  for (size_t i = 0; i < actual_output.size(); ++i) {
+    EXPECT_LE(std::abs(expected_output[i] - actual_output[i]), max_diff)
+        << "at " << i;
+  }
+}
+
+TEST(QuantizedActivationsOpTest, SoftmaxFixedPointMatchesDefault) {
+  std::minstd_rand random_engine;
+  for (int depth : {1, 8, 1001}) {
+    for (float beta : {0.1f, 1.0f, 2.5f}) {
+      TestSoftmaxFixedPointMatchesDefault<uint8_t, uint8_t>(
+          TensorType_UINT8, TensorType_UINT8, beta, depth, 1, &random_engine);
+      TestSoftmaxFixedPointMatchesDefault<int8_t, int8_t>(
+          TensorType_INT8, TensorType_INT8, beta, depth, 1, &random_engine);
+      // Q0.15 intermediate precision, i.e. a few int16 output steps.
+      TestSoftmaxFixedPointMatchesDefault<uint8_t, int16_t>(
+          TensorType_UINT8, TensorType_INT16, beta, depth, 4, &random_engine);
+      TestSoftmaxFixedPointMatchesDefault<int8_t, int16_t>(
+          TensorType_INT8, TensorType_INT16, beta, depth, 4, &random_engine);
+    }
+  }
+}
+
+TEST(QuantizedActivationsOpTest, SoftmaxFixedPointInt8) {
+  QuantizedActivationsOpModel m(
+      ops::builtin::Register_SOFTMAX_FIXED_POINT_OPT(), 0.1f,
+      {TensorType_INT8, {2, 4}, -10, 10}, TensorType_INT8);
+  m.SetInput<int8_t>({
+      0, -6, 2, 4,   //
+      3, -2, 10, 1,  //
+  });
+  m.Invoke();
+  EXPECT_THAT(m.GetDequantizedOutput<int8_t>(),
+              ElementsAreArray(ArrayFloatNear(
+                  {
+                      .23463, .12877, .28658, .35003,  //
+                      .22528, .13664, .45365, .18443,  //
+                  },
+                  kQuantizedTolerance)));
+}
+
+// The int16 exp LUT only holds exp(-beta * x) for x >= 0; a negative beta
+// falls back to the float table.
+TEST(QuantizedActivationsOpTest, SoftmaxFixedPointInt8NegativeBeta) {
+  QuantizedActivationsOpModel m(
+      ops::builtin::Register_SOFTMAX_FIXED_POINT_OPT(), -0.1f,
+      {TensorType_INT8, {2, 4}, -10, 10}, TensorType_INT8);
+  m.SetInput<int8_t>({
+      0, 6, -2, -4,    //
+      -3, 2, -10, -1,  //
+  });
+  m.Invoke();
+  EXPECT_THAT(m.GetDequantizedOutput<int8_t>(),
+              ElementsAreArray(ArrayFloatNear(
+                  {
+                      .23463, .12877, .28658, .35003,  //
+                      .22528, .13664, .45365, .18443,  //
+                  },
+                  kQuantizedTolerance)));
+}
+
+TEST(FloatActivationsOpTest, SoftmaxFixedPoint) {
+  FloatActivationsOpModel m(ops::builtin::Register_SOFTMAX_FIXED_POINT_OPT(),
+                            0.1f, {TensorType_FLOAT32, {2, 4}},
+                            TensorType_FLOAT32);
+  m.SetInput({
+      0, -6, 2, 4,   //
+      3, -2, 10, 1,  //
+  });
+  m.Invoke();
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 .23463, .12877, .28658, .35003,  //
+                                 .22528, .13664, .45365, .18443,  //
+                             })));
+
+  // Large logit ranges and saturated inputs.
+  std::minstd_rand random_engine;
+  std::vector<float> input;
+  GenerateUniformRandomVector(4 * 1000, -100.0f, 100.0f, &random_engine,
+                              &input);
+  input[0] = -1000.0f;
+  FloatActivationsOpModel expected(1.0f, {TensorType_FLOAT32, {4, 1000}},
+                                   TensorType_FLOAT32);
+  FloatActivationsOpModel actual(
+      ops::builtin::Register_SOFTMAX_FIXED_POINT_OPT(), 1.0f,
+      {TensorType_FLOAT32, {4, 1000}}, TensorType_FLOAT32);
+  expected.SetInput(input);
+  actual.SetInput(input);
+  expected.Invoke();
+  actual.Invoke();
+  EXPECT_THAT(actual.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(expected.GetOutput(), 1e-6)));
+}
+
+// A negative beta favors the smallest logits; the fast exp does not apply.
+TEST(FloatActivationsOpTest, SoftmaxFixedPointNegativeBeta) {
+  FloatActivationsOpModel m(ops::builtin::Register_SOFTMAX_FIXED_POINT_OPT(),
+                            -0.1f, {TensorType_FLOAT32, {2, 4}},
+                            TensorType_FLOAT32);
+  m.SetInput({
+      0, 6, -2, -4,    //
+      -3, 2, -10, -1,  //
+  });
+  m.Invoke();
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 .23463, .12877, .28658, .35003,  //
+                                 .22528, .13664, .45365, .18443,  //
+                             })));
+}
+
+TEST(FloatActivationsOpTest, LogSoftmaxFixedPoint) {
+  FloatActivationsOpModel m(
+      ops::builtin::Register_LOG_SOFTMAX_FIXED_POINT_OPT(),
+      BuiltinOperator_LOG_SOFTMAX, /*input=*/{TensorType_FLOAT32, {2, 4}});
+  m.SetInput({
+      0, -6, 2, 4,   //
+      3, -2, 10, 1,  //
+  });
+  m.Invoke();
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 -4.14297, -10.14297, -2.14297, -.142971,    //
+                                 -7.00104, -12.00104, -.00104087, -9.00104,  //
+                             })));
+}
+
+TEST(QuantizedActivationsOpTest, LogSoftmaxFixedPointUint8) {
+  QuantizedActivationsOpModel m(
+      ops::builtin::Register_LOG_SOFTMAX_FIXED_POINT_OPT(),
+      BuiltinOperator_LOG_SOFTMAX,
+      /*input=*/{TensorType_UINT8, {2, 4}, -10, 10},
+      /*output=*/{TensorType_UINT8, {}, 0, 0, 16. / 256, 255});
+  m.SetInput<uint8_t>({
+      0, -6, 2, 4,   //
+      3, -2, 10, 1,  //
+  });
+  m.Invoke();
+  EXPECT_THAT(m.GetOutput<uint8_t>(),
+              ElementsAreArray({189, 93, 221, 253, 142, 63, 255, 111}));
+}
+
+TEST(QuantizedActivationsOpTest, LogSoftmaxFixedPointInt8) {
+  QuantizedActivationsOpModel m(
+      ops::builtin::Register_LOG_SOFTMAX_FIXED_POINT_OPT(),
+      BuiltinOperator_LOG_SOFTMAX,
+      /*input=*/{TensorType_INT8, {2, 4}, -10, 10},
+      /*output=*/{TensorType_INT8, {}, 0, 0, 16. / 256, 127});
+  m.SetInput<int8_t>({
+      0, -6, 2, 4,   //
+      3, -2, 10, 1,  //
+  });
+  m.Invoke();
+  EXPECT_THAT(m.GetOutput<int8_t>(), ElementsAreArray({
+                                         61, -36, 93, 125,   //
+                                         15, -65, 127, -16,  //
+                                     }));
+
+  // Deep rows, where x_max - x spans the whole 8-bit range. The tolerance is
+  // one output step plus the input quantization error.
+  std::minstd_rand random_engine;
+  std::vector<float> input;
+  const int depth = 1001;
+  GenerateUniformRandomVector(2 * depth, -10.0f, 10.0f, &random_engine,
+                              &input);
+  QuantizedActivationsOpModel deep(
+      ops::builtin::Register_LOG_SOFTMAX_FIXED_POINT_OPT(),
+      BuiltinOperator_LOG_SOFTMAX,
+      /*input=*/{TensorType_INT8, {2, depth}, -10, 10},
+      /*output=*/{TensorType_INT8, {}, 0, 0, 16. / 256, 127});
+  deep.SetInput<int8_t>(input);
+  deep.Invoke();
+  std::vector<float> expected(input.size());
+  for (int i = 0; i < 2; ++i) {
+    const float* row = &input[i * depth];
+    const float max = *std::max_element(row, row + depth);
+    double sum = 0;
+    for (int c = 0; c < depth; ++c) sum += std::exp(row[c] - max);
+    for (int c = 0; c < depth; ++c) {
+      expected[i * depth + c] =
+          std::max(row[c] - max - static_cast<float>(std::log(sum)), -16.0f);
+    }
+  }
+  const float tolerance = 16. / 256 + 10. / 255;
+  EXPECT_THAT(deep.GetDequantizedOutput<int8_t>(),
+              ElementsAreArray(ArrayFloatNear(expected, tolerance)));
+}
+
 const auto kPReluKernelMap = new std::map<string, TfLiteRegistration*>({
     {"Reference", ops::builtin::Register_PRELU_REF()},
     {"GenericOptimized", ops::builtin::Register_PRELU()},
@@ -17,6 +17,8 @@ limitations under the License.
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
+#include <cstring>
 #include <vector>
 
 #include "flatbuffers/flexbuffers.h"  // from @flatbuffers
@@ -46,6 +48,16 @@ typedef struct {
   bool magnitude_squared;
   int output_height;
   internal::Spectrogram* spectrogram;
+  // In streaming mode every invoke gets the samples that follow those of the
+  // previous invoke, rather than a whole clip. Each channel keeps the samples
+  // of its incomplete window, and the output holds the latest output_frames
+  // frames, computing only the ones the new samples complete. The state is
+  // kept until the op is prepared for a different number of channels.
+  bool streaming;
+  int output_frames;
+  std::vector<internal::Spectrogram>* channel_spectrograms;
+  // The latest output_frames frames of every channel, oldest first.
+  std::vector<float>* frame_history;
 } TfLiteAudioSpectrogramParams;
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -60,12 +72,19 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
 
   data->spectrogram = new internal::Spectrogram;
 
+  data->streaming = m["streaming"].AsBool();
+  data->output_frames = m["output_frames"].AsInt32();
+  data->channel_spectrograms = new std::vector<internal::Spectrogram>;
+  data->frame_history = new std::vector<float>;
+
   return data;
 }
 
 void Free(TfLiteContext* context, void* buffer) {
   auto* params = reinterpret_cast<TfLiteAudioSpectrogramParams*>(buffer);
   delete params->spectrogram;
+  delete params->channel_spectrograms;
+  delete params->frame_history;
   delete params;
 }
 
@@ -89,12 +108,30 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   TF_LITE_ENSURE(context, params->spectrogram->Initialize(params->window_size,
                                                           params->stride));
-  const int64_t sample_count = input->dims->data[0];
-  const int64_t length_minus_window = (sample_count - params->window_size);
-  if (length_minus_window < 0) {
-    params->output_height = 0;
+  if (params->streaming) {
+    TF_LITE_ENSURE(context, params->output_frames > 0);
+    params->output_height = params->output_frames;
+    const size_t channel_count = input->dims->data[1];
+    if (params->channel_spectrograms->size() != channel_count) {
+      params->channel_spectrograms->assign(channel_count,
+                                           internal::Spectrogram());
+      for (auto& spectrogram : *params->channel_spectrograms) {
+        TF_LITE_ENSURE(context, spectrogram.Initialize(params->window_size,
+                                                       params->stride));
+      }
+      params->frame_history->assign(
+          channel_count * params->output_frames *
+              params->spectrogram->output_frequency_channels(),
+          0.0f);
+    }
   } else {
-    params->output_height = 1 + (length_minus_window / params->stride);
+    const int64_t sample_count = input->dims->data[0];
+    const int64_t length_minus_window = (sample_count - params->window_size);
+    if (length_minus_window < 0) {
+      params->output_height = 0;
+    } else {
+      params->output_height = 1 + (length_minus_window / params->stride);
+    }
   }
   TfLiteIntArray* output_size = TfLiteIntArrayCreate(3);
   output_size->data[0] = input->dims->data[1];
@@ -104,6 +141,57 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   return context->ResizeTensor(context, output, output_size);
 }
 
+// Computes the frames the input completes, and appends them to the frame
+// history of every channel.
+TfLiteStatus EvalStreaming(TfLiteContext* context,
+                           TfLiteAudioSpectrogramParams* params,
+                           const TfLiteTensor* input, TfLiteTensor* output) {
+  const float* input_data = GetTensorData<float>(input);
+  const int64_t sample_count = input->dims->data[0];
+  const int64_t channel_count = input->dims->data[1];
+  const int64_t output_width = params->spectrogram->output_frequency_channels();
+  const int64_t history_frames = params->output_frames;
+
+  std::vector<float> input_for_channel(sample_count);
+  std::vector<std::vector<float>> spectrogram_output;
+  for (int64_t channel = 0; channel < channel_count; ++channel) {
+    for (int i = 0; i < sample_count; ++i) {
+      input_for_channel[i] = input_data[i * channel_count + channel];
+    }
+    TF_LITE_ENSURE(context, (*params->channel_spectrograms)[channel]
+                                .ComputeSquaredMagnitudeSpectrogram(
+                                    input_for_channel, &spectrogram_output));
+
+    // Only the newest frames fit if there are more than the history holds.
+    const int64_t new_frames =
+        std::min<int64_t>(spectrogram_output.size(), history_frames);
+    const std::vector<float>* first_new_frame =
+        spectrogram_output.data() + spectrogram_output.size() - new_frames;
+    float* history = params->frame_history->data() +
+                     channel * history_frames * output_width;
+    memmove(history, history + new_frames * output_width,
+            (history_frames - new_frames) * output_width * sizeof(float));
+    for (int64_t frame = 0; frame < new_frames; ++frame) {
+      const std::vector<float>& spectrogram_row = first_new_frame[frame];
+      TF_LITE_ENSURE_EQ(context, spectrogram_row.size(), output_width);
+      float* history_row =
+          history + (history_frames - new_frames + frame) * output_width;
+      if (params->magnitude_squared) {
+        for (int i = 0; i < output_width; ++i) {
+          history_row[i] = spectrogram_row[i];
+        }
+      } else {
+        for (int i = 0; i < output_width; ++i) {
+          history_row[i] = sqrtf(spectrogram_row[i]);
+        }
+      }
+    }
+  }
+  memcpy(GetTensorData<float>(output), params->frame_history->data(),
+         params->frame_history->size() * sizeof(float));
+  return kTfLiteOk;
+}
+
 template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   auto* params =
@@ -115,8 +203,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_OK(context,
                     GetOutputSafe(context, node, kOutputTensor, &output));
 
-  TF_LITE_ENSURE(context, params->spectrogram->Initialize(params->window_size,
-                                                          params->stride));
+  if (params->streaming) {
+    return EvalStreaming(context, params, input, output);
+  }
 
   const float* input_data = GetTensorData<float>(input);
 
@@ -129,6 +218,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 
   std::vector<float> input_for_channel(sample_count);
   for (int64_t channel = 0; channel < channel_count; ++channel) {
+    // Drops the samples left over from the previous channel.
+    TF_LITE_ENSURE(context, params->spectrogram->Initialize(
+                                params->window_size, params->stride));
     float* output_slice =
         output_flat + (channel * params->output_height * output_width);
     for (int i = 0; i < sample_count; ++i) {
@@ -36,7 +36,8 @@ class BaseAudioSpectrogramOpModel : public SingleOpModel {
  public:
   BaseAudioSpectrogramOpModel(const TensorData& input1,
                               const TensorData& output, int window_size,
-                              int stride, bool magnitude_squared) {
+                              int stride, bool magnitude_squared,
+                              int streaming_output_frames = 0) {
     input1_ = AddInput(input1);
     output_ = AddOutput(output);
 
@@ -45,6 +46,10 @@ class BaseAudioSpectrogramOpModel : public SingleOpModel {
       fbb.Int("window_size", window_size);
       fbb.Int("stride", stride);
       fbb.Bool("magnitude_squared", magnitude_squared);
+      if (streaming_output_frames > 0) {
+        fbb.Bool("streaming", true);
+        fbb.Int("output_frames", streaming_output_frames);
+      }
     });
     fbb.Finish();
     SetCustomOp("AudioSpectrogram", fbb.GetBuffer(),
@@ -107,6 +112,63 @@ TEST(SpectrogramOpTest, StrideTest) {
                                  {0, 1, 4, 1, 0, 1, 2, 1, 2, 1}, 1e-3)));
 }
 
+TEST(SpectrogramOpTest, StreamingTest) {
+  const std::vector<float> audio = {-1.0f, 0.0f, 1.0f,  0.0f, -1.0f, 0.5f,
+                                    1.0f,  0.0f, 1.0f,  0.0f, -0.5f, 0.0f,
+                                    1.0f,  0.2f, -1.0f, 0.0f, 1.0f,  0.0f,
+                                    0.0f,  1.0f, 0.0f,  -1.0f, 0.0f, 1.0f};
+  const int kChunkSize = 4;
+  const int kOutputFrames = 3;
+  BaseAudioSpectrogramOpModel streaming(
+      {TensorType_FLOAT32, {kChunkSize, 2}}, {TensorType_FLOAT32, {}}, 8, 2,
+      false, kOutputFrames);
+
+  for (int end = kChunkSize; end <= audio.size(); end += kChunkSize) {
+    // The second channel is the first one at half the amplitude.
+    std::vector<float> chunk;
+    for (int i = end - kChunkSize; i < end; ++i) {
+      chunk.push_back(audio[i]);
+      chunk.push_back(0.5f * audio[i]);
+    }
+    streaming.PopulateTensor<float>(streaming.input1(), chunk);
+    streaming.Invoke();
+    EXPECT_THAT(streaming.GetOutputShape(), ElementsAre(2, kOutputFrames, 5));
+
+    // Every window of the audio so far, computed from scratch.
+    int whole_frames = 0;
+    std::vector<float> whole_output;
+    if (end >= 8) {
+      BaseAudioSpectrogramOpModel whole({TensorType_FLOAT32, {end, 2}},
+                                        {TensorType_FLOAT32, {}}, 8, 2, false);
+      std::vector<float> input;
+      for (int i = 0; i < end; ++i) {
+        input.push_back(audio[i]);
+        input.push_back(0.5f * audio[i]);
+      }
+      whole.PopulateTensor<float>(whole.input1(), input);
+      whole.Invoke();
+      whole_frames = whole.GetOutputShape()[1];
+      whole_output = whole.GetOutput();
+    }
+
+    // The output holds the latest frames, with zeros before the first one.
+    std::vector<float> expected;
+    for (int channel = 0; channel < 2; ++channel) {
+      for (int frame = whole_frames - kOutputFrames; frame < whole_frames;
+           ++frame) {
+        for (int i = 0; i < 5; ++i) {
+          expected.push_back(
+              frame < 0 ? 0.0f
+                        : whole_output[(channel * whole_frames + frame) * 5 +
+                                       i]);
+        }
+      }
+    }
+    EXPECT_THAT(streaming.GetOutput(),
+                ElementsAreArray(ArrayFloatNear(expected, 1e-5)));
+  }
+}
+
 }  // namespace
 }  // namespace custom
 }  // namespace ops
@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/optimized/multithreaded_conv.h"
 #endif
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/packed_int4.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/conv.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
@@ -381,6 +382,22 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
   const bool is_hybrid =
       (input->type == kTfLiteFloat32 &&
        (filter->type == kTfLiteUInt8 || filter->type == kTfLiteInt8));
+  // Packed int4 filters are read in place by EvalInt4, which needs neither
+  // im2col nor transposed weights.
+  const bool is_int4 = filter->type == kTfLiteInt4;
+  if (is_int4) {
+    TF_LITE_ENSURE_TYPES_EQ(context, input_type, kTfLiteFloat32);
+    TF_LITE_ENSURE_EQ(context, filter->quantization.type,
+                      kTfLiteAffineQuantization);
+    const auto* affine_quantization =
+        reinterpret_cast<TfLiteAffineQuantization*>(
+            filter->quantization.params);
+    TF_LITE_ENSURE(context, affine_quantization);
+    TF_LITE_ENSURE(context, affine_quantization->scale);
+    TF_LITE_ENSURE(context, affine_quantization->scale->size == 1 ||
+                                affine_quantization->scale->size ==
+                                    filter->dims->data[0]);
+  }
 
   if (is_hybrid && filter->type == kTfLiteInt8 &&
       filter->quantization.type == kTfLiteAffineQuantization &&
@@ -405,7 +422,7 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
   // is incompatible with mutable input filters that might change between evals.
   data->supports_multithreaded_kernel =
       (kernel_type == kMultithreadOptimized) &&
-      (context->recommended_num_threads != 1) && !is_hybrid &&
+      (context->recommended_num_threads != 1) && !is_hybrid && !is_int4 &&
       (params->dilation_width_factor == 1) &&
       (params->dilation_height_factor == 1) &&
       (filter->allocation_type != kTfLiteArenaRw) && !IsDynamicTensor(filter);
@@ -430,9 +447,16 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
   TF_LITE_ENSURE_STATUS(GetSizeOfType(context, input->type, &im2col_type_size));
   const size_t im2col_bytes = batches * out_height * out_width * channels_in *
                               filter_height * filter_width * im2col_type_size;
-  TF_LITE_ENSURE_STATUS(AllocateTemporaryTensorsIfRequired(
-      context, node, is_hybrid, data->is_hybrid_per_channel, kernel_type,
-      im2col_bytes));
+  if (is_int4) {
+    data->need_im2col = false;
+    data->need_hwcn_weights = false;
+    TfLiteIntArrayFree(node->temporaries);
+    node->temporaries = TfLiteIntArrayCreate(0);
+  } else {
+    TF_LITE_ENSURE_STATUS(AllocateTemporaryTensorsIfRequired(
+        context, node, is_hybrid, data->is_hybrid_per_channel, kernel_type,
+        im2col_bytes));
+  }
 
   TF_LITE_ENSURE(context, has_bias);
 
@@ -1048,6 +1072,74 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// Float convolution with a packed int4 filter. Every filter tap is a run of
+// input_depth packed values that is unpacked in registers while it is
+// multiplied with the input, so the filter is never expanded in memory.
+void EvalInt4(TfLiteConvParams* params, OpData* data,
+              const TfLiteTensor* input, const TfLiteTensor* filter,
+              const TfLiteTensor* bias, TfLiteTensor* output) {
+  float output_activation_min, output_activation_max;
+  CalculateActivationRange(params->activation, &output_activation_min,
+                           &output_activation_max);
+
+  const int batches = SizeOfDimension(input, 0);
+  const int input_height = SizeOfDimension(input, 1);
+  const int input_width = SizeOfDimension(input, 2);
+  const int input_depth = SizeOfDimension(input, 3);
+  const int output_depth = SizeOfDimension(filter, 0);
+  const int filter_height = SizeOfDimension(filter, 1);
+  const int filter_width = SizeOfDimension(filter, 2);
+  const int output_height = SizeOfDimension(output, 1);
+  const int output_width = SizeOfDimension(output, 2);
+
+  const auto* affine_quantization =
+      reinterpret_cast<TfLiteAffineQuantization*>(filter->quantization.params);
+  const float* scales = affine_quantization->scale->data;
+  const bool per_channel = affine_quantization->scale->size > 1;
+  const uint8_t* filter_data = GetTensorData<uint8_t>(filter);
+  const float* bias_data = GetTensorData<float>(bias);
+  const float* input_data = GetTensorData<float>(input);
+  float* output_data = GetTensorData<float>(output);
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin =
+          out_y * params->stride_height - data->padding.height;
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin =
+            out_x * params->stride_width - data->padding.width;
+        for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
+          float total = 0.0f;
+          for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+            const int in_y =
+                in_y_origin + params->dilation_height_factor * filter_y;
+            if (in_y < 0 || in_y >= input_height) continue;
+            for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+              const int in_x =
+                  in_x_origin + params->dilation_width_factor * filter_x;
+              if (in_x < 0 || in_x >= input_width) continue;
+              const int filter_start =
+                  ((out_channel * filter_height + filter_y) * filter_width +
+                   filter_x) *
+                  input_depth;
+              const float* input_ptr =
+                  input_data +
+                  ((batch * input_height + in_y) * input_width + in_x) *
+                      input_depth;
+              total += internal::PackedInt4DotProduct(
+                  filter_data, filter_start, input_depth, input_ptr);
+            }
+          }
+          float value = total * scales[per_channel ? out_channel : 0];
+          if (bias_data) value += bias_data[out_channel];
+          *output_data++ = ActivationFunctionWithMinMax(
+              value, output_activation_min, output_activation_max);
+        }
+      }
+    }
+  }
+}
+
 template <KernelType kernel_type, TfLiteType input_type>
 TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node) {
   auto* params = reinterpret_cast<TfLiteConvParams*>(node->builtin_data);
@@ -1078,7 +1170,9 @@ TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node) {
   TFLITE_DCHECK_EQ(input_type, input->type);
   switch (input_type) {  // Already know in/outtypes are same.
     case kTfLiteFloat32:
-      if (filter->type == kTfLiteUInt8 || filter->type == kTfLiteInt8) {
+      if (filter->type == kTfLiteInt4) {
+        EvalInt4(params, data, input, filter, bias, output);
+      } else if (filter->type == kTfLiteUInt8 || filter->type == kTfLiteInt8) {
         if (data->is_hybrid_per_channel) {
           TF_LITE_ENSURE_OK(context, EvalHybridPerChannel<kernel_type>(
                                          context, node, params, data, input,
@@ -45,6 +45,7 @@ TfLiteRegistration* Register_CONVOLUTION_CBLAS_OPT();
 
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
 
 template <typename FilterType>
@@ -861,6 +862,134 @@ TEST_P(ConvolutionOpTest, SimpleTestFloatWithDilation) {
   EXPECT_THAT(m.GetOutput(), ElementsAreArray({5, 5, 5, 5, 5, 5, 5, 5, 5}));
 }
 
+class Int4ConvolutionOpModel : public SingleOpModel {
+ public:
+  Int4ConvolutionOpModel(TfLiteRegistration* registration,
+                         const TensorData& input, const TensorData& filter,
+                         const std::vector<int8_t>& filter_values,
+                         int stride_width, int stride_height,
+                         enum Padding padding,
+                         enum ActivationFunctionType activation,
+                         int dilation_width_factor,
+                         int dilation_height_factor) {
+    input_ = AddInput(input);
+    AddConstInt4Input(filter, filter_values);
+    bias_ = AddInput({TensorType_FLOAT32, {filter.shape[0]}});
+    output_ = AddOutput({TensorType_FLOAT32, {}});
+
+    SetBuiltinOp(BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+                 CreateConv2DOptions(
+                     builder_, padding, stride_width, stride_height, activation,
+                     dilation_width_factor, dilation_height_factor)
+                     .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(BuiltinOperator_CONV_2D,
+                                                    registration);
+    BuildInterpreter({input.shape, filter.shape, GetShape(bias_)});
+  }
+
+  void SetBias(const std::vector<float>& f) { PopulateTensor(bias_, f); }
+  void SetInput(const std::vector<float>& f) { PopulateTensor(input_, f); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ private:
+  int input_;
+  int bias_;
+  int output_;
+};
+
+// Convolves an [1, height, width, depth] input with an [count, filter_height,
+// filter_width, depth] filter without padding.
+std::vector<float> NaiveValidConv(const std::vector<float>& input, int height,
+                                  int width, int depth,
+                                  const std::vector<float>& filter, int count,
+                                  int filter_height, int filter_width,
+                                  const std::vector<float>& bias) {
+  std::vector<float> output;
+  for (int y = 0; y + filter_height <= height; ++y) {
+    for (int x = 0; x + filter_width <= width; ++x) {
+      for (int c = 0; c < count; ++c) {
+        float total = bias[c];
+        for (int fy = 0; fy < filter_height; ++fy) {
+          for (int fx = 0; fx < filter_width; ++fx) {
+            const int input_start = ((y + fy) * width + x + fx) * depth;
+            const int filter_start =
+                ((c * filter_height + fy) * filter_width + fx) * depth;
+            for (int d = 0; d < depth; ++d) {
+              total += input[input_start + d] * filter[filter_start + d];
+            }
+          }
+        }
+        output.push_back(total);
+      }
+    }
+  }
+  return output;
+}
+
+TEST_P(ConvolutionOpTest, Int4FilterPerChannel) {
+  // An odd depth, so that most filter taps start in a high nibble.
+  const int height = 4, width = 5, depth = 3;
+  const int count = 2, filter_height = 2, filter_width = 3;
+  const std::vector<float> scales = {0.5, 0.25};
+  std::vector<int8_t> filter_values;
+  std::vector<float> filter;
+  for (int i = 0; i < count * filter_height * filter_width * depth; ++i) {
+    filter_values.push_back((i * 7) % 16 - 8);
+    filter.push_back(filter_values.back() *
+                     scales[i / (filter_height * filter_width * depth)]);
+  }
+  std::vector<float> input;
+  for (int i = 0; i < height * width * depth; ++i) {
+    input.push_back(((i * 5) % 11) * 0.5f - 2.0f);
+  }
+  const std::vector<float> bias = {1, -2};
+
+  Int4ConvolutionOpModel m(
+      GetRegistration(), {TensorType_FLOAT32, {1, height, width, depth}},
+      {TensorType_INT4,
+       {count, filter_height, filter_width, depth},
+       0,
+       0,
+       0,
+       0,
+       /*per_channel_quantization=*/true,
+       scales,
+       {0, 0}},
+      filter_values, /*stride_width=*/1, /*stride_height=*/1, Padding_VALID,
+      ActivationFunctionType_NONE, /*dilation_width_factor=*/1,
+      /*dilation_height_factor=*/1);
+  m.SetInput(input);
+  m.SetBias(bias);
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(1, 3, 3, count));
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  NaiveValidConv(input, height, width, depth, filter, count,
+                                 filter_height, filter_width, bias))));
+}
+
+TEST_P(ConvolutionOpTest, Int4FilterSamePaddingStrideAndDilation) {
+  Int4ConvolutionOpModel m(
+      GetRegistration(), {TensorType_FLOAT32, {1, 2, 2, 1}},
+      {TensorType_INT4, {1, 2, 2, 1}, 0, 0, /*scale=*/0.5}, {1, 2, 3, 4},
+      /*stride_width=*/1, /*stride_height=*/2, Padding_SAME,
+      ActivationFunctionType_RELU, /*dilation_width_factor=*/2,
+      /*dilation_height_factor=*/1);
+  m.SetInput({1, 2, 3, -4});
+  m.SetBias({0.5});
+  m.Invoke();
+
+  // The filter dequantizes to [0.5 1; 1.5 2], dilated to 2x3, and the image
+  // is padded by one column on each side. Each output only has one column of
+  // taps inside the image:
+  //   relu(1 * 2 + 2 * -4 + 0.5) = 0
+  //   relu(0.5 * 1 + 1.5 * 3 + 0.5) = 5.5
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(1, 1, 2, 1));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({0, 5.5})));
+}
+
 class QuantizedConvolutionOpModel : public BaseConvolutionOpModel<uint8_t> {
  public:
   using BaseConvolutionOpModel::BaseConvolutionOpModel;
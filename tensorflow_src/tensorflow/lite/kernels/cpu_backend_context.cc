@@ -118,6 +118,8 @@ CpuBackendContext* CpuBackendContext::GetFromContext(TfLiteContext* context) {
     external_context->set_internal_backend_context(
         std::unique_ptr<TfLiteInternalBackendContext>(cpu_backend_context));
   }
+  cpu_backend_context->set_profiler(
+      reinterpret_cast<Profiler*>(context->profiler));
 
   return cpu_backend_context;
 }
@@ -22,11 +22,14 @@ limitations under the License.
 #endif
 
 #include <memory>
+#include <vector>
 
 #include "public/gemmlowp.h"
 #include "ruy/context.h"  // from @ruy
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_timed_task.h"
 
 namespace tflite {
 
@@ -53,6 +56,18 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
 
   bool use_caching() const { return use_caching_; }
 
+  // The profiler of the graph whose operator last called GetFromContext(), or
+  // nullptr. cpu_backend_threadpool::Execute reports the tasks it runs to it.
+  Profiler* profiler() const { return profiler_; }
+
+  void set_profiler(Profiler* profiler) { profiler_ = profiler; }
+
+  // Storage cpu_backend_threadpool::Execute times the tasks in while a
+  // profiler is installed, grown to the largest task count seen.
+  std::vector<cpu_backend_threadpool::detail::TimedTask>* timed_tasks() {
+    return &timed_tasks_;
+  }
+
   void ClearCaches() override { ruy_context_->ClearPrepackedCache(); }
 
   bool HasAvxOrAbove();
@@ -114,6 +129,10 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
   // CpuBackendGem operations to a library that permits such an optimization
   // (currently the Ruy library only).
   bool use_caching_;
+  // Not owned. Refreshed by every GetFromContext() call, so that it follows
+  // the profiler installed on the interpreter.
+  Profiler* profiler_ = nullptr;
+  std::vector<cpu_backend_threadpool::detail::TimedTask> timed_tasks_;
 
   CpuBackendContext(const CpuBackendContext&) = delete;
 };
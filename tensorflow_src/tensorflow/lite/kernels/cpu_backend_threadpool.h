@@ -16,7 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_KERNELS_CPU_BACKEND_THREADPOOL_H_
 #define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_THREADPOOL_H_
 
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_timed_task.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 
 #ifdef TFLITE_WITH_RUY
@@ -31,30 +36,66 @@ namespace cpu_backend_threadpool {
 
 #ifdef TFLITE_WITH_RUY
 
-using Task = ruy::Task;
+namespace detail {
 
 template <typename TaskType>
-void Execute(int tasks_count, TaskType* tasks,
-             CpuBackendContext* cpu_backend_context) {
-  TFLITE_DCHECK_LE(tasks_count, cpu_backend_context->max_num_threads());
+void ExecuteOnThreadPool(int tasks_count, TaskType* tasks,
+                         CpuBackendContext* cpu_backend_context) {
   cpu_backend_context->ruy_context()->mutable_thread_pool()->Execute(
       tasks_count, tasks);
 }
 
+}  // namespace detail
+
 #else  // not TFLITE_WITH_RUY
 
-using Task = gemmlowp::Task;
+namespace detail {
 
 template <typename TaskType>
-void Execute(int tasks_count, TaskType* tasks,
-             CpuBackendContext* cpu_backend_context) {
-  TFLITE_DCHECK_LE(tasks_count, cpu_backend_context->max_num_threads());
+void ExecuteOnThreadPool(int tasks_count, TaskType* tasks,
+                         CpuBackendContext* cpu_backend_context) {
   cpu_backend_context->gemmlowp_context()->workers_pool()->Execute(tasks_count,
                                                                    tasks);
 }
 
+}  // namespace detail
+
 #endif
 
+// Runs `tasks` in parallel, one per thread, and returns once all are done.
+//
+// When a profiler is installed, every task is reported as a
+// CPU_BACKEND_TASK_EVENT. Tasks are timed on the thread that runs them but
+// reported from the calling thread after they all finish, so profilers do not
+// need to be thread-safe.
+template <typename TaskType>
+void Execute(int tasks_count, TaskType* tasks,
+             CpuBackendContext* cpu_backend_context) {
+  TFLITE_DCHECK_LE(tasks_count, cpu_backend_context->max_num_threads());
+  Profiler* profiler = cpu_backend_context->profiler();
+  if (profiler == nullptr) {
+    detail::ExecuteOnThreadPool(tasks_count, tasks, cpu_backend_context);
+    return;
+  }
+
+  std::vector<detail::TimedTask>& timed_tasks =
+      *cpu_backend_context->timed_tasks();
+  if (timed_tasks.size() < static_cast<size_t>(tasks_count)) {
+    timed_tasks.resize(tasks_count);
+  }
+  for (int i = 0; i < tasks_count; ++i) {
+    timed_tasks[i].Reset(&tasks[i]);
+  }
+  detail::ExecuteOnThreadPool(tasks_count, timed_tasks.data(),
+                              cpu_backend_context);
+  for (int i = 0; i < tasks_count; ++i) {
+    profiler->AddEvent("CpuBackendTask",
+                       Profiler::EventType::CPU_BACKEND_TASK_EVENT,
+                       timed_tasks[i].start_us(), timed_tasks[i].end_us(),
+                       /*event_metadata=*/i);
+  }
+}
+
 }  // namespace cpu_backend_threadpool
 }  // namespace tflite
 
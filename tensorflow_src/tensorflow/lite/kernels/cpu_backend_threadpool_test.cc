@@ -18,6 +18,7 @@ limitations under the License.
 #include <vector>
 
 #include <gtest/gtest.h>
+#include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 
 namespace tflite {
@@ -89,6 +90,63 @@ TEST(CpuBackendThreadpoolTest, TenThreadsSize1234567) {
   TestGenerateArrayOfIncrementingInts(10, 1234567);
 }
 
+class AddedEventsProfiler : public Profiler {
+ public:
+  struct Event {
+    EventType event_type;
+    uint64_t start;
+    uint64_t end;
+    int64_t event_metadata;
+  };
+
+  uint32_t BeginEvent(const char* tag, EventType event_type,
+                      int64_t event_metadata1,
+                      int64_t event_metadata2) override {
+    return 0;
+  }
+  void EndEvent(uint32_t event_handle) override {}
+  void AddEvent(const char* tag, EventType event_type, uint64_t start,
+                uint64_t end, int64_t event_metadata1,
+                int64_t event_metadata2) override {
+    events.push_back({event_type, start, end, event_metadata1});
+  }
+
+  std::vector<Event> events;
+};
+
+TEST(CpuBackendThreadpoolTest, ReportsTasksToProfiler) {
+  const int num_threads = 3;
+  std::vector<int> buffer(3000);
+  std::vector<TestGenerateArrayOfIncrementingIntsTask> tasks;
+  for (int thread = 0; thread < num_threads; thread++) {
+    tasks.emplace_back(buffer.data(), thread * 1000, (thread + 1) * 1000);
+  }
+  CpuBackendContext context;
+  context.SetMaxNumThreads(num_threads);
+  AddedEventsProfiler profiler;
+  context.set_profiler(&profiler);
+
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(), &context);
+
+  for (int i = 0; i < buffer.size(); i++) {
+    ASSERT_EQ(buffer[i], i);
+  }
+  ASSERT_EQ(num_threads, profiler.events.size());
+  for (int i = 0; i < num_threads; i++) {
+    EXPECT_EQ(Profiler::EventType::CPU_BACKEND_TASK_EVENT,
+              profiler.events[i].event_type);
+    EXPECT_EQ(i, profiler.events[i].event_metadata);
+    EXPECT_GT(profiler.events[i].start, 0);
+    EXPECT_LE(profiler.events[i].start, profiler.events[i].end);
+  }
+
+  // The timed tasks are kept in the context and reused.
+  const auto* timed_tasks = context.timed_tasks()->data();
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(), &context);
+  EXPECT_EQ(2 * num_threads, profiler.events.size());
+  EXPECT_EQ(timed_tasks, context.timed_tasks()->data());
+}
+
 }  // namespace
 
 }  // namespace tflite
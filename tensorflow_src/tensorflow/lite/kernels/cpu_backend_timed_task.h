@@ -0,0 +1,74 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_KERNELS_CPU_BACKEND_TIMED_TASK_H_
+#define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_TIMED_TASK_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/profiling/time.h"
+
+#ifdef TFLITE_WITH_RUY
+#include "ruy/thread_pool.h"  // from @ruy
+#else
+#include "public/gemmlowp.h"
+#endif
+
+namespace tflite {
+namespace cpu_backend_threadpool {
+
+#ifdef TFLITE_WITH_RUY
+using Task = ruy::Task;
+#else
+using Task = gemmlowp::Task;
+#endif
+
+namespace detail {
+
+// Runs a task and records when it started and ended, on the thread that runs
+// it. Kept by CpuBackendContext and reused across Execute() calls, so that
+// profiling the tasks does not allocate.
+class TimedTask : public Task {
+ public:
+  void Reset(Task* task) {
+    task_ = task;
+    start_us_ = 0;
+    end_us_ = 0;
+  }
+
+  void Run() override {
+#ifndef TFLITE_WITH_RUY
+    // gemmlowp hands the allocator of the worker to the task it runs.
+    task_->local_allocator = local_allocator;
+#endif
+    start_us_ = profiling::time::NowMicros();
+    task_->Run();
+    end_us_ = profiling::time::NowMicros();
+  }
+
+  uint64_t start_us() const { return start_us_; }
+  uint64_t end_us() const { return end_us_; }
+
+ private:
+  Task* task_ = nullptr;
+  uint64_t start_us_ = 0;
+  uint64_t end_us_ = 0;
+};
+
+}  // namespace detail
+}  // namespace cpu_backend_threadpool
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_CPU_BACKEND_TIMED_TASK_H_
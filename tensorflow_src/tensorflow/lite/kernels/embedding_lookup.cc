@@ -34,6 +34,7 @@ limitations under the License.
 #include <cstring>
 
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/packed_int4.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 
@@ -57,6 +58,22 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   TfLiteTensor* output;
   TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+  // Packed int4 rows are always dequantized, with one scale per row or one
+  // for the whole table.
+  if (value->type == kTfLiteInt4) {
+    TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteFloat32);
+    TF_LITE_ENSURE_EQ(context, value->quantization.type,
+                      kTfLiteAffineQuantization);
+    const auto* affine_quantization =
+        reinterpret_cast<TfLiteAffineQuantization*>(
+            value->quantization.params);
+    TF_LITE_ENSURE(context, affine_quantization);
+    TF_LITE_ENSURE(context, affine_quantization->scale);
+    TF_LITE_ENSURE(context, affine_quantization->scale->size == 1 ||
+                                affine_quantization->scale->size ==
+                                    SizeOfDimension(value, 0));
+  }
+
   TfLiteIntArray* outputSize = TfLiteIntArrayCreate(NumDimensions(value));
 
   outputSize->data[0] = SizeOfDimension(lookup, 0);
@@ -131,6 +148,38 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+TfLiteStatus EvalInt4(TfLiteContext* context, TfLiteNode* node,
+                      const TfLiteTensor* lookup, const TfLiteTensor* value,
+                      TfLiteTensor* output) {
+  const int row_size = SizeOfDimension(value, 0);
+  const int col_size = NumElements(value) / row_size;
+  const auto* affine_quantization =
+      reinterpret_cast<TfLiteAffineQuantization*>(value->quantization.params);
+  const float* scales = affine_quantization->scale->data;
+  const bool per_row = affine_quantization->scale->size > 1;
+
+  float* output_ptr = GetTensorData<float>(output);
+  const uint8_t* value_ptr = GetTensorData<uint8_t>(value);
+  const int32_t* lookup_data = GetTensorData<int32_t>(lookup);
+
+  for (int i = 0; i < SizeOfDimension(lookup, 0); i++) {
+    int idx = lookup_data[i];
+    if (idx >= row_size || idx < 0) {
+      context->ReportError(context,
+                           "Embedding Lookup: index out of bounds. "
+                           "Got %d, and bounds are [0, %d]",
+                           idx, row_size - 1);
+      return kTfLiteError;
+    }
+    // Only the looked up rows are unpacked, straight into the output.
+    internal::UnpackInt4ToFloat(value_ptr, idx * col_size, col_size,
+                                scales[per_row ? idx : 0],
+                                output_ptr + i * col_size);
+  }
+
+  return kTfLiteOk;
+}
+
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* lookup;
   TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 0, &lookup));
@@ -148,6 +197,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       } else {
         return EvalSimple(context, node, lookup, value, output);
       }
+    case kTfLiteInt4:
+      return EvalInt4(context, node, lookup, value, output);
     default:
       context->ReportError(context, "Type not currently supported.");
       return kTfLiteError;
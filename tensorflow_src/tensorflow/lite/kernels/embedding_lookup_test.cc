@@ -101,6 +101,29 @@ class HybridEmbeddingLookupOpModel : public BaseEmbeddingLookupOpModel {
   }
 };
 
+class Int4EmbeddingLookupOpModel : public SingleOpModel {
+ public:
+  Int4EmbeddingLookupOpModel(std::initializer_list<int> index_shape,
+                             const TensorData& weight,
+                             const std::vector<int8_t>& weight_values) {
+    input_ = AddInput(TensorType_INT32);
+    AddConstInt4Input(weight, weight_values);
+    output_ = AddOutput(TensorType_FLOAT32);
+    SetBuiltinOp(BuiltinOperator_EMBEDDING_LOOKUP, BuiltinOptions_NONE, 0);
+    BuildInterpreter({index_shape, weight.shape});
+  }
+
+  void SetInput(std::initializer_list<int> data) {
+    PopulateTensor(input_, data);
+  }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int input_;
+  int output_;
+};
+
 // TODO(ahentz): write more tests that exercise the details of the op, such as
 // lookup errors and variable input shapes.
 TEST(EmbeddingLookupOpTest, SimpleTest) {
@@ -261,5 +284,44 @@ TEST(EmbeddingLookupHybridOpTest, Simple3DTestQuantized) {
               }));
 }
 
+TEST(Int4EmbeddingLookupOpTest, Simple2DTestPerRowScales) {
+  // Rows of 3 packed values, so that row 1 starts in a high nibble.
+  Int4EmbeddingLookupOpModel m(
+      {4},
+      {TensorType_INT4, {3, 3}, 0, 0, 0, 0, true, {1.0, 0.5, 0.25}, {0, 0, 0}},
+      {
+          1, -2, 3,   // Row 0
+          -8, 7, 0,   // Row 1
+          4, -4, -1,  // Row 2
+      });
+  m.SetInput({2, 0, 1, 2});
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 1.0, -1.0, -0.25,  // Row 2
+                                 1.0, -2.0, 3.0,    // Row 0
+                                 -4.0, 3.5, 0.0,    // Row 1
+                                 1.0, -1.0, -0.25,  // Row 2
+                             })));
+}
+
+TEST(Int4EmbeddingLookupOpTest, Simple3DTestPerTensorScale) {
+  std::vector<int8_t> values;
+  for (int i = 0; i < 3 * 2 * 2; ++i) {
+    values.push_back(i - 6);
+  }
+  Int4EmbeddingLookupOpModel m({2}, {TensorType_INT4, {3, 2, 2}, 0, 0, 0.5},
+                               values);
+  m.SetInput({1, 2});
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 -1.0, -0.5, 0.0, 0.5,  // Row 1
+                                 1.0, 1.5, 2.0, 2.5,    // Row 2
+                             })));
+}
+
 }  // namespace
 }  // namespace tflite
@@ -115,11 +115,11 @@ TfLiteStatus FillString(const TfLiteTensor* value, TfLiteTensor* output) {
   for (int i = 0; i < output->dims->size; ++i) {
     n *= output->dims->data[i];
   }
+  buffer.Reserve(n, static_cast<size_t>(n) * string_ref.len);
   for (int i = 0; i < n; ++i) {
     buffer.AddString(string_ref.str, string_ref.len);
   }
-  buffer.WriteToTensor(output, /*new_shape=*/nullptr);
-  return kTfLiteOk;
+  return buffer.WriteToTensor(output, /*new_shape=*/nullptr);
 }
 
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
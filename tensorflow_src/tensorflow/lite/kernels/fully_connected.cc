@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/optimized/sparse_ops/fully_connected.h"
+#include "tensorflow/lite/kernels/internal/packed_int4.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/fully_connected.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
@@ -142,7 +143,24 @@ inline TfLiteStatus CheckTypes(TfLiteContext* context,
   const bool is_optional_bias_int =
       !bias || (bias->type == kTfLiteInt32) || (bias->type == kTfLiteInt64);
 
-  if (is_quantized) {
+  if (filter->type == kTfLiteInt4) {
+    // Packed int4 weights only run with float activations.
+    TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteFloat32);
+    TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteFloat32);
+    TF_LITE_ENSURE_EQ(context, is_optional_bias_float, true);
+    TF_LITE_ENSURE_EQ(context, params->weights_format,
+                      kTfLiteFullyConnectedWeightsFormatDefault);
+    TF_LITE_ENSURE_EQ(context, filter->quantization.type,
+                      kTfLiteAffineQuantization);
+    const auto* affine_quantization =
+        reinterpret_cast<TfLiteAffineQuantization*>(
+            filter->quantization.params);
+    TF_LITE_ENSURE(context, affine_quantization);
+    TF_LITE_ENSURE(context, affine_quantization->scale);
+    TF_LITE_ENSURE(context, affine_quantization->scale->size == 1 ||
+                                affine_quantization->scale->size ==
+                                    filter->dims->data[0]);
+  } else if (is_quantized) {
     if (is_shuffled) {
       TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteUInt8);
       TF_LITE_ENSURE_TYPES_EQ(context, filter->type, kTfLiteUInt8);
@@ -383,11 +401,12 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   const bool is_quantized =
       ((filter->type == kTfLiteUInt8) || (filter->type == kTfLiteInt8));
   const bool is_hybrid = is_quantized && (input->type == kTfLiteFloat32);
+  const bool is_int4 = filter->type == kTfLiteInt4;
   const bool is_pie = kernel_type == kLegacyPie;
 
-  // Pie and hybrid path supports all kinds of fused activations, otherwise only
-  // clipping activations are supported.
-  if (!is_pie && !is_hybrid) {
+  // Pie, hybrid and int4 paths support all kinds of fused activations,
+  // otherwise only clipping activations are supported.
+  if (!is_pie && !is_hybrid && !is_int4) {
     TF_LITE_ENSURE(context, params->activation == kTfLiteActNone ||
                                 params->activation == kTfLiteActRelu ||
                                 params->activation == kTfLiteActReluN1To1 ||
@@ -958,6 +977,37 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// Float activations with packed int4 weights, which are unpacked in the inner
+// loop of the matrix multiplication instead of being expanded to a buffer.
+TfLiteStatus EvalInt4(TfLiteContext* context, TfLiteNode* node,
+                      TfLiteFullyConnectedParams* params,
+                      const TfLiteTensor* input, const TfLiteTensor* filter,
+                      const TfLiteTensor* bias, TfLiteTensor* output) {
+  const int input_size = filter->dims->data[1];
+  const int batch_size = NumElements(input) / input_size;
+  const int num_units = filter->dims->data[0];
+  float* output_data = GetTensorData<float>(output);
+
+  // Output = bias if bias tensor exists.
+  if (bias) {
+    tensor_utils::VectorBatchVectorAssign(GetTensorData<float>(bias), num_units,
+                                          batch_size, output_data);
+  } else {
+    std::fill_n(output_data, batch_size * num_units, 0.0f);
+  }
+
+  const auto* affine_quantization =
+      reinterpret_cast<TfLiteAffineQuantization*>(filter->quantization.params);
+  internal::PackedInt4MatrixBatchVectorMultiplyAccumulate(
+      GetTensorData<uint8_t>(filter), num_units, input_size,
+      affine_quantization->scale->data, affine_quantization->scale->size,
+      GetTensorData<float>(input), batch_size, output_data);
+
+  tensor_utils::ApplyActivationToVector(output_data, batch_size * num_units,
+                                        params->activation, output_data);
+  return kTfLiteOk;
+}
+
 template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   auto* params =
@@ -1009,6 +1059,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                              "Unhandled fully-connected weights format");
         return kTfLiteError;
       }
+    case kTfLiteInt4:
+      return EvalInt4(context, node, params, input, filter, bias, output);
     default:
       context->ReportError(context,
                            "Filter data type %s currently not supported.",
@@ -355,6 +355,37 @@ class HybridFullyConnectedOpModel : public SingleOpModel {
   int input_size_;
 };
 
+class Int4FullyConnectedOpModel : public SingleOpModel {
+ public:
+  Int4FullyConnectedOpModel(TfLiteRegistration* registration, int units,
+                            int batches, int input_size,
+                            const TensorData& weights,
+                            const std::vector<int8_t>& weight_values,
+                            ActivationFunctionType activation) {
+    input_ = AddInput({TensorType_FLOAT32, {batches, input_size}});
+    AddConstInt4Input(weights, weight_values);
+    bias_ = AddInput({TensorType_FLOAT32, {units}});
+    output_ = AddOutput({TensorType_FLOAT32});
+
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, activation).Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), weights.shape, GetShape(bias_)});
+  }
+
+  void SetBias(const std::vector<float>& f) { PopulateTensor(bias_, f); }
+  void SetInput(const std::vector<float>& f) { PopulateTensor(input_, f); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ private:
+  int input_;
+  int bias_;
+  int output_;
+};
+
 const auto kKernelMap = new std::map<string, TfLiteRegistration*>({
     {"Reference", ops::builtin::Register_FULLY_CONNECTED_REF()},
     {"GenericOptimized", ops::builtin::Register_FULLY_CONNECTED_GENERIC_OPT()},
@@ -1116,6 +1147,53 @@ TEST_P(QuantizedFullyConnectedOpTest,
               ElementsAre(175, 177, 179, 243, 245, 247));
 }
 
+// Rows of 5 packed values, so that every other row starts in a high nibble.
+const std::vector<int8_t>* kInt4Weights = new std::vector<int8_t>({
+    1,  2,  3,  4,  5,   // u = 0
+    -1, -2, -3, -4, -5,  // u = 1
+    7,  -8, 0,  1,  -1,  // u = 2
+});
+
+TEST_P(FloatFullyConnectedOpTest, Int4WeightsPerChannel) {
+  Int4FullyConnectedOpModel m(
+      GetRegistration(), /*units=*/3, /*batches=*/2, /*input_size=*/5,
+      /*weights=*/
+      {TensorType_INT4, {3, 5}, 0, 0, 0, 0, true, {0.5, 0.25, 1.0}, {0, 0, 0}},
+      *kInt4Weights, ActivationFunctionType_NONE);
+  m.SetBias({1, 2, 3});
+  m.SetInput({
+      1, 2, 3, 4, 5,   // b = 0
+      -1, 0, 1, 0, 2,  // b = 1
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 28.5, -11.75, -7,  //
+                                 7, -1, -6,         //
+                             })));
+}
+
+TEST_P(FloatFullyConnectedOpTest, Int4WeightsPerTensorRelu) {
+  Int4FullyConnectedOpModel m(
+      GetRegistration(), /*units=*/3, /*batches=*/2, /*input_size=*/5,
+      /*weights=*/{TensorType_INT4, {3, 5}, 0, 0, 0.5}, *kInt4Weights,
+      ActivationFunctionType_RELU);
+  m.SetBias({1, 2, 3});
+  m.SetInput({
+      1, 2, 3, 4, 5,   // b = 0
+      -1, 0, 1, 0, 2,  // b = 1
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 28.5, 0, 0,  //
+                                 7, 0, 0,     //
+                             })));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     FloatFullyConnectedOpTest, FloatFullyConnectedOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMap)));
@@ -137,6 +137,7 @@ TfLiteStatus GatherStrings(TfLiteContext* context, const TfLiteTensor* input,
   const PositionT* indexes = GetTensorData<PositionT>(positions);
   const PositionT num_strings = GetStringCount(input);
   const int num_indexes = NumElements(positions);
+  buffer.Reserve(num_indexes, /*num_bytes=*/0);
 
   for (int i = 0; i < num_indexes; ++i) {
     const PositionT pos = indexes[i];
@@ -144,8 +145,7 @@ TfLiteStatus GatherStrings(TfLiteContext* context, const TfLiteTensor* input,
     const auto string_ref = GetString(input, pos);
     buffer.AddString(string_ref.str, string_ref.len);
   }
-  buffer.WriteToTensor(output, /*new_shape=*/nullptr);
-  return kTfLiteOk;
+  return buffer.WriteToTensor(output, /*new_shape=*/nullptr);
 }
 
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
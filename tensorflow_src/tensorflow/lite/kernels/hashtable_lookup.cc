@@ -143,7 +143,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     }
   }
   if (output->type == kTfLiteString) {
-    buf.WriteToTensorAsVector(output);
+    TF_LITE_ENSURE_OK(context, buf.WriteToTensorAsVector(output));
   }
 
   return kTfLiteOk;
@@ -0,0 +1,210 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/internal/optimized/depthwiseconv_3x3_filter_generic.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/depthwiseconv_uint8.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/depthwise_conv.h"
+#include "tensorflow/lite/kernels/internal/test_util.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace {
+
+using optimized_ops::depthwise_conv::DepthwiseConv3x3FilterGeneric;
+using optimized_ops::depthwise_conv::Generic3x3FilterKernelSupported;
+
+// Picks a random 3x3 configuration supported by the generic kernel. Depths
+// that are not a multiple of 4, and that span several channel blocks, are
+// included on purpose to exercise the leftover-channel path.
+void GenerateShapes(RuntimeShape* input_shape, RuntimeShape* filter_shape,
+                    RuntimeShape* output_shape, int* pad_width,
+                    int* pad_height, int* stride) {
+  const int batch = UniformRandomInt(1, 3);
+  const int depth = UniformRandomInt(4, 80);
+  const int input_width = UniformRandomInt(3, 30);
+  const int input_height = UniformRandomInt(3, 30);
+  *stride = UniformRandomInt(1, 2);
+  const auto padding_type =
+      UniformRandomInt(0, 1) ? PaddingType::kValid : PaddingType::kSame;
+
+  input_shape->BuildFrom({batch, input_height, input_width, depth});
+  filter_shape->BuildFrom({1, 3, 3, depth});
+  EXPECT_TRUE(ComputeConvSizes(*input_shape, depth, 3, 3, *stride,
+                               /*dilation_width_factor=*/1,
+                               /*dilation_height_factor=*/1, padding_type,
+                               output_shape, pad_width, pad_height));
+  EXPECT_TRUE(Generic3x3FilterKernelSupported(
+      *input_shape, *filter_shape, *stride, *stride,
+      /*dilation_width_factor=*/1, /*dilation_height_factor=*/1,
+      /*depth_multiplier=*/1, *output_shape));
+}
+
+DepthwiseParams MakeParams(int stride, int pad_width, int pad_height) {
+  DepthwiseParams params;
+  params.padding_type = PaddingType::kSame;
+  params.stride_width = stride;
+  params.stride_height = stride;
+  params.dilation_width_factor = 1;
+  params.dilation_height_factor = 1;
+  params.padding_values.width = pad_width;
+  params.padding_values.height = pad_height;
+  params.depth_multiplier = 1;
+  return params;
+}
+
+// Splits the output rows across `num_threads` slices the way the multithreaded
+// dispatcher does, and runs the kernel slice by slice.
+template <typename T, bool kPerChannel>
+void RunGenericByRows(const DepthwiseParams& params,
+                      const int32* output_multiplier, const int32* output_shift,
+                      const RuntimeShape& input_shape, const T* input_data,
+                      const RuntimeShape& filter_shape, const T* filter_data,
+                      const RuntimeShape& bias_shape, const int32* bias_data,
+                      const RuntimeShape& output_shape, T* output_data,
+                      int num_threads) {
+  const int rows = output_shape.Dims(1);
+  int start = 0;
+  for (int i = 0; i < num_threads; ++i) {
+    const int end = start + (rows - start) / (num_threads - i);
+    DepthwiseConv3x3FilterGeneric<T, kPerChannel>(
+        params, output_multiplier, output_shift, input_shape, input_data,
+        filter_shape, filter_data, bias_shape, bias_data, output_shape,
+        output_data, start, end, /*thread_dim=*/1);
+    start = end;
+  }
+}
+
+void TestOneUint8() {
+  RuntimeShape input_shape, filter_shape, output_shape;
+  int pad_width, pad_height, stride;
+  GenerateShapes(&input_shape, &filter_shape, &output_shape, &pad_width,
+                 &pad_height, &stride);
+  const int depth = output_shape.Dims(3);
+  RuntimeShape bias_shape({1, 1, 1, depth});
+
+  std::vector<uint8> input_data(input_shape.FlatSize());
+  std::vector<uint8> filter_data(filter_shape.FlatSize());
+  std::vector<int32> bias_data(depth);
+  FillRandom(&input_data);
+  FillRandom(&filter_data);
+  FillRandom(&bias_data, -10000, 10000);
+
+  DepthwiseParams params = MakeParams(stride, pad_width, pad_height);
+  params.input_offset = -UniformRandomInt(0, 255);
+  params.weights_offset = -UniformRandomInt(0, 255);
+  params.output_offset = UniformRandomInt(0, 255);
+  params.quantized_activation_min = UniformRandomInt(0, 64);
+  params.quantized_activation_max = UniformRandomInt(192, 255);
+  QuantizeMultiplier(UniformRandomFloat(1e-5f, 1e-3f),
+                     &params.output_multiplier, &params.output_shift);
+
+  std::vector<uint8> reference_output(output_shape.FlatSize());
+  std::vector<uint8> generic_output(output_shape.FlatSize());
+  reference_ops::DepthwiseConv(params, input_shape, input_data.data(),
+                               filter_shape, filter_data.data(), bias_shape,
+                               bias_data.data(), output_shape,
+                               reference_output.data());
+  RunGenericByRows<uint8, false>(
+      params, &params.output_multiplier, &params.output_shift, input_shape,
+      input_data.data(), filter_shape, filter_data.data(), bias_shape,
+      bias_data.data(), output_shape, generic_output.data(),
+      UniformRandomInt(1, 3));
+
+  // Both kernels use MultiplyByQuantizedMultiplier, so results are exact.
+  EXPECT_EQ(reference_output, generic_output);
+}
+
+void TestOneInt8PerChannel() {
+  RuntimeShape input_shape, filter_shape, output_shape;
+  int pad_width, pad_height, stride;
+  GenerateShapes(&input_shape, &filter_shape, &output_shape, &pad_width,
+                 &pad_height, &stride);
+  const int depth = output_shape.Dims(3);
+  RuntimeShape bias_shape({1, 1, 1, depth});
+
+  std::vector<int8> input_data(input_shape.FlatSize());
+  std::vector<int8> filter_data(filter_shape.FlatSize());
+  std::vector<int32> bias_data(depth);
+  FillRandom(&input_data);
+  FillRandom(&filter_data);
+  FillRandom(&bias_data, -1000, 1000);
+
+  DepthwiseParams params = MakeParams(stride, pad_width, pad_height);
+  params.input_offset = UniformRandomInt(-127, 128);
+  params.weights_offset = 0;
+  params.output_offset = UniformRandomInt(-25, 25);
+  params.quantized_activation_min = -128;
+  params.quantized_activation_max = 127;
+
+  std::vector<int32> output_multiplier(depth);
+  std::vector<int32> output_shift(depth);
+  for (int i = 0; i < depth; ++i) {
+    QuantizeMultiplier(UniformRandomFloat(1e-4f, 5e-3f), &output_multiplier[i],
+                       &output_shift[i]);
+  }
+
+  std::vector<int8> reference_output(output_shape.FlatSize());
+  std::vector<int8> generic_output(output_shape.FlatSize());
+  reference_integer_ops::DepthwiseConvPerChannel(
+      params, output_multiplier.data(), output_shift.data(), input_shape,
+      input_data.data(), filter_shape, filter_data.data(), bias_shape,
+      bias_data.data(), output_shape, reference_output.data());
+  RunGenericByRows<int8, true>(
+      params, output_multiplier.data(), output_shift.data(), input_shape,
+      input_data.data(), filter_shape, filter_data.data(), bias_shape,
+      bias_data.data(), output_shape, generic_output.data(),
+      UniformRandomInt(1, 3));
+
+  EXPECT_EQ(reference_output, generic_output);
+}
+
+TEST(DepthwiseConv3x3FilterGenericTest, Uint8MatchesReference) {
+  for (int i = 0; i < 60; ++i) {
+    TestOneUint8();
+  }
+}
+
+TEST(DepthwiseConv3x3FilterGenericTest, Int8PerChannelMatchesReference) {
+  for (int i = 0; i < 60; ++i) {
+    TestOneInt8PerChannel();
+  }
+}
+
+TEST(DepthwiseConv3x3FilterGenericTest, UnsupportedShapes) {
+  const RuntimeShape input_shape({1, 8, 8, 16});
+  const RuntimeShape output_shape({1, 8, 8, 16});
+  // 5x5 filter.
+  EXPECT_FALSE(Generic3x3FilterKernelSupported(
+      input_shape, RuntimeShape({1, 5, 5, 16}), 1, 1, 1, 1, 1, output_shape));
+  // Mismatched strides.
+  EXPECT_FALSE(Generic3x3FilterKernelSupported(
+      input_shape, RuntimeShape({1, 3, 3, 16}), 1, 2, 1, 1, 1, output_shape));
+  // Dilation.
+  EXPECT_FALSE(Generic3x3FilterKernelSupported(
+      input_shape, RuntimeShape({1, 3, 3, 16}), 1, 1, 2, 2, 1, output_shape));
+  // Depth multiplier.
+  EXPECT_FALSE(Generic3x3FilterKernelSupported(
+      input_shape, RuntimeShape({1, 3, 3, 32}), 1, 1, 1, 1, 2,
+      RuntimeShape({1, 8, 8, 32})));
+}
+
+}  // namespace
+}  // namespace tflite
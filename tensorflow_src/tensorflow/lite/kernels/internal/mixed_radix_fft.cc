@@ -0,0 +1,356 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/internal/mixed_radix_fft.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+namespace tflite {
+namespace internal {
+
+using std::complex;
+
+namespace {
+
+// Some platforms don't have M_PI, so define a local constant here.
+const double kPi = 3.14159265358979323846;
+
+complex<double> UnitRoot(int numerator, int denominator) {
+  const double angle = -2.0 * kPi * numerator / denominator;
+  return complex<double>(cos(angle), sin(angle));
+}
+
+// The operators of std::complex check for infinities and NaNs, which keeps
+// them from being inlined into the butterflies.
+template <typename T>
+inline complex<T> Mul(const complex<T>& a, const complex<T>& b) {
+  return complex<T>(a.real() * b.real() - a.imag() * b.imag(),
+                    a.real() * b.imag() + a.imag() * b.real());
+}
+
+template <typename T>
+inline complex<T> MulNegI(const complex<T>& a) {
+  return complex<T>(a.imag(), -a.real());
+}
+
+// Every stage turns `count` butterflies of `radix` inputs, which are `count`
+// points apart in the sub-transform being computed, into `radix` adjacent
+// outputs. Points are `stride` values apart, and the inner loop runs over the
+// `stride` sequences that share the butterfly's twiddles.
+
+template <typename T>
+void Radix2(const complex<T>* x, complex<T>* y, int count, int stride,
+            const complex<T>* twiddles) {
+  for (int p = 0; p < count; ++p) {
+    const complex<T> w1 = twiddles[p];
+    const complex<T>* x0 = x + p * stride;
+    const complex<T>* x1 = x0 + count * stride;
+    complex<T>* y0 = y + 2 * p * stride;
+    complex<T>* y1 = y0 + stride;
+    for (int q = 0; q < stride; ++q) {
+      const complex<T> a0 = x0[q];
+      const complex<T> a1 = x1[q];
+      y0[q] = a0 + a1;
+      y1[q] = Mul(a0 - a1, w1);
+    }
+  }
+}
+
+template <typename T>
+void Radix3(const complex<T>* x, complex<T>* y, int count, int stride,
+            const complex<T>* twiddles) {
+  const T sin_third = static_cast<T>(sin(2.0 * kPi / 3.0));
+  for (int p = 0; p < count; ++p) {
+    const complex<T> w1 = twiddles[2 * p];
+    const complex<T> w2 = twiddles[2 * p + 1];
+    const complex<T>* x0 = x + p * stride;
+    const complex<T>* x1 = x0 + count * stride;
+    const complex<T>* x2 = x1 + count * stride;
+    complex<T>* y0 = y + 3 * p * stride;
+    complex<T>* y1 = y0 + stride;
+    complex<T>* y2 = y1 + stride;
+    for (int q = 0; q < stride; ++q) {
+      const complex<T> a0 = x0[q];
+      const complex<T> t1 = x1[q] + x2[q];
+      const complex<T> t2 = a0 - t1 * static_cast<T>(0.5);
+      const complex<T> t3 = MulNegI(x1[q] - x2[q]) * sin_third;
+      y0[q] = a0 + t1;
+      y1[q] = Mul(t2 + t3, w1);
+      y2[q] = Mul(t2 - t3, w2);
+    }
+  }
+}
+
+template <typename T>
+void Radix4(const complex<T>* x, complex<T>* y, int count, int stride,
+            const complex<T>* twiddles) {
+  for (int p = 0; p < count; ++p) {
+    const complex<T> w1 = twiddles[3 * p];
+    const complex<T> w2 = twiddles[3 * p + 1];
+    const complex<T> w3 = twiddles[3 * p + 2];
+    const complex<T>* x0 = x + p * stride;
+    const complex<T>* x1 = x0 + count * stride;
+    const complex<T>* x2 = x1 + count * stride;
+    const complex<T>* x3 = x2 + count * stride;
+    complex<T>* y0 = y + 4 * p * stride;
+    complex<T>* y1 = y0 + stride;
+    complex<T>* y2 = y1 + stride;
+    complex<T>* y3 = y2 + stride;
+    for (int q = 0; q < stride; ++q) {
+      const complex<T> t0 = x0[q] + x2[q];
+      const complex<T> t1 = x0[q] - x2[q];
+      const complex<T> t2 = x1[q] + x3[q];
+      const complex<T> t3 = MulNegI(x1[q] - x3[q]);
+      y0[q] = t0 + t2;
+      y1[q] = Mul(t1 + t3, w1);
+      y2[q] = Mul(t0 - t2, w2);
+      y3[q] = Mul(t1 - t3, w3);
+    }
+  }
+}
+
+template <typename T>
+void Radix5(const complex<T>* x, complex<T>* y, int count, int stride,
+            const complex<T>* twiddles) {
+  const T c1 = static_cast<T>(cos(2.0 * kPi / 5.0));
+  const T c2 = static_cast<T>(cos(4.0 * kPi / 5.0));
+  const T s1 = static_cast<T>(sin(2.0 * kPi / 5.0));
+  const T s2 = static_cast<T>(sin(4.0 * kPi / 5.0));
+  for (int p = 0; p < count; ++p) {
+    const complex<T>* w = twiddles + 4 * p;
+    const complex<T>* x0 = x + p * stride;
+    const complex<T>* x1 = x0 + count * stride;
+    const complex<T>* x2 = x1 + count * stride;
+    const complex<T>* x3 = x2 + count * stride;
+    const complex<T>* x4 = x3 + count * stride;
+    complex<T>* y0 = y + 5 * p * stride;
+    complex<T>* y1 = y0 + stride;
+    complex<T>* y2 = y1 + stride;
+    complex<T>* y3 = y2 + stride;
+    complex<T>* y4 = y3 + stride;
+    for (int q = 0; q < stride; ++q) {
+      const complex<T> a0 = x0[q];
+      const complex<T> b1 = x1[q] + x4[q];
+      const complex<T> b2 = x2[q] + x3[q];
+      const complex<T> d1 = x1[q] - x4[q];
+      const complex<T> d2 = x2[q] - x3[q];
+      const complex<T> t1 = a0 + b1 * c1 + b2 * c2;
+      const complex<T> t2 = a0 + b1 * c2 + b2 * c1;
+      const complex<T> u1 = MulNegI(d1 * s1 + d2 * s2);
+      const complex<T> u2 = MulNegI(d1 * s2 - d2 * s1);
+      y0[q] = a0 + b1 + b2;
+      y1[q] = Mul(t1 + u1, w[0]);
+      y2[q] = Mul(t2 + u2, w[1]);
+      y3[q] = Mul(t2 - u2, w[2]);
+      y4[q] = Mul(t1 - u1, w[3]);
+    }
+  }
+}
+
+// Plain DFT butterflies, for the prime factors without a dedicated stage.
+template <typename T>
+void RadixGeneric(const complex<T>* x, complex<T>* y, int radix, int count,
+                  int stride, const complex<T>* twiddles,
+                  const complex<T>* roots) {
+  for (int p = 0; p < count; ++p) {
+    const complex<T>* w = twiddles + (radix - 1) * p;
+    const complex<T>* x0 = x + p * stride;
+    complex<T>* y0 = y + radix * p * stride;
+    for (int q = 0; q < stride; ++q) {
+      y0[q] = x0[q];
+    }
+    for (int k = 1; k < radix; ++k) {
+      const complex<T>* xk = x0 + k * count * stride;
+      for (int q = 0; q < stride; ++q) {
+        y0[q] += xk[q];
+      }
+    }
+    for (int t = 1; t < radix; ++t) {
+      complex<T>* yt = y0 + t * stride;
+      for (int q = 0; q < stride; ++q) {
+        complex<T> sum = x0[q];
+        for (int k = 1; k < radix; ++k) {
+          sum += Mul(x0[k * count * stride + q], roots[(k * t) % radix]);
+        }
+        yt[q] = Mul(sum, w[t - 1]);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+template <typename T>
+bool MixedRadixFft<T>::Initialize(int size) {
+  size_ = 0;
+  stages_.clear();
+  twiddles_.clear();
+  if (size < 1) {
+    return false;
+  }
+  size_ = size;
+
+  std::vector<int> radices;
+  int remaining = size;
+  while (remaining % 4 == 0) {
+    radices.push_back(4);
+    remaining /= 4;
+  }
+  if (remaining % 2 == 0) {
+    radices.push_back(2);
+    remaining /= 2;
+  }
+  for (int factor = 3; factor * factor <= remaining; factor += 2) {
+    while (remaining % factor == 0) {
+      radices.push_back(factor);
+      remaining /= factor;
+    }
+  }
+  if (remaining > 1) {
+    radices.push_back(remaining);
+  }
+
+  // The first stage splits the whole transform, every following one the
+  // sub-transforms left by the previous stage.
+  remaining = size;
+  for (int radix : radices) {
+    Stage stage;
+    stage.radix = radix;
+    stage.count = remaining / radix;
+    stage.twiddle_offset = twiddles_.size();
+    for (int p = 0; p < stage.count; ++p) {
+      for (int t = 1; t < radix; ++t) {
+        twiddles_.push_back(complex<T>(UnitRoot(p * t, remaining)));
+      }
+    }
+    stage.roots_offset = twiddles_.size();
+    if (radix > 5) {
+      for (int k = 0; k < radix; ++k) {
+        twiddles_.push_back(complex<T>(UnitRoot(k, radix)));
+      }
+    }
+    stages_.push_back(stage);
+    remaining = stage.count;
+  }
+  return true;
+}
+
+template <typename T>
+void MixedRadixFft<T>::Forward(complex<T>* data, complex<T>* work,
+                               int batch) const {
+  complex<T>* x = data;
+  complex<T>* y = work;
+  int stride = batch;
+  for (const Stage& stage : stages_) {
+    const complex<T>* twiddles = twiddles_.data() + stage.twiddle_offset;
+    switch (stage.radix) {
+      case 2:
+        Radix2(x, y, stage.count, stride, twiddles);
+        break;
+      case 3:
+        Radix3(x, y, stage.count, stride, twiddles);
+        break;
+      case 4:
+        Radix4(x, y, stage.count, stride, twiddles);
+        break;
+      case 5:
+        Radix5(x, y, stage.count, stride, twiddles);
+        break;
+      default:
+        RadixGeneric(x, y, stage.radix, stage.count, stride, twiddles,
+                     twiddles_.data() + stage.roots_offset);
+        break;
+    }
+    stride *= stage.radix;
+    std::swap(x, y);
+  }
+  if (x != data) {
+    std::copy(x, x + size_ * batch, data);
+  }
+}
+
+template <typename T>
+bool RealFft<T>::Initialize(int size) {
+  size_ = 0;
+  split_twiddles_.clear();
+  if (size < 1) {
+    return false;
+  }
+  size_ = size;
+  if (size % 2 != 0) {
+    return fft_.Initialize(size);
+  }
+  // X[k] = (Z[k] + conj(Z[h - k])) / 2 - i / 2 * W^k * (Z[k] - conj(Z[h - k]))
+  // with Z the FFT of the h = size / 2 packed samples x[2n] + i * x[2n + 1].
+  const int half_size = size / 2;
+  split_twiddles_.resize(half_size + 1);
+  for (int k = 0; k <= half_size; ++k) {
+    const complex<double> w = UnitRoot(k, size);
+    split_twiddles_[k] = complex<T>(0.5 * w.imag(), -0.5 * w.real());
+  }
+  return fft_.Initialize(half_size);
+}
+
+template <typename T>
+int RealFft<T>::work_size() const {
+  return size_ % 2 == 0 ? size_ / 2 : 2 * size_;
+}
+
+template <typename T>
+void RealFft<T>::Forward(const T* input, int input_size, complex<T>* output,
+                         complex<T>* work) const {
+  const int valid_size = std::min(input_size, size_);
+  if (size_ % 2 != 0) {
+    for (int i = 0; i < valid_size; ++i) {
+      work[i] = complex<T>(input[i], 0);
+    }
+    std::fill(work + valid_size, work + size_, complex<T>(0, 0));
+    fft_.Forward(work, work + size_, 1);
+    std::copy(work, work + output_size(), output);
+    return;
+  }
+
+  // Runs the packed FFT in the output, which has room for it.
+  const int half_size = size_ / 2;
+  for (int i = 0; i < half_size; ++i) {
+    const T real = 2 * i < valid_size ? input[2 * i] : 0;
+    const T imag = 2 * i + 1 < valid_size ? input[2 * i + 1] : 0;
+    output[i] = complex<T>(real, imag);
+  }
+  fft_.Forward(output, work, 1);
+
+  // Splits the pairs of values mirroring each other in place.
+  const complex<T> z0 = output[0];
+  output[0] = complex<T>(z0.real() + z0.imag(), 0);
+  output[half_size] = complex<T>(z0.real() - z0.imag(), 0);
+  for (int k = 1; 2 * k <= half_size; ++k) {
+    const int j = half_size - k;
+    const complex<T> zk = output[k];
+    const complex<T> zj = output[j];
+    output[k] = (zk + std::conj(zj)) * static_cast<T>(0.5) +
+                Mul(zk - std::conj(zj), split_twiddles_[k]);
+    output[j] = (zj + std::conj(zk)) * static_cast<T>(0.5) +
+                Mul(zj - std::conj(zk), split_twiddles_[j]);
+  }
+}
+
+template class MixedRadixFft<float>;
+template class MixedRadixFft<double>;
+template class RealFft<float>;
+template class RealFft<double>;
+
+}  // namespace internal
+}  // namespace tflite
@@ -0,0 +1,99 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_MIXED_RADIX_FFT_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_MIXED_RADIX_FFT_H_
+
+#include <complex>
+#include <vector>
+
+namespace tflite {
+namespace internal {
+
+// Forward complex FFT of any length. The length is factored into radix 4, 2,
+// 3 and 5 stages, and a plain DFT stage for every other prime factor p, which
+// costs O(length * p). All twiddles are computed once, in double precision,
+// by Initialize(). The stages run in Stockham order, so there is no bit
+// reversal pass, and `batch` interleaved sequences share every twiddle load.
+//
+// The template parameter can be float or double.
+template <typename T>
+class MixedRadixFft {
+ public:
+  MixedRadixFft() : size_(0) {}
+
+  // Plans transforms of `size` points. Returns false if size is not positive.
+  bool Initialize(int size);
+
+  int size() const { return size_; }
+
+  // Transforms `batch` sequences in place, point i of sequence b being
+  // data[i * batch + b]. `work` must hold size() * batch values.
+  void Forward(std::complex<T>* data, std::complex<T>* work, int batch) const;
+
+ private:
+  struct Stage {
+    int radix;
+    // Number of butterflies per sequence, size of the remaining sub-transform
+    // divided by radix.
+    int count;
+    // Offset of the (radix - 1) * count twiddles of the stage in twiddles_.
+    int twiddle_offset;
+    // Offset of the radix roots of unity of a plain DFT stage in twiddles_.
+    int roots_offset;
+  };
+
+  int size_;
+  std::vector<Stage> stages_;
+  std::vector<std::complex<T>> twiddles_;
+};
+
+// Forward FFT of a real sequence of any length, producing the size() / 2 + 1
+// non-redundant values of its spectrum. Even lengths run a complex FFT of
+// half the length over the samples packed in pairs.
+template <typename T>
+class RealFft {
+ public:
+  RealFft() : size_(0) {}
+
+  // Plans transforms of `size` points. Returns false if size is not positive.
+  bool Initialize(int size);
+
+  int size() const { return size_; }
+  int output_size() const { return size_ / 2 + 1; }
+  // Number of values Forward() needs in `work`.
+  int work_size() const;
+
+  // Transforms the first size() samples of `input`, of which there are
+  // `input_size`, zero-padding it if it is shorter. Writes output_size()
+  // values to `output`.
+  void Forward(const T* input, int input_size, std::complex<T>* output,
+               std::complex<T>* work) const;
+
+ private:
+  int size_;
+  MixedRadixFft<T> fft_;
+  // Twiddles combining the packed half length FFT into the real one.
+  std::vector<std::complex<T>> split_twiddles_;
+};
+
+extern template class MixedRadixFft<float>;
+extern template class MixedRadixFft<double>;
+extern template class RealFft<float>;
+extern template class RealFft<double>;
+
+}  // namespace internal
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_MIXED_RADIX_FFT_H_
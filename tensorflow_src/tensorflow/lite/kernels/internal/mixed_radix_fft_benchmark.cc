@@ -0,0 +1,121 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Compares the 2D real FFT of RFFT2D, rows of RealFft followed by batched
+// columns of MixedRadixFft, with the rdft2d function of fft2d it replaced.
+// fft2d only handles powers of two, so other sizes only time the former.
+//
+// Usage: mixed_radix_fft_benchmark [iterations]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <vector>
+
+#include "third_party/fft2d/fft2d.h"
+#include "tensorflow/lite/kernels/internal/mixed_radix_fft.h"
+
+namespace {
+
+using std::complex;
+
+bool IsPowerOfTwo(int v) { return v && !(v & (v - 1)); }
+
+template <typename F>
+double MicrosecondsPerCall(int iterations, F&& function) {
+  function();  // Warms up the caches.
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    function();
+  }
+  const std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+double TimeMixedRadix(int height, int width, int iterations,
+                      const std::vector<float>& input) {
+  tflite::internal::RealFft<float> row_fft;
+  tflite::internal::MixedRadixFft<float> column_fft;
+  row_fft.Initialize(width);
+  column_fft.Initialize(height);
+  const int output_width = row_fft.output_size();
+  std::vector<complex<float>> output(height * output_width);
+  std::vector<complex<float>> work(
+      std::max(row_fft.work_size(), height * output_width));
+  return MicrosecondsPerCall(iterations, [&]() {
+    for (int i = 0; i < height; ++i) {
+      row_fft.Forward(input.data() + i * width, width,
+                      output.data() + i * output_width, work.data());
+    }
+    column_fft.Forward(output.data(), work.data(), output_width);
+  });
+}
+
+double TimeFft2d(int height, int width, int iterations,
+                 const std::vector<float>& input) {
+  std::vector<std::vector<double>> rows(height,
+                                        std::vector<double>(width + 2));
+  std::vector<double*> row_pointers(height);
+  for (int i = 0; i < height; ++i) {
+    row_pointers[i] = rows[i].data();
+  }
+  const int working_length = std::max(height, width / 2);
+  std::vector<int> integer_working_area(
+      2 + static_cast<int>(sqrt(working_length)));
+  std::vector<double> double_working_area(working_length / 2 + width / 4);
+  return MicrosecondsPerCall(iterations, [&]() {
+    for (int i = 0; i < height; ++i) {
+      std::copy(input.data() + i * width, input.data() + (i + 1) * width,
+                rows[i].begin());
+    }
+    // Zero the first element so that the working areas are initialized on
+    // every call, as RFFT2D used to.
+    integer_working_area[0] = 0;
+    rdft2d(height, width, 1, row_pointers.data(), nullptr,
+           integer_working_area.data(), double_working_area.data());
+  });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int iterations = argc > 1 ? atoi(argv[1]) : 200;
+  const int sizes[][2] = {{64, 64},   {128, 128}, {256, 256}, {512, 512},
+                          {96, 96},   {100, 100}, {240, 320}, {49, 161},
+                          {480, 640}, {97, 97}};
+  printf("%-10s %16s %16s\n", "size", "mixed radix us", "fft2d us");
+  for (const auto& size : sizes) {
+    const int height = size[0];
+    const int width = size[1];
+    std::vector<float> input(height * width);
+    for (int i = 0; i < input.size(); ++i) {
+      input[i] = sin(i * 0.01f) + (i % 7) * 0.1f;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "%dx%d", height, width);
+    const double mixed_radix = TimeMixedRadix(height, width, iterations, input);
+    if (IsPowerOfTwo(height) && IsPowerOfTwo(width)) {
+      const double fft2d = TimeFft2d(height, width, iterations, input);
+      printf("%-10s %16.1f %16.1f\n", name, mixed_radix, fft2d);
+    } else {
+      printf("%-10s %16.1f %16s\n", name, mixed_radix, "-");
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,135 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/internal/mixed_radix_fft.h"
+
+#include <math.h>
+
+#include <complex>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace internal {
+namespace {
+
+using std::complex;
+
+const int kSizes[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 12, 15, 16, 22,
+                      25, 30, 49, 60, 64, 97, 100, 128, 360, 512};
+
+std::vector<complex<double>> NaiveDft(
+    const std::vector<complex<double>>& input) {
+  const int size = input.size();
+  std::vector<complex<double>> output(size);
+  for (int k = 0; k < size; ++k) {
+    for (int n = 0; n < size; ++n) {
+      const double angle = -2.0 * M_PI * ((static_cast<int64_t>(k) * n) %
+                                          size) / size;
+      output[k] += input[n] * complex<double>(cos(angle), sin(angle));
+    }
+  }
+  return output;
+}
+
+template <typename T>
+class MixedRadixFftTest : public ::testing::Test {};
+
+using Types = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(MixedRadixFftTest, Types);
+
+template <typename T>
+double Tolerance(int size) {
+  return (sizeof(T) == 4 ? 1e-5 : 1e-12) * size;
+}
+
+TYPED_TEST(MixedRadixFftTest, MatchesDftForAllRadices) {
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+  for (int size : kSizes) {
+    const int batch = 3;
+    std::vector<std::vector<complex<double>>> inputs(batch);
+    std::vector<complex<TypeParam>> data(size * batch);
+    for (int b = 0; b < batch; ++b) {
+      for (int i = 0; i < size; ++i) {
+        inputs[b].emplace_back(distribution(random), distribution(random));
+        data[i * batch + b] = complex<TypeParam>(inputs[b].back());
+      }
+    }
+
+    MixedRadixFft<TypeParam> fft;
+    ASSERT_TRUE(fft.Initialize(size));
+    std::vector<complex<TypeParam>> work(size * batch);
+    fft.Forward(data.data(), work.data(), batch);
+
+    for (int b = 0; b < batch; ++b) {
+      const std::vector<complex<double>> expected = NaiveDft(inputs[b]);
+      for (int k = 0; k < size; ++k) {
+        const complex<TypeParam>& actual = data[k * batch + b];
+        EXPECT_NEAR(actual.real(), expected[k].real(),
+                    Tolerance<TypeParam>(size))
+            << "size " << size << " index " << k;
+        EXPECT_NEAR(actual.imag(), expected[k].imag(),
+                    Tolerance<TypeParam>(size))
+            << "size " << size << " index " << k;
+      }
+    }
+  }
+}
+
+TYPED_TEST(MixedRadixFftTest, RealFftMatchesDft) {
+  std::mt19937 random(4321);
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+  for (int size : kSizes) {
+    // Shorter inputs are zero-padded, longer ones cropped.
+    for (int input_size : {size / 2, size, size + 3}) {
+      std::vector<TypeParam> input(input_size);
+      std::vector<complex<double>> padded(size);
+      for (int i = 0; i < input_size; ++i) {
+        input[i] = distribution(random);
+        if (i < size) padded[i] = input[i];
+      }
+
+      RealFft<TypeParam> fft;
+      ASSERT_TRUE(fft.Initialize(size));
+      ASSERT_EQ(fft.output_size(), size / 2 + 1);
+      std::vector<complex<TypeParam>> output(fft.output_size());
+      std::vector<complex<TypeParam>> work(fft.work_size());
+      fft.Forward(input.data(), input_size, output.data(), work.data());
+
+      const std::vector<complex<double>> expected = NaiveDft(padded);
+      for (int k = 0; k < fft.output_size(); ++k) {
+        EXPECT_NEAR(output[k].real(), expected[k].real(),
+                    Tolerance<TypeParam>(size))
+            << "size " << size << " index " << k;
+        EXPECT_NEAR(output[k].imag(), expected[k].imag(),
+                    Tolerance<TypeParam>(size))
+            << "size " << size << " index " << k;
+      }
+    }
+  }
+}
+
+TEST(MixedRadixFftPlanTest, RejectsEmptySizes) {
+  MixedRadixFft<float> fft;
+  EXPECT_FALSE(fft.Initialize(0));
+  RealFft<float> real_fft;
+  EXPECT_FALSE(real_fft.Initialize(-4));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace tflite
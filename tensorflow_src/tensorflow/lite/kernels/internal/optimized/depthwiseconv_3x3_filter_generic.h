@@ -0,0 +1,323 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_DEPTHWISECONV_3X3_FILTER_GENERIC_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_DEPTHWISECONV_3X3_FILTER_GENERIC_H_
+
+#include <algorithm>
+#include <type_traits>
+
+#include "ruy/profiler/instrumentation.h"  // from @ruy
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+// The ARMv6 SIMD32 extension (UXTAB16/SXTAB16, SMLAxy) is available in ARM
+// state on ARMv6 and later, and in Thumb state only with Thumb-2.
+#if defined(__arm__) && defined(__ARM_ARCH) && __ARM_ARCH >= 6 && \
+    (!defined(__thumb__) || defined(__thumb2__))
+#define TFLITE_DEPTHWISECONV_USE_ARM_SIMD32
+#endif
+
+namespace tflite {
+namespace optimized_ops {
+namespace depthwise_conv {
+
+// NEON-free 3x3 depthwise convolution for 8-bit inputs.
+//
+// Four channels are processed at a time using 16-bit SWAR lanes: one 32-bit
+// load fetches four input bytes, which are split into two registers holding
+// the even (0, 2) and odd (1, 3) channels as offset-corrected 16-bit lanes.
+// Filter values are pre-packed per channel block in the same lane order, with
+// the weights offset already applied, so every tap costs two extend-adds and
+// four 16x16->32 multiply-accumulates. On ARMv6 these map one-to-one onto
+// UXTAB16/SXTAB16 and SMLABB/SMLATT; elsewhere the portable versions below
+// are used.
+//
+// Channels are walked in blocks so that the packed filter and the three input
+// rows touched by an output row stay in L1 while consecutive output rows are
+// produced (they share two of their three input rows at stride 1).
+
+// Number of channels whose packed filter is kept on the stack at once.
+constexpr int kGeneric3x3ChannelBlock = 32;
+
+namespace swar {
+
+inline uint32 Pack16x2(int32 lo, int32 hi) {
+  return (static_cast<uint32>(hi) << 16) | (static_cast<uint32>(lo) & 0xffff);
+}
+
+inline int32 Lane16Lo(uint32 x) { return static_cast<int16>(x & 0xffff); }
+inline int32 Lane16Hi(uint32 x) { return static_cast<int16>(x >> 16); }
+
+// Loads 4 consecutive bytes, byte 0 in the least significant position.
+inline uint32 Load8x4(const void* src) {
+  const uint8* p = static_cast<const uint8*>(src);
+  return static_cast<uint32>(p[0]) | (static_cast<uint32>(p[1]) << 8) |
+         (static_cast<uint32>(p[2]) << 16) | (static_cast<uint32>(p[3]) << 24);
+}
+
+// Returns 16-bit lanes {lanes.lo + ext(x.byte0), lanes.hi + ext(x.byte2)},
+// where ext is zero-extension for uint8 and sign-extension for int8.
+template <typename T>
+inline uint32 ExtendAddEven(uint32 lanes, uint32 x);
+// As ExtendAddEven, for bytes 1 and 3.
+template <typename T>
+inline uint32 ExtendAddOdd(uint32 lanes, uint32 x);
+
+// Returns acc + lo(a) * lo(b).
+inline int32 MulAccLo(uint32 a, uint32 b, int32 acc);
+// Returns acc + hi(a) * hi(b).
+inline int32 MulAccHi(uint32 a, uint32 b, int32 acc);
+
+#ifdef TFLITE_DEPTHWISECONV_USE_ARM_SIMD32
+
+template <>
+inline uint32 ExtendAddEven<uint8>(uint32 lanes, uint32 x) {
+  uint32 r;
+  asm("uxtab16 %0, %1, %2" : "=r"(r) : "r"(lanes), "r"(x));
+  return r;
+}
+template <>
+inline uint32 ExtendAddOdd<uint8>(uint32 lanes, uint32 x) {
+  uint32 r;
+  asm("uxtab16 %0, %1, %2, ror #8" : "=r"(r) : "r"(lanes), "r"(x));
+  return r;
+}
+template <>
+inline uint32 ExtendAddEven<int8>(uint32 lanes, uint32 x) {
+  uint32 r;
+  asm("sxtab16 %0, %1, %2" : "=r"(r) : "r"(lanes), "r"(x));
+  return r;
+}
+template <>
+inline uint32 ExtendAddOdd<int8>(uint32 lanes, uint32 x) {
+  uint32 r;
+  asm("sxtab16 %0, %1, %2, ror #8" : "=r"(r) : "r"(lanes), "r"(x));
+  return r;
+}
+inline int32 MulAccLo(uint32 a, uint32 b, int32 acc) {
+  int32 r;
+  asm("smlabb %0, %1, %2, %3" : "=r"(r) : "r"(a), "r"(b), "r"(acc));
+  return r;
+}
+inline int32 MulAccHi(uint32 a, uint32 b, int32 acc) {
+  int32 r;
+  asm("smlatt %0, %1, %2, %3" : "=r"(r) : "r"(a), "r"(b), "r"(acc));
+  return r;
+}
+
+#else  // TFLITE_DEPTHWISECONV_USE_ARM_SIMD32
+
+template <>
+inline uint32 ExtendAddEven<uint8>(uint32 lanes, uint32 x) {
+  return Pack16x2(Lane16Lo(lanes) + static_cast<uint8>(x),
+                  Lane16Hi(lanes) + static_cast<uint8>(x >> 16));
+}
+template <>
+inline uint32 ExtendAddOdd<uint8>(uint32 lanes, uint32 x) {
+  return ExtendAddEven<uint8>(lanes, x >> 8);
+}
+template <>
+inline uint32 ExtendAddEven<int8>(uint32 lanes, uint32 x) {
+  return Pack16x2(Lane16Lo(lanes) + static_cast<int8>(x),
+                  Lane16Hi(lanes) + static_cast<int8>(x >> 16));
+}
+template <>
+inline uint32 ExtendAddOdd<int8>(uint32 lanes, uint32 x) {
+  return ExtendAddEven<int8>(lanes, x >> 8);
+}
+inline int32 MulAccLo(uint32 a, uint32 b, int32 acc) {
+  return acc + Lane16Lo(a) * Lane16Lo(b);
+}
+inline int32 MulAccHi(uint32 a, uint32 b, int32 acc) {
+  return acc + Lane16Hi(a) * Lane16Hi(b);
+}
+
+#endif  // TFLITE_DEPTHWISECONV_USE_ARM_SIMD32
+
+}  // namespace swar
+
+inline bool Generic3x3FilterKernelSupported(
+    const RuntimeShape& input_shape, const RuntimeShape& filter_shape,
+    int32 stride_width, int32 stride_height, int32 dilation_width_factor,
+    int32 dilation_height_factor, int32 depth_multiplier,
+    const RuntimeShape& output_shape) {
+  const int32 input_depth = input_shape.Dims(3);
+  const int32 filter_height = filter_shape.Dims(1);
+  const int32 filter_width = filter_shape.Dims(2);
+  return filter_width == 3 && filter_height == 3 && depth_multiplier == 1 &&
+         (stride_width == 1 || stride_width == 2) &&
+         stride_width == stride_height && dilation_width_factor == 1 &&
+         dilation_height_factor == 1 && input_depth >= 4 &&
+         output_shape.Dims(3) == input_depth;
+}
+
+// Computes a 3x3, depth-multiplier-1 depthwise convolution. T is uint8 (with
+// an optional filter offset and a single output multiplier) or int8 (with
+// per-channel output multipliers). When kPerChannel is false only
+// output_multiplier[0] and output_shift[0] are read. Threading follows
+// DepthwiseConvGeneral: thread_dim 0 splits batches, 1 splits output rows.
+template <typename T, bool kPerChannel>
+inline void DepthwiseConv3x3FilterGeneric(
+    const DepthwiseParams& params, const int32* output_multiplier,
+    const int32* output_shift, const RuntimeShape& input_shape,
+    const T* input_data, const RuntimeShape& filter_shape, const T* filter_data,
+    const RuntimeShape& bias_shape, const int32* bias_data,
+    const RuntimeShape& output_shape, T* output_data, int thread_start,
+    int thread_end, int thread_dim) {
+  static_assert(std::is_same<T, uint8>::value || std::is_same<T, int8>::value,
+                "Only 8-bit types are supported.");
+  ruy::profiler::ScopeLabel label("DepthwiseConv/8bit/3x3Generic");
+  const int stride = params.stride_width;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+  const int32 input_offset = params.input_offset;
+  const int32 filter_offset = params.weights_offset;
+  const int32 output_offset = params.output_offset;
+  const int32 output_activation_min = params.quantized_activation_min;
+  const int32 output_activation_max = params.quantized_activation_max;
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int depth = MatchingDim(input_shape, 3, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  TFLITE_DCHECK_EQ(filter_shape.Dims(3), depth);
+  TFLITE_DCHECK(bias_data == nullptr || bias_shape.FlatSize() == depth);
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+  TFLITE_DCHECK(thread_dim == 0 || thread_dim == 1);
+
+  int batch_start = 0;
+  int batch_end = batches;
+  int row_start = 0;
+  int row_end = output_height;
+  if (thread_dim == 0) {
+    TFLITE_DCHECK_GE(thread_start, 0);
+    TFLITE_DCHECK_LE(thread_end, batches);
+    batch_start = thread_start;
+    batch_end = thread_end;
+  } else {
+    TFLITE_DCHECK_GE(thread_start, 0);
+    TFLITE_DCHECK_LE(thread_end, output_height);
+    row_start = thread_start;
+    row_end = thread_end;
+  }
+
+  // Input offset replicated into both 16-bit lanes; (x + input_offset) fits in
+  // int16 for any valid 8-bit zero point.
+  const uint32 input_offset_lanes = swar::Pack16x2(input_offset, input_offset);
+  const int input_row_stride = input_width * depth;
+
+  // Packed filter for one channel block: for each tap and each group of four
+  // channels, {c0, c2} followed by {c1, c3}.
+  constexpr int kGroupsPerBlock = kGeneric3x3ChannelBlock / 4;
+  uint32 packed_filter[9][kGroupsPerBlock][2];
+
+  for (int c_block = 0; c_block < depth; c_block += kGeneric3x3ChannelBlock) {
+    const int block_depth = std::min(kGeneric3x3ChannelBlock, depth - c_block);
+    const int num_groups = block_depth / 4;
+    for (int tap = 0; tap < 9; ++tap) {
+      const T* f = filter_data + tap * depth + c_block;
+      for (int g = 0; g < num_groups; ++g, f += 4) {
+        packed_filter[tap][g][0] =
+            swar::Pack16x2(f[0] + filter_offset, f[2] + filter_offset);
+        packed_filter[tap][g][1] =
+            swar::Pack16x2(f[1] + filter_offset, f[3] + filter_offset);
+      }
+    }
+
+    for (int b = batch_start; b < batch_end; ++b) {
+      const T* input_batch =
+          input_data + b * input_height * input_row_stride + c_block;
+      for (int out_y = row_start; out_y < row_end; ++out_y) {
+        const int in_y_origin = out_y * stride - pad_height;
+        const int filter_y_start = std::max(0, -in_y_origin);
+        const int filter_y_end = std::min(3, input_height - in_y_origin);
+        T* output_row =
+            output_data + ((b * output_height + out_y) * output_width) * depth;
+        for (int out_x = 0; out_x < output_width; ++out_x) {
+          const int in_x_origin = out_x * stride - pad_width;
+          const int filter_x_start = std::max(0, -in_x_origin);
+          const int filter_x_end = std::min(3, input_width - in_x_origin);
+          const T* input_origin = input_batch + in_y_origin * input_row_stride +
+                                  in_x_origin * depth;
+          T* output_ptr = output_row + out_x * depth + c_block;
+
+          int c = c_block;
+          for (int g = 0; g < num_groups; ++g, c += 4) {
+            int32 acc[4] = {0, 0, 0, 0};
+            if (bias_data) {
+              acc[0] = bias_data[c + 0];
+              acc[1] = bias_data[c + 1];
+              acc[2] = bias_data[c + 2];
+              acc[3] = bias_data[c + 3];
+            }
+            for (int fy = filter_y_start; fy < filter_y_end; ++fy) {
+              const T* input_ptr =
+                  input_origin + fy * input_row_stride + g * 4;
+              for (int fx = filter_x_start; fx < filter_x_end; ++fx) {
+                const uint32 x = swar::Load8x4(input_ptr + fx * depth);
+                const uint32 even =
+                    swar::ExtendAddEven<T>(input_offset_lanes, x);
+                const uint32 odd = swar::ExtendAddOdd<T>(input_offset_lanes, x);
+                const uint32* f = packed_filter[fy * 3 + fx][g];
+                acc[0] = swar::MulAccLo(even, f[0], acc[0]);
+                acc[2] = swar::MulAccHi(even, f[0], acc[2]);
+                acc[1] = swar::MulAccLo(odd, f[1], acc[1]);
+                acc[3] = swar::MulAccHi(odd, f[1], acc[3]);
+              }
+            }
+            for (int i = 0; i < 4; ++i) {
+              const int ch = kPerChannel ? c + i : 0;
+              int32 out = MultiplyByQuantizedMultiplier(
+                  acc[i], output_multiplier[ch], output_shift[ch]);
+              out += output_offset;
+              out = std::max(out, output_activation_min);
+              out = std::min(out, output_activation_max);
+              *output_ptr++ = static_cast<T>(out);
+            }
+          }
+
+          // Leftover channels of the last block.
+          for (; c < c_block + block_depth; ++c) {
+            int32 acc = bias_data ? bias_data[c] : 0;
+            for (int fy = filter_y_start; fy < filter_y_end; ++fy) {
+              for (int fx = filter_x_start; fx < filter_x_end; ++fx) {
+                const int32 input_val =
+                    input_origin[fy * input_row_stride + fx * depth +
+                                 (c - c_block)];
+                const int32 filter_val = filter_data[(fy * 3 + fx) * depth + c];
+                acc += (filter_val + filter_offset) * (input_val + input_offset);
+              }
+            }
+            const int ch = kPerChannel ? c : 0;
+            acc = MultiplyByQuantizedMultiplier(acc, output_multiplier[ch],
+                                                output_shift[ch]);
+            acc += output_offset;
+            acc = std::max(acc, output_activation_min);
+            acc = std::min(acc, output_activation_max);
+            *output_ptr++ = static_cast<T>(acc);
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace depthwise_conv
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_DEPTHWISECONV_3X3_FILTER_GENERIC_H_
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "ruy/profiler/instrumentation.h"  // from @ruy
 #include "tensorflow/lite/kernels/internal/optimized/cpu_check.h"
+#include "tensorflow/lite/kernels/internal/optimized/depthwiseconv_3x3_filter_generic.h"
 #include "tensorflow/lite/kernels/internal/optimized/depthwiseconv_uint8_3x3_filter.h"
 #include "tensorflow/lite/kernels/internal/reference/depthwiseconv_uint8.h"
 #include "tensorflow/lite/kernels/internal/types.h"
@@ -2060,6 +2061,20 @@ inline void DepthwiseConvWithRounding(
   }
 #endif
 
+#ifndef USE_NEON
+  // Without NEON, prefer the SWAR 3x3 kernel over the general row kernels.
+  if (depthwise_conv::Generic3x3FilterKernelSupported(
+          input_shape, filter_shape, params.stride_width, params.stride_height,
+          dilation_width_factor, dilation_height_factor, depth_multiplier,
+          output_shape)) {
+    depthwise_conv::DepthwiseConv3x3FilterGeneric<uint8, false>(
+        params, &params.output_multiplier, &params.output_shift, input_shape,
+        input_data, filter_shape, filter_data, bias_shape, bias_data,
+        output_shape, output_data, thread_start, thread_end, thread_dim);
+    return;
+  }
+#endif
+
   ruy::profiler::ScopeLabel specialized_label("DepthwiseConv/8bit/General");
   depthwise_conv::DepthwiseConvGeneral(params, input_shape, input_data,
                                        filter_shape, filter_data, bias_shape,
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/optimized/cpu_check.h"
 #include "tensorflow/lite/kernels/internal/optimized/depthwiseconv_3x3_filter_common.h"
+#include "tensorflow/lite/kernels/internal/optimized/depthwiseconv_3x3_filter_generic.h"
 #include "tensorflow/lite/kernels/internal/optimized/depthwiseconv_uint8_3x3_filter.h"
 #include "tensorflow/lite/kernels/internal/optimized/integer_ops/depthwise_conv_3x3_filter.h"
 #include "tensorflow/lite/kernels/internal/optimized/neon_check.h"
@@ -1868,6 +1869,20 @@ inline void DepthwiseConvWithRounding(
   }
 #endif
 
+#ifndef USE_NEON
+  // Without NEON, prefer the SWAR 3x3 kernel over the general row kernels.
+  if (optimized_ops::depthwise_conv::Generic3x3FilterKernelSupported(
+          input_shape, filter_shape, params.stride_width, params.stride_height,
+          dilation_width_factor, dilation_height_factor, depth_multiplier,
+          output_shape)) {
+    optimized_ops::depthwise_conv::DepthwiseConv3x3FilterGeneric<int8, true>(
+        params, output_multiplier, output_shift, input_shape, input_data,
+        filter_shape, filter_data, bias_shape, bias_data, output_shape,
+        output_data, thread_start, thread_end, thread_dim);
+    return;
+  }
+#endif
+
   ruy::profiler::ScopeLabel specialized_label("DepthwiseConvInt8/8bit/General");
   depthwise_conv::DepthwiseConvGeneral(
       params, output_multiplier, output_shift, input_shape, input_data,
@@ -4166,6 +4166,239 @@ inline void LogSoftmax(const SoftmaxParams& params, float input_scale,
   }
 }
 
+// Softmax engine of the kFixedPointOptimized softmax and log-softmax kernels.
+//
+// For 8-bit inputs, exp(scale * (x - x_max)) is read from a 256-entry Q0.15
+// table indexed by x_max - x, the row sum is accumulated in int32 and the
+// normalization uses the same 1 / (1 + x) int16 LUT as
+// reference_ops::SoftmaxInt16. This keeps the per-element work integer only,
+// which matters on cores without a fast FPU (armv6, Cortex-M class).
+//
+// The int32 accumulator holds up to 65538 entries of 32767, rows deeper than
+// kSoftmaxInt16LUTMaxDepth have to use another engine.
+constexpr int kSoftmaxInt16LUTMaxDepth =
+    std::numeric_limits<int32_t>::max() / std::numeric_limits<int16_t>::max();
+
+inline void PopulateSoftmaxInt16ExpLookupTable(int16_t* table,
+                                               float input_scale, float beta) {
+  const double scale = -static_cast<double>(input_scale) * beta;
+  for (int d = 0; d < 256; ++d) {
+    table[d] = static_cast<int16_t>(
+        std::min(TfLiteRound(std::exp(scale * d) * 32768.0), 32767.0));
+  }
+}
+
+template <typename In, typename Out>
+inline void SoftmaxInt16LUT(const SoftmaxParams& params,
+                            const RuntimeShape& input_shape,
+                            const In* input_data,
+                            const RuntimeShape& output_shape,
+                            Out* output_data) {
+  ruy::profiler::ScopeLabel label("SoftmaxInt16LUT");
+  static_assert(sizeof(In) == 1, "Lookup table valid only for 8bit inputs");
+  const int trailing_dim = input_shape.DimensionsCount() - 1;
+  const int excluding_last_dim =
+      MatchingFlatSizeSkipDim(input_shape, trailing_dim, output_shape);
+  const int last_dim =
+      MatchingDim(input_shape, trailing_dim, output_shape, trailing_dim);
+  TFLITE_DCHECK_LE(last_dim, kSoftmaxInt16LUTMaxDepth);
+
+  const int32_t clamp_max = std::numeric_limits<Out>::max();
+  const int32_t clamp_min = std::numeric_limits<Out>::min();
+  const int16_t* exp_table = params.exp_q15_table;
+  for (int i = 0; i < excluding_last_dim; ++i) {
+    int32_t max_val = std::numeric_limits<In>::min();
+    for (int j = 0; j < last_dim; ++j) {
+      max_val = std::max(max_val, static_cast<int32_t>(input_data[j]));
+    }
+
+    int32_t sum_of_exps = 0;  // Q16.15 fixed point format.
+    for (int j = 0; j < last_dim; ++j) {
+      sum_of_exps += exp_table[max_val - input_data[j]];
+    }
+
+    // 1 / sum_of_exps, see reference_ops::SoftmaxInt16. The table entry of the
+    // maximum is 32767, so the sum is never zero.
+    const int headroom_plus_one =
+        CountLeadingZeros(static_cast<uint32_t>(sum_of_exps));
+    const int32_t shifted_sum =
+        ((static_cast<int64_t>(sum_of_exps) << (headroom_plus_one - 1)) +
+         (1 << 13)) >>
+        14;
+    const int32_t sym_shifted_sum = std::min(
+        std::max(shifted_sum - ((1 << 15) + (1 << 16)), int32_t{-32768}),
+        int32_t{32767});
+    const int16_t reciprocal_scale_Q015 = generic_int16_table_lookup(
+        static_cast<int16_t>(sym_shifted_sum), params.one_over_one_plus_x_lut);
+
+    const int right_shift = 31 - headroom_plus_one;
+    const int64_t round = int64_t{1} << (right_shift - 1);
+    for (int j = 0; j < last_dim; ++j) {
+      const int32_t prob_Q015 = std::min(
+          static_cast<int32_t>((static_cast<int64_t>(
+                                    exp_table[max_val - input_data[j]]) *
+                                    reciprocal_scale_Q015 +
+                                round) >>
+                               right_shift),
+          int32_t{32767});
+      const int32_t prob_quantized =
+          params.zero_point +
+          MultiplyByQuantizedMultiplier(prob_Q015, params.output_multiplier,
+                                        params.output_shift);
+      output_data[j] = static_cast<Out>(
+          std::max(std::min(clamp_max, prob_quantized), clamp_min));
+    }
+    input_data += last_dim;
+    output_data += last_dim;
+  }
+}
+
+// Same table as SoftmaxInt16LUT (populated with beta = 1). Only the log of the
+// row sum is computed in float; every element is then rescaled with a Q16
+// multiplier.
+template <typename T>
+inline void LogSoftmaxInt16LUT(const SoftmaxParams& params, float input_scale,
+                               const RuntimeShape& input_shape,
+                               const T* input_data,
+                               const RuntimeShape& output_shape,
+                               T* output_data) {
+  ruy::profiler::ScopeLabel label("LogSoftmaxInt16LUT");
+  static_assert(sizeof(T) == 1, "Lookup table valid only for 8bit");
+  const int trailing_dim = input_shape.DimensionsCount() - 1;
+  const int excluding_last_dim =
+      MatchingFlatSizeSkipDim(input_shape, trailing_dim, output_shape);
+  const int last_dim =
+      MatchingDim(input_shape, trailing_dim, output_shape, trailing_dim);
+  TFLITE_DCHECK_LE(last_dim, kSoftmaxInt16LUTMaxDepth);
+
+  const int32_t clamp_max = std::numeric_limits<T>::max();
+  const int32_t clamp_min = std::numeric_limits<T>::min();
+  const int16_t* exp_table = params.exp_q15_table;
+  // params.scale is the output scale.
+  const int64_t multiplier_Q16 =
+      static_cast<int64_t>(TfLiteRound(input_scale / params.scale * 65536.0f));
+  for (int i = 0; i < excluding_last_dim; ++i) {
+    int32_t max_val = std::numeric_limits<T>::min();
+    for (int j = 0; j < last_dim; ++j) {
+      max_val = std::max(max_val, static_cast<int32_t>(input_data[j]));
+    }
+
+    int32_t sum_of_exps = 0;  // Q16.15 fixed point format.
+    for (int j = 0; j < last_dim; ++j) {
+      sum_of_exps += exp_table[max_val - input_data[j]];
+    }
+    const float log_sum_exp = std::log(sum_of_exps / 32768.0f);
+
+    // log_prob / output_scale + zero_point, plus one half for rounding, all
+    // in Q16.
+    const int64_t log_sum_exp_Q16 =
+        static_cast<int64_t>(TfLiteRound(log_sum_exp / params.scale * 65536));
+    const int64_t offset_Q16 =
+        (static_cast<int64_t>(params.zero_point) << 16) + (1 << 15) -
+        log_sum_exp_Q16;
+    for (int j = 0; j < last_dim; ++j) {
+      const int64_t log_prob_Q16 =
+          offset_Q16 - (max_val - input_data[j]) * multiplier_Q16;
+      const int32_t prob_quantized = static_cast<int32_t>(std::max<int64_t>(
+          log_prob_Q16 >> 16, std::numeric_limits<int32_t>::min()));
+      output_data[j] = static_cast<T>(
+          std::max(std::min(clamp_max, prob_quantized), clamp_min));
+    }
+    input_data += last_dim;
+    output_data += last_dim;
+  }
+}
+
+// exp(x) for x <= 0, with the Cephes expf polynomial: x = n * ln(2) + r with
+// |r| <= ln(2) / 2, exp(r) from a degree 7 polynomial and 2^n written into the
+// exponent bits. The relative error is a few ulp, and it is several times
+// cheaper than std::exp on cores without a vector exp. Inputs below
+// ln(FLT_MIN) are flushed to exp(-87.3); NaN is propagated.
+inline float ExpPolynomialNonPositive(float x) {
+  if (x < -87.3f) x = -87.3f;
+  const float n = std::floor(x * 1.44269504088896341f + 0.5f);
+  // Cody-Waite split of ln(2), so that r is exact.
+  float r = x - n * 0.693359375f;
+  r = r + n * 2.12194440e-4f;
+  float p = 1.9875691500E-4f;
+  p = p * r + 1.3981999507E-3f;
+  p = p * r + 8.3334519073E-3f;
+  p = p * r + 4.1665795894E-2f;
+  p = p * r + 1.6666665459E-1f;
+  p = p * r + 5.0000001201E-1f;
+  const float exp_r = p * r * r + r + 1.0f;
+  const int32_t exponent = n == n ? static_cast<int32_t>(n) : 0;
+  const int32_t bits = (exponent + 127) << 23;
+  float two_n;
+  std::memcpy(&two_n, &bits, sizeof(two_n));
+  return exp_r * two_n;
+}
+
+inline void SoftmaxFastExp(const SoftmaxParams& params,
+                           const RuntimeShape& input_shape,
+                           const float* input_data,
+                           const RuntimeShape& output_shape,
+                           float* output_data) {
+  ruy::profiler::ScopeLabel label("SoftmaxFastExp");
+  // (input - max) * beta must stay non-positive.
+  TFLITE_DCHECK_GT(params.beta, 0);
+  const int trailing_dim = input_shape.DimensionsCount() - 1;
+  const int outer_size =
+      MatchingFlatSizeSkipDim(input_shape, trailing_dim, output_shape);
+  const int depth =
+      MatchingDim(input_shape, trailing_dim, output_shape, trailing_dim);
+  const float beta = static_cast<float>(params.beta);
+
+  for (int i = 0; i < outer_size; ++i) {
+    float max = std::numeric_limits<float>::lowest();
+    for (int c = 0; c < depth; ++c) {
+      max = std::max(max, input_data[c]);
+    }
+    // The exp values are cached in the output buffer.
+    float sum = 0.f;
+    for (int c = 0; c < depth; ++c) {
+      output_data[c] = ExpPolynomialNonPositive((input_data[c] - max) * beta);
+      sum += output_data[c];
+    }
+    const float inv_sum = 1.f / sum;
+    for (int c = 0; c < depth; ++c) {
+      output_data[c] *= inv_sum;
+    }
+    input_data += depth;
+    output_data += depth;
+  }
+}
+
+inline void LogSoftmaxFastExp(const SoftmaxParams& params,
+                              const RuntimeShape& input_shape,
+                              const float* input_data,
+                              const RuntimeShape& output_shape,
+                              float* output_data) {
+  ruy::profiler::ScopeLabel label("LogSoftmaxFastExp");
+  const int trailing_dim = input_shape.DimensionsCount() - 1;
+  const int outer_size =
+      MatchingFlatSizeSkipDim(input_shape, trailing_dim, output_shape);
+  const int depth =
+      MatchingDim(input_shape, trailing_dim, output_shape, trailing_dim);
+
+  for (int i = 0; i < outer_size; ++i) {
+    float max = std::numeric_limits<float>::lowest();
+    for (int c = 0; c < depth; ++c) {
+      max = std::max(max, input_data[c]);
+    }
+    float sum = 0.f;
+    for (int c = 0; c < depth; ++c) {
+      sum += ExpPolynomialNonPositive(input_data[c] - max);
+    }
+    const float offset = max + std::log(sum);
+    for (int c = 0; c < depth; ++c) {
+      output_data[c] = input_data[c] - offset;
+    }
+    input_data += depth;
+    output_data += depth;
+  }
+}
+
 inline void Logistic(const RuntimeShape& input_shape, const float* input_data,
                      const RuntimeShape& output_shape, float* output_data) {
   ruy::profiler::ScopeLabel label("Logistic");
@@ -0,0 +1,345 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_POOLING_TILED_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_POOLING_TILED_H_
+
+#include <algorithm>
+#include <limits>
+#include <cstddef>
+#include <type_traits>
+
+#include "ruy/profiler/instrumentation.h"  // from @ruy
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace optimized_ops {
+namespace tiled_pooling {
+
+// Tiled MAX_POOL_2D and AVERAGE_POOL_2D for float, uint8 and int8.
+//
+// Both reductions are separable, so each input row is first reduced
+// horizontally, once per output column, into a row buffer. An output row then
+// only combines the filter_height buffered rows covering its window. Buffered
+// rows live in a ring indexed by input row, so when windows overlap
+// vertically (stride_height < filter_height) a row reduced for one output row
+// is reused by the next ones instead of being read from the input again. The
+// per-output cost drops from filter_width * filter_height to
+// filter_width + filter_height.
+//
+// Channels are walked in tranches sized so that the ring stays in L1. The
+// final division, optional requantization and activation clamp are applied in
+// the same pass that writes the output.
+//
+// Pools whose single window covers the whole input (global pooling, as in
+// MobileNet heads) skip the row buffers and reduce the input in one
+// contiguous pass.
+//
+// The kernels do not allocate: the ring and the other per-call buffers live in
+// a scratch buffer of TiledPoolScratchBytes() bytes supplied by the caller.
+
+// Budget for the ring of horizontally reduced rows.
+constexpr int kTiledPoolingRowCacheBytes = 32 * 1024;
+
+// Rescales 8-bit outputs whose scale or zero point differ from the input's.
+// The multiplier and shift encode input_scale / output_scale.
+struct PoolRequantizeParams {
+  int32 input_zero_point;
+  int32 output_zero_point;
+  int32 output_multiplier;
+  int output_shift;
+};
+
+template <typename T>
+struct PoolAccumulator {
+  using type = int32;
+};
+
+template <>
+struct PoolAccumulator<float> {
+  using type = float;
+};
+
+// Returns whether the only output pixel of the pool sees the whole input.
+inline bool IsGlobalPool(const PoolParams& params,
+                         const RuntimeShape& input_shape,
+                         const RuntimeShape& output_shape) {
+  if (output_shape.Dims(1) != 1 || output_shape.Dims(2) != 1) {
+    return false;
+  }
+  const int in_x_origin = -params.padding_values.width;
+  const int in_y_origin = -params.padding_values.height;
+  return in_x_origin <= 0 && in_y_origin <= 0 &&
+         in_x_origin + params.filter_width >= input_shape.Dims(2) &&
+         in_y_origin + params.filter_height >= input_shape.Dims(1);
+}
+
+namespace detail {
+
+// Channels reduced per pass, so that the ring of filter_height rows of
+// output_width accumulators stays within kTiledPoolingRowCacheBytes.
+template <typename Acc>
+inline int TrancheSize(const PoolParams& params, int output_width,
+                       int depth) {
+  const int row_elements = params.filter_height * output_width;
+  return std::min(
+      depth, std::max(4, kTiledPoolingRowCacheBytes /
+                             static_cast<int>(row_elements * sizeof(Acc))));
+}
+
+}  // namespace detail
+
+// Returns the size of the scratch buffer AveragePool() and MaxPool() need for
+// these shapes.
+template <typename T>
+inline size_t TiledPoolScratchBytes(const PoolParams& params,
+                                    const RuntimeShape& input_shape,
+                                    const RuntimeShape& output_shape) {
+  using Acc = typename PoolAccumulator<T>::type;
+  const int depth = MatchingDim(input_shape, 3, output_shape, 3);
+  if (IsGlobalPool(params, input_shape, output_shape)) {
+    return depth * sizeof(Acc);
+  }
+  const int output_width = output_shape.Dims(2);
+  const int tranche_size =
+      detail::TrancheSize<Acc>(params, output_width, depth);
+  // The ring and the accumulators of an output pixel, then the horizontal
+  // window of every output column and the input row held by every ring slot.
+  return (params.filter_height * output_width + 1) * tranche_size *
+             sizeof(Acc) +
+         (2 * output_width + params.filter_height) * sizeof(int);
+}
+
+namespace detail {
+
+template <bool kMax, typename Acc>
+inline Acc Combine(Acc a, Acc b) {
+  return kMax ? std::max(a, b) : a + b;
+}
+
+// Divides with rounding half away from zero, as the integer reference
+// kernels do.
+inline int32 RoundedDivide(int32 acc, int32 count) {
+  return acc > 0 ? (acc + count / 2) / count : (acc - count / 2) / count;
+}
+
+template <bool kMax>
+inline void WriteOutput(const PoolParams& params,
+                        const PoolRequantizeParams* requantize,
+                        const float* acc, int count, int depth,
+                        float* output) {
+  for (int c = 0; c < depth; ++c) {
+    const float value = kMax ? acc[c] : acc[c] / count;
+    output[c] = ActivationFunctionWithMinMax(
+        value, params.float_activation_min, params.float_activation_max);
+  }
+}
+
+template <bool kMax, typename T>
+inline void WriteOutput(const PoolParams& params,
+                        const PoolRequantizeParams* requantize,
+                        const int32* acc, int count, int depth, T* output) {
+  for (int c = 0; c < depth; ++c) {
+    int32 value;
+    if (requantize == nullptr) {
+      value = kMax ? acc[c] : RoundedDivide(acc[c], count);
+    } else {
+      const int32 centered =
+          kMax ? acc[c] - requantize->input_zero_point
+               : RoundedDivide(acc[c] - count * requantize->input_zero_point,
+                               count);
+      value = requantize->output_zero_point +
+              MultiplyByQuantizedMultiplier(centered,
+                                            requantize->output_multiplier,
+                                            requantize->output_shift);
+    }
+    value = std::max(value, params.quantized_activation_min);
+    value = std::min(value, params.quantized_activation_max);
+    output[c] = static_cast<T>(value);
+  }
+}
+
+template <bool kMax, typename T>
+inline void GlobalPool(const PoolParams& params,
+                       const PoolRequantizeParams* requantize,
+                       const RuntimeShape& input_shape, const T* input_data,
+                       const RuntimeShape& output_shape, T* output_data,
+                       void* scratch_data) {
+  using Acc = typename PoolAccumulator<T>::type;
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int depth = MatchingDim(input_shape, 3, output_shape, 3);
+  const int pixels = input_shape.Dims(1) * input_shape.Dims(2);
+
+  Acc* acc = static_cast<Acc*>(scratch_data);
+  for (int batch = 0; batch < batches; ++batch) {
+    const T* input = input_data + batch * pixels * depth;
+    for (int c = 0; c < depth; ++c) {
+      acc[c] = static_cast<Acc>(input[c]);
+    }
+    for (int i = 1; i < pixels; ++i) {
+      const T* pixel = input + i * depth;
+      for (int c = 0; c < depth; ++c) {
+        acc[c] = Combine<kMax, Acc>(acc[c], static_cast<Acc>(pixel[c]));
+      }
+    }
+    WriteOutput<kMax>(params, requantize, acc, pixels, depth,
+                      output_data + Offset(output_shape, batch, 0, 0, 0));
+  }
+}
+
+template <bool kMax, typename T>
+inline void TiledPool(const PoolParams& params,
+                      const PoolRequantizeParams* requantize,
+                      const RuntimeShape& input_shape, const T* input_data,
+                      const RuntimeShape& output_shape, T* output_data,
+                      void* scratch_data) {
+  using Acc = typename PoolAccumulator<T>::type;
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  if (IsGlobalPool(params, input_shape, output_shape)) {
+    GlobalPool<kMax>(params, requantize, input_shape, input_data, output_shape,
+                     output_data, scratch_data);
+    return;
+  }
+
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int depth = MatchingDim(input_shape, 3, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int filter_height = params.filter_height;
+  const int filter_width = params.filter_width;
+  const int stride_height = params.stride_height;
+  const int stride_width = params.stride_width;
+
+  const int tranche_size = TrancheSize<Acc>(params, output_width, depth);
+
+  // Carves the scratch buffer as laid out by TiledPoolScratchBytes().
+  // ring[slot] holds input row ring_row[slot], reduced horizontally for every
+  // output column, tranche_size channels per column.
+  Acc* ring = static_cast<Acc*>(scratch_data);
+  Acc* acc = ring + filter_height * output_width * tranche_size;
+  // The horizontal window of every output column, clipped to the input.
+  int* x_start = reinterpret_cast<int*>(acc + tranche_size);
+  int* x_end = x_start + output_width;
+  int* ring_row = x_end + output_width;
+  for (int out_x = 0; out_x < output_width; ++out_x) {
+    const int in_x_origin = out_x * stride_width - params.padding_values.width;
+    x_start[out_x] = std::max(0, in_x_origin);
+    x_end[out_x] = std::min(input_width, in_x_origin + filter_width);
+  }
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int depth_base = 0; depth_base < depth; depth_base += tranche_size) {
+      const int tranche_depth = std::min(tranche_size, depth - depth_base);
+      std::fill(ring_row, ring_row + filter_height, -1);
+      for (int out_y = 0; out_y < output_height; ++out_y) {
+        const int in_y_origin =
+            out_y * stride_height - params.padding_values.height;
+        const int y_start = std::max(0, in_y_origin);
+        const int y_end = std::min(input_height, in_y_origin + filter_height);
+
+        // Reduce the rows this window needs that are not buffered yet.
+        for (int in_y = y_start; in_y < y_end; ++in_y) {
+          const int slot = in_y % filter_height;
+          if (ring_row[slot] == in_y) continue;
+          ring_row[slot] = in_y;
+          Acc* row = ring + slot * output_width * tranche_size;
+          for (int out_x = 0; out_x < output_width; ++out_x) {
+            Acc* dst = row + out_x * tranche_size;
+            const T* src = input_data +
+                           Offset(input_shape, batch, in_y, x_start[out_x],
+                                  depth_base);
+            for (int c = 0; c < tranche_depth; ++c) {
+              dst[c] = static_cast<Acc>(src[c]);
+            }
+            for (int in_x = x_start[out_x] + 1; in_x < x_end[out_x]; ++in_x) {
+              src += depth;
+              for (int c = 0; c < tranche_depth; ++c) {
+                dst[c] = Combine<kMax, Acc>(dst[c], static_cast<Acc>(src[c]));
+              }
+            }
+          }
+        }
+
+        // Combine the buffered rows and write the output row.
+        for (int out_x = 0; out_x < output_width; ++out_x) {
+          const Acc* src =
+              ring +
+              ((y_start % filter_height) * output_width + out_x) * tranche_size;
+          std::copy(src, src + tranche_depth, acc);
+          for (int in_y = y_start + 1; in_y < y_end; ++in_y) {
+            src = ring + ((in_y % filter_height) * output_width + out_x) *
+                             tranche_size;
+            for (int c = 0; c < tranche_depth; ++c) {
+              acc[c] = Combine<kMax, Acc>(acc[c], src[c]);
+            }
+          }
+          const int count =
+              (x_end[out_x] - x_start[out_x]) * (y_end - y_start);
+          WriteOutput<kMax>(
+              params, requantize, acc, count, tranche_depth,
+              output_data +
+                  Offset(output_shape, batch, out_y, out_x, depth_base));
+        }
+      }
+    }
+  }
+}
+
+}  // namespace detail
+
+// `requantize` must be null for float, and may be null for 8-bit types when
+// the input and output share their quantization parameters. `scratch_data`
+// must hold TiledPoolScratchBytes<T>() bytes, aligned for int32 and float.
+template <typename T>
+inline void AveragePool(const PoolParams& params,
+                        const PoolRequantizeParams* requantize,
+                        const RuntimeShape& input_shape, const T* input_data,
+                        const RuntimeShape& output_shape, T* output_data,
+                        void* scratch_data) {
+  ruy::profiler::ScopeLabel label("AveragePool/Tiled");
+  static_assert(std::is_same<T, float>::value ||
+                    std::is_same<T, uint8>::value ||
+                    std::is_same<T, int8>::value,
+                "Unsupported type");
+  detail::TiledPool</*kMax=*/false>(params, requantize, input_shape,
+                                    input_data, output_shape, output_data,
+                                    scratch_data);
+}
+
+template <typename T>
+inline void MaxPool(const PoolParams& params,
+                    const PoolRequantizeParams* requantize,
+                    const RuntimeShape& input_shape, const T* input_data,
+                    const RuntimeShape& output_shape, T* output_data,
+                    void* scratch_data) {
+  ruy::profiler::ScopeLabel label("MaxPool/Tiled");
+  static_assert(std::is_same<T, float>::value ||
+                    std::is_same<T, uint8>::value ||
+                    std::is_same<T, int8>::value,
+                "Unsupported type");
+  detail::TiledPool</*kMax=*/true>(params, requantize, input_shape,
+                                   input_data, output_shape, output_data,
+                                   scratch_data);
+}
+
+}  // namespace tiled_pooling
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_POOLING_TILED_H_
@@ -0,0 +1,79 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/internal/packed_int4.h"
+
+namespace tflite {
+namespace internal {
+
+void PackInt4(const int8_t* values, int size, uint8_t* packed) {
+  for (int i = 0; i + 1 < size; i += 2) {
+    packed[i >> 1] = (values[i] & 0x0F) | ((values[i + 1] & 0x0F) << 4);
+  }
+  if (size & 1) {
+    packed[size >> 1] = values[size - 1] & 0x0F;
+  }
+}
+
+float PackedInt4DotProduct(const uint8_t* packed, int start, int size,
+                           const float* vector) {
+  if (size <= 0) return 0.0f;
+  float result = 0.0f;
+  if (start & 1) {
+    result = UnpackHighInt4(packed[start >> 1]) * vector[0];
+    ++start;
+    ++vector;
+    --size;
+  }
+  const uint8_t* bytes = packed + (start >> 1);
+  const int num_pairs = size >> 1;
+  // Separate accumulators for the low and high nibbles keep the two
+  // multiply-adds of every byte independent.
+  float low_sum = 0.0f;
+  float high_sum = 0.0f;
+  for (int i = 0; i < num_pairs; ++i) {
+    const uint8_t byte = bytes[i];
+    low_sum += UnpackLowInt4(byte) * vector[2 * i];
+    high_sum += UnpackHighInt4(byte) * vector[2 * i + 1];
+  }
+  if (size & 1) {
+    low_sum += UnpackLowInt4(bytes[num_pairs]) * vector[size - 1];
+  }
+  return result + low_sum + high_sum;
+}
+
+void PackedInt4MatrixBatchVectorMultiplyAccumulate(
+    const uint8_t* matrix, int m_rows, int m_cols, const float* scales,
+    int num_scales, const float* vectors, int n_batch, float* result) {
+  for (int r = 0; r < m_rows; ++r) {
+    const int start = r * m_cols;
+    const float scale = scales[num_scales == 1 ? 0 : r];
+    // Each row is reused across the batch while it is still in cache.
+    for (int b = 0; b < n_batch; ++b) {
+      result[b * m_rows + r] +=
+          scale *
+          PackedInt4DotProduct(matrix, start, m_cols, vectors + b * m_cols);
+    }
+  }
+}
+
+void UnpackInt4ToFloat(const uint8_t* packed, int start, int size, float scale,
+                       float* output) {
+  for (int i = 0; i < size; ++i) {
+    output[i] = GetPackedInt4(packed, start + i) * scale;
+  }
+}
+
+}  // namespace internal
+}  // namespace tflite
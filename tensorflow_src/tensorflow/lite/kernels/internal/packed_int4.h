@@ -0,0 +1,67 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_PACKED_INT4_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_PACKED_INT4_H_
+
+#include <cstdint>
+
+namespace tflite {
+namespace internal {
+
+// Helpers for kTfLiteInt4 tensors, whose signed 4 bit values in [-8, 7] are
+// packed two to a byte in flattened element order, element 2 * i in the low
+// nibble of byte i and element 2 * i + 1 in its high nibble. Kernels read the
+// packed bytes directly and unpack them in registers, so weights never take
+// more than half a byte per element in memory.
+
+// Sign extends the low and high nibble of `byte`.
+inline int8_t UnpackLowInt4(uint8_t byte) {
+  return static_cast<int8_t>(byte << 4) >> 4;
+}
+inline int8_t UnpackHighInt4(uint8_t byte) {
+  return static_cast<int8_t>(byte) >> 4;
+}
+
+// Returns element `index` of a packed tensor.
+inline int8_t GetPackedInt4(const uint8_t* packed, int index) {
+  const uint8_t byte = packed[index >> 1];
+  return (index & 1) ? UnpackHighInt4(byte) : UnpackLowInt4(byte);
+}
+
+// Packs `size` values in [-8, 7] into (size + 1) / 2 bytes of `packed`. The
+// high nibble of the last byte is zero if size is odd.
+void PackInt4(const int8_t* values, int size, uint8_t* packed);
+
+// Returns the dot product of `size` float values with the packed elements
+// starting at element `start`, which may be in a high nibble.
+float PackedInt4DotProduct(const uint8_t* packed, int start, int size,
+                           const float* vector);
+
+// Multiplies the packed [m_rows, m_cols] matrix by each of the `n_batch`
+// vectors of m_cols values, scales the product of row r by scales[r], or
+// scales[0] if num_scales is 1, and adds it to result[b * m_rows + r].
+void PackedInt4MatrixBatchVectorMultiplyAccumulate(
+    const uint8_t* matrix, int m_rows, int m_cols, const float* scales,
+    int num_scales, const float* vectors, int n_batch, float* result);
+
+// Writes `size` elements, starting at element `start`, times `scale` to
+// `output`.
+void UnpackInt4ToFloat(const uint8_t* packed, int start, int size, float scale,
+                       float* output);
+
+}  // namespace internal
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_PACKED_INT4_H_
@@ -0,0 +1,99 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/internal/packed_int4.h"
+
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+using ::testing::FloatEq;
+using ::testing::Pointwise;
+
+TEST(PackedInt4Test, PacksLowNibbleFirst) {
+  const std::vector<int8_t> values = {1, -1, 7, -8, -3};
+  std::vector<uint8_t> packed(3);
+  PackInt4(values.data(), values.size(), packed.data());
+  EXPECT_THAT(packed, ElementsAre(0xF1, 0x87, 0x0D));
+  for (int i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(GetPackedInt4(packed.data(), i), values[i]);
+  }
+}
+
+TEST(PackedInt4Test, RoundTripsAllValues) {
+  std::vector<int8_t> values;
+  for (int v = -8; v <= 7; ++v) values.push_back(v);
+  std::vector<uint8_t> packed(values.size() / 2);
+  PackInt4(values.data(), values.size(), packed.data());
+  std::vector<float> unpacked(values.size());
+  UnpackInt4ToFloat(packed.data(), 0, values.size(), 0.5f, unpacked.data());
+  for (int i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(unpacked[i], values[i] * 0.5f);
+  }
+}
+
+TEST(PackedInt4Test, DotProductFromAnyStart) {
+  const std::vector<int8_t> values = {3, -2, 5, 7, -8, 0, 1, -1, 4};
+  std::vector<uint8_t> packed((values.size() + 1) / 2);
+  PackInt4(values.data(), values.size(), packed.data());
+  const std::vector<float> vector = {0.5f, 1.0f, -2.0f, 0.25f,
+                                     3.0f, -1.0f, 2.0f, 1.5f, -0.5f};
+  for (int start = 0; start < values.size(); ++start) {
+    for (int size = 0; start + size <= values.size(); ++size) {
+      float expected = 0.0f;
+      for (int i = 0; i < size; ++i) {
+        expected += values[start + i] * vector[i];
+      }
+      EXPECT_FLOAT_EQ(
+          PackedInt4DotProduct(packed.data(), start, size, vector.data()),
+          expected)
+          << "start " << start << " size " << size;
+    }
+  }
+}
+
+TEST(PackedInt4Test, MatrixBatchVectorMultiplyAccumulate) {
+  // A 3x3 matrix, so that the second row starts in a high nibble.
+  const std::vector<int8_t> matrix = {1, 2, 3, -4, -5, -6, 7, 0, -8};
+  std::vector<uint8_t> packed(5);
+  PackInt4(matrix.data(), matrix.size(), packed.data());
+  const std::vector<float> scales = {1.0f, 0.5f, 0.25f};
+  const std::vector<float> vectors = {1.0f, 2.0f, 3.0f, -1.0f, 0.0f, 1.0f};
+  std::vector<float> result = {1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f};
+  PackedInt4MatrixBatchVectorMultiplyAccumulate(packed.data(), 3, 3,
+                                                scales.data(), 3,
+                                                vectors.data(), 2,
+                                                result.data());
+  EXPECT_THAT(result, Pointwise(FloatEq(), {15.0f, -15.0f, -3.25f, 2.0f, -1.0f,
+                                            -3.75f}));
+
+  // A single scale applies to every row.
+  std::vector<float> per_tensor_result(3);
+  PackedInt4MatrixBatchVectorMultiplyAccumulate(packed.data(), 3, 3,
+                                                scales.data() + 1, 1,
+                                                vectors.data(), 1,
+                                                per_tensor_result.data());
+  EXPECT_THAT(per_tensor_result, ElementsAreArray({7.0f, -16.0f, -8.5f}));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace tflite
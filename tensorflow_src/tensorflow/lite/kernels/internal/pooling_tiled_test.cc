@@ -0,0 +1,342 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/internal/optimized/pooling_tiled.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/pooling.h"
+#include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/pooling.h"
+#include "tensorflow/lite/kernels/internal/reference/pooling.h"
+#include "tensorflow/lite/kernels/internal/test_util.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+#ifdef POOLING_BENCHMARKS
+#include "testing/base/public/benchmark.h"
+#endif  // POOLING_BENCHMARKS
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+namespace tiled = optimized_ops::tiled_pooling;
+
+// Sets up a pool over `input_shape`. Returns false when the window does not
+// fit the input.
+bool MakePool(const RuntimeShape& input_shape, int filter_width,
+              int filter_height, int stride, PaddingType padding_type,
+              PoolParams* params, RuntimeShape* output_shape) {
+  int pad_width, pad_height;
+  if (!ComputeConvSizes(input_shape, input_shape.Dims(3), filter_width,
+                        filter_height, stride, /*dilation_width_factor=*/1,
+                        /*dilation_height_factor=*/1, padding_type,
+                        output_shape, &pad_width, &pad_height)) {
+    return false;
+  }
+  params->filter_width = filter_width;
+  params->filter_height = filter_height;
+  params->stride_width = stride;
+  params->stride_height = stride;
+  params->padding_values.width = pad_width;
+  params->padding_values.height = pad_height;
+  params->float_activation_min = std::numeric_limits<float>::lowest();
+  params->float_activation_max = std::numeric_limits<float>::max();
+  return true;
+}
+
+// Returns a scratch buffer for tiled pools of T over these shapes.
+template <typename T>
+std::vector<int32> MakeScratch(const PoolParams& params,
+                               const RuntimeShape& input_shape,
+                               const RuntimeShape& output_shape) {
+  const size_t bytes =
+      tiled::TiledPoolScratchBytes<T>(params, input_shape, output_shape);
+  return std::vector<int32>((bytes + sizeof(int32) - 1) / sizeof(int32));
+}
+
+// Picks a random pool, including overlapping, non-overlapping and global
+// windows, and depths spanning several channel tranches.
+void GenerateRandomPool(PoolParams* params, RuntimeShape* input_shape,
+                        RuntimeShape* output_shape) {
+  do {
+    const int batch = UniformRandomInt(1, 2);
+    const int depth = UniformRandomInt(1, 300);
+    const int input_height = UniformRandomInt(1, 20);
+    const int input_width = UniformRandomInt(1, 20);
+    input_shape->BuildFrom({batch, input_height, input_width, depth});
+    int filter_width = UniformRandomInt(1, 5);
+    int filter_height = UniformRandomInt(1, 5);
+    if (UniformRandomInt(0, 4) == 0) {
+      filter_width = input_width;
+      filter_height = input_height;
+    }
+    const auto padding_type =
+        UniformRandomInt(0, 1) ? PaddingType::kValid : PaddingType::kSame;
+    if (MakePool(*input_shape, filter_width, filter_height,
+                 UniformRandomInt(1, 3), padding_type, params, output_shape)) {
+      return;
+    }
+  } while (true);
+}
+
+TEST(PoolingTiledTest, FloatMatchesReference) {
+  for (int i = 0; i < 100; ++i) {
+    PoolParams params;
+    RuntimeShape input_shape, output_shape;
+    GenerateRandomPool(&params, &input_shape, &output_shape);
+    params.float_activation_min = -5.0f;
+    params.float_activation_max = 5.0f;
+    std::vector<float> input(input_shape.FlatSize());
+    FillRandom(&input, -10.0f, 10.0f);
+
+    std::vector<float> expected(output_shape.FlatSize());
+    std::vector<float> output(output_shape.FlatSize());
+    std::vector<int32> scratch =
+        MakeScratch<float>(params, input_shape, output_shape);
+    reference_ops::AveragePool(params, input_shape, input.data(), output_shape,
+                               expected.data());
+    tiled::AveragePool(params, nullptr, input_shape, input.data(),
+                       output_shape, output.data(), scratch.data());
+    for (size_t j = 0; j < output.size(); ++j) {
+      EXPECT_NEAR(output[j], expected[j], 1e-5f) << j;
+    }
+
+    reference_ops::MaxPool(params, input_shape, input.data(), output_shape,
+                           expected.data());
+    tiled::MaxPool(params, nullptr, input_shape, input.data(), output_shape,
+                   output.data(), scratch.data());
+    EXPECT_THAT(output, ElementsAreArray(expected));
+  }
+}
+
+TEST(PoolingTiledTest, Uint8MatchesReference) {
+  for (int i = 0; i < 100; ++i) {
+    PoolParams params;
+    RuntimeShape input_shape, output_shape;
+    GenerateRandomPool(&params, &input_shape, &output_shape);
+    params.quantized_activation_min = UniformRandomInt(0, 64);
+    params.quantized_activation_max = UniformRandomInt(192, 255);
+    std::vector<uint8> input(input_shape.FlatSize());
+    FillRandom(&input);
+
+    std::vector<uint8> expected(output_shape.FlatSize());
+    std::vector<uint8> output(output_shape.FlatSize());
+    std::vector<int32> scratch =
+        MakeScratch<uint8>(params, input_shape, output_shape);
+    reference_ops::AveragePool(params, input_shape, input.data(), output_shape,
+                               expected.data());
+    tiled::AveragePool(params, nullptr, input_shape, input.data(),
+                       output_shape, output.data(), scratch.data());
+    EXPECT_EQ(output, expected);
+
+    reference_ops::MaxPool(params, input_shape, input.data(), output_shape,
+                           expected.data());
+    tiled::MaxPool(params, nullptr, input_shape, input.data(), output_shape,
+                   output.data(), scratch.data());
+    EXPECT_EQ(output, expected);
+  }
+}
+
+TEST(PoolingTiledTest, Int8MatchesReference) {
+  for (int i = 0; i < 100; ++i) {
+    PoolParams params;
+    RuntimeShape input_shape, output_shape;
+    GenerateRandomPool(&params, &input_shape, &output_shape);
+    params.quantized_activation_min = UniformRandomInt(-128, -64);
+    params.quantized_activation_max = UniformRandomInt(64, 127);
+    std::vector<int8> input(input_shape.FlatSize());
+    FillRandom(&input);
+
+    std::vector<int8> expected(output_shape.FlatSize());
+    std::vector<int8> output(output_shape.FlatSize());
+    std::vector<int32> scratch =
+        MakeScratch<int8>(params, input_shape, output_shape);
+    reference_integer_ops::AveragePool(params, input_shape, input.data(),
+                                       output_shape, expected.data());
+    tiled::AveragePool(params, nullptr, input_shape, input.data(),
+                       output_shape, output.data(), scratch.data());
+    EXPECT_EQ(output, expected);
+
+    reference_integer_ops::MaxPool(params, input_shape, input.data(),
+                                   output_shape, expected.data());
+    tiled::MaxPool(params, nullptr, input_shape, input.data(), output_shape,
+                   output.data(), scratch.data());
+    EXPECT_EQ(output, expected);
+  }
+}
+
+// With a requantizing output, results are compared against the pool computed
+// on dequantized values, requantized in float.
+TEST(PoolingTiledTest, Int8Requantize) {
+  for (int i = 0; i < 100; ++i) {
+    PoolParams params;
+    RuntimeShape input_shape, output_shape;
+    GenerateRandomPool(&params, &input_shape, &output_shape);
+    params.quantized_activation_min = -128;
+    params.quantized_activation_max = 127;
+    const float input_scale = UniformRandomFloat(0.01f, 0.1f);
+    const float output_scale = input_scale * UniformRandomFloat(0.5f, 2.0f);
+    tiled::PoolRequantizeParams requantize;
+    requantize.input_zero_point = UniformRandomInt(-20, 20);
+    requantize.output_zero_point = UniformRandomInt(-20, 20);
+    QuantizeMultiplier(static_cast<double>(input_scale) / output_scale,
+                       &requantize.output_multiplier,
+                       &requantize.output_shift);
+
+    std::vector<int8> input(input_shape.FlatSize());
+    FillRandom(&input);
+    std::vector<float> dequantized(input.size());
+    for (size_t j = 0; j < input.size(); ++j) {
+      dequantized[j] = (input[j] - requantize.input_zero_point) * input_scale;
+    }
+
+    std::vector<float> float_output(output_shape.FlatSize());
+    std::vector<int8> output(output_shape.FlatSize());
+    std::vector<int32> scratch =
+        MakeScratch<int8>(params, input_shape, output_shape);
+    for (const bool max_pool : {false, true}) {
+      if (max_pool) {
+        reference_ops::MaxPool(params, input_shape, dequantized.data(),
+                               output_shape, float_output.data());
+        tiled::MaxPool(params, &requantize, input_shape, input.data(),
+                       output_shape, output.data(), scratch.data());
+      } else {
+        reference_ops::AveragePool(params, input_shape, dequantized.data(),
+                                   output_shape, float_output.data());
+        tiled::AveragePool(params, &requantize, input_shape, input.data(),
+                           output_shape, output.data(), scratch.data());
+      }
+      for (size_t j = 0; j < output.size(); ++j) {
+        const float expected = std::min(
+            127.0f, std::max(-128.0f, std::round(float_output[j] /
+                                                 output_scale) +
+                                          requantize.output_zero_point));
+        // The average is rounded once in the input scale and once more when
+        // rescaled.
+        EXPECT_NEAR(output[j], expected, max_pool ? 1 : 2) << j;
+      }
+    }
+  }
+}
+
+TEST(PoolingTiledTest, IsGlobalPool) {
+  PoolParams params;
+  RuntimeShape output_shape;
+  const RuntimeShape input_shape({1, 7, 7, 1024});
+  ASSERT_TRUE(MakePool(input_shape, 7, 7, 1, PaddingType::kValid, &params,
+                       &output_shape));
+  EXPECT_TRUE(tiled::IsGlobalPool(params, input_shape, output_shape));
+  ASSERT_TRUE(MakePool(input_shape, 3, 3, 2, PaddingType::kSame, &params,
+                       &output_shape));
+  EXPECT_FALSE(tiled::IsGlobalPool(params, input_shape, output_shape));
+  ASSERT_TRUE(MakePool(input_shape, 4, 4, 4, PaddingType::kValid, &params,
+                       &output_shape));
+  EXPECT_FALSE(tiled::IsGlobalPool(params, input_shape, output_shape));
+}
+
+}  // namespace
+}  // namespace tflite
+
+#ifdef POOLING_BENCHMARKS
+
+// Compile with --copt="-DGOOGLE_COMMANDLINEFLAGS_FULL_API=1" and
+// --copt="-DPOOLING_BENCHMARKS"
+// Run with --benchmarks=all
+//
+// Arguments: input size, depth, filter size, stride, and kernel: 0 for the
+// reference kernel, 1 for the generic optimized kernel, 2 for the tiled one.
+// Shapes follow common MobileNet and ResNet pools: 3x3/2 and 2x2/2 max pools,
+// 3x3/1 average pools and 7x7 global average pools.
+template <typename T>
+void BM_Pool(benchmark::State& state, bool max_pool) {
+  const int size = state.range(0);
+  const int depth = state.range(1);
+  const int filter = state.range(2);
+  const int stride = state.range(3);
+  const int kernel = state.range(4);
+
+  tflite::PoolParams params;
+  tflite::RuntimeShape output_shape;
+  const tflite::RuntimeShape input_shape({1, size, size, depth});
+  // Windows as large as the input are global pools.
+  tflite::MakePool(input_shape, filter, filter, stride,
+                   filter == size ? tflite::PaddingType::kValid
+                                  : tflite::PaddingType::kSame,
+                   &params, &output_shape);
+  params.quantized_activation_min = std::numeric_limits<T>::min();
+  params.quantized_activation_max = std::numeric_limits<T>::max();
+  std::vector<T> input(input_shape.FlatSize());
+  std::vector<T> output(output_shape.FlatSize());
+  std::vector<tflite::int32> scratch =
+      tflite::MakeScratch<T>(params, input_shape, output_shape);
+  tflite::FillRandom(&input);
+
+  for (auto _ : state) {
+    if (kernel == 0 && max_pool) {
+      tflite::reference_ops::MaxPool(params, input_shape, input.data(),
+                                     output_shape, output.data());
+    } else if (kernel == 0) {
+      tflite::reference_ops::AveragePool(params, input_shape, input.data(),
+                                         output_shape, output.data());
+    } else if (kernel == 1 && max_pool) {
+      tflite::optimized_ops::MaxPool(params, input_shape, input.data(),
+                                     output_shape, output.data());
+    } else if (kernel == 1) {
+      tflite::optimized_ops::AveragePool(params, input_shape, input.data(),
+                                         output_shape, output.data());
+    } else if (max_pool) {
+      tflite::optimized_ops::tiled_pooling::MaxPool(
+          params, nullptr, input_shape, input.data(), output_shape,
+          output.data(), scratch.data());
+    } else {
+      tflite::optimized_ops::tiled_pooling::AveragePool(
+          params, nullptr, input_shape, input.data(), output_shape,
+          output.data(), scratch.data());
+    }
+    testing::DoNotOptimize(output[0]);
+  }
+  state.SetItemsProcessed(state.iterations() * input.size());
+}
+
+void BM_MaxPoolUint8(benchmark::State& state) {
+  BM_Pool<uint8_t>(state, /*max_pool=*/true);
+}
+void BM_AveragePoolUint8(benchmark::State& state) {
+  BM_Pool<uint8_t>(state, /*max_pool=*/false);
+}
+
+void PoolShapes(benchmark::internal::Benchmark* b) {
+  for (int kernel = 0; kernel <= 2; ++kernel) {
+    b->Args({112, 64, 3, 2, kernel});
+    b->Args({56, 128, 2, 2, kernel});
+    b->Args({28, 256, 3, 1, kernel});
+    b->Args({14, 512, 3, 2, kernel});
+    b->Args({7, 1024, 7, 1, kernel});
+    b->Args({7, 1280, 7, 1, kernel});
+  }
+}
+
+BENCHMARK(BM_MaxPoolUint8)->Apply(PoolShapes);
+BENCHMARK(BM_AveragePoolUint8)->Apply(PoolShapes);
+
+#endif  // POOLING_BENCHMARKS
@@ -18,7 +18,7 @@ limitations under the License.
 #include <assert.h>
 #include <math.h>
 
-#include "third_party/fft2d/fft.h"
+#include "tensorflow/lite/kernels/internal/mixed_radix_fft.h"
 
 namespace tflite {
 namespace internal {
@@ -93,17 +93,13 @@ bool Spectrogram::Initialize(const std::vector<double>& window,
   // CHECK(fft_length_ >= window_length_);
   output_frequency_channels_ = 1 + fft_length_ / 2;
 
-  // Allocate 2 more than what rdft needs, so we can rationalize the layout.
-  fft_input_output_.assign(fft_length_ + 2, 0.0);
-
-  int half_fft_length = fft_length_ / 2;
-  fft_double_working_area_.assign(half_fft_length, 0.0);
-  fft_integer_working_area_.assign(2 + static_cast<int>(sqrt(half_fft_length)),
-                                   0);
-  // Set flag element to ensure that the working areas are initialized
-  // on the first call to cdft.  It's redundant given the assign above,
-  // but keep it as a reminder.
-  fft_integer_working_area_[0] = 0;
+  if (!fft_.Initialize(fft_length_)) {
+    initialized_ = false;
+    return false;
+  }
+  fft_input_.assign(window_length_, 0.0);
+  fft_output_.assign(output_frequency_channels_, 0.0);
+  fft_working_area_.assign(fft_.work_size(), 0.0);
   input_queue_.clear();
   samples_to_next_step_ = window_length_;
   initialized_ = true;
@@ -125,16 +121,18 @@ bool Spectrogram::ComputeComplexSpectrogram(
   int input_start = 0;
   while (GetNextWindowOfSamples(input, &input_start)) {
     // DCHECK_EQ(input_queue_.size(), window_length_);
-    ProcessCoreFFT();  // Processes input_queue_ to fft_input_output_.
+    ProcessCoreFFT();  // Processes input_queue_ to fft_output_.
     // Add a new slice vector onto the output, to save new result to.
     output->resize(output->size() + 1);
     // Get a reference to the newly added slice to fill in.
     auto& spectrogram_slice = output->back();
     spectrogram_slice.resize(output_frequency_channels_);
     for (int i = 0; i < output_frequency_channels_; ++i) {
+      // The FFT computes sum(x[n] * exp(-2*pi*i*k*n/N)), while the rdft this
+      // class used to call produced the conjugate; keep emitting that.
       // This will convert double to float if it needs to.
-      spectrogram_slice[i] = complex<OutputSample>(
-          fft_input_output_[2 * i], fft_input_output_[2 * i + 1]);
+      spectrogram_slice[i] = complex<OutputSample>(fft_output_[i].real(),
+                                                   -fft_output_[i].imag());
     }
   }
   return true;
@@ -166,7 +164,7 @@ bool Spectrogram::ComputeSquaredMagnitudeSpectrogram(
   int input_start = 0;
   while (GetNextWindowOfSamples(input, &input_start)) {
     // DCHECK_EQ(input_queue_.size(), window_length_);
-    ProcessCoreFFT();  // Processes input_queue_ to fft_input_output_.
+    ProcessCoreFFT();  // Processes input_queue_ to fft_output_.
     // Add a new slice vector onto the output, to save new result to.
     output->resize(output->size() + 1);
     // Get a reference to the newly added slice to fill in.
@@ -176,8 +174,8 @@ bool Spectrogram::ComputeSquaredMagnitudeSpectrogram(
       // Similar to the Complex case, except storing the norm.
       // But the norm function is known to be a performance killer,
       // so do it this way with explicit real and imaginary temps.
-      const double re = fft_input_output_[2 * i];
-      const double im = fft_input_output_[2 * i + 1];
+      const double re = fft_output_[i].real();
+      const double im = fft_output_[i].imag();
       // Which finally converts double to float if it needs to.
       spectrogram_slice[i] = re * re + im * im;
     }
@@ -223,21 +221,11 @@ bool Spectrogram::GetNextWindowOfSamples(const std::vector<InputSample>& input,
 
 void Spectrogram::ProcessCoreFFT() {
   for (int j = 0; j < window_length_; ++j) {
-    fft_input_output_[j] = input_queue_[j] * window_[j];
-  }
-  // Zero-pad the rest of the input buffer.
-  for (int j = window_length_; j < fft_length_; ++j) {
-    fft_input_output_[j] = 0.0;
+    fft_input_[j] = input_queue_[j] * window_[j];
   }
-  const int kForwardFFT = 1;  // 1 means forward; -1 reverse.
-  // This real FFT is a fair amount faster than using cdft here.
-  rdft(fft_length_, kForwardFFT, &fft_input_output_[0],
-       &fft_integer_working_area_[0], &fft_double_working_area_[0]);
-  // Make rdft result look like cdft result;
-  // unpack the last real value from the first position's imag slot.
-  fft_input_output_[fft_length_] = fft_input_output_[1];
-  fft_input_output_[fft_length_ + 1] = 0;
-  fft_input_output_[1] = 0;
+  // The FFT zero-pads the window up to fft_length_.
+  fft_.Forward(fft_input_.data(), window_length_, fft_output_.data(),
+               fft_working_area_.data());
 }
 
 }  // namespace internal
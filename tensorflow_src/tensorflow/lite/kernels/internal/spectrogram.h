@@ -35,7 +35,7 @@ limitations under the License.
 #include <deque>
 #include <vector>
 
-#include "third_party/fft2d/fft.h"
+#include "tensorflow/lite/kernels/internal/mixed_radix_fft.h"
 
 namespace tflite {
 namespace internal {
@@ -96,12 +96,13 @@ class Spectrogram {
   int samples_to_next_step_;
 
   std::vector<double> window_;
-  std::vector<double> fft_input_output_;
+  std::vector<double> fft_input_;
+  std::vector<std::complex<double>> fft_output_;
   std::deque<double> input_queue_;
 
-  // Working data areas for the FFT routines.
-  std::vector<int> fft_integer_working_area_;
-  std::vector<double> fft_double_working_area_;
+  RealFft<double> fft_;
+  // Working data area for the FFT routines.
+  std::vector<std::complex<double>> fft_working_area_;
 };
 
 // Explicit instantiations in spectrogram.cc.
@@ -0,0 +1,84 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/internal/spectrogram.h"
+
+#include <math.h>
+
+#include <complex>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace internal {
+namespace {
+
+using std::complex;
+
+constexpr int kLength = 8;
+
+// One window of sin(2 * pi * n / kLength) under a rectangular window.
+std::vector<double> SineWindow() {
+  std::vector<double> input(kLength);
+  for (int n = 0; n < kLength; ++n) {
+    input[n] = sin(2.0 * M_PI * n / kLength);
+  }
+  return input;
+}
+
+TEST(SpectrogramTest, ComplexMatchesRdftSign) {
+  Spectrogram spectrogram;
+  ASSERT_TRUE(spectrogram.Initialize(std::vector<double>(kLength, 1.0),
+                                     /*step_length=*/kLength));
+  std::vector<std::vector<complex<double>>> output;
+  ASSERT_TRUE(spectrogram.ComputeComplexSpectrogram(SineWindow(), &output));
+  ASSERT_EQ(output.size(), 1);
+  ASSERT_EQ(output[0].size(), kLength / 2 + 1);
+  // sum(x[n] * exp(+2*pi*i*k*n/N)), as rdft computed it: the sine lands on
+  // +i * N/2 in bin 1 and nowhere else.
+  for (int k = 0; k <= kLength / 2; ++k) {
+    const double imag = k == 1 ? kLength / 2 : 0.0;
+    EXPECT_NEAR(output[0][k].real(), 0.0, 1e-9) << "bin " << k;
+    EXPECT_NEAR(output[0][k].imag(), imag, 1e-9) << "bin " << k;
+  }
+}
+
+TEST(SpectrogramTest, SquaredMagnitudeMatchesComplex) {
+  Spectrogram complex_spectrogram;
+  Spectrogram magnitude_spectrogram;
+  ASSERT_TRUE(complex_spectrogram.Initialize(kLength, kLength / 2));
+  ASSERT_TRUE(magnitude_spectrogram.Initialize(kLength, kLength / 2));
+  std::vector<double> input = SineWindow();
+  input.insert(input.end(), input.begin(), input.end());
+
+  std::vector<std::vector<complex<double>>> complex_output;
+  std::vector<std::vector<double>> magnitude_output;
+  ASSERT_TRUE(
+      complex_spectrogram.ComputeComplexSpectrogram(input, &complex_output));
+  ASSERT_TRUE(magnitude_spectrogram.ComputeSquaredMagnitudeSpectrogram(
+      input, &magnitude_output));
+  ASSERT_EQ(complex_output.size(), 3);
+  ASSERT_EQ(magnitude_output.size(), complex_output.size());
+  for (int i = 0; i < complex_output.size(); ++i) {
+    for (int k = 0; k < complex_output[i].size(); ++k) {
+      EXPECT_NEAR(magnitude_output[i][k], std::norm(complex_output[i][k]),
+                  1e-9);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace tflite
@@ -1096,6 +1096,12 @@ struct SoftmaxParams {
   int16_t* one_over_one_plus_x_lut;
   uint8_t* uint8_table1;
   uint8_t* uint8_table2;
+  // int16 LUT for exp(-input_scale * beta * d) in Q0.15, where d = max - x is
+  // the 8-bit distance to the row maximum (256 entries).
+  int16_t* exp_q15_table;
+  // Rescales a Q0.15 probability to the output scale.
+  int32_t output_multiplier;
+  int output_shift;
 };
 
 struct SpaceToBatchParams {
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #include <vector>
 
@@ -44,6 +45,16 @@ typedef struct {
   float lower_frequency_limit;
   int filterbank_channel_count;
   int dct_coefficient_count;
+  // Initialized for the spectrogram width and sample rate of the last invoke.
+  internal::Mfcc* mfcc;
+  int mfcc_input_length;
+  int mfcc_sample_rate;
+  // In streaming mode, the frames that the input shares with the previous
+  // input, e.g. because it comes from a sliding window over the same audio,
+  // reuse the previously computed coefficients.
+  bool streaming;
+  std::vector<float>* previous_input;
+  std::vector<float>* previous_output;
 } TfLiteMfccParams;
 
 constexpr int kInputTensorWav = 0;
@@ -60,11 +71,21 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   data->lower_frequency_limit = m["lower_frequency_limit"].AsInt64();
   data->filterbank_channel_count = m["filterbank_channel_count"].AsInt64();
   data->dct_coefficient_count = m["dct_coefficient_count"].AsInt64();
+  data->mfcc = nullptr;
+  data->mfcc_input_length = 0;
+  data->mfcc_sample_rate = 0;
+  data->streaming = m["streaming"].AsBool();
+  data->previous_input = new std::vector<float>;
+  data->previous_output = new std::vector<float>;
   return data;
 }
 
 void Free(TfLiteContext* context, void* buffer) {
-  delete reinterpret_cast<TfLiteMfccParams*>(buffer);
+  auto* params = reinterpret_cast<TfLiteMfccParams*>(buffer);
+  delete params->mfcc;
+  delete params->previous_input;
+  delete params->previous_output;
+  delete params;
 }
 
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
@@ -98,6 +119,28 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   return context->ResizeTensor(context, output, output_size);
 }
 
+// Returns how many of the leading frames equal the trailing frames of the
+// previous input. Gives up once it compared a few times as many frames as the
+// input has, so that it stays cheaper than computing the coefficients.
+int CountRepeatedFrames(const float* previous_frames, const float* frames,
+                        int frame_count, int frame_size) {
+  const size_t frame_bytes = frame_size * sizeof(float);
+  int comparisons_left = 4 * frame_count;
+  for (int shift = 0; shift < frame_count; ++shift) {
+    const int overlap = frame_count - shift;
+    int frame = 0;
+    while (frame < overlap && comparisons_left > 0 &&
+           memcmp(previous_frames + (shift + frame) * frame_size,
+                  frames + frame * frame_size, frame_bytes) == 0) {
+      ++frame;
+      --comparisons_left;
+    }
+    if (frame == overlap) return overlap;
+    if (--comparisons_left <= 0) return 0;
+  }
+  return 0;
+}
+
 // Input is a single squared-magnitude spectrogram frame. The input spectrum
 // is converted to linear magnitude and weighted into bands using a
 // triangular mel filterbank, and a discrete cosine transform (DCT) of the
@@ -123,20 +166,58 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const int spectrogram_samples = input_wav->dims->data[1];
   const int audio_channels = input_wav->dims->data[0];
 
-  internal::Mfcc mfcc;
-  mfcc.set_upper_frequency_limit(params->upper_frequency_limit);
-  mfcc.set_lower_frequency_limit(params->lower_frequency_limit);
-  mfcc.set_filterbank_channel_count(params->filterbank_channel_count);
-  mfcc.set_dct_coefficient_count(params->dct_coefficient_count);
-
-  mfcc.Initialize(spectrogram_channels, sample_rate);
+  if (params->mfcc == nullptr ||
+      params->mfcc_input_length != spectrogram_channels ||
+      params->mfcc_sample_rate != sample_rate) {
+    delete params->mfcc;
+    params->mfcc = new internal::Mfcc;
+    internal::Mfcc& mfcc = *params->mfcc;
+    mfcc.set_upper_frequency_limit(params->upper_frequency_limit);
+    mfcc.set_lower_frequency_limit(params->lower_frequency_limit);
+    mfcc.set_filterbank_channel_count(params->filterbank_channel_count);
+    mfcc.set_dct_coefficient_count(params->dct_coefficient_count);
+
+    mfcc.Initialize(spectrogram_channels, sample_rate);
+    params->mfcc_input_length = spectrogram_channels;
+    params->mfcc_sample_rate = sample_rate;
+    params->previous_input->clear();
+  }
+  const internal::Mfcc& mfcc = *params->mfcc;
 
   const float* spectrogram_flat = GetTensorData<float>(input_wav);
   float* output_flat = GetTensorData<float>(output);
 
+  const size_t input_size = NumElements(input_wav);
+  const size_t output_size = NumElements(output);
+  const bool has_previous =
+      params->streaming && params->previous_input->size() == input_size;
+  if (params->streaming) {
+    params->previous_output->resize(output_size);
+    // Computes into the cached output, so that it is there next time.
+    output_flat = params->previous_output->data();
+  }
+
   for (int audio_channel = 0; audio_channel < audio_channels; ++audio_channel) {
-    for (int spectrogram_sample = 0; spectrogram_sample < spectrogram_samples;
-         ++spectrogram_sample) {
+    int first_new_sample = 0;
+    if (has_previous) {
+      const int input_offset =
+          audio_channel * spectrogram_samples * spectrogram_channels;
+      const int repeated_samples = CountRepeatedFrames(
+          params->previous_input->data() + input_offset,
+          spectrogram_flat + input_offset, spectrogram_samples,
+          spectrogram_channels);
+      float* channel_output = output_flat + audio_channel *
+                                                spectrogram_samples *
+                                                params->dct_coefficient_count;
+      memmove(channel_output,
+              channel_output + (spectrogram_samples - repeated_samples) *
+                                   params->dct_coefficient_count,
+              repeated_samples * params->dct_coefficient_count *
+                  sizeof(float));
+      first_new_sample = repeated_samples;
+    }
+    for (int spectrogram_sample = first_new_sample;
+         spectrogram_sample < spectrogram_samples; ++spectrogram_sample) {
       const float* sample_data =
           spectrogram_flat +
           (audio_channel * spectrogram_samples * spectrogram_channels) +
@@ -157,6 +238,13 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     }
   }
 
+  if (params->streaming) {
+    params->previous_input->assign(spectrogram_flat,
+                                   spectrogram_flat + input_size);
+    memcpy(GetTensorData<float>(output), output_flat,
+           output_size * sizeof(float));
+  }
+
   return kTfLiteOk;
 }
 
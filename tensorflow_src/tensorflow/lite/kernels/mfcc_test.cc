@@ -36,7 +36,7 @@ using ::testing::ElementsAreArray;
 class BaseMfccOpModel : public SingleOpModel {
  public:
   BaseMfccOpModel(const TensorData& input1, const TensorData& input2,
-                  const TensorData& output) {
+                  const TensorData& output, bool streaming = false) {
     input1_ = AddInput(input1);
     input2_ = AddInput(input2);
     output_ = AddOutput(output);
@@ -47,6 +47,9 @@ class BaseMfccOpModel : public SingleOpModel {
       fbb.Int("lower_frequency_limit", 20);
       fbb.Int("filterbank_channel_count", 40);
       fbb.Int("dct_coefficient_count", 13);
+      if (streaming) {
+        fbb.Bool("streaming", true);
+      }
     });
     fbb.Finish();
     SetCustomOp("Mfcc", fbb.GetBuffer(), Register_MFCC);
@@ -115,6 +118,43 @@ TEST(MfccOpTest, ScalarInputRateTest) {
           1e-3)));
 }
 
+TEST(MfccOpTest, StreamingTest) {
+  const int kFrames = 4;
+  const int kWidth = 513;
+  BaseMfccOpModel streaming({TensorType_FLOAT32, {2, kFrames, kWidth}},
+                            {TensorType_INT32, {1}}, {TensorType_FLOAT32, {}},
+                            /*streaming=*/true);
+  BaseMfccOpModel reference({TensorType_FLOAT32, {2, kFrames, kWidth}},
+                            {TensorType_INT32, {1}}, {TensorType_FLOAT32, {}});
+  streaming.PopulateTensor<int>(streaming.input2(), {22050});
+  reference.PopulateTensor<int>(reference.input2(), {22050});
+
+  // Slides a window over a sequence of frames, by one frame for the first
+  // channel and by a varying number of frames for the second one.
+  const int shifts[] = {0, 1, 1, 3, 0, 2, 5, 1};
+  int first_frames[2] = {0, 0};
+  for (int step = 0; step < 8; ++step) {
+    first_frames[0] += 1;
+    first_frames[1] += shifts[step];
+    std::vector<float> data;
+    for (int channel = 0; channel < 2; ++channel) {
+      for (int frame = 0; frame < kFrames; ++frame) {
+        const int global_frame = first_frames[channel] + frame;
+        for (int i = 0; i < kWidth; ++i) {
+          data.push_back((global_frame * 7 + i) % 23 + channel);
+        }
+      }
+    }
+    streaming.PopulateTensor<float>(streaming.input1(), data);
+    reference.PopulateTensor<float>(reference.input1(), data);
+    streaming.Invoke();
+    reference.Invoke();
+
+    EXPECT_THAT(streaming.GetOutputShape(), ElementsAre(2, kFrames, 13));
+    EXPECT_THAT(streaming.GetOutput(), ElementsAreArray(reference.GetOutput()));
+  }
+}
+
 }  // namespace
 }  // namespace custom
 }  // namespace ops
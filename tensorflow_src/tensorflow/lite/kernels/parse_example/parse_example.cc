@@ -614,16 +614,9 @@ Status FastParseExampleLite(
       const int32_t num_strings = offsets.size() - 1;
       const size_t required_bytes = sizeof(int32_t) * (num_strings + 2) +
           total_size;
+      TfLiteTensorRealloc(required_bytes, result->dense_values[d]);
       char* tensor_buffer =
           reinterpret_cast<char*>(result->dense_values[d]->data.raw);
-      if (result->dense_values[d]->bytes < required_bytes) {
-        if (result->dense_values[d]->data.raw) {
-          free(result->dense_values[d]->data.raw);
-        }
-        tensor_buffer = reinterpret_cast<char*>(malloc(required_bytes));
-        result->dense_values[d]->data.raw = tensor_buffer;
-        result->dense_values[d]->bytes = required_bytes;
-      }
       const int32_t start = sizeof(int32_t) * (num_strings + 2);
       memcpy(tensor_buffer, &num_strings, sizeof(int32_t));
       for (size_t i = 0; i < offsets.size(); i++) {
@@ -18,11 +18,14 @@ limitations under the License.
 #include <stdint.h>
 
 #include <cstdlib>
+#include <type_traits>
 
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/optimized/pooling_tiled.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/pooling.h"
 #include "tensorflow/lite/kernels/internal/reference/pooling.h"
 #include "tensorflow/lite/kernels/internal/reference/reference_ops.h"
@@ -37,10 +40,13 @@ namespace ops {
 namespace builtin {
 namespace pooling {
 
-// This file has two implementation of each pooling op.
+// This file has two implementation of each pooling op, plus a tiled one for
+// AVERAGE_POOL_2D and MAX_POOL_2D. The generic optimized kernels also route
+// global pools, and 8-bit pools on targets without NEON, to the tiled ones.
 enum KernelType {
   kReference,
   kGenericOptimized,
+  kTiled,
 };
 
 enum PoolType {
@@ -51,20 +57,70 @@ enum PoolType {
 
 struct OpData {
   TfLitePaddingValues padding;
+  // Only set by the tiled kernels, for 8-bit outputs whose scale or zero point
+  // differ from the input's; the rescale is fused into the pooling pass.
+  bool requantize;
+  optimized_ops::tiled_pooling::PoolRequantizeParams requantize_params;
+  // Whether Eval() runs the tiled kernel, whose scratch buffer is the
+  // temporary tensor at scratch_tensor_index.
+  bool tiled;
+  int scratch_tensor_index;
 };
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   // This is a builtin op, so we don't use the contents in 'buffer', if any.
   // Instead, we allocate a new object to carry information from Prepare() to
   // Eval().
-  return new OpData;
+  auto* data = new OpData;
+  context->AddTensors(context, 1, &data->scratch_tensor_index);
+  return data;
 }
 
 void Free(TfLiteContext* context, void* buffer) {
   delete reinterpret_cast<OpData*>(buffer);
 }
 
-template <PoolType pool_type>
+// Fills everything but the activation range.
+tflite::PoolParams GetPoolGeometry(const TfLitePoolParams* params,
+                                   const OpData* data) {
+  tflite::PoolParams op_params;
+  op_params.stride_height = params->stride_height;
+  op_params.stride_width = params->stride_width;
+  op_params.filter_height = params->filter_height;
+  op_params.filter_width = params->filter_width;
+  op_params.padding_values.height = data->padding.height;
+  op_params.padding_values.width = data->padding.width;
+  return op_params;
+}
+
+// Besides the kTiled registrations, the generic optimized kernels hand global
+// pools to the tiled kernels, and 8-bit pools too on targets without NEON,
+// where they would otherwise rescan the whole window for every output pixel
+// in scalar code.
+template <KernelType kernel_type, PoolType pool_type>
+bool UseTiledKernel(TfLiteType type, const tflite::PoolParams& geometry,
+                    const RuntimeShape& input_shape,
+                    const RuntimeShape& output_shape) {
+  if (pool_type == kL2 || (type != kTfLiteFloat32 && type != kTfLiteUInt8 &&
+                           type != kTfLiteInt8)) {
+    return false;
+  }
+  switch (kernel_type) {
+    case kReference:
+      return false;
+    case kTiled:
+      return true;
+    case kGenericOptimized:
+#ifndef USE_NEON
+      if (type != kTfLiteFloat32) return true;
+#endif
+      return optimized_ops::tiled_pooling::IsGlobalPool(geometry, input_shape,
+                                                        output_shape);
+  }
+  return false;
+}
+
+template <KernelType kernel_type, PoolType pool_type>
 TfLiteStatus GenericPrepare(TfLiteContext* context, TfLiteNode* node) {
   auto* params = reinterpret_cast<TfLitePoolParams*>(node->builtin_data);
   OpData* data = reinterpret_cast<OpData*>(node->user_data);
@@ -92,8 +148,23 @@ TfLiteStatus GenericPrepare(TfLiteContext* context, TfLiteNode* node) {
       params->filter_height, params->filter_width, padding, &out_height,
       &out_width);
 
+  data->requantize = false;
   if (input->type == kTfLiteUInt8 || input->type == kTfLiteInt8) {
-    if (pool_type == kAverage || pool_type == kMax) {
+    if (kernel_type == kTiled && (pool_type == kAverage || pool_type == kMax)) {
+      data->requantize =
+          std::abs(input->params.scale - output->params.scale) > 1.0e-6 ||
+          input->params.zero_point != output->params.zero_point;
+      if (data->requantize) {
+        TF_LITE_ENSURE(context, output->params.scale > 0);
+        const double real_multiplier =
+            static_cast<double>(input->params.scale) / output->params.scale;
+        data->requantize_params.input_zero_point = input->params.zero_point;
+        data->requantize_params.output_zero_point = output->params.zero_point;
+        QuantizeMultiplier(real_multiplier,
+                           &data->requantize_params.output_multiplier,
+                           &data->requantize_params.output_shift);
+      }
+    } else if (pool_type == kAverage || pool_type == kMax) {
       TFLITE_DCHECK_LE(std::abs(input->params.scale - output->params.scale),
                        1.0e-6);
       TFLITE_DCHECK_EQ(input->params.zero_point, output->params.zero_point);
@@ -104,6 +175,33 @@ TfLiteStatus GenericPrepare(TfLiteContext* context, TfLiteNode* node) {
     }
   }
 
+  const tflite::PoolParams geometry = GetPoolGeometry(params, data);
+  const RuntimeShape input_shape = GetTensorShape(input);
+  const RuntimeShape output_shape(
+      {batches, out_height, out_width, channels_out});
+  data->tiled = UseTiledKernel<kernel_type, pool_type>(
+      input->type, geometry, input_shape, output_shape);
+  TfLiteIntArrayFree(node->temporaries);
+  node->temporaries = TfLiteIntArrayCreate(data->tiled ? 1 : 0);
+  if (data->tiled) {
+    node->temporaries->data[0] = data->scratch_tensor_index;
+    TfLiteTensor* scratch;
+    TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, 0, &scratch));
+    scratch->type = kTfLiteInt8;
+    scratch->allocation_type = kTfLiteArenaRw;
+    // The accumulators are float for float pools and int32 otherwise.
+    const size_t scratch_bytes =
+        input->type == kTfLiteFloat32
+            ? optimized_ops::tiled_pooling::TiledPoolScratchBytes<float>(
+                  geometry, input_shape, output_shape)
+            : optimized_ops::tiled_pooling::TiledPoolScratchBytes<int8_t>(
+                  geometry, input_shape, output_shape);
+    TfLiteIntArray* scratch_size = TfLiteIntArrayCreate(1);
+    scratch_size->data[0] = static_cast<int>(scratch_bytes);
+    TF_LITE_ENSURE_OK(context,
+                      context->ResizeTensor(context, scratch, scratch_size));
+  }
+
   TfLiteIntArray* output_size = TfLiteIntArrayCreate(4);
   output_size->data[0] = batches;
   output_size->data[1] = out_height;
@@ -112,6 +210,24 @@ TfLiteStatus GenericPrepare(TfLiteContext* context, TfLiteNode* node) {
   return context->ResizeTensor(context, output, output_size);
 }
 
+template <PoolType pool_type, typename T>
+void TiledEval(TfLiteContext* context, TfLiteNode* node,
+               const tflite::PoolParams& op_params, const OpData* data,
+               const TfLiteTensor* input, TfLiteTensor* output) {
+  const optimized_ops::tiled_pooling::PoolRequantizeParams* requantize =
+      data->requantize ? &data->requantize_params : nullptr;
+  void* scratch = GetTemporary(context, node, 0)->data.raw;
+  if (pool_type == kAverage) {
+    optimized_ops::tiled_pooling::AveragePool(
+        op_params, requantize, GetTensorShape(input), GetTensorData<T>(input),
+        GetTensorShape(output), GetTensorData<T>(output), scratch);
+  } else {
+    optimized_ops::tiled_pooling::MaxPool(
+        op_params, requantize, GetTensorShape(input), GetTensorData<T>(input),
+        GetTensorShape(output), GetTensorData<T>(output), scratch);
+  }
+}
+
 template <KernelType kernel_type>
 void AverageEvalFloat(TfLiteContext* context, TfLiteNode* node,
                       TfLitePoolParams* params, OpData* data,
@@ -119,6 +235,13 @@ void AverageEvalFloat(TfLiteContext* context, TfLiteNode* node,
   float activation_min, activation_max;
   CalculateActivationRange(params->activation, &activation_min,
                            &activation_max);
+  if (data->tiled) {
+    tflite::PoolParams op_params = GetPoolGeometry(params, data);
+    op_params.float_activation_min = activation_min;
+    op_params.float_activation_max = activation_max;
+    TiledEval<kAverage, float>(context, node, op_params, data, input, output);
+    return;
+  }
 #define TF_LITE_AVERAGE_POOL(type)                                       \
   tflite::PoolParams op_params;                                          \
   op_params.stride_height = params->stride_height;                       \
@@ -149,6 +272,13 @@ void AverageEvalQuantizedUint8(TfLiteContext* context, TfLiteNode* node,
   int32_t activation_max;
   (void)CalculateActivationRangeQuantized(context, params->activation, output,
                                           &activation_min, &activation_max);
+  if (data->tiled) {
+    tflite::PoolParams op_params = GetPoolGeometry(params, data);
+    op_params.quantized_activation_min = activation_min;
+    op_params.quantized_activation_max = activation_max;
+    TiledEval<kAverage, uint8_t>(context, node, op_params, data, input, output);
+    return;
+  }
 #define TF_LITE_AVERAGE_POOL(type)                                         \
   tflite::PoolParams op_params;                                            \
   op_params.stride_height = params->stride_height;                         \
@@ -179,6 +309,13 @@ void AverageEvalQuantizedInt8(TfLiteContext* context, TfLiteNode* node,
 
   (void)CalculateActivationRangeQuantized(context, params->activation, output,
                                           &activation_min, &activation_max);
+  if (data->tiled) {
+    tflite::PoolParams op_params = GetPoolGeometry(params, data);
+    op_params.quantized_activation_min = activation_min;
+    op_params.quantized_activation_max = activation_max;
+    TiledEval<kAverage, int8_t>(context, node, op_params, data, input, output);
+    return;
+  }
 #define TF_LITE_AVERAGE_POOL(type)                                        \
   tflite::PoolParams op_params;                                           \
   op_params.stride_height = params->stride_height;                        \
@@ -233,6 +370,13 @@ void MaxEvalFloat(TfLiteContext* context, TfLiteNode* node,
   float activation_min, activation_max;
   CalculateActivationRange(params->activation, &activation_min,
                            &activation_max);
+  if (data->tiled) {
+    tflite::PoolParams op_params = GetPoolGeometry(params, data);
+    op_params.float_activation_min = activation_min;
+    op_params.float_activation_max = activation_max;
+    TiledEval<kMax, float>(context, node, op_params, data, input, output);
+    return;
+  }
 #define TF_LITE_MAX_POOL(type)                                                 \
   tflite::PoolParams op_params;                                                \
   op_params.stride_height = params->stride_height;                             \
@@ -261,6 +405,13 @@ void MaxEvalQuantizedUInt8(TfLiteContext* context, TfLiteNode* node,
   int32_t activation_max;
   (void)CalculateActivationRangeQuantized(context, params->activation, output,
                                           &activation_min, &activation_max);
+  if (data->tiled) {
+    tflite::PoolParams op_params = GetPoolGeometry(params, data);
+    op_params.quantized_activation_min = activation_min;
+    op_params.quantized_activation_max = activation_max;
+    TiledEval<kMax, uint8_t>(context, node, op_params, data, input, output);
+    return;
+  }
 #define TF_LITE_MAX_POOL(type)                                         \
   tflite::PoolParams op_params;                                        \
   op_params.stride_height = params->stride_height;                     \
@@ -290,6 +441,13 @@ void MaxEvalQuantizedInt8(TfLiteContext* context, TfLiteNode* node,
   int32_t activation_max;
   (void)CalculateActivationRangeQuantized(context, params->activation, output,
                                           &activation_min, &activation_max);
+  if (data->tiled) {
+    tflite::PoolParams op_params = GetPoolGeometry(params, data);
+    op_params.quantized_activation_min = activation_min;
+    op_params.quantized_activation_max = activation_max;
+    TiledEval<kMax, int8_t>(context, node, op_params, data, input, output);
+    return;
+  }
 #define TF_LITE_MAX_POOL(type)                                        \
   tflite::PoolParams op_params;                                       \
   op_params.stride_height = params->stride_height;                    \
@@ -458,44 +616,66 @@ TfLiteStatus L2Eval(TfLiteContext* context, TfLiteNode* node) {
 }  // namespace pooling
 
 TfLiteRegistration* Register_AVERAGE_POOL_REF() {
-  static TfLiteRegistration r = {pooling::Init, pooling::Free,
-                                 pooling::GenericPrepare<pooling::kAverage>,
-                                 pooling::AverageEval<pooling::kReference>};
+  static TfLiteRegistration r = {
+      pooling::Init, pooling::Free,
+      pooling::GenericPrepare<pooling::kReference, pooling::kAverage>,
+      pooling::AverageEval<pooling::kReference>};
   return &r;
 }
 
 TfLiteRegistration* Register_MAX_POOL_REF() {
-  static TfLiteRegistration r = {pooling::Init, pooling::Free,
-                                 pooling::GenericPrepare<pooling::kMax>,
-                                 pooling::MaxEval<pooling::kReference>};
+  static TfLiteRegistration r = {
+      pooling::Init, pooling::Free,
+      pooling::GenericPrepare<pooling::kReference, pooling::kMax>,
+      pooling::MaxEval<pooling::kReference>};
   return &r;
 }
 
 TfLiteRegistration* Register_L2_POOL_REF() {
-  static TfLiteRegistration r = {pooling::Init, pooling::Free,
-                                 pooling::GenericPrepare<pooling::kL2>,
-                                 pooling::L2Eval<pooling::kReference>};
+  static TfLiteRegistration r = {
+      pooling::Init, pooling::Free,
+      pooling::GenericPrepare<pooling::kReference, pooling::kL2>,
+      pooling::L2Eval<pooling::kReference>};
   return &r;
 }
 
 TfLiteRegistration* Register_AVERAGE_POOL_GENERIC_OPT() {
   static TfLiteRegistration r = {
-      pooling::Init, pooling::Free, pooling::GenericPrepare<pooling::kAverage>,
+      pooling::Init, pooling::Free,
+      pooling::GenericPrepare<pooling::kGenericOptimized, pooling::kAverage>,
       pooling::AverageEval<pooling::kGenericOptimized>};
   return &r;
 }
 
 TfLiteRegistration* Register_MAX_POOL_GENERIC_OPT() {
-  static TfLiteRegistration r = {pooling::Init, pooling::Free,
-                                 pooling::GenericPrepare<pooling::kMax>,
-                                 pooling::MaxEval<pooling::kGenericOptimized>};
+  static TfLiteRegistration r = {
+      pooling::Init, pooling::Free,
+      pooling::GenericPrepare<pooling::kGenericOptimized, pooling::kMax>,
+      pooling::MaxEval<pooling::kGenericOptimized>};
   return &r;
 }
 
 TfLiteRegistration* Register_L2_POOL_GENERIC_OPT() {
-  static TfLiteRegistration r = {pooling::Init, pooling::Free,
-                                 pooling::GenericPrepare<pooling::kL2>,
-                                 pooling::L2Eval<pooling::kGenericOptimized>};
+  static TfLiteRegistration r = {
+      pooling::Init, pooling::Free,
+      pooling::GenericPrepare<pooling::kGenericOptimized, pooling::kL2>,
+      pooling::L2Eval<pooling::kGenericOptimized>};
+  return &r;
+}
+
+TfLiteRegistration* Register_AVERAGE_POOL_TILED() {
+  static TfLiteRegistration r = {
+      pooling::Init, pooling::Free,
+      pooling::GenericPrepare<pooling::kTiled, pooling::kAverage>,
+      pooling::AverageEval<pooling::kTiled>};
+  return &r;
+}
+
+TfLiteRegistration* Register_MAX_POOL_TILED() {
+  static TfLiteRegistration r = {
+      pooling::Init, pooling::Free,
+      pooling::GenericPrepare<pooling::kTiled, pooling::kMax>,
+      pooling::MaxEval<pooling::kTiled>};
   return &r;
 }
 
@@ -19,11 +19,22 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/memory/memory.h"
 #include "flatbuffers/flatbuffers.h"  // from @flatbuffers
 #include "tensorflow/lite/kernels/test_util.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
 namespace tflite {
+
+namespace ops {
+namespace builtin {
+
+TfLiteRegistration* Register_AVERAGE_POOL_TILED();
+TfLiteRegistration* Register_MAX_POOL_TILED();
+
+}  // namespace builtin
+}  // namespace ops
+
 namespace {
 
 using ::testing::ElementsAreArray;
@@ -34,7 +45,8 @@ class BasePoolingOpModel : public SingleOpModel {
       BuiltinOperator type, const TensorData& input, int filter_width,
       int filter_height, const TensorData& output,
       Padding padding = Padding_VALID, int stride_w = 2, int stride_h = 2,
-      ActivationFunctionType activation = ActivationFunctionType_NONE) {
+      ActivationFunctionType activation = ActivationFunctionType_NONE,
+      TfLiteRegistration* registration = nullptr) {
     input_ = AddInput(input);
     output_ = AddOutput(output);
 
@@ -42,6 +54,9 @@ class BasePoolingOpModel : public SingleOpModel {
                  CreatePool2DOptions(builder_, padding, stride_w, stride_h,
                                      filter_width, filter_height, activation)
                      .Union());
+    if (registration) {
+      resolver_ = absl::make_unique<SingleOpResolver>(type, registration);
+    }
 
     BuildInterpreter({GetShape(input_)});
   }
@@ -150,6 +165,19 @@ TEST(FloatPoolingOpTest, AveragePool) {
   EXPECT_THAT(m.GetOutput(), ElementsAreArray({2.75, 5.75}));
 }
 
+TEST(FloatPoolingOpTest, GlobalAveragePool) {
+  FloatPoolingOpModel m(BuiltinOperator_AVERAGE_POOL_2D,
+                        /*input=*/{TensorType_FLOAT32, {1, 2, 4, 2}},
+                        /*filter_width=*/4, /*filter_height=*/2,
+                        /*output=*/{TensorType_FLOAT32, {}});
+  m.SetInput({
+      0, 1, 6, 2, 2, 3, 4, 4,    //
+      3, 5, 2, 6, 10, 7, 7, 12,  //
+  });
+  m.Invoke();
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({4.25, 5.0}));
+}
+
 TEST(FloatPoolingOpTest, AveragePoolActivationRelu) {
   FloatPoolingOpModel m(BuiltinOperator_AVERAGE_POOL_2D,
                         /*input=*/{TensorType_FLOAT32, {1, 2, 4, 1}},
@@ -904,6 +932,69 @@ TEST(QuantizedInt8PoolingOpTest, MaxPool) {
   EXPECT_THAT(m.GetOutput(), ElementsAreArray({96 - 128, 160 - 128}));
 }
 
+TEST(QuantizedInt8PoolingOpTest, AveragePoolTiledRequantize) {
+  // Input Range[0, 15.9375] --> [Scale{0.0625}, zero_point{-128}]
+  // Output Range[-8, 7.9375] --> [Scale{0.0625}, zero_point{0}]
+  SymmetricQuantizedPoolingOpModel m(
+      BuiltinOperator_AVERAGE_POOL_2D,
+      /*input=*/{TensorType_INT8, {1, 2, 4, 1}, 0, 15.9375},
+      /*filter_width=*/2, /*filter_height=*/2,
+      /*output=*/{TensorType_INT8, {}, -8, 7.9375}, Padding_VALID, 2, 2,
+      ActivationFunctionType_NONE,
+      ops::builtin::Register_AVERAGE_POOL_TILED());
+  m.SetInput({
+      0, 6, 2, 4,   //
+      3, 2, 10, 7,  //
+  });
+  m.Invoke();
+
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear({2.75, 5.75})));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({44, 92}));
+}
+
+TEST(QuantizedInt8PoolingOpTest, MaxPoolTiledRequantizeRelu6) {
+  // Input Range[-15.9375, 15.8130] --> [Scale{0.124512}, zero_point{0}]
+  // Output Range[0, 31.875] --> [Scale{0.125}, zero_point{-128}]
+  SymmetricQuantizedPoolingOpModel m(
+      BuiltinOperator_MAX_POOL_2D,
+      /*input=*/{TensorType_INT8, {1, 2, 4, 1}, -15.9375, 15.8130},
+      /*filter_width=*/2, /*filter_height=*/2,
+      /*output=*/{TensorType_INT8, {}, 0, 31.875}, Padding_VALID, 2, 2,
+      ActivationFunctionType_RELU6, ops::builtin::Register_MAX_POOL_TILED());
+  m.SetInput({
+      0, -6, 2, 4,   //
+      -3, -2, 10, 7,  //
+  });
+  m.Invoke();
+
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear({0, 6}, 0.125)));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({-128, 48 - 128}));
+}
+
+TEST(QuantizedUInt8PoolingOpTest, AveragePoolTiledMatchesDefault) {
+  const std::vector<float> input = ReplicateDepthRamp(
+      {0, 6, 2, 4, 3, 2, 10, 7, 1, 5, 9, 8, 4, 3, 2, 1}, 300, 0.01);
+  const TensorData input_tensor = {TensorType_UINT8, {1, 4, 4, 300}, 0,
+                                   15.9375};
+  const TensorData output_tensor = {TensorType_UINT8, {}, 0, 15.9375};
+  QuantizedPoolingOpModel m(BuiltinOperator_AVERAGE_POOL_2D, input_tensor,
+                            /*filter_width=*/3, /*filter_height=*/3,
+                            output_tensor, Padding_SAME, 1, 1);
+  QuantizedPoolingOpModel tiled(
+      BuiltinOperator_AVERAGE_POOL_2D, input_tensor, /*filter_width=*/3,
+      /*filter_height=*/3, output_tensor, Padding_SAME, 1, 1,
+      ActivationFunctionType_NONE,
+      ops::builtin::Register_AVERAGE_POOL_TILED());
+  m.SetInput(input);
+  tiled.SetInput(input);
+  m.Invoke();
+  tiled.Invoke();
+
+  EXPECT_THAT(tiled.GetOutput(), ElementsAreArray(m.GetOutput()));
+}
+
 TEST(QuantizedInt8PoolingOpTest16, MaxPool) {
   // Choose the input ranges carefully so that the dequantized output matches
   // the results of the float model above.
@@ -13,17 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
-#include <math.h>
 #include <stddef.h>
 #include <stdint.h>
-#include <string.h>
 
 #include <algorithm>
 #include <complex>
 
-#include "third_party/fft2d/fft2d.h"
 #include "ruy/profiler/instrumentation.h"  // from @ruy
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/mixed_radix_fft.h"
 #include "tensorflow/lite/kernels/internal/tensor.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/internal/types.h"
@@ -39,71 +37,52 @@ using std::complex;
 constexpr int kInputTensor = 0;
 constexpr int kFftLengthTensor = 1;
 constexpr int kOutputTensor = 0;
-constexpr int kFftIntegerWorkingAreaTensor = 0;
-constexpr int kFftDoubleWorkingAreaTensor = 1;
+constexpr int kFftWorkingAreaTensor = 0;
 constexpr int kTensorNotAllocated = -1;
 
 struct OpData {
   // IDs are the arbitrary identifiers used by TF Lite to identify and access
   // memory buffers.
-  int fft_integer_working_area_id = kTensorNotAllocated;
-  int fft_double_working_area_id = kTensorNotAllocated;
+  int fft_working_area_id = kTensorNotAllocated;
+  // Plans of the fft_length the output was last resized for, so that their
+  // twiddles are only computed again when fft_length changes. Rows are real
+  // FFTs of fft_width points, columns complex FFTs of fft_height points.
+  internal::RealFft<float> row_fft;
+  internal::MixedRadixFft<float> column_fft;
 };
 
-bool IsPowerOfTwo(uint32_t v) { return v && !(v & (v - 1)); }
-
 static TfLiteStatus InitTemporaryTensors(TfLiteContext* context,
                                          TfLiteNode* node) {
   OpData* data = reinterpret_cast<OpData*>(node->user_data);
   // The prepare function may be executed multiple times. But temporary tensors
   // only need to be initiated once.
-  if (data->fft_integer_working_area_id != kTensorNotAllocated &&
-      data->fft_double_working_area_id != kTensorNotAllocated) {
+  if (data->fft_working_area_id != kTensorNotAllocated) {
     return kTfLiteOk;
   }
 
   TfLiteIntArrayFree(node->temporaries);
-  // Create two temporary tensors.
-  node->temporaries = TfLiteIntArrayCreate(2);
+  node->temporaries = TfLiteIntArrayCreate(1);
   int first_new_index;
-  TF_LITE_ENSURE_STATUS(context->AddTensors(context, 2, &first_new_index));
-  node->temporaries->data[kFftIntegerWorkingAreaTensor] = first_new_index;
-  data->fft_integer_working_area_id = first_new_index;
-  node->temporaries->data[kFftDoubleWorkingAreaTensor] = first_new_index + 1;
-  data->fft_double_working_area_id = first_new_index + 1;
-
-  // Set up FFT integer working area buffer.
-  TfLiteTensor* fft_integer_working_area;
-  TF_LITE_ENSURE_OK(
-      context, GetTemporarySafe(context, node, kFftIntegerWorkingAreaTensor,
-                                &fft_integer_working_area));
-  fft_integer_working_area->type = kTfLiteInt32;
-  // If fft_length is not a constant tensor, fft_integer_working_area will be
-  // set to dynamic later in Prepare.
-  fft_integer_working_area->allocation_type = kTfLiteArenaRw;
-
-  // Set up FFT double working area buffer.
-  TfLiteTensor* fft_double_working_area;
-  TF_LITE_ENSURE_OK(context,
-                    GetTemporarySafe(context, node, kFftDoubleWorkingAreaTensor,
-                                     &fft_double_working_area));
-  // fft_double_working_area is a double tensor. Ideally, double should be
-  // added into tflite data types. However, since fft_double_working_area is a
-  // temporary tensor, and there are no ops having double input/output tensors
-  // in tflite at this point, adding double as a tflite data type may confuse
-  // users that double is supported. As a results, kTfLiteInt64 is used here
-  // for memory allocation. And it will be cast into double in Eval when being
-  // used.
-  fft_double_working_area->type = kTfLiteInt64;
-  // If fft_length is not a constant tensor, fft_double_working_area will be
-  // set to dynamic later in Prepare.
-  fft_double_working_area->allocation_type = kTfLiteArenaRw;
+  TF_LITE_ENSURE_STATUS(context->AddTensors(context, 1, &first_new_index));
+  node->temporaries->data[kFftWorkingAreaTensor] = first_new_index;
+  data->fft_working_area_id = first_new_index;
+
+  // Set up FFT working area buffer, which holds complex values.
+  TfLiteTensor* fft_working_area;
+  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
+                                              kFftWorkingAreaTensor,
+                                              &fft_working_area));
+  fft_working_area->type = kTfLiteComplex64;
+  // If fft_length is not a constant tensor, fft_working_area will be set to
+  // dynamic later in Prepare.
+  fft_working_area->allocation_type = kTfLiteArenaRw;
 
   return kTfLiteOk;
 }
 
 TfLiteStatus ResizeOutputandTemporaryTensors(TfLiteContext* context,
                                              TfLiteNode* node) {
+  OpData* data = reinterpret_cast<OpData*>(node->user_data);
   const TfLiteTensor* input;
   TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kInputTensor, &input));
   const int num_dims = NumDimensions(input);
@@ -112,15 +91,20 @@ TfLiteStatus ResizeOutputandTemporaryTensors(TfLiteContext* context,
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kFftLengthTensor, &fft_length));
   const int32_t* fft_length_data = GetTensorData<int32_t>(fft_length);
-  // The lib, fft2d, can only handle fft_lengths of power of 2.
-  TF_LITE_ENSURE(context, IsPowerOfTwo(fft_length_data[0]));
-  TF_LITE_ENSURE(context, IsPowerOfTwo(fft_length_data[1]));
+  // Any positive length is supported, but lengths with large prime factors
+  // are slower.
+  TF_LITE_ENSURE(context, fft_length_data[0] > 0);
+  TF_LITE_ENSURE(context, fft_length_data[1] > 0);
 
   int fft_height, fft_width;
   fft_height = fft_length_data[0];
   fft_width = fft_length_data[1];
-  int fft_working_length = std::max(fft_height, fft_width / 2);
-  int half_fft_working_length = fft_working_length / 2;
+  if (data->row_fft.size() != fft_width) {
+    TF_LITE_ENSURE(context, data->row_fft.Initialize(fft_width));
+  }
+  if (data->column_fft.size() != fft_height) {
+    TF_LITE_ENSURE(context, data->column_fft.Initialize(fft_height));
+  }
 
   // Resize output tensor.
   TfLiteTensor* output;
@@ -131,27 +115,17 @@ TfLiteStatus ResizeOutputandTemporaryTensors(TfLiteContext* context,
   output_shape->data[num_dims - 1] = fft_length_data[1] / 2 + 1;
   TF_LITE_ENSURE_STATUS(context->ResizeTensor(context, output, output_shape));
 
-  // Resize temporary tensors, fft_integer_working_area.
-  TfLiteTensor* fft_integer_working_area;
-  TF_LITE_ENSURE_OK(
-      context, GetTemporarySafe(context, node, kFftIntegerWorkingAreaTensor,
-                                &fft_integer_working_area));
-  TfLiteIntArray* fft_integer_working_area_shape = TfLiteIntArrayCreate(1);
-  fft_integer_working_area_shape->data[0] =
-      2 + static_cast<int>(sqrt(fft_working_length));
-  TF_LITE_ENSURE_STATUS(context->ResizeTensor(context, fft_integer_working_area,
-                                              fft_integer_working_area_shape));
-
-  // Resize temporary tensors, fft_double_working_area.
-  TfLiteTensor* fft_double_working_area;
-  TF_LITE_ENSURE_OK(context,
-                    GetTemporarySafe(context, node, kFftDoubleWorkingAreaTensor,
-                                     &fft_double_working_area));
-  TfLiteIntArray* fft_double_working_area_shape = TfLiteIntArrayCreate(1);
-  fft_double_working_area_shape->data[0] =
-      half_fft_working_length + fft_width / 4;
-  TF_LITE_ENSURE_STATUS(context->ResizeTensor(context, fft_double_working_area,
-                                              fft_double_working_area_shape));
+  // Resize temporary tensor, fft_working_area. The column FFTs of a slice all
+  // run at once, so they need a working value per output value.
+  TfLiteTensor* fft_working_area;
+  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
+                                              kFftWorkingAreaTensor,
+                                              &fft_working_area));
+  TfLiteIntArray* fft_working_area_shape = TfLiteIntArrayCreate(1);
+  fft_working_area_shape->data[0] = std::max(
+      data->row_fft.work_size(), fft_height * data->row_fft.output_size());
+  TF_LITE_ENSURE_STATUS(context->ResizeTensor(context, fft_working_area,
+                                              fft_working_area_shape));
 
   return kTfLiteOk;
 }
@@ -208,16 +182,11 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   // temporary tensors to dynamic, so that their tensor sizes can be determined
   // in Eval.
   if (!IsConstantTensor(fft_length)) {
-    TfLiteTensor* fft_integer_working_area;
-    TF_LITE_ENSURE_OK(
-        context, GetTemporarySafe(context, node, kFftIntegerWorkingAreaTensor,
-                                  &fft_integer_working_area));
-    TfLiteTensor* fft_double_working_area;
-    TF_LITE_ENSURE_OK(
-        context, GetTemporarySafe(context, node, kFftDoubleWorkingAreaTensor,
-                                  &fft_double_working_area));
-    SetTensorToDynamic(fft_integer_working_area);
-    SetTensorToDynamic(fft_double_working_area);
+    TfLiteTensor* fft_working_area;
+    TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
+                                                kFftWorkingAreaTensor,
+                                                &fft_working_area));
+    SetTensorToDynamic(fft_working_area);
     SetTensorToDynamic(output);
     return kTfLiteOk;
   }
@@ -226,143 +195,37 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   return kTfLiteOk;
 }
 
-// Reorder the result so that it matches the pattern of tf.signal.rfft2d.
-// In tf.signal.fft2d the frequency matrix of a 4x4 input is
-//    [[F(0, 0),  F(0, 1/4),   F(0, 2/4)],
-//    [F(1/4, 0), F(1/4, 1/4), F(1/4, 2/4)],
-//    [F(2/4, 0), F(2/4, 1/4), F(2/4, 2/4)],
-//    [F(3/4, 0), F(3/4, 1/4), F(3/4, 2/4)]]
-// While in rdft2d, the frequency matrix of a 4x4 input is
-//    [[(F(0, 0), F(0, -2/4))       F(0, -1/4),   0],
-//     [ F(-1/4, 0),                F(-1/4, -1/4), 0],
-//     [(F(-2/4, 0),F(-2/4, -2/4)), F(-2/4, -1/4), 0],
-//     [ j*F(-3/4, -2/4),           F(-3/4, -1/4), 0]]
-// Since real fft has the property that
-//   Real(u,v) = Real(-u, -v)
-//   Img(u,v) = - Img(-u, -v)
-// Result of rdft2d can be reordered and match the pattern of tf.signal.rfft2d.
-// For example,
-//   Real(-3/4, 0) = Real(1/4, 0) = Real(-1/4, 0)
-//   Img(-3/4, 0) = Img(1/4, 0) = -Img(-1/4, 0)
-void Rfft2dReorder(int fft_height, int fft_width, double** fft_input_output) {
-  int fft_height_half;
-  ruy::profiler::ScopeLabel label("Rfft2dReorder");
-  double real, img;
-
-  fft_height_half = fft_height >> 1;
-  // Use 4x4 input as an example, reorder the frequency matrix from
-  //    [[(F(0, 0), F(0, -2/4))       F(0, -1/4),   0],
-  //     [ F(-1/4, 0),                F(-1/4, -1/4), 0],
-  //     [(F(-2/4, 0),F(-2/4, -2/4)), F(-2/4, -1/4), 0],
-  //     [ j*F(-3/4, -2/4),           F(-3/4, -1/4), 0]]
-  // to
-  //    [[F(0, 0),  F(0, -1/4),   F(0, -2/4)],
-  //    [F(-1/4, 0), F(-1/4, -1/4), F(-1/4, -2/4)],
-  //    [F(-2/4, 0), F(-2/4, -1/4), F(-2/4, -2/4)],
-  //    [F(-3/4, 0), F(-3/4, -1/4), F(-3/4, -2/4)]]
-  for (int i = fft_height_half + 1; i < fft_height; ++i) {
-    real = fft_input_output[i][0];
-    img = fft_input_output[i][1];
-    fft_input_output[i][fft_width] = img;
-    fft_input_output[i][fft_width + 1] = real;
-    fft_input_output[fft_height - i][fft_width] = img;
-    fft_input_output[fft_height - i][fft_width + 1] = -real;
-    fft_input_output[i][0] = fft_input_output[fft_height - i][0];
-    fft_input_output[i][1] = -fft_input_output[fft_height - i][1];
-  }
-
-  double temp = fft_input_output[0][1];
-  fft_input_output[0][fft_width + 1] = 0;
-  fft_input_output[0][1] = 0;
-  fft_input_output[fft_height_half][fft_width] =
-      fft_input_output[fft_height_half][1];
-  fft_input_output[fft_height_half][fft_width + 1] = 0;
-  fft_input_output[fft_height_half][1] = 0;
-  fft_input_output[0][fft_width] = temp;
-
-  // Reorder the frequency matrix from
-  //    [[F(0, 0),  F(0, -1/4),   F(0, -2/4)],
-  //    [F(-1/4, 0), F(-1/4, -1/4), F(-1/4, -2/4)],
-  //    [F(-2/4, 0), F(-2/4, -1/4), F(-2/4, -2/4)],
-  //    [F(-3/4, 0), F(-3/4, -1/4), F(-3/4, -2/4)]]
-  // to
-  //    [[F(0, 0),  F(0, 1/4),   F(0, 2/4)],
-  //    [F(1/4, 0), F(1/4, 1/4), F(1/4, 2/4)],
-  //    [F(2/4, 0), F(2/4, 1/4), F(2/4, 2/4)],
-  //    [F(3/4, 0), F(3/4, 1/4), F(3/4, 2/4)]]
-  for (int i = 0; i < fft_height; ++i) {
-    for (int j = 1; j < fft_width + 2; j += 2) {
-      fft_input_output[i][j] = -fft_input_output[i][j];
-    }
-  }
-}
-
-void Rfft2dImpl(int fft_height, int fft_width, double** fft_input_output,
-                int* fft_integer_working_area_data,
-                double* fft_double_working_area_data) {
+// Computes the FFT of every row, then of every column of the
+// fft_height x (fft_width / 2 + 1) result, which is laid out as
+// fft_width / 2 + 1 interleaved columns.
+void Rfft2dImpl(const OpData* data, const float* input_data, int input_height,
+                int input_width, complex<float>* output_data,
+                complex<float>* fft_working_area_data) {
   ruy::profiler::ScopeLabel label("Rfft2dImpl");
-
-  // Working data areas for the FFT routines.
-  double* fft_dynamic_working_area = nullptr;
-  const int kForwardFft = 1;
-  rdft2d(fft_height, fft_width, kForwardFft, fft_input_output,
-         fft_dynamic_working_area, fft_integer_working_area_data,
-         fft_double_working_area_data);
-  Rfft2dReorder(fft_height, fft_width, fft_input_output);
-}
-
-void PrepareInputBuffer(const float* input_data, int input_height,
-                        int input_width, int fft_height, int fft_width,
-                        double** fft_input_output) {
-  int valid_input_height = std::min(input_height, fft_height);
-  int valid_input_width = std::min(input_width, fft_width);
+  const int fft_height = data->column_fft.size();
+  const int output_width = data->row_fft.output_size();
+  const int valid_input_height = std::min(input_height, fft_height);
   for (int i = 0; i < valid_input_height; ++i) {
-    int in_pos = i * input_width;
-    for (int j = 0; j < valid_input_width; ++j) {
-      fft_input_output[i][j] = input_data[in_pos++];
-    }
-    // Zero-pad the rest of the input buffer
-    for (int j = valid_input_width; j < fft_width + 2; ++j) {
-      fft_input_output[i][j] = 0;
-    }
-  }
-
-  // Zero-pad input buffer, if fft_height is greater than valid_input_height.
-  for (int i = valid_input_height; i < fft_height; ++i) {
-    for (int j = 0; j < fft_width + 2; ++j) {
-      fft_input_output[i][j] = 0;
-    }
-  }
-}
-
-void PrepareOutputBuffer(complex<float>* output_data, int fft_height,
-                         int fft_width, double** fft_input_output) {
-  int cnt = 0;
-  for (int i = 0; i < fft_height; ++i) {
-    for (int j = 0; j < fft_width / 2 + 1; ++j) {
-      output_data[cnt++] = complex<float>(fft_input_output[i][j * 2],
-                                          fft_input_output[i][j * 2 + 1]);
-    }
+    data->row_fft.Forward(input_data + i * input_width, input_width,
+                          output_data + i * output_width,
+                          fft_working_area_data);
   }
+  // Zero-pad the rows, if fft_height is greater than valid_input_height.
+  std::fill(output_data + valid_input_height * output_width,
+            output_data + fft_height * output_width, complex<float>(0, 0));
+  data->column_fft.Forward(output_data, fft_working_area_data, output_width);
 }
 
 TfLiteStatus Rfft2dHelper(TfLiteContext* context, TfLiteNode* node) {
+  const OpData* data = reinterpret_cast<OpData*>(node->user_data);
   const TfLiteTensor* input;
   TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kInputTensor, &input));
   const float* input_data = GetTensorData<float>(input);
-  const TfLiteTensor* fft_length;
-  TF_LITE_ENSURE_OK(context,
-                    GetInputSafe(context, node, kFftLengthTensor, &fft_length));
-  const int32_t* fft_length_data = GetTensorData<int32_t>(fft_length);
   TfLiteTensor* output;
   TF_LITE_ENSURE_OK(context,
                     GetOutputSafe(context, node, kOutputTensor, &output));
   complex<float>* output_data = GetTensorData<complex<float>>(output);
 
-  int fft_height, fft_width;
-  fft_height = fft_length_data[0];
-  fft_width = fft_length_data[1];
-
   // FFT is processed for every slice on the inner most 2 dimensions.
   // Count the number of slices in the input tensor.
   const RuntimeShape input_shape = GetTensorShape(input);
@@ -376,50 +239,25 @@ TfLiteStatus Rfft2dHelper(TfLiteContext* context, TfLiteNode* node) {
   int input_height = input_dims_data[input_dims_count - 2];
   int input_width = input_dims_data[input_dims_count - 1];
   int input_slice_size = input_height * input_width;
-  int output_slice_size = fft_height * (fft_width / 2 + 1);
-
-  // Create input/output buffer for FFT
-  double** fft_input_output = new double*[fft_height];
-  for (int i = 0; i < fft_height; ++i) {
-    fft_input_output[i] = new double[fft_width + 2];
-  }
+  int output_slice_size =
+      data->column_fft.size() * data->row_fft.output_size();
 
-  // Get buffer for integer working area.
-  TfLiteTensor* fft_integer_working_area;
-  TF_LITE_ENSURE_OK(
-      context, GetTemporarySafe(context, node, kFftIntegerWorkingAreaTensor,
-                                &fft_integer_working_area));
-  int* fft_integer_working_area_data =
-      GetTensorData<int>(fft_integer_working_area);
-
-  // Get buffer for double working area.
-  TfLiteTensor* fft_double_working_area;
-  TF_LITE_ENSURE_OK(context,
-                    GetTemporarySafe(context, node, kFftDoubleWorkingAreaTensor,
-                                     &fft_double_working_area));
-  // Get double value out of the memory of fft_double_working_area_data.
-  double* fft_double_working_area_data = reinterpret_cast<double*>(
-      GetTensorData<int64_t>(fft_double_working_area));
+  // Get buffer for working area.
+  TfLiteTensor* fft_working_area;
+  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
+                                              kFftWorkingAreaTensor,
+                                              &fft_working_area));
+  complex<float>* fft_working_area_data =
+      GetTensorData<complex<float>>(fft_working_area);
 
   // Process every slice in the input buffer
   for (int i = 0; i < num_slices; ++i) {
-    PrepareInputBuffer(input_data, input_height, input_width, fft_height,
-                       fft_width, fft_input_output);
-    memset(fft_integer_working_area_data, 0, fft_integer_working_area->bytes);
-    memset(fft_double_working_area_data, 0, fft_double_working_area->bytes);
-    Rfft2dImpl(fft_height, fft_width, fft_input_output,
-               fft_integer_working_area_data, fft_double_working_area_data);
-    PrepareOutputBuffer(output_data, fft_height, fft_width, fft_input_output);
+    Rfft2dImpl(data, input_data, input_height, input_width, output_data,
+               fft_working_area_data);
     input_data += input_slice_size;
     output_data += output_slice_size;
   }
 
-  // Delete the input buffer
-  for (int i = 0; i < fft_height; ++i) {
-    delete[] fft_input_output[i];
-  }
-  delete[] fft_input_output;
-
   return kTfLiteOk;
 }
 
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <math.h>
 #include <stdint.h>
 
 #include <complex>
@@ -58,6 +59,48 @@ class Rfft2dOpModel : public SingleOpModel {
   int output_;
 };
 
+// The FFT runs in float, so results that are not exact small integers can be
+// off by a few ulps.
+void ExpectComplexNear(const std::vector<complex<float>>& actual,
+                       const std::vector<complex<float>>& expected,
+                       float tolerance) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (int i = 0; i < actual.size(); ++i) {
+    EXPECT_NEAR(actual[i].real(), expected[i].real(), tolerance) << i;
+    EXPECT_NEAR(actual[i].imag(), expected[i].imag(), tolerance) << i;
+  }
+}
+
+// Computes the rfft2d of every height x width slice of `input` directly from
+// the definition of the DFT.
+std::vector<complex<float>> NaiveRfft2d(const std::vector<float>& input,
+                                        int height, int width, int fft_height,
+                                        int fft_width) {
+  const int num_slices = input.size() / (height * width);
+  const int output_width = fft_width / 2 + 1;
+  std::vector<complex<float>> output;
+  for (int s = 0; s < num_slices; ++s) {
+    const float* slice = input.data() + s * height * width;
+    for (int u = 0; u < fft_height; ++u) {
+      for (int v = 0; v < output_width; ++v) {
+        complex<double> sum = 0;
+        for (int i = 0; i < std::min(height, fft_height); ++i) {
+          for (int j = 0; j < std::min(width, fft_width); ++j) {
+            const double angle =
+                -2.0 * M_PI *
+                (static_cast<double>(u * i % fft_height) / fft_height +
+                 static_cast<double>(v * j % fft_width) / fft_width);
+            sum += static_cast<double>(slice[i * width + j]) *
+                   complex<double>(cos(angle), sin(angle));
+          }
+        }
+        output.push_back(complex<float>(sum));
+      }
+    }
+  }
+  return output;
+}
+
 TEST(Rfft2dOpTest, FftLengthMatchesInputSize) {
   Rfft2dOpModel model({TensorType_FLOAT32, {4, 4}}, {TensorType_INT32, {2}});
   // clang-format off
@@ -116,7 +159,10 @@ TEST(Rfft2dOpTest, FftLengthGreaterThanInputSize) {
     {-10, 20}, {11.1923885, 11.9497471}, {5, -5}, {-3.63603902, -3.12132025},
     {-6, -2}};
   // clang-format on
-  EXPECT_THAT(model.GetOutput(), ElementsAreArray(expected_result));
+  ExpectComplexNear(model.GetOutput(),
+                    std::vector<complex<float>>(std::begin(expected_result),
+                                                std::end(expected_result)),
+                    1e-5);
 }
 
 TEST(Rfft2dOpTest, InputDimsGreaterThan2) {
@@ -141,6 +187,39 @@ TEST(Rfft2dOpTest, InputDimsGreaterThan2) {
   EXPECT_THAT(model.GetOutput(), ElementsAreArray(expected_result));
 }
 
+TEST(Rfft2dOpTest, OddFftLengths) {
+  Rfft2dOpModel model({TensorType_FLOAT32, {4, 6}}, {TensorType_INT32, {2}});
+  std::vector<float> input;
+  for (int i = 0; i < 24; ++i) {
+    input.push_back((i * 7) % 11 - 5);
+  }
+  model.PopulateTensor<float>(model.input(), input);
+  // Pads the height and crops the width.
+  model.PopulateTensor<int32_t>(model.fft_lengths(), {5, 3});
+  model.Invoke();
+
+  EXPECT_THAT(model.GetOutputShape(), ElementsAreArray({5, 2}));
+  ExpectComplexNear(model.GetOutput(), NaiveRfft2d(input, 4, 6, 5, 3), 1e-4);
+}
+
+TEST(Rfft2dOpTest, NonPowerOfTwoFftLengths) {
+  Rfft2dOpModel model({TensorType_FLOAT32, {2, 12, 15}},
+                      {TensorType_INT32, {2}});
+  std::vector<float> input;
+  for (int i = 0; i < 2 * 12 * 15; ++i) {
+    input.push_back(sin(i * 0.37f) + (i % 5) * 0.25f);
+  }
+  model.PopulateTensor<float>(model.input(), input);
+  // Rows run a packed FFT of 7 points, which has no dedicated radix, and
+  // columns radix 2, 3 and 5 stages.
+  model.PopulateTensor<int32_t>(model.fft_lengths(), {30, 14});
+  model.Invoke();
+
+  EXPECT_THAT(model.GetOutputShape(), ElementsAreArray({2, 30, 8}));
+  ExpectComplexNear(model.GetOutput(), NaiveRfft2d(input, 12, 15, 30, 14),
+                    1e-4);
+}
+
 }  // namespace
 }  // namespace builtin
 }  // namespace ops
@@ -113,8 +113,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   // Generate n-grams recursively.
   tflite::DynamicBuffer buf;
   if (words.size() < params->ngram_size) {
-    buf.WriteToTensorAsVector(GetOutput(context, node, 0));
-    return kTfLiteOk;
+    return buf.WriteToTensorAsVector(GetOutput(context, node, 0));
   }
 
   // Stack stores the index of word used to generate ngram.
@@ -151,8 +150,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     }
   }
 
-  buf.WriteToTensorAsVector(GetOutput(context, node, 0));
-  return kTfLiteOk;
+  return buf.WriteToTensorAsVector(GetOutput(context, node, 0));
 }
 }  // namespace
 
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
 #include "tensorflow/lite/interpreter.h"
 #include "tensorflow/lite/kernels/acceleration_test_util.h"
+#include "tensorflow/lite/kernels/internal/packed_int4.h"
 #include "tensorflow/lite/kernels/register.h"
 #include "tensorflow/lite/kernels/test_delegate_providers.h"
 #include "tensorflow/lite/model.h"
@@ -120,6 +121,35 @@ int SingleOpModel::AddIntermediate(TensorType type,
   return id;
 }
 
+int SingleOpModel::AddConstInt4Input(const TensorData& t,
+                                     const std::vector<int8_t>& values) {
+  int id = tensors_.size();
+  const std::vector<float> scale = t.per_channel_quantization
+                                       ? t.per_channel_quantization_scales
+                                       : std::vector<float>{t.scale};
+  flatbuffers::Offset<QuantizationParameters> q_params =
+      CreateQuantizationParameters(
+          builder_, /*min=*/0, /*max=*/0, builder_.CreateVector<float>(scale),
+          builder_.CreateVector<int64_t>(std::vector<int64_t>(scale.size())),
+          QuantizationDetails_NONE, 0, /*quantized_dimension=*/0);
+
+  if (buffers_.empty()) {
+    buffers_.push_back(CreateBuffer(builder_, builder_.CreateVector({})));
+  }
+  std::vector<uint8_t> packed((values.size() + 1) / 2);
+  internal::PackInt4(values.data(), values.size(), packed.data());
+  const int buffer_id = buffers_.size();
+  buffers_.push_back(CreateBuffer(builder_, builder_.CreateVector(packed)));
+
+  tensors_.push_back(CreateTensor(builder_, builder_.CreateVector<int>(t.shape),
+                                  TensorType_INT4, /*buffer=*/buffer_id,
+                                  /*name=*/0, q_params,
+                                  /*is_variable=*/false));
+  inputs_.push_back(id);
+  tensor_data_[id] = t;
+  return id;
+}
+
 int SingleOpModel::AddNullInput() {
   int id = kTfLiteOptionalTensor;
   inputs_.push_back(id);
@@ -213,6 +213,12 @@ class SingleOpModel {
     return AddConstInput(TensorData{type, shape}, data);
   }
 
+  // Adds a constant TensorType_INT4 input holding `values`, which must be in
+  // [-8, 7], packed two to a byte. Its zero points are all 0, and its scale is
+  // either t.scale or, if t.per_channel_quantization is set, one scale per
+  // slice of the first dimension.
+  int AddConstInt4Input(const TensorData& t, const std::vector<int8_t>& values);
+
   // TODO(b/166202747): Use a better way to do type specialization. Reduce
   // duplicate code in the two functions below.
   int AddConstSparseInput(const TensorData& t,
@@ -270,7 +270,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     case kTfLiteString: {
       DynamicBuffer buffer;
       TileString(*(input->dims), input, multipliers, &buffer, output);
-      buffer.WriteToTensor(output, /*new_shape=*/nullptr);
+      TF_LITE_ENSURE_OK(context,
+                        buffer.WriteToTensor(output, /*new_shape=*/nullptr));
       break;
     }
     case kTfLiteBool:
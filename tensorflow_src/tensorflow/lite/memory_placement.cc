@@ -0,0 +1,312 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/memory_placement.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <vector>
+
+namespace tflite {
+namespace {
+
+constexpr size_t kDefaultHugePageSize = 2 * 1024 * 1024;
+// Alignment of the data when huge pages are not used.
+constexpr size_t kPageAlignment = 4096;
+
+size_t RoundUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+#if defined(__linux__)
+
+// From <linux/mempolicy.h>, which is not always installed.
+constexpr int kMpolBind = 2;
+
+// Binds [address, address + size) to `node`. Must be called before the pages
+// are touched, as the policy only applies to pages allocated afterwards.
+bool BindToNumaNode(void* address, size_t size, int node) {
+#if defined(SYS_mbind)
+  constexpr int kBitsPerWord = 8 * sizeof(unsigned long);  // NOLINT
+  std::vector<unsigned long> mask(node / kBitsPerWord + 1, 0);  // NOLINT
+  mask[node / kBitsPerWord] = 1UL << (node % kBitsPerWord);
+  return syscall(SYS_mbind, address, size, kMpolBind, mask.data(),
+                 mask.size() * kBitsPerWord + 1, 0) == 0;
+#else
+  return false;
+#endif
+}
+
+// Per-mapping statistics parsed from /proc/self/smaps and numa_maps.
+struct MappingStats {
+  uintptr_t start = 0;
+  uintptr_t end = 0;
+  size_t resident_bytes = 0;
+  size_t huge_page_bytes = 0;
+  std::vector<size_t> numa_node_bytes;
+};
+
+// Adds `count` scaled by overlap / mapping size to `total`.
+void AddProrated(size_t count, size_t overlap, size_t mapping_size,
+                 size_t* total) {
+  if (mapping_size == 0) return;
+  *total += static_cast<size_t>(static_cast<double>(count) * overlap /
+                                mapping_size);
+}
+
+bool ReadSmaps(uintptr_t begin, uintptr_t end,
+               std::vector<MappingStats>* mappings) {
+  FILE* file = fopen("/proc/self/smaps", "r");
+  if (file == nullptr) return false;
+  char line[512];
+  MappingStats* current = nullptr;
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    unsigned long start, stop;  // NOLINT
+    if (sscanf(line, "%lx-%lx ", &start, &stop) == 2) {
+      current = nullptr;
+      if (start < end && stop > begin) {
+        mappings->emplace_back();
+        current = &mappings->back();
+        current->start = start;
+        current->end = stop;
+      }
+      continue;
+    }
+    if (current == nullptr) continue;
+    char key[64];
+    unsigned long kb;  // NOLINT
+    if (sscanf(line, "%63[^:]: %lu kB", key, &kb) != 2) continue;
+    const size_t bytes = kb * 1024;
+    const bool hugetlb = !strcmp(key, "Private_Hugetlb") ||
+                         !strcmp(key, "Shared_Hugetlb");
+    if (!strcmp(key, "Rss") || hugetlb) current->resident_bytes += bytes;
+    if (!strcmp(key, "AnonHugePages") || !strcmp(key, "ShmemPmdMapped") ||
+        !strcmp(key, "FilePmdMapped") || hugetlb) {
+      current->huge_page_bytes += bytes;
+    }
+  }
+  fclose(file);
+  return true;
+}
+
+// Fills MappingStats::numa_node_bytes from /proc/self/numa_maps, whose lines
+// look like "7f0000000000 bind:0 anon=512 dirty=512 N0=512
+// kernelpagesize_kB=4".
+void ReadNumaMaps(std::vector<MappingStats>* mappings) {
+  FILE* file = fopen("/proc/self/numa_maps", "r");
+  if (file == nullptr) return;
+  // Lines can be long for file mappings with long paths.
+  std::vector<char> line(4096);
+  while (fgets(line.data(), line.size(), file) != nullptr) {
+    unsigned long start;  // NOLINT
+    if (sscanf(line.data(), "%lx ", &start) != 1) continue;
+    auto mapping = std::find_if(
+        mappings->begin(), mappings->end(),
+        [start](const MappingStats& m) { return m.start == start; });
+    if (mapping == mappings->end()) continue;
+
+    size_t page_size = kPageAlignment;
+    std::vector<std::pair<int, size_t>> node_pages;
+    char* save = nullptr;
+    for (char* token = strtok_r(line.data(), " \n", &save); token != nullptr;
+         token = strtok_r(nullptr, " \n", &save)) {
+      int node;
+      unsigned long count;  // NOLINT
+      if (sscanf(token, "N%d=%lu", &node, &count) == 2) {
+        node_pages.emplace_back(node, count);
+      } else if (sscanf(token, "kernelpagesize_kB=%lu", &count) == 1) {
+        page_size = count * 1024;
+      }
+    }
+    for (const auto& entry : node_pages) {
+      if (entry.first < 0) continue;
+      const size_t node = entry.first;
+      if (mapping->numa_node_bytes.size() <= node) {
+        mapping->numa_node_bytes.resize(node + 1, 0);
+      }
+      mapping->numa_node_bytes[node] += entry.second * page_size;
+    }
+  }
+  fclose(file);
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace
+
+int CurrentNumaNode() {
+#if defined(__linux__) && defined(SYS_getcpu)
+  unsigned cpu, node;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+    return static_cast<int>(node);
+  }
+#endif
+  return kNoNumaNode;
+}
+
+size_t HugePageSize() {
+  static const size_t huge_page_size = []() {
+    size_t size = kDefaultHugePageSize;
+#if defined(__linux__)
+    FILE* file = fopen("/proc/meminfo", "r");
+    if (file == nullptr) return size;
+    char line[256];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+      unsigned long kb;  // NOLINT
+      if (sscanf(line, "Hugepagesize: %lu kB", &kb) == 1 && kb > 0) {
+        size = kb * 1024;
+        break;
+      }
+    }
+    fclose(file);
+#endif
+    return size;
+  }();
+  return huge_page_size;
+}
+
+bool GetPageStats(const void* address, size_t size, PageStats* stats) {
+  *stats = PageStats();
+#if defined(__linux__)
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(address);
+  const uintptr_t end = begin + size;
+  std::vector<MappingStats> mappings;
+  if (!ReadSmaps(begin, end, &mappings)) return false;
+  ReadNumaMaps(&mappings);
+  for (const MappingStats& mapping : mappings) {
+    const size_t mapping_size = mapping.end - mapping.start;
+    const size_t overlap =
+        std::min(end, mapping.end) - std::max(begin, mapping.start);
+    stats->mapped_bytes += overlap;
+    AddProrated(mapping.resident_bytes, overlap, mapping_size,
+                &stats->resident_bytes);
+    AddProrated(mapping.huge_page_bytes, overlap, mapping_size,
+                &stats->huge_page_bytes);
+    if (stats->numa_node_bytes.size() < mapping.numa_node_bytes.size()) {
+      stats->numa_node_bytes.resize(mapping.numa_node_bytes.size(), 0);
+    }
+    for (size_t node = 0; node < mapping.numa_node_bytes.size(); ++node) {
+      AddProrated(mapping.numa_node_bytes[node], overlap, mapping_size,
+                  &stats->numa_node_bytes[node]);
+    }
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+PlacedMemory::PlacedMemory(size_t size, const MemoryPlacement& placement,
+                           ErrorReporter* error_reporter)
+    : size_(size) {
+  if (size == 0) size = 1;
+#if defined(__linux__)
+  const size_t huge_page_size = HugePageSize();
+  HugePageMode huge_pages = placement.huge_pages;
+  // Bytes from data_ the NUMA policy applies to. These are whole huge pages
+  // with huge pages: mbind() fails on part of a hugetlb mapping, and would
+  // split the mapping advised for transparent huge pages.
+  size_t data_size = 0;
+  if (huge_pages == HugePageMode::kExplicit) {
+    mapping_size_ = RoundUp(size, huge_page_size);
+    mapping_ = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mapping_ == MAP_FAILED) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "No explicit huge pages for %zu bytes, falling "
+                           "back to transparent huge pages.",
+                           size);
+      huge_pages = HugePageMode::kTransparent;
+    } else {
+      data_ = mapping_;
+      data_size = mapping_size_;
+    }
+  }
+  if (data_ == nullptr) {
+    // Over-allocate so that the data can start on a huge page boundary; only
+    // whole, aligned huge pages can be backed by transparent huge pages.
+    const size_t alignment = huge_pages == HugePageMode::kTransparent
+                                 ? huge_page_size
+                                 : kPageAlignment;
+    data_size = RoundUp(size, alignment);
+    mapping_size_ = data_size + alignment - kPageAlignment;
+    mapping_ = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping_ == MAP_FAILED) {
+      TF_LITE_REPORT_ERROR(error_reporter, "Failed to map %zu bytes.", size);
+      mapping_ = nullptr;
+      mapping_size_ = 0;
+      return;
+    }
+    const uintptr_t start = reinterpret_cast<uintptr_t>(mapping_);
+    data_ = reinterpret_cast<void*>(RoundUp(start, alignment));
+    if (huge_pages == HugePageMode::kTransparent &&
+        madvise(data_, data_size, MADV_HUGEPAGE) != 0) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Transparent huge pages are not available.");
+      huge_pages = HugePageMode::kNone;
+    }
+  }
+  huge_pages_ = huge_pages;
+
+  const int node = placement.numa_node == kCurrentNumaNode
+                       ? CurrentNumaNode()
+                       : placement.numa_node;
+  if (node >= 0) {
+    if (BindToNumaNode(data_, data_size, node)) {
+      numa_node_ = node;
+    } else {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Failed to bind memory to NUMA node %d.", node);
+    }
+  }
+#else
+  if (placement.huge_pages != HugePageMode::kNone ||
+      placement.numa_node != kNoNumaNode) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Memory placement is not supported on this platform.");
+  }
+  mapping_size_ = RoundUp(size, kPageAlignment) + kPageAlignment;
+  mapping_ = calloc(mapping_size_, 1);
+  if (mapping_ == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Failed to allocate %zu bytes.",
+                         size);
+    mapping_size_ = 0;
+    return;
+  }
+  data_ = reinterpret_cast<void*>(
+      RoundUp(reinterpret_cast<uintptr_t>(mapping_), kPageAlignment));
+#endif
+}
+
+PlacedMemory::~PlacedMemory() {
+  if (mapping_ == nullptr) return;
+#if defined(__linux__)
+  munmap(mapping_, mapping_size_);
+#else
+  free(mapping_);
+#endif
+}
+
+}  // namespace tflite
@@ -0,0 +1,116 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+/// \file
+/// Placement of large buffers, such as model weights and tensor arenas, in
+/// huge pages and on a given NUMA node. Only supported on Linux; elsewhere
+/// memory is mapped with the defaults and no statistics are available.
+#ifndef TENSORFLOW_LITE_MEMORY_PLACEMENT_H_
+#define TENSORFLOW_LITE_MEMORY_PLACEMENT_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/stderr_reporter.h"
+
+namespace tflite {
+
+enum class HugePageMode {
+  // Default pages.
+  kNone,
+  // Transparent huge pages: the mapping is aligned to the huge page size and
+  // advised with MADV_HUGEPAGE.
+  kTransparent,
+  // Explicit huge pages from the hugetlbfs pool (MAP_HUGETLB), falling back
+  // to transparent huge pages if the pool is exhausted or not configured.
+  kExplicit,
+};
+
+// Values of MemoryPlacement::numa_node other than node numbers.
+constexpr int kNoNumaNode = -1;
+// The node of the CPU running the thread that maps the memory, e.g. an
+// interpreter's worker thread allocating its tensors.
+constexpr int kCurrentNumaNode = -2;
+
+struct MemoryPlacement {
+  HugePageMode huge_pages = HugePageMode::kNone;
+  // Node to bind the memory to, kNoNumaNode to leave it to the kernel's
+  // default policy.
+  int numa_node = kNoNumaNode;
+};
+
+// Page statistics of a memory range, see GetPageStats().
+struct PageStats {
+  // Bytes of the mappings covering the range.
+  size_t mapped_bytes = 0;
+  // Bytes backed by physical memory.
+  size_t resident_bytes = 0;
+  // Bytes backed by huge pages, transparent or explicit.
+  size_t huge_page_bytes = 0;
+  // Resident bytes on each NUMA node, indexed by node. Empty if the kernel
+  // does not report NUMA placement.
+  std::vector<size_t> numa_node_bytes;
+};
+
+// Returns the NUMA node of the CPU the calling thread runs on, or kNoNumaNode
+// if unknown.
+int CurrentNumaNode();
+
+// Returns the size of explicit huge pages, typically 2 MiB on x86.
+size_t HugePageSize();
+
+// Fills `stats` for the mappings of this process overlapping
+// [address, address + size), from /proc/self/smaps and /proc/self/numa_maps.
+// Mappings partially overlapping the range are counted in proportion to the
+// overlap. Returns false if the statistics are unavailable.
+bool GetPageStats(const void* address, size_t size, PageStats* stats);
+
+// Anonymous, private, zero-initialized memory mapped with a MemoryPlacement.
+// The NUMA policy is set before the memory is first touched, so pages are
+// allocated on the requested node. Failures to place the memory as requested
+// are reported as warnings and leave the memory with default placement; only
+// failing to map it at all makes it invalid.
+class PlacedMemory {
+ public:
+  PlacedMemory(size_t size, const MemoryPlacement& placement,
+               ErrorReporter* error_reporter = DefaultErrorReporter());
+  ~PlacedMemory();
+
+  PlacedMemory(const PlacedMemory&) = delete;
+  PlacedMemory& operator=(const PlacedMemory&) = delete;
+
+  void* data() const { return data_; }
+  // Requested size; the mapping may be rounded up to whole huge pages.
+  size_t size() const { return size_; }
+  bool valid() const { return data_ != nullptr; }
+
+  // Placement actually obtained.
+  HugePageMode huge_pages() const { return huge_pages_; }
+  int numa_node() const { return numa_node_; }
+
+ private:
+  void* data_ = nullptr;
+  size_t size_ = 0;
+  // Start and length of the whole mapping.
+  void* mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+  HugePageMode huge_pages_ = HugePageMode::kNone;
+  int numa_node_ = kNoNumaNode;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MEMORY_PLACEMENT_H_
@@ -0,0 +1,129 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/memory_placement.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <numeric>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+constexpr size_t kSize = 4 * 1024 * 1024;
+
+TEST(PlacedMemoryTest, AllModesGiveWritableZeroedMemory) {
+  for (HugePageMode mode : {HugePageMode::kNone, HugePageMode::kTransparent,
+                            HugePageMode::kExplicit}) {
+    MemoryPlacement placement;
+    placement.huge_pages = mode;
+    PlacedMemory memory(kSize, placement);
+    ASSERT_TRUE(memory.valid());
+    EXPECT_EQ(memory.size(), kSize);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(memory.data()) % 4096, 0);
+
+    char* data = static_cast<char*>(memory.data());
+    EXPECT_EQ(data[0], 0);
+    EXPECT_EQ(data[kSize - 1], 0);
+    memset(data, 0x5a, kSize);
+    EXPECT_EQ(data[kSize / 2], 0x5a);
+  }
+}
+
+TEST(PlacedMemoryTest, HugePagesAreAligned) {
+  for (HugePageMode mode :
+       {HugePageMode::kTransparent, HugePageMode::kExplicit}) {
+    MemoryPlacement placement;
+    placement.huge_pages = mode;
+    PlacedMemory memory(kSize, placement);
+    ASSERT_TRUE(memory.valid());
+    // Explicit huge pages fall back to transparent ones without a hugetlbfs
+    // pool, and those to default pages if disabled.
+    if (memory.huge_pages() == HugePageMode::kNone) continue;
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(memory.data()) % HugePageSize(), 0);
+  }
+}
+
+TEST(PageStatsTest, CountsResidentBytes) {
+  PlacedMemory memory(kSize, MemoryPlacement());
+  ASSERT_TRUE(memory.valid());
+  PageStats stats;
+  // No statistics on this platform.
+  if (!GetPageStats(memory.data(), memory.size(), &stats)) return;
+  EXPECT_EQ(stats.mapped_bytes, kSize);
+  const size_t untouched = stats.resident_bytes;
+
+  memset(memory.data(), 1, kSize);
+  ASSERT_TRUE(GetPageStats(memory.data(), memory.size(), &stats));
+  EXPECT_GT(stats.resident_bytes, untouched);
+  EXPECT_LE(stats.resident_bytes, kSize);
+  if (!stats.numa_node_bytes.empty()) {
+    EXPECT_GT(std::accumulate(stats.numa_node_bytes.begin(),
+                              stats.numa_node_bytes.end(), size_t{0}),
+              0);
+  }
+}
+
+TEST(PlacedMemoryTest, BindsToCurrentNumaNode) {
+  const int node = CurrentNumaNode();
+  EXPECT_GE(node, kNoNumaNode);
+  MemoryPlacement placement;
+  placement.numa_node = kCurrentNumaNode;
+  PlacedMemory memory(kSize, placement);
+  ASSERT_TRUE(memory.valid());
+  memset(memory.data(), 1, kSize);
+  // Binding may be refused, e.g. in containers without CAP_SYS_NICE on some
+  // kernels, in which case the memory keeps the default policy.
+  if (memory.numa_node() == kNoNumaNode) return;
+
+  EXPECT_GE(memory.numa_node(), 0);
+  PageStats stats;
+  if (GetPageStats(memory.data(), memory.size(), &stats) &&
+      stats.numa_node_bytes.size() > memory.numa_node()) {
+    EXPECT_EQ(stats.numa_node_bytes[memory.numa_node()], stats.resident_bytes);
+  }
+}
+
+TEST(PlacedMemoryTest, BindsHugePagesOfAnySize) {
+  // Not a whole number of pages, let alone huge pages.
+  constexpr size_t kOddSize = 3 * 1024 * 1024 + 123;
+  MemoryPlacement placement;
+  placement.numa_node = kCurrentNumaNode;
+  PlacedMemory probe(kOddSize, placement);
+  ASSERT_TRUE(probe.valid());
+  // Binding is refused altogether on this system.
+  if (probe.numa_node() == kNoNumaNode) return;
+
+  for (HugePageMode mode :
+       {HugePageMode::kTransparent, HugePageMode::kExplicit}) {
+    placement.huge_pages = mode;
+    PlacedMemory memory(kOddSize, placement);
+    ASSERT_TRUE(memory.valid());
+    EXPECT_EQ(memory.numa_node(), probe.numa_node());
+    memset(memory.data(), 1, kOddSize);
+  }
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
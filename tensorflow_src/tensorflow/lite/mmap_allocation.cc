@@ -13,12 +13,16 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <errno.h>
 #include <fcntl.h>
 #include <stddef.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <memory>
+#include <utility>
+
 #include "tensorflow/lite/allocation.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
 
@@ -26,21 +30,31 @@ namespace tflite {
 
 MMAPAllocation::MMAPAllocation(const char* filename,
                                ErrorReporter* error_reporter)
-    : MMAPAllocation(error_reporter, open(filename, O_RDONLY)) {
+    : MMAPAllocation(filename, MMapOptions(), error_reporter) {}
+
+MMAPAllocation::MMAPAllocation(const char* filename,
+                               const MMapOptions& options,
+                               ErrorReporter* error_reporter)
+    : MMAPAllocation(error_reporter, open(filename, O_RDONLY), options) {
   if (mmap_fd_ == -1) {
     TF_LITE_REPORT_ERROR(error_reporter, "Could not open '%s'.", filename);
   }
 }
 
 MMAPAllocation::MMAPAllocation(int fd, ErrorReporter* error_reporter)
-    : MMAPAllocation(error_reporter, dup(fd)) {
+    : MMAPAllocation(fd, MMapOptions(), error_reporter) {}
+
+MMAPAllocation::MMAPAllocation(int fd, const MMapOptions& options,
+                               ErrorReporter* error_reporter)
+    : MMAPAllocation(error_reporter, dup(fd), options) {
   if (mmap_fd_ == -1) {
     TF_LITE_REPORT_ERROR(error_reporter, "Failed to dup '%d' file descriptor.",
                          fd);
   }
 }
 
-MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd)
+MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
+                               const MMapOptions& options)
     : Allocation(error_reporter, Allocation::Type::kMMap),
       mmap_fd_(owned_fd),
       mmapped_buffer_(MAP_FAILED),
@@ -51,16 +65,48 @@ MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd)
   struct stat sb;
   fstat(mmap_fd_, &sb);
   buffer_size_bytes_ = sb.st_size;
+  if (options.placement.huge_pages != HugePageMode::kNone ||
+      options.placement.numa_node != kNoNumaNode) {
+    if (ReadIntoPlacedMemory(options.placement)) return;
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Failed to read '%d' into placed memory, mapping it "
+                         "instead.",
+                         mmap_fd_);
+  }
+  int flags = MAP_SHARED;
+#if defined(MAP_POPULATE)
+  if (options.populate) flags |= MAP_POPULATE;
+#endif
   mmapped_buffer_ =
-      mmap(nullptr, buffer_size_bytes_, PROT_READ, MAP_SHARED, mmap_fd_, 0);
+      mmap(nullptr, buffer_size_bytes_, PROT_READ, flags, mmap_fd_, 0);
   if (mmapped_buffer_ == MAP_FAILED) {
     TF_LITE_REPORT_ERROR(error_reporter, "Mmap of '%d' failed.", mmap_fd_);
     return;
   }
 }
 
+bool MMAPAllocation::ReadIntoPlacedMemory(const MemoryPlacement& placement) {
+  std::unique_ptr<PlacedMemory> memory(
+      new PlacedMemory(buffer_size_bytes_, placement, error_reporter_));
+  if (!memory->valid()) return false;
+  char* data = static_cast<char*>(memory->data());
+  size_t offset = 0;
+  while (offset < buffer_size_bytes_) {
+    const ssize_t bytes_read =
+        pread(mmap_fd_, data + offset, buffer_size_bytes_ - offset, offset);
+    if (bytes_read < 0 && errno == EINTR) continue;
+    if (bytes_read <= 0) return false;
+    offset += bytes_read;
+  }
+  // The weights are not written to after loading.
+  mprotect(memory->data(), buffer_size_bytes_, PROT_READ);
+  placed_buffer_ = std::move(memory);
+  mmapped_buffer_ = placed_buffer_->data();
+  return true;
+}
+
 MMAPAllocation::~MMAPAllocation() {
-  if (valid()) {
+  if (valid() && placed_buffer_ == nullptr) {
     munmap(const_cast<void*>(mmapped_buffer_), buffer_size_bytes_);
   }
   if (mmap_fd_ != -1) close(mmap_fd_);
@@ -21,18 +21,32 @@ namespace tflite {
 
 MMAPAllocation::MMAPAllocation(const char* filename,
                                ErrorReporter* error_reporter)
-    : MMAPAllocation(error_reporter, -1) {}
+    : MMAPAllocation(error_reporter, -1, MMapOptions()) {}
+
+MMAPAllocation::MMAPAllocation(const char* filename,
+                               const MMapOptions& options,
+                               ErrorReporter* error_reporter)
+    : MMAPAllocation(error_reporter, -1, options) {}
 
 MMAPAllocation::MMAPAllocation(int fd, ErrorReporter* error_reporter)
-    : MMAPAllocation(error_reporter, -1) {}
+    : MMAPAllocation(error_reporter, -1, MMapOptions()) {}
 
-MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd)
+MMAPAllocation::MMAPAllocation(int fd, const MMapOptions& options,
+                               ErrorReporter* error_reporter)
+    : MMAPAllocation(error_reporter, -1, options) {}
+
+MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
+                               const MMapOptions& options)
     : Allocation(error_reporter, Allocation::Type::kMMap),
       mmapped_buffer_(nullptr) {
   // The disabled variant should never be created.
   assert(false);
 }
 
+bool MMAPAllocation::ReadIntoPlacedMemory(const MemoryPlacement& placement) {
+  return false;
+}
+
 MMAPAllocation::~MMAPAllocation() {}
 
 const void* MMAPAllocation::base() const { return nullptr; }
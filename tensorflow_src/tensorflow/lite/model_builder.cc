@@ -44,10 +44,11 @@ ErrorReporter* ValidateErrorReporter(ErrorReporter* e) {
 // Loads a model from `filename`. If `mmap_file` is true then use mmap,
 // otherwise make a copy of the model in a buffer.
 std::unique_ptr<Allocation> GetAllocationFromFile(
-    const char* filename, ErrorReporter* error_reporter) {
+    const char* filename, const MMapOptions& options,
+    ErrorReporter* error_reporter) {
   std::unique_ptr<Allocation> allocation;
   if (MMAPAllocation::IsSupported()) {
-    allocation.reset(new MMAPAllocation(filename, error_reporter));
+    allocation.reset(new MMAPAllocation(filename, options, error_reporter));
   } else {
     allocation.reset(new FileCopyAllocation(filename, error_reporter));
   }
@@ -56,17 +57,31 @@ std::unique_ptr<Allocation> GetAllocationFromFile(
 
 std::unique_ptr<FlatBufferModel> FlatBufferModel::BuildFromFile(
     const char* filename, ErrorReporter* error_reporter) {
+  return BuildFromFile(filename, MMapOptions(), error_reporter);
+}
+
+std::unique_ptr<FlatBufferModel> FlatBufferModel::BuildFromFile(
+    const char* filename, const MMapOptions& options,
+    ErrorReporter* error_reporter) {
   error_reporter = ValidateErrorReporter(error_reporter);
-  return BuildFromAllocation(GetAllocationFromFile(filename, error_reporter),
-                             error_reporter);
+  return BuildFromAllocation(
+      GetAllocationFromFile(filename, options, error_reporter),
+      error_reporter);
 }
 
 std::unique_ptr<FlatBufferModel> FlatBufferModel::VerifyAndBuildFromFile(
     const char* filename, TfLiteVerifier* extra_verifier,
     ErrorReporter* error_reporter) {
+  return VerifyAndBuildFromFile(filename, MMapOptions(), extra_verifier,
+                                error_reporter);
+}
+
+std::unique_ptr<FlatBufferModel> FlatBufferModel::VerifyAndBuildFromFile(
+    const char* filename, const MMapOptions& options,
+    TfLiteVerifier* extra_verifier, ErrorReporter* error_reporter) {
   error_reporter = ValidateErrorReporter(error_reporter);
   return VerifyAndBuildFromAllocation(
-      GetAllocationFromFile(filename, error_reporter), extra_verifier,
+      GetAllocationFromFile(filename, options, error_reporter), extra_verifier,
       error_reporter);
 }
 #endif
@@ -83,6 +83,20 @@ class FlatBufferModel {
       const char* filename, TfLiteVerifier* extra_verifier = nullptr,
       ErrorReporter* error_reporter = DefaultErrorReporter());
 
+  /// Same as BuildFromFile() and VerifyAndBuildFromFile(), with options for
+  /// mapping the file, e.g. to place the model in huge pages or on the NUMA
+  /// node of the threads running it. The placement obtained can be checked
+  /// with GetPageStats() on the allocation. Platforms without mmap ignore the
+  /// options and copy the file to the heap.
+  /// WARNING: Experimental interface, subject to change
+  static std::unique_ptr<FlatBufferModel> BuildFromFile(
+      const char* filename, const MMapOptions& options,
+      ErrorReporter* error_reporter = DefaultErrorReporter());
+  static std::unique_ptr<FlatBufferModel> VerifyAndBuildFromFile(
+      const char* filename, const MMapOptions& options,
+      TfLiteVerifier* extra_verifier = nullptr,
+      ErrorReporter* error_reporter = DefaultErrorReporter());
+
   /// Builds a model based on a pre-loaded flatbuffer.
   /// Caller retains ownership of the buffer and should keep it alive until
   /// the returned object is destroyed. Caller also retains ownership of
@@ -267,6 +267,25 @@ TEST(BasicFlatBufferModel, TestModelInInterpreter) {
   }
 }
 
+TEST(BasicFlatBufferModel, TestModelWithPlacement) {
+  MMapOptions options;
+  options.placement.huge_pages = HugePageMode::kTransparent;
+  options.placement.numa_node = kCurrentNumaNode;
+  auto model = FlatBufferModel::VerifyAndBuildFromFile(
+      "tensorflow/lite/testdata/test_model.bin", options);
+  ASSERT_TRUE(model);
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(
+      InterpreterBuilder(*model, TrivialResolver(&dummy_reg))(&interpreter),
+      kTfLiteOk);
+  ASSERT_NE(interpreter, nullptr);
+  // Read-only tensors point into the placed copy of the file.
+  const char* base = static_cast<const char*>(model->allocation()->base());
+  const char* data = interpreter->tensor(0)->data.raw;
+  EXPECT_GE(data, base);
+  EXPECT_LT(data, base + model->allocation()->bytes());
+}
+
 // Test that loading a model with TensorFlow ops fails when the flex delegate is
 // not linked into the target.
 TEST(FlexModel, FailureWithoutFlexDelegate) {
@@ -57,6 +57,8 @@ const char* TensorTypeName(TfLiteType type) {
       return "kTfLiteUInt8";
     case kTfLiteInt8:
       return "kTfLiteInt8";
+    case kTfLiteInt4:
+      return "kTfLiteInt4";
     case kTfLiteInt64:
       return "kTfLiteInt64";
     case kTfLiteUInt64:
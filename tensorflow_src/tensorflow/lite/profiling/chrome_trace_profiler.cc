@@ -0,0 +1,285 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/chrome_trace_profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "tensorflow/lite/profiling/profile_buffer.h"
+#include "tensorflow/lite/profiling/time.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+// All events belong to a single process.
+constexpr int kProcessId = 1;
+// Tracks of CPU_BACKEND_TASK_EVENTs, one per task index. Thread tracks are
+// numbered from 1.
+constexpr int kTaskTrackBase = 1000;
+
+const char* GetCategory(Profiler::EventType event_type) {
+  switch (event_type) {
+    case Profiler::EventType::DEFAULT:
+      return "default";
+    case Profiler::EventType::OPERATOR_INVOKE_EVENT:
+      return "operator";
+    case Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT:
+      return "delegate_operator";
+    case Profiler::EventType::GENERAL_RUNTIME_INSTRUMENTATION_EVENT:
+      return "runtime_instrumentation";
+    case Profiler::EventType::CPU_BACKEND_TASK_EVENT:
+      return "cpu_backend_task";
+    case Profiler::EventType::OPERATOR_PREPARE_EVENT:
+      return "operator_prepare";
+  }
+  return "unknown";
+}
+
+// Names of the event metadata, as interpreted by SubgraphAwareProfiler and
+// the TFLITE_SCOPED_*_PROFILE macros.
+void GetMetadataNames(Profiler::EventType event_type, const char** name1,
+                      const char** name2) {
+  switch (event_type) {
+    case Profiler::EventType::OPERATOR_INVOKE_EVENT:
+    case Profiler::EventType::OPERATOR_PREPARE_EVENT:
+      *name1 = "node_index";
+      *name2 = "subgraph_index";
+      return;
+    case Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT:
+      *name1 = "delegate_node_index";
+      *name2 = "subgraph_index";
+      return;
+    case Profiler::EventType::CPU_BACKEND_TASK_EVENT:
+      *name1 = "task_index";
+      *name2 = "subgraph_index";
+      return;
+    default:
+      *name1 = "event_metadata1";
+      *name2 = "event_metadata2";
+  }
+}
+
+void WriteJsonString(const char* value, std::ostream* stream) {
+  *stream << '"';
+  for (const char* c = value; *c != '\0'; ++c) {
+    switch (*c) {
+      case '"':
+        *stream << "\\\"";
+        break;
+      case '\\':
+        *stream << "\\\\";
+        break;
+      case '\n':
+        *stream << "\\n";
+        break;
+      case '\t':
+        *stream << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(*c) < 0x20) {
+          char escaped[8];
+          snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+          *stream << escaped;
+        } else {
+          *stream << *c;
+        }
+    }
+  }
+  *stream << '"';
+}
+
+}  // namespace
+
+ChromeTraceProfiler::ChromeTraceProfiler(uint32_t max_num_events)
+    : stream_(nullptr), max_num_events_(std::max(max_num_events, 1u)) {
+  events_.reserve(max_num_events_);
+}
+
+ChromeTraceProfiler::ChromeTraceProfiler(std::ostream* stream)
+    : stream_(stream), max_num_events_(0) {}
+
+ChromeTraceProfiler::~ChromeTraceProfiler() {
+  if (stream_ != nullptr) Finish();
+}
+
+void ChromeTraceProfiler::StartProfiling() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  enabled_ = true;
+}
+
+void ChromeTraceProfiler::StopProfiling() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  enabled_ = false;
+}
+
+uint32_t ChromeTraceProfiler::BeginEvent(const char* tag, EventType event_type,
+                                         int64_t event_metadata1,
+                                         int64_t event_metadata2) {
+  const uint64_t begin_us = time::NowMicros();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!enabled_ || finished_) return kInvalidEventHandle;
+  const Event event = {tag,      event_type, event_metadata1, event_metadata2,
+                       begin_us, begin_us,   GetThreadTrack()};
+  if (!free_open_events_.empty()) {
+    const uint32_t handle = free_open_events_.back();
+    free_open_events_.pop_back();
+    open_events_[handle] = event;
+    return handle;
+  }
+  open_events_.push_back(event);
+  return open_events_.size() - 1;
+}
+
+void ChromeTraceProfiler::EndEvent(uint32_t event_handle) {
+  const uint64_t end_us = time::NowMicros();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (event_handle >= open_events_.size()) return;
+  Event& event = open_events_[event_handle];
+  if (event.tag == nullptr) return;
+  event.end_us = end_us;
+  Record(event);
+  event.tag = nullptr;
+  free_open_events_.push_back(event_handle);
+}
+
+void ChromeTraceProfiler::EndEvent(uint32_t event_handle,
+                                   int64_t event_metadata1,
+                                   int64_t event_metadata2) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (event_handle >= open_events_.size()) return;
+    // Harmless if the event already ended: its entry is ignored once free.
+    open_events_[event_handle].event_metadata1 = event_metadata1;
+    open_events_[event_handle].event_metadata2 = event_metadata2;
+  }
+  EndEvent(event_handle);
+}
+
+void ChromeTraceProfiler::AddEvent(const char* tag, EventType event_type,
+                                   uint64_t start, uint64_t end,
+                                   int64_t event_metadata1,
+                                   int64_t event_metadata2) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!enabled_ || finished_) return;
+  const int track = event_type == EventType::CPU_BACKEND_TASK_EVENT
+                        ? kTaskTrackBase + static_cast<int>(event_metadata1)
+                        : GetThreadTrack();
+  Record({tag, event_type, event_metadata1, event_metadata2, start, end,
+          track});
+}
+
+int ChromeTraceProfiler::GetThreadTrack() {
+  const int next_track = static_cast<int>(thread_tracks_.size()) + 1;
+  return thread_tracks_.insert({std::this_thread::get_id(), next_track})
+      .first->second;
+}
+
+void ChromeTraceProfiler::Record(const Event& event) {
+  if (stream_ == nullptr) {
+    if (events_.size() < max_num_events_) {
+      events_.push_back(event);
+    } else {
+      events_[num_events_ % max_num_events_] = event;
+    }
+    ++num_events_;
+    return;
+  }
+  if (finished_) return;
+  if (named_tracks_.insert(event.track).second) {
+    BeginTraceEntry();
+    WriteTrackName(event.track, stream_);
+  }
+  BeginTraceEntry();
+  WriteEvent(event, stream_);
+}
+
+void ChromeTraceProfiler::BeginTraceEntry() {
+  *stream_ << (first_entry_ ? "[\n" : ",\n");
+  first_entry_ = false;
+}
+
+void ChromeTraceProfiler::WriteTrackName(int track, std::ostream* stream) {
+  const std::string name =
+      track >= kTaskTrackBase
+          ? "CPU backend task " + std::to_string(track - kTaskTrackBase)
+          : "Thread " + std::to_string(track);
+  *stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << kProcessId
+          << ",\"tid\":" << track << ",\"args\":{\"name\":";
+  WriteJsonString(name.c_str(), stream);
+  *stream << "}}";
+}
+
+void ChromeTraceProfiler::WriteEvent(const Event& event,
+                                     std::ostream* stream) {
+  const char* name1;
+  const char* name2;
+  GetMetadataNames(event.event_type, &name1, &name2);
+  const uint64_t duration_us =
+      event.end_us > event.begin_us ? event.end_us - event.begin_us : 0;
+  *stream << "{\"name\":";
+  WriteJsonString(event.tag, stream);
+  *stream << ",\"cat\":\"" << GetCategory(event.event_type)
+          << "\",\"ph\":\"X\",\"pid\":" << kProcessId
+          << ",\"tid\":" << event.track << ",\"ts\":" << event.begin_us
+          << ",\"dur\":" << duration_us << ",\"args\":{\"" << name1
+          << "\":" << event.event_metadata1 << ",\"" << name2
+          << "\":" << event.event_metadata2 << "}}";
+}
+
+void ChromeTraceProfiler::WriteTrace(std::ostream* stream) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stream_ != nullptr) return;
+
+  std::vector<const Event*> events;
+  events.reserve(events_.size());
+  for (const Event& event : events_) events.push_back(&event);
+  std::stable_sort(events.begin(), events.end(),
+                   [](const Event* a, const Event* b) {
+                     return a->begin_us < b->begin_us;
+                   });
+  std::set<int> tracks;
+  for (const Event* event : events) tracks.insert(event->track);
+
+  *stream << "[";
+  const char* separator = "\n";
+  for (int track : tracks) {
+    *stream << separator;
+    WriteTrackName(track, stream);
+    separator = ",\n";
+  }
+  for (const Event* event : events) {
+    *stream << separator;
+    WriteEvent(*event, stream);
+    separator = ",\n";
+  }
+  *stream << "\n]\n";
+}
+
+void ChromeTraceProfiler::Finish() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stream_ == nullptr || finished_) return;
+  finished_ = true;
+  *stream_ << (first_entry_ ? "[" : "") << "\n]\n";
+  stream_->flush();
+}
+
+uint64_t ChromeTraceProfiler::dropped_events() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_events_ - events_.size();
+}
+
+}  // namespace profiling
+}  // namespace tflite
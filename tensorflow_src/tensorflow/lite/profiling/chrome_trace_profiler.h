@@ -0,0 +1,139 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_CHROME_TRACE_PROFILER_H_
+#define TENSORFLOW_LITE_PROFILING_CHROME_TRACE_PROFILER_H_
+
+#include <cstdint>
+#include <map>
+#include <mutex>  // NOLINT(build/c++11)
+#include <ostream>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/api/profiler.h"
+
+namespace tflite {
+namespace profiling {
+
+// Records profile events as a timeline in the Chrome trace event format, which
+// chrome://tracing and https://ui.perfetto.dev open offline.
+//
+// Every event, including runtime instrumentation events, becomes a complete
+// ("X") event on the track of the thread that recorded it, with its metadata
+// as arguments. CPU_BACKEND_TASK_EVENTs are reported by the thread running the
+// operator once its tasks are done, so they get one track per task index
+// instead.
+//
+// The profiler works in one of two modes:
+// - Buffered: the last `max_num_events` events are kept in memory and
+//   written by WriteTrace().
+// - Streaming: every event is written to a stream as soon as it ends, so runs
+//   of any length can be recorded. The trace is terminated by Finish() or by
+//   the destructor; the viewers also open traces cut short by a crash.
+//
+// Like BufferedProfiler, the profiler records nothing until StartProfiling().
+// All methods may be called from any thread. Timestamps come from
+// time::NowMicros(), as for events added through AddEvent().
+class ChromeTraceProfiler : public tflite::Profiler {
+ public:
+  // Creates a buffered profiler.
+  explicit ChromeTraceProfiler(uint32_t max_num_events);
+
+  // Creates a streaming profiler writing to `stream`, which must outlive it.
+  // Writing happens under a lock, on the thread that ends each event.
+  explicit ChromeTraceProfiler(std::ostream* stream);
+
+  ~ChromeTraceProfiler() override;
+
+  uint32_t BeginEvent(const char* tag, EventType event_type,
+                      int64_t event_metadata1,
+                      int64_t event_metadata2) override;
+
+  void EndEvent(uint32_t event_handle) override;
+
+  void EndEvent(uint32_t event_handle, int64_t event_metadata1,
+                int64_t event_metadata2) override;
+
+  // `start` and `end` are in microseconds.
+  void AddEvent(const char* tag, EventType event_type, uint64_t start,
+                uint64_t end, int64_t event_metadata1,
+                int64_t event_metadata2) override;
+
+  void StartProfiling();
+  void StopProfiling();
+
+  // Buffered mode only: writes the recorded events as a complete trace.
+  // Events that have not ended yet are left out.
+  void WriteTrace(std::ostream* stream);
+
+  // Streaming mode only: terminates the trace and flushes the stream. Later
+  // events are ignored.
+  void Finish();
+
+  // Number of events overwritten before WriteTrace(), in buffered mode.
+  uint64_t dropped_events();
+
+ private:
+  struct Event {
+    const char* tag;
+    EventType event_type;
+    int64_t event_metadata1;
+    int64_t event_metadata2;
+    uint64_t begin_us;
+    uint64_t end_us;
+    int track;
+  };
+
+  // Returns the track of the calling thread. Requires `mutex_`.
+  int GetThreadTrack();
+  // Keeps or writes a finished event. Requires `mutex_`.
+  void Record(const Event& event);
+  // Writes the separator preceding the next streamed entry. Requires
+  // `mutex_`.
+  void BeginTraceEntry();
+
+  static void WriteTrackName(int track, std::ostream* stream);
+  static void WriteEvent(const Event& event, std::ostream* stream);
+
+  std::mutex mutex_;
+  bool enabled_ = false;
+
+  // Set in streaming mode.
+  std::ostream* const stream_;
+  bool finished_ = false;
+
+  // Ring of finished events, in buffered mode.
+  const uint32_t max_num_events_;
+  std::vector<Event> events_;
+  uint64_t num_events_ = 0;
+
+  // Events that began and did not end yet; handles index this vector. Free
+  // entries have a null tag.
+  std::vector<Event> open_events_;
+  std::vector<uint32_t> free_open_events_;
+
+  std::map<std::thread::id, int> thread_tracks_;
+  // Streaming mode: tracks whose name was written, and whether nothing was
+  // written yet.
+  std::set<int> named_tracks_;
+  bool first_entry_ = true;
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_CHROME_TRACE_PROFILER_H_
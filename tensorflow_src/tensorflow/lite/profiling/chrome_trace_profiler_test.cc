@@ -0,0 +1,183 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/chrome_trace_profiler.h"
+
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+using EventType = Profiler::EventType;
+
+int CountOccurrences(const std::string& text, const std::string& pattern) {
+  int count = 0;
+  for (size_t pos = text.find(pattern); pos != std::string::npos;
+       pos = text.find(pattern, pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+std::string GetTrace(ChromeTraceProfiler* profiler) {
+  std::stringstream stream;
+  profiler->WriteTrace(&stream);
+  return stream.str();
+}
+
+TEST(ChromeTraceProfilerTest, NothingRecordedUntilStarted) {
+  ChromeTraceProfiler profiler(1024);
+  { ScopedProfile profile(&profiler, "Invoke"); }
+  EXPECT_EQ("[\n]\n", GetTrace(&profiler));
+}
+
+TEST(ChromeTraceProfilerTest, WritesCompleteEvents) {
+  ChromeTraceProfiler profiler(1024);
+  profiler.StartProfiling();
+  {
+    ScopedProfile invoke(&profiler, "Invoke");
+    TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(&profiler, "CONV_2D", 3);
+  }
+  profiler.StopProfiling();
+
+  const std::string trace = GetTrace(&profiler);
+  EXPECT_EQ('[', trace.front());
+  EXPECT_THAT(trace, HasSubstr("\n]\n"));
+  EXPECT_EQ(2, CountOccurrences(trace, "\"ph\":\"X\""));
+  EXPECT_THAT(trace, HasSubstr("{\"name\":\"Invoke\",\"cat\":\"default\""));
+  EXPECT_THAT(trace, HasSubstr("{\"name\":\"CONV_2D\",\"cat\":\"operator\""));
+  EXPECT_THAT(trace,
+              HasSubstr("\"args\":{\"node_index\":3,\"subgraph_index\":0}"));
+  // One thread, named once.
+  EXPECT_EQ(1, CountOccurrences(trace, "\"thread_name\""));
+  EXPECT_THAT(trace, HasSubstr("\"tid\":1,\"args\":{\"name\":\"Thread 1\"}"));
+  // The enclosing event comes first.
+  EXPECT_LT(trace.find("Invoke"), trace.find("CONV_2D"));
+}
+
+TEST(ChromeTraceProfilerTest, RuntimeInstrumentationEvents) {
+  ChromeTraceProfiler profiler(1024);
+  profiler.StartProfiling();
+  {
+    ScopedRuntimeInstrumentationProfile profile(&profiler, "Invoke");
+    profile.set_runtime_status(/*delegate_status=*/5,
+                               /*interpreter_status=*/0);
+  }
+  const std::string trace = GetTrace(&profiler);
+  EXPECT_THAT(trace, HasSubstr("\"cat\":\"runtime_instrumentation\""));
+  EXPECT_THAT(trace, HasSubstr("\"event_metadata1\":5,\"event_metadata2\":0"));
+}
+
+TEST(ChromeTraceProfilerTest, AddedEvents) {
+  ChromeTraceProfiler profiler(1024);
+  profiler.StartProfiling();
+  Profiler* p = &profiler;
+  p->AddEvent("Kernel", EventType::DELEGATE_OPERATOR_INVOKE_EVENT,
+              /*start=*/100, /*end=*/150, /*event_metadata=*/7);
+  const std::string trace = GetTrace(&profiler);
+  EXPECT_THAT(trace, HasSubstr("\"cat\":\"delegate_operator\""));
+  EXPECT_THAT(trace, HasSubstr("\"ts\":100,\"dur\":50"));
+  EXPECT_THAT(trace, HasSubstr("\"delegate_node_index\":7"));
+}
+
+TEST(ChromeTraceProfilerTest, CpuBackendTasksHaveTheirOwnTracks) {
+  ChromeTraceProfiler profiler(1024);
+  profiler.StartProfiling();
+  Profiler* p = &profiler;
+  for (int task = 0; task < 2; ++task) {
+    p->AddEvent("CpuBackendTask", EventType::CPU_BACKEND_TASK_EVENT,
+                /*start=*/10, /*end=*/20, /*event_metadata=*/task);
+  }
+  const std::string trace = GetTrace(&profiler);
+  EXPECT_THAT(trace, HasSubstr("\"tid\":1000,\"args\":{\"name\":"
+                               "\"CPU backend task 0\"}"));
+  EXPECT_THAT(trace, HasSubstr("\"tid\":1001,\"args\":{\"name\":"
+                               "\"CPU backend task 1\"}"));
+  EXPECT_THAT(trace, HasSubstr("\"cat\":\"cpu_backend_task\",\"ph\":\"X\","
+                               "\"pid\":1,\"tid\":1001"));
+  EXPECT_THAT(trace, Not(HasSubstr("\"Thread 1\"")));
+}
+
+TEST(ChromeTraceProfilerTest, ThreadsHaveTheirOwnTracks) {
+  ChromeTraceProfiler profiler(1024);
+  profiler.StartProfiling();
+  { ScopedProfile profile(&profiler, "Main"); }
+  std::thread([&profiler]() { ScopedProfile profile(&profiler, "Worker"); })
+      .join();
+  const std::string trace = GetTrace(&profiler);
+  EXPECT_EQ(2, CountOccurrences(trace, "\"thread_name\""));
+  EXPECT_THAT(trace, HasSubstr("{\"name\":\"Worker\",\"cat\":\"default\","
+                               "\"ph\":\"X\",\"pid\":1,\"tid\":2"));
+}
+
+TEST(ChromeTraceProfilerTest, KeepsTheLastEvents) {
+  ChromeTraceProfiler profiler(2);
+  profiler.StartProfiling();
+  { ScopedProfile profile(&profiler, "First"); }
+  { ScopedProfile profile(&profiler, "Second"); }
+  { ScopedProfile profile(&profiler, "Third"); }
+  EXPECT_EQ(1, profiler.dropped_events());
+  const std::string trace = GetTrace(&profiler);
+  EXPECT_THAT(trace, Not(HasSubstr("First")));
+  EXPECT_THAT(trace, HasSubstr("Second"));
+  EXPECT_THAT(trace, HasSubstr("Third"));
+}
+
+TEST(ChromeTraceProfilerTest, EscapesTags) {
+  ChromeTraceProfiler profiler(1024);
+  profiler.StartProfiling();
+  { ScopedProfile profile(&profiler, "a\"b\\c\n"); }
+  EXPECT_THAT(GetTrace(&profiler), HasSubstr("\"name\":\"a\\\"b\\\\c\\n\""));
+}
+
+TEST(ChromeTraceProfilerTest, Streaming) {
+  std::stringstream stream;
+  {
+    ChromeTraceProfiler profiler(&stream);
+    profiler.StartProfiling();
+    uint32_t handle = profiler.BeginEvent("Invoke", EventType::DEFAULT, 0, 0);
+    // Nothing is written before the event ends.
+    EXPECT_EQ("", stream.str());
+    profiler.EndEvent(handle);
+    EXPECT_THAT(stream.str(), HasSubstr("\"name\":\"Invoke\""));
+    { ScopedProfile profile(&profiler, "AllocateTensors"); }
+    profiler.Finish();
+    { ScopedProfile profile(&profiler, "AfterFinish"); }
+  }
+  const std::string trace = stream.str();
+  EXPECT_EQ(0, trace.find("[\n{\"name\":\"thread_name\""));
+  EXPECT_EQ(1, CountOccurrences(trace, "\"thread_name\""));
+  EXPECT_EQ(2, CountOccurrences(trace, "\"ph\":\"X\""));
+  EXPECT_THAT(trace, Not(HasSubstr("AfterFinish")));
+  EXPECT_EQ(trace.size() - 3, trace.rfind("\n]\n"));
+  EXPECT_EQ(1, CountOccurrences(trace, "]\n"));
+}
+
+TEST(ChromeTraceProfilerTest, StreamingWithoutEvents) {
+  std::stringstream stream;
+  { ChromeTraceProfiler profiler(&stream); }
+  EXPECT_EQ("[\n]\n", stream.str());
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
@@ -18,6 +18,9 @@ limitations under the License.
 #include <malloc.h>
 #include <sys/resource.h>
 #include <sys/time.h>
+#include <unistd.h>
+
+#include <fstream>
 #endif
 
 namespace tflite {
@@ -39,6 +42,8 @@ MemoryUsage GetMemoryUsage() {
   rusage res;
   if (getrusage(RUSAGE_SELF, &res) == 0) {
     result.max_rss_kb = res.ru_maxrss;
+    result.minor_page_faults = res.ru_minflt;
+    result.major_page_faults = res.ru_majflt;
   }
   const auto mem = mallinfo();
   result.total_allocated_bytes = mem.arena;
@@ -47,12 +52,26 @@ MemoryUsage GetMemoryUsage() {
   return result;
 }
 
+int64_t GetCurrentRssKb() {
+#ifdef __linux__
+  // The second field is the number of resident pages.
+  std::ifstream statm("/proc/self/statm");
+  int64_t size_pages, resident_pages;
+  if (statm >> size_pages >> resident_pages) {
+    return resident_pages * (sysconf(_SC_PAGESIZE) / 1024);
+  }
+#endif
+  return MemoryUsage::kValueNotSet;
+}
+
 void MemoryUsage::AllStatsToStream(std::ostream* stream) const {
   *stream << "max resident set size = " << max_rss_kb / 1024.0
           << " MB, total malloc-ed size = "
           << total_allocated_bytes / 1024.0 / 1024.0
           << " MB, in-use allocated/mmapped size = "
-          << in_use_allocated_bytes / 1024.0 / 1024.0 << " MB";
+          << in_use_allocated_bytes / 1024.0 / 1024.0
+          << " MB, page faults = " << minor_page_faults << " minor, "
+          << major_page_faults << " major";
 }
 
 }  // namespace memory
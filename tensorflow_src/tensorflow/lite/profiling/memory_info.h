@@ -32,7 +32,9 @@ struct MemoryUsage {
   MemoryUsage()
       : max_rss_kb(kValueNotSet),
         total_allocated_bytes(kValueNotSet),
-        in_use_allocated_bytes(kValueNotSet) {}
+        in_use_allocated_bytes(kValueNotSet),
+        minor_page_faults(kValueNotSet),
+        major_page_faults(kValueNotSet) {}
 
   // The maximum memory size (in kilobytes) occupied by an OS process that is
   // held in main memory (RAM). Such memory usage information is generally
@@ -47,6 +49,12 @@ struct MemoryUsage {
   // those are freed). This is an alias to mallinfo::uordblks.
   int in_use_allocated_bytes;
 
+  // Number of page faults of the process that were served without, and with,
+  // reading from disk, e.g. when touching a page of a mmapped model for the
+  // first time. These are aliases to rusage::ru_minflt and rusage::ru_majflt.
+  int64_t minor_page_faults;
+  int64_t major_page_faults;
+
   MemoryUsage operator+(MemoryUsage const& obj) const {
     MemoryUsage res;
     res.max_rss_kb = max_rss_kb + obj.max_rss_kb;
@@ -54,6 +62,8 @@ struct MemoryUsage {
         total_allocated_bytes + obj.total_allocated_bytes;
     res.in_use_allocated_bytes =
         in_use_allocated_bytes + obj.in_use_allocated_bytes;
+    res.minor_page_faults = minor_page_faults + obj.minor_page_faults;
+    res.major_page_faults = major_page_faults + obj.major_page_faults;
     return res;
   }
 
@@ -64,6 +74,8 @@ struct MemoryUsage {
         total_allocated_bytes - obj.total_allocated_bytes;
     res.in_use_allocated_bytes =
         in_use_allocated_bytes - obj.in_use_allocated_bytes;
+    res.minor_page_faults = minor_page_faults - obj.minor_page_faults;
+    res.major_page_faults = major_page_faults - obj.major_page_faults;
     return res;
   }
 
@@ -81,6 +93,12 @@ struct MemoryUsage {
 // systems will be added later.
 MemoryUsage GetMemoryUsage();
 
+// Returns the current resident set size of the process in kilobytes, which
+// unlike MemoryUsage::max_rss_kb also goes down, or MemoryUsage::kValueNotSet
+// if unknown. This reads /proc/self/statm on Linux, so it is slower than
+// GetMemoryUsage().
+int64_t GetCurrentRssKb();
+
 }  // namespace memory
 }  // namespace profiling
 }  // namespace tflite
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/profiling/memory_info.h"
 
+#include <memory>
+
 #include <gtest/gtest.h>
 
 namespace tflite {
@@ -25,20 +27,28 @@ TEST(MemoryUsage, AddAndSub) {
   mem1.max_rss_kb = 5;
   mem1.total_allocated_bytes = 7000;
   mem1.in_use_allocated_bytes = 2000;
+  mem1.minor_page_faults = 30;
+  mem1.major_page_faults = 2;
 
   mem2.max_rss_kb = 3;
   mem2.total_allocated_bytes = 7000;
   mem2.in_use_allocated_bytes = 4000;
+  mem2.minor_page_faults = 10;
+  mem2.major_page_faults = 1;
 
   const auto add_mem = mem1 + mem2;
   EXPECT_EQ(8, add_mem.max_rss_kb);
   EXPECT_EQ(14000, add_mem.total_allocated_bytes);
   EXPECT_EQ(6000, add_mem.in_use_allocated_bytes);
+  EXPECT_EQ(40, add_mem.minor_page_faults);
+  EXPECT_EQ(3, add_mem.major_page_faults);
 
   const auto sub_mem = mem1 - mem2;
   EXPECT_EQ(2, sub_mem.max_rss_kb);
   EXPECT_EQ(0, sub_mem.total_allocated_bytes);
   EXPECT_EQ(-2000, sub_mem.in_use_allocated_bytes);
+  EXPECT_EQ(20, sub_mem.minor_page_faults);
+  EXPECT_EQ(1, sub_mem.major_page_faults);
 }
 
 TEST(MemoryUsage, GetMemoryUsage) {
@@ -59,6 +69,24 @@ TEST(MemoryUsage, GetMemoryUsage) {
 #endif
 }
 
+TEST(MemoryUsage, PageFaultsAndCurrentRss) {
+#ifdef __linux__
+  const MemoryUsage before = GetMemoryUsage();
+  const int64_t rss_before_kb = GetCurrentRssKb();
+  EXPECT_GT(rss_before_kb, 0);
+  // Touches pages that were never mapped in.
+  constexpr int kNumBytes = 8 << 20;
+  std::unique_ptr<char[]> buffer(new char[kNumBytes]);
+  for (int i = 0; i < kNumBytes; i += 1024) buffer[i] = i;
+  const MemoryUsage delta = GetMemoryUsage() - before;
+  EXPECT_GT(delta.minor_page_faults, 0);
+  EXPECT_GE(delta.major_page_faults, 0);
+  EXPECT_GT(GetCurrentRssKb(), rss_before_kb);
+#else
+  EXPECT_EQ(MemoryUsage::kValueNotSet, GetCurrentRssKb());
+#endif
+}
+
 TEST(MemoryUsage, IsSupported) {
 #ifdef __linux__
   EXPECT_TRUE(MemoryUsage::IsSupported());
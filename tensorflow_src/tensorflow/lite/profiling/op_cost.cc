@@ -0,0 +1,166 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/op_cost.h"
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+const TfLiteTensor* GetTensor(const TfLiteContext& context,
+                              const TfLiteIntArray* indices, int i) {
+  if (indices == nullptr || i >= indices->size) return nullptr;
+  const int tensor_index = indices->data[i];
+  if (tensor_index < 0 || tensor_index >= context.tensors_size) {
+    return nullptr;
+  }
+  return &context.tensors[tensor_index];
+}
+
+int64_t NumElements(const TfLiteTensor* tensor) {
+  if (tensor == nullptr || tensor->dims == nullptr) return 0;
+  int64_t count = 1;
+  for (int i = 0; i < tensor->dims->size; ++i) {
+    count *= tensor->dims->data[i];
+  }
+  return count;
+}
+
+// Returns dimension `i` of `tensor`, counting from the end if negative, or 0
+// if there is no such dimension.
+int64_t Dim(const TfLiteTensor* tensor, int i) {
+  if (tensor == nullptr || tensor->dims == nullptr) return 0;
+  if (i < 0) i += tensor->dims->size;
+  if (i < 0 || i >= tensor->dims->size) return 0;
+  return tensor->dims->data[i];
+}
+
+// Fills in the operation counts of `cost`.
+void EstimateOps(const TfLiteContext& context, const TfLiteNode& node,
+                 const TfLiteRegistration& registration, OpCost* cost) {
+  const TfLiteTensor* input = GetTensor(context, node.inputs, 0);
+  const TfLiteTensor* output = GetTensor(context, node.outputs, 0);
+  const int64_t num_outputs = NumElements(output);
+  switch (registration.builtin_code) {
+    case BuiltinOperator_CONV_2D: {
+      // Filter: [output_depth, height, width, input_depth / groups].
+      const TfLiteTensor* filter = GetTensor(context, node.inputs, 1);
+      cost->macs = num_outputs * Dim(filter, 1) * Dim(filter, 2) *
+                   Dim(filter, 3);
+      break;
+    }
+    case BuiltinOperator_DEPTHWISE_CONV_2D: {
+      // Filter: [1, height, width, output_depth].
+      const TfLiteTensor* filter = GetTensor(context, node.inputs, 1);
+      cost->macs = num_outputs * Dim(filter, 1) * Dim(filter, 2);
+      break;
+    }
+    case BuiltinOperator_TRANSPOSE_CONV: {
+      // Inputs: output shape, filter [output_depth, height, width,
+      // input_depth] and input. Every input element is scattered over a
+      // filter window of every output channel.
+      const TfLiteTensor* filter = GetTensor(context, node.inputs, 1);
+      cost->macs = NumElements(GetTensor(context, node.inputs, 2)) *
+                   Dim(filter, 0) * Dim(filter, 1) * Dim(filter, 2);
+      break;
+    }
+    case BuiltinOperator_FULLY_CONNECTED: {
+      // Weights: [units, input_depth].
+      const TfLiteTensor* weights = GetTensor(context, node.inputs, 1);
+      cost->macs = num_outputs * Dim(weights, -1);
+      break;
+    }
+    case BuiltinOperator_BATCH_MATMUL: {
+      const auto* params =
+          reinterpret_cast<const TfLiteBatchMatMulParams*>(node.builtin_data);
+      const bool adj_x = params != nullptr && params->adj_x;
+      cost->macs = num_outputs * Dim(input, adj_x ? -2 : -1);
+      break;
+    }
+    case BuiltinOperator_AVERAGE_POOL_2D:
+    case BuiltinOperator_MAX_POOL_2D:
+    case BuiltinOperator_L2_POOL_2D: {
+      const auto* params =
+          reinterpret_cast<const TfLitePoolParams*>(node.builtin_data);
+      if (params != nullptr) {
+        cost->flops =
+            num_outputs * params->filter_width * params->filter_height;
+      }
+      break;
+    }
+    case BuiltinOperator_MEAN:
+    case BuiltinOperator_SUM:
+    case BuiltinOperator_REDUCE_MAX:
+    case BuiltinOperator_REDUCE_MIN:
+    case BuiltinOperator_REDUCE_PROD:
+      cost->flops = NumElements(input);
+      break;
+    case BuiltinOperator_ADD:
+    case BuiltinOperator_SUB:
+    case BuiltinOperator_MUL:
+    case BuiltinOperator_DIV:
+    case BuiltinOperator_SQUARED_DIFFERENCE:
+    case BuiltinOperator_MAXIMUM:
+    case BuiltinOperator_MINIMUM:
+    case BuiltinOperator_PRELU:
+    case BuiltinOperator_RELU:
+    case BuiltinOperator_RELU6:
+    case BuiltinOperator_RELU_N1_TO_1:
+    case BuiltinOperator_LEAKY_RELU:
+    case BuiltinOperator_HARD_SWISH:
+    case BuiltinOperator_LOGISTIC:
+    case BuiltinOperator_TANH:
+    case BuiltinOperator_SOFTMAX:
+    case BuiltinOperator_LOG_SOFTMAX:
+    case BuiltinOperator_QUANTIZE:
+    case BuiltinOperator_DEQUANTIZE:
+      cost->flops = num_outputs;
+      break;
+    default:
+      break;
+  }
+  cost->flops += 2 * cost->macs;
+}
+
+}  // namespace
+
+OpCost EstimateOpCost(const TfLiteContext& context, const TfLiteNode& node,
+                      const TfLiteRegistration& registration) {
+  OpCost cost;
+  if (node.inputs != nullptr) {
+    for (int i = 0; i < node.inputs->size; ++i) {
+      const TfLiteTensor* tensor = GetTensor(context, node.inputs, i);
+      if (tensor == nullptr) continue;
+      if (tensor->allocation_type == kTfLiteMmapRo) {
+        cost.weight_bytes += tensor->bytes;
+      } else {
+        cost.input_bytes += tensor->bytes;
+      }
+    }
+  }
+  if (node.outputs != nullptr) {
+    for (int i = 0; i < node.outputs->size; ++i) {
+      const TfLiteTensor* tensor = GetTensor(context, node.outputs, i);
+      if (tensor != nullptr) cost.output_bytes += tensor->bytes;
+    }
+  }
+  EstimateOps(context, node, registration, &cost);
+  return cost;
+}
+
+}  // namespace profiling
+}  // namespace tflite
@@ -0,0 +1,80 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_OP_COST_H_
+#define TENSORFLOW_LITE_PROFILING_OP_COST_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace profiling {
+
+// Estimated work and memory traffic of one invocation of a node.
+struct OpCost {
+  // Multiply-accumulates of convolutions and matrix multiplications.
+  int64_t macs = 0;
+  // Arithmetic operations, counting a multiply-accumulate as two.
+  int64_t flops = 0;
+  // Bytes read from non-constant inputs.
+  int64_t input_bytes = 0;
+  // Bytes read from constant inputs, i.e. weights and biases.
+  int64_t weight_bytes = 0;
+  // Bytes written to outputs.
+  int64_t output_bytes = 0;
+
+  int64_t total_bytes() const {
+    return input_bytes + weight_bytes + output_bytes;
+  }
+
+  // Operations per byte of memory traffic.
+  double arithmetic_intensity() const {
+    return total_bytes() > 0 ? static_cast<double>(flops) / total_bytes() : 0;
+  }
+};
+
+// Estimated cost and measured time accumulated over invocations.
+struct OpCostStats {
+  int64_t count = 0;
+  int64_t time_us = 0;
+  // Sum of the estimated costs of the invocations.
+  OpCost cost;
+
+  void Add(const OpCost& invocation_cost, int64_t num_invocations,
+           int64_t invocations_time_us) {
+    count += num_invocations;
+    time_us += invocations_time_us;
+    cost.macs += invocation_cost.macs * num_invocations;
+    cost.flops += invocation_cost.flops * num_invocations;
+    cost.input_bytes += invocation_cost.input_bytes * num_invocations;
+    cost.weight_bytes += invocation_cost.weight_bytes * num_invocations;
+    cost.output_bytes += invocation_cost.output_bytes * num_invocations;
+  }
+};
+
+// Estimates the cost of invoking `node` from the current shapes of its
+// tensors, which must have been prepared. Each tensor is assumed to be read or
+// written exactly once, so caches are not taken into account.
+//
+// Operations are counted for convolutions, matrix multiplications, pooling,
+// reductions and element-wise arithmetic; other operators, including custom
+// operators and delegate kernels, only report their memory traffic.
+OpCost EstimateOpCost(const TfLiteContext& context, const TfLiteNode& node,
+                      const TfLiteRegistration& registration);
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_OP_COST_H_
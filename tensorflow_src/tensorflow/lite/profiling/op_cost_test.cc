@@ -0,0 +1,187 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/op_cost.h"
+
+#include <initializer_list>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+// Float tensors and a node using them, without any data.
+class OpCostTest : public ::testing::Test {
+ protected:
+  ~OpCostTest() override {
+    for (TfLiteTensor& tensor : tensors_) TfLiteIntArrayFree(tensor.dims);
+    TfLiteIntArrayFree(node_.inputs);
+    TfLiteIntArrayFree(node_.outputs);
+  }
+
+  int AddTensor(std::initializer_list<int> shape,
+                TfLiteAllocationType allocation_type = kTfLiteArenaRw) {
+    TfLiteTensor tensor = {};
+    tensor.type = kTfLiteFloat32;
+    tensor.allocation_type = allocation_type;
+    tensor.dims = TfLiteIntArrayCreate(shape.size());
+    tensor.bytes = sizeof(float);
+    int i = 0;
+    for (int dim : shape) {
+      tensor.dims->data[i++] = dim;
+      tensor.bytes *= dim;
+    }
+    tensors_.push_back(tensor);
+    return tensors_.size() - 1;
+  }
+
+  int AddWeights(std::initializer_list<int> shape) {
+    return AddTensor(shape, kTfLiteMmapRo);
+  }
+
+  OpCost Estimate(BuiltinOperator op, std::initializer_list<int> inputs,
+                  std::initializer_list<int> outputs,
+                  void* builtin_data = nullptr) {
+    context_.tensors = tensors_.data();
+    context_.tensors_size = tensors_.size();
+    node_.inputs = TfLiteIntArrayCreate(inputs.size());
+    int i = 0;
+    for (int input : inputs) node_.inputs->data[i++] = input;
+    node_.outputs = TfLiteIntArrayCreate(outputs.size());
+    i = 0;
+    for (int output : outputs) node_.outputs->data[i++] = output;
+    node_.builtin_data = builtin_data;
+    registration_.builtin_code = op;
+    return EstimateOpCost(context_, node_, registration_);
+  }
+
+ private:
+  std::vector<TfLiteTensor> tensors_;
+  TfLiteContext context_ = {};
+  TfLiteNode node_ = {};
+  TfLiteRegistration registration_ = {};
+};
+
+TEST_F(OpCostTest, Conv2D) {
+  const int input = AddTensor({1, 8, 8, 3});
+  const int filter = AddWeights({16, 3, 3, 3});
+  const int bias = AddWeights({16});
+  const int output = AddTensor({1, 8, 8, 16});
+  const OpCost cost =
+      Estimate(BuiltinOperator_CONV_2D, {input, filter, bias}, {output});
+  EXPECT_EQ(8 * 8 * 16 * 3 * 3 * 3, cost.macs);
+  EXPECT_EQ(2 * cost.macs, cost.flops);
+  EXPECT_EQ(8 * 8 * 3 * 4, cost.input_bytes);
+  EXPECT_EQ((16 * 3 * 3 * 3 + 16) * 4, cost.weight_bytes);
+  EXPECT_EQ(8 * 8 * 16 * 4, cost.output_bytes);
+  EXPECT_DOUBLE_EQ(static_cast<double>(cost.flops) / cost.total_bytes(),
+                   cost.arithmetic_intensity());
+}
+
+TEST_F(OpCostTest, DepthwiseConv2D) {
+  const int input = AddTensor({1, 8, 8, 16});
+  const int filter = AddWeights({1, 3, 3, 16});
+  const int output = AddTensor({1, 4, 4, 16});
+  const OpCost cost =
+      Estimate(BuiltinOperator_DEPTHWISE_CONV_2D, {input, filter}, {output});
+  EXPECT_EQ(4 * 4 * 16 * 3 * 3, cost.macs);
+}
+
+TEST_F(OpCostTest, TransposeConv) {
+  const int output_shape = AddWeights({4});
+  const int filter = AddWeights({8, 3, 3, 4});
+  const int input = AddTensor({1, 5, 5, 4});
+  const int output = AddTensor({1, 10, 10, 8});
+  const OpCost cost = Estimate(BuiltinOperator_TRANSPOSE_CONV,
+                               {output_shape, filter, input}, {output});
+  EXPECT_EQ(5 * 5 * 4 * 8 * 3 * 3, cost.macs);
+}
+
+TEST_F(OpCostTest, FullyConnectedWithoutBias) {
+  const int input = AddTensor({2, 64});
+  const int weights = AddWeights({10, 64});
+  const int output = AddTensor({2, 10});
+  const OpCost cost =
+      Estimate(BuiltinOperator_FULLY_CONNECTED,
+               {input, weights, kTfLiteOptionalTensor}, {output});
+  EXPECT_EQ(2 * 10 * 64, cost.macs);
+  EXPECT_EQ(10 * 64 * 4, cost.weight_bytes);
+}
+
+TEST_F(OpCostTest, BatchMatMul) {
+  const int lhs = AddTensor({3, 4, 5});
+  const int rhs = AddTensor({3, 5, 6});
+  const int output = AddTensor({3, 4, 6});
+  TfLiteBatchMatMulParams params = {};
+  EXPECT_EQ(3 * 4 * 6 * 5,
+            Estimate(BuiltinOperator_BATCH_MATMUL, {lhs, rhs}, {output},
+                     &params)
+                .macs);
+}
+
+TEST_F(OpCostTest, Pooling) {
+  const int input = AddTensor({1, 8, 8, 4});
+  const int output = AddTensor({1, 4, 4, 4});
+  TfLitePoolParams params = {};
+  params.filter_width = 2;
+  params.filter_height = 2;
+  const OpCost cost =
+      Estimate(BuiltinOperator_MAX_POOL_2D, {input}, {output}, &params);
+  EXPECT_EQ(0, cost.macs);
+  EXPECT_EQ(4 * 4 * 4 * 2 * 2, cost.flops);
+}
+
+TEST_F(OpCostTest, ElementWise) {
+  const int input1 = AddTensor({2, 3});
+  const int input2 = AddTensor({1, 3});
+  const int output = AddTensor({2, 3});
+  const OpCost cost = Estimate(BuiltinOperator_ADD, {input1, input2}, {output});
+  EXPECT_EQ(6, cost.flops);
+  EXPECT_EQ(9 * 4, cost.input_bytes);
+  EXPECT_EQ(6 * 4, cost.output_bytes);
+}
+
+TEST_F(OpCostTest, OtherOperatorsOnlyReportTraffic) {
+  const int input = AddTensor({2, 3});
+  const int output = AddTensor({3, 2});
+  const OpCost cost = Estimate(BuiltinOperator_RESHAPE, {input}, {output});
+  EXPECT_EQ(0, cost.flops);
+  EXPECT_EQ(0, cost.macs);
+  EXPECT_EQ(6 * 4 * 2, cost.total_bytes());
+}
+
+TEST(OpCostStatsTest, Add) {
+  OpCost cost;
+  cost.macs = 10;
+  cost.flops = 20;
+  cost.input_bytes = 4;
+  cost.weight_bytes = 8;
+  cost.output_bytes = 2;
+  OpCostStats stats;
+  stats.Add(cost, /*num_invocations=*/3, /*invocations_time_us=*/30);
+  stats.Add(cost, /*num_invocations=*/1, /*invocations_time_us=*/5);
+  EXPECT_EQ(4, stats.count);
+  EXPECT_EQ(35, stats.time_us);
+  EXPECT_EQ(40, stats.cost.macs);
+  EXPECT_EQ(80, stats.cost.flops);
+  EXPECT_EQ(56, stats.cost.total_bytes());
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
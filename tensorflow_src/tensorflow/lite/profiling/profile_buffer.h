@@ -18,6 +18,7 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <string>
 #include <vector>
 
 #include "tensorflow/lite/core/api/profiler.h"
@@ -58,6 +59,20 @@ struct ProfileEvent {
   int64_t extra_event_metadata;
 };
 
+// Statistics of all the profile events sharing a tag, an event type and event
+// metadata, e.g. every invocation of one operator node.
+struct ProfileEventStats {
+  std::string tag;
+  ProfileEvent::EventType event_type;
+  int64_t event_metadata;
+  int64_t extra_event_metadata;
+  // Number of events, and their total, shortest and longest durations.
+  uint64_t count;
+  uint64_t total_us;
+  uint64_t min_us;
+  uint64_t max_us;
+};
+
 // A ring buffer of profile events.
 // This class is not thread safe.
 class ProfileBuffer {
@@ -86,9 +101,10 @@ class ProfileBuffer {
     event_buffer_[index].extra_event_metadata = event_metadata2;
     event_buffer_[index].begin_timestamp_us = timestamp;
     event_buffer_[index].end_timestamp_us = 0;
-    if (event_type != Profiler::EventType::OPERATOR_INVOKE_EVENT) {
-      event_buffer_[index].begin_mem_usage = memory::GetMemoryUsage();
-    }
+    event_buffer_[index].begin_mem_usage = SamplesMemoryUsage(event_type)
+                                               ? memory::GetMemoryUsage()
+                                               : memory::MemoryUsage();
+    event_buffer_[index].end_mem_usage = memory::MemoryUsage();
     current_index_++;
     return index;
   }
@@ -114,8 +130,7 @@ class ProfileBuffer {
 
     int event_index = event_handle % max_size;
     event_buffer_[event_index].end_timestamp_us = time::NowMicros();
-    if (event_buffer_[event_index].event_type !=
-        Profiler::EventType::OPERATOR_INVOKE_EVENT) {
+    if (SamplesMemoryUsage(event_buffer_[event_index].event_type)) {
       event_buffer_[event_index].end_mem_usage = memory::GetMemoryUsage();
     }
     if (event_metadata1) {
@@ -143,6 +158,8 @@ class ProfileBuffer {
     event_buffer_[index].extra_event_metadata = event_metadata2;
     event_buffer_[index].begin_timestamp_us = start;
     event_buffer_[index].end_timestamp_us = end;
+    event_buffer_[index].begin_mem_usage = memory::MemoryUsage();
+    event_buffer_[index].end_mem_usage = memory::MemoryUsage();
     current_index_++;
   }
 
@@ -174,6 +191,14 @@ class ProfileBuffer {
   }
 
  private:
+  // Memory usage is only sampled around the phases of building and running an
+  // interpreter, e.g. "AllocateTensors". Reading it takes longer than most
+  // operators take to invoke or prepare.
+  static bool SamplesMemoryUsage(ProfileEvent::EventType event_type) {
+    return event_type != Profiler::EventType::OPERATOR_INVOKE_EVENT &&
+           event_type != Profiler::EventType::OPERATOR_PREPARE_EVENT;
+  }
+
   bool enabled_;
   uint32_t current_index_;
   std::vector<ProfileEvent> event_buffer_;
@@ -101,6 +101,29 @@ TEST(ProfileBufferTest, OverFlow) {
   }
 }
 
+TEST(ProfileBufferTest, SamplesMemoryUsageOfPhasesOnly) {
+  if (!memory::MemoryUsage::IsSupported()) return;
+  ProfileBuffer buffer(/*max_size*/ 10, /*enabled*/ true);
+  buffer.EndEvent(buffer.BeginEvent("AllocateTensors",
+                                    ProfileEvent::EventType::DEFAULT, 0, 0));
+  buffer.EndEvent(buffer.BeginEvent(
+      "ADD", ProfileEvent::EventType::OPERATOR_PREPARE_EVENT, 0, 0));
+  buffer.AddEvent("ParseQuantization", ProfileEvent::EventType::DEFAULT,
+                  /*start*/ 1, /*end*/ 2, 0, 0);
+  auto events = GetProfileEvents(buffer);
+  ASSERT_EQ(3, events.size());
+  EXPECT_NE(memory::MemoryUsage::kValueNotSet,
+            events[0]->begin_mem_usage.max_rss_kb);
+  EXPECT_NE(memory::MemoryUsage::kValueNotSet,
+            events[0]->end_mem_usage.max_rss_kb);
+  for (int i = 1; i < 3; ++i) {
+    EXPECT_EQ(memory::MemoryUsage::kValueNotSet,
+              events[i]->begin_mem_usage.max_rss_kb);
+    EXPECT_EQ(memory::MemoryUsage::kValueNotSet,
+              events[i]->end_mem_usage.max_rss_kb);
+  }
+}
+
 TEST(ProfileBufferTest, Enable) {
   ProfileBuffer buffer(/*max_size*/ 10, /*enabled*/ false);
   EXPECT_EQ(0, buffer.Size());
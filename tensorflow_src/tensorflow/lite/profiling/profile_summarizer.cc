@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "tensorflow/lite/profiling/profile_summarizer.h"
 
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <sstream>
+#include <string>
 
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -86,6 +89,59 @@ OperatorDetails GetOperatorDetails(const tflite::Interpreter& interpreter,
   return details;
 }
 
+// Returns the name and type under which the invocations of a node are
+// reported.
+void GetOperatorNodeNameAndType(const tflite::Interpreter& interpreter,
+                                const std::string& tag,
+                                uint32_t subgraph_index, uint32_t node_index,
+                                std::string* node_name_in_stats,
+                                std::string* type_in_stats) {
+  const auto op_details =
+      GetOperatorDetails(interpreter, subgraph_index, node_index);
+  *type_in_stats = tag;
+  if (!op_details.op_description.empty()) {
+    *type_in_stats += "/" + op_details.op_description;
+  }
+
+  const auto node_name = ToString(op_details.outputs);
+  // Append node index to node name because 'stats_calculator' can not
+  // distinguish two nodes w/ the same 'node_name'.
+  *node_name_in_stats = node_name + ":" + std::to_string(node_index);
+}
+
+// Returns the estimated cost of one invocation of a node, from the current
+// shapes of its tensors.
+OpCost GetOperatorCost(const tflite::Interpreter& interpreter,
+                       uint32_t subgraph_index, uint32_t node_index) {
+  auto subgraph =
+      const_cast<tflite::Interpreter&>(interpreter).subgraph(subgraph_index);
+  if (subgraph == nullptr) return OpCost();
+  auto node_reg = subgraph->node_and_registration(node_index);
+  if (node_reg == nullptr) return OpCost();
+  return EstimateOpCost(*subgraph->context(), node_reg->first,
+                        node_reg->second);
+}
+
+std::string GetDelegateNodeName(const std::string& tag,
+                                int64_t event_metadata) {
+  // Append event_metadata to node name because 'stats_calculator' can not
+  // distinguish two nodes w/ the same 'node_name'.
+  return "Delegate/" + tag + ":" + std::to_string(event_metadata);
+}
+
+// Merges aggregated invocations of node `name` into `node_stats`.
+void MergeNodeStats(std::map<std::string, NodeEventStats>* node_stats,
+                    const std::string& name, const std::string& type,
+                    const ProfileEventStats& stats) {
+  auto it = node_stats->find(name);
+  if (it == node_stats->end()) {
+    it = node_stats->emplace(name, NodeEventStats()).first;
+    it->second.type = type;
+    it->second.run_order = node_stats->size() - 1;
+  }
+  it->second.Merge(stats.count, stats.total_us, stats.min_us, stats.max_us);
+}
+
 }  // namespace
 
 ProfileSummarizer::ProfileSummarizer(
@@ -128,6 +184,11 @@ void ProfileSummarizer::ProcessProfiles(
   int64_t delegate_internal_total_us = 0;
 
   for (auto event : events) {
+    // Thread-pool tasks run within an operator invocation, which already
+    // accounts for their time.
+    if (event->event_type == Profiler::EventType::CPU_BACKEND_TASK_EVENT) {
+      continue;
+    }
     const auto subgraph_index = event->extra_event_metadata;
     auto stats_calculator = GetStatsCalculator(subgraph_index);
     int64_t start_us = event->begin_timestamp_us - base_start_us;
@@ -138,35 +199,33 @@ void ProfileSummarizer::ProcessProfiles(
       // index as event_metadata. See the macro
       // TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE defined in
       // tensorflow/lite/core/api/profiler.h for details.
-      const auto node_index = event->event_metadata;
-
-      const auto op_details =
-          GetOperatorDetails(interpreter, subgraph_index, node_index);
-      std::string type_in_stats(event->tag);
-      if (!op_details.op_description.empty()) {
-        type_in_stats += "/" + op_details.op_description;
-      }
-
-      const auto node_name = ToString(op_details.outputs);
-      // Append node index to node name because 'stats_calculator' can not
-      // distinguish two nodes w/ the same 'node_name'.
-      const auto node_name_in_stats =
-          node_name + ":" + std::to_string(node_index);
-
+      std::string node_name_in_stats, type_in_stats;
+      GetOperatorNodeNameAndType(interpreter, event->tag, subgraph_index,
+                                 event->event_metadata, &node_name_in_stats,
+                                 &type_in_stats);
       stats_calculator->AddNodeStats(node_name_in_stats, type_in_stats,
                                      node_num, start_us, node_exec_time,
                                      0 /*memory */);
+      op_cost_stats_[event->tag].Add(
+          GetOperatorCost(interpreter, subgraph_index, event->event_metadata),
+          /*num_invocations=*/1, node_exec_time);
+    } else if (event->event_type ==
+               Profiler::EventType::OPERATOR_PREPARE_EVENT) {
+      // Operators are only prepared during runs when their tensors are
+      // resized, e.g. with dynamic tensors.
+      std::string node_name_in_stats, type_in_stats;
+      GetOperatorNodeNameAndType(interpreter, event->tag, subgraph_index,
+                                 event->event_metadata, &node_name_in_stats,
+                                 &type_in_stats);
+      stats_calculator->AddNodeStats(
+          node_name_in_stats + "/Prepare", type_in_stats + "/Prepare",
+          node_num, start_us, node_exec_time, 0 /*memory */);
     } else if (event->event_type ==
                Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT) {
-      const std::string node_name(event->tag);
-      // Append event_metadata to node name because 'stats_calculator' can not
-      // distinguish two nodes w/ the same 'node_name'.
-      const auto node_name_in_stats =
-          "Delegate/" + node_name + ":" + std::to_string(event->event_metadata);
-
       delegate_stats_calculator_->AddNodeStats(
-          node_name_in_stats, "DelegateOpInvoke", node_num, start_us,
-          node_exec_time, 0 /*memory */);
+          GetDelegateNodeName(event->tag, event->event_metadata),
+          "DelegateOpInvoke", node_num, start_us, node_exec_time,
+          0 /*memory */);
     } else {
       // TODO(b/139812778) consider use a different stats_calculator to record
       // non-op-invoke events so that these could be separated from
@@ -205,6 +264,77 @@ void ProfileSummarizer::ProcessProfiles(
   }
 }
 
+void ProfileSummarizer::ProcessEventStats(
+    const std::vector<ProfileEventStats>& event_stats, int64_t num_runs,
+    const tflite::Interpreter& interpreter) {
+  if (num_runs <= 0) return;
+  num_event_stats_runs_ += num_runs;
+
+  for (const auto& stats : event_stats) {
+    if (stats.count == 0 ||
+        stats.event_type == Profiler::EventType::CPU_BACKEND_TASK_EVENT) {
+      continue;
+    }
+    const auto subgraph_index = stats.extra_event_metadata;
+    if (stats.event_type == Profiler::EventType::OPERATOR_INVOKE_EVENT) {
+      std::string node_name_in_stats, type_in_stats;
+      GetOperatorNodeNameAndType(interpreter, stats.tag, subgraph_index,
+                                 stats.event_metadata, &node_name_in_stats,
+                                 &type_in_stats);
+      MergeNodeStats(&event_stats_map_[subgraph_index], node_name_in_stats,
+                     type_in_stats, stats);
+      op_cost_stats_[stats.tag].Add(
+          GetOperatorCost(interpreter, subgraph_index, stats.event_metadata),
+          stats.count, stats.total_us);
+    } else if (stats.event_type ==
+               Profiler::EventType::OPERATOR_PREPARE_EVENT) {
+      std::string node_name_in_stats, type_in_stats;
+      GetOperatorNodeNameAndType(interpreter, stats.tag, subgraph_index,
+                                 stats.event_metadata, &node_name_in_stats,
+                                 &type_in_stats);
+      MergeNodeStats(&event_stats_map_[subgraph_index],
+                     node_name_in_stats + "/Prepare",
+                     type_in_stats + "/Prepare", stats);
+    } else if (stats.event_type ==
+               Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT) {
+      MergeNodeStats(&delegate_event_stats_,
+                     GetDelegateNodeName(stats.tag, stats.event_metadata),
+                     "DelegateOpInvoke", stats);
+    } else {
+      if (stats.tag == "Invoke") {
+        // Don't count the overall Invoke for profiling.
+        continue;
+      }
+      MergeNodeStats(&event_stats_map_[subgraph_index],
+                     stats.tag + "/" + std::to_string(subgraph_index),
+                     stats.tag, stats);
+    }
+  }
+}
+
+std::string ProfileSummarizer::GetOutputString() {
+  std::string output;
+  // The stats calculators are left out when they only hold empty tables.
+  if (HasStatsCalculatorProfiles() || num_event_stats_runs_ == 0) {
+    output = summary_formatter_->GetOutputString(stats_calculator_map_,
+                                                 *delegate_stats_calculator_);
+  }
+  return output + summary_formatter_->GetEventStatsString(
+                      event_stats_map_, delegate_event_stats_,
+                      num_event_stats_runs_, /*include_node_stats=*/true);
+}
+
+std::string ProfileSummarizer::GetShortSummary() {
+  std::string output;
+  if (HasStatsCalculatorProfiles() || num_event_stats_runs_ == 0) {
+    output = summary_formatter_->GetShortSummary(stats_calculator_map_,
+                                                 *delegate_stats_calculator_);
+  }
+  return output + summary_formatter_->GetEventStatsString(
+                      event_stats_map_, delegate_event_stats_,
+                      num_event_stats_runs_, /*include_node_stats=*/false);
+}
+
 tensorflow::StatsCalculator* ProfileSummarizer::GetStatsCalculator(
     uint32_t subgraph_index) {
   if (stats_calculator_map_.count(subgraph_index) == 0) {
@@ -17,11 +17,14 @@ limitations under the License.
 #define TENSORFLOW_LITE_PROFILING_PROFILE_SUMMARIZER_H_
 
 #include <functional>
+#include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "tensorflow/core/util/stats_calculator.h"
 #include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/profiling/op_cost.h"
 #include "tensorflow/lite/profiling/profile_buffer.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 
@@ -40,21 +43,46 @@ class ProfileSummarizer {
   void ProcessProfiles(const std::vector<const ProfileEvent*>& profile_stats,
                        const tflite::Interpreter& interpreter);
 
-  // Returns a string detailing the accumulated runtime stats in the format of
-  // summary_formatter_.
-  std::string GetOutputString() {
-    return summary_formatter_->GetOutputString(stats_calculator_map_,
-                                               *delegate_stats_calculator_);
+  // Updates statistics from `num_runs` runs aggregated per node, e.g. by a
+  // SamplingProfiler. The count, total, minimum and maximum duration of each
+  // node are merged as they are, without replaying individual invocations, so
+  // they are reported separately from the stats of ProcessProfiles().
+  void ProcessEventStats(const std::vector<ProfileEventStats>& event_stats,
+                         int64_t num_runs,
+                         const tflite::Interpreter& interpreter);
+
+  // Returns a string detailing the accumulated runtime stats, followed by the
+  // stats merged from aggregated events, in the format of summary_formatter_.
+  std::string GetOutputString();
+
+  std::string GetShortSummary();
+
+  tensorflow::StatsCalculator* GetStatsCalculator(uint32_t subgraph_index);
+
+  // Returns a string detailing the estimated cost and achieved throughput of
+  // operator invocations per node type, in the format of summary_formatter_.
+  std::string GetOpCostString() {
+    return summary_formatter_->GetOpCostString(op_cost_stats_);
   }
 
-  std::string GetShortSummary() {
-    return summary_formatter_->GetShortSummary(stats_calculator_map_,
-                                               *delegate_stats_calculator_);
+  // Returns the estimated cost and measured time of operator invocations, per
+  // operator name. See EstimateOpCost() for how the cost is estimated.
+  const std::map<std::string, OpCostStats>& GetOpCostStats() const {
+    return op_cost_stats_;
   }
 
-  tensorflow::StatsCalculator* GetStatsCalculator(uint32_t subgraph_index);
+  // Returns the node invocations merged by ProcessEventStats(), per subgraph.
+  const std::map<uint32_t, std::map<std::string, NodeEventStats>>&
+  GetEventStats() const {
+    return event_stats_map_;
+  }
 
   bool HasProfiles() {
+    return HasStatsCalculatorProfiles() || num_event_stats_runs_ > 0;
+  }
+
+ private:
+  bool HasStatsCalculatorProfiles() {
     for (auto& stats_calc : stats_calculator_map_) {
       auto subgraph_stats = stats_calc.second.get();
       if (subgraph_stats->num_runs() >= 1) return true;
@@ -62,13 +90,21 @@ class ProfileSummarizer {
     return false;
   }
 
- private:
   // Map storing stats per subgraph.
   std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>
       stats_calculator_map_;
 
   std::unique_ptr<tensorflow::StatsCalculator> delegate_stats_calculator_;
 
+  // Node invocations merged from aggregated events, per subgraph and for
+  // delegate internal nodes, over `num_event_stats_runs_` runs.
+  std::map<uint32_t, std::map<std::string, NodeEventStats>> event_stats_map_;
+  std::map<std::string, NodeEventStats> delegate_event_stats_;
+  int64_t num_event_stats_runs_ = 0;
+
+  // Cost of operator invocations per operator name.
+  std::map<std::string, OpCostStats> op_cost_stats_;
+
   // Summary formatter for customized output formats.
   std::shared_ptr<ProfileSummaryFormatter> summary_formatter_;
 };
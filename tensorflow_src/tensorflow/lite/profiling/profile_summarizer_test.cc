@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/test_util.h"
 #include "tensorflow/lite/model.h"
 #include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/profiling/sampling_profiler.h"
 #include "tensorflow/lite/version.h"
 
 namespace tflite {
@@ -149,6 +150,64 @@ TEST(ProfileSummarizerTest, InterpreterPlusProfilingDetails) {
       << output;
 }
 
+TEST(ProfileSummarizerTest, InterpreterEventStats) {
+  SamplingProfiler::Options options;
+  options.sampling_period = 2;
+  SamplingProfiler profiler(options);
+  SimpleOpModel m;
+  m.Init(RegisterSimpleOpWithProfilingDetails);
+  auto interpreter = m.GetInterpreter();
+  interpreter->SetProfiler(&profiler);
+  for (int i = 0; i < 10; ++i) {
+    m.SetInputs(i, 2);
+    m.Invoke();
+    EXPECT_EQ(m.GetOutput(), i + 2);
+  }
+  interpreter->SetProfiler(nullptr);
+  EXPECT_EQ(5, profiler.num_sampled_invokes());
+  ProfileSummarizer summarizer;
+  summarizer.ProcessEventStats(profiler.GetEventStats(),
+                               profiler.num_sampled_invokes(), *interpreter);
+  auto output = summarizer.GetOutputString();
+  ASSERT_TRUE(output.find("SimpleOpEval/Profile") != std::string::npos)
+      << output;
+  ASSERT_TRUE(output.find("Invoke") == std::string::npos) << output;  // NOLINT
+}
+
+TEST(ProfileSummarizerTest, EventStatsAreMerged) {
+  SimpleOpModel m;
+  m.Init(RegisterSimpleOp);
+  ProfileEventStats stats;
+  stats.tag = "Stage";
+  stats.event_type = ProfileEvent::EventType::DEFAULT;
+  stats.event_metadata = 0;
+  stats.extra_event_metadata = 0;
+  stats.count = 2;
+  stats.total_us = 30;
+  stats.min_us = 10;
+  stats.max_us = 20;
+  ProfileSummarizer summarizer;
+  summarizer.ProcessEventStats({stats}, /*num_runs=*/2, *m.GetInterpreter());
+  stats.count = 1;
+  stats.total_us = 5;
+  stats.min_us = 5;
+  stats.max_us = 5;
+  summarizer.ProcessEventStats({stats}, /*num_runs=*/1, *m.GetInterpreter());
+
+  ASSERT_EQ(1, summarizer.GetEventStats().count(0));
+  const auto& node_stats = summarizer.GetEventStats().at(0);
+  ASSERT_EQ(1, node_stats.count("Stage/0"));
+  const NodeEventStats& merged = node_stats.at("Stage/0");
+  EXPECT_EQ("Stage", merged.type);
+  EXPECT_EQ(3, merged.count);
+  EXPECT_EQ(35, merged.total_us);
+  EXPECT_EQ(5, merged.min_us);
+  EXPECT_EQ(20, merged.max_us);
+  EXPECT_TRUE(summarizer.HasProfiles());
+  auto output = summarizer.GetShortSummary();
+  EXPECT_NE(output.find("runs=3"), std::string::npos) << output;
+}
+
 // A simple test that performs `ADD` if condition is true, and `MUL` otherwise.
 // The computation is: `cond ? a + b : a * b`.
 class ProfileSummarizerIfOpTest : public subgraph_test_util::ControlFlowOpTest {
@@ -225,6 +284,37 @@ TEST_F(ProfileSummarizerIfOpTest, TestIfFalse) {
   EXPECT_EQ(2, event_count_of_subgraph_two);
 }
 
+TEST_F(ProfileSummarizerIfOpTest, OperatorCost) {
+  BufferedProfiler profiler(1024);
+  interpreter_->SetProfiler(&profiler);
+
+  interpreter_->typed_input_tensor<bool>(0)[0] = true;
+  profiler.StartProfiling();
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  profiler.StopProfiling();
+
+  ProfileSummarizer summarizer;
+  summarizer.ProcessProfiles(profiler.GetProfileEvents(), *interpreter_);
+  const auto& op_cost_stats = summarizer.GetOpCostStats();
+  ASSERT_EQ(1, op_cost_stats.count("ADD"));
+  ASSERT_EQ(1, op_cost_stats.count("IF"));
+  // An int32 [2] + [1, 2] addition in subgraph 1.
+  const OpCostStats& add = op_cost_stats.at("ADD");
+  EXPECT_EQ(1, add.count);
+  EXPECT_EQ(2, add.cost.flops);
+  EXPECT_EQ(16, add.cost.input_bytes);
+  EXPECT_EQ(8, add.cost.output_bytes);
+  EXPECT_EQ(0, op_cost_stats.at("IF").cost.flops);
+
+  // The cost table is only reported on request.
+  EXPECT_TRUE(summarizer.GetOutputString().find("Cost by node type") ==
+              std::string::npos);
+  const std::string output = summarizer.GetOpCostString();
+  EXPECT_TRUE(output.find("Cost by node type") != std::string::npos)
+      << output;
+  EXPECT_TRUE(output.find("[GFLOP/s]") != std::string::npos) << output;
+}
+
 }  // namespace
 }  // namespace profiling
 }  // namespace tflite
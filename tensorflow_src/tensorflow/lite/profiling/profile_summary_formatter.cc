@@ -15,8 +15,14 @@ limitations under the License.
 
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 
+#include <algorithm>
+#include <iomanip>
+#include <map>
 #include <memory>
 #include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace tflite {
 namespace profiling {
@@ -76,6 +82,148 @@ std::string ProfileSummaryDefaultFormatter::GenerateReport(
   return stream.str();
 }
 
+std::string ProfileSummaryDefaultFormatter::GetOpCostString(
+    const std::map<std::string, OpCostStats>& op_cost_stats) const {
+  std::vector<std::pair<std::string, OpCostStats>> sorted_stats;
+  for (const auto& stats : op_cost_stats) {
+    if (stats.second.count > 0) sorted_stats.push_back(stats);
+  }
+  if (sorted_stats.empty()) return "";
+  // Most expensive node types first, as in the summary by node type.
+  std::stable_sort(sorted_stats.begin(), sorted_stats.end(),
+                   [](const std::pair<std::string, OpCostStats>& a,
+                      const std::pair<std::string, OpCostStats>& b) {
+                     return a.second.time_us > b.second.time_us;
+                   });
+
+  const bool format_as_csv = GetStatSummarizerOptions().format_as_csv;
+  const int widths[] = {24, 9, 10, 10, 10, 10, 11, 10};
+  std::stringstream stream;
+  auto write_row = [&](const std::vector<std::string>& cells) {
+    for (int i = 0; i < cells.size(); ++i) {
+      if (format_as_csv) {
+        stream << (i > 0 ? "," : "") << cells[i];
+      } else {
+        stream << "\t" << std::setw(widths[i]) << cells[i];
+      }
+    }
+    stream << std::endl;
+  };
+  auto format = [](double value, int precision) {
+    std::stringstream stream;
+    stream << std::fixed << std::setprecision(precision) << value;
+    return stream.str();
+  };
+
+  if (!format_as_csv) {
+    stream << "============================== Cost by node type "
+              "=============================="
+           << std::endl;
+  }
+  write_row({"[Node type]", "[count]", "[avg ms]", "[MFLOP]", "[MB]",
+             "[FLOP/B]", "[GFLOP/s]", "[GB/s]"});
+  for (const auto& stats : sorted_stats) {
+    const OpCostStats& s = stats.second;
+    // Estimates are per invocation, throughputs over the measured time.
+    const double time_ns = s.time_us * 1000.0;
+    write_row({stats.first, std::to_string(s.count),
+               format(s.time_us / 1000.0 / s.count, 3),
+               format(s.cost.flops / 1e6 / s.count, 3),
+               format(s.cost.total_bytes() / 1e6 / s.count, 3),
+               format(s.cost.arithmetic_intensity(), 2),
+               format(time_ns > 0 ? s.cost.flops / time_ns : 0, 2),
+               format(time_ns > 0 ? s.cost.total_bytes() / time_ns : 0, 2)});
+  }
+  return stream.str();
+}
+
+std::string ProfileSummaryDefaultFormatter::GetEventStatsString(
+    const std::map<uint32_t, std::map<std::string, NodeEventStats>>&
+        event_stats_map,
+    const std::map<std::string, NodeEventStats>& delegate_event_stats,
+    int64_t num_runs, bool include_node_stats) const {
+  if (num_runs <= 0) return "";
+  std::stringstream stream;
+  for (const auto& subgraph_stats : event_stats_map) {
+    const uint32_t subgraph_index = subgraph_stats.first;
+    stream << GetNodeEventStatsString(
+        subgraph_index == 0 ? ""
+                            : "Subgraph (index: " +
+                                  std::to_string(subgraph_index) + ") ",
+        subgraph_stats.second, num_runs, include_node_stats);
+  }
+  if (!delegate_event_stats.empty()) {
+    stream << "Delegate internal: " << std::endl
+           << GetNodeEventStatsString("", delegate_event_stats, num_runs,
+                                      include_node_stats);
+  }
+  return stream.str();
+}
+
+std::string ProfileSummaryDefaultFormatter::GetNodeEventStatsString(
+    const std::string& prefix,
+    const std::map<std::string, NodeEventStats>& node_stats, int64_t num_runs,
+    bool include_node_stats) const {
+  int64_t total_us = 0;
+  std::vector<std::pair<std::string, NodeEventStats>> sorted_stats;
+  for (const auto& stats : node_stats) {
+    if (stats.second.count == 0) continue;
+    total_us += stats.second.total_us;
+    sorted_stats.push_back(stats);
+  }
+  if (sorted_stats.empty()) return "";
+
+  std::stringstream stream;
+  if (include_node_stats) {
+    std::stable_sort(sorted_stats.begin(), sorted_stats.end(),
+                     [](const std::pair<std::string, NodeEventStats>& a,
+                        const std::pair<std::string, NodeEventStats>& b) {
+                       return a.second.run_order < b.second.run_order;
+                     });
+    const bool format_as_csv = GetStatSummarizerOptions().format_as_csv;
+    const int widths[] = {24, 9, 10, 10, 10, 9, 9, 14, 0};
+    auto write_row = [&](const std::vector<std::string>& cells) {
+      for (int i = 0; i < cells.size(); ++i) {
+        if (format_as_csv) {
+          stream << (i > 0 ? "," : "") << cells[i];
+        } else {
+          stream << "\t" << std::setw(widths[i]) << cells[i];
+        }
+      }
+      stream << std::endl;
+    };
+    auto format = [](double value, int precision) {
+      std::stringstream stream;
+      stream << std::fixed << std::setprecision(precision) << value;
+      return stream.str();
+    };
+
+    if (!format_as_csv) {
+      stream << "============================== Aggregated run order "
+                "=============================="
+             << std::endl;
+    }
+    write_row({"[node type]", "[count]", "[avg ms]", "[min ms]", "[max ms]",
+               "[%]", "[cdf%]", "[times called]", "[Name]"});
+    int64_t cumulative_us = 0;
+    for (const auto& stats : sorted_stats) {
+      const NodeEventStats& s = stats.second;
+      cumulative_us += s.total_us;
+      const double total = total_us > 0 ? total_us : 1;
+      write_row({s.type, std::to_string(s.count),
+                 format(s.total_us / 1000.0 / s.count, 3),
+                 format(s.min_us / 1000.0, 3), format(s.max_us / 1000.0, 3),
+                 format(100.0 * s.total_us / total, 3) + "%",
+                 format(100.0 * cumulative_us / total, 3) + "%",
+                 format(static_cast<double>(s.count) / num_runs, 2),
+                 stats.first});
+    }
+  }
+  stream << prefix << "Aggregated timings (microseconds): runs=" << num_runs
+         << " avg=" << static_cast<double>(total_us) / num_runs << std::endl;
+  return stream.str();
+}
+
 tensorflow::StatSummarizerOptions
 ProfileSummaryDefaultFormatter::GetStatSummarizerOptions() const {
   auto options = tensorflow::StatSummarizerOptions();
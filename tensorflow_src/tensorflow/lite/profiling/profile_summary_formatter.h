@@ -15,7 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_PROFILING_PROFILE_SUMMARY_FORMATTER_H_
 #define TENSORFLOW_LITE_PROFILING_PROFILE_SUMMARY_FORMATTER_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -23,10 +26,33 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/util/stats_calculator.h"
+#include "tensorflow/lite/profiling/op_cost.h"
 
 namespace tflite {
 namespace profiling {
 
+// Invocations of a node, merged from events aggregated by the profiler, e.g.
+// by a SamplingProfiler.
+struct NodeEventStats {
+  std::string type;
+  // Order in which the node was first seen.
+  int64_t run_order = 0;
+  // Number of invocations, and their total, shortest and longest durations.
+  int64_t count = 0;
+  int64_t total_us = 0;
+  int64_t min_us = 0;
+  int64_t max_us = 0;
+
+  void Merge(int64_t num_events, int64_t events_total_us,
+             int64_t events_min_us, int64_t events_max_us) {
+    if (num_events <= 0) return;
+    min_us = count > 0 ? std::min(min_us, events_min_us) : events_min_us;
+    max_us = count > 0 ? std::max(max_us, events_max_us) : events_max_us;
+    count += num_events;
+    total_us += events_total_us;
+  }
+};
+
 // Formats the profile summary in a certain way.
 class ProfileSummaryFormatter {
  public:
@@ -46,6 +72,23 @@ class ProfileSummaryFormatter {
       const tensorflow::StatsCalculator& delegate_stats_calculator) const = 0;
   virtual tensorflow::StatSummarizerOptions GetStatSummarizerOptions()
       const = 0;
+  // Returns a string detailing the estimated cost and achieved throughput of
+  // operator invocations per node type. Empty by default.
+  virtual std::string GetOpCostString(
+      const std::map<std::string, OpCostStats>& op_cost_stats) const {
+    return "";
+  }
+  // Returns a string detailing the node invocations merged from aggregated
+  // events over `num_runs` runs, per subgraph and for delegate internal nodes.
+  // Only the per-run totals are included unless `include_node_stats` is set.
+  // Empty by default.
+  virtual std::string GetEventStatsString(
+      const std::map<uint32_t, std::map<std::string, NodeEventStats>>&
+          event_stats_map,
+      const std::map<std::string, NodeEventStats>& delegate_event_stats,
+      int64_t num_runs, bool include_node_stats) const {
+    return "";
+  }
 };
 
 class ProfileSummaryDefaultFormatter : public ProfileSummaryFormatter {
@@ -63,8 +106,19 @@ class ProfileSummaryDefaultFormatter : public ProfileSummaryFormatter {
       const tensorflow::StatsCalculator& delegate_stats_calculator)
       const override;
   tensorflow::StatSummarizerOptions GetStatSummarizerOptions() const override;
+  std::string GetOpCostString(
+      const std::map<std::string, OpCostStats>& op_cost_stats) const override;
+  std::string GetEventStatsString(
+      const std::map<uint32_t, std::map<std::string, NodeEventStats>>&
+          event_stats_map,
+      const std::map<std::string, NodeEventStats>& delegate_event_stats,
+      int64_t num_runs, bool include_node_stats) const override;
 
  private:
+  std::string GetNodeEventStatsString(
+      const std::string& prefix,
+      const std::map<std::string, NodeEventStats>& node_stats,
+      int64_t num_runs, bool include_node_stats) const;
   std::string GenerateReport(
       const std::string& tag, bool include_output_string,
       const std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>&
@@ -152,6 +152,46 @@ TEST(SummaryWriterTest, DelegationShortSummary) {
   ASSERT_TRUE(output.find("Delegate internal") != std::string::npos);
 }
 
+TEST(SummaryWriterTest, EmptyOpCostString) {
+  ProfileSummaryDefaultFormatter writer;
+  EXPECT_EQ("", writer.GetOpCostString({}));
+}
+
+TEST(SummaryWriterTest, OpCostString) {
+  ProfileSummaryDefaultFormatter writer;
+  OpCost cost;
+  cost.flops = 2000000;
+  cost.input_bytes = 1000000;
+  std::map<std::string, OpCostStats> op_cost_stats;
+  op_cost_stats["CONV_2D"].Add(cost, /*num_invocations=*/2,
+                               /*invocations_time_us=*/4000);
+  op_cost_stats["ADD"].Add(cost, /*num_invocations=*/1,
+                           /*invocations_time_us=*/1);
+  std::string output = writer.GetOpCostString(op_cost_stats);
+  ASSERT_TRUE(output.find("Cost by node type") != std::string::npos);
+  // The slowest node type comes first.
+  ASSERT_LT(output.find("CONV_2D"), output.find("ADD"));
+  // 2 ms, 2 MFLOP and 1 MB per invocation, i.e. 1 GFLOP/s and 0.5 GB/s.
+  ASSERT_TRUE(output.find("2.000\t     2.000\t     1.000\t      2.00"
+                          "\t       1.00\t      0.50") != std::string::npos)
+      << output;
+}
+
+TEST(SummaryWriterTest, OpCostStringCSV) {
+  ProfileSummaryCSVFormatter writer;
+  OpCost cost;
+  cost.flops = 2000000;
+  cost.input_bytes = 1000000;
+  std::map<std::string, OpCostStats> op_cost_stats;
+  op_cost_stats["CONV_2D"].Add(cost, /*num_invocations=*/2,
+                               /*invocations_time_us=*/4000);
+  std::string output = writer.GetOpCostString(op_cost_stats);
+  ASSERT_TRUE(output.find("Cost by node type") == std::string::npos);
+  ASSERT_TRUE(output.find("CONV_2D,2,2.000,2.000,1.000,2.00,1.00,0.50\n") !=
+              std::string::npos)
+      << output;
+}
+
 }  // namespace
 }  // namespace profiling
 }  // namespace tflite
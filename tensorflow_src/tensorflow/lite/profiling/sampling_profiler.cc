@@ -0,0 +1,498 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/sampling_profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <tuple>
+
+#include "tensorflow/lite/profiling/time.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+constexpr uint32_t kMaxThreads = 64;
+// Event handles hold the thread index in their top byte and the index of the
+// open event in the lower bits.
+constexpr int kThreadIndexShift = 24;
+constexpr uint32_t kOpenEventIndexMask = (1u << kThreadIndexShift) - 1;
+// Events open at once on a thread, i.e. the deepest nesting recorded.
+constexpr int kMaxOpenEvents = 32;
+// Returned for the "Invoke" events that are not recorded, so that the end of
+// the invoke can still be tracked.
+constexpr uint32_t kUnrecordedInvokeHandle = kInvalidEventHandle - 1;
+
+std::atomic<uint64_t> next_profiler_id(1);
+
+// The buffer of the calling thread for the profiler it last recorded with.
+struct ThreadBufferCache {
+  uint64_t profiler_id = 0;
+  void* buffer = nullptr;
+};
+thread_local ThreadBufferCache thread_buffer_cache;
+
+uint32_t RoundUpToPowerOfTwo(uint32_t n) {
+  uint32_t result = 1;
+  while (result < n) result <<= 1;
+  return result;
+}
+
+// Runtime instrumentation events are left out, as by BufferedProfiler.
+bool IsSupportedEvent(Profiler::EventType event_type) {
+  return event_type !=
+         Profiler::EventType::GENERAL_RUNTIME_INSTRUMENTATION_EVENT;
+}
+
+bool IsInvokeEvent(const char* tag, Profiler::EventType event_type) {
+  return event_type == Profiler::EventType::DEFAULT &&
+         std::strcmp(tag, "Invoke") == 0;
+}
+
+uint32_t HashEventKey(const char* tag, Profiler::EventType event_type,
+                      int64_t event_metadata1, int64_t event_metadata2) {
+  constexpr uint64_t kMultiplier = 0x9E3779B97F4A7C15ull;
+  uint64_t hash = reinterpret_cast<uintptr_t>(tag);
+  hash = hash * kMultiplier + static_cast<uint64_t>(event_metadata1);
+  hash = hash * kMultiplier + static_cast<uint64_t>(event_metadata2);
+  hash = hash * kMultiplier + static_cast<uint64_t>(event_type);
+  return static_cast<uint32_t>(hash >> 32);
+}
+
+SamplingProfiler::Options ValidateOptions(SamplingProfiler::Options options) {
+  options.max_events_per_thread = std::max(options.max_events_per_thread, 1u);
+  options.max_event_stats_per_thread =
+      std::max(options.max_event_stats_per_thread, 1u);
+  options.max_threads =
+      std::min(std::max(options.max_threads, 1u), kMaxThreads);
+  options.sampling_period = std::max(options.sampling_period, 1u);
+  return options;
+}
+
+}  // namespace
+
+struct SamplingProfiler::Event {
+  const char* tag;
+  EventType event_type;
+  int64_t event_metadata1;
+  int64_t event_metadata2;
+  uint64_t begin_us;
+  uint64_t end_us;
+  // Slot in the open events of the thread, which is lower for an event than
+  // for the events nested in it.
+  int depth;
+};
+
+struct SamplingProfiler::OpenEvent {
+  const char* tag;
+  EventType event_type;
+  int64_t event_metadata1;
+  int64_t event_metadata2;
+  uint64_t begin_us;
+  bool open;
+};
+
+struct SamplingProfiler::Stats {
+  const char* tag;
+  EventType event_type;
+  int64_t event_metadata1;
+  int64_t event_metadata2;
+  // Zero for unused entries.
+  uint64_t count;
+  uint64_t total_us;
+  uint64_t min_us;
+  uint64_t max_us;
+};
+
+// Everything below is written by the owning thread only, except `begin` and
+// `overwritten_events`, which belong to the reader.
+struct SamplingProfiler::ThreadBuffer {
+  ThreadBuffer(const Options& options, uint32_t index)
+      : index(index),
+        owner(std::this_thread::get_id()),
+        events(RoundUpToPowerOfTwo(options.max_events_per_thread)),
+        stats(RoundUpToPowerOfTwo(options.max_event_stats_per_thread)),
+        open_events(kMaxOpenEvents) {}
+
+  const uint32_t index;
+  const std::thread::id owner;
+
+  // Ring of finished events; the unread ones are [begin, end), modulo the
+  // ring size.
+  std::vector<Event> events;
+  std::atomic<uint32_t> end{0};
+  uint32_t begin = 0;
+  uint64_t overwritten_events = 0;
+
+  // Open-addressing hash table.
+  std::vector<Stats> stats;
+  uint64_t unaggregated_events = 0;
+
+  // Events that began and did not end yet. Entries above the last open one
+  // are free.
+  std::vector<OpenEvent> open_events;
+  int num_open_events = 0;
+  uint64_t dropped_open_events = 0;
+
+  // Nesting depth of "Invoke" events, and whether the outermost one is
+  // recorded.
+  int invoke_depth = 0;
+  bool invoke_recorded = false;
+
+  // Events in the ring that were not read and will be overwritten.
+  uint32_t PendingOverwrites(uint32_t current_end) const {
+    const uint32_t unread = current_end - begin;
+    const uint32_t capacity = events.size();
+    return unread > capacity ? unread - capacity : 0;
+  }
+};
+
+SamplingProfiler::SamplingProfiler(const Options& options)
+    : options_(ValidateOptions(options)),
+      id_(next_profiler_id.fetch_add(1, std::memory_order_relaxed)),
+      enabled_(true),
+      num_invokes_(0),
+      num_sampled_invokes_(0),
+      dropped_thread_events_(0),
+      num_threads_(0),
+      threads_(new std::atomic<ThreadBuffer*>[options_.max_threads]) {
+  for (uint32_t i = 0; i < options_.max_threads; ++i) {
+    threads_[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+SamplingProfiler::~SamplingProfiler() {
+  for (uint32_t i = 0; i < options_.max_threads; ++i) {
+    delete threads_[i].load(std::memory_order_acquire);
+  }
+}
+
+SamplingProfiler::ThreadBuffer* SamplingProfiler::GetThreadBuffer() {
+  if (thread_buffer_cache.profiler_id == id_) {
+    return static_cast<ThreadBuffer*>(thread_buffer_cache.buffer);
+  }
+  return RegisterThread();
+}
+
+SamplingProfiler::ThreadBuffer* SamplingProfiler::RegisterThread() {
+  // The thread may already own a buffer if it recorded events with another
+  // profiler in between.
+  ThreadBuffer* buffer = nullptr;
+  const std::thread::id self = std::this_thread::get_id();
+  const uint32_t num_threads =
+      std::min(num_threads_.load(std::memory_order_acquire),
+               options_.max_threads);
+  for (uint32_t i = 0; i < num_threads && buffer == nullptr; ++i) {
+    ThreadBuffer* candidate = threads_[i].load(std::memory_order_acquire);
+    if (candidate != nullptr && candidate->owner == self) buffer = candidate;
+  }
+  if (buffer == nullptr) {
+    const uint32_t index =
+        num_threads_.fetch_add(1, std::memory_order_acq_rel);
+    if (index < options_.max_threads) {
+      buffer = new ThreadBuffer(options_, index);
+      threads_[index].store(buffer, std::memory_order_release);
+    }
+  }
+  thread_buffer_cache.profiler_id = id_;
+  thread_buffer_cache.buffer = buffer;
+  return buffer;
+}
+
+uint32_t SamplingProfiler::BeginEvent(const char* tag, EventType event_type,
+                                      int64_t event_metadata1,
+                                      int64_t event_metadata2) {
+  if (!enabled_.load(std::memory_order_relaxed) ||
+      !IsSupportedEvent(event_type)) {
+    return kInvalidEventHandle;
+  }
+  ThreadBuffer* buffer = GetThreadBuffer();
+  if (buffer == nullptr) {
+    dropped_thread_events_.fetch_add(1, std::memory_order_relaxed);
+    return kInvalidEventHandle;
+  }
+
+  const bool is_invoke = IsInvokeEvent(tag, event_type);
+  if (is_invoke && buffer->invoke_depth++ == 0) {
+    const uint64_t invoke =
+        num_invokes_.fetch_add(1, std::memory_order_relaxed);
+    buffer->invoke_recorded = invoke % options_.sampling_period == 0;
+    if (buffer->invoke_recorded) {
+      num_sampled_invokes_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  if (buffer->invoke_depth > 0 && !buffer->invoke_recorded) {
+    return is_invoke ? kUnrecordedInvokeHandle : kInvalidEventHandle;
+  }
+  if (buffer->num_open_events == kMaxOpenEvents) {
+    ++buffer->dropped_open_events;
+    return is_invoke ? kUnrecordedInvokeHandle : kInvalidEventHandle;
+  }
+
+  const int index = buffer->num_open_events++;
+  OpenEvent& event = buffer->open_events[index];
+  event.tag = tag;
+  event.event_type = event_type;
+  event.event_metadata1 = event_metadata1;
+  event.event_metadata2 = event_metadata2;
+  event.open = true;
+  event.begin_us = time::MonotonicNowMicros();
+  return (buffer->index << kThreadIndexShift) | index;
+}
+
+void SamplingProfiler::EndEvent(uint32_t event_handle) {
+  EndEvent(event_handle, nullptr, nullptr);
+}
+
+void SamplingProfiler::EndEvent(uint32_t event_handle,
+                                int64_t event_metadata1,
+                                int64_t event_metadata2) {
+  EndEvent(event_handle, &event_metadata1, &event_metadata2);
+}
+
+void SamplingProfiler::EndEvent(uint32_t event_handle,
+                                const int64_t* event_metadata1,
+                                const int64_t* event_metadata2) {
+  // Not gated on `enabled_`, so that invokes that began while profiling was
+  // enabled are tracked to their end.
+  if (event_handle == kInvalidEventHandle) return;
+  if (event_handle == kUnrecordedInvokeHandle) {
+    ThreadBuffer* buffer = GetThreadBuffer();
+    if (buffer != nullptr && buffer->invoke_depth > 0) --buffer->invoke_depth;
+    return;
+  }
+  const uint32_t thread_index = event_handle >> kThreadIndexShift;
+  const uint32_t event_index = event_handle & kOpenEventIndexMask;
+  if (thread_index >= options_.max_threads || event_index >= kMaxOpenEvents) {
+    return;
+  }
+  ThreadBuffer* buffer = threads_[thread_index].load(std::memory_order_acquire);
+  if (buffer == nullptr) return;
+  OpenEvent& event = buffer->open_events[event_index];
+  if (!event.open) return;
+
+  const uint64_t end_us = time::MonotonicNowMicros();
+  event.open = false;
+  if (IsInvokeEvent(event.tag, event.event_type) && buffer->invoke_depth > 0) {
+    --buffer->invoke_depth;
+  }
+  Record(buffer, event.tag, event.event_type,
+         event_metadata1 ? *event_metadata1 : event.event_metadata1,
+         event_metadata2 ? *event_metadata2 : event.event_metadata2,
+         event.begin_us, end_us, event_index);
+  while (buffer->num_open_events > 0 &&
+         !buffer->open_events[buffer->num_open_events - 1].open) {
+    --buffer->num_open_events;
+  }
+}
+
+void SamplingProfiler::AddEvent(const char* tag, EventType event_type,
+                                uint64_t start, uint64_t end,
+                                int64_t event_metadata1,
+                                int64_t event_metadata2) {
+  if (!enabled_.load(std::memory_order_relaxed) ||
+      !IsSupportedEvent(event_type)) {
+    return;
+  }
+  ThreadBuffer* buffer = GetThreadBuffer();
+  if (buffer == nullptr) {
+    dropped_thread_events_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  if (buffer->invoke_depth > 0 && !buffer->invoke_recorded) return;
+  // `start` and `end` come from time::NowMicros(). Move them to the monotonic
+  // clock by the current offset between the two, keeping the duration.
+  const int64_t offset_us = static_cast<int64_t>(time::MonotonicNowMicros()) -
+                            static_cast<int64_t>(time::NowMicros());
+  const uint64_t begin_us =
+      std::max<int64_t>(static_cast<int64_t>(start) + offset_us, 0);
+  Record(buffer, tag, event_type, event_metadata1, event_metadata2, begin_us,
+         begin_us + (end - start), buffer->num_open_events);
+}
+
+void SamplingProfiler::Record(ThreadBuffer* buffer, const char* tag,
+                              EventType event_type, int64_t event_metadata1,
+                              int64_t event_metadata2, uint64_t begin_us,
+                              uint64_t end_us, int depth) {
+  const uint32_t end = buffer->end.load(std::memory_order_relaxed);
+  Event& event = buffer->events[end & (buffer->events.size() - 1)];
+  event.tag = tag;
+  event.event_type = event_type;
+  event.event_metadata1 = event_metadata1;
+  event.event_metadata2 = event_metadata2;
+  event.begin_us = begin_us;
+  event.end_us = end_us;
+  event.depth = depth;
+  buffer->end.store(end + 1, std::memory_order_release);
+
+  const uint64_t duration_us = end_us > begin_us ? end_us - begin_us : 0;
+  const uint32_t mask = buffer->stats.size() - 1;
+  uint32_t i =
+      HashEventKey(tag, event_type, event_metadata1, event_metadata2) & mask;
+  for (uint32_t probe = 0; probe <= mask; ++probe, i = (i + 1) & mask) {
+    Stats& stats = buffer->stats[i];
+    if (stats.count == 0) {
+      stats.tag = tag;
+      stats.event_type = event_type;
+      stats.event_metadata1 = event_metadata1;
+      stats.event_metadata2 = event_metadata2;
+      stats.count = 1;
+      stats.total_us = duration_us;
+      stats.min_us = duration_us;
+      stats.max_us = duration_us;
+      return;
+    }
+    if (stats.tag == tag && stats.event_type == event_type &&
+        stats.event_metadata1 == event_metadata1 &&
+        stats.event_metadata2 == event_metadata2) {
+      ++stats.count;
+      stats.total_us += duration_us;
+      stats.min_us = std::min(stats.min_us, duration_us);
+      stats.max_us = std::max(stats.max_us, duration_us);
+      return;
+    }
+  }
+  ++buffer->unaggregated_events;
+}
+
+void SamplingProfiler::Reset() {
+  const uint32_t num_threads = std::min(
+      num_threads_.load(std::memory_order_acquire), options_.max_threads);
+  for (uint32_t t = 0; t < num_threads; ++t) {
+    ThreadBuffer* buffer = threads_[t].load(std::memory_order_acquire);
+    if (buffer == nullptr) continue;
+    buffer->begin = buffer->end.load(std::memory_order_acquire);
+    buffer->overwritten_events = 0;
+    for (Stats& stats : buffer->stats) stats.count = 0;
+    buffer->unaggregated_events = 0;
+    buffer->dropped_open_events = 0;
+  }
+  num_invokes_.store(0, std::memory_order_relaxed);
+  num_sampled_invokes_.store(0, std::memory_order_relaxed);
+  dropped_thread_events_.store(0, std::memory_order_relaxed);
+}
+
+std::vector<const ProfileEvent*> SamplingProfiler::GetProfileEvents() {
+  std::vector<Event> events;
+  const uint32_t num_threads = std::min(
+      num_threads_.load(std::memory_order_acquire), options_.max_threads);
+  for (uint32_t t = 0; t < num_threads; ++t) {
+    ThreadBuffer* buffer = threads_[t].load(std::memory_order_acquire);
+    if (buffer == nullptr) continue;
+    const uint32_t end = buffer->end.load(std::memory_order_acquire);
+    const uint32_t overwritten = buffer->PendingOverwrites(end);
+    buffer->overwritten_events += overwritten;
+    buffer->begin += overwritten;
+    const uint32_t mask = buffer->events.size() - 1;
+    for (; buffer->begin != end; ++buffer->begin) {
+      events.push_back(buffer->events[buffer->begin & mask]);
+    }
+  }
+  // Events that began within the same microsecond are ordered parent first.
+  std::stable_sort(events.begin(), events.end(),
+                   [](const Event& a, const Event& b) {
+                     return a.begin_us < b.begin_us ||
+                            (a.begin_us == b.begin_us && a.depth < b.depth);
+                   });
+
+  profile_events_.clear();
+  profile_events_.reserve(events.size());
+  for (const Event& event : events) {
+    profile_events_.emplace_back();
+    ProfileEvent& profile_event = profile_events_.back();
+    profile_event.tag = event.tag;
+    profile_event.begin_timestamp_us = event.begin_us;
+    profile_event.end_timestamp_us = event.end_us;
+    profile_event.event_type = event.event_type;
+    profile_event.event_metadata = event.event_metadata1;
+    profile_event.extra_event_metadata = event.event_metadata2;
+  }
+  std::vector<const ProfileEvent*> result;
+  result.reserve(profile_events_.size());
+  for (const ProfileEvent& profile_event : profile_events_) {
+    result.push_back(&profile_event);
+  }
+  return result;
+}
+
+std::vector<ProfileEventStats> SamplingProfiler::GetEventStats() const {
+  // Tags are compared by value: the same literal may have several addresses.
+  using Key = std::tuple<std::string, int, int64_t, int64_t>;
+  std::map<Key, ProfileEventStats> merged;
+  const uint32_t num_threads = std::min(
+      num_threads_.load(std::memory_order_acquire), options_.max_threads);
+  for (uint32_t t = 0; t < num_threads; ++t) {
+    const ThreadBuffer* buffer = threads_[t].load(std::memory_order_acquire);
+    if (buffer == nullptr) continue;
+    for (const Stats& stats : buffer->stats) {
+      if (stats.count == 0) continue;
+      const Key key(stats.tag, static_cast<int>(stats.event_type),
+                    stats.event_metadata1, stats.event_metadata2);
+      auto it = merged.find(key);
+      if (it == merged.end()) {
+        ProfileEventStats& result = merged[key];
+        result.tag = stats.tag;
+        result.event_type = stats.event_type;
+        result.event_metadata = stats.event_metadata1;
+        result.extra_event_metadata = stats.event_metadata2;
+        result.count = stats.count;
+        result.total_us = stats.total_us;
+        result.min_us = stats.min_us;
+        result.max_us = stats.max_us;
+      } else {
+        ProfileEventStats& result = it->second;
+        result.count += stats.count;
+        result.total_us += stats.total_us;
+        result.min_us = std::min(result.min_us, stats.min_us);
+        result.max_us = std::max(result.max_us, stats.max_us);
+      }
+    }
+  }
+  std::vector<ProfileEventStats> result;
+  result.reserve(merged.size());
+  for (auto& entry : merged) result.push_back(std::move(entry.second));
+  return result;
+}
+
+uint64_t SamplingProfiler::dropped_events() const {
+  uint64_t dropped = dropped_thread_events_.load(std::memory_order_relaxed);
+  const uint32_t num_threads = std::min(
+      num_threads_.load(std::memory_order_acquire), options_.max_threads);
+  for (uint32_t t = 0; t < num_threads; ++t) {
+    const ThreadBuffer* buffer = threads_[t].load(std::memory_order_acquire);
+    if (buffer == nullptr) continue;
+    dropped += buffer->overwritten_events + buffer->dropped_open_events +
+               buffer->PendingOverwrites(
+                   buffer->end.load(std::memory_order_acquire));
+  }
+  return dropped;
+}
+
+uint64_t SamplingProfiler::unaggregated_events() const {
+  uint64_t unaggregated = 0;
+  const uint32_t num_threads = std::min(
+      num_threads_.load(std::memory_order_acquire), options_.max_threads);
+  for (uint32_t t = 0; t < num_threads; ++t) {
+    const ThreadBuffer* buffer = threads_[t].load(std::memory_order_acquire);
+    if (buffer != nullptr) unaggregated += buffer->unaggregated_events;
+  }
+  return unaggregated;
+}
+
+}  // namespace profiling
+}  // namespace tflite
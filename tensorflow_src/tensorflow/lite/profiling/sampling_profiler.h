@@ -0,0 +1,151 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_SAMPLING_PROFILER_H_
+#define TENSORFLOW_LITE_PROFILING_SAMPLING_PROFILER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/profile_buffer.h"
+
+namespace tflite {
+namespace profiling {
+
+// A profiler cheap enough to stay installed in production.
+//
+// Unlike BufferedProfiler, recording an event takes no lock, allocates no
+// memory and makes no system call besides reading the clock; memory usage is
+// not sampled. Timestamps come from time::MonotonicNowMicros(), so durations
+// are not skewed by changes to the system time. The intervals passed to
+// AddEvent(), timed with time::NowMicros(), are moved to that clock.
+//
+// - Each thread records into its own fixed-size buffers, allocated the first
+//   time the thread records an event. Events are kept in a ring once they
+//   end; when the ring is full the oldest events are overwritten.
+// - Each event is also folded, when it ends, into per-thread statistics keyed
+//   by tag, event type and metadata (count, total, min and max duration). The
+//   statistics do not depend on the ring, so they stay exact however long the
+//   profiler runs without being read.
+// - Only 1 in `sampling_period` top-level invokes is recorded. Events of the
+//   other invokes are rejected after a single branch.
+//
+// Events must end on the thread that began them, which is always the case for
+// ScopedProfile and the TFLITE_SCOPED_*_PROFILE macros. GetProfileEvents(),
+// GetEventStats() and Reset() may run on any thread, but not while a recorded
+// thread is inside Interpreter::Invoke().
+class SamplingProfiler : public tflite::Profiler {
+ public:
+  struct Options {
+    // Events kept per thread until read by GetProfileEvents().
+    uint32_t max_events_per_thread = 1024;
+    // Distinct (tag, type, metadata) statistics kept per thread; further
+    // ones are counted by unaggregated_events(). Should exceed the number of
+    // nodes in the profiled graphs.
+    uint32_t max_event_stats_per_thread = 512;
+    // Threads that can record events. Events from further threads are
+    // dropped. At most 64.
+    uint32_t max_threads = 8;
+    // Records 1 in `sampling_period` invokes.
+    uint32_t sampling_period = 1;
+  };
+
+  SamplingProfiler() : SamplingProfiler(Options()) {}
+  explicit SamplingProfiler(const Options& options);
+  ~SamplingProfiler() override;
+
+  uint32_t BeginEvent(const char* tag, EventType event_type,
+                      int64_t event_metadata1,
+                      int64_t event_metadata2) override;
+
+  void EndEvent(uint32_t event_handle) override;
+
+  void EndEvent(uint32_t event_handle, int64_t event_metadata1,
+                int64_t event_metadata2) override;
+
+  // `start` and `end` are in microseconds, as for BufferedProfiler.
+  void AddEvent(const char* tag, EventType event_type, uint64_t start,
+                uint64_t end, int64_t event_metadata1,
+                int64_t event_metadata2) override;
+
+  // Profiling is enabled on construction.
+  void StartProfiling() { enabled_.store(true, std::memory_order_relaxed); }
+  void StopProfiling() { enabled_.store(false, std::memory_order_relaxed); }
+
+  // Clears the recorded events and statistics.
+  void Reset();
+
+  // Returns the events that ended since the previous call, with timestamps in
+  // microseconds, as expected by ProfileSummarizer::ProcessProfiles(). The
+  // events stay valid until the next call.
+  std::vector<const ProfileEvent*> GetProfileEvents();
+
+  // Returns the statistics of all the events recorded since construction or
+  // the last Reset(), merged across threads. The result can be passed to
+  // ProfileSummarizer::ProcessEventStats().
+  std::vector<ProfileEventStats> GetEventStats() const;
+
+  // Number of top-level invokes that were recorded.
+  uint64_t num_sampled_invokes() const {
+    return num_sampled_invokes_.load(std::memory_order_relaxed);
+  }
+
+  // Number of events that are missing from GetProfileEvents(), because they
+  // were overwritten before being read, or because too many events were open
+  // at once or too many threads recorded events. Only the last two also
+  // leave them out of GetEventStats().
+  uint64_t dropped_events() const;
+
+  // Number of events that are missing from GetEventStats() only, because the
+  // statistics of their thread were full.
+  uint64_t unaggregated_events() const;
+
+ private:
+  struct Event;
+  struct OpenEvent;
+  struct Stats;
+  struct ThreadBuffer;
+
+  ThreadBuffer* GetThreadBuffer();
+  ThreadBuffer* RegisterThread();
+  void EndEvent(uint32_t event_handle, const int64_t* event_metadata1,
+                const int64_t* event_metadata2);
+  // Adds a finished event to the ring and statistics of `buffer`. `depth`
+  // orders it after the events it is nested in.
+  void Record(ThreadBuffer* buffer, const char* tag, EventType event_type,
+              int64_t event_metadata1, int64_t event_metadata2,
+              uint64_t begin_us, uint64_t end_us, int depth);
+
+  const Options options_;
+  // Identifies this profiler in the per-thread buffer cache.
+  const uint64_t id_;
+  std::atomic<bool> enabled_;
+  std::atomic<uint64_t> num_invokes_;
+  std::atomic<uint64_t> num_sampled_invokes_;
+  // Events of threads beyond `max_threads`.
+  std::atomic<uint64_t> dropped_thread_events_;
+  // Threads that asked for a buffer, including the ones that did not get one.
+  std::atomic<uint32_t> num_threads_;
+  std::unique_ptr<std::atomic<ThreadBuffer*>[]> threads_;
+  // Storage for the result of GetProfileEvents().
+  std::vector<ProfileEvent> profile_events_;
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_SAMPLING_PROFILER_H_
@@ -0,0 +1,252 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/sampling_profiler.h"
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/profiling/time.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+using EventType = Profiler::EventType;
+
+// Mimics Subgraph::Invoke(): an "Invoke" event around one event per node.
+void RunInvoke(Profiler* profiler, int num_nodes) {
+  ScopedProfile invoke(profiler, "Invoke");
+  for (int node = 0; node < num_nodes; ++node) {
+    TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(profiler, "Op", node);
+  }
+}
+
+const ProfileEventStats* FindStats(const std::vector<ProfileEventStats>& stats,
+                                   const std::string& tag,
+                                   int64_t event_metadata) {
+  for (const auto& s : stats) {
+    if (s.tag == tag && s.event_metadata == event_metadata) return &s;
+  }
+  return nullptr;
+}
+
+TEST(SamplingProfilerTest, CollectsNestedEvents) {
+  SamplingProfiler profiler;
+  {
+    ScopedProfile parent(&profiler, "Parent");
+    ScopedProfile child(&profiler, "Child");
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  auto events = profiler.GetProfileEvents();
+  ASSERT_EQ(2, events.size());
+  EXPECT_EQ("Parent", events[0]->tag);
+  EXPECT_EQ("Child", events[1]->tag);
+  EXPECT_GE(events[0]->end_timestamp_us, events[1]->end_timestamp_us);
+  EXPECT_GE(events[1]->end_timestamp_us - events[1]->begin_timestamp_us,
+            10000);
+
+  // Events are only returned once.
+  EXPECT_EQ(0, profiler.GetProfileEvents().size());
+  EXPECT_EQ(0, profiler.dropped_events());
+}
+
+TEST(SamplingProfilerTest, StatsSurviveRingOverflow) {
+  SamplingProfiler::Options options;
+  options.max_events_per_thread = 4;
+  SamplingProfiler profiler(options);
+  for (int i = 0; i < 10; ++i) {
+    RunInvoke(&profiler, /*num_nodes=*/1);
+  }
+  // 10 "Invoke" and 10 "Op" events, of which the ring keeps the last 4.
+  EXPECT_EQ(4, profiler.GetProfileEvents().size());
+  EXPECT_EQ(16, profiler.dropped_events());
+
+  const auto stats = profiler.GetEventStats();
+  ASSERT_EQ(2, stats.size());
+  const auto* op = FindStats(stats, "Op", 0);
+  ASSERT_NE(op, nullptr);
+  EXPECT_EQ(10, op->count);
+  EXPECT_EQ(EventType::OPERATOR_INVOKE_EVENT, op->event_type);
+  EXPECT_LE(op->min_us, op->max_us);
+  EXPECT_LE(op->max_us, op->total_us);
+  const auto* invoke = FindStats(stats, "Invoke", 0);
+  ASSERT_NE(invoke, nullptr);
+  EXPECT_EQ(10, invoke->count);
+  EXPECT_GE(invoke->total_us, op->total_us);
+}
+
+TEST(SamplingProfilerTest, SamplesInvokes) {
+  SamplingProfiler::Options options;
+  options.sampling_period = 3;
+  SamplingProfiler profiler(options);
+  for (int i = 0; i < 9; ++i) {
+    RunInvoke(&profiler, /*num_nodes=*/2);
+  }
+  EXPECT_EQ(3, profiler.num_sampled_invokes());
+  // 3 sampled invokes with 2 nodes each.
+  EXPECT_EQ(9, profiler.GetProfileEvents().size());
+  const auto stats = profiler.GetEventStats();
+  ASSERT_NE(FindStats(stats, "Op", 1), nullptr);
+  EXPECT_EQ(3, FindStats(stats, "Op", 1)->count);
+  EXPECT_EQ(0, profiler.dropped_events());
+
+  // Events outside of invokes are always recorded.
+  { ScopedProfile profile(&profiler, "AllocateTensors"); }
+  EXPECT_EQ(1, profiler.GetProfileEvents().size());
+}
+
+TEST(SamplingProfilerTest, NestedInvokesFollowTheOutermostOne) {
+  SamplingProfiler::Options options;
+  options.sampling_period = 2;
+  SamplingProfiler profiler(options);
+  for (int i = 0; i < 4; ++i) {
+    ScopedProfile invoke(&profiler, "Invoke");
+    RunInvoke(&profiler, /*num_nodes=*/1);
+  }
+  EXPECT_EQ(2, profiler.num_sampled_invokes());
+  const auto stats = profiler.GetEventStats();
+  ASSERT_NE(FindStats(stats, "Invoke", 0), nullptr);
+  EXPECT_EQ(4, FindStats(stats, "Invoke", 0)->count);
+  ASSERT_NE(FindStats(stats, "Op", 0), nullptr);
+  EXPECT_EQ(2, FindStats(stats, "Op", 0)->count);
+}
+
+TEST(SamplingProfilerTest, EndEventMetadataKeysStats) {
+  SamplingProfiler profiler;
+  Profiler* p = &profiler;
+  for (int i = 0; i < 3; ++i) {
+    const uint32_t handle = p->BeginEvent("Delegate", EventType::DEFAULT, 0);
+    p->EndEvent(handle, /*event_metadata1=*/i % 2, /*event_metadata2=*/0);
+  }
+  const auto stats = profiler.GetEventStats();
+  ASSERT_EQ(2, stats.size());
+  EXPECT_EQ(2, FindStats(stats, "Delegate", 0)->count);
+  EXPECT_EQ(1, FindStats(stats, "Delegate", 1)->count);
+}
+
+TEST(SamplingProfilerTest, AddEvent) {
+  SamplingProfiler profiler;
+  Profiler* p = &profiler;
+  const uint64_t min_begin_us = time::MonotonicNowMicros() - 1000;
+  const uint64_t start_us = time::NowMicros() - 1000;
+  p->AddEvent("Kernel", EventType::DELEGATE_OPERATOR_INVOKE_EVENT, start_us,
+              start_us + 50, /*event_metadata=*/7);
+  const uint64_t max_begin_us = time::MonotonicNowMicros() - 1000;
+  auto events = profiler.GetProfileEvents();
+  ASSERT_EQ(1, events.size());
+  // Moved to the clock of the events timed by the profiler, give or take the
+  // truncation of both clocks to microseconds.
+  EXPECT_GE(events[0]->begin_timestamp_us + 2, min_begin_us);
+  EXPECT_LE(events[0]->begin_timestamp_us, max_begin_us + 2);
+  EXPECT_EQ(50, events[0]->end_timestamp_us - events[0]->begin_timestamp_us);
+  EXPECT_EQ(7, events[0]->event_metadata);
+  const auto stats = profiler.GetEventStats();
+  ASSERT_EQ(1, stats.size());
+  EXPECT_EQ(50, stats[0].total_us);
+}
+
+TEST(SamplingProfilerTest, RuntimeInstrumentationEventsAreIgnored) {
+  SamplingProfiler profiler;
+  Profiler* p = &profiler;
+  p->AddEvent("Status", EventType::GENERAL_RUNTIME_INSTRUMENTATION_EVENT,
+              /*start=*/0, /*end=*/1, /*event_metadata=*/2);
+  p->EndEvent(p->BeginEvent(
+      "Status", EventType::GENERAL_RUNTIME_INSTRUMENTATION_EVENT, 0));
+  EXPECT_EQ(0, profiler.GetProfileEvents().size());
+  EXPECT_EQ(0, profiler.GetEventStats().size());
+}
+
+TEST(SamplingProfilerTest, StopProfiling) {
+  SamplingProfiler profiler;
+  profiler.StopProfiling();
+  RunInvoke(&profiler, /*num_nodes=*/2);
+  EXPECT_EQ(0, profiler.GetProfileEvents().size());
+  EXPECT_EQ(0, profiler.num_sampled_invokes());
+  profiler.StartProfiling();
+  RunInvoke(&profiler, /*num_nodes=*/2);
+  EXPECT_EQ(3, profiler.GetProfileEvents().size());
+}
+
+TEST(SamplingProfilerTest, Reset) {
+  SamplingProfiler profiler;
+  RunInvoke(&profiler, /*num_nodes=*/2);
+  profiler.Reset();
+  EXPECT_EQ(0, profiler.GetProfileEvents().size());
+  EXPECT_EQ(0, profiler.GetEventStats().size());
+  EXPECT_EQ(0, profiler.num_sampled_invokes());
+}
+
+TEST(SamplingProfilerTest, MergesThreads) {
+  SamplingProfiler profiler;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&profiler]() {
+      for (int i = 0; i < 100; ++i) {
+        RunInvoke(&profiler, /*num_nodes=*/3);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(400, profiler.num_sampled_invokes());
+  const auto stats = profiler.GetEventStats();
+  ASSERT_EQ(4, stats.size());
+  for (int node = 0; node < 3; ++node) {
+    ASSERT_NE(FindStats(stats, "Op", node), nullptr);
+    EXPECT_EQ(400, FindStats(stats, "Op", node)->count);
+  }
+  EXPECT_EQ(0, profiler.unaggregated_events());
+}
+
+TEST(SamplingProfilerTest, DropsEventsOfExtraThreads) {
+  SamplingProfiler::Options options;
+  options.max_threads = 1;
+  SamplingProfiler profiler(options);
+  RunInvoke(&profiler, /*num_nodes=*/1);
+  std::thread([&profiler]() { RunInvoke(&profiler, /*num_nodes=*/1); })
+      .join();
+  EXPECT_EQ(2, profiler.dropped_events());
+  ASSERT_NE(FindStats(profiler.GetEventStats(), "Op", 0), nullptr);
+  EXPECT_EQ(1, FindStats(profiler.GetEventStats(), "Op", 0)->count);
+}
+
+TEST(SamplingProfilerTest, CountsUnaggregatedEvents) {
+  SamplingProfiler::Options options;
+  options.max_event_stats_per_thread = 2;
+  SamplingProfiler profiler(options);
+  RunInvoke(&profiler, /*num_nodes=*/3);
+  EXPECT_EQ(2, profiler.GetEventStats().size());
+  EXPECT_EQ(2, profiler.unaggregated_events());
+  EXPECT_EQ(4, profiler.GetProfileEvents().size());
+}
+
+TEST(SamplingProfilerTest, SeveralProfilersOnOneThread) {
+  SamplingProfiler first;
+  SamplingProfiler second;
+  for (int i = 0; i < 3; ++i) {
+    RunInvoke(&first, /*num_nodes=*/1);
+    RunInvoke(&second, /*num_nodes=*/2);
+  }
+  EXPECT_EQ(6, first.GetProfileEvents().size());
+  EXPECT_EQ(9, second.GetProfileEvents().size());
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
@@ -35,6 +35,13 @@ uint64_t NowMicros() {
           .count());
 }
 
+uint64_t MonotonicNowMicros() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
 void SleepForMicros(uint64_t micros) {
   std::this_thread::sleep_for(std::chrono::microseconds(micros));
 }
@@ -47,6 +54,18 @@ uint64_t NowMicros() {
   return static_cast<uint64_t>(tv.tv_sec) * 1e6 + tv.tv_usec;
 }
 
+uint64_t MonotonicNowMicros() {
+#if defined(CLOCK_MONOTONIC_RAW)
+  // Not slewed by NTP either.
+  const clockid_t clock_id = CLOCK_MONOTONIC_RAW;
+#else
+  const clockid_t clock_id = CLOCK_MONOTONIC;
+#endif
+  timespec now;
+  clock_gettime(clock_id, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
 void SleepForMicros(uint64_t micros) {
   timespec sleep_time;
   sleep_time.tv_sec = micros / 1e6;
@@ -21,6 +21,9 @@ namespace tflite {
 namespace profiling {
 namespace time {
 uint64_t NowMicros();
+// Microseconds from a clock that is not affected by changes to the system
+// time, e.g. by NTP. Only differences between its values are meaningful.
+uint64_t MonotonicNowMicros();
 void SleepForMicros(uint64_t micros);
 }  // namespace time
 }  // namespace profiling
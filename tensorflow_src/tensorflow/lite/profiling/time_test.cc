@@ -27,6 +27,15 @@ TEST(TimeTest, NowMicros) {
   EXPECT_GE(now1, now0);
 }
 
+TEST(TimeTest, MonotonicNowMicros) {
+  auto now0 = MonotonicNowMicros();
+  auto now1 = MonotonicNowMicros();
+  EXPECT_GE(now1, now0);
+  SleepForMicros(1000);
+  auto now2 = MonotonicNowMicros();
+  EXPECT_GT(now2, now1);
+}
+
 TEST(TimeTest, SleepForMicros) {
   // A zero sleep shouldn't cause issues.
   SleepForMicros(0);
@@ -114,7 +114,17 @@ TfLiteStatus SimpleMemoryArena::Deallocate(
 TfLiteStatus SimpleMemoryArena::Commit(TfLiteContext* context) {
   size_t required_size = RequiredBufferSize();
   if (required_size > underlying_buffer_size_) {
-    char* new_alloc = new char[required_size];
+    char* new_alloc =
+        buffer_allocator_
+            ? static_cast<char*>(
+                  buffer_allocator_->Allocate(required_size, arena_alignment_))
+            : new char[required_size];
+    if (new_alloc == nullptr) {
+      TF_LITE_KERNEL_LOG(context,
+                         "Failed to allocate %zu bytes for the memory arena.",
+                         required_size);
+      return kTfLiteError;
+    }
     char* new_underlying_buffer_aligned_ptr = reinterpret_cast<char*>(
         AlignTo(arena_alignment_, reinterpret_cast<intptr_t>(new_alloc)));
 
@@ -123,14 +133,15 @@ TfLiteStatus SimpleMemoryArena::Commit(TfLiteContext* context) {
     // memory block.
     if (high_water_mark_ > 0 && underlying_buffer_size_ > 0) {
       size_t copy_amount = std::min(
-          underlying_buffer_.get() + underlying_buffer_size_ -
+          underlying_buffer_ + underlying_buffer_size_ -
               underlying_buffer_aligned_ptr_,
           new_alloc + required_size - new_underlying_buffer_aligned_ptr);
       memcpy(new_underlying_buffer_aligned_ptr, underlying_buffer_aligned_ptr_,
              copy_amount);
     }
 
-    underlying_buffer_.reset(new_alloc);
+    FreeBuffer(underlying_buffer_);
+    underlying_buffer_ = new_alloc;
     underlying_buffer_size_ = required_size;
     underlying_buffer_aligned_ptr_ = new_underlying_buffer_aligned_ptr;
   }
@@ -164,8 +175,18 @@ TfLiteStatus SimpleMemoryArena::ReleaseBuffer() {
   committed_ = false;
   underlying_buffer_size_ = 0;
   underlying_buffer_aligned_ptr_ = nullptr;
-  underlying_buffer_.reset();
+  FreeBuffer(underlying_buffer_);
+  underlying_buffer_ = nullptr;
   return kTfLiteOk;
 }
 
+void SimpleMemoryArena::FreeBuffer(char* buffer) {
+  if (buffer == nullptr) return;
+  if (buffer_allocator_) {
+    buffer_allocator_->Deallocate(buffer);
+  } else {
+    delete[] buffer;
+  }
+}
+
 }  // namespace tflite
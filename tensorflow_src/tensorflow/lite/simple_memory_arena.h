@@ -54,6 +54,21 @@ struct ArenaAllocWithUsageInterval {
   }
 };
 
+// Source of the underlying buffers of SimpleMemoryArena, to place arenas in
+// externally managed memory instead of the heap, e.g. hugepages, shared memory
+// or a region shared by several interpreters (see ArenaMemoryPool).
+class ArenaBufferAllocator {
+ public:
+  virtual ~ArenaBufferAllocator() {}
+
+  // Returns a buffer of at least `size` bytes aligned to `alignment`, or
+  // nullptr if out of memory.
+  virtual void* Allocate(size_t size, size_t alignment) = 0;
+
+  // Returns a buffer obtained from Allocate().
+  virtual void Deallocate(void* buffer) = 0;
+};
+
 // This small class is responsible for allocating, deallocating and reusing
 // dynamic memory from a common underlying buffer. The arena can be used in
 // scenarios when the pattern of memory allocations and deallocations is
@@ -61,12 +76,22 @@ struct ArenaAllocWithUsageInterval {
 // zero-sized allocations are explicitly allowed, and will resolve to null.
 class SimpleMemoryArena {
  public:
-  explicit SimpleMemoryArena(size_t arena_alignment)
+  // The underlying buffer comes from `buffer_allocator` if not null, which
+  // must then outlive the arena, and from the heap otherwise.
+  explicit SimpleMemoryArena(size_t arena_alignment,
+                             ArenaBufferAllocator* buffer_allocator = nullptr)
       : committed_(false),
         arena_alignment_(arena_alignment),
         high_water_mark_(0),
+        buffer_allocator_(buffer_allocator),
+        underlying_buffer_(nullptr),
         underlying_buffer_size_(0),
+        underlying_buffer_aligned_ptr_(nullptr),
         ordered_allocs_() {}
+  ~SimpleMemoryArena() { FreeBuffer(underlying_buffer_); }
+
+  SimpleMemoryArena(const SimpleMemoryArena&) = delete;
+  SimpleMemoryArena& operator=(const SimpleMemoryArena&) = delete;
 
   // Schedule memory allocation for a tensor with a given size, assuming that it
   // needs to be allocated before the execution of first_node, and deallocated
@@ -108,10 +133,14 @@ class SimpleMemoryArena {
   }
 
  private:
+  // Returns `buffer` to wherever it was allocated from.
+  void FreeBuffer(char* buffer);
+
   bool committed_;
   size_t arena_alignment_;
   size_t high_water_mark_;
-  std::unique_ptr<char[]> underlying_buffer_;
+  ArenaBufferAllocator* buffer_allocator_;
+  char* underlying_buffer_;
   size_t underlying_buffer_size_;
   char* underlying_buffer_aligned_ptr_;
   std::vector<ArenaAllocWithUsageInterval> ordered_allocs_;
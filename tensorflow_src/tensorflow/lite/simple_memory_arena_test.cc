@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/simple_memory_arena.h"
 
+#include <cstdint>
+#include <vector>
+
 #include <gtest/gtest.h>
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/testing/util.h"
@@ -156,6 +159,56 @@ TEST(SimpleMemoryArenaTest, TestClearBuffer) {
   EXPECT_NE(resolved_ptr, nullptr);
 }
 
+// Hands out buffers from a fixed region, one after the other, and records the
+// buffers returned.
+class RegionAllocator : public ArenaBufferAllocator {
+ public:
+  void* Allocate(size_t size, size_t alignment) override {
+    if (next_ + size > sizeof(region_)) return nullptr;
+    void* buffer = region_ + next_;
+    next_ += (size + alignment - 1) / alignment * alignment;
+    return buffer;
+  }
+  void Deallocate(void* buffer) override { released_.push_back(buffer); }
+
+  alignas(64) char region_[16384];
+  size_t next_ = 0;
+  std::vector<void*> released_;
+};
+
+TEST(SimpleMemoryArenaTest, TestExternalBufferAllocator) {
+  TfLiteContext context;
+  context.ReportError = ReportError;
+  RegionAllocator allocator;
+  ArenaAllocWithUsageInterval allocs[3];
+  {
+    SimpleMemoryArena arena(64, &allocator);
+    arena.Allocate(&context, 32, 1024, 0, 0, 2, &allocs[0]);
+    ASSERT_EQ(arena.Commit(&context), kTfLiteOk);
+    EXPECT_EQ(arena.BasePointer(),
+              reinterpret_cast<std::intptr_t>(allocator.region_));
+    char* resolved_ptr = nullptr;
+    ASSERT_EQ(arena.ResolveAlloc(&context, allocs[0], &resolved_ptr),
+              kTfLiteOk);
+    resolved_ptr[0] = 42;
+
+    // Growing moves the contents to a new buffer and returns the old one.
+    arena.Allocate(&context, 32, 4096, 1, 1, 2, &allocs[1]);
+    ASSERT_EQ(arena.Commit(&context), kTfLiteOk);
+    ASSERT_EQ(allocator.released_.size(), 1);
+    EXPECT_EQ(allocator.released_[0], allocator.region_);
+    ASSERT_EQ(arena.ResolveAlloc(&context, allocs[0], &resolved_ptr),
+              kTfLiteOk);
+    EXPECT_EQ(resolved_ptr[0], 42);
+
+    // Fails cleanly once the allocator runs out of memory.
+    arena.Allocate(&context, 32, 16384, 2, 1, 2, &allocs[2]);
+    EXPECT_EQ(arena.Commit(&context), kTfLiteError);
+  }
+  // The arena returns its buffer when destroyed.
+  EXPECT_EQ(allocator.released_.size(), 2);
+}
+
 // Test parameterized by whether ClearBuffer() is called before ClearPlan(), or
 // vice versa.
 class BufferAndPlanClearingTest : public ::testing::Test,
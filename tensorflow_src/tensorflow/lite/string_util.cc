@@ -26,9 +26,14 @@ limitations under the License.
 
 namespace tflite {
 
+void DynamicBuffer::Reserve(size_t num_strings, size_t num_bytes) {
+  offset_.reserve(offset_.size() + num_strings);
+  data_.reserve(data_.size() + num_bytes);
+}
+
 void DynamicBuffer::AddString(const char* str, size_t len) {
-  data_.resize(data_.size() + len);
-  memcpy(data_.data() + offset_.back(), str, len);
+  // Append in one pass instead of zero-filling via resize() and then copying.
+  data_.insert(data_.end(), str, str + len);
   offset_.push_back(offset_.back() + len);
 }
 
@@ -68,55 +73,84 @@ void DynamicBuffer::AddJoinedString(const std::vector<StringRef>& strings,
   offset_.push_back(offset_.back() + total_len);
 }
 
-int DynamicBuffer::WriteToBuffer(char** buffer) {
-  // Allocate sufficient memory to tensor buffer.
+int32_t DynamicBuffer::GetBufferSize() const {
   int32_t num_strings = offset_.size() - 1;
   // Total bytes include:
   //   * size of content (data_.size)
   //   * offset of each tensor (sizeof(int32_t) * num_strings)
   //   * length of whole buffer (int32_t)
   //   * num of strings (int32_t).
-  int32_t bytes = data_.size()                            // size of content
-                  + sizeof(int32_t) * (num_strings + 2);  // size of header
+  return data_.size()                            // size of content
+         + sizeof(int32_t) * (num_strings + 2);  // size of header
+}
 
-  // Caller will take ownership of buffer.
-  *buffer = reinterpret_cast<char*>(malloc(bytes));
+void DynamicBuffer::FillBuffer(char* buffer) const {
+  int32_t num_strings = offset_.size() - 1;
 
   // Set num of string
-  memcpy(*buffer, &num_strings, sizeof(int32_t));
+  memcpy(buffer, &num_strings, sizeof(int32_t));
 
   // Set offset of strings.
   int32_t start = sizeof(int32_t) * (num_strings + 2);
   for (size_t i = 0; i < offset_.size(); i++) {
     int32_t offset = start + offset_[i];
-    memcpy(*buffer + sizeof(int32_t) * (i + 1), &offset, sizeof(int32_t));
+    memcpy(buffer + sizeof(int32_t) * (i + 1), &offset, sizeof(int32_t));
   }
 
   // Copy data of strings.
-  memcpy(*buffer + start, data_.data(), data_.size());
+  memcpy(buffer + start, data_.data(), data_.size());
+}
+
+int DynamicBuffer::WriteToBuffer(char** buffer) {
+  // Allocate sufficient memory to tensor buffer.
+  int32_t bytes = GetBufferSize();
+
+  // Caller will take ownership of buffer.
+  *buffer = reinterpret_cast<char*>(malloc(bytes));
+  if (*buffer == nullptr) return -1;
+  FillBuffer(*buffer);
   return bytes;
 }
 
 #ifndef TF_LITE_STATIC_MEMORY
-void DynamicBuffer::WriteToTensorAsVector(TfLiteTensor* tensor) {
+TfLiteStatus DynamicBuffer::WriteToTensorAsVector(TfLiteTensor* tensor) {
   auto dims = TfLiteIntArrayCreate(1);
   dims->data[0] = offset_.size() - 1;  // Store number of strings.
-  WriteToTensor(tensor, dims);
+  return WriteToTensor(tensor, dims);
 }
 
-void DynamicBuffer::WriteToTensor(TfLiteTensor* tensor,
-                                  TfLiteIntArray* new_shape) {
-  char* tensor_buffer;
-  int bytes = WriteToBuffer(&tensor_buffer);
-
+TfLiteStatus DynamicBuffer::WriteToTensor(TfLiteTensor* tensor,
+                                          TfLiteIntArray* new_shape) {
   if (new_shape == nullptr) {
     new_shape = TfLiteIntArrayCopy(tensor->dims);
   }
 
+  if (tensor->allocation_type == kTfLiteDynamic) {
+    // Serialize straight into the tensor's own buffer. TfLiteTensorRealloc
+    // never shrinks the allocation, so it carries over to the next invocation
+    // instead of being freed and malloc'ed again.
+    if (TfLiteTensorRealloc(GetBufferSize(), tensor) != kTfLiteOk) {
+      TfLiteIntArrayFree(new_shape);
+      return kTfLiteError;
+    }
+    FillBuffer(tensor->data.raw);
+    TfLiteIntArrayFree(tensor->dims);
+    tensor->dims = new_shape;
+    return kTfLiteOk;
+  }
+
+  char* tensor_buffer;
+  int bytes = WriteToBuffer(&tensor_buffer);
+  if (bytes < 0) {
+    TfLiteIntArrayFree(new_shape);
+    return kTfLiteError;
+  }
+
   // Set tensor content pointer to tensor_buffer, and release original data.
   TfLiteTensorReset(tensor->type, tensor->name, new_shape, tensor->params,
-                    tensor_buffer, bytes, kTfLiteDynamic, tensor->allocation,
+                    tensor_buffer, bytes, kTfLiteDynamic, nullptr,
                     tensor->is_variable, tensor);
+  return kTfLiteOk;
 }
 #endif  // TF_LITE_STATIC_MEMORY
 
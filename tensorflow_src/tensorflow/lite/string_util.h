@@ -64,6 +64,10 @@ class DynamicBuffer {
  public:
   DynamicBuffer() : offset_({0}) {}
 
+  // Reserve room for `num_strings` strings holding `num_bytes` bytes of
+  // content in total, so that subsequent AddString calls don't reallocate.
+  void Reserve(size_t num_strings, size_t num_bytes);
+
   // Add string to dynamic buffer by resizing the buffer and copying the data.
   void AddString(const StringRef& string);
 
@@ -76,7 +80,8 @@ class DynamicBuffer {
   void AddJoinedString(const std::vector<StringRef>& strings,
                        StringRef separator);
 
-  // Fill content into a buffer and returns the number of bytes stored.
+  // Fill content into a buffer and returns the number of bytes stored, or -1
+  // if the buffer cannot be allocated.
   // The function allocates space for the buffer but does NOT take ownership.
   int WriteToBuffer(char** buffer);
 
@@ -84,12 +89,23 @@ class DynamicBuffer {
   // must match the number of strings in this object. Caller relinquishes
   // ownership of new_shape. If 'new_shape' is nullptr, keep the tensor's
   // existing shape.
-  void WriteToTensor(TfLiteTensor* tensor, TfLiteIntArray* new_shape);
+  // If the tensor is already dynamic its buffer is reused (and only grown when
+  // needed), so repeated invocations don't allocate a fresh buffer each time.
+  // Returns kTfLiteError, leaving the tensor unchanged, if the data cannot be
+  // allocated.
+  TfLiteStatus WriteToTensor(TfLiteTensor* tensor, TfLiteIntArray* new_shape);
 
   // Fill content into a string tensor. Set shape to {num_strings}.
-  void WriteToTensorAsVector(TfLiteTensor* tensor);
+  TfLiteStatus WriteToTensorAsVector(TfLiteTensor* tensor);
 
  private:
+  // Returns the number of bytes needed to serialize this object.
+  int32_t GetBufferSize() const;
+
+  // Serialize header and content into 'buffer', which must hold at least
+  // GetBufferSize() bytes.
+  void FillBuffer(char* buffer) const;
+
   // Data buffer to store contents of strings, not including headers.
   std::vector<char> data_;
   // Offset of the starting index of each string in data buffer.
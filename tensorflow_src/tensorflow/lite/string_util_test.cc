@@ -194,6 +194,63 @@ TEST(StringUtil, TestShapes) {
   EXPECT_EQ(t0->dims->data[1], 2);
 }
 
+TEST(StringUtil, TestWriteToTensorReusesDynamicBuffer) {
+  Interpreter interpreter;
+  interpreter.AddTensors(1);
+  TfLiteTensor* t0 = interpreter.tensor(0);
+  t0->type = kTfLiteString;
+  t0->allocation_type = kTfLiteDynamic;
+
+  DynamicBuffer buf0;
+  buf0.Reserve(2, 7);
+  buf0.AddString("ABC", 3);
+  buf0.AddString("DEFG", 4);
+  buf0.WriteToTensorAsVector(t0);
+  ASSERT_EQ(t0->bytes, 23);
+  const char* data = t0->data.raw;
+
+  // A smaller payload is written into the same allocation.
+  DynamicBuffer buf1;
+  buf1.AddString("X", 1);
+  buf1.WriteToTensorAsVector(t0);
+  EXPECT_EQ(t0->data.raw, data);
+  ASSERT_EQ(t0->bytes, 13);
+  ASSERT_EQ(t0->dims->size, 1);
+  EXPECT_EQ(t0->dims->data[0], 1);
+  ASSERT_EQ(GetStringCount(t0), 1);
+  StringRef str_ref = GetString(t0, 0);
+  EXPECT_EQ(string(str_ref.str, str_ref.len), "X");
+}
+
+TEST(StringUtil, TestWriteToTensorKeepsPooledBuffer) {
+  Interpreter interpreter;
+  interpreter.EnableDynamicMemoryPool();
+  interpreter.AddTensors(1);
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(0, kTfLiteString, "", {2},
+                                                     TfLiteQuantization()),
+            kTfLiteOk);
+  TfLiteTensor* t0 = interpreter.tensor(0);
+
+  DynamicBuffer buf0;
+  buf0.AddString("ABC", 3);
+  buf0.AddString("DEFG", 4);
+  ASSERT_EQ(buf0.WriteToTensorAsVector(t0), kTfLiteOk);
+  const char* data = t0->data.raw;
+
+  // The pool keeps the capacity of the buffer after shrinking it, so growing
+  // back to the earlier size still fits.
+  DynamicBuffer buf1;
+  buf1.AddString("X", 1);
+  ASSERT_EQ(buf1.WriteToTensorAsVector(t0), kTfLiteOk);
+  EXPECT_EQ(t0->data.raw, data);
+  ASSERT_EQ(buf0.WriteToTensorAsVector(t0), kTfLiteOk);
+  EXPECT_EQ(t0->data.raw, data);
+  EXPECT_EQ(t0->bytes, 23);
+  ASSERT_EQ(GetStringCount(t0), 2);
+  StringRef str_ref = GetString(t0, 1);
+  EXPECT_EQ(string(str_ref.str, str_ref.len), "DEFG");
+}
+
 }  // namespace tflite
 
 int main(int argc, char** argv) {
@@ -15,12 +15,15 @@ limitations under the License.
 
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/time.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/benchmark/load_generator.h"
 #include "tensorflow/lite/tools/logging.h"
 
 namespace tflite {
@@ -41,11 +44,29 @@ BenchmarkParams BenchmarkModel::DefaultParams() {
   params.AddParam("warmup_runs", BenchmarkParam::Create<int32_t>(1));
   params.AddParam("warmup_min_secs", BenchmarkParam::Create<float>(0.5f));
   params.AddParam("verbose", BenchmarkParam::Create<bool>(false));
+  params.AddParam("latency_output_json_file",
+                  BenchmarkParam::Create<std::string>(""));
+  params.AddParam("throttling_drift_threshold",
+                  BenchmarkParam::Create<float>(0.1f));
+  params.AddParam("num_concurrent_instances",
+                  BenchmarkParam::Create<int32_t>(0));
+  params.AddParam("concurrent_request_rates",
+                  BenchmarkParam::Create<std::string>(""));
+  params.AddParam("concurrent_arrival_process",
+                  BenchmarkParam::Create<std::string>("poisson"));
   return params;
 }
 
 BenchmarkModel::BenchmarkModel() : params_(DefaultParams()) {}
 
+void BenchmarkLoggingListener::OnBenchmarkStart(
+    const BenchmarkParams& params) {
+  if (params.HasParam("throttling_drift_threshold")) {
+    throttling_drift_threshold_ =
+        params.Get<float>("throttling_drift_threshold");
+  }
+}
+
 void BenchmarkLoggingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
   auto inference_us = results.inference_time_us();
   auto init_us = results.startup_latency_us();
@@ -58,6 +79,19 @@ void BenchmarkLoggingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
                    << "Warmup (avg): " << warmup_us.avg() << ", "
                    << "Inference (avg): " << inference_us.avg();
 
+  const LatencyStats& inference_latency_us = results.inference_latency_us();
+  if (inference_latency_us.count() > 0) {
+    std::stringstream stream;
+    inference_latency_us.OutputToStream(&stream);
+    TFLITE_LOG(INFO) << "Inference latency distribution in us: "
+                     << stream.str();
+    if (inference_latency_us.IsThrottled(throttling_drift_threshold_)) {
+      TFLITE_LOG(WARN) << "The inference latency grew by "
+                       << inference_latency_us.Drift() * 100
+                       << "% over the runs, which suggests thermal throttling.";
+    }
+  }
+
   if (!init_mem_usage.IsSupported()) return;
   TFLITE_LOG(INFO)
       << "Note: as the benchmark tool itself affects memory footprint, the "
@@ -68,6 +102,28 @@ void BenchmarkLoggingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
                    << " overall=" << overall_mem_usage.max_rss_kb / 1024.0;
 }
 
+void LatencyReportListener::OnBenchmarkEnd(const BenchmarkResults& results) {
+  std::ofstream stream(json_file_path_);
+  if (!stream) {
+    TFLITE_LOG(ERROR) << "Failed to open " << json_file_path_;
+    return;
+  }
+  stream << "{\"benchmark_name\":\"";
+  for (char c : benchmark_name_) {
+    if (c == '"' || c == '\\') stream << '\\';
+    stream << c;
+  }
+  stream << "\""
+         << ",\"init_us\":" << results.startup_latency_us()
+         << ",\"first_inference_us\":" << results.warmup_time_us().first()
+         << ",\"warmup_avg_us\":" << results.warmup_time_us().avg()
+         << ",\"inference\":";
+  results.inference_latency_us().OutputToJson(&stream,
+                                              throttling_drift_threshold_);
+  stream << "}\n";
+  TFLITE_LOG(INFO) << "Latency report written to " << json_file_path_;
+}
+
 std::vector<Flag> BenchmarkModel::GetFlags() {
   return {
       CreateFlag<int32_t>(
@@ -112,6 +168,26 @@ std::vector<Flag> BenchmarkModel::GetFlags() {
                        "Whether to log parameters whose values are not set. "
                        "By default, only log those parameters that are set by "
                        "parsing their values from the commandline flags."),
+      CreateFlag<std::string>(
+          "latency_output_json_file", &params_,
+          "File path to export the inference latency percentiles, histogram, "
+          "jitter and drift to as JSON."),
+      CreateFlag<float>(
+          "throttling_drift_threshold", &params_,
+          "Relative growth of the latency from the first to the last quarter "
+          "of the runs above which the benchmark reports thermal throttling."),
+      CreateFlag<int32_t>(
+          "num_concurrent_instances", &params_,
+          "If positive, after the regular runs, load test this many instances "
+          "of the model served concurrently, see concurrent_request_rates."),
+      CreateFlag<std::string>(
+          "concurrent_request_rates", &params_,
+          "Comma-separated offered loads in requests per second, e.g. "
+          "10,20,40, at each of which the concurrent instances are load "
+          "tested for num_runs requests, but at most max_secs."),
+      CreateFlag<std::string>(
+          "concurrent_arrival_process", &params_,
+          "How requests arrive in the load test: 'poisson' or 'fixed' rate."),
   };
 }
 
@@ -134,6 +210,16 @@ void BenchmarkModel::LogParams() {
   LOG_BENCHMARK_PARAM(int32_t, "warmup_runs", "Min warmup runs", verbose);
   LOG_BENCHMARK_PARAM(float, "warmup_min_secs",
                       "Min warmup runs duration (seconds)", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "latency_output_json_file",
+                      "Latency output JSON file", verbose);
+  LOG_BENCHMARK_PARAM(float, "throttling_drift_threshold",
+                      "Throttling drift threshold", verbose);
+  LOG_BENCHMARK_PARAM(int32_t, "num_concurrent_instances",
+                      "Num concurrent instances", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "concurrent_request_rates",
+                      "Concurrent request rates (per second)", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "concurrent_arrival_process",
+                      "Concurrent arrival process", verbose);
 }
 
 TfLiteStatus BenchmarkModel::PrepareInputData() { return kTfLiteOk; }
@@ -144,6 +230,7 @@ Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
                                   float max_secs, RunType run_type,
                                   TfLiteStatus* invoke_status) {
   Stat<int64_t> run_stats;
+  run_latency_us_ = LatencyStats();
   TFLITE_LOG(INFO) << "Running benchmark for at least " << min_num_times
                    << " iterations and at least " << min_secs << " seconds but"
                    << " terminate if exceeding " << max_secs << " seconds.";
@@ -168,6 +255,7 @@ Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
     listeners_.OnSingleRunEnd();
 
     run_stats.UpdateStat(end_us - start_us);
+    run_latency_us_.Add(end_us - start_us);
     if (run_frequency > 0) {
       inter_run_sleep_time =
           next_run_finish_time - profiling::time::NowMicros() * 1e-6;
@@ -192,6 +280,63 @@ Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
 
 TfLiteStatus BenchmarkModel::ValidateParams() { return kTfLiteOk; }
 
+TfLiteStatus BenchmarkModel::InitConcurrentInstances(int num_instances) {
+  TFLITE_LOG(ERROR) << "Concurrent instances are not supported.";
+  return kTfLiteError;
+}
+
+TfLiteStatus BenchmarkModel::RunConcurrentLoad() {
+  std::vector<double> request_rates;
+  if (!util::SplitAndParse(params_.Get<std::string>("concurrent_request_rates"),
+                           ',', &request_rates) ||
+      request_rates.empty() ||
+      *std::min_element(request_rates.begin(), request_rates.end()) <= 0) {
+    TFLITE_LOG(ERROR) << "Please specify positive offered loads in requests "
+                         "per second with --concurrent_request_rates";
+    return kTfLiteError;
+  }
+  const std::string arrival_process_name =
+      params_.Get<std::string>("concurrent_arrival_process");
+  LoadGeneratorOptions options;
+  if (!ParseArrivalProcess(arrival_process_name, &options.arrival_process)) {
+    TFLITE_LOG(ERROR) << "Unknown arrival process " << arrival_process_name
+                      << ", expected 'poisson' or 'fixed'.";
+    return kTfLiteError;
+  }
+  options.num_instances = params_.Get<int32_t>("num_concurrent_instances");
+  options.num_requests = params_.Get<int32_t>("num_runs");
+  options.max_secs = params_.Get<float>("max_secs");
+  TF_LITE_ENSURE_STATUS(InitConcurrentInstances(options.num_instances));
+
+  for (double request_rate : request_rates) {
+    options.requests_per_second = request_rate;
+    const LoadGeneratorResults results = LoadGenerator(options).Run(
+        [this](int instance) { return RunConcurrentInstance(instance); });
+    std::stringstream requests_per_instance;
+    for (int i = 0; i < results.requests_per_instance.size(); ++i) {
+      requests_per_instance << (i == 0 ? "" : ",")
+                            << results.requests_per_instance[i];
+    }
+    std::stringstream queueing_delay;
+    results.queueing_delay_us.OutputToStream(&queueing_delay);
+    std::stringstream latency;
+    results.latency_us.OutputToStream(&latency);
+    TFLITE_LOG(INFO) << "Concurrent load of " << options.num_instances
+                     << " instances, offered "
+                     << results.offered_requests_per_second << " requests/s ("
+                     << arrival_process_name << "): achieved "
+                     << results.achieved_requests_per_second
+                     << " requests/s over " << results.duration_secs
+                     << " s, requests: " << results.num_requests
+                     << ", failed: " << results.num_failed_requests
+                     << ", per instance: " << requests_per_instance.str();
+    TFLITE_LOG(INFO) << "Queueing delay in us: " << queueing_delay.str();
+    TFLITE_LOG(INFO) << "Request latency in us: " << latency.str();
+    if (results.num_failed_requests > 0) return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus BenchmarkModel::Run(int argc, char** argv) {
   TF_LITE_ENSURE_STATUS(ParseFlags(argc, argv));
   return Run();
@@ -236,9 +381,27 @@ TfLiteStatus BenchmarkModel::Run() {
   const auto overall_mem_usage =
       profiling::memory::GetMemoryUsage() - start_mem_usage;
 
-  listeners_.OnBenchmarkEnd({model_size_mb, startup_latency_us, input_bytes,
-                             warmup_time_us, inference_time_us, init_mem_usage,
-                             overall_mem_usage});
+  const BenchmarkResults results(model_size_mb, startup_latency_us, input_bytes,
+                                 warmup_time_us, inference_time_us,
+                                 init_mem_usage, overall_mem_usage,
+                                 run_latency_us_);
+  listeners_.OnBenchmarkEnd(results);
+
+  // Invoked directly rather than added to `listeners_`, where it would have to
+  // be removed again before the next Run().
+  const std::string latency_json_file =
+      params_.Get<std::string>("latency_output_json_file");
+  if (!latency_json_file.empty()) {
+    LatencyReportListener(latency_json_file,
+                          params_.Get<std::string>("benchmark_name"),
+                          params_.Get<float>("throttling_drift_threshold"))
+        .OnBenchmarkEnd(results);
+  }
+
+  if (status == kTfLiteOk &&
+      params_.Get<int32_t>("num_concurrent_instances") > 0) {
+    status = RunConcurrentLoad();
+  }
   return status;
 }
 
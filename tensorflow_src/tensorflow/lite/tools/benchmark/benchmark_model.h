@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/latency_stats.h"
 #include "tensorflow/lite/tools/command_line_flags.h"
 
 namespace tflite {
@@ -46,20 +47,26 @@ class BenchmarkResults {
                    tensorflow::Stat<int64_t> warmup_time_us,
                    tensorflow::Stat<int64_t> inference_time_us,
                    const profiling::memory::MemoryUsage& init_mem_usage,
-                   const profiling::memory::MemoryUsage& overall_mem_usage)
+                   const profiling::memory::MemoryUsage& overall_mem_usage,
+                   const LatencyStats& inference_latency_us = LatencyStats())
       : model_size_mb_(model_size_mb),
         startup_latency_us_(startup_latency_us),
         input_bytes_(input_bytes),
         warmup_time_us_(warmup_time_us),
         inference_time_us_(inference_time_us),
         init_mem_usage_(init_mem_usage),
-        overall_mem_usage_(overall_mem_usage) {}
+        overall_mem_usage_(overall_mem_usage),
+        inference_latency_us_(inference_latency_us) {}
 
   const double model_size_mb() const { return model_size_mb_; }
   tensorflow::Stat<int64_t> inference_time_us() const {
     return inference_time_us_;
   }
   tensorflow::Stat<int64_t> warmup_time_us() const { return warmup_time_us_; }
+  // Percentiles, jitter and drift of the inference latencies.
+  const LatencyStats& inference_latency_us() const {
+    return inference_latency_us_;
+  }
   int64_t startup_latency_us() const { return startup_latency_us_; }
   uint64_t input_bytes() const { return input_bytes_; }
   double throughput_MB_per_second() const {
@@ -83,6 +90,7 @@ class BenchmarkResults {
   tensorflow::Stat<int64_t> inference_time_us_;
   profiling::memory::MemoryUsage init_mem_usage_;
   profiling::memory::MemoryUsage overall_mem_usage_;
+  LatencyStats inference_latency_us_;
 };
 
 class BenchmarkListener {
@@ -153,7 +161,30 @@ class BenchmarkListeners : public BenchmarkListener {
 // Benchmark listener that just logs the results of benchmark run.
 class BenchmarkLoggingListener : public BenchmarkListener {
  public:
+  void OnBenchmarkStart(const BenchmarkParams& params) override;
   void OnBenchmarkEnd(const BenchmarkResults& results) override;
+
+ private:
+  float throttling_drift_threshold_ = 0.1f;
+};
+
+// Benchmark listener that writes the latency distribution of the inferences
+// as JSON, for tracking latency regressions.
+class LatencyReportListener : public BenchmarkListener {
+ public:
+  LatencyReportListener(const std::string& json_file_path,
+                        const std::string& benchmark_name,
+                        float throttling_drift_threshold)
+      : json_file_path_(json_file_path),
+        benchmark_name_(benchmark_name),
+        throttling_drift_threshold_(throttling_drift_threshold) {}
+
+  void OnBenchmarkEnd(const BenchmarkResults& results) override;
+
+ private:
+  const std::string json_file_path_;
+  const std::string benchmark_name_;
+  const float throttling_drift_threshold_;
 };
 
 template <typename T>
@@ -203,6 +234,7 @@ class BenchmarkModel {
   // Get the model file size if it's available.
   virtual int64_t MayGetModelFileSize() { return -1; }
   virtual uint64_t ComputeInputBytes() = 0;
+  // Also records the latencies of the runs in `run_latency_us_`.
   virtual tensorflow::Stat<int64_t> Run(int min_num_times, float min_secs,
                                         float max_secs, RunType run_type,
                                         TfLiteStatus* invoke_status);
@@ -212,8 +244,23 @@ class BenchmarkModel {
 
   virtual TfLiteStatus ResetInputsAndOutputs();
   virtual TfLiteStatus RunImpl() = 0;
+
+  // Creates `num_instances` instances of the model for the concurrent load
+  // test. RunConcurrentInstance() then runs different instances concurrently
+  // from different threads, but never a given instance concurrently.
+  virtual TfLiteStatus InitConcurrentInstances(int num_instances);
+  virtual TfLiteStatus RunConcurrentInstance(int instance) {
+    return kTfLiteError;
+  }
+  // Serves open-loop arrivals of requests at each offered load with the
+  // concurrent instances, and logs the achieved throughput, the queueing
+  // delay and the request latency.
+  TfLiteStatus RunConcurrentLoad();
+
   BenchmarkParams params_;
   BenchmarkListeners listeners_;
+  // Latencies of the runs of the last Run(min_num_times, ...) call.
+  LatencyStats run_latency_us_;
 };
 
 }  // namespace benchmark
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include <fstream>
+#include <iterator>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -392,6 +393,48 @@ TEST(BenchmarkTest, MaxDurationWorks) {
   benchmark.Run();
 }
 
+class LatencyStatsTestListener : public BenchmarkListener {
+  void OnBenchmarkEnd(const BenchmarkResults& results) override {
+    EXPECT_EQ(results.inference_time_us().count(),
+              results.inference_latency_us().count());
+    EXPECT_LE(results.inference_latency_us().Percentile(50),
+              results.inference_latency_us().Percentile(99));
+  }
+};
+
+TEST(BenchmarkTest, LatencyReportIsWritten) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  BenchmarkParams params = CreateParams();
+  const std::string file_path = CreateFilePath("/latency.json");
+  params.Set<std::string>("latency_output_json_file", file_path);
+  TestBenchmark benchmark(std::move(params));
+  LatencyStatsTestListener listener;
+  benchmark.AddListener(&listener);
+  EXPECT_EQ(kTfLiteOk, benchmark.Run());
+
+  std::ifstream file(file_path);
+  std::string report((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+  EXPECT_NE(std::string::npos, report.find("\"p99_us\""));
+}
+
+TEST(BenchmarkTest, ConcurrentLoadWorks) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  BenchmarkParams params = CreateParams();
+  params.Set<int32_t>("num_concurrent_instances", 2);
+  params.Set<std::string>("concurrent_request_rates", "100,1000");
+  TestBenchmark benchmark(std::move(params));
+  EXPECT_EQ(kTfLiteOk, benchmark.Run());
+}
+
+TEST(BenchmarkTest, ConcurrentLoadRequiresRequestRates) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  BenchmarkParams params = CreateParams();
+  params.Set<int32_t>("num_concurrent_instances", 2);
+  TestBenchmark benchmark(std::move(params));
+  EXPECT_EQ(kTfLiteError, benchmark.Run());
+}
+
 TEST(BenchmarkTest, ParametersArePopulatedWhenInputShapeIsNotSpecified) {
   ASSERT_THAT(g_fp32_model_path, testing::NotNull());
 
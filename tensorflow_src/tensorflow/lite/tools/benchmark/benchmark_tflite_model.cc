@@ -254,6 +254,8 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<int32_t>(1024));
   default_params.AddParam("profiling_output_csv_file",
                           BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("report_op_cost",
+                          BenchmarkParam::Create<bool>(false));
 
   for (const auto& delegate_provider :
        tools::GetRegisteredDelegateProviders()) {
@@ -280,6 +282,7 @@ BenchmarkTfLiteModel::~BenchmarkTfLiteModel() {
   // Destory the owned interpreter earlier than other objects (specially
   // 'owned_delegates_').
   interpreter_.reset();
+  concurrent_instances_.clear();
 }
 
 std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
@@ -314,7 +317,10 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
       CreateFlag<std::string>(
           "profiling_output_csv_file", &params_,
           "File path to export profile data as CSV, if not set "
-          "prints to stdout.")};
+          "prints to stdout."),
+      CreateFlag<bool>("report_op_cost", &params_,
+                       "report the estimated cost and achieved throughput of "
+                       "operators per node type, with op profiling")};
 
   flags.insert(flags.end(), specific_flags.begin(), specific_flags.end());
 
@@ -349,6 +355,7 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Max profiling buffer entries", verbose);
   LOG_BENCHMARK_PARAM(std::string, "profiling_output_csv_file",
                       "CSV File to export profiling data to", verbose);
+  LOG_BENCHMARK_PARAM(bool, "report_op_cost", "Report op cost", verbose);
 
   for (const auto& delegate_provider :
        tools::GetRegisteredDelegateProviders()) {
@@ -759,10 +766,78 @@ BenchmarkTfLiteModel::MayCreateProfilingListener() const {
       interpreter_.get(), params_.Get<int32_t>("max_profiling_buffer_entries"),
       params_.Get<std::string>("profiling_output_csv_file"),
       CreateProfileSummaryFormatter(
-          !params_.Get<std::string>("profiling_output_csv_file").empty())));
+          !params_.Get<std::string>("profiling_output_csv_file").empty()),
+      params_.Get<bool>("report_op_cost")));
 }
 
 TfLiteStatus BenchmarkTfLiteModel::RunImpl() { return interpreter_->Invoke(); }
 
+TfLiteStatus BenchmarkTfLiteModel::InitConcurrentInstances(int num_instances) {
+  concurrent_instances_.clear();
+  auto resolver = GetOpResolver();
+  const int32_t num_threads = params_.Get<int32_t>("num_threads");
+  const std::vector<int>& interpreter_inputs = interpreter_->inputs();
+  for (int i = 0; i < num_instances; ++i) {
+    std::unique_ptr<ConcurrentInstance> instance(new ConcurrentInstance);
+    // Instances share the model, so its weights are mapped only once, but each
+    // has its own CPU backend context: its thread pool can only serve one
+    // interpreter at a time.
+    tflite::InterpreterBuilder(*model_, *resolver)(&instance->interpreter,
+                                                   num_threads);
+    Interpreter* interpreter = instance->interpreter.get();
+    if (!interpreter) {
+      TFLITE_LOG(ERROR) << "Failed to initialize concurrent instance #" << i;
+      return kTfLiteError;
+    }
+    interpreter->SetAllowFp16PrecisionForFp32(params_.Get<bool>("allow_fp16"));
+    for (const auto& delegate_provider :
+         tools::GetRegisteredDelegateProviders()) {
+      auto delegate = delegate_provider->CreateTfLiteDelegate(params_);
+      if (delegate == nullptr) continue;
+      if (interpreter->ModifyGraphWithDelegate(delegate.get()) != kTfLiteOk) {
+        TFLITE_LOG(ERROR) << "Failed to apply " << delegate_provider->GetName()
+                          << " delegate to concurrent instance #" << i;
+        return kTfLiteError;
+      }
+      instance->delegates.emplace_back(std::move(delegate));
+    }
+
+    for (int j = 0; j < interpreter_inputs.size(); ++j) {
+      const TfLiteTensor* t = interpreter_->tensor(interpreter_inputs[j]);
+      if (t->type != kTfLiteString) {
+        interpreter->ResizeInputTensor(
+            interpreter->inputs()[j],
+            std::vector<int>(t->dims->data, t->dims->data + t->dims->size));
+      }
+    }
+    if (interpreter->AllocateTensors() != kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Failed to allocate tensors of concurrent instance #"
+                        << i;
+      return kTfLiteError;
+    }
+
+    // Copies the inputs of the last regular run.
+    for (int j = 0; j < interpreter_inputs.size(); ++j) {
+      const TfLiteTensor* t = interpreter_->tensor(interpreter_inputs[j]);
+      TfLiteTensor* instance_t = interpreter->tensor(interpreter->inputs()[j]);
+      if (t->type == kTfLiteString) {
+        tflite::DynamicBuffer buffer;
+        for (int k = 0; k < GetStringCount(t); ++k) {
+          buffer.AddString(GetString(t, k));
+        }
+        buffer.WriteToTensor(instance_t, /*new_shape=*/nullptr);
+      } else if (t->bytes == instance_t->bytes) {
+        std::memcpy(instance_t->data.raw, t->data.raw, t->bytes);
+      }
+    }
+    concurrent_instances_.push_back(std::move(instance));
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkTfLiteModel::RunConcurrentInstance(int instance) {
+  return concurrent_instances_[instance]->interpreter->Invoke();
+}
+
 }  // namespace benchmark
 }  // namespace tflite
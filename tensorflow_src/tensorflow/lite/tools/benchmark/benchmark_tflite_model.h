@@ -81,6 +81,9 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   // necessary.
   virtual std::unique_ptr<BenchmarkListener> MayCreateProfilingListener() const;
 
+  TfLiteStatus InitConcurrentInstances(int num_instances) override;
+  TfLiteStatus RunConcurrentInstance(int instance) override;
+
   void CleanUp();
 
   std::unique_ptr<tflite::FlatBufferModel> model_;
@@ -124,6 +127,16 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   std::unique_ptr<BenchmarkListener> ruy_profiling_listener_ = nullptr;
   std::mt19937 random_engine_;
   std::vector<Interpreter::TfLiteDelegatePtr> owned_delegates_;
+
+  // An interpreter of the load test, with the same delegates and inputs as
+  // `interpreter_`. The interpreter is declared last to be destroyed before
+  // its delegates.
+  struct ConcurrentInstance {
+    std::vector<Interpreter::TfLiteDelegatePtr> delegates;
+    std::unique_ptr<tflite::Interpreter> interpreter;
+  };
+  std::vector<std::unique_ptr<ConcurrentInstance>> concurrent_instances_;
+
   // Always TFLITE_LOG the benchmark result.
   BenchmarkLoggingListener log_output_;
 };
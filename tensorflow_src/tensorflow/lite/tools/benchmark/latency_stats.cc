@@ -0,0 +1,184 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/latency_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// Buckets per power of two above kExactBuckets.
+constexpr int kSubBuckets = 128;
+constexpr int kExactBuckets = 2 * kSubBuckets;
+constexpr int kMaxWindows = 64;
+
+int BitLength(uint64_t value) {
+  int length = 0;
+  while (value != 0) {
+    value >>= 1;
+    ++length;
+  }
+  return length;
+}
+
+}  // namespace
+
+int LatencyStats::BucketIndex(int64_t latency_us) {
+  if (latency_us < kExactBuckets) return std::max<int64_t>(latency_us, 0);
+  const int shift = BitLength(latency_us) - BitLength(kExactBuckets - 1);
+  return kSubBuckets + shift * kSubBuckets +
+         static_cast<int>((latency_us >> shift) - kSubBuckets);
+}
+
+int64_t LatencyStats::BucketValue(int index) const {
+  int64_t value = index;
+  if (index >= kExactBuckets) {
+    const int shift = (index - kSubBuckets) / kSubBuckets;
+    const int64_t mantissa = kSubBuckets + (index - kSubBuckets) % kSubBuckets;
+    const int64_t lower = mantissa << shift;
+    const int64_t upper = ((mantissa + 1) << shift) - 1;
+    value = lower + (upper - lower) / 2;
+  }
+  return std::min(std::max(value, min_us_), max_us_);
+}
+
+void LatencyStats::Add(int64_t latency_us) {
+  if (count_ == 0) {
+    min_us_ = latency_us;
+    max_us_ = latency_us;
+  } else {
+    min_us_ = std::min(min_us_, latency_us);
+    max_us_ = std::max(max_us_, latency_us);
+    const int64_t jitter_us = std::abs(latency_us - last_us_);
+    jitter_sum_us_ += jitter_us;
+    max_jitter_us_ = std::max(max_jitter_us_, jitter_us);
+  }
+  last_us_ = latency_us;
+  ++count_;
+  sum_us_ += latency_us;
+  squared_sum_us_ += static_cast<double>(latency_us) * latency_us;
+
+  const int index = BucketIndex(latency_us);
+  if (index >= bucket_counts_.size()) bucket_counts_.resize(index + 1, 0);
+  ++bucket_counts_[index];
+
+  window_sum_us_ += latency_us;
+  if (++window_count_ < window_size_) return;
+  window_avgs_us_.push_back(window_sum_us_ / window_count_);
+  window_sum_us_ = 0;
+  window_count_ = 0;
+  if (window_avgs_us_.size() == kMaxWindows) {
+    // Merges pairs of windows, which then cover twice as many runs.
+    for (int i = 0; i < kMaxWindows / 2; ++i) {
+      window_avgs_us_[i] =
+          (window_avgs_us_[2 * i] + window_avgs_us_[2 * i + 1]) / 2;
+    }
+    window_avgs_us_.resize(kMaxWindows / 2);
+    window_size_ *= 2;
+  }
+}
+
+double LatencyStats::avg_us() const {
+  return count_ == 0 ? 0 : sum_us_ / count_;
+}
+
+double LatencyStats::std_deviation_us() const {
+  if (count_ == 0) return 0;
+  const double avg = avg_us();
+  return std::sqrt(std::max(0.0, squared_sum_us_ / count_ - avg * avg));
+}
+
+double LatencyStats::avg_jitter_us() const {
+  return count_ < 2 ? 0 : jitter_sum_us_ / (count_ - 1);
+}
+
+int64_t LatencyStats::Percentile(double percentile) const {
+  if (count_ == 0) return 0;
+  const int64_t rank = std::max<int64_t>(
+      1, static_cast<int64_t>(std::ceil(percentile / 100.0 * count_)));
+  int64_t seen = 0;
+  for (int i = 0; i < bucket_counts_.size(); ++i) {
+    seen += bucket_counts_[i];
+    if (seen >= rank) return BucketValue(i);
+  }
+  return max_us_;
+}
+
+std::vector<LatencyStats::HistogramBin> LatencyStats::Histogram(
+    int num_bins) const {
+  std::vector<HistogramBin> bins;
+  if (count_ == 0 || num_bins <= 0) return bins;
+  const int64_t width = (max_us_ - min_us_ + num_bins) / num_bins;
+  for (int i = 0; i < num_bins; ++i) {
+    const int64_t lower_us = min_us_ + i * width;
+    bins.push_back({lower_us, lower_us + width - 1, 0});
+  }
+  for (int i = 0; i < bucket_counts_.size(); ++i) {
+    if (bucket_counts_[i] == 0) continue;
+    const int bin = std::min<int64_t>((BucketValue(i) - min_us_) / width,
+                                      num_bins - 1);
+    bins[bin].count += bucket_counts_[i];
+  }
+  return bins;
+}
+
+double LatencyStats::Drift() const {
+  const int quarter = window_avgs_us_.size() / 4;
+  if (quarter == 0) return 0;
+  double first_us = 0;
+  double last_us = 0;
+  for (int i = 0; i < quarter; ++i) {
+    first_us += window_avgs_us_[i];
+    last_us += window_avgs_us_[window_avgs_us_.size() - 1 - i];
+  }
+  return first_us > 0 ? (last_us - first_us) / first_us : 0;
+}
+
+void LatencyStats::OutputToStream(std::ostream* stream) const {
+  *stream << "count=" << count_ << " p50=" << Percentile(50)
+          << " p90=" << Percentile(90) << " p99=" << Percentile(99)
+          << " p99.9=" << Percentile(99.9) << " jitter(avg)=" << avg_jitter_us()
+          << " jitter(max)=" << max_jitter_us_ << " drift=" << Drift() * 100
+          << "%";
+}
+
+void LatencyStats::OutputToJson(std::ostream* stream, double drift_threshold,
+                                int num_bins) const {
+  *stream << "{\"count\":" << count_ << ",\"avg_us\":" << avg_us()
+          << ",\"std_deviation_us\":" << std_deviation_us()
+          << ",\"min_us\":" << min_us_ << ",\"max_us\":" << max_us_
+          << ",\"p50_us\":" << Percentile(50) << ",\"p90_us\":"
+          << Percentile(90) << ",\"p99_us\":" << Percentile(99)
+          << ",\"p99_9_us\":" << Percentile(99.9)
+          << ",\"avg_jitter_us\":" << avg_jitter_us()
+          << ",\"max_jitter_us\":" << max_jitter_us_ << ",\"drift\":" << Drift()
+          << ",\"throttled\":"
+          << (IsThrottled(drift_threshold) ? "true" : "false")
+          << ",\"histogram\":[";
+  const std::vector<HistogramBin> bins = Histogram(num_bins);
+  for (int i = 0; i < bins.size(); ++i) {
+    *stream << (i == 0 ? "" : ",") << "{\"lower_us\":" << bins[i].lower_us
+            << ",\"upper_us\":" << bins[i].upper_us
+            << ",\"count\":" << bins[i].count << "}";
+  }
+  *stream << "]}";
+}
+
+}  // namespace benchmark
+}  // namespace tflite
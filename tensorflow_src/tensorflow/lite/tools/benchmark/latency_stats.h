@@ -0,0 +1,105 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_LATENCY_STATS_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_LATENCY_STATS_H_
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace tflite {
+namespace benchmark {
+
+// Distribution of the latencies of a sequence of runs: percentiles, a
+// histogram, the jitter between consecutive runs and the drift of the latency
+// over the runs, e.g. when the device throttles during a long benchmark.
+//
+// Memory does not grow with the number of runs: latencies are counted in
+// buckets that are exact below 256us and 1/128 wide relative to their values
+// above, and the drift is measured on at most 64 averages of consecutive runs.
+class LatencyStats {
+ public:
+  struct HistogramBin {
+    int64_t lower_us;
+    int64_t upper_us;
+    int64_t count;
+  };
+
+  void Add(int64_t latency_us);
+
+  int64_t count() const { return count_; }
+  int64_t min_us() const { return min_us_; }
+  int64_t max_us() const { return max_us_; }
+  double avg_us() const;
+  double std_deviation_us() const;
+
+  // Returns the latency that `percentile` percent of the runs did not exceed,
+  // e.g. 99.9 for the p99.9 latency, within the bucket precision.
+  int64_t Percentile(double percentile) const;
+
+  // Returns `num_bins` bins of equal width between the minimum and maximum
+  // latencies.
+  std::vector<HistogramBin> Histogram(int num_bins) const;
+
+  // Average and maximum absolute difference between the latencies of
+  // consecutive runs.
+  double avg_jitter_us() const;
+  int64_t max_jitter_us() const { return max_jitter_us_; }
+
+  // Relative change of the average latency from the first to the last quarter
+  // of the runs, e.g. 0.2 if the last runs are 20% slower. 0 with too few
+  // runs to tell.
+  double Drift() const;
+
+  // Whether the latency grew by more than `drift_threshold` over the runs.
+  bool IsThrottled(double drift_threshold) const {
+    return Drift() > drift_threshold;
+  }
+
+  // Logs the percentiles, jitter and drift on one line.
+  void OutputToStream(std::ostream* stream) const;
+
+  // Writes the statistics and a histogram of `num_bins` bins as a JSON object.
+  void OutputToJson(std::ostream* stream, double drift_threshold,
+                    int num_bins = 20) const;
+
+ private:
+  static int BucketIndex(int64_t latency_us);
+  // Returns the latency a bucket stands for, within the observed range.
+  int64_t BucketValue(int index) const;
+
+  int64_t count_ = 0;
+  int64_t min_us_ = 0;
+  int64_t max_us_ = 0;
+  double sum_us_ = 0;
+  double squared_sum_us_ = 0;
+  std::vector<int64_t> bucket_counts_;
+
+  int64_t last_us_ = 0;
+  double jitter_sum_us_ = 0;
+  int64_t max_jitter_us_ = 0;
+
+  // Averages of windows of `window_size_` consecutive runs.
+  std::vector<double> window_avgs_us_;
+  int64_t window_size_ = 1;
+  int64_t window_count_ = 0;
+  double window_sum_us_ = 0;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_LATENCY_STATS_H_
@@ -0,0 +1,118 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/latency_stats.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+TEST(LatencyStatsTest, Empty) {
+  LatencyStats stats;
+  EXPECT_EQ(0, stats.count());
+  EXPECT_EQ(0, stats.Percentile(50));
+  EXPECT_EQ(0, stats.avg_jitter_us());
+  EXPECT_EQ(0, stats.Drift());
+  EXPECT_TRUE(stats.Histogram(10).empty());
+}
+
+TEST(LatencyStatsTest, ExactPercentilesOfShortLatencies) {
+  LatencyStats stats;
+  for (int i = 1; i <= 200; ++i) stats.Add(i);
+  EXPECT_EQ(200, stats.count());
+  EXPECT_EQ(1, stats.min_us());
+  EXPECT_EQ(200, stats.max_us());
+  EXPECT_DOUBLE_EQ(100.5, stats.avg_us());
+  EXPECT_EQ(1, stats.Percentile(0));
+  EXPECT_EQ(100, stats.Percentile(50));
+  EXPECT_EQ(180, stats.Percentile(90));
+  EXPECT_EQ(198, stats.Percentile(99));
+  EXPECT_EQ(200, stats.Percentile(99.9));
+  EXPECT_EQ(200, stats.Percentile(100));
+}
+
+TEST(LatencyStatsTest, PercentilesOfLongLatenciesWithinOnePercent) {
+  LatencyStats stats;
+  for (int i = 1; i <= 1000; ++i) stats.Add(i * 1000);
+  EXPECT_NEAR(500000, stats.Percentile(50), 500000 / 100);
+  EXPECT_NEAR(990000, stats.Percentile(99), 990000 / 100);
+  EXPECT_NEAR(999000, stats.Percentile(99.9), 999000 / 100);
+  EXPECT_EQ(1000000, stats.Percentile(100));
+}
+
+TEST(LatencyStatsTest, StdDeviationAndJitter) {
+  LatencyStats stats;
+  for (int64_t latency_us : {100, 300, 100, 300}) stats.Add(latency_us);
+  EXPECT_DOUBLE_EQ(200, stats.avg_us());
+  EXPECT_DOUBLE_EQ(100, stats.std_deviation_us());
+  EXPECT_DOUBLE_EQ(200, stats.avg_jitter_us());
+  EXPECT_EQ(200, stats.max_jitter_us());
+}
+
+TEST(LatencyStatsTest, Histogram) {
+  LatencyStats stats;
+  for (int i = 0; i < 10; ++i) stats.Add(10);
+  for (int i = 0; i < 5; ++i) stats.Add(29);
+  const std::vector<LatencyStats::HistogramBin> bins = stats.Histogram(4);
+  ASSERT_EQ(4, bins.size());
+  EXPECT_EQ(10, bins[0].lower_us);
+  EXPECT_EQ(14, bins[0].upper_us);
+  EXPECT_EQ(10, bins[0].count);
+  EXPECT_EQ(0, bins[1].count);
+  EXPECT_EQ(0, bins[2].count);
+  EXPECT_EQ(25, bins[3].lower_us);
+  EXPECT_EQ(29, bins[3].upper_us);
+  EXPECT_EQ(5, bins[3].count);
+}
+
+TEST(LatencyStatsTest, DriftOfSlowingRuns) {
+  LatencyStats steady;
+  LatencyStats throttled;
+  // More runs than windows, so that windows get merged.
+  for (int i = 0; i < 1000; ++i) {
+    steady.Add(1000);
+    throttled.Add(i < 500 ? 1000 : 1500);
+  }
+  EXPECT_DOUBLE_EQ(0, steady.Drift());
+  EXPECT_FALSE(steady.IsThrottled(0.1));
+  EXPECT_NEAR(0.5, throttled.Drift(), 0.01);
+  EXPECT_TRUE(throttled.IsThrottled(0.1));
+  EXPECT_FALSE(throttled.IsThrottled(0.6));
+}
+
+TEST(LatencyStatsTest, OutputToJson) {
+  LatencyStats stats;
+  stats.Add(10);
+  stats.Add(20);
+  std::stringstream stream;
+  stats.OutputToJson(&stream, /*drift_threshold=*/0.1, /*num_bins=*/1);
+  EXPECT_EQ(
+      "{\"count\":2,\"avg_us\":15,\"std_deviation_us\":5,\"min_us\":10,"
+      "\"max_us\":20,\"p50_us\":10,\"p90_us\":20,\"p99_us\":20,"
+      "\"p99_9_us\":20,\"avg_jitter_us\":10,\"max_jitter_us\":10,"
+      "\"drift\":0,\"throttled\":false,\"histogram\":[{\"lower_us\":10,"
+      "\"upper_us\":20,\"count\":2}]}",
+      stream.str());
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,138 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/load_generator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "tensorflow/lite/profiling/time.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// Instances sleep until shortly before requests arrive, then spin, so that the
+// queueing delay does not include the time the OS takes to wake them up. On a
+// single core the spinning instance would hold up the one serving a request,
+// so there they sleep all the way.
+constexpr int64_t kSpinUs = 200;
+// Time left to start the threads of the instances before the first arrival.
+constexpr int64_t kStartupUs = 1000;
+
+struct RequestRecord {
+  int64_t queueing_delay_us = 0;
+  int64_t service_time_us = 0;
+  int64_t end_us = 0;
+  bool ok = false;
+};
+
+}  // namespace
+
+bool ParseArrivalProcess(const std::string& name, ArrivalProcess* process) {
+  if (name == "poisson") {
+    *process = ArrivalProcess::kPoisson;
+  } else if (name == "fixed") {
+    *process = ArrivalProcess::kFixedRate;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::vector<int64_t> LoadGenerator::ScheduleArrivals(int64_t* end_us) const {
+  std::vector<int64_t> arrivals_us;
+  *end_us = 0;
+  if (options_.requests_per_second <= 0) return arrivals_us;
+  const double mean_gap_us = 1e6 / options_.requests_per_second;
+  const double max_us = options_.max_secs * 1e6;
+  std::mt19937 random_engine(options_.seed);
+  std::exponential_distribution<double> poisson_gap_us(1.0 / mean_gap_us);
+  double arrival_us = 0;
+  for (int i = 0; i < options_.num_requests && arrival_us <= max_us; ++i) {
+    arrivals_us.push_back(static_cast<int64_t>(arrival_us));
+    arrival_us += options_.arrival_process == ArrivalProcess::kPoisson
+                      ? poisson_gap_us(random_engine)
+                      : mean_gap_us;
+  }
+  *end_us = static_cast<int64_t>(arrival_us);
+  return arrivals_us;
+}
+
+LoadGeneratorResults LoadGenerator::Run(const RunRequestFn& run_request) const {
+  LoadGeneratorResults results;
+  const int num_instances = std::max(options_.num_instances, 1);
+  results.requests_per_instance.assign(num_instances, 0);
+  results.offered_requests_per_second = options_.requests_per_second;
+  int64_t arrivals_end_us;
+  const std::vector<int64_t> arrivals_us = ScheduleArrivals(&arrivals_end_us);
+  if (arrivals_us.empty()) return results;
+
+  // Free instances take the earliest request not taken yet and wait for it to
+  // arrive, which is a FIFO queue served by all instances.
+  std::vector<RequestRecord> records(arrivals_us.size());
+  std::atomic<int> next_request(0);
+  const int64_t spin_us = std::thread::hardware_concurrency() > 1 ? kSpinUs : 0;
+  const int64_t start_us = profiling::time::NowMicros() + kStartupUs;
+  auto serve = [&](int instance) {
+    for (int i = next_request++; i < arrivals_us.size(); i = next_request++) {
+      const int64_t arrival_us = start_us + arrivals_us[i];
+      int64_t begin_us = profiling::time::NowMicros();
+      while (begin_us < arrival_us) {
+        if (begin_us < arrival_us - spin_us) {
+          profiling::time::SleepForMicros(arrival_us - spin_us - begin_us);
+        }
+        begin_us = profiling::time::NowMicros();
+      }
+      records[i].ok = run_request(instance) == kTfLiteOk;
+      records[i].end_us = profiling::time::NowMicros();
+      records[i].queueing_delay_us = begin_us - arrival_us;
+      records[i].service_time_us = records[i].end_us - begin_us;
+      ++results.requests_per_instance[instance];
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int instance = 1; instance < num_instances; ++instance) {
+    threads.emplace_back(serve, instance);
+  }
+  serve(0);
+  for (std::thread& thread : threads) thread.join();
+
+  // The offered load also covers the gap after the last arrival.
+  int64_t last_end_us = start_us + arrivals_end_us;
+  for (const RequestRecord& record : records) {
+    ++results.num_requests;
+    last_end_us = std::max(last_end_us, record.end_us);
+    if (!record.ok) {
+      ++results.num_failed_requests;
+      continue;
+    }
+    results.queueing_delay_us.Add(record.queueing_delay_us);
+    results.service_time_us.Add(record.service_time_us);
+    results.latency_us.Add(record.queueing_delay_us + record.service_time_us);
+  }
+  results.duration_secs = (last_end_us - start_us) / 1e6;
+  if (results.duration_secs > 0) {
+    results.achieved_requests_per_second =
+        (results.num_requests - results.num_failed_requests) /
+        results.duration_secs;
+  }
+  return results;
+}
+
+}  // namespace benchmark
+}  // namespace tflite
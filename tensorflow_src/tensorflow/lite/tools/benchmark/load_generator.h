@@ -0,0 +1,95 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_LOAD_GENERATOR_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_LOAD_GENERATOR_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/tools/benchmark/latency_stats.h"
+
+namespace tflite {
+namespace benchmark {
+
+enum class ArrivalProcess {
+  // Exponentially distributed gaps between requests.
+  kPoisson,
+  // Constant gaps between requests.
+  kFixedRate,
+};
+
+// Returns false if `name` is neither "poisson" nor "fixed".
+bool ParseArrivalProcess(const std::string& name, ArrivalProcess* process);
+
+struct LoadGeneratorOptions {
+  // Number of instances serving requests concurrently, each on its own thread.
+  int num_instances = 1;
+  ArrivalProcess arrival_process = ArrivalProcess::kPoisson;
+  // Offered load.
+  double requests_per_second = 1;
+  int num_requests = 1;
+  // Requests that would arrive later are not issued.
+  float max_secs = 150;
+  uint32_t seed = 0;
+};
+
+struct LoadGeneratorResults {
+  int64_t num_requests = 0;
+  int64_t num_failed_requests = 0;
+  // From the first arrival to the last completion, or to the time the next
+  // request would arrive at if later.
+  double duration_secs = 0;
+  double offered_requests_per_second = 0;
+  double achieved_requests_per_second = 0;
+  // Time requests waited for a free instance after they arrived.
+  LatencyStats queueing_delay_us;
+  // Time instances took to run requests.
+  LatencyStats service_time_us;
+  // Queueing delay plus service time, as seen by the client.
+  LatencyStats latency_us;
+  std::vector<int64_t> requests_per_instance;
+};
+
+// Drives instances with an open-loop arrival process: requests arrive on a
+// schedule that does not depend on how fast they are served, and wait in a
+// FIFO queue for the first free instance. Unlike back-to-back runs, this shows
+// how latency grows with the offered load once instances saturate.
+class LoadGenerator {
+ public:
+  // Serves one request on `instance`. Different instances are run
+  // concurrently, a given instance never is.
+  using RunRequestFn = std::function<TfLiteStatus(int instance)>;
+
+  explicit LoadGenerator(const LoadGeneratorOptions& options)
+      : options_(options) {}
+
+  LoadGeneratorResults Run(const RunRequestFn& run_request) const;
+
+ private:
+  // Arrival times of the requests relative to the start, in microseconds.
+  // `end_us` is set to the time the next request would arrive at.
+  std::vector<int64_t> ScheduleArrivals(int64_t* end_us) const;
+
+  LoadGeneratorOptions options_;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_LOAD_GENERATOR_H_
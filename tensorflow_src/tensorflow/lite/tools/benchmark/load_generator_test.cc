@@ -0,0 +1,140 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/load_generator.h"
+
+#include <atomic>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/profiling/time.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+LoadGeneratorOptions CreateOptions(int num_instances,
+                                   double requests_per_second,
+                                   int num_requests) {
+  LoadGeneratorOptions options;
+  options.num_instances = num_instances;
+  options.arrival_process = ArrivalProcess::kFixedRate;
+  options.requests_per_second = requests_per_second;
+  options.num_requests = num_requests;
+  return options;
+}
+
+TEST(LoadGeneratorTest, ParseArrivalProcess) {
+  ArrivalProcess process;
+  ASSERT_TRUE(ParseArrivalProcess("fixed", &process));
+  EXPECT_EQ(ArrivalProcess::kFixedRate, process);
+  ASSERT_TRUE(ParseArrivalProcess("poisson", &process));
+  EXPECT_EQ(ArrivalProcess::kPoisson, process);
+  EXPECT_FALSE(ParseArrivalProcess("bursty", &process));
+}
+
+TEST(LoadGeneratorTest, IssuesRequestsAtTheOfferedRate) {
+  LoadGenerator generator(CreateOptions(1, 1000, 20));
+  const LoadGeneratorResults results =
+      generator.Run([](int instance) { return kTfLiteOk; });
+  EXPECT_EQ(20, results.num_requests);
+  EXPECT_EQ(0, results.num_failed_requests);
+  EXPECT_EQ(20, results.latency_us.count());
+  EXPECT_EQ(std::vector<int64_t>({20}), results.requests_per_instance);
+  // The last request arrives after 19ms, the next one would after 20ms.
+  EXPECT_GE(results.duration_secs, 0.02);
+  EXPECT_DOUBLE_EQ(1000, results.offered_requests_per_second);
+  EXPECT_LE(results.achieved_requests_per_second, 1000);
+  EXPECT_GT(results.achieved_requests_per_second, 500);
+}
+
+TEST(LoadGeneratorTest, RequestsQueueWhenOverloaded) {
+  // Requests arrive every 1ms but take 2ms.
+  LoadGenerator generator(CreateOptions(1, 1000, 20));
+  const LoadGeneratorResults results = generator.Run([](int instance) {
+    profiling::time::SleepForMicros(2000);
+    return kTfLiteOk;
+  });
+  EXPECT_EQ(20, results.num_requests);
+  EXPECT_GE(results.service_time_us.min_us(), 2000);
+  // The last request waits for the 19 before it, which take 38ms, less the
+  // 19ms it arrives after the first.
+  EXPECT_GE(results.queueing_delay_us.max_us(), 19000);
+  EXPECT_GE(results.latency_us.Percentile(100),
+            results.queueing_delay_us.max_us() + 2000);
+  EXPECT_LT(results.achieved_requests_per_second, 1000);
+}
+
+TEST(LoadGeneratorTest, InstancesServeConcurrently) {
+  constexpr int kNumInstances = 4;
+  std::vector<std::atomic<int>> running(kNumInstances);
+  for (auto& count : running) count = 0;
+  std::atomic<int> max_running(0);
+  std::atomic<int> total_running(0);
+  LoadGenerator generator(CreateOptions(kNumInstances, 2000, 40));
+  const LoadGeneratorResults results = generator.Run([&](int instance) {
+    EXPECT_EQ(1, ++running[instance]);
+    const int now_running = ++total_running;
+    int previous = max_running;
+    while (previous < now_running &&
+           !max_running.compare_exchange_weak(previous, now_running)) {
+    }
+    profiling::time::SleepForMicros(2000);
+    --total_running;
+    --running[instance];
+    return kTfLiteOk;
+  });
+  EXPECT_EQ(40, results.num_requests);
+  EXPECT_GT(max_running, 1);
+  int64_t num_served = 0;
+  for (int64_t count : results.requests_per_instance) num_served += count;
+  EXPECT_EQ(40, num_served);
+}
+
+TEST(LoadGeneratorTest, FailedRequestsAreCounted) {
+  LoadGenerator generator(CreateOptions(2, 10000, 10));
+  std::atomic<int> num_calls(0);
+  const LoadGeneratorResults results = generator.Run([&](int instance) {
+    return ++num_calls % 2 == 0 ? kTfLiteError : kTfLiteOk;
+  });
+  EXPECT_EQ(10, results.num_requests);
+  EXPECT_EQ(5, results.num_failed_requests);
+  EXPECT_EQ(5, results.latency_us.count());
+}
+
+TEST(LoadGeneratorTest, ArrivalsStopAfterMaxSecs) {
+  LoadGeneratorOptions options = CreateOptions(1, 10, 100);
+  options.max_secs = 0.25;
+  LoadGenerator generator(options);
+  const LoadGeneratorResults results =
+      generator.Run([](int instance) { return kTfLiteOk; });
+  // Requests arrive at 0, 0.1 and 0.2 seconds.
+  EXPECT_EQ(3, results.num_requests);
+}
+
+TEST(LoadGeneratorTest, PoissonArrivals) {
+  LoadGeneratorOptions options = CreateOptions(2, 5000, 200);
+  options.arrival_process = ArrivalProcess::kPoisson;
+  LoadGenerator generator(options);
+  const LoadGeneratorResults results =
+      generator.Run([](int instance) { return kTfLiteOk; });
+  EXPECT_EQ(200, results.num_requests);
+  EXPECT_EQ(0, results.num_failed_requests);
+  EXPECT_GT(results.duration_secs, 0);
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,328 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/benchmark/op_benchmark/autotuning_op_resolver.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "tensorflow/lite/allocation.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+constexpr char kBuiltinVariant[] = "builtin";
+
+}  // namespace
+
+// Dispatching kernel of an op and version. Kernel init functions are not told
+// which registration they belong to, but the subgraph keeps a copy of it for
+// every node, whose custom_name points at `name`. `name` is the first member
+// of this standard layout struct, so the kernel gets back to the resolver
+// from it once the node is prepared.
+struct AutotuningOpResolver::TunedOp {
+  // The name of the op, so that errors still name the builtin op.
+  char name[64];
+  const AutotuningOpResolver* resolver;
+  TfLiteRegistration registration;
+  // Whether a node of the op currently has a variant other than "builtin".
+  bool tuned;
+};
+
+namespace {
+
+// User data of a node run by the dispatching kernel.
+struct DispatchData {
+  // Arguments of init, which are passed on to the chosen kernel once the
+  // node is known.
+  const char* buffer;
+  size_t length;
+  const TfLiteRegistration* registration = nullptr;
+  void* user_data = nullptr;
+};
+
+void* DispatchInit(TfLiteContext* context, const char* buffer, size_t length) {
+  DispatchData* data = new DispatchData;
+  data->buffer = buffer;
+  data->length = length;
+  return data;
+}
+
+void DispatchFree(TfLiteContext* context, void* buffer) {
+  auto* data = static_cast<DispatchData*>(buffer);
+  if (data->registration != nullptr && data->registration->free != nullptr) {
+    data->registration->free(context, data->user_data);
+  }
+  delete data;
+}
+
+// Picks the kernel of the node on its first preparation, when its index is
+// known, and initializes it. As in the control flow kernels, the subgraph of
+// the node is found through the context.
+TfLiteStatus ChooseKernel(TfLiteContext* context, TfLiteNode* node,
+                          DispatchData* data) {
+  Subgraph* subgraph = reinterpret_cast<Subgraph*>(context->impl_);
+  const auto& nodes_and_registration = subgraph->nodes_and_registration();
+  int node_index = 0;
+  while (node_index < nodes_and_registration.size() &&
+         &nodes_and_registration[node_index].first != node) {
+    ++node_index;
+  }
+  TF_LITE_ENSURE(context, node_index < nodes_and_registration.size());
+  const TfLiteRegistration& node_registration =
+      nodes_and_registration[node_index].second;
+  const AutotuningOpResolver* resolver =
+      AutotuningOpResolver::FromTunedRegistration(node_registration);
+  TF_LITE_ENSURE(context, resolver != nullptr);
+
+  // Only the nodes of the primary subgraph are tuned.
+  const auto* subgraphs = subgraph->GetSubgraphs();
+  if (subgraphs == nullptr || subgraphs->empty() ||
+      (*subgraphs)[0].get() != subgraph) {
+    node_index = -1;
+  }
+  data->registration = resolver->FindVariant(
+      node_registration.builtin_code, node_registration.version,
+      resolver->GetNodeVariant(node_index, node_registration.builtin_code));
+  TF_LITE_ENSURE(context, data->registration != nullptr);
+  if (data->registration->init != nullptr) {
+    data->user_data =
+        data->registration->init(context, data->buffer, data->length);
+  }
+  return kTfLiteOk;
+}
+
+// The chosen kernel finds its own user data in the node while it runs.
+TfLiteStatus DispatchPrepare(TfLiteContext* context, TfLiteNode* node) {
+  auto* data = static_cast<DispatchData*>(node->user_data);
+  if (data->registration == nullptr) {
+    TF_LITE_ENSURE_STATUS(ChooseKernel(context, node, data));
+  }
+  if (data->registration->prepare == nullptr) return kTfLiteOk;
+  node->user_data = data->user_data;
+  const TfLiteStatus status = data->registration->prepare(context, node);
+  node->user_data = data;
+  return status;
+}
+
+TfLiteStatus DispatchInvoke(TfLiteContext* context, TfLiteNode* node) {
+  auto* data = static_cast<DispatchData*>(node->user_data);
+  node->user_data = data->user_data;
+  const TfLiteStatus status = data->registration->invoke(context, node);
+  node->user_data = data;
+  return status;
+}
+
+// FNV-1a hash of the model file.
+uint64_t GetModelHash(const FlatBufferModel* model) {
+  const Allocation* allocation = model->allocation();
+  if (allocation == nullptr || allocation->base() == nullptr) return 0;
+  const auto* bytes = static_cast<const uint8_t*>(allocation->base());
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < allocation->bytes(); ++i) {
+    hash = (hash ^ bytes[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+// Cache entries are lines of the model hash, the number of threads and the
+// variant of every node, separated by spaces.
+std::string GetCacheKey(uint64_t model_hash, int num_threads) {
+  std::stringstream key;
+  key << std::hex << std::setw(16) << std::setfill('0') << model_hash
+      << std::dec << " " << num_threads;
+  return key.str();
+}
+
+}  // namespace
+
+AutotuningOpResolver::AutotuningOpResolver(const FlatBufferModel* model,
+                                           int num_threads)
+    : model_(model),
+      num_threads_(num_threads),
+      model_hash_(GetModelHash(model)) {
+  const Model* flatbuffer_model = model->GetModel();
+  if (flatbuffer_model->subgraphs() == nullptr ||
+      flatbuffer_model->subgraphs()->size() == 0 ||
+      flatbuffer_model->operator_codes() == nullptr) {
+    return;
+  }
+  const auto* operators = flatbuffer_model->subgraphs()->Get(0)->operators();
+  if (operators == nullptr) return;
+  const auto* opcodes = flatbuffer_model->operator_codes();
+  for (const Operator* op : *operators) {
+    if (op->opcode_index() >= opcodes->size()) {
+      node_ops_.emplace_back(BuiltinOperator_CUSTOM, 0);
+      continue;
+    }
+    const OperatorCode* opcode = opcodes->Get(op->opcode_index());
+    node_ops_.emplace_back(GetBuiltinCode(opcode), opcode->version());
+  }
+  node_variants_.assign(node_ops_.size(), kBuiltinVariant);
+}
+
+AutotuningOpResolver::~AutotuningOpResolver() = default;
+
+const TfLiteRegistration* AutotuningOpResolver::FindOp(
+    tflite::BuiltinOperator op, int version) const {
+  auto it = tuned_ops_.find({op, version});
+  if (it == tuned_ops_.end() || !it->second->tuned) {
+    return BuiltinOpResolver::FindOp(op, version);
+  }
+  return &it->second->registration;
+}
+
+const AutotuningOpResolver* AutotuningOpResolver::FromTunedRegistration(
+    const TfLiteRegistration& registration) {
+  if (registration.invoke != DispatchInvoke ||
+      registration.custom_name == nullptr) {
+    return nullptr;
+  }
+  return reinterpret_cast<const TunedOp*>(registration.custom_name)->resolver;
+}
+
+const TfLiteRegistration* AutotuningOpResolver::FindVariant(
+    int32_t builtin_code, int version, const std::string& variant) const {
+  if (variant != kBuiltinVariant) {
+    for (const KernelVariant& kernel :
+         GetKernelVariants(builtin_code, version)) {
+      if (kernel.name == variant) return kernel.registration;
+    }
+  }
+  return BuiltinOpResolver::FindOp(
+      static_cast<BuiltinOperator>(builtin_code), version);
+}
+
+const std::string& AutotuningOpResolver::GetNodeVariant(
+    int node_index, int32_t builtin_code) const {
+  static const std::string* builtin_variant = new std::string(kBuiltinVariant);
+  if (node_index < 0 || node_index >= node_ops_.size() ||
+      node_ops_[node_index].first != builtin_code) {
+    return *builtin_variant;
+  }
+  return node_variants_[node_index];
+}
+
+void AutotuningOpResolver::SetNodeVariants(
+    std::vector<std::string> node_variants) {
+  node_variants_ = std::move(node_variants);
+  node_variants_.resize(node_ops_.size(), kBuiltinVariant);
+  for (auto& tuned_op : tuned_ops_) tuned_op.second->tuned = false;
+  for (int i = 0; i < node_ops_.size(); ++i) {
+    const int32_t builtin_code = node_ops_[i].first;
+    const int version = node_ops_[i].second;
+    if (builtin_code == BuiltinOperator_CUSTOM ||
+        node_variants_[i] == kBuiltinVariant) {
+      continue;
+    }
+    std::unique_ptr<TunedOp>& tuned_op = tuned_ops_[{builtin_code, version}];
+    if (tuned_op == nullptr) {
+      tuned_op.reset(new TunedOp());
+      strncpy(tuned_op->name,
+              EnumNameBuiltinOperator(
+                  static_cast<BuiltinOperator>(builtin_code)),
+              sizeof(tuned_op->name) - 1);
+      tuned_op->resolver = this;
+      tuned_op->registration = {DispatchInit, DispatchFree, DispatchPrepare,
+                                DispatchInvoke};
+      tuned_op->registration.builtin_code = builtin_code;
+      tuned_op->registration.custom_name = tuned_op->name;
+      tuned_op->registration.version = version;
+    }
+    tuned_op->tuned = true;
+  }
+}
+
+TfLiteStatus AutotuningOpResolver::Calibrate(
+    const OpBenchmarkOptions& options) {
+  OpBenchmarkOptions calibration_options = options;
+  calibration_options.num_threads = {num_threads_};
+  OpBenchmark benchmark(model_, calibration_options);
+  TF_LITE_ENSURE_STATUS(benchmark.Init());
+  std::vector<std::string> node_variants(node_ops_.size(), kBuiltinVariant);
+  for (const OpBenchmarkResult& result : benchmark.BenchmarkAllNodes()) {
+    if (result.best && result.node_index < node_variants.size()) {
+      node_variants[result.node_index] = result.variant;
+    }
+  }
+  SetNodeVariants(std::move(node_variants));
+  return kTfLiteOk;
+}
+
+TfLiteStatus AutotuningOpResolver::LoadCache(const std::string& cache_file) {
+  if (model_hash_ == 0) return kTfLiteError;
+  std::ifstream stream(cache_file);
+  if (!stream) return kTfLiteError;
+  const std::string key = GetCacheKey(model_hash_, num_threads_);
+  std::string line;
+  while (std::getline(stream, line)) {
+    if (line.compare(0, key.size(), key) != 0 || line.size() == key.size() ||
+        line[key.size()] != ' ') {
+      continue;
+    }
+    std::stringstream variants(line.substr(key.size()));
+    std::vector<std::string> node_variants;
+    std::string variant;
+    while (variants >> variant) node_variants.push_back(variant);
+    if (node_variants.size() != node_ops_.size()) return kTfLiteError;
+    SetNodeVariants(std::move(node_variants));
+    return kTfLiteOk;
+  }
+  return kTfLiteError;
+}
+
+TfLiteStatus AutotuningOpResolver::SaveCache(
+    const std::string& cache_file) const {
+  if (model_hash_ == 0) return kTfLiteError;
+  const std::string key = GetCacheKey(model_hash_, num_threads_);
+  std::vector<std::string> lines;
+  {
+    std::ifstream stream(cache_file);
+    std::string line;
+    while (std::getline(stream, line)) {
+      if (line.compare(0, key.size() + 1, key + " ") != 0) {
+        lines.push_back(line);
+      }
+    }
+  }
+  std::string entry = key;
+  for (const std::string& variant : node_variants_) entry += " " + variant;
+  lines.push_back(entry);
+
+  std::ofstream stream(cache_file, std::ios::trunc);
+  for (const std::string& line : lines) stream << line << "\n";
+  return stream ? kTfLiteOk : kTfLiteError;
+}
+
+TfLiteStatus AutotuningOpResolver::LoadOrCalibrate(
+    const std::string& cache_file, const OpBenchmarkOptions& options) {
+  if (LoadCache(cache_file) == kTfLiteOk) return kTfLiteOk;
+  TFLITE_LOG(INFO) << "No kernels tuned for the model with " << num_threads_
+                   << " thread(s) in " << cache_file << ", calibrating.";
+  TF_LITE_ENSURE_STATUS(Calibrate(options));
+  if (SaveCache(cache_file) != kTfLiteOk) {
+    TFLITE_LOG(WARN) << "Failed to write " << cache_file;
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace benchmark
+}  // namespace tflite
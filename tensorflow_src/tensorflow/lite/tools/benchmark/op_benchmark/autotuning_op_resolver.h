@@ -0,0 +1,123 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_BENCHMARK_AUTOTUNING_OP_RESOLVER_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_BENCHMARK_AUTOTUNING_OP_RESOLVER_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/tools/benchmark/op_benchmark/op_benchmark.h"
+
+namespace tflite {
+namespace benchmark {
+
+// An op resolver running each node of a model with the kernel variant that
+// was measured to be the fastest for it, e.g. the reference or multithreaded
+// kernel of a convolution instead of the one BuiltinOpResolver picks.
+//
+// The variants are chosen by a calibration pass, which times every variant of
+// every node on the shapes of the model (see OpBenchmark), and are kept in a
+// cache file keyed by a hash of the model and the number of threads, so later
+// loads skip the calibration:
+//
+//   AutotuningOpResolver resolver(model.get(), num_threads);
+//   resolver.LoadOrCalibrate("/data/local/tmp/autotuning.cache");
+//   InterpreterBuilder(*model, resolver)(&interpreter, num_threads);
+//
+// Ops of which no node has a tuned variant are resolved as by
+// BuiltinOpResolver. The others resolve to a kernel that runs the chosen
+// variant of each node of the primary subgraph, and the builtin kernel for
+// nodes of other subgraphs. The resolver must outlive the interpreters built
+// with it.
+class AutotuningOpResolver : public ops::builtin::BuiltinOpResolver {
+ public:
+  // `model` must outlive the resolver.
+  AutotuningOpResolver(const FlatBufferModel* model, int num_threads);
+  ~AutotuningOpResolver() override;
+
+  const TfLiteRegistration* FindOp(tflite::BuiltinOperator op,
+                                   int version) const override;
+  using BuiltinOpResolver::FindOp;
+
+  // Times the kernel variants of every node with the resolver's number of
+  // threads, and picks the fastest. `options.num_threads` is ignored.
+  TfLiteStatus Calibrate(const OpBenchmarkOptions& options);
+
+  // Reads the variants chosen for the model and number of threads from
+  // `cache_file`. Returns kTfLiteError if the file has none.
+  TfLiteStatus LoadCache(const std::string& cache_file);
+
+  // Writes the chosen variants to `cache_file`, keeping the entries of other
+  // models and numbers of threads.
+  TfLiteStatus SaveCache(const std::string& cache_file) const;
+
+  // Loads the variants from `cache_file`, or calibrates and saves them if it
+  // has none.
+  TfLiteStatus LoadOrCalibrate(
+      const std::string& cache_file,
+      const OpBenchmarkOptions& options = OpBenchmarkOptions());
+
+  // Sets the variant of each node of the primary subgraph, e.g. "ref".
+  // Nodes past the end of `node_variants` use "builtin".
+  void SetNodeVariants(std::vector<std::string> node_variants);
+  const std::vector<std::string>& node_variants() const {
+    return node_variants_;
+  }
+
+  // Fingerprint of the model file the cache entries are keyed by, or 0 if
+  // the model has no underlying buffer.
+  uint64_t model_hash() const { return model_hash_; }
+
+  // Returns the kernel of `variant` for the op and version of a node, or the
+  // builtin kernel if there is no such variant.
+  const TfLiteRegistration* FindVariant(int32_t builtin_code, int version,
+                                        const std::string& variant) const;
+
+  // Returns the variant chosen for node `node_index` if it runs
+  // `builtin_code`, "builtin" otherwise.
+  const std::string& GetNodeVariant(int node_index,
+                                    int32_t builtin_code) const;
+
+  // Returns the resolver of a node whose registration is a copy of one
+  // FindOp() returned for a tuned op, or null for other registrations.
+  static const AutotuningOpResolver* FromTunedRegistration(
+      const TfLiteRegistration& registration);
+
+ private:
+  struct TunedOp;
+
+  const FlatBufferModel* model_;
+  const int num_threads_;
+  const uint64_t model_hash_;
+  // Builtin op and version of each node of the primary subgraph.
+  std::vector<std::pair<int32_t, int>> node_ops_;
+  std::vector<std::string> node_variants_;
+  // Dispatching kernels of the ops and versions that had a tuned node. Entries
+  // are never removed, so that the registrations handed out by FindOp() stay
+  // valid when the variants change.
+  std::map<std::pair<int32_t, int>, std::unique_ptr<TunedOp>> tuned_ops_;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_BENCHMARK_AUTOTUNING_OP_RESOLVER_H_
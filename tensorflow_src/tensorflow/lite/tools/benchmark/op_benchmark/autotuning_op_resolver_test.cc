@@ -0,0 +1,161 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/benchmark/op_benchmark/autotuning_op_resolver.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+using ::testing::ElementsAre;
+
+constexpr char kAddModel[] = "tensorflow/lite/testdata/add.bin";
+
+class AutotuningOpResolverTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    model_ = FlatBufferModel::BuildFromFile(kAddModel);
+    ASSERT_NE(model_, nullptr);
+    const char* tmp_dir = getenv("TEST_TMPDIR");
+    cache_file_ = (tmp_dir != nullptr ? std::string(tmp_dir)
+                                      : ::testing::TempDir()) +
+                  "/autotuning.cache";
+    std::remove(cache_file_.c_str());
+  }
+
+  // Runs the model, which computes 3 * input, and checks its output.
+  void ExpectRunsModel(const OpResolver& resolver) {
+    std::unique_ptr<Interpreter> interpreter;
+    ASSERT_EQ(kTfLiteOk, InterpreterBuilder(*model_, resolver)(&interpreter));
+    ExpectRunsModel(interpreter.get());
+  }
+
+  void ExpectRunsModel(Interpreter* interpreter) {
+    ASSERT_EQ(kTfLiteOk, interpreter->AllocateTensors());
+    float* input = interpreter->typed_input_tensor<float>(0);
+    for (int i = 0; i < 8 * 8 * 3; ++i) input[i] = i;
+    ASSERT_EQ(kTfLiteOk, interpreter->Invoke());
+    const float* output = interpreter->typed_output_tensor<float>(0);
+    for (int i = 0; i < 8 * 8 * 3; ++i) EXPECT_EQ(3 * i, output[i]);
+  }
+
+  std::unique_ptr<FlatBufferModel> model_;
+  std::string cache_file_;
+};
+
+TEST_F(AutotuningOpResolverTest, UntunedOpsAreBuiltin) {
+  AutotuningOpResolver resolver(model_.get(), /*num_threads=*/1);
+  EXPECT_THAT(resolver.node_variants(), ElementsAre("builtin", "builtin"));
+  EXPECT_NE(0, resolver.model_hash());
+  ops::builtin::BuiltinOpResolver builtin_resolver;
+  EXPECT_EQ(builtin_resolver.FindOp(BuiltinOperator_ADD, 1)->invoke,
+            resolver.FindOp(BuiltinOperator_ADD, 1)->invoke);
+  ExpectRunsModel(resolver);
+}
+
+TEST_F(AutotuningOpResolverTest, RunsChosenVariants) {
+  AutotuningOpResolver resolver(model_.get(), /*num_threads=*/1);
+  resolver.SetNodeVariants({"ref", "generic_opt"});
+  EXPECT_THAT(resolver.node_variants(), ElementsAre("ref", "generic_opt"));
+
+  const TfLiteRegistration* builtin =
+      resolver.FindVariant(BuiltinOperator_ADD, 1, "builtin");
+  EXPECT_NE(builtin, resolver.FindVariant(BuiltinOperator_ADD, 1, "ref"));
+  EXPECT_EQ(builtin, resolver.FindVariant(BuiltinOperator_ADD, 1, "tiled"));
+  const TfLiteRegistration* dispatch =
+      resolver.FindOp(BuiltinOperator_ADD, 1);
+  EXPECT_NE(builtin->invoke, dispatch->invoke);
+  EXPECT_EQ(BuiltinOperator_ADD, dispatch->builtin_code);
+  EXPECT_EQ("ref", resolver.GetNodeVariant(0, BuiltinOperator_ADD));
+  EXPECT_EQ("builtin", resolver.GetNodeVariant(0, BuiltinOperator_MUL));
+  EXPECT_EQ("builtin", resolver.GetNodeVariant(2, BuiltinOperator_ADD));
+  ExpectRunsModel(resolver);
+}
+
+TEST_F(AutotuningOpResolverTest, RegistrationsOutliveVariantChanges) {
+  AutotuningOpResolver resolver(model_.get(), /*num_threads=*/1);
+  resolver.SetNodeVariants({"ref", "ref"});
+  const TfLiteRegistration* dispatch =
+      resolver.FindOp(BuiltinOperator_ADD, 1);
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(kTfLiteOk, InterpreterBuilder(*model_, resolver)(&interpreter));
+
+  resolver.SetNodeVariants({"generic_opt"});
+  EXPECT_EQ(dispatch, resolver.FindOp(BuiltinOperator_ADD, 1));
+  resolver.SetNodeVariants({});
+  EXPECT_NE(dispatch->invoke,
+            resolver.FindOp(BuiltinOperator_ADD, 1)->invoke);
+  // The nodes built with the dispatching kernel still run, with the builtin
+  // kernel now.
+  ExpectRunsModel(interpreter.get());
+}
+
+TEST_F(AutotuningOpResolverTest, Cache) {
+  AutotuningOpResolver resolver(model_.get(), /*num_threads=*/1);
+  EXPECT_EQ(kTfLiteError, resolver.LoadCache(cache_file_));
+  resolver.SetNodeVariants({"neon_opt", "ref"});
+  ASSERT_EQ(kTfLiteOk, resolver.SaveCache(cache_file_));
+
+  AutotuningOpResolver two_threads_resolver(model_.get(), /*num_threads=*/2);
+  EXPECT_EQ(kTfLiteError, two_threads_resolver.LoadCache(cache_file_));
+  ASSERT_EQ(kTfLiteOk, two_threads_resolver.SaveCache(cache_file_));
+
+  AutotuningOpResolver loaded_resolver(model_.get(), /*num_threads=*/1);
+  ASSERT_EQ(kTfLiteOk, loaded_resolver.LoadCache(cache_file_));
+  EXPECT_THAT(loaded_resolver.node_variants(), ElementsAre("neon_opt", "ref"));
+  ExpectRunsModel(loaded_resolver);
+  ASSERT_EQ(kTfLiteOk, two_threads_resolver.LoadCache(cache_file_));
+  EXPECT_THAT(two_threads_resolver.node_variants(),
+              ElementsAre("builtin", "builtin"));
+
+  // Saving again replaces the entry.
+  loaded_resolver.SetNodeVariants({"ref"});
+  ASSERT_EQ(kTfLiteOk, loaded_resolver.SaveCache(cache_file_));
+  std::ifstream stream(cache_file_);
+  int num_lines = 0;
+  for (std::string line; std::getline(stream, line);) ++num_lines;
+  EXPECT_EQ(2, num_lines);
+  ASSERT_EQ(kTfLiteOk, resolver.LoadCache(cache_file_));
+  EXPECT_THAT(resolver.node_variants(), ElementsAre("ref", "builtin"));
+}
+
+TEST_F(AutotuningOpResolverTest, LoadOrCalibrate) {
+  OpBenchmarkOptions options;
+  options.min_num_runs = 2;
+  options.min_secs = 0;
+  AutotuningOpResolver resolver(model_.get(), /*num_threads=*/1);
+  ASSERT_EQ(kTfLiteOk, resolver.LoadOrCalibrate(cache_file_, options));
+  ASSERT_EQ(2, resolver.node_variants().size());
+  ExpectRunsModel(resolver);
+
+  AutotuningOpResolver loaded_resolver(model_.get(), /*num_threads=*/1);
+  ASSERT_EQ(kTfLiteOk, loaded_resolver.LoadCache(cache_file_));
+  EXPECT_EQ(resolver.node_variants(), loaded_resolver.node_variants());
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,617 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/benchmark/op_benchmark/op_benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <utility>
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/core/api/flatbuffer_conversions.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/kernels/register_ref.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace ops {
+namespace builtin {
+
+// Optimized kernel variants, which are not registered by any resolver.
+TfLiteRegistration* Register_ADD_GENERIC_OPT();
+TfLiteRegistration* Register_ADD_NEON_OPT();
+TfLiteRegistration* Register_AVERAGE_POOL_GENERIC_OPT();
+TfLiteRegistration* Register_AVERAGE_POOL_TILED();
+TfLiteRegistration* Register_BATCH_MATMUL_GENERIC_OPTIMIZED();
+TfLiteRegistration* Register_BATCH_TO_SPACE_ND_GENERIC_OPT();
+TfLiteRegistration* Register_CONCATENATION_GENERIC_OPT();
+TfLiteRegistration* Register_CONVOLUTION_GENERIC_OPT();
+TfLiteRegistration* Register_CONVOLUTION_MULTITHREADED_OPT();
+TfLiteRegistration* Register_DEPTH_TO_SPACE_GENERIC_OPT();
+TfLiteRegistration* Register_DEPTHWISE_CONVOLUTION_GENERIC_OPT();
+TfLiteRegistration* Register_DEPTHWISE_CONVOLUTION_NEON_OPT();
+TfLiteRegistration* Register_DEQUANTIZE_OPT();
+TfLiteRegistration* Register_DIV_GENERIC_OPT();
+TfLiteRegistration* Register_DIV_NEON_OPT();
+TfLiteRegistration* Register_FULLY_CONNECTED_GENERIC_OPT();
+TfLiteRegistration* Register_FULLY_CONNECTED_PIE();
+TfLiteRegistration* Register_L2NORM_GENERIC_OPT();
+TfLiteRegistration* Register_L2_POOL_GENERIC_OPT();
+TfLiteRegistration* Register_LOCAL_RESPONSE_NORM_GENERIC_OPT();
+TfLiteRegistration* Register_LOG_SOFTMAX_FIXED_POINT_OPT();
+TfLiteRegistration* Register_LOGISTIC_FIXED_POINT_OPT();
+TfLiteRegistration* Register_LOGISTIC_GENERIC_OPT();
+TfLiteRegistration* Register_MAX_POOL_GENERIC_OPT();
+TfLiteRegistration* Register_MAX_POOL_TILED();
+TfLiteRegistration* Register_MAXIMUM_GENERIC_OPT();
+TfLiteRegistration* Register_MEAN_OPT();
+TfLiteRegistration* Register_MINIMUM_GENERIC_OPT();
+TfLiteRegistration* Register_MUL_GENERIC_OPT();
+TfLiteRegistration* Register_MUL_NEON_OPT();
+TfLiteRegistration* Register_PAD_GENERIC_OPT();
+TfLiteRegistration* Register_PADV2_GENERIC_OPT();
+TfLiteRegistration* Register_QUANTIZE_OPT();
+TfLiteRegistration* Register_RESIZE_NEAREST_NEIGHBOR_GENERIC_OPT();
+TfLiteRegistration* Register_RESIZE_NEAREST_NEIGHBOR_NEON_OPT();
+TfLiteRegistration* Register_SOFTMAX_FIXED_POINT_OPT();
+TfLiteRegistration* Register_SPACE_TO_BATCH_ND_GENERIC_OPT();
+TfLiteRegistration* Register_SPACE_TO_DEPTH_GENERIC_OPT();
+TfLiteRegistration* Register_SUB_GENERIC_OPT();
+TfLiteRegistration* Register_SUB_NEON_OPT();
+TfLiteRegistration* Register_TANH_FIXED_POINT_OPT();
+TfLiteRegistration* Register_TANH_GENERIC_OPT();
+
+}  // namespace builtin
+}  // namespace ops
+
+namespace benchmark {
+namespace {
+
+using ops::builtin::BuiltinOpResolver;
+using ops::builtin::BuiltinRefOpResolver;
+
+struct OptimizedVariant {
+  BuiltinOperator op;
+  const char* name;
+  TfLiteRegistration* (*registration)();
+};
+
+const OptimizedVariant kOptimizedVariants[] = {
+    {BuiltinOperator_ADD, "generic_opt",
+     ops::builtin::Register_ADD_GENERIC_OPT},
+    {BuiltinOperator_ADD, "neon_opt", ops::builtin::Register_ADD_NEON_OPT},
+    {BuiltinOperator_AVERAGE_POOL_2D, "generic_opt",
+     ops::builtin::Register_AVERAGE_POOL_GENERIC_OPT},
+    {BuiltinOperator_AVERAGE_POOL_2D, "tiled",
+     ops::builtin::Register_AVERAGE_POOL_TILED},
+    {BuiltinOperator_BATCH_MATMUL, "generic_opt",
+     ops::builtin::Register_BATCH_MATMUL_GENERIC_OPTIMIZED},
+    {BuiltinOperator_BATCH_TO_SPACE_ND, "generic_opt",
+     ops::builtin::Register_BATCH_TO_SPACE_ND_GENERIC_OPT},
+    {BuiltinOperator_CONCATENATION, "generic_opt",
+     ops::builtin::Register_CONCATENATION_GENERIC_OPT},
+    {BuiltinOperator_CONV_2D, "generic_opt",
+     ops::builtin::Register_CONVOLUTION_GENERIC_OPT},
+    {BuiltinOperator_CONV_2D, "multithreaded_opt",
+     ops::builtin::Register_CONVOLUTION_MULTITHREADED_OPT},
+    {BuiltinOperator_DEPTH_TO_SPACE, "generic_opt",
+     ops::builtin::Register_DEPTH_TO_SPACE_GENERIC_OPT},
+    {BuiltinOperator_DEPTHWISE_CONV_2D, "generic_opt",
+     ops::builtin::Register_DEPTHWISE_CONVOLUTION_GENERIC_OPT},
+    {BuiltinOperator_DEPTHWISE_CONV_2D, "neon_opt",
+     ops::builtin::Register_DEPTHWISE_CONVOLUTION_NEON_OPT},
+    {BuiltinOperator_DEQUANTIZE, "opt", ops::builtin::Register_DEQUANTIZE_OPT},
+    {BuiltinOperator_DIV, "generic_opt",
+     ops::builtin::Register_DIV_GENERIC_OPT},
+    {BuiltinOperator_DIV, "neon_opt", ops::builtin::Register_DIV_NEON_OPT},
+    {BuiltinOperator_FULLY_CONNECTED, "generic_opt",
+     ops::builtin::Register_FULLY_CONNECTED_GENERIC_OPT},
+    {BuiltinOperator_FULLY_CONNECTED, "pie",
+     ops::builtin::Register_FULLY_CONNECTED_PIE},
+    {BuiltinOperator_L2_NORMALIZATION, "generic_opt",
+     ops::builtin::Register_L2NORM_GENERIC_OPT},
+    {BuiltinOperator_L2_POOL_2D, "generic_opt",
+     ops::builtin::Register_L2_POOL_GENERIC_OPT},
+    {BuiltinOperator_LOCAL_RESPONSE_NORMALIZATION, "generic_opt",
+     ops::builtin::Register_LOCAL_RESPONSE_NORM_GENERIC_OPT},
+    {BuiltinOperator_LOG_SOFTMAX, "fixed_point_opt",
+     ops::builtin::Register_LOG_SOFTMAX_FIXED_POINT_OPT},
+    {BuiltinOperator_LOGISTIC, "generic_opt",
+     ops::builtin::Register_LOGISTIC_GENERIC_OPT},
+    {BuiltinOperator_LOGISTIC, "fixed_point_opt",
+     ops::builtin::Register_LOGISTIC_FIXED_POINT_OPT},
+    {BuiltinOperator_MAX_POOL_2D, "generic_opt",
+     ops::builtin::Register_MAX_POOL_GENERIC_OPT},
+    {BuiltinOperator_MAX_POOL_2D, "tiled",
+     ops::builtin::Register_MAX_POOL_TILED},
+    {BuiltinOperator_MAXIMUM, "generic_opt",
+     ops::builtin::Register_MAXIMUM_GENERIC_OPT},
+    {BuiltinOperator_MEAN, "opt", ops::builtin::Register_MEAN_OPT},
+    {BuiltinOperator_MINIMUM, "generic_opt",
+     ops::builtin::Register_MINIMUM_GENERIC_OPT},
+    {BuiltinOperator_MUL, "generic_opt",
+     ops::builtin::Register_MUL_GENERIC_OPT},
+    {BuiltinOperator_MUL, "neon_opt", ops::builtin::Register_MUL_NEON_OPT},
+    {BuiltinOperator_PAD, "generic_opt",
+     ops::builtin::Register_PAD_GENERIC_OPT},
+    {BuiltinOperator_PADV2, "generic_opt",
+     ops::builtin::Register_PADV2_GENERIC_OPT},
+    {BuiltinOperator_QUANTIZE, "opt", ops::builtin::Register_QUANTIZE_OPT},
+    {BuiltinOperator_RESIZE_NEAREST_NEIGHBOR, "generic_opt",
+     ops::builtin::Register_RESIZE_NEAREST_NEIGHBOR_GENERIC_OPT},
+    {BuiltinOperator_RESIZE_NEAREST_NEIGHBOR, "neon_opt",
+     ops::builtin::Register_RESIZE_NEAREST_NEIGHBOR_NEON_OPT},
+    {BuiltinOperator_SOFTMAX, "fixed_point_opt",
+     ops::builtin::Register_SOFTMAX_FIXED_POINT_OPT},
+    {BuiltinOperator_SPACE_TO_BATCH_ND, "generic_opt",
+     ops::builtin::Register_SPACE_TO_BATCH_ND_GENERIC_OPT},
+    {BuiltinOperator_SPACE_TO_DEPTH, "generic_opt",
+     ops::builtin::Register_SPACE_TO_DEPTH_GENERIC_OPT},
+    {BuiltinOperator_SUB, "generic_opt",
+     ops::builtin::Register_SUB_GENERIC_OPT},
+    {BuiltinOperator_SUB, "neon_opt", ops::builtin::Register_SUB_NEON_OPT},
+    {BuiltinOperator_TANH, "generic_opt",
+     ops::builtin::Register_TANH_GENERIC_OPT},
+    {BuiltinOperator_TANH, "fixed_point_opt",
+     ops::builtin::Register_TANH_FIXED_POINT_OPT},
+};
+
+const BuiltinOpResolver& GetBuiltinOpResolver() {
+  static const BuiltinOpResolver* resolver = new BuiltinOpResolver();
+  return *resolver;
+}
+
+const BuiltinRefOpResolver& GetBuiltinRefOpResolver() {
+  static const BuiltinRefOpResolver* resolver = new BuiltinRefOpResolver();
+  return *resolver;
+}
+
+// Allocates builtin data with malloc(), as the interpreter frees it with
+// free().
+class MallocDataAllocator : public BuiltinDataAllocator {
+ public:
+  void* Allocate(size_t size, size_t alignment_hint) override {
+    return malloc(size);
+  }
+  void Deallocate(void* data) override { free(data); }
+};
+
+// Returns a copy of `quantization`, to be owned by another tensor.
+TfLiteQuantization CopyQuantization(const TfLiteQuantization& quantization) {
+  TfLiteQuantization copy = {kTfLiteNoQuantization, nullptr};
+  if (quantization.type != kTfLiteAffineQuantization ||
+      quantization.params == nullptr) {
+    return copy;
+  }
+  const auto* params =
+      static_cast<const TfLiteAffineQuantization*>(quantization.params);
+  auto* copied_params = static_cast<TfLiteAffineQuantization*>(
+      malloc(sizeof(TfLiteAffineQuantization)));
+  copied_params->scale = nullptr;
+  if (params->scale != nullptr) {
+    copied_params->scale = TfLiteFloatArrayCreate(params->scale->size);
+    std::copy_n(params->scale->data, params->scale->size,
+                copied_params->scale->data);
+  }
+  copied_params->zero_point = params->zero_point != nullptr
+                                  ? TfLiteIntArrayCopy(params->zero_point)
+                                  : nullptr;
+  copied_params->quantized_dimension = params->quantized_dimension;
+  copy.type = kTfLiteAffineQuantization;
+  copy.params = copied_params;
+  return copy;
+}
+
+std::vector<int> GetShape(const TfLiteTensor& tensor) {
+  if (tensor.dims == nullptr) return {};
+  return std::vector<int>(tensor.dims->data,
+                          tensor.dims->data + tensor.dims->size);
+}
+
+template <typename T, typename Distribution>
+void FillRandom(TfLiteTensor* tensor, Distribution distribution,
+                std::mt19937* generator) {
+  T* data = reinterpret_cast<T*>(tensor->data.raw);
+  const size_t count = tensor->bytes / sizeof(T);
+  for (size_t i = 0; i < count; ++i) {
+    data[i] = static_cast<T>(distribution(*generator));
+  }
+}
+
+// Fills floating point and quantized tensors with random values. Other
+// tensors, which often hold indices or sizes, are zeroed.
+void FillInput(TfLiteTensor* tensor, std::mt19937* generator) {
+  if (tensor->data.raw == nullptr) return;
+  switch (tensor->type) {
+    case kTfLiteFloat32:
+      FillRandom<float>(tensor, std::uniform_real_distribution<float>(-1, 1),
+                        generator);
+      break;
+    case kTfLiteInt8:
+      FillRandom<int8_t>(tensor, std::uniform_int_distribution<int>(-128, 127),
+                         generator);
+      break;
+    case kTfLiteUInt8:
+      FillRandom<uint8_t>(tensor, std::uniform_int_distribution<int>(0, 255),
+                          generator);
+      break;
+    case kTfLiteInt16:
+      FillRandom<int16_t>(
+          tensor, std::uniform_int_distribution<int>(-32768, 32767), generator);
+      break;
+    default:
+      memset(tensor->data.raw, 0, tensor->bytes);
+  }
+}
+
+std::string GetOpName(const TfLiteRegistration& registration) {
+  if (registration.builtin_code == BuiltinOperator_CUSTOM &&
+      registration.custom_name != nullptr) {
+    return registration.custom_name;
+  }
+  return EnumNameBuiltinOperator(
+      static_cast<BuiltinOperator>(registration.builtin_code));
+}
+
+// Writes `value` as a JSON string; op names and error messages are plain
+// text, but may contain quotes.
+void WriteJsonString(const std::string& value, std::ostream* stream) {
+  *stream << '"';
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      *stream << '\\' << c;
+    } else if (c == '\n') {
+      *stream << "\\n";
+    } else if (static_cast<unsigned char>(c) >= 0x20) {
+      *stream << c;
+    }
+  }
+  *stream << '"';
+}
+
+// Returns `value` as a CSV field.
+std::string CsvField(const std::string& value) {
+  if (value.find_first_of(",\"\n") == std::string::npos) return value;
+  std::string quoted = "\"";
+  for (char c : value) {
+    if (c == '"') quoted += '"';
+    quoted += c == '\n' ? ' ' : c;
+  }
+  return quoted + "\"";
+}
+
+}  // namespace
+
+class OpBenchmark::LastErrorReporter : public ErrorReporter {
+ public:
+  int Report(const char* format, va_list args) override {
+    char buffer[512];
+    const int size = vsnprintf(buffer, sizeof(buffer), format, args);
+    last_error_ = buffer;
+    return size;
+  }
+  void Clear() { last_error_.clear(); }
+  const std::string& last_error() const { return last_error_; }
+
+ private:
+  std::string last_error_;
+};
+
+std::vector<KernelVariant> GetKernelVariants(int32_t builtin_code,
+                                             int version) {
+  const auto op = static_cast<BuiltinOperator>(builtin_code);
+  std::vector<KernelVariant> variants;
+  if (const TfLiteRegistration* registration =
+          GetBuiltinOpResolver().FindOp(op, version)) {
+    variants.push_back({"builtin", registration});
+  }
+  if (const TfLiteRegistration* registration =
+          GetBuiltinRefOpResolver().FindOp(op, version)) {
+    variants.push_back({"ref", registration});
+  }
+  // The optimized variants are only offered for the versions the builtin
+  // kernel supports.
+  if (variants.empty() || variants[0].name != "builtin") return variants;
+  for (const OptimizedVariant& variant : kOptimizedVariants) {
+    if (variant.op == op) {
+      variants.push_back({variant.name, variant.registration()});
+    }
+  }
+  return variants;
+}
+
+OpBenchmark::OpBenchmark(const FlatBufferModel* model,
+                         const OpBenchmarkOptions& options)
+    : model_(model),
+      options_(options),
+      error_reporter_(new LastErrorReporter()) {}
+
+OpBenchmark::~OpBenchmark() {}
+
+TfLiteStatus OpBenchmark::Init() {
+  InterpreterBuilder(*model_, GetBuiltinOpResolver())(&model_interpreter_);
+  if (model_interpreter_ == nullptr) return kTfLiteError;
+  if (model_interpreter_->AllocateTensors() != kTfLiteOk) return kTfLiteError;
+
+  // The shapes of dynamic tensors are only known once the model ran.
+  bool has_dynamic_tensors = false;
+  for (int i = 0; i < model_interpreter_->tensors_size(); ++i) {
+    if (model_interpreter_->tensor(i)->allocation_type == kTfLiteDynamic) {
+      has_dynamic_tensors = true;
+    }
+  }
+  if (has_dynamic_tensors) {
+    std::mt19937 generator;
+    for (int input : model_interpreter_->inputs()) {
+      FillInput(model_interpreter_->tensor(input), &generator);
+    }
+    return model_interpreter_->Invoke();
+  }
+  return kTfLiteOk;
+}
+
+int OpBenchmark::num_nodes() const {
+  return model_interpreter_ ? model_interpreter_->execution_plan().size() : 0;
+}
+
+std::unique_ptr<Interpreter> OpBenchmark::CreateSingleOpInterpreter(
+    int node_index, const TfLiteRegistration& registration, int num_threads,
+    std::string* error) {
+  const auto* node_and_registration =
+      model_interpreter_->node_and_registration(node_index);
+  const auto* subgraphs = model_->GetModel()->subgraphs();
+  const auto* operators = subgraphs->Get(0)->operators();
+  if (node_and_registration == nullptr || operators == nullptr ||
+      node_index >= operators->size()) {
+    *error = "No such node";
+    return nullptr;
+  }
+  const TfLiteNode& node = node_and_registration->first;
+  const Operator* op = operators->Get(node_index);
+  const auto* op_codes = model_->GetModel()->operator_codes();
+  const BuiltinOperator op_type =
+      GetBuiltinCode(op_codes->Get(op->opcode_index()));
+  if (op_type == BuiltinOperator_IF || op_type == BuiltinOperator_WHILE ||
+      op_type == BuiltinOperator_CALL_ONCE) {
+    *error = "Control flow operators are not supported";
+    return nullptr;
+  }
+
+  error_reporter_->Clear();
+  auto interpreter = std::unique_ptr<Interpreter>(
+      new Interpreter(error_reporter_.get()));
+
+  // Maps the tensors of the node to the ones of the new interpreter.
+  std::map<int, int> tensor_map;
+  auto map_tensors = [&tensor_map](const TfLiteIntArray* tensors) {
+    std::vector<int> mapped;
+    for (int i = 0; tensors != nullptr && i < tensors->size; ++i) {
+      const int tensor = tensors->data[i];
+      if (tensor == kTfLiteOptionalTensor) {
+        mapped.push_back(kTfLiteOptionalTensor);
+        continue;
+      }
+      const int next_tensor = tensor_map.size();
+      mapped.push_back(tensor_map.insert({tensor, next_tensor}).first->second);
+    }
+    return mapped;
+  };
+  const std::vector<int> inputs = map_tensors(node.inputs);
+  const std::vector<int> outputs = map_tensors(node.outputs);
+  const std::vector<int> intermediates = map_tensors(node.intermediates);
+
+  interpreter->AddTensors(tensor_map.size());
+  std::vector<int> interpreter_inputs;
+  for (const auto& mapping : tensor_map) {
+    const TfLiteTensor& tensor = *model_interpreter_->tensor(mapping.first);
+    if (tensor.sparsity != nullptr) {
+      *error = "Sparse tensors are not supported";
+      return nullptr;
+    }
+    TfLiteStatus status;
+    if (tensor.allocation_type == kTfLiteMmapRo) {
+      status = interpreter->SetTensorParametersReadOnly(
+          mapping.second, tensor.type, tensor.name, GetShape(tensor),
+          CopyQuantization(tensor.quantization), tensor.data.raw_const,
+          tensor.bytes);
+    } else {
+      status = interpreter->SetTensorParametersReadWrite(
+          mapping.second, tensor.type, tensor.name, GetShape(tensor),
+          CopyQuantization(tensor.quantization), tensor.is_variable);
+      if (!tensor.is_variable &&
+          std::find(inputs.begin(), inputs.end(), mapping.second) !=
+              inputs.end()) {
+        interpreter_inputs.push_back(mapping.second);
+      }
+    }
+    if (status != kTfLiteOk) {
+      *error = error_reporter_->last_error();
+      return nullptr;
+    }
+  }
+  interpreter->SetInputs(interpreter_inputs);
+  interpreter->SetOutputs(outputs);
+  interpreter->SetNumThreads(num_threads);
+
+  void* builtin_data = nullptr;
+  MallocDataAllocator allocator;
+  if (op_type != BuiltinOperator_CUSTOM &&
+      ParseOpData(op, op_type, error_reporter_.get(), &allocator,
+                  &builtin_data) != kTfLiteOk) {
+    *error = error_reporter_->last_error();
+    return nullptr;
+  }
+  const char* init_data = nullptr;
+  size_t init_data_size = 0;
+  if (op_type == BuiltinOperator_CUSTOM && op->custom_options() != nullptr) {
+    init_data = reinterpret_cast<const char*>(op->custom_options()->data());
+    init_data_size = op->custom_options()->size();
+  }
+  if (interpreter->primary_subgraph().AddNodeWithParameters(
+          inputs, outputs, intermediates, init_data, init_data_size,
+          builtin_data, &registration) != kTfLiteOk ||
+      interpreter->AllocateTensors() != kTfLiteOk) {
+    *error = error_reporter_->last_error();
+    return nullptr;
+  }
+
+  std::mt19937 generator(node_index);
+  for (int input : interpreter->inputs()) {
+    FillInput(interpreter->tensor(input), &generator);
+  }
+  return interpreter;
+}
+
+std::vector<OpBenchmarkResult> OpBenchmark::BenchmarkNode(int node_index) {
+  std::vector<OpBenchmarkResult> results;
+  const auto* node_and_registration =
+      model_interpreter_->node_and_registration(node_index);
+  if (node_and_registration == nullptr) return results;
+  const TfLiteRegistration& model_registration = node_and_registration->second;
+  const std::string op_name = GetOpName(model_registration);
+
+  std::vector<KernelVariant> variants;
+  if (model_registration.builtin_code == BuiltinOperator_CUSTOM) {
+    variants.push_back({"builtin", &model_registration});
+  } else {
+    variants = GetKernelVariants(model_registration.builtin_code,
+                                 model_registration.version);
+  }
+
+  for (const KernelVariant& variant : variants) {
+    for (int num_threads : options_.num_threads) {
+      OpBenchmarkResult result;
+      result.node_index = node_index;
+      result.op_name = op_name;
+      result.variant = variant.name;
+      result.num_threads = num_threads;
+      auto interpreter = CreateSingleOpInterpreter(
+          node_index, *variant.registration, num_threads, &result.error);
+      if (interpreter == nullptr) {
+        results.push_back(result);
+        continue;
+      }
+
+      bool failed = false;
+      for (int i = 0; i < options_.warmup_runs && !failed; ++i) {
+        failed = interpreter->Invoke() != kTfLiteOk;
+      }
+      // Running sums, as cheap layers may run millions of times.
+      int64_t sum_us = 0;
+      double sum_squares_us = 0;
+      const uint64_t start_us = profiling::time::NowMicros();
+      while (!failed) {
+        const uint64_t elapsed_us = profiling::time::NowMicros() - start_us;
+        if (elapsed_us >= options_.max_secs * 1e6 ||
+            (result.num_runs >= options_.min_num_runs &&
+             elapsed_us >= options_.min_secs * 1e6)) {
+          break;
+        }
+        const uint64_t run_start_us = profiling::time::NowMicros();
+        failed = interpreter->Invoke() != kTfLiteOk;
+        const int64_t time_us = profiling::time::NowMicros() - run_start_us;
+        result.min_us =
+            result.num_runs == 0 ? time_us : std::min(result.min_us, time_us);
+        result.max_us = std::max(result.max_us, time_us);
+        sum_us += time_us;
+        sum_squares_us += static_cast<double>(time_us) * time_us;
+        ++result.num_runs;
+      }
+      if (failed) {
+        result.error = "Invoke failed: " + error_reporter_->last_error();
+        result.num_runs = 0;
+        results.push_back(result);
+        continue;
+      }
+      if (result.num_runs > 0) {
+        result.avg_us = static_cast<double>(sum_us) / result.num_runs;
+        const double variance = sum_squares_us / result.num_runs -
+                                result.avg_us * result.avg_us;
+        result.std_deviation_us = std::sqrt(std::max(variance, 0.0));
+      }
+      results.push_back(result);
+    }
+  }
+
+  OpBenchmarkResult* best = nullptr;
+  for (OpBenchmarkResult& result : results) {
+    if (!result.error.empty() || result.num_runs == 0) continue;
+    if (best == nullptr || result.avg_us < best->avg_us) best = &result;
+  }
+  if (best != nullptr) best->best = true;
+  return results;
+}
+
+std::vector<OpBenchmarkResult> OpBenchmark::BenchmarkAllNodes() {
+  std::vector<OpBenchmarkResult> results;
+  if (model_interpreter_ == nullptr) return results;
+  for (int node_index : model_interpreter_->execution_plan()) {
+    auto node_results = BenchmarkNode(node_index);
+    results.insert(results.end(), node_results.begin(), node_results.end());
+  }
+  return results;
+}
+
+void WriteResultsCsv(const std::vector<OpBenchmarkResult>& results,
+                     std::ostream* stream) {
+  *stream << "node_index,op,variant,num_threads,num_runs,avg_us,min_us,"
+             "max_us,std_deviation_us,best,error\n";
+  for (const OpBenchmarkResult& result : results) {
+    *stream << result.node_index << "," << CsvField(result.op_name) << ","
+            << CsvField(result.variant) << "," << result.num_threads << ","
+            << result.num_runs << "," << result.avg_us << "," << result.min_us
+            << "," << result.max_us << "," << result.std_deviation_us << ","
+            << (result.best ? 1 : 0) << "," << CsvField(result.error) << "\n";
+  }
+}
+
+void WriteResultsJson(const std::vector<OpBenchmarkResult>& results,
+                      std::ostream* stream) {
+  *stream << "[";
+  const char* separator = "\n";
+  for (const OpBenchmarkResult& result : results) {
+    *stream << separator << "{\"node_index\":" << result.node_index
+            << ",\"op\":";
+    WriteJsonString(result.op_name, stream);
+    *stream << ",\"variant\":";
+    WriteJsonString(result.variant, stream);
+    *stream << ",\"num_threads\":" << result.num_threads
+            << ",\"num_runs\":" << result.num_runs
+            << ",\"avg_us\":" << result.avg_us
+            << ",\"min_us\":" << result.min_us
+            << ",\"max_us\":" << result.max_us
+            << ",\"std_deviation_us\":" << result.std_deviation_us
+            << ",\"best\":" << (result.best ? "true" : "false");
+    if (!result.error.empty()) {
+      *stream << ",\"error\":";
+      WriteJsonString(result.error, stream);
+    }
+    *stream << "}";
+    separator = ",\n";
+  }
+  *stream << "\n]\n";
+}
+
+}  // namespace benchmark
+}  // namespace tflite
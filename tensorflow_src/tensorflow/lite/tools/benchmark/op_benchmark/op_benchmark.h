@@ -0,0 +1,128 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_BENCHMARK_OP_BENCHMARK_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_BENCHMARK_OP_BENCHMARK_H_
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model.h"
+
+namespace tflite {
+namespace benchmark {
+
+// A kernel that can run an operator.
+struct KernelVariant {
+  // E.g. "builtin", "ref" or "generic_opt".
+  std::string name;
+  const TfLiteRegistration* registration;
+};
+
+// Returns the kernels available for a builtin operator: the one of
+// BuiltinOpResolver ("builtin"), the one of BuiltinRefOpResolver ("ref") and
+// the optimized variants exposed by the kernel sources. Kernels the resolvers
+// do not have for `version` are left out.
+std::vector<KernelVariant> GetKernelVariants(int32_t builtin_code,
+                                             int version);
+
+struct OpBenchmarkOptions {
+  // Every kernel variant is run with each of these numbers of threads.
+  std::vector<int> num_threads = {1};
+  int warmup_runs = 1;
+  // Each layer and variant runs at least `min_num_runs` times and until
+  // `min_secs` have elapsed, or `max_secs` at most.
+  int min_num_runs = 10;
+  float min_secs = 0.2f;
+  float max_secs = 5.0f;
+};
+
+// Timing of one layer run by one kernel variant.
+struct OpBenchmarkResult {
+  int node_index;
+  std::string op_name;
+  std::string variant;
+  int num_threads;
+  // Set if the layer could not be run with the variant.
+  std::string error;
+  int64_t num_runs = 0;
+  double avg_us = 0;
+  int64_t min_us = 0;
+  int64_t max_us = 0;
+  double std_deviation_us = 0;
+  // Whether this is the fastest variant of the layer.
+  bool best = false;
+};
+
+// Benchmarks every layer of a model on its own, with every available kernel
+// variant.
+//
+// Each node of the primary subgraph is copied into an interpreter holding
+// only that node: its params, the shapes and quantization of its tensors as
+// prepared in the whole model, and its constant tensors, which are shared
+// with the model. Other inputs are filled with random data. Nodes calling
+// other subgraphs, e.g. IF and WHILE, are not supported.
+class OpBenchmark {
+ public:
+  // `model` must outlive the OpBenchmark.
+  OpBenchmark(const FlatBufferModel* model, const OpBenchmarkOptions& options);
+  ~OpBenchmark();
+
+  // Prepares the whole model to find out the shapes of its tensors.
+  TfLiteStatus Init();
+
+  int num_nodes() const;
+
+  // Benchmarks node `node_index` with every kernel variant and number of
+  // threads, and flags the fastest run.
+  std::vector<OpBenchmarkResult> BenchmarkNode(int node_index);
+
+  // Benchmarks all nodes, in execution order.
+  std::vector<OpBenchmarkResult> BenchmarkAllNodes();
+
+  // Returns an interpreter running node `node_index` of the model alone, with
+  // the given kernel, or null with the reason in `error`. The interpreter
+  // reports its errors to the OpBenchmark, which it must not outlive.
+  std::unique_ptr<Interpreter> CreateSingleOpInterpreter(
+      int node_index, const TfLiteRegistration& registration, int num_threads,
+      std::string* error);
+
+ private:
+  class LastErrorReporter;
+
+  const FlatBufferModel* model_;
+  const OpBenchmarkOptions options_;
+  std::unique_ptr<Interpreter> model_interpreter_;
+  // Keeps the last error of the single-op interpreters, instead of printing
+  // every failure of kernels that do not support a layer.
+  std::unique_ptr<LastErrorReporter> error_reporter_;
+};
+
+// Writes one line per result, with a header line.
+void WriteResultsCsv(const std::vector<OpBenchmarkResult>& results,
+                     std::ostream* stream);
+
+// Writes the results as a JSON array of objects.
+void WriteResultsJson(const std::vector<OpBenchmarkResult>& results,
+                      std::ostream* stream);
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_BENCHMARK_OP_BENCHMARK_H_
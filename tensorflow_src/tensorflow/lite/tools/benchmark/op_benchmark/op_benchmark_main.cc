@@ -0,0 +1,156 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/benchmark/op_benchmark/autotuning_op_resolver.h"
+#include "tensorflow/lite/tools/benchmark/op_benchmark/op_benchmark.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// Stores the fastest variant of every node for each number of threads, as
+// AutotuningOpResolver::Calibrate() would have picked it.
+TfLiteStatus WriteAutotuningCache(const FlatBufferModel* model,
+                                  const std::vector<int>& num_threads,
+                                  const std::vector<OpBenchmarkResult>& results,
+                                  const std::string& cache_file) {
+  for (int threads : num_threads) {
+    AutotuningOpResolver resolver(model, threads);
+    std::vector<std::string> node_variants = resolver.node_variants();
+    std::map<int, double> node_best_us;
+    for (const OpBenchmarkResult& result : results) {
+      if (result.num_threads != threads || !result.error.empty() ||
+          result.node_index >= node_variants.size()) {
+        continue;
+      }
+      auto best = node_best_us.find(result.node_index);
+      if (best == node_best_us.end() || result.avg_us < best->second) {
+        node_best_us[result.node_index] = result.avg_us;
+        node_variants[result.node_index] = result.variant;
+      }
+    }
+    resolver.SetNodeVariants(std::move(node_variants));
+    TF_LITE_ENSURE_STATUS(resolver.SaveCache(cache_file));
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+int Main(int argc, char** argv) {
+  std::string graph;
+  std::string num_threads = "1";
+  int32_t node_index = -1;
+  std::string output_csv_file;
+  std::string output_json_file;
+  std::string autotuning_cache_file;
+  OpBenchmarkOptions options;
+  std::vector<Flag> flag_list = {
+      Flag::CreateFlag("graph", &graph, "Path to the .tflite model.",
+                       Flag::kRequired),
+      Flag::CreateFlag("num_threads", &num_threads,
+                       "Comma-separated numbers of threads every kernel "
+                       "variant is run with, e.g. '1,4'."),
+      Flag::CreateFlag("node", &node_index,
+                       "Index of the only node to benchmark, or -1 for all."),
+      Flag::CreateFlag("warmup_runs", &options.warmup_runs,
+                       "Number of runs before timing each layer."),
+      Flag::CreateFlag("min_num_runs", &options.min_num_runs,
+                       "Minimum number of timed runs of each layer."),
+      Flag::CreateFlag("min_secs", &options.min_secs,
+                       "Minimum time each layer and variant is run for."),
+      Flag::CreateFlag("max_secs", &options.max_secs,
+                       "Maximum time each layer and variant is run for."),
+      Flag::CreateFlag("output_csv_file", &output_csv_file,
+                       "File the results are written to as CSV."),
+      Flag::CreateFlag("output_json_file", &output_json_file,
+                       "File the results are written to as JSON."),
+      Flag::CreateFlag("autotuning_cache_file", &autotuning_cache_file,
+                       "AutotuningOpResolver cache the fastest variant of "
+                       "every node is stored in, for each number of "
+                       "threads."),
+  };
+  if (!Flags::Parse(&argc, const_cast<const char**>(argv), flag_list)) {
+    TFLITE_LOG(ERROR) << Flags::Usage(argv[0], flag_list);
+    return EXIT_FAILURE;
+  }
+  options.num_threads.clear();
+  if (!util::SplitAndParse(num_threads, ',', &options.num_threads) ||
+      options.num_threads.empty()) {
+    TFLITE_LOG(ERROR) << "Invalid --num_threads: " << num_threads;
+    return EXIT_FAILURE;
+  }
+
+  auto model = FlatBufferModel::BuildFromFile(graph.c_str());
+  if (model == nullptr) {
+    TFLITE_LOG(ERROR) << "Failed to load model " << graph;
+    return EXIT_FAILURE;
+  }
+  OpBenchmark benchmark(model.get(), options);
+  if (benchmark.Init() != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Failed to prepare model " << graph;
+    return EXIT_FAILURE;
+  }
+
+  const std::vector<OpBenchmarkResult> results =
+      node_index >= 0 ? benchmark.BenchmarkNode(node_index)
+                      : benchmark.BenchmarkAllNodes();
+  for (const OpBenchmarkResult& result : results) {
+    if (result.best) {
+      TFLITE_LOG(INFO) << "Node " << result.node_index << " ("
+                       << result.op_name << "): " << result.variant << " with "
+                       << result.num_threads << " thread(s), "
+                       << result.avg_us << " us";
+    }
+  }
+
+  if (!output_csv_file.empty()) {
+    std::ofstream stream(output_csv_file);
+    WriteResultsCsv(results, &stream);
+    if (!stream) {
+      TFLITE_LOG(ERROR) << "Failed to write " << output_csv_file;
+      return EXIT_FAILURE;
+    }
+  }
+  if (!output_json_file.empty()) {
+    std::ofstream stream(output_json_file);
+    WriteResultsJson(results, &stream);
+    if (!stream) {
+      TFLITE_LOG(ERROR) << "Failed to write " << output_json_file;
+      return EXIT_FAILURE;
+    }
+  }
+  if (!autotuning_cache_file.empty() &&
+      WriteAutotuningCache(model.get(), options.num_threads, results,
+                           autotuning_cache_file) != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Failed to write " << autotuning_cache_file;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+}  // namespace benchmark
+}  // namespace tflite
+
+int main(int argc, char** argv) { return tflite::benchmark::Main(argc, argv); }
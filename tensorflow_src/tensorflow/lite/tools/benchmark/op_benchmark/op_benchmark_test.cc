@@ -0,0 +1,181 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/benchmark/op_benchmark/op_benchmark.h"
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+constexpr char kAddModel[] = "tensorflow/lite/testdata/add.bin";
+constexpr char kQuantizedAddModel[] =
+    "tensorflow/lite/testdata/add_quantized_int8.bin";
+
+std::set<std::string> GetVariantNames(int32_t builtin_code) {
+  std::set<std::string> names;
+  for (const KernelVariant& variant :
+       GetKernelVariants(builtin_code, /*version=*/1)) {
+    EXPECT_NE(variant.registration, nullptr) << variant.name;
+    names.insert(variant.name);
+  }
+  return names;
+}
+
+OpBenchmarkOptions GetFastOptions() {
+  OpBenchmarkOptions options;
+  options.num_threads = {1, 2};
+  options.min_num_runs = 3;
+  options.min_secs = 0;
+  options.max_secs = 1;
+  return options;
+}
+
+TEST(OpBenchmarkTest, KernelVariants) {
+  EXPECT_EQ(std::set<std::string>(
+                {"builtin", "ref", "generic_opt", "multithreaded_opt"}),
+            GetVariantNames(BuiltinOperator_CONV_2D));
+  EXPECT_EQ(std::set<std::string>({"builtin", "ref"}),
+            GetVariantNames(BuiltinOperator_RESHAPE));
+  EXPECT_TRUE(GetKernelVariants(BuiltinOperator_ADD, /*version=*/1000).empty());
+}
+
+TEST(OpBenchmarkTest, SingleOpInterpreter) {
+  auto model = FlatBufferModel::BuildFromFile(kAddModel);
+  ASSERT_NE(model, nullptr);
+  OpBenchmark benchmark(model.get(), GetFastOptions());
+  ASSERT_EQ(kTfLiteOk, benchmark.Init());
+  ASSERT_EQ(2, benchmark.num_nodes());
+
+  const auto variants = GetKernelVariants(BuiltinOperator_ADD, /*version=*/1);
+  ASSERT_FALSE(variants.empty());
+  for (const KernelVariant& variant : variants) {
+    std::string error;
+    // The second node adds the output of the first one and the model input.
+    auto interpreter = benchmark.CreateSingleOpInterpreter(
+        /*node_index=*/1, *variant.registration, /*num_threads=*/1, &error);
+    ASSERT_NE(interpreter, nullptr) << variant.name << ": " << error;
+    ASSERT_EQ(2, interpreter->inputs().size());
+    ASSERT_EQ(1, interpreter->outputs().size());
+    ASSERT_EQ(1, interpreter->nodes_size());
+    TfLiteTensor* output = interpreter->tensor(interpreter->outputs()[0]);
+    ASSERT_EQ(4, output->dims->size);
+    EXPECT_EQ(3, output->dims->data[3]);
+
+    float* input1 = interpreter->typed_input_tensor<float>(0);
+    float* input2 = interpreter->typed_input_tensor<float>(1);
+    for (int i = 0; i < 8 * 8 * 3; ++i) {
+      input1[i] = i;
+      input2[i] = 0.5f;
+    }
+    ASSERT_EQ(kTfLiteOk, interpreter->Invoke()) << variant.name;
+    for (int i = 0; i < 8 * 8 * 3; ++i) {
+      EXPECT_EQ(i + 0.5f, output->data.f[i]) << variant.name;
+    }
+  }
+}
+
+TEST(OpBenchmarkTest, CopiesQuantization) {
+  auto model = FlatBufferModel::BuildFromFile(kQuantizedAddModel);
+  ASSERT_NE(model, nullptr);
+  OpBenchmark benchmark(model.get(), GetFastOptions());
+  ASSERT_EQ(kTfLiteOk, benchmark.Init());
+  const KernelVariant builtin =
+      GetKernelVariants(BuiltinOperator_ADD, /*version=*/1)[0];
+  std::string error;
+  auto interpreter = benchmark.CreateSingleOpInterpreter(
+      /*node_index=*/0, *builtin.registration, /*num_threads=*/1, &error);
+  ASSERT_NE(interpreter, nullptr) << error;
+  const TfLiteTensor* input = interpreter->tensor(interpreter->inputs()[0]);
+  EXPECT_EQ(kTfLiteInt8, input->type);
+  ASSERT_EQ(kTfLiteAffineQuantization, input->quantization.type);
+  EXPECT_NEAR(0.003922, input->params.scale, 1e-6);
+}
+
+TEST(OpBenchmarkTest, BenchmarkNode) {
+  auto model = FlatBufferModel::BuildFromFile(kAddModel);
+  ASSERT_NE(model, nullptr);
+  OpBenchmark benchmark(model.get(), GetFastOptions());
+  ASSERT_EQ(kTfLiteOk, benchmark.Init());
+
+  const auto results = benchmark.BenchmarkNode(0);
+  // Every variant, with 1 and 2 threads.
+  ASSERT_EQ(
+      2 * GetKernelVariants(BuiltinOperator_ADD, /*version=*/1).size(),
+      results.size());
+  int num_best = 0;
+  for (const OpBenchmarkResult& result : results) {
+    EXPECT_EQ(0, result.node_index);
+    EXPECT_EQ("ADD", result.op_name);
+    EXPECT_TRUE(result.error.empty()) << result.error;
+    EXPECT_GE(result.num_runs, 3);
+    EXPECT_LE(result.min_us, result.avg_us);
+    EXPECT_LE(result.avg_us, result.max_us);
+    if (result.best) ++num_best;
+  }
+  EXPECT_EQ(1, num_best);
+  EXPECT_EQ(2 * results.size(), benchmark.BenchmarkAllNodes().size());
+}
+
+TEST(OpBenchmarkTest, WriteResults) {
+  OpBenchmarkResult fast;
+  fast.node_index = 3;
+  fast.op_name = "CONV_2D";
+  fast.variant = "generic_opt";
+  fast.num_threads = 2;
+  fast.num_runs = 10;
+  fast.avg_us = 12.5;
+  fast.min_us = 10;
+  fast.max_us = 20;
+  fast.std_deviation_us = 2;
+  fast.best = true;
+  OpBenchmarkResult failed = fast;
+  failed.variant = "ref";
+  failed.num_runs = 0;
+  failed.best = false;
+  failed.error = "Type \"INT16\" is not supported";
+
+  std::stringstream csv;
+  WriteResultsCsv({fast, failed}, &csv);
+  EXPECT_EQ(
+      "node_index,op,variant,num_threads,num_runs,avg_us,min_us,max_us,"
+      "std_deviation_us,best,error\n"
+      "3,CONV_2D,generic_opt,2,10,12.5,10,20,2,1,\n"
+      "3,CONV_2D,ref,2,0,12.5,10,20,2,0,\"Type \"\"INT16\"\" is not "
+      "supported\"\n",
+      csv.str());
+
+  std::stringstream json;
+  WriteResultsJson({fast, failed}, &json);
+  EXPECT_EQ(
+      "[\n{\"node_index\":3,\"op\":\"CONV_2D\",\"variant\":\"generic_opt\","
+      "\"num_threads\":2,\"num_runs\":10,\"avg_us\":12.5,\"min_us\":10,"
+      "\"max_us\":20,\"std_deviation_us\":2,\"best\":true},\n"
+      "{\"node_index\":3,\"op\":\"CONV_2D\",\"variant\":\"ref\","
+      "\"num_threads\":2,\"num_runs\":0,\"avg_us\":12.5,\"min_us\":10,"
+      "\"max_us\":20,\"std_deviation_us\":2,\"best\":false,"
+      "\"error\":\"Type \\\"INT16\\\" is not supported\"}\n]\n",
+      json.str());
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
@@ -25,10 +25,12 @@ namespace benchmark {
 ProfilingListener::ProfilingListener(
     Interpreter* interpreter, uint32_t max_num_entries,
     const std::string& csv_file_path,
-    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter)
+    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter,
+    bool report_op_cost)
     : run_summarizer_(summarizer_formatter),
       init_summarizer_(summarizer_formatter),
       csv_file_path_(csv_file_path),
+      report_op_cost_(report_op_cost),
       interpreter_(interpreter),
       profiler_(max_num_entries) {
   TFLITE_TOOLS_CHECK(interpreter);
@@ -79,6 +81,11 @@ void ProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
     WriteOutput("Operator-wise Profiling Info for Regular Benchmark Runs:",
                 run_summarizer_.GetOutputString(),
                 output_stream == nullptr ? &TFLITE_LOG(INFO) : output_stream);
+    if (report_op_cost_) {
+      WriteOutput("Estimated Operator Cost for Regular Benchmark Runs:",
+                  run_summarizer_.GetOpCostString(),
+                  output_stream == nullptr ? &TFLITE_LOG(INFO) : output_stream);
+    }
   }
 }
 
@@ -33,7 +33,8 @@ class ProfilingListener : public BenchmarkListener {
       Interpreter* interpreter, uint32_t max_num_entries,
       const std::string& csv_file_path = "",
       std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter =
-          std::make_shared<profiling::ProfileSummaryDefaultFormatter>());
+          std::make_shared<profiling::ProfileSummaryDefaultFormatter>(),
+      bool report_op_cost = false);
 
   void OnBenchmarkStart(const BenchmarkParams& params) override;
 
@@ -47,6 +48,8 @@ class ProfilingListener : public BenchmarkListener {
   profiling::ProfileSummarizer run_summarizer_;
   profiling::ProfileSummarizer init_summarizer_;
   std::string csv_file_path_;
+  // Whether to also report the estimated cost of operators per node type.
+  bool report_op_cost_;
 
  private:
   void WriteOutput(const std::string& header, const string& data,
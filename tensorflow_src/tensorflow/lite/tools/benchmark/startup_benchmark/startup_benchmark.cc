@@ -0,0 +1,320 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/benchmark/startup_benchmark/startup_benchmark.h"
+
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/allocation.h"
+#include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/profiling/memory_info.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// Sums the durations of the events recorded while a phase runs by tag, in the
+// order the tags are first seen. Events nested in others, e.g. the
+// preparation of the operators of a WHILE body, are counted in both.
+class PartsProfiler : public Profiler {
+ public:
+  uint32_t BeginEvent(const char* tag, EventType event_type,
+                      int64_t event_metadata1,
+                      int64_t event_metadata2) override {
+    if (!IsPart(tag, event_type)) return 0;
+    open_events_.push_back(
+        {PartName(tag, event_type), profiling::time::NowMicros()});
+    return open_events_.size();
+  }
+
+  void EndEvent(uint32_t event_handle) override {
+    if (event_handle == 0 || event_handle > open_events_.size()) return;
+    const OpenEvent& event = open_events_[event_handle - 1];
+    AddPart(event.name, profiling::time::NowMicros() - event.begin_us);
+  }
+
+  // Returns the parts recorded since the last call.
+  std::vector<StartupPhase> TakeParts() {
+    std::vector<StartupPhase> parts = std::move(parts_);
+    parts_.clear();
+    part_index_.clear();
+    open_events_.clear();
+    return parts;
+  }
+
+ private:
+  struct OpenEvent {
+    std::string name;
+    uint64_t begin_us;
+  };
+
+  static std::string PartName(const char* tag, EventType event_type) {
+    if (event_type == EventType::OPERATOR_PREPARE_EVENT) {
+      return std::string("Prepare/") + tag;
+    } else if (event_type == EventType::OPERATOR_INVOKE_EVENT) {
+      return std::string("Invoke/") + tag;
+    }
+    return tag;
+  }
+
+  void AddPart(const std::string& name, uint64_t duration_us) {
+    auto it = part_index_.find(name);
+    if (it == part_index_.end()) {
+      it = part_index_.emplace(name, parts_.size()).first;
+      StartupPhase part;
+      part.name = name;
+      part.depth = 1;
+      part.count = 0;
+      parts_.push_back(part);
+    }
+    StartupPhase& part = parts_[it->second];
+    ++part.count;
+    part.duration_us += duration_us;
+  }
+
+  // The "AllocateTensors" and "Invoke" events of the interpreter span whole
+  // phases, and backend tasks are already part of the operators.
+  static bool IsPart(const char* tag, EventType event_type) {
+    if (event_type == EventType::DEFAULT) {
+      return std::strcmp(tag, "AllocateTensors") != 0 &&
+             std::strcmp(tag, "Invoke") != 0;
+    }
+    return event_type == EventType::OPERATOR_PREPARE_EVENT ||
+           event_type == EventType::OPERATOR_INVOKE_EVENT ||
+           event_type == EventType::DELEGATE_OPERATOR_INVOKE_EVENT;
+  }
+
+  std::vector<OpenEvent> open_events_;
+  std::vector<StartupPhase> parts_;
+  std::map<std::string, int> part_index_;
+};
+
+// Measures a phase, and the page faults and resident memory it causes.
+class PhaseTimer {
+ public:
+  explicit PhaseTimer(const char* name)
+      : name_(name),
+        begin_usage_(profiling::memory::GetMemoryUsage()),
+        begin_rss_kb_(profiling::memory::GetCurrentRssKb()),
+        begin_us_(profiling::time::NowMicros()) {}
+
+  StartupPhase Stop() const {
+    const uint64_t end_us = profiling::time::NowMicros();
+    StartupPhase phase;
+    phase.name = name_;
+    phase.duration_us = end_us - begin_us_;
+    const profiling::memory::MemoryUsage usage =
+        profiling::memory::GetMemoryUsage() - begin_usage_;
+    const int64_t end_rss_kb = profiling::memory::GetCurrentRssKb();
+    if (usage.IsSupported()) {
+      phase.has_memory_usage = true;
+      phase.minor_page_faults = usage.minor_page_faults;
+      phase.major_page_faults = usage.major_page_faults;
+      if (begin_rss_kb_ != profiling::memory::MemoryUsage::kValueNotSet &&
+          end_rss_kb != profiling::memory::MemoryUsage::kValueNotSet) {
+        phase.rss_delta_kb = end_rss_kb - begin_rss_kb_;
+      }
+    }
+    return phase;
+  }
+
+ private:
+  const char* name_;
+  profiling::memory::MemoryUsage begin_usage_;
+  int64_t begin_rss_kb_;
+  uint64_t begin_us_;
+};
+
+// Zeroes the inputs, so that the invocations do not read uninitialized memory.
+void ZeroInputs(Interpreter* interpreter) {
+  for (int input : interpreter->inputs()) {
+    TfLiteTensor* tensor = interpreter->tensor(input);
+    if (tensor->type != kTfLiteString && tensor->data.raw != nullptr) {
+      std::memset(tensor->data.raw, 0, tensor->bytes);
+    }
+  }
+}
+
+}  // namespace
+
+StartupBenchmark::~StartupBenchmark() {
+  // The profiler of the last run is gone by now.
+  if (interpreter_) interpreter_->SetProfiler(nullptr);
+}
+
+TfLiteStatus StartupBenchmark::Run() {
+  phases_.clear();
+  prefetcher_.reset();
+  interpreter_.reset();
+  model_.reset();
+  PartsProfiler profiler;
+  auto add_phase = [this, &profiler](const PhaseTimer& timer) {
+    phases_.push_back(timer.Stop());
+    for (StartupPhase& part : profiler.TakeParts()) {
+      phases_.push_back(std::move(part));
+    }
+  };
+
+  {
+    PhaseTimer timer("BuildFromFile");
+    MMapOptions mmap_options;
+    mmap_options.populate = options_.mmap_populate;
+    model_ = FlatBufferModel::BuildFromFile(graph_.c_str(), mmap_options);
+    add_phase(timer);
+  }
+  if (model_ == nullptr) {
+    TFLITE_LOG(ERROR) << "Failed to load model " << graph_;
+    return kTfLiteError;
+  }
+
+  if (options_.verify_model) {
+    PhaseTimer timer("VerifyModel");
+    const Allocation* allocation = model_->allocation();
+    flatbuffers::Verifier verifier(
+        static_cast<const uint8_t*>(allocation->base()), allocation->bytes());
+    const bool verified = VerifyModelBuffer(verifier);
+    add_phase(timer);
+    if (!verified) {
+      TFLITE_LOG(ERROR) << "Model " << graph_ << " failed verification";
+      return kTfLiteError;
+    }
+  }
+
+  {
+    // Registering the builtin operators is part of building the interpreter.
+    PhaseTimer timer("InterpreterBuilder");
+    ops::builtin::BuiltinOpResolver resolver;
+    InterpreterBuilder builder(*model_, resolver);
+    builder.SetProfiler(&profiler);
+    const TfLiteStatus status = builder(&interpreter_, options_.num_threads);
+    add_phase(timer);
+    if (status != kTfLiteOk || interpreter_ == nullptr) {
+      TFLITE_LOG(ERROR) << "Failed to build the interpreter of " << graph_;
+      return kTfLiteError;
+    }
+  }
+
+  // From here on, the preparation and invocation of the operators are the
+  // parts of the phases.
+  interpreter_->SetProfiler(&profiler);
+  TfLiteStatus status = kTfLiteOk;
+  {
+    PhaseTimer timer("AllocateTensors");
+    status = interpreter_->AllocateTensors();
+    add_phase(timer);
+  }
+  if (status == kTfLiteOk &&
+      (options_.prefault_weights || options_.read_ahead_nodes > 0 ||
+       options_.lock_weights_kb > 0)) {
+    prefetcher_.reset(
+        new WeightPrefetcher(interpreter_.get(), model_->allocation()));
+  }
+  if (status == kTfLiteOk && options_.prefault_weights) {
+    PhaseTimer timer("PrefaultWeights");
+    prefetcher_->Prefault();
+    add_phase(timer);
+  }
+  if (status == kTfLiteOk && options_.lock_weights_kb > 0) {
+    PhaseTimer timer("LockWeights");
+    prefetcher_->Lock(static_cast<size_t>(options_.lock_weights_kb) * 1024);
+    add_phase(timer);
+  }
+  if (status == kTfLiteOk) {
+    ZeroInputs(interpreter_.get());
+    // The read-ahead follows the operators through the profiling events, and
+    // passes them on to `profiler`.
+    if (options_.read_ahead_nodes > 0) {
+      prefetcher_->StartReadAhead(options_.read_ahead_nodes,
+                                  WeightPrefetcher::Mode::kTouch, &profiler);
+      interpreter_->SetProfiler(prefetcher_.get());
+    }
+    PhaseTimer timer("FirstInvoke");
+    status = interpreter_->Invoke();
+    add_phase(timer);
+    if (options_.read_ahead_nodes > 0) {
+      prefetcher_->StopReadAhead();
+      interpreter_->SetProfiler(&profiler);
+    }
+  }
+  if (status == kTfLiteOk) {
+    PhaseTimer timer("SecondInvoke");
+    status = interpreter_->Invoke();
+    add_phase(timer);
+  }
+  interpreter_->SetProfiler(nullptr);
+  if (status != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Failed to run " << graph_;
+  }
+  return status;
+}
+
+WeightPrefetchStats StartupBenchmark::prefetch_stats() const {
+  return prefetcher_ ? prefetcher_->stats() : WeightPrefetchStats();
+}
+
+void StartupBenchmark::OutputToStream(std::ostream* stream) const {
+  *stream << std::left << std::setw(40) << "Phase" << std::right
+          << std::setw(8) << "Count" << std::setw(14) << "Time (us)"
+          << std::setw(14) << "Minor faults" << std::setw(14)
+          << "Major faults" << std::setw(16) << "RSS delta (KB)" << "\n";
+  for (const StartupPhase& phase : phases_) {
+    const std::string name = std::string(2 * phase.depth, ' ') + phase.name;
+    *stream << std::left << std::setw(40) << name << std::right
+            << std::setw(8) << phase.count << std::setw(14)
+            << phase.duration_us;
+    if (phase.has_memory_usage) {
+      *stream << std::setw(14) << phase.minor_page_faults << std::setw(14)
+              << phase.major_page_faults << std::setw(16)
+              << phase.rss_delta_kb;
+    }
+    *stream << "\n";
+  }
+  if (prefetcher_) {
+    const WeightPrefetchStats stats = prefetcher_->stats();
+    *stream << "Weights: " << stats.weight_bytes << " bytes, "
+            << stats.prefaulted_bytes << " prefaulted, "
+            << stats.read_ahead_bytes << " read ahead, " << stats.locked_bytes
+            << " locked; " << stats.late_nodes
+            << " nodes ran before their weights were read ahead\n";
+  }
+}
+
+void StartupBenchmark::OutputToCsv(std::ostream* stream) const {
+  *stream << "phase,depth,count,duration_us,minor_page_faults,"
+             "major_page_faults,rss_delta_kb\n";
+  for (const StartupPhase& phase : phases_) {
+    *stream << phase.name << "," << phase.depth << "," << phase.count << ","
+            << phase.duration_us << ",";
+    if (phase.has_memory_usage) {
+      *stream << phase.minor_page_faults << "," << phase.major_page_faults
+              << "," << phase.rss_delta_kb;
+    } else {
+      *stream << ",,";
+    }
+    *stream << "\n";
+  }
+}
+
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,109 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_STARTUP_BENCHMARK_STARTUP_BENCHMARK_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_STARTUP_BENCHMARK_STARTUP_BENCHMARK_H_
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/weight_prefetcher.h"
+
+namespace tflite {
+namespace benchmark {
+
+struct StartupBenchmarkOptions {
+  // Whether to verify the model as FlatBufferModel::VerifyAndBuildFromFile()
+  // does.
+  bool verify_model = true;
+  int num_threads = 1;
+  // Whether to map the model with MMapOptions::populate, reading it all in
+  // BuildFromFile.
+  bool mmap_populate = false;
+  // Whether to fault in all weights after AllocateTensors, in the order the
+  // nodes use them.
+  bool prefault_weights = false;
+  // Number of nodes the weights are read ahead of the executing one during the
+  // first invocation, on a helper thread; 0 to disable.
+  int read_ahead_nodes = 0;
+  // KB of the weights of the first nodes to lock in memory after
+  // AllocateTensors; 0 to disable.
+  int lock_weights_kb = 0;
+};
+
+// Cost of a phase of the startup, or of a part of one.
+struct StartupPhase {
+  std::string name;
+  // 0 for the phases, 1 for their parts, e.g. the parsing of the nodes while
+  // building the interpreter.
+  int depth = 0;
+  // Number of times the part ran, e.g. once per subgraph or per operator.
+  int64_t count = 1;
+  int64_t duration_us = 0;
+  // Page faults and change of the resident set size, only measured for the
+  // phases.
+  bool has_memory_usage = false;
+  int64_t minor_page_faults = 0;
+  int64_t major_page_faults = 0;
+  int64_t rss_delta_kb = 0;
+};
+
+// Breaks down the cold start of a model into its phases: mapping the model
+// file, verifying it, building the interpreter (resolving the operators and
+// parsing the nodes, tensors and quantization parameters), allocating the
+// tensors (preparing every operator and planning the arena), and the first and
+// second invocations. With the options bringing the weights into memory, see
+// WeightPrefetcher, their cost moves from the first invocation to phases of
+// their own.
+//
+// Only the first Run() in a process measures a cold start, later ones find
+// the model mapped and the kernels initialized.
+class StartupBenchmark {
+ public:
+  StartupBenchmark(const std::string& graph,
+                   const StartupBenchmarkOptions& options)
+      : graph_(graph), options_(options) {}
+  ~StartupBenchmark();
+
+  TfLiteStatus Run();
+
+  const std::vector<StartupPhase>& phases() const { return phases_; }
+  // Statistics of the weights brought into memory, all zero unless one of
+  // the options doing so is set.
+  WeightPrefetchStats prefetch_stats() const;
+
+  // Logs the phases as a table.
+  void OutputToStream(std::ostream* stream) const;
+  void OutputToCsv(std::ostream* stream) const;
+
+ private:
+  std::string graph_;
+  StartupBenchmarkOptions options_;
+  std::vector<StartupPhase> phases_;
+  std::unique_ptr<FlatBufferModel> model_;
+  std::unique_ptr<Interpreter> interpreter_;
+  // Destroyed before the interpreter and the model it refers to.
+  std::unique_ptr<WeightPrefetcher> prefetcher_;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_STARTUP_BENCHMARK_STARTUP_BENCHMARK_H_
@@ -0,0 +1,79 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/tools/benchmark/startup_benchmark/startup_benchmark.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+
+int Main(int argc, char** argv) {
+  std::string graph;
+  std::string output_csv_file;
+  StartupBenchmarkOptions options;
+  std::vector<Flag> flag_list = {
+      Flag::CreateFlag("graph", &graph, "Path to the .tflite model.",
+                       Flag::kRequired),
+      Flag::CreateFlag("num_threads", &options.num_threads,
+                       "Number of threads the interpreter is built with."),
+      Flag::CreateFlag("verify_model", &options.verify_model,
+                       "Whether to verify the model before building the "
+                       "interpreter."),
+      Flag::CreateFlag("mmap_populate", &options.mmap_populate,
+                       "Whether to read the whole model when mapping it."),
+      Flag::CreateFlag("prefault_weights", &options.prefault_weights,
+                       "Whether to fault in the weights in node order after "
+                       "allocating the tensors."),
+      Flag::CreateFlag("read_ahead_nodes", &options.read_ahead_nodes,
+                       "Number of nodes to read the weights ahead of during "
+                       "the first invocation, 0 to disable."),
+      Flag::CreateFlag("lock_weights_kb", &options.lock_weights_kb,
+                       "KB of weights of the first nodes to lock in memory, "
+                       "0 to disable."),
+      Flag::CreateFlag("output_csv_file", &output_csv_file,
+                       "File the phases are written to as CSV."),
+  };
+  if (!Flags::Parse(&argc, const_cast<const char**>(argv), flag_list)) {
+    TFLITE_LOG(ERROR) << Flags::Usage(argv[0], flag_list);
+    return EXIT_FAILURE;
+  }
+
+  // Only the first run is a cold start, so there is a single one.
+  StartupBenchmark benchmark(graph, options);
+  const TfLiteStatus status = benchmark.Run();
+  benchmark.OutputToStream(&std::cout);
+  if (status != kTfLiteOk) return EXIT_FAILURE;
+
+  if (!output_csv_file.empty()) {
+    std::ofstream stream(output_csv_file);
+    benchmark.OutputToCsv(&stream);
+    if (!stream) {
+      TFLITE_LOG(ERROR) << "Failed to write " << output_csv_file;
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
+
+}  // namespace benchmark
+}  // namespace tflite
+
+int main(int argc, char** argv) { return tflite::benchmark::Main(argc, argv); }
@@ -0,0 +1,180 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/benchmark/startup_benchmark/startup_benchmark.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+constexpr char kAddModel[] = "tensorflow/lite/testdata/add.bin";
+// Has weights, unlike kAddModel.
+constexpr char kLstmModel[] = "tensorflow/lite/testdata/lstm.bin";
+
+const StartupPhase* FindPhase(const std::vector<StartupPhase>& phases,
+                              const std::string& name) {
+  for (const StartupPhase& phase : phases) {
+    if (phase.name == name) return &phase;
+  }
+  return nullptr;
+}
+
+TEST(StartupBenchmarkTest, PhasesInOrder) {
+  StartupBenchmark benchmark(kAddModel, StartupBenchmarkOptions());
+  ASSERT_EQ(kTfLiteOk, benchmark.Run());
+  std::vector<std::string> phase_names;
+  for (const StartupPhase& phase : benchmark.phases()) {
+    if (phase.depth == 0) phase_names.push_back(phase.name);
+    EXPECT_GE(phase.duration_us, 0);
+  }
+  EXPECT_EQ(std::vector<std::string>({"BuildFromFile", "VerifyModel",
+                                      "InterpreterBuilder", "AllocateTensors",
+                                      "FirstInvoke", "SecondInvoke"}),
+            phase_names);
+}
+
+TEST(StartupBenchmarkTest, SumsQuantizationParsing) {
+  // The quantization of the tensors of a subgraph is one part.
+  StartupBenchmark benchmark("tensorflow/lite/testdata/add_quantized.bin",
+                             StartupBenchmarkOptions());
+  ASSERT_EQ(kTfLiteOk, benchmark.Run());
+  const StartupPhase* part =
+      FindPhase(benchmark.phases(), "ParseQuantization");
+  ASSERT_NE(nullptr, part);
+  EXPECT_EQ(1, part->depth);
+  EXPECT_EQ(1, part->count);
+
+  StartupBenchmark float_benchmark(kAddModel, StartupBenchmarkOptions());
+  ASSERT_EQ(kTfLiteOk, float_benchmark.Run());
+  EXPECT_EQ(nullptr, FindPhase(float_benchmark.phases(), "ParseQuantization"));
+}
+
+TEST(StartupBenchmarkTest, SkipsVerification) {
+  StartupBenchmarkOptions options;
+  options.verify_model = false;
+  StartupBenchmark benchmark(kAddModel, options);
+  ASSERT_EQ(kTfLiteOk, benchmark.Run());
+  EXPECT_EQ(nullptr, FindPhase(benchmark.phases(), "VerifyModel"));
+}
+
+TEST(StartupBenchmarkTest, BreaksDownPhases) {
+  StartupBenchmark benchmark(kAddModel, StartupBenchmarkOptions());
+  ASSERT_EQ(kTfLiteOk, benchmark.Run());
+  const std::vector<StartupPhase>& phases = benchmark.phases();
+  for (const char* name : {"ResolveOps", "ParseNodes", "ParseTensors"}) {
+    const StartupPhase* part = FindPhase(phases, name);
+    ASSERT_NE(nullptr, part) << name;
+    EXPECT_EQ(1, part->depth);
+    EXPECT_EQ(1, part->count);
+  }
+  // The model has two ADD nodes, prepared once and run twice.
+  const StartupPhase* prepare = FindPhase(phases, "Prepare/ADD");
+  ASSERT_NE(nullptr, prepare);
+  EXPECT_EQ(2, prepare->count);
+  const StartupPhase* invoke = FindPhase(phases, "Invoke/ADD");
+  ASSERT_NE(nullptr, invoke);
+  EXPECT_EQ(2, invoke->count);
+  // Parts follow the phase they belong to.
+  int allocate_index = -1;
+  int prepare_index = -1;
+  for (int i = 0; i < phases.size(); ++i) {
+    if (phases[i].name == "AllocateTensors") allocate_index = i;
+    if (phases[i].name == "Prepare/ADD") prepare_index = i;
+  }
+  EXPECT_EQ(allocate_index + 1, prepare_index);
+}
+
+TEST(StartupBenchmarkTest, MeasuresMemoryOfPhases) {
+  StartupBenchmark benchmark(kAddModel, StartupBenchmarkOptions());
+  ASSERT_EQ(kTfLiteOk, benchmark.Run());
+  for (const StartupPhase& phase : benchmark.phases()) {
+    if (phase.depth > 0) {
+      EXPECT_FALSE(phase.has_memory_usage) << phase.name;
+      continue;
+    }
+#ifdef __linux__
+    EXPECT_TRUE(phase.has_memory_usage) << phase.name;
+#endif
+    EXPECT_GE(phase.minor_page_faults, 0);
+    EXPECT_GE(phase.major_page_faults, 0);
+  }
+}
+
+TEST(StartupBenchmarkTest, OutputToCsv) {
+  StartupBenchmark benchmark(kAddModel, StartupBenchmarkOptions());
+  ASSERT_EQ(kTfLiteOk, benchmark.Run());
+  std::stringstream stream;
+  benchmark.OutputToCsv(&stream);
+  std::string line;
+  ASSERT_TRUE(std::getline(stream, line));
+  EXPECT_EQ(
+      "phase,depth,count,duration_us,minor_page_faults,major_page_faults,"
+      "rss_delta_kb",
+      line);
+  ASSERT_TRUE(std::getline(stream, line));
+  EXPECT_EQ(0, line.find("BuildFromFile,0,1,"));
+}
+
+TEST(StartupBenchmarkTest, PrefetchesWeights) {
+  StartupBenchmarkOptions options;
+  options.mmap_populate = true;
+  options.prefault_weights = true;
+  options.read_ahead_nodes = 2;
+  options.lock_weights_kb = 64;
+  StartupBenchmark benchmark(kLstmModel, options);
+  ASSERT_EQ(kTfLiteOk, benchmark.Run());
+  std::vector<std::string> phase_names;
+  for (const StartupPhase& phase : benchmark.phases()) {
+    if (phase.depth == 0) phase_names.push_back(phase.name);
+  }
+  EXPECT_EQ(std::vector<std::string>(
+                {"BuildFromFile", "VerifyModel", "InterpreterBuilder",
+                 "AllocateTensors", "PrefaultWeights", "LockWeights",
+                 "FirstInvoke", "SecondInvoke"}),
+            phase_names);
+  // The operator events of the first invocation still reach the breakdown
+  // through the read-ahead.
+  const StartupPhase* invoke = FindPhase(benchmark.phases(), "Invoke/LSTM");
+  ASSERT_NE(nullptr, invoke);
+  EXPECT_EQ(1, invoke->count);
+
+  const WeightPrefetchStats stats = benchmark.prefetch_stats();
+  EXPECT_GT(stats.weight_bytes, 0);
+  EXPECT_EQ(stats.weight_bytes, stats.prefaulted_bytes);
+  EXPECT_LE(stats.read_ahead_bytes, stats.weight_bytes);
+  EXPECT_LE(stats.locked_bytes, 64 * 1024);
+}
+
+TEST(StartupBenchmarkTest, NoPrefetchByDefault) {
+  StartupBenchmark benchmark(kLstmModel, StartupBenchmarkOptions());
+  ASSERT_EQ(kTfLiteOk, benchmark.Run());
+  EXPECT_EQ(nullptr, FindPhase(benchmark.phases(), "PrefaultWeights"));
+  EXPECT_EQ(0, benchmark.prefetch_stats().weight_bytes);
+}
+
+TEST(StartupBenchmarkTest, MissingModel) {
+  StartupBenchmark benchmark("does/not/exist.tflite",
+                             StartupBenchmarkOptions());
+  EXPECT_EQ(kTfLiteError, benchmark.Run());
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
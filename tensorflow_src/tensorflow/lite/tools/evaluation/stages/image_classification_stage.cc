@@ -101,31 +101,43 @@ TfLiteStatus ImageClassificationStage::Init(
 }
 
 TfLiteStatus ImageClassificationStage::Run() {
+  TF_LITE_ENSURE_STATUS(RunPreprocessing());
+  TF_LITE_ENSURE_STATUS(RunInference());
+  if (accuracy_eval_stage_) {
+    TF_LITE_ENSURE_STATUS(RunAccuracyEval(this, &ground_truth_label_));
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus ImageClassificationStage::RunPreprocessing() {
   if (image_path_.empty()) {
     LOG(ERROR) << "Input image not set";
     return kTfLiteError;
   }
-
-  // Preprocessing.
   preprocessing_stage_->SetImagePath(&image_path_);
-  if (preprocessing_stage_->Run() != kTfLiteOk) return kTfLiteError;
-  // Inference.
+  return preprocessing_stage_->Run();
+}
+
+TfLiteStatus ImageClassificationStage::RunInference() {
   std::vector<void*> data_ptrs = {};
   data_ptrs.push_back(preprocessing_stage_->GetPreprocessedImageData());
   inference_stage_->SetInputs(data_ptrs);
-  if (inference_stage_->Run() != kTfLiteOk) return kTfLiteError;
-  // Accuracy Eval.
-  if (accuracy_eval_stage_) {
-    if (ground_truth_label_.empty()) {
-      LOG(ERROR) << "Ground truth label not provided";
-      return kTfLiteError;
-    }
-    accuracy_eval_stage_->SetEvalInputs(inference_stage_->GetOutputs()->at(0),
-                                        &ground_truth_label_);
-    if (accuracy_eval_stage_->Run() != kTfLiteOk) return kTfLiteError;
-  }
+  return inference_stage_->Run();
+}
 
-  return kTfLiteOk;
+TfLiteStatus ImageClassificationStage::RunAccuracyEval(
+    ImageClassificationStage* worker, std::string* ground_truth_label) {
+  if (!accuracy_eval_stage_) {
+    LOG(ERROR) << "topk_accuracy_eval_params not provided";
+    return kTfLiteError;
+  }
+  if (ground_truth_label->empty()) {
+    LOG(ERROR) << "Ground truth label not provided";
+    return kTfLiteError;
+  }
+  accuracy_eval_stage_->SetEvalInputs(
+      worker->inference_stage_->GetOutputs()->at(0), ground_truth_label);
+  return accuracy_eval_stage_->Run();
 }
 
 EvaluationStageMetrics ImageClassificationStage::LatestMetrics() {
@@ -60,6 +60,18 @@ class ImageClassificationStage : public EvaluationStage {
     ground_truth_label_ = ground_truth_label;
   }
 
+  // Run() split into its steps, for pipelined evaluations where every worker
+  // preprocesses and runs inference on images with its own stage, and a
+  // single stage accumulates the accuracy of all of them. Call after
+  // SetInputs().
+  TfLiteStatus RunPreprocessing();
+  TfLiteStatus RunInference();
+  // Accumulates the accuracy of the latest inference of `worker`, which may be
+  // this stage. Only uses the TopkAccuracyEvalStage of this stage, so it may
+  // run while other stages, or this one, preprocess or run inference.
+  TfLiteStatus RunAccuracyEval(ImageClassificationStage* worker,
+                               std::string* ground_truth_label);
+
   // Provides a pointer to the underlying TfLiteInferenceStage.
   // Returns non-null value only if this stage has been initialized.
   TfliteInferenceStage* const GetInferenceStage() {
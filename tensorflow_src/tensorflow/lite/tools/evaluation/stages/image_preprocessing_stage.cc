@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/lite/tools/evaluation/proto/evaluation_config.pb.h"
 #include "tensorflow/lite/tools/evaluation/proto/evaluation_stages.pb.h"
 #include "tensorflow/lite/tools/evaluation/proto/preprocessing_steps.pb.h"
+#include "tensorflow/lite/tools/evaluation/stages/utils/image_preprocessing.h"
 
 namespace tflite {
 namespace evaluation {
@@ -59,6 +60,13 @@ struct ImageData {
   }
 };
 
+// Stores an 8-bit image as it was decoded.
+struct DecodedImage {
+  int width = 0;
+  int height = 0;
+  std::unique_ptr<uint8_t[]> data;
+};
+
 // Loads the raw image.
 inline void LoadImageRaw(std::string* filename, ImageData* image_data) {
   std::ifstream stream(filename->c_str(), std::ios::in | std::ios::binary);
@@ -73,15 +81,14 @@ inline void LoadImageRaw(std::string* filename, ImageData* image_data) {
 }
 
 // Loads the jpeg image.
-inline void LoadImageJpeg(std::string* filename, ImageData* image_data) {
+inline void LoadImageJpeg(std::string* filename, DecodedImage* image) {
   // Reads image.
   std::ifstream t(*filename);
   std::string image_str((std::istreambuf_iterator<char>(t)),
                         std::istreambuf_iterator<char>());
   const int fsize = image_str.size();
   auto temp = absl::bit_cast<const uint8_t*>(image_str.data());
-  std::unique_ptr<uint8_t[]> original_image;
-  int original_width, original_height, original_channels;
+  int original_channels;
   tensorflow::jpeg::UncompressFlags flags;
   // JDCT_ISLOW performs slower but more accurate pre-processing.
   // This isn't always obvious in unit tests, but makes a difference during
@@ -89,41 +96,60 @@ inline void LoadImageJpeg(std::string* filename, ImageData* image_data) {
   flags.dct_method = JDCT_ISLOW;
   // We necessarily require a 3-channel image as the output.
   flags.components = kNumChannels;
-  original_image.reset(Uncompress(temp, fsize, flags, &original_width,
-                                  &original_height, &original_channels,
-                                  nullptr));
-  // Copies the image data.
-  image_data->width = original_width;
-  image_data->height = original_height;
-  int original_size = original_height * original_width * original_channels;
-  std::vector<float>* float_image = new std::vector<float>();
-  float_image->reserve(original_size);
-  for (int i = 0; i < original_size; ++i) {
-    float_image->push_back(static_cast<float>(original_image[i]));
-  }
-  image_data->data.reset(float_image);
+  image->data.reset(Uncompress(temp, fsize, flags, &image->width,
+                                &image->height, &original_channels, nullptr));
 }
 
-// Central-cropping.
-inline void Crop(ImageData* image_data, const CroppingParams& crop_params) {
-  int crop_height, crop_width;
-  int input_width = image_data->width;
-  int input_height = image_data->height;
+// Gets the region central-cropping keeps of an image.
+void GetCropRegion(int input_width, int input_height,
+                   const CroppingParams& crop_params, int* start_w,
+                   int* start_h, int* crop_width, int* crop_height) {
+  *crop_height = input_height;
+  *crop_width = input_width;
   if (crop_params.has_cropping_fraction()) {
-    crop_height =
+    *crop_height =
         static_cast<int>(round(crop_params.cropping_fraction() * input_height));
-    crop_width =
+    *crop_width =
         static_cast<int>(round(crop_params.cropping_fraction() * input_width));
   } else if (crop_params.has_target_size()) {
-    crop_height = crop_params.target_size().height();
-    crop_width = crop_params.target_size().width();
+    *crop_height = crop_params.target_size().height();
+    *crop_width = crop_params.target_size().width();
   }
   if (crop_params.has_cropping_fraction() && crop_params.square_cropping()) {
-    crop_height = std::min(crop_height, crop_width);
-    crop_width = crop_height;
+    *crop_height = std::min(*crop_height, *crop_width);
+    *crop_width = *crop_height;
   }
-  int start_w = static_cast<int>(round((input_width - crop_width) / 2.0));
-  int start_h = static_cast<int>(round((input_height - crop_height) / 2.0));
+  *start_w = static_cast<int>(round((input_width - *crop_width) / 2.0));
+  *start_h = static_cast<int>(round((input_height - *crop_height) / 2.0));
+}
+
+// Gets the size of an image after resizing.
+void GetResizedSize(int input_width, int input_height,
+                    const ResizingParams& params, int* output_width,
+                    int* output_height) {
+  if (params.aspect_preserving()) {
+    float ratio_w =
+        params.target_size().width() / static_cast<float>(input_width);
+    float ratio_h =
+        params.target_size().height() / static_cast<float>(input_height);
+    if (ratio_w >= ratio_h) {
+      *output_width = params.target_size().width();
+      *output_height = static_cast<int>(round(input_height * ratio_w));
+    } else {
+      *output_width = static_cast<int>(round(input_width * ratio_h));
+      *output_height = params.target_size().height();
+    }
+  } else {
+    *output_height = params.target_size().height();
+    *output_width = params.target_size().width();
+  }
+}
+
+// Central-cropping.
+inline void Crop(ImageData* image_data, const CroppingParams& crop_params) {
+  int start_w, start_h, crop_width, crop_height;
+  GetCropRegion(image_data->width, image_data->height, crop_params, &start_w,
+                &start_h, &crop_width, &crop_height);
   std::vector<float>* cropped_image = new std::vector<float>();
   cropped_image->reserve(crop_height * crop_width * kNumChannels);
   for (int in_h = start_h; in_h < start_h + crop_height; ++in_h) {
@@ -151,22 +177,8 @@ inline void ResizeBilinear(ImageData* image_data,
                                     kNumChannels});
   // Calculates output size.
   int output_height, output_width;
-  if (params.aspect_preserving()) {
-    float ratio_w =
-        params.target_size().width() / static_cast<float>(image_data->width);
-    float ratio_h =
-        params.target_size().height() / static_cast<float>(image_data->height);
-    if (ratio_w >= ratio_h) {
-      output_width = params.target_size().width();
-      output_height = static_cast<int>(round(image_data->height * ratio_w));
-    } else {
-      output_width = static_cast<int>(round(image_data->width * ratio_h));
-      output_height = params.target_size().height();
-    }
-  } else {
-    output_height = params.target_size().height();
-    output_width = params.target_size().width();
-  }
+  GetResizedSize(image_data->width, image_data->height, params, &output_width,
+                 &output_height);
   tflite::RuntimeShape output_size_dims({1, 1, 1, 2});
   std::vector<int32_t> output_size_data = {output_height, output_width};
   tflite::RuntimeShape output_shape(
@@ -237,6 +249,67 @@ inline void Normalize(ImageData* image_data,
     }
   }
 }
+
+// Returns the number of leading steps that are at most a cropping, a resizing
+// and a normalization, in this order, which image::PreprocessImage() performs
+// in a single pass.
+int NumFusedSteps(const ImagePreprocessingParams& params) {
+  int last_step = -1;
+  for (int i = 0; i < params.steps_size(); ++i) {
+    const ImagePreprocessingStepParams& param = params.steps(i);
+    int step = 3;
+    if (param.has_cropping_params()) {
+      step = 0;
+    } else if (param.has_resizing_params()) {
+      step = 1;
+    } else if (param.has_normalization_params()) {
+      step = 2;
+    }
+    if (step <= last_step || step == 3) return i;
+    last_step = step;
+  }
+  return params.steps_size();
+}
+
+// Gets the parameters of image::PreprocessImage() for the first
+// `num_fused_steps` steps, applied to a `width` x `height` image.
+image::PreprocessingParams GetFusedParams(
+    const ImagePreprocessingParams& params, int num_fused_steps, int width,
+    int height) {
+  image::PreprocessingParams fused;
+  fused.crop_width = width;
+  fused.crop_height = height;
+  fused.output_width = width;
+  fused.output_height = height;
+  fused.fixed_point = params.fixed_point_arithmetic();
+  for (int i = 0; i < num_fused_steps; ++i) {
+    const ImagePreprocessingStepParams& param = params.steps(i);
+    if (param.has_cropping_params()) {
+      GetCropRegion(width, height, param.cropping_params(), &fused.crop_x,
+                    &fused.crop_y, &fused.crop_width, &fused.crop_height);
+      fused.output_width = fused.crop_width;
+      fused.output_height = fused.crop_height;
+    } else if (param.has_resizing_params()) {
+      GetResizedSize(fused.crop_width, fused.crop_height,
+                     param.resizing_params(), &fused.output_width,
+                     &fused.output_height);
+      if (param.resizing_params().resize_method() == ResizingParams::AREA) {
+        fused.resize_method = image::ResizeMethod::kArea;
+      }
+    } else if (param.has_normalization_params()) {
+      const NormalizationParams& normalization = param.normalization_params();
+      if (normalization.has_channelwise_mean()) {
+        fused.mean = {normalization.channelwise_mean()};
+      } else {
+        fused.mean = {normalization.means().r_mean(),
+                      normalization.means().g_mean(),
+                      normalization.means().b_mean()};
+      }
+      fused.scale = normalization.scale();
+    }
+  }
+  return fused;
+}
 }  // namespace
 
 TfLiteStatus ImagePreprocessingStage::Init() {
@@ -259,6 +332,15 @@ TfLiteStatus ImagePreprocessingStage::Init() {
       }
     }
   }
+  // Only image::PreprocessImage() resizes by area.
+  for (int i = NumFusedSteps(params); i < params.steps_size(); ++i) {
+    const ImagePreprocessingStepParams& param = params.steps(i);
+    if (param.has_resizing_params() &&
+        param.resizing_params().resize_method() == ResizingParams::AREA) {
+      LOG(ERROR) << "Area resizing must at most be preceded by a cropping";
+      return kTfLiteError;
+    }
+  }
   output_type_ = static_cast<TfLiteType>(params.output_type());
   return kTfLiteOk;
 }
@@ -277,10 +359,53 @@ TfLiteStatus ImagePreprocessingStage::Run() {
   string image_ext = image_path_->substr(image_path_->find_last_of("."));
   absl::AsciiStrToLower(&image_ext);
   bool is_raw_image = (image_ext == ".rgb8");
+  int num_done_steps = 0;
   if (image_ext == ".rgb8") {
     LoadImageRaw(image_path_, &image_data);
   } else if (image_ext == ".jpg" || image_ext == ".jpeg") {
-    LoadImageJpeg(image_path_, &image_data);
+    DecodedImage image;
+    LoadImageJpeg(image_path_, &image);
+    if (!image.data) {
+      LOG(ERROR) << "Could not decode " << *image_path_;
+      return kTfLiteError;
+    }
+    // The leading cropping, resizing and normalization run in a single pass,
+    // straight into the output if there are no other steps.
+    num_done_steps = NumFusedSteps(params);
+    const image::PreprocessingParams fused_params =
+        GetFusedParams(params, num_done_steps, image.width, image.height);
+    const int output_size =
+        fused_params.output_width * fused_params.output_height * kNumChannels;
+    TfLiteType output_type = kTfLiteFloat32;
+    void* output = nullptr;
+    if (num_done_steps < params.steps_size()) {
+      image_data.width = fused_params.output_width;
+      image_data.height = fused_params.output_height;
+      image_data.data.reset(new std::vector<float>(output_size));
+      output = image_data.data->data();
+    } else if (output_type_ == kTfLiteUInt8) {
+      uint8_preprocessed_image_.resize(output_size);
+      output = uint8_preprocessed_image_.data();
+      output_type = output_type_;
+    } else if (output_type_ == kTfLiteInt8) {
+      int8_preprocessed_image_.resize(output_size);
+      output = int8_preprocessed_image_.data();
+      output_type = output_type_;
+    } else if (output_type_ == kTfLiteFloat32) {
+      float_preprocessed_image_.resize(output_size);
+      output = float_preprocessed_image_.data();
+    }
+    if (output == nullptr ||
+        image::PreprocessImage(image.data.get(), image.width, image.height,
+                               kNumChannels, fused_params, output_type,
+                               output) != kTfLiteOk) {
+      LOG(ERROR) << "Could not preprocess " << *image_path_;
+      return kTfLiteError;
+    }
+    if (num_done_steps == params.steps_size()) {
+      latency_stats_.UpdateStat(profiling::time::NowMicros() - start_us);
+      return kTfLiteOk;
+    }
   } else {
     LOG(ERROR) << "Extension " << image_ext << " is not supported";
     return kTfLiteError;
@@ -289,7 +414,8 @@ TfLiteStatus ImagePreprocessingStage::Run() {
   // Cropping, padding and resizing are not supported with raw images since raw
   // images do not contain image size information. Those steps are assumed to
   // be done before raw images are generated.
-  for (const ImagePreprocessingStepParams& param : params.steps()) {
+  for (int i = num_done_steps; i < params.steps_size(); ++i) {
+    const ImagePreprocessingStepParams& param = params.steps(i);
     if (param.has_cropping_params()) {
       if (is_raw_image) {
         LOG(WARNING) << "Image cropping will not be performed on raw images";
@@ -98,10 +98,12 @@ class ImagePreprocessingConfigBuilder {
   }
 
   // Adds a resizing step.
-  void AddResizingStep(uint32_t width, uint32_t height,
-                       bool aspect_preserving) {
+  void AddResizingStep(
+      uint32_t width, uint32_t height, bool aspect_preserving,
+      ResizingParams::ResizeMethod method = ResizingParams::BILINEAR) {
     ImagePreprocessingStepParams params;
     params.mutable_resizing_params()->set_aspect_preserving(aspect_preserving);
+    params.mutable_resizing_params()->set_resize_method(method);
     params.mutable_resizing_params()->mutable_target_size()->set_height(height);
     params.mutable_resizing_params()->mutable_target_size()->set_width(width);
     config_.mutable_specification()
@@ -176,6 +178,13 @@ class ImagePreprocessingConfigBuilder {
     }
   }
 
+  // Computes uint8 and int8 outputs with integer arithmetic.
+  void SetFixedPointArithmetic(bool fixed_point_arithmetic) {
+    config_.mutable_specification()
+        ->mutable_image_preprocessing_params()
+        ->set_fixed_point_arithmetic(fixed_point_arithmetic);
+  }
+
   EvaluationStageConfig build() { return std::move(config_); }
 
  private:
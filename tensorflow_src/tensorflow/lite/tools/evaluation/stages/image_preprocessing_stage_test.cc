@@ -306,6 +306,50 @@ TEST(ImagePreprocessingStage, TestImagePreprocessingSubtractMean) {
   EXPECT_EQ(metrics.process_metrics().total_latency().avg_us(), last_latency);
 }
 
+TEST(ImagePreprocessingStage, TestImagePreprocessingFixedPointArithmetic) {
+  std::string image_path = kTestImage;
+
+  auto build_config = [](bool fixed_point_arithmetic) {
+    ImagePreprocessingConfigBuilder builder(kImagePreprocessingStageName,
+                                            kTfLiteInt8);
+    builder.AddCroppingStep(0.875);
+    builder.AddResizingStep(224, 224, false);
+    builder.AddNormalizationStep(128.0, 1.0);
+    builder.SetFixedPointArithmetic(fixed_point_arithmetic);
+    return builder.build();
+  };
+  ImagePreprocessingStage stage = ImagePreprocessingStage(build_config(false));
+  ImagePreprocessingStage fixed_point_stage =
+      ImagePreprocessingStage(build_config(true));
+  EXPECT_EQ(stage.Init(), kTfLiteOk);
+  EXPECT_EQ(fixed_point_stage.Init(), kTfLiteOk);
+
+  stage.SetImagePath(&image_path);
+  fixed_point_stage.SetImagePath(&image_path);
+  EXPECT_EQ(stage.Run(), kTfLiteOk);
+  EXPECT_EQ(fixed_point_stage.Run(), kTfLiteOk);
+
+  // Integer arithmetic differs from float arithmetic by at most one.
+  int8_t* preprocessed_image_ptr =
+      static_cast<int8_t*>(stage.GetPreprocessedImageData());
+  int8_t* fixed_point_image_ptr =
+      static_cast<int8_t*>(fixed_point_stage.GetPreprocessedImageData());
+  ASSERT_NE(preprocessed_image_ptr, nullptr);
+  ASSERT_NE(fixed_point_image_ptr, nullptr);
+  for (int i = 0; i < kImageDim * kImageDim * 3; ++i) {
+    EXPECT_NEAR(fixed_point_image_ptr[i], preprocessed_image_ptr[i], 1);
+  }
+}
+
+TEST(ImagePreprocessingStage, AreaResizingAfterPadding) {
+  ImagePreprocessingConfigBuilder builder(kImagePreprocessingStageName,
+                                          kTfLiteFloat32);
+  builder.AddPaddingStep(300, 300, 0);
+  builder.AddResizingStep(224, 224, false, ResizingParams::AREA);
+  ImagePreprocessingStage stage = ImagePreprocessingStage(builder.build());
+  EXPECT_EQ(stage.Init(), kTfLiteError);
+}
+
 }  // namespace
 }  // namespace evaluation
 }  // namespace tflite
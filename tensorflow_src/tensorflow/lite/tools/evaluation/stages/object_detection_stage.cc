@@ -89,16 +89,21 @@ TfLiteStatus ObjectDetectionStage::Init(
 }
 
 TfLiteStatus ObjectDetectionStage::Run() {
+  TF_LITE_ENSURE_STATUS(RunPreprocessing());
+  TF_LITE_ENSURE_STATUS(RunInference());
+  return RunAveragePrecisionEval(predicted_objects_, *ground_truth_objects_);
+}
+
+TfLiteStatus ObjectDetectionStage::RunPreprocessing() {
   if (image_path_.empty()) {
     LOG(ERROR) << "Input image not set";
     return kTfLiteError;
   }
-
-  // Preprocessing.
   preprocessing_stage_->SetImagePath(&image_path_);
-  TF_LITE_ENSURE_STATUS(preprocessing_stage_->Run());
+  return preprocessing_stage_->Run();
+}
 
-  // Inference.
+TfLiteStatus ObjectDetectionStage::RunInference() {
   std::vector<void*> data_ptrs = {};
   data_ptrs.push_back(preprocessing_stage_->GetPreprocessedImageData());
   inference_stage_->SetInputs(data_ptrs);
@@ -129,13 +134,16 @@ TfLiteStatus ObjectDetectionStage::Run() {
     object->set_score(detected_label_probabilities[i]);
   }
 
-  // AP Evaluation.
-  eval_stage_->SetEvalInputs(predicted_objects_, *ground_truth_objects_);
-  TF_LITE_ENSURE_STATUS(eval_stage_->Run());
-
   return kTfLiteOk;
 }
 
+TfLiteStatus ObjectDetectionStage::RunAveragePrecisionEval(
+    const ObjectDetectionResult& predicted_objects,
+    const ObjectDetectionResult& ground_truth_objects) {
+  eval_stage_->SetEvalInputs(predicted_objects, ground_truth_objects);
+  return eval_stage_->Run();
+}
+
 EvaluationStageMetrics ObjectDetectionStage::LatestMetrics() {
   EvaluationStageMetrics metrics;
   auto* detection_metrics =
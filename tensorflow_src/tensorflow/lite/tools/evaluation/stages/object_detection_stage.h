@@ -66,6 +66,20 @@ class ObjectDetectionStage : public EvaluationStage {
     ground_truth_objects_ = &ground_truth_objects;
   }
 
+  // Run() split into its steps, for pipelined evaluations where every worker
+  // preprocesses and runs inference on images with its own stage, and a
+  // single stage accumulates the average precision of all of them. Call after
+  // SetInputs().
+  TfLiteStatus RunPreprocessing();
+  // Also converts the model output into GetLatestPrediction().
+  TfLiteStatus RunInference();
+  // Accumulates the predicted objects of an image. Only uses the
+  // ObjectDetectionAveragePrecisionStage of this stage, so it may run while
+  // other stages, or this one, preprocess or run inference.
+  TfLiteStatus RunAveragePrecisionEval(
+      const ObjectDetectionResult& predicted_objects,
+      const ObjectDetectionResult& ground_truth_objects);
+
   // Provides a pointer to the underlying TfLiteInferenceStage.
   // Returns non-null value only if this stage has been initialized.
   TfliteInferenceStage* const GetInferenceStage() {
@@ -0,0 +1,347 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/evaluation/stages/utils/image_preprocessing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace evaluation {
+namespace image {
+namespace {
+
+// Resampling weights are in Q11, so that resampled 8-bit values fit in 32 bits
+// as in reference_ops::ResizeBilinearInteger.
+constexpr int kWeightBits = 11;
+constexpr int32_t kWeightOne = 1 << kWeightBits;
+constexpr int kResampledBits = 2 * kWeightBits;
+constexpr float kMaxFixedPointMean = 512.0f;
+
+// Pixels an output row or column is resampled from. Every output index has
+// taps [begin[i], begin[i + 1]).
+struct AxisTaps {
+  std::vector<int> begin;
+  // Offsets of the rows or columns in the image.
+  std::vector<int> offsets;
+  std::vector<float> weights;
+  std::vector<int32_t> fixed_weights;
+};
+
+// Always two taps per output index, computed as reference_ops::ResizeBilinear
+// does, so that summing them in order gives the same floats.
+AxisTaps BilinearTaps(int input_size, int output_size, int input_offset,
+                      int stride) {
+  AxisTaps taps;
+  const float scale = static_cast<float>(input_size) / output_size;
+  for (int i = 0; i < output_size; ++i) {
+    const float input = i * scale;
+    const int lower =
+        std::max(static_cast<int>(std::floor(input)), static_cast<int>(0));
+    const int upper =
+        std::min(static_cast<int>(std::ceil(input)), input_size - 1);
+    const float fraction = input - lower;
+    const int32_t fixed_fraction =
+        static_cast<int32_t>(std::round(fraction * kWeightOne));
+    taps.begin.push_back(taps.offsets.size());
+    taps.offsets.push_back((input_offset + lower) * stride);
+    taps.weights.push_back(1 - fraction);
+    taps.fixed_weights.push_back(kWeightOne - fixed_fraction);
+    taps.offsets.push_back((input_offset + upper) * stride);
+    taps.weights.push_back(fraction);
+    taps.fixed_weights.push_back(fixed_fraction);
+  }
+  taps.begin.push_back(taps.offsets.size());
+  return taps;
+}
+
+// Weights every input index by how much of it the output index covers.
+AxisTaps AreaTaps(int input_size, int output_size, int input_offset,
+                  int stride) {
+  AxisTaps taps;
+  const double scale = static_cast<double>(input_size) / output_size;
+  for (int i = 0; i < output_size; ++i) {
+    const double start = i * scale;
+    const double end = std::min((i + 1) * scale, double(input_size));
+    const int first = static_cast<int>(std::floor(start));
+    const int last = std::min(static_cast<int>(std::ceil(end)), input_size);
+    taps.begin.push_back(taps.offsets.size());
+    int32_t fixed_sum = 0;
+    int heaviest = -1;
+    for (int j = first; j < last; ++j) {
+      const double coverage =
+          (std::min(end, j + 1.0) - std::max(start, double(j))) / scale;
+      const int32_t fixed_weight =
+          static_cast<int32_t>(std::round(coverage * kWeightOne));
+      if (heaviest < 0 || fixed_weight > taps.fixed_weights[heaviest]) {
+        heaviest = taps.offsets.size();
+      }
+      taps.offsets.push_back((input_offset + j) * stride);
+      taps.weights.push_back(static_cast<float>(coverage));
+      taps.fixed_weights.push_back(fixed_weight);
+      fixed_sum += fixed_weight;
+    }
+    // The fixed-point weights must add up to one for flat areas to stay flat.
+    taps.fixed_weights[heaviest] += kWeightOne - fixed_sum;
+  }
+  taps.begin.push_back(taps.offsets.size());
+  return taps;
+}
+
+// Region of the image PreprocessImage() crops and the size it outputs.
+struct Geometry {
+  int crop_width;
+  int crop_height;
+  int output_width;
+  int output_height;
+  int output_channels;
+};
+
+Geometry GetGeometry(int width, int height, int channels,
+                     const PreprocessingParams& params) {
+  Geometry geometry;
+  const bool crop = params.crop_width != 0 || params.crop_height != 0;
+  geometry.crop_width = crop ? params.crop_width : width;
+  geometry.crop_height = crop ? params.crop_height : height;
+  geometry.output_width =
+      params.output_width == 0 ? geometry.crop_width : params.output_width;
+  geometry.output_height =
+      params.output_height == 0 ? geometry.crop_height : params.output_height;
+  geometry.output_channels =
+      params.output_channels == 0 ? channels : params.output_channels;
+  return geometry;
+}
+
+struct Resampling {
+  AxisTaps rows;
+  AxisTaps columns;
+  int output_width;
+  int output_height;
+  int output_channels;
+};
+
+// (value - mean) * multiplier + zero_point with value in Q22, computed as
+// (value - offset) * multiplier >> shift.
+struct FixedPointNormalization {
+  std::vector<int64_t> offsets;
+  int64_t multiplier;
+  int shift;
+};
+
+bool GetFixedPointNormalization(const PreprocessingParams& params,
+                                int channels,
+                                FixedPointNormalization* normalization) {
+  normalization->offsets.clear();
+  for (int c = 0; c < channels; ++c) {
+    const float mean = params.mean[params.mean.size() == 1 ? 0 : c];
+    if (!(std::abs(mean) <= kMaxFixedPointMean)) return false;
+    normalization->offsets.push_back(static_cast<int64_t>(
+        std::round(static_cast<double>(mean) * (1 << kResampledBits))));
+  }
+  const double multiplier =
+      static_cast<double>(params.scale) / params.quantization_scale;
+  if (multiplier == 0 || !std::isfinite(multiplier)) return false;
+  int exponent;
+  const double fraction = std::frexp(multiplier, &exponent);
+  // |multiplier| <= 2^30 and |value - offset| < 2^32, so that their product
+  // fits in 63 bits.
+  normalization->multiplier =
+      static_cast<int64_t>(std::round(fraction * (1 << 30)));
+  normalization->shift = kResampledBits + 30 - exponent;
+  return normalization->shift >= 0 && normalization->shift <= 62;
+}
+
+template <typename T>
+T Saturate(float value) {
+  value = std::max(value, static_cast<float>(std::numeric_limits<T>::min()));
+  value = std::min(value, static_cast<float>(std::numeric_limits<T>::max()));
+  return static_cast<T>(value);
+}
+
+template <typename T>
+void StoreFloat(float value, const PreprocessingParams& params, T* output) {
+  *output = Saturate<T>(value / params.quantization_scale + params.zero_point);
+}
+
+template <>
+void StoreFloat(float value, const PreprocessingParams& params,
+                float* output) {
+  *output = value;
+}
+
+template <typename T>
+void ResampleFloat(const uint8_t* image, const Resampling& resampling,
+                   const PreprocessingParams& params, T* output) {
+  const AxisTaps& rows = resampling.rows;
+  const AxisTaps& columns = resampling.columns;
+  for (int y = 0; y < resampling.output_height; ++y) {
+    for (int x = 0; x < resampling.output_width; ++x) {
+      for (int c = 0; c < resampling.output_channels; ++c) {
+        // Sums column by column, then row by row, as ResizeBilinear does.
+        float value = 0;
+        for (int i = columns.begin[x]; i < columns.begin[x + 1]; ++i) {
+          for (int j = rows.begin[y]; j < rows.begin[y + 1]; ++j) {
+            value += static_cast<float>(
+                         image[rows.offsets[j] + columns.offsets[i] + c]) *
+                     rows.weights[j] * columns.weights[i];
+          }
+        }
+        const float mean = params.mean[params.mean.size() == 1 ? 0 : c];
+        StoreFloat((value - mean) * params.scale, params, output++);
+      }
+    }
+  }
+}
+
+template <typename T>
+void ResampleFixedPoint(const uint8_t* image, const Resampling& resampling,
+                        const FixedPointNormalization& normalization,
+                        int32_t zero_point, T* output) {
+  const AxisTaps& rows = resampling.rows;
+  const AxisTaps& columns = resampling.columns;
+  const int64_t fraction_mask = (int64_t{1} << normalization.shift) - 1;
+  for (int y = 0; y < resampling.output_height; ++y) {
+    for (int x = 0; x < resampling.output_width; ++x) {
+      for (int c = 0; c < resampling.output_channels; ++c) {
+        int32_t value = 0;
+        for (int i = columns.begin[x]; i < columns.begin[x + 1]; ++i) {
+          int32_t column = 0;
+          for (int j = rows.begin[y]; j < rows.begin[y + 1]; ++j) {
+            column += rows.fixed_weights[j] *
+                      image[rows.offsets[j] + columns.offsets[i] + c];
+          }
+          value += columns.fixed_weights[i] * column;
+        }
+        const int64_t scaled = (value - normalization.offsets[c]) *
+                               normalization.multiplier;
+        // Truncates scaled / 2^shift + zero_point toward zero as a cast of
+        // the float arithmetic does.
+        int64_t result = (scaled >> normalization.shift) + zero_point;
+        if (result < 0 && (scaled & fraction_mask) != 0) ++result;
+        result = std::max<int64_t>(result, std::numeric_limits<T>::min());
+        result = std::min<int64_t>(result, std::numeric_limits<T>::max());
+        *output++ = static_cast<T>(result);
+      }
+    }
+  }
+}
+
+template <typename T>
+void Resample(const uint8_t* image, const Resampling& resampling,
+              const PreprocessingParams& params, T* output) {
+  FixedPointNormalization normalization;
+  if (params.fixed_point &&
+      GetFixedPointNormalization(params, resampling.output_channels,
+                                 &normalization)) {
+    ResampleFixedPoint(image, resampling, normalization, params.zero_point,
+                       output);
+  } else {
+    ResampleFloat(image, resampling, params, output);
+  }
+}
+
+}  // namespace
+
+TfLiteStatus PreprocessImage(const uint8_t* image, int width, int height,
+                             int channels, const PreprocessingParams& params,
+                             TfLiteType output_type, void* output) {
+  if (image == nullptr || output == nullptr || width <= 0 || height <= 0 ||
+      channels <= 0) {
+    TFLITE_LOG(ERROR) << "Invalid image";
+    return kTfLiteError;
+  }
+  const Geometry geometry = GetGeometry(width, height, channels, params);
+  if (params.crop_x < 0 || params.crop_y < 0 || geometry.crop_width <= 0 ||
+      geometry.crop_height <= 0 ||
+      params.crop_x + geometry.crop_width > width ||
+      params.crop_y + geometry.crop_height > height) {
+    TFLITE_LOG(ERROR) << "Crop region is not inside the " << width << "x"
+                      << height << " image";
+    return kTfLiteError;
+  }
+  if (geometry.output_width <= 0 || geometry.output_height <= 0) {
+    TFLITE_LOG(ERROR) << "Invalid output size";
+    return kTfLiteError;
+  }
+  const int output_channels = geometry.output_channels;
+  if (output_channels <= 0 || output_channels > channels) {
+    TFLITE_LOG(ERROR) << "Can not output " << output_channels
+                      << " channels of an image with " << channels;
+    return kTfLiteError;
+  }
+  if (params.mean.size() != 1 && params.mean.size() != output_channels) {
+    TFLITE_LOG(ERROR) << "Expected 1 or " << output_channels << " means, got "
+                      << params.mean.size();
+    return kTfLiteError;
+  }
+  if (output_type != kTfLiteFloat32 && !(params.quantization_scale > 0)) {
+    TFLITE_LOG(ERROR) << "Quantization scale must be positive";
+    return kTfLiteError;
+  }
+
+  Resampling resampling;
+  resampling.output_width = geometry.output_width;
+  resampling.output_height = geometry.output_height;
+  resampling.output_channels = output_channels;
+  auto taps =
+      params.resize_method == ResizeMethod::kArea ? AreaTaps : BilinearTaps;
+  resampling.rows = taps(geometry.crop_height, geometry.output_height,
+                         params.crop_y, width * channels);
+  resampling.columns = taps(geometry.crop_width, geometry.output_width,
+                            params.crop_x, channels);
+
+  switch (output_type) {
+    case kTfLiteFloat32:
+      ResampleFloat(image, resampling, params, static_cast<float*>(output));
+      return kTfLiteOk;
+    case kTfLiteUInt8:
+      Resample(image, resampling, params, static_cast<uint8_t*>(output));
+      return kTfLiteOk;
+    case kTfLiteInt8:
+      Resample(image, resampling, params, static_cast<int8_t*>(output));
+      return kTfLiteOk;
+    default:
+      TFLITE_LOG(ERROR) << "Output type " << TfLiteTypeGetName(output_type)
+                        << " is not supported";
+      return kTfLiteError;
+  }
+}
+
+TfLiteStatus PreprocessImage(const uint8_t* image, int width, int height,
+                             int channels, const PreprocessingParams& params,
+                             TfLiteTensor* tensor) {
+  const Geometry geometry = GetGeometry(width, height, channels, params);
+  const TfLiteIntArray* dims = tensor->dims;
+  if (dims == nullptr || dims->size != 4 || dims->data[0] != 1 ||
+      dims->data[1] != geometry.output_height ||
+      dims->data[2] != geometry.output_width ||
+      dims->data[3] != geometry.output_channels) {
+    TFLITE_LOG(ERROR) << "Tensor " << (tensor->name ? tensor->name : "")
+                      << " is not of shape [1, " << geometry.output_height
+                      << ", " << geometry.output_width << ", "
+                      << geometry.output_channels << "]";
+    return kTfLiteError;
+  }
+  return PreprocessImage(image, width, height, channels, params, tensor->type,
+                         tensor->data.raw);
+}
+
+}  // namespace image
+}  // namespace evaluation
+}  // namespace tflite
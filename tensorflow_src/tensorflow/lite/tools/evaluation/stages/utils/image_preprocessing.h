@@ -0,0 +1,85 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_EVALUATION_STAGES_UTILS_IMAGE_PREPROCESSING_H_
+#define TENSORFLOW_LITE_TOOLS_EVALUATION_STAGES_UTILS_IMAGE_PREPROCESSING_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace evaluation {
+namespace image {
+
+enum class ResizeMethod {
+  // Same as RESIZE_BILINEAR with align_corners and half_pixel_centers false.
+  kBilinear,
+  // Averages the pixels covered by every output pixel, which keeps the details
+  // bilinear resizing skips when shrinking an image by more than 2x.
+  kArea,
+};
+
+// Crop, resize, normalization and quantization done by PreprocessImage():
+//   output = (resized - mean) * scale / quantization_scale + zero_point
+// where the quantization only applies to uint8 and int8 outputs.
+struct PreprocessingParams {
+  // Region of the image to crop, the whole image if empty.
+  int crop_x = 0;
+  int crop_y = 0;
+  int crop_width = 0;
+  int crop_height = 0;
+  // Size of the output, the size of the crop if 0.
+  int output_width = 0;
+  int output_height = 0;
+  ResizeMethod resize_method = ResizeMethod::kBilinear;
+  // Number of leading channels of the image to output, all if 0.
+  int output_channels = 0;
+  // Either a single mean for all channels or one per output channel.
+  std::vector<float> mean = {0.0f};
+  float scale = 1.0f;
+  float quantization_scale = 1.0f;
+  int32_t zero_point = 0;
+  // Computes uint8 and int8 outputs with integer arithmetic, which may differ
+  // by one from the float arithmetic. Parameters the integer arithmetic can not
+  // represent, e.g. means outside of [-512, 512], use float arithmetic anyway.
+  bool fixed_point = false;
+};
+
+// Preprocesses the interleaved `width` x `height` image with `channels`
+// channels in a single pass, writing the output_height x output_width x
+// output_channels values of type `output_type` (kTfLiteFloat32, kTfLiteUInt8
+// or kTfLiteInt8) to `output`. uint8 and int8 values are truncated toward zero
+// and saturated.
+//
+// With float arithmetic the output is bit-exact with cropping the image into
+// a float image, resizing it with reference_ops::ResizeBilinear, normalizing
+// it and casting it to the output type, but without any intermediate image.
+TfLiteStatus PreprocessImage(const uint8_t* image, int width, int height,
+                             int channels, const PreprocessingParams& params,
+                             TfLiteType output_type, void* output);
+
+// Same as above, writing to `tensor`, whose shape must be [1, output_height,
+// output_width, output_channels].
+TfLiteStatus PreprocessImage(const uint8_t* image, int width, int height,
+                             int channels, const PreprocessingParams& params,
+                             TfLiteTensor* tensor);
+
+}  // namespace image
+}  // namespace evaluation
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_EVALUATION_STAGES_UTILS_IMAGE_PREPROCESSING_H_
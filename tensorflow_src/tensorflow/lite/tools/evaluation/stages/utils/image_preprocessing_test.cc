@@ -0,0 +1,282 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/evaluation/stages/utils/image_preprocessing.h"
+
+#include <stdint.h>
+
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/kernels/internal/reference/reference_ops.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace evaluation {
+namespace image {
+namespace {
+
+constexpr int kWidth = 37;
+constexpr int kHeight = 29;
+constexpr int kChannels = 3;
+
+std::vector<uint8_t> RandomImage(int width, int height, int channels) {
+  std::vector<uint8_t> image(width * height * channels);
+  std::srand(42);
+  for (uint8_t& value : image) value = std::rand() % 256;
+  return image;
+}
+
+// Crops, resizes and normalizes the image in separate float passes, as
+// ImagePreprocessingStage did, then casts the result to T.
+template <typename T>
+std::vector<T> PreprocessInSteps(const std::vector<uint8_t>& image,
+                                 const PreprocessingParams& params) {
+  std::vector<float> cropped;
+  for (int y = params.crop_y; y < params.crop_y + params.crop_height; ++y) {
+    for (int x = params.crop_x; x < params.crop_x + params.crop_width; ++x) {
+      for (int c = 0; c < kChannels; ++c) {
+        cropped.push_back(image[(y * kWidth + x) * kChannels + c]);
+      }
+    }
+  }
+  tflite::ResizeBilinearParams resize_params;
+  resize_params.align_corners = false;
+  resize_params.half_pixel_centers = false;
+  std::vector<int32_t> output_size = {params.output_height,
+                                      params.output_width};
+  std::vector<float> resized(params.output_height * params.output_width *
+                             kChannels);
+  reference_ops::ResizeBilinear(
+      resize_params,
+      RuntimeShape({1, params.crop_height, params.crop_width, kChannels}),
+      cropped.data(), RuntimeShape({1, 1, 1, 2}), output_size.data(),
+      RuntimeShape(
+          {1, params.output_height, params.output_width, kChannels}),
+      resized.data());
+  std::vector<T> output;
+  for (int i = 0; i < resized.size(); ++i) {
+    const float mean = params.mean[params.mean.size() == 1 ? 0 : i % 3];
+    output.push_back(static_cast<T>((resized[i] - mean) * params.scale));
+  }
+  return output;
+}
+
+PreprocessingParams CropAndResize(int output_width, int output_height) {
+  PreprocessingParams params;
+  params.crop_x = 3;
+  params.crop_y = 2;
+  params.crop_width = 30;
+  params.crop_height = 25;
+  params.output_width = output_width;
+  params.output_height = output_height;
+  return params;
+}
+
+template <typename T>
+std::vector<T> Preprocess(const std::vector<uint8_t>& image,
+                          const PreprocessingParams& params, TfLiteType type) {
+  const int output_width =
+      params.output_width ? params.output_width : params.crop_width;
+  const int output_height =
+      params.output_height ? params.output_height : params.crop_height;
+  std::vector<T> output(output_width * output_height * kChannels);
+  EXPECT_EQ(PreprocessImage(image.data(), kWidth, kHeight, kChannels, params,
+                            type, output.data()),
+            kTfLiteOk);
+  return output;
+}
+
+TEST(ImagePreprocessing, FloatBilinearIsBitExactWithSteps) {
+  const std::vector<uint8_t> image = RandomImage(kWidth, kHeight, kChannels);
+  for (const auto& size : {std::make_pair(16, 12), std::make_pair(45, 51),
+                           std::make_pair(30, 25), std::make_pair(7, 31)}) {
+    PreprocessingParams params = CropAndResize(size.first, size.second);
+    params.mean = {127.5f};
+    params.scale = 1.0f / 127.5f;
+    EXPECT_EQ(Preprocess<float>(image, params, kTfLiteFloat32),
+              PreprocessInSteps<float>(image, params));
+    params.mean = {123.68f, 116.78f, 103.94f};
+    params.scale = 0.017f;
+    EXPECT_EQ(Preprocess<float>(image, params, kTfLiteFloat32),
+              PreprocessInSteps<float>(image, params));
+  }
+}
+
+TEST(ImagePreprocessing, QuantizedBilinearIsBitExactWithSteps) {
+  const std::vector<uint8_t> image = RandomImage(kWidth, kHeight, kChannels);
+  PreprocessingParams params = CropAndResize(16, 12);
+  EXPECT_EQ(Preprocess<uint8_t>(image, params, kTfLiteUInt8),
+            PreprocessInSteps<uint8_t>(image, params));
+  params.mean = {128.0f};
+  EXPECT_EQ(Preprocess<int8_t>(image, params, kTfLiteInt8),
+            PreprocessInSteps<int8_t>(image, params));
+}
+
+TEST(ImagePreprocessing, FixedPointIsWithinOneOfFloat) {
+  const std::vector<uint8_t> image = RandomImage(kWidth, kHeight, kChannels);
+  for (const auto& size : {std::make_pair(16, 12), std::make_pair(45, 51)}) {
+    PreprocessingParams params = CropAndResize(size.first, size.second);
+    params.mean = {128.0f};
+    params.scale = 0.75f;
+    params.quantization_scale = 0.5f;
+    params.zero_point = -3;
+    const std::vector<int8_t> expected =
+        Preprocess<int8_t>(image, params, kTfLiteInt8);
+    params.fixed_point = true;
+    const std::vector<int8_t> output =
+        Preprocess<int8_t>(image, params, kTfLiteInt8);
+    for (int i = 0; i < output.size(); ++i) {
+      EXPECT_NEAR(output[i], expected[i], 1) << i;
+    }
+  }
+}
+
+TEST(ImagePreprocessing, FixedPointIsExactWithoutResampling) {
+  const std::vector<uint8_t> image = RandomImage(kWidth, kHeight, kChannels);
+  PreprocessingParams params = CropAndResize(30, 25);
+  params.mean = {128.0f};
+  const std::vector<int8_t> expected =
+      Preprocess<int8_t>(image, params, kTfLiteInt8);
+  params.fixed_point = true;
+  EXPECT_EQ(Preprocess<int8_t>(image, params, kTfLiteInt8), expected);
+  EXPECT_EQ(expected, PreprocessInSteps<int8_t>(image, params));
+}
+
+TEST(ImagePreprocessing, Saturates) {
+  const std::vector<uint8_t> image = {0, 100, 255};
+  PreprocessingParams params;
+  params.mean = {50.0f};
+  params.scale = 2.0f;
+  for (bool fixed_point : {false, true}) {
+    params.fixed_point = fixed_point;
+    uint8_t output[3];
+    ASSERT_EQ(PreprocessImage(image.data(), 1, 1, 3, params, kTfLiteUInt8,
+                              output),
+              kTfLiteOk);
+    EXPECT_EQ(output[0], 0);
+    EXPECT_EQ(output[1], 100);
+    EXPECT_EQ(output[2], 255);
+  }
+}
+
+TEST(ImagePreprocessing, AreaAveragesCoveredPixels) {
+  // 4x2 single channel image, shrunk to 2x1.
+  const std::vector<uint8_t> image = {10, 20, 30, 40, 50, 60, 71, 80};
+  PreprocessingParams params;
+  params.output_width = 2;
+  params.output_height = 1;
+  params.resize_method = ResizeMethod::kArea;
+  float output[6];
+  ASSERT_EQ(PreprocessImage(image.data(), 4, 2, 1, params, kTfLiteFloat32,
+                            output),
+            kTfLiteOk);
+  EXPECT_FLOAT_EQ(output[0], 35.0f);
+  EXPECT_FLOAT_EQ(output[1], 55.25f);
+
+  // Partially covered pixels count in proportion to their coverage.
+  params.output_width = 3;
+  params.output_height = 2;
+  ASSERT_EQ(PreprocessImage(image.data(), 4, 2, 1, params, kTfLiteFloat32,
+                            output),
+            kTfLiteOk);
+  EXPECT_FLOAT_EQ(output[0], 10.0f * 0.75f + 20.0f * 0.25f);
+
+  params.output_width = 2;
+  params.output_height = 1;
+  params.fixed_point = true;
+  uint8_t quantized[2];
+  ASSERT_EQ(PreprocessImage(image.data(), 4, 2, 1, params, kTfLiteUInt8,
+                            quantized),
+            kTfLiteOk);
+  EXPECT_EQ(quantized[0], 35);
+  EXPECT_EQ(quantized[1], 55);
+}
+
+TEST(ImagePreprocessing, AreaKeepsFlatImagesFlat) {
+  const std::vector<uint8_t> image(kWidth * kHeight * kChannels, 77);
+  PreprocessingParams params = CropAndResize(11, 7);
+  params.resize_method = ResizeMethod::kArea;
+  params.fixed_point = true;
+  for (uint8_t value : Preprocess<uint8_t>(image, params, kTfLiteUInt8)) {
+    EXPECT_EQ(value, 77);
+  }
+}
+
+TEST(ImagePreprocessing, OutputsLeadingChannels) {
+  const std::vector<uint8_t> image = {1, 2, 3, 4, 5, 6, 7, 8};
+  PreprocessingParams params;
+  params.output_channels = 3;
+  uint8_t output[6];
+  ASSERT_EQ(PreprocessImage(image.data(), 2, 1, 4, params, kTfLiteUInt8,
+                            output),
+            kTfLiteOk);
+  EXPECT_EQ(std::vector<uint8_t>(output, output + 6),
+            std::vector<uint8_t>({1, 2, 3, 5, 6, 7}));
+}
+
+TEST(ImagePreprocessing, InvalidParams) {
+  const std::vector<uint8_t> image = RandomImage(kWidth, kHeight, kChannels);
+  std::vector<float> output(kWidth * kHeight * kChannels);
+  PreprocessingParams params = CropAndResize(10, 10);
+  params.crop_width = kWidth;
+  EXPECT_EQ(PreprocessImage(image.data(), kWidth, kHeight, kChannels, params,
+                            kTfLiteFloat32, output.data()),
+            kTfLiteError);
+  params = PreprocessingParams();
+  params.output_channels = 4;
+  EXPECT_EQ(PreprocessImage(image.data(), kWidth, kHeight, kChannels, params,
+                            kTfLiteFloat32, output.data()),
+            kTfLiteError);
+  params = PreprocessingParams();
+  params.mean = {1.0f, 2.0f};
+  EXPECT_EQ(PreprocessImage(image.data(), kWidth, kHeight, kChannels, params,
+                            kTfLiteFloat32, output.data()),
+            kTfLiteError);
+  params = PreprocessingParams();
+  EXPECT_EQ(PreprocessImage(image.data(), kWidth, kHeight, kChannels, params,
+                            kTfLiteInt32, output.data()),
+            kTfLiteError);
+}
+
+TEST(ImagePreprocessing, WritesToTensor) {
+  const std::vector<uint8_t> image = RandomImage(kWidth, kHeight, kChannels);
+  PreprocessingParams params = CropAndResize(16, 12);
+  std::vector<uint8_t> data(16 * 12 * kChannels);
+  TfLiteIntArray* dims = TfLiteIntArrayCreate(4);
+  dims->data[0] = 1;
+  dims->data[1] = 12;
+  dims->data[2] = 16;
+  dims->data[3] = kChannels;
+  TfLiteTensor tensor = {};
+  tensor.type = kTfLiteUInt8;
+  tensor.dims = dims;
+  tensor.data.raw = reinterpret_cast<char*>(data.data());
+  ASSERT_EQ(PreprocessImage(image.data(), kWidth, kHeight, kChannels, params,
+                            &tensor),
+            kTfLiteOk);
+  EXPECT_EQ(data, PreprocessInSteps<uint8_t>(image, params));
+
+  dims->data[1] = 13;
+  EXPECT_EQ(PreprocessImage(image.data(), kWidth, kHeight, kChannels, params,
+                            &tensor),
+            kTfLiteError);
+  TfLiteIntArrayFree(dims);
+}
+
+}  // namespace
+}  // namespace image
+}  // namespace evaluation
+}  // namespace tflite
@@ -12,9 +12,12 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <cstdlib>
 #include <fstream>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -24,6 +27,7 @@ limitations under the License.
 #include "tensorflow/lite/tools/evaluation/proto/evaluation_config.pb.h"
 #include "tensorflow/lite/tools/evaluation/proto/evaluation_stages.pb.h"
 #include "tensorflow/lite/tools/evaluation/stages/object_detection_stage.h"
+#include "tensorflow/lite/tools/evaluation/tasks/evaluation_pipeline.h"
 #include "tensorflow/lite/tools/evaluation/tasks/task_executor.h"
 #include "tensorflow/lite/tools/evaluation/utils.h"
 #include "tensorflow/lite/tools/logging.h"
@@ -39,6 +43,7 @@ constexpr char kGroundTruthProtoFileFlag[] = "ground_truth_proto";
 constexpr char kInterpreterThreadsFlag[] = "num_interpreter_threads";
 constexpr char kDebugModeFlag[] = "debug_mode";
 constexpr char kDelegateFlag[] = "delegate";
+constexpr char kEvalThreadsFlag[] = "num_eval_threads";
 
 std::string GetNameFromPath(const std::string& str) {
   int pos = str.find_last_of("/\\");
@@ -48,7 +53,8 @@ std::string GetNameFromPath(const std::string& str) {
 
 class CocoObjectDetection : public TaskExecutor {
  public:
-  CocoObjectDetection() : debug_mode_(false), num_interpreter_threads_(1) {}
+  CocoObjectDetection()
+      : debug_mode_(false), num_interpreter_threads_(1), num_eval_threads_(1) {}
   ~CocoObjectDetection() override {}
 
  protected:
@@ -58,6 +64,10 @@ class CocoObjectDetection : public TaskExecutor {
   absl::optional<EvaluationStageMetrics> RunImpl() final;
 
  private:
+  // Metrics of all images, where `stages` preprocessed them and ran inference
+  // and the first stage accumulated their average precision.
+  EvaluationStageMetrics LatestMetrics(
+      const std::vector<std::unique_ptr<ObjectDetectionStage>>& stages) const;
   void OutputResult(const EvaluationStageMetrics& latest_metrics) const;
   std::string model_file_path_;
   std::string model_output_labels_path_;
@@ -67,6 +77,7 @@ class CocoObjectDetection : public TaskExecutor {
   bool debug_mode_;
   std::string delegate_;
   int num_interpreter_threads_;
+  int num_eval_threads_;
 };
 
 std::vector<Flag> CocoObjectDetection::GetFlags() {
@@ -104,6 +115,11 @@ std::vector<Flag> CocoObjectDetection::GetFlags() {
           kDelegateFlag, &delegate_,
           "Delegate to use for inference, if available. "
           "Must be one of {'nnapi', 'gpu', 'xnnpack', 'hexagon'}"),
+      tflite::Flag::CreateFlag(
+          kEvalThreadsFlag, &num_eval_threads_,
+          "Number of threads preprocessing images and running inference "
+          "concurrently, each with its own interpreter. Metrics are the same "
+          "as with a single thread."),
   };
   return flag_list;
 }
@@ -136,25 +152,46 @@ absl::optional<EvaluationStageMetrics> CocoObjectDetection::RunImpl() {
   if (!ground_truth_proto_file_.empty()) {
     PopulateGroundTruth(ground_truth_proto_file_, &ground_truth_map);
   }
+  // The map is not modified once every image has an entry, so that workers
+  // can read it concurrently.
+  std::vector<std::string> image_names;
+  image_names.reserve(image_paths.size());
+  for (const std::string& image_path : image_paths) {
+    image_names.push_back(GetNameFromPath(image_path));
+    ground_truth_map[image_names.back()];
+  }
 
-  ObjectDetectionStage eval(eval_config);
-
-  eval.SetAllLabels(model_labels);
-  if (eval.Init(&delegate_providers_) != kTfLiteOk) return absl::nullopt;
+  // Every evaluation thread has its own stage, the first one also accumulates
+  // the average precision of all images.
+  std::vector<std::unique_ptr<ObjectDetectionStage>> stages;
+  for (int i = 0; i < std::max(num_eval_threads_, 1); ++i) {
+    stages.emplace_back(new ObjectDetectionStage(eval_config));
+    stages.back()->SetAllLabels(model_labels);
+    if (stages.back()->Init(&delegate_providers_) != kTfLiteOk) {
+      return absl::nullopt;
+    }
+  }
 
   const int step = image_paths.size() / 100;
-  for (int i = 0; i < image_paths.size(); ++i) {
-    if (step > 1 && i % step == 0) {
-      TFLITE_LOG(INFO) << "Finished: " << i / step << "%";
+  auto preprocess = [&](int worker, int index) {
+    stages[worker]->SetInputs(image_paths[index],
+                              ground_truth_map.at(image_names[index]));
+    return stages[worker]->RunPreprocessing();
+  };
+  auto infer = [&](int worker, int index) {
+    return stages[worker]->RunInference();
+  };
+  auto accumulate = [&](int worker, int index) {
+    if (step > 1 && index % step == 0) {
+      TFLITE_LOG(INFO) << "Finished: " << index / step << "%";
     }
-
-    const std::string image_name = GetNameFromPath(image_paths[i]);
-    eval.SetInputs(image_paths[i], ground_truth_map[image_name]);
-    if (eval.Run() != kTfLiteOk) return absl::nullopt;
+    const ObjectDetectionResult& prediction =
+        *stages[worker]->GetLatestPrediction();
+    TF_LITE_ENSURE_STATUS(stages[0]->RunAveragePrecisionEval(
+        prediction, ground_truth_map.at(image_names[index])));
 
     if (debug_mode_) {
-      ObjectDetectionResult prediction = *eval.GetLatestPrediction();
-      TFLITE_LOG(INFO) << "Image: " << image_name << "\n";
+      TFLITE_LOG(INFO) << "Image: " << image_names[index] << "\n";
       for (int i = 0; i < prediction.objects_size(); ++i) {
         const auto& object = prediction.objects(i);
         TFLITE_LOG(INFO) << "Object [" << i << "]";
@@ -174,10 +211,15 @@ absl::optional<EvaluationStageMetrics> CocoObjectDetection::RunImpl() {
       TFLITE_LOG(INFO)
           << "======================================================\n";
     }
+    return kTfLiteOk;
+  };
+  if (RunEvaluationPipeline(image_paths.size(), stages.size(), preprocess,
+                            infer, accumulate) != kTfLiteOk) {
+    return absl::nullopt;
   }
 
   // Write metrics to file.
-  EvaluationStageMetrics latest_metrics = eval.LatestMetrics();
+  EvaluationStageMetrics latest_metrics = LatestMetrics(stages);
   if (ground_truth_proto_file_.empty()) {
     TFLITE_LOG(WARN) << "mAP metrics are meaningless w/o ground truth.";
     latest_metrics.mutable_process_metrics()
@@ -189,6 +231,19 @@ absl::optional<EvaluationStageMetrics> CocoObjectDetection::RunImpl() {
   return absl::make_optional(latest_metrics);
 }
 
+EvaluationStageMetrics CocoObjectDetection::LatestMetrics(
+    const std::vector<std::unique_ptr<ObjectDetectionStage>>& stages) const {
+  std::vector<EvaluationStageMetrics> worker_metrics;
+  for (const auto& stage : stages) {
+    worker_metrics.push_back(stage->LatestMetrics());
+  }
+  return MergeWorkerMetrics<ObjectDetectionMetrics>(
+      std::move(worker_metrics), [](EvaluationStageMetrics* metrics) {
+        return metrics->mutable_process_metrics()
+            ->mutable_object_detection_metrics();
+      });
+}
+
 void CocoObjectDetection::OutputResult(
     const EvaluationStageMetrics& latest_metrics) const {
   if (!output_file_path_.empty()) {
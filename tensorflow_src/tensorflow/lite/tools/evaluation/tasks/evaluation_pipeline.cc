@@ -0,0 +1,119 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/evaluation/tasks/evaluation_pipeline.h"
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <mutex>               // NOLINT(build/c++11)
+#include <thread>              // NOLINT(build/c++11)
+#include <vector>
+
+namespace tflite {
+namespace evaluation {
+
+TfLiteStatus RunEvaluationPipeline(int num_items, int num_workers,
+                                   const EvaluationStepFn& preprocess,
+                                   const EvaluationStepFn& infer,
+                                   const EvaluationStepFn& accumulate) {
+  if (num_workers <= 1 || num_items <= 1) {
+    for (int i = 0; i < num_items; ++i) {
+      TF_LITE_ENSURE_STATUS(preprocess(0, i));
+      TF_LITE_ENSURE_STATUS(infer(0, i));
+      TF_LITE_ENSURE_STATUS(accumulate(0, i));
+    }
+    return kTfLiteOk;
+  }
+
+  std::mutex mutex;
+  std::condition_variable items_changed;
+  // All guarded by `mutex`.
+  int next_item = 0;
+  int num_accumulated = 0;
+  // The worker whose result of each item is ready to be accumulated, or -1.
+  std::vector<int> inferred_by(num_items, -1);
+  TfLiteStatus status = kTfLiteOk;
+
+  auto fail = [&](TfLiteStatus step_status) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      status = step_status;
+    }
+    items_changed.notify_all();
+  };
+  auto run_worker = [&](int worker) {
+    int previous_item = -1;
+    while (true) {
+      int item;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (status != kTfLiteOk || next_item >= num_items) return;
+        item = next_item++;
+      }
+      TfLiteStatus step_status = preprocess(worker, item);
+      if (step_status != kTfLiteOk) {
+        fail(step_status);
+        return;
+      }
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        items_changed.wait(lock, [&] {
+          return status != kTfLiteOk || num_accumulated > previous_item;
+        });
+        if (status != kTfLiteOk) return;
+      }
+      step_status = infer(worker, item);
+      if (step_status != kTfLiteOk) {
+        fail(step_status);
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        inferred_by[item] = worker;
+      }
+      items_changed.notify_all();
+      previous_item = item;
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(num_workers);
+  for (int worker = 0; worker < num_workers; ++worker) {
+    workers.emplace_back(run_worker, worker);
+  }
+  for (int i = 0; i < num_items; ++i) {
+    int worker;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      items_changed.wait(
+          lock, [&] { return status != kTfLiteOk || inferred_by[i] >= 0; });
+      if (status != kTfLiteOk) break;
+      worker = inferred_by[i];
+    }
+    const TfLiteStatus step_status = accumulate(worker, i);
+    if (step_status != kTfLiteOk) {
+      fail(step_status);
+      break;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      num_accumulated = i + 1;
+    }
+    items_changed.notify_all();
+  }
+  for (std::thread& worker : workers) worker.join();
+  return status;
+}
+
+}  // namespace evaluation
+}  // namespace tflite
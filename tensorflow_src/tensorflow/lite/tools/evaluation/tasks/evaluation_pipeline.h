@@ -0,0 +1,51 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_EVALUATION_TASKS_EVALUATION_PIPELINE_H_
+#define TENSORFLOW_LITE_TOOLS_EVALUATION_TASKS_EVALUATION_PIPELINE_H_
+
+#include <functional>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace evaluation {
+
+// A step of the evaluation of the item at `index` by `worker`, in
+// [0, num_workers).
+using EvaluationStepFn = std::function<TfLiteStatus(int worker, int index)>;
+
+// Evaluates the items [0, num_items) as a pipeline of three steps, so that
+// the workers preprocess and run inference on different items concurrently
+// while their results are accumulated:
+// * `preprocess` and `infer` run on the thread of `worker`, which should own
+//   the stages (and so the interpreter) they use. A worker only runs
+//   `infer` once the result of its previous item has been accumulated, so
+//   that result stays valid until then, but may preprocess the next item
+//   meanwhile.
+// * `accumulate` runs on the calling thread, in increasing order of `index`,
+//   so metrics that depend on the order of the items, e.g. average precision,
+//   are identical to the ones of a sequential evaluation.
+// A worker holds at most two items, one preprocessed and one waiting to be
+// accumulated. With a single worker, the steps run sequentially on the
+// calling thread. Stops at the first step that fails, and returns its status.
+TfLiteStatus RunEvaluationPipeline(int num_items, int num_workers,
+                                   const EvaluationStepFn& preprocess,
+                                   const EvaluationStepFn& infer,
+                                   const EvaluationStepFn& accumulate);
+
+}  // namespace evaluation
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_EVALUATION_TASKS_EVALUATION_PIPELINE_H_
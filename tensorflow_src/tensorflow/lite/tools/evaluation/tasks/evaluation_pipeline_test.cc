@@ -0,0 +1,151 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/evaluation/tasks/evaluation_pipeline.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace evaluation {
+namespace {
+
+constexpr int kNumItems = 50;
+
+// Squares the items as a worker with a single output buffer would.
+class FakeWorkers {
+ public:
+  explicit FakeWorkers(int num_workers)
+      : preprocessed_(num_workers, -1), outputs_(num_workers, -1) {}
+
+  TfLiteStatus Preprocess(int worker, int index) {
+    preprocessed_[worker] = index;
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus Infer(int worker, int index) {
+    EXPECT_EQ(index, preprocessed_[worker]);
+    // Makes items finish out of order.
+    std::this_thread::sleep_for(std::chrono::microseconds((index % 3) * 200));
+    outputs_[worker] = index * index;
+    return kTfLiteOk;
+  }
+
+  int output(int worker) const { return outputs_[worker]; }
+
+ private:
+  std::vector<int> preprocessed_;
+  std::vector<int> outputs_;
+};
+
+std::vector<int> RunSquares(int num_workers) {
+  FakeWorkers workers(num_workers);
+  std::vector<int> accumulated;
+  EXPECT_EQ(
+      kTfLiteOk,
+      RunEvaluationPipeline(
+          kNumItems, num_workers,
+          [&](int worker, int index) {
+            return workers.Preprocess(worker, index);
+          },
+          [&](int worker, int index) { return workers.Infer(worker, index); },
+          [&](int worker, int index) {
+            accumulated.push_back(workers.output(worker));
+            return kTfLiteOk;
+          }));
+  return accumulated;
+}
+
+TEST(EvaluationPipelineTest, SequentialWithOneWorker) {
+  std::vector<int> expected;
+  for (int i = 0; i < kNumItems; ++i) expected.push_back(i * i);
+  EXPECT_EQ(expected, RunSquares(1));
+}
+
+TEST(EvaluationPipelineTest, AccumulatesInOrderWithManyWorkers) {
+  EXPECT_EQ(RunSquares(1), RunSquares(4));
+}
+
+TEST(EvaluationPipelineTest, WorkersRunConcurrently) {
+  std::atomic<int> running(0);
+  std::atomic<int> max_running(0);
+  std::mutex mutex;
+  std::vector<int> worker_of_item(kNumItems, -1);
+  ASSERT_EQ(kTfLiteOk,
+            RunEvaluationPipeline(
+                kNumItems, 4,
+                [](int worker, int index) { return kTfLiteOk; },
+                [&](int worker, int index) {
+                  const int now_running = ++running;
+                  int previous = max_running;
+                  while (previous < now_running &&
+                         !max_running.compare_exchange_weak(previous,
+                                                            now_running)) {
+                  }
+                  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                  --running;
+                  std::lock_guard<std::mutex> lock(mutex);
+                  worker_of_item[index] = worker;
+                  return kTfLiteOk;
+                },
+                [&](int worker, int index) {
+                  std::lock_guard<std::mutex> lock(mutex);
+                  EXPECT_EQ(worker_of_item[index], worker);
+                  return kTfLiteOk;
+                }));
+  EXPECT_GT(max_running, 1);
+}
+
+TEST(EvaluationPipelineTest, StopsAtFirstError) {
+  for (int num_workers : {1, 3}) {
+    std::atomic<int> num_accumulated(0);
+    EXPECT_EQ(kTfLiteError,
+              RunEvaluationPipeline(
+                  kNumItems, num_workers,
+                  [](int worker, int index) { return kTfLiteOk; },
+                  [](int worker, int index) {
+                    return index == 10 ? kTfLiteError : kTfLiteOk;
+                  },
+                  [&](int worker, int index) {
+                    ++num_accumulated;
+                    return kTfLiteOk;
+                  }));
+    EXPECT_LE(num_accumulated, 10);
+  }
+}
+
+TEST(EvaluationPipelineTest, AccumulationErrorStopsWorkers) {
+  std::atomic<int> num_inferred(0);
+  EXPECT_EQ(kTfLiteError,
+            RunEvaluationPipeline(
+                kNumItems, 2, [](int worker, int index) { return kTfLiteOk; },
+                [&](int worker, int index) {
+                  ++num_inferred;
+                  return kTfLiteOk;
+                },
+                [](int worker, int index) {
+                  return index == 0 ? kTfLiteError : kTfLiteOk;
+                }));
+  // Each worker infers at most one item past the failing one.
+  EXPECT_LE(num_inferred, 3);
+}
+
+}  // namespace
+}  // namespace evaluation
+}  // namespace tflite
@@ -12,9 +12,12 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <cstdlib>
 #include <fstream>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/types/optional.h"
@@ -23,6 +26,7 @@ limitations under the License.
 #include "tensorflow/lite/tools/evaluation/proto/evaluation_config.pb.h"
 #include "tensorflow/lite/tools/evaluation/proto/evaluation_stages.pb.h"
 #include "tensorflow/lite/tools/evaluation/stages/image_classification_stage.h"
+#include "tensorflow/lite/tools/evaluation/tasks/evaluation_pipeline.h"
 #include "tensorflow/lite/tools/evaluation/tasks/task_executor.h"
 #include "tensorflow/lite/tools/evaluation/utils.h"
 #include "tensorflow/lite/tools/logging.h"
@@ -39,6 +43,7 @@ constexpr char kDenylistFilePathFlag[] = "denylist_file_path";
 constexpr char kNumImagesFlag[] = "num_images";
 constexpr char kInterpreterThreadsFlag[] = "num_interpreter_threads";
 constexpr char kDelegateFlag[] = "delegate";
+constexpr char kEvalThreadsFlag[] = "num_eval_threads";
 
 template <typename T>
 std::vector<T> GetFirstN(const std::vector<T>& v, int n) {
@@ -49,7 +54,8 @@ std::vector<T> GetFirstN(const std::vector<T>& v, int n) {
 
 class ImagenetClassification : public TaskExecutor {
  public:
-  ImagenetClassification() : num_images_(0), num_interpreter_threads_(1) {}
+  ImagenetClassification()
+      : num_images_(0), num_interpreter_threads_(1), num_eval_threads_(1) {}
   ~ImagenetClassification() override {}
 
  protected:
@@ -59,6 +65,11 @@ class ImagenetClassification : public TaskExecutor {
   absl::optional<EvaluationStageMetrics> RunImpl() final;
 
  private:
+  // Metrics of all images, where `stages` preprocessed them and ran inference
+  // and the first stage accumulated their accuracy.
+  EvaluationStageMetrics LatestMetrics(
+      const std::vector<std::unique_ptr<ImageClassificationStage>>& stages)
+      const;
   void OutputResult(const EvaluationStageMetrics& latest_metrics) const;
   std::string model_file_path_;
   std::string ground_truth_images_path_;
@@ -69,6 +80,7 @@ class ImagenetClassification : public TaskExecutor {
   std::string delegate_;
   int num_images_;
   int num_interpreter_threads_;
+  int num_eval_threads_;
 };
 
 std::vector<Flag> ImagenetClassification::GetFlags() {
@@ -106,6 +118,11 @@ std::vector<Flag> ImagenetClassification::GetFlags() {
           kDelegateFlag, &delegate_,
           "Delegate to use for inference, if available. "
           "Must be one of {'nnapi', 'gpu', 'hexagon', 'xnnpack'}"),
+      tflite::Flag::CreateFlag(
+          kEvalThreadsFlag, &num_eval_threads_,
+          "Number of threads preprocessing images and running inference "
+          "concurrently, each with its own interpreter. Metrics are the same "
+          "as with a single thread."),
   };
   return flag_list;
 }
@@ -155,25 +172,57 @@ absl::optional<EvaluationStageMetrics> ImagenetClassification::RunImpl() {
   inference_params->set_delegate(ParseStringToDelegateType(delegate_));
   classification_params->mutable_topk_accuracy_eval_params()->set_k(10);
 
-  ImageClassificationStage eval(eval_config);
-
-  eval.SetAllLabels(model_labels);
-  if (eval.Init(&delegate_providers_) != kTfLiteOk) return absl::nullopt;
+  // Every evaluation thread has its own stage, the first one also accumulates
+  // the accuracy of all images.
+  std::vector<std::unique_ptr<ImageClassificationStage>> stages;
+  for (int i = 0; i < std::max(num_eval_threads_, 1); ++i) {
+    stages.emplace_back(new ImageClassificationStage(eval_config));
+    stages.back()->SetAllLabels(model_labels);
+    if (stages.back()->Init(&delegate_providers_) != kTfLiteOk) {
+      return absl::nullopt;
+    }
+  }
 
   const int step = image_labels.size() / 100;
-  for (int i = 0; i < image_labels.size(); ++i) {
-    if (step > 1 && i % step == 0) {
-      TFLITE_LOG(INFO) << "Evaluated: " << i / step << "%";
+  auto preprocess = [&](int worker, int index) {
+    stages[worker]->SetInputs(image_labels[index].image,
+                              image_labels[index].label);
+    return stages[worker]->RunPreprocessing();
+  };
+  auto infer = [&](int worker, int index) {
+    return stages[worker]->RunInference();
+  };
+  auto accumulate = [&](int worker, int index) {
+    if (step > 1 && index % step == 0) {
+      TFLITE_LOG(INFO) << "Evaluated: " << index / step << "%";
     }
-    eval.SetInputs(image_labels[i].image, image_labels[i].label);
-    if (eval.Run() != kTfLiteOk) return absl::nullopt;
+    return stages[0]->RunAccuracyEval(stages[worker].get(),
+                                      &image_labels[index].label);
+  };
+  if (RunEvaluationPipeline(image_labels.size(), stages.size(), preprocess,
+                            infer, accumulate) != kTfLiteOk) {
+    return absl::nullopt;
   }
 
-  const auto latest_metrics = eval.LatestMetrics();
+  const auto latest_metrics = LatestMetrics(stages);
   OutputResult(latest_metrics);
   return absl::make_optional(latest_metrics);
 }
 
+EvaluationStageMetrics ImagenetClassification::LatestMetrics(
+    const std::vector<std::unique_ptr<ImageClassificationStage>>& stages)
+    const {
+  std::vector<EvaluationStageMetrics> worker_metrics;
+  for (const auto& stage : stages) {
+    worker_metrics.push_back(stage->LatestMetrics());
+  }
+  return MergeWorkerMetrics<ImageClassificationMetrics>(
+      std::move(worker_metrics), [](EvaluationStageMetrics* metrics) {
+        return metrics->mutable_process_metrics()
+            ->mutable_image_classification_metrics();
+      });
+}
+
 void ImagenetClassification::OutputResult(
     const EvaluationStageMetrics& latest_metrics) const {
   if (!output_file_path_.empty()) {
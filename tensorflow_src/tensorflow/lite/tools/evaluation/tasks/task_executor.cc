@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/tools/evaluation/tasks/task_executor.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "absl/types/optional.h"
 #include "tensorflow/lite/tools/logging.h"
 
@@ -42,5 +45,37 @@ absl::optional<EvaluationStageMetrics> TaskExecutor::Run(int* argc,
 
   return RunImpl();
 }
+
+LatencyMetrics MergeLatencyMetrics(const std::vector<LatencyMetrics>& latencies,
+                                   const std::vector<int64_t>& num_runs) {
+  LatencyMetrics merged;
+  int64_t total_runs = 0;
+  // Sum of the squares of all latencies, recovered from the standard
+  // deviation and average of each stage.
+  double sum_squares_us = 0;
+  for (int i = 0; i < latencies.size() && i < num_runs.size(); ++i) {
+    if (num_runs[i] <= 0) continue;
+    const LatencyMetrics& latency = latencies[i];
+    merged.set_max_us(total_runs == 0
+                          ? latency.max_us()
+                          : std::max(merged.max_us(), latency.max_us()));
+    merged.set_min_us(total_runs == 0
+                          ? latency.min_us()
+                          : std::min(merged.min_us(), latency.min_us()));
+    merged.set_sum_us(merged.sum_us() + latency.sum_us());
+    merged.set_last_us(latency.last_us());
+    const double std_deviation_us = latency.std_deviation_us();
+    sum_squares_us += num_runs[i] * (std_deviation_us * std_deviation_us +
+                                     latency.avg_us() * latency.avg_us());
+    total_runs += num_runs[i];
+  }
+  if (total_runs == 0) return merged;
+  const double avg_us = static_cast<double>(merged.sum_us()) / total_runs;
+  merged.set_avg_us(avg_us);
+  merged.set_std_deviation_us(static_cast<int64_t>(
+      std::sqrt(std::max(0.0, sum_squares_us / total_runs - avg_us * avg_us))));
+  return merged;
+}
+
 }  // namespace evaluation
 }  // namespace tflite
@@ -15,6 +15,9 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_TOOLS_EVALUATION_TASKS_TASK_EXECUTOR_H_
 #define TENSORFLOW_LITE_TOOLS_EVALUATION_TASKS_TASK_EXECUTOR_H_
 
+#include <cstdint>
+#include <vector>
+
 #include "absl/types/optional.h"
 #include "tensorflow/lite/tools/command_line_flags.h"
 #include "tensorflow/lite/tools/evaluation/evaluation_delegate_provider.h"
@@ -40,6 +43,49 @@ class TaskExecutor {
   DelegateProviders delegate_providers_;
 };
 
+// Combines the latencies of stages that ran disjoint sets of runs, e.g. the
+// workers of RunEvaluationPipeline(), into the ones of a single stage that ran
+// them all. `num_runs[i]` is the number of runs `latencies[i]` covers. The
+// latency of the last run is the one of the last stage with runs.
+LatencyMetrics MergeLatencyMetrics(const std::vector<LatencyMetrics>& latencies,
+                                   const std::vector<int64_t>& num_runs);
+
+// Combines the metrics of the workers of RunEvaluationPipeline(), where the
+// first worker also accumulated the accuracy of every run. The result is the
+// metrics of the first worker, with the run count, latencies and inference
+// count of all of them. `task_metrics` returns the task-specific metrics, e.g.
+// ImageClassificationMetrics, of an EvaluationStageMetrics.
+template <typename TaskMetrics>
+EvaluationStageMetrics MergeWorkerMetrics(
+    std::vector<EvaluationStageMetrics> worker_metrics,
+    TaskMetrics* (*task_metrics)(EvaluationStageMetrics*)) {
+  if (worker_metrics.size() == 1) return worker_metrics[0];
+  std::vector<LatencyMetrics> pre_processing_latencies;
+  std::vector<LatencyMetrics> inference_latencies;
+  std::vector<int64_t> num_runs;
+  int64_t total_runs = 0;
+  int num_inferences = 0;
+  for (EvaluationStageMetrics& metrics : worker_metrics) {
+    const TaskMetrics& worker_task_metrics = *task_metrics(&metrics);
+    pre_processing_latencies.push_back(
+        worker_task_metrics.pre_processing_latency());
+    inference_latencies.push_back(worker_task_metrics.inference_latency());
+    num_runs.push_back(metrics.num_runs());
+    total_runs += metrics.num_runs();
+    num_inferences += worker_task_metrics.inference_metrics().num_inferences();
+  }
+  EvaluationStageMetrics merged = worker_metrics[0];
+  TaskMetrics* merged_task_metrics = task_metrics(&merged);
+  *merged_task_metrics->mutable_pre_processing_latency() =
+      MergeLatencyMetrics(pre_processing_latencies, num_runs);
+  *merged_task_metrics->mutable_inference_latency() =
+      MergeLatencyMetrics(inference_latencies, num_runs);
+  merged_task_metrics->mutable_inference_metrics()->set_num_inferences(
+      num_inferences);
+  merged.set_num_runs(total_runs);
+  return merged;
+}
+
 // Just a declaration. In order to avoid the boilerpolate main-function code,
 // every evaluation task should define this function.
 std::unique_ptr<TaskExecutor> CreateTaskExecutor();
@@ -0,0 +1,111 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/evaluation/tasks/task_executor.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/tools/evaluation/proto/evaluation_stages.pb.h"
+
+namespace tflite {
+namespace evaluation {
+namespace {
+
+LatencyMetrics Latency(int64_t min_us, int64_t max_us, int64_t sum_us,
+                       int64_t last_us, double avg_us,
+                       int64_t std_deviation_us) {
+  LatencyMetrics latency;
+  latency.set_min_us(min_us);
+  latency.set_max_us(max_us);
+  latency.set_sum_us(sum_us);
+  latency.set_last_us(last_us);
+  latency.set_avg_us(avg_us);
+  latency.set_std_deviation_us(std_deviation_us);
+  return latency;
+}
+
+TEST(MergeLatencyMetricsTest, MatchesSingleStage) {
+  // Runs of 1us and 3us, then of 5us and 9us.
+  const LatencyMetrics merged = MergeLatencyMetrics(
+      {Latency(1, 3, 4, 3, 2.0, 1), Latency(5, 9, 14, 9, 7.0, 2)}, {2, 2});
+  EXPECT_EQ(merged.min_us(), 1);
+  EXPECT_EQ(merged.max_us(), 9);
+  EXPECT_EQ(merged.sum_us(), 18);
+  EXPECT_EQ(merged.last_us(), 9);
+  EXPECT_DOUBLE_EQ(merged.avg_us(), 4.5);
+  // The standard deviation of {1, 3, 5, 9} is sqrt(8.75).
+  EXPECT_EQ(merged.std_deviation_us(), 2);
+}
+
+TEST(MergeLatencyMetricsTest, SkipsStagesWithoutRuns) {
+  const LatencyMetrics merged =
+      MergeLatencyMetrics({Latency(0, 0, 0, 0, 0.0, 0),
+                           Latency(4, 4, 8, 4, 4.0, 0),
+                           Latency(0, 0, 0, 0, 0.0, 0)},
+                          {0, 2, 0});
+  EXPECT_EQ(merged.min_us(), 4);
+  EXPECT_EQ(merged.max_us(), 4);
+  EXPECT_EQ(merged.sum_us(), 8);
+  EXPECT_EQ(merged.last_us(), 4);
+  EXPECT_DOUBLE_EQ(merged.avg_us(), 4.0);
+  EXPECT_EQ(merged.std_deviation_us(), 0);
+
+  const LatencyMetrics empty = MergeLatencyMetrics({}, {});
+  EXPECT_EQ(empty.sum_us(), 0);
+  EXPECT_DOUBLE_EQ(empty.avg_us(), 0.0);
+}
+
+ImageClassificationMetrics* GetClassificationMetrics(
+    EvaluationStageMetrics* metrics) {
+  return metrics->mutable_process_metrics()
+      ->mutable_image_classification_metrics();
+}
+
+TEST(MergeWorkerMetricsTest, KeepsAccuracyOfFirstWorker) {
+  std::vector<EvaluationStageMetrics> worker_metrics(2);
+  for (int i = 0; i < 2; ++i) {
+    worker_metrics[i].set_num_runs(i + 1);
+    auto* metrics = GetClassificationMetrics(&worker_metrics[i]);
+    *metrics->mutable_inference_latency() =
+        Latency(10, 10, 10 * (i + 1), 10, 10.0, 0);
+    *metrics->mutable_pre_processing_latency() =
+        Latency(i, i, i * (i + 1), i, i, 0);
+    metrics->mutable_inference_metrics()->set_num_inferences(i + 1);
+  }
+  GetClassificationMetrics(&worker_metrics[0])
+      ->mutable_topk_accuracy_metrics()
+      ->add_topk_accuracies(0.5f);
+
+  EvaluationStageMetrics merged =
+      MergeWorkerMetrics(worker_metrics, &GetClassificationMetrics);
+  EXPECT_EQ(merged.num_runs(), 3);
+  const ImageClassificationMetrics& metrics =
+      merged.process_metrics().image_classification_metrics();
+  EXPECT_EQ(metrics.inference_metrics().num_inferences(), 3);
+  EXPECT_EQ(metrics.inference_latency().sum_us(), 30);
+  EXPECT_EQ(metrics.pre_processing_latency().min_us(), 0);
+  EXPECT_EQ(metrics.pre_processing_latency().max_us(), 1);
+  ASSERT_EQ(metrics.topk_accuracy_metrics().topk_accuracies_size(), 1);
+  EXPECT_FLOAT_EQ(metrics.topk_accuracy_metrics().topk_accuracies(0), 0.5f);
+
+  EvaluationStageMetrics single =
+      MergeWorkerMetrics({worker_metrics[1]}, &GetClassificationMetrics);
+  EXPECT_EQ(single.num_runs(), 2);
+}
+
+}  // namespace
+}  // namespace evaluation
+}  // namespace tflite
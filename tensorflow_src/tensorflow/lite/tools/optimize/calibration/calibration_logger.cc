@@ -47,6 +47,108 @@ TfLiteStatus MinMax::Update(const float* values, size_t tensor_size,
   return kTfLiteOk;
 }
 
+void MinMax::Merge(const MinMax& other) {
+  if (!other.has_values_) return;
+  min_ = std::min<float>(min_, other.min_);
+  max_ = std::max<float>(max_, other.max_);
+  has_values_ = true;
+}
+
+Histogram::Histogram(int num_bins)
+    : counts_(std::max(4, (num_bins + 3) / 4 * 4), 0) {}
+
+void Histogram::GrowRange(float range) {
+  if (range_ == 0.0f) {
+    range_ = range;
+    return;
+  }
+  // Doubling the range maps old bin i onto new bin num_bins / 4 + i / 2.
+  const int num_bins = counts_.size();
+  while (range_ < range) {
+    std::vector<int64_t> counts(num_bins, 0);
+    for (int i = 0; i < num_bins; ++i) {
+      counts[num_bins / 4 + i / 2] += counts_[i];
+    }
+    counts_.swap(counts);
+    range_ *= 2.0f;
+  }
+}
+
+void Histogram::Update(const float* values, size_t tensor_size) {
+  float max_abs = std::numeric_limits<float>::min();
+  for (size_t i = 0; i < tensor_size; ++i) {
+    if (std::isfinite(values[i])) {
+      max_abs = std::max(max_abs, std::abs(values[i]));
+    }
+  }
+  if (max_abs > range_) {
+    // The smallest power of two not below |max_abs|.
+    int exponent;
+    const float mantissa = std::frexp(max_abs, &exponent);
+    GrowRange(std::ldexp(1.0f, mantissa == 0.5f ? exponent - 1 : exponent));
+  }
+
+  const int num_bins = counts_.size();
+  const float bins_per_unit = num_bins / (2.0f * range_);
+  for (size_t i = 0; i < tensor_size; ++i) {
+    const float value = values[i];
+    // NaN and infinities have no bin; MinMax reports NaN values.
+    if (!std::isfinite(value)) continue;
+    int bin = 0;
+    if (value >= range_) {
+      bin = num_bins - 1;
+    } else if (value > -range_) {
+      bin = std::min(num_bins - 1,
+                     static_cast<int>((value + range_) * bins_per_unit));
+    }
+    ++counts_[bin];
+    ++total_count_;
+  }
+}
+
+TfLiteStatus Histogram::Merge(const Histogram& other) {
+  if (other.counts_.size() != counts_.size()) return kTfLiteError;
+  if (!other.HasValues()) return kTfLiteOk;
+  Histogram aligned = other;
+  aligned.GrowRange(range_);
+  GrowRange(aligned.range_);
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    counts_[i] += aligned.counts_[i];
+  }
+  total_count_ += aligned.total_count_;
+  return kTfLiteOk;
+}
+
+float Histogram::Quantile(double fraction) const {
+  const double target =
+      std::min(1.0, std::max(0.0, fraction)) * total_count_;
+  const float bin_width = 2.0f * range_ / counts_.size();
+  int64_t count_below = 0;
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    if (counts_[i] > 0 && count_below + counts_[i] >= target) {
+      const double within = (target - count_below) / counts_[i];
+      return -range_ + bin_width * (i + within);
+    }
+    count_below += counts_[i];
+  }
+  return range_;
+}
+
+TfLiteStatus Logger::Merge(const Logger& other) {
+  for (const auto& tensorid_stat : other.tensor_id_to_stats_map_) {
+    tensor_id_to_stats_map_[tensorid_stat.first].Merge(tensorid_stat.second);
+  }
+  for (const auto& tensorid_histogram : other.tensor_id_to_histogram_map_) {
+    auto histogram = tensor_id_to_histogram_map_.find(tensorid_histogram.first);
+    if (histogram == tensor_id_to_histogram_map_.end()) {
+      tensor_id_to_histogram_map_.insert(tensorid_histogram);
+    } else {
+      TF_LITE_ENSURE_STATUS(histogram->second.Merge(tensorid_histogram.second));
+    }
+  }
+  return kTfLiteOk;
+}
+
 }  // namespace calibration
 }  // namespace optimize
 }  // namespace tflite
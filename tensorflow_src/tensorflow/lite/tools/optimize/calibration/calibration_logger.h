@@ -15,8 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_TOOLS_OPTIMIZE_CALIBRATION_CALIBRATION_LOGGER_H_
 #define TENSORFLOW_LITE_TOOLS_OPTIMIZE_CALIBRATION_CALIBRATION_LOGGER_H_
 
+#include <cstdint>
 #include <limits>
 #include <unordered_map>
+#include <vector>
 
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
@@ -39,21 +41,68 @@ class MinMax {
     return kTfLiteOk;
   }
 
+  // Widens the range to include the values seen by |other|.
+  void Merge(const MinMax& other);
+
  private:
   bool has_values_ = false;
   float min_ = std::numeric_limits<float>::max();
   float max_ = std::numeric_limits<float>::min();
 };
 
-// Captures min max values for tensors.
+// Counts values in equal bins over [-range, range]. The range is a power of
+// two that doubles, pairing up adjacent bins, whenever a value falls outside
+// of it, so histograms with the same number of bins can be merged exactly no
+// matter which values each of them saw first.
+class Histogram {
+ public:
+  // |num_bins| is rounded up to a multiple of four.
+  explicit Histogram(int num_bins);
+
+  void Update(const float* values, size_t tensor_size);
+
+  // Adds the counts of |other|, which must have the same number of bins.
+  TfLiteStatus Merge(const Histogram& other);
+
+  bool HasValues() const { return total_count_ > 0; }
+
+  // Returns the value below which |fraction| of the counted values lie,
+  // interpolating linearly within a bin.
+  float Quantile(double fraction) const;
+
+ private:
+  void GrowRange(float range);
+
+  std::vector<int64_t> counts_;
+  float range_ = 0.0f;
+  int64_t total_count_ = 0;
+};
+
+// Captures min max values, and optionally histograms, for tensors.
 class Logger {
  public:
+  Logger() = default;
+
+  // If |histogram_bins| is positive, the values of every tensor are also
+  // counted in a |Histogram| with that many bins.
+  explicit Logger(int histogram_bins) : histogram_bins_(histogram_bins) {}
+
   // Log the value for tensor at |tensor_index| which has |tensor_values|
   TfLiteStatus LogTensorValue(int tensor_index, const float* tensor_values,
                               size_t tensor_size,
                               ErrorReporter* error_reporter) {
-    return tensor_id_to_stats_map_[tensor_index].Update(
-        tensor_values, tensor_size, error_reporter);
+    TF_LITE_ENSURE_STATUS(tensor_id_to_stats_map_[tensor_index].Update(
+        tensor_values, tensor_size, error_reporter));
+    if (histogram_bins_ > 0) {
+      auto histogram = tensor_id_to_histogram_map_.find(tensor_index);
+      if (histogram == tensor_id_to_histogram_map_.end()) {
+        histogram = tensor_id_to_histogram_map_
+                        .emplace(tensor_index, Histogram(histogram_bins_))
+                        .first;
+      }
+      histogram->second.Update(tensor_values, tensor_size);
+    }
+    return kTfLiteOk;
   }
 
   // Returns a map from tensor_index -> observed min max values.
@@ -61,8 +110,20 @@ class Logger {
     return tensor_id_to_stats_map_;
   }
 
+  // Returns a map from tensor_index -> histogram of the observed values,
+  // empty unless the logger was created with histogram bins.
+  const std::unordered_map<int, Histogram>& GetHistograms() const {
+    return tensor_id_to_histogram_map_;
+  }
+
+  // Adds the values logged by |other|, e.g. by another interpreter running on
+  // a different part of the calibration set.
+  TfLiteStatus Merge(const Logger& other);
+
  private:
+  int histogram_bins_ = 0;
   std::unordered_map<int, MinMax> tensor_id_to_stats_map_;
+  std::unordered_map<int, Histogram> tensor_id_to_histogram_map_;
 };
 
 }  // namespace calibration
@@ -0,0 +1,123 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/optimize/calibration/calibration_logger.h"
+
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace optimize {
+namespace calibration {
+namespace {
+
+std::vector<float> Ramp(float start, float step, int size) {
+  std::vector<float> values(size);
+  for (int i = 0; i < size; ++i) {
+    values[i] = start + step * i;
+  }
+  return values;
+}
+
+TEST(HistogramTest, QuantilesOfUniformValues) {
+  Histogram histogram(1024);
+  EXPECT_FALSE(histogram.HasValues());
+  const std::vector<float> values = Ramp(-3.0f, 0.001f, 6001);
+  histogram.Update(values.data(), values.size());
+  ASSERT_TRUE(histogram.HasValues());
+  // The range is [-4, 4], so each bin is 1/128 wide.
+  const float tolerance = 1.0f / 128;
+  EXPECT_NEAR(histogram.Quantile(0.0), -3.0f, tolerance);
+  EXPECT_NEAR(histogram.Quantile(0.25), -1.5f, tolerance);
+  EXPECT_NEAR(histogram.Quantile(0.5), 0.0f, tolerance);
+  EXPECT_NEAR(histogram.Quantile(1.0), 3.0f, tolerance);
+}
+
+TEST(HistogramTest, GrowingRangeKeepsCounts) {
+  Histogram histogram(64);
+  const std::vector<float> small = Ramp(0.0f, 0.01f, 100);
+  histogram.Update(small.data(), small.size());
+  const float large = 1000.0f;
+  histogram.Update(&large, 1);
+  // The small values now share a bin of width 64, but still hold all but the
+  // last percent of the mass.
+  EXPECT_LT(histogram.Quantile(0.98), 64.0f);
+  EXPECT_NEAR(histogram.Quantile(1.0), 1024.0f, 64.0f);
+}
+
+TEST(HistogramTest, MergeMatchesSingleHistogram) {
+  const std::vector<float> first = Ramp(-0.5f, 0.01f, 100);
+  const std::vector<float> second = Ramp(-20.0f, 0.5f, 100);
+  Histogram single(256);
+  single.Update(first.data(), first.size());
+  single.Update(second.data(), second.size());
+
+  Histogram left(256), right(256);
+  left.Update(first.data(), first.size());
+  right.Update(second.data(), second.size());
+  ASSERT_EQ(left.Merge(right), kTfLiteOk);
+  for (double fraction : {0.0, 0.1, 0.33, 0.5, 0.9, 1.0}) {
+    EXPECT_FLOAT_EQ(left.Quantile(fraction), single.Quantile(fraction));
+  }
+
+  Histogram other_bins(128);
+  EXPECT_EQ(left.Merge(other_bins), kTfLiteError);
+}
+
+TEST(HistogramTest, SkipsNonFiniteValues) {
+  Histogram histogram(64);
+  const std::vector<float> values = {
+      std::numeric_limits<float>::quiet_NaN(),
+      -std::numeric_limits<float>::infinity(), 1.0f, 2.0f,
+      std::numeric_limits<float>::infinity()};
+  histogram.Update(values.data(), values.size());
+  ASSERT_TRUE(histogram.HasValues());
+  // The range is [-2, 2], so each bin is 1/16 wide.
+  EXPECT_NEAR(histogram.Quantile(0.0), 1.0f, 1.0f / 16);
+  EXPECT_NEAR(histogram.Quantile(1.0), 2.0f, 1.0f / 16);
+
+  Histogram empty(64);
+  empty.Update(values.data(), 2);
+  EXPECT_FALSE(empty.HasValues());
+}
+
+TEST(LoggerTest, MergeCombinesTensors) {
+  Logger first(64), second(64);
+  const std::vector<float> low = {-2.0f, 1.0f};
+  const std::vector<float> high = {0.5f, 3.0f};
+  ASSERT_EQ(first.LogTensorValue(0, low.data(), low.size(), nullptr),
+            kTfLiteOk);
+  ASSERT_EQ(second.LogTensorValue(0, high.data(), high.size(), nullptr),
+            kTfLiteOk);
+  ASSERT_EQ(second.LogTensorValue(1, high.data(), high.size(), nullptr),
+            kTfLiteOk);
+  ASSERT_EQ(first.Merge(second), kTfLiteOk);
+
+  float min, max;
+  ASSERT_EQ(first.GetCalibrationValues().at(0).Get(&min, &max), kTfLiteOk);
+  EXPECT_EQ(min, -2.0f);
+  EXPECT_EQ(max, 3.0f);
+  ASSERT_EQ(first.GetCalibrationValues().at(1).Get(&min, &max), kTfLiteOk);
+  EXPECT_EQ(min, 0.5f);
+  EXPECT_EQ(max, 3.0f);
+  EXPECT_EQ(first.GetHistograms().size(), 2);
+  EXPECT_TRUE(first.GetHistograms().at(1).HasValues());
+}
+
+}  // namespace
+}  // namespace calibration
+}  // namespace optimize
+}  // namespace tflite
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/tools/optimize/calibration/calibration_reader.h"
 
+#include <algorithm>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 
@@ -35,14 +37,28 @@ TfLiteStatus CalibrationReader::GetTensorStatsAsMap(
 
 TfLiteStatus CalibrationReader::AddCalibrationToModel(ModelT* model,
                                                       bool update) const {
+  return AddCalibrationToModel(model, update, /*percentile=*/100.0f);
+}
+
+TfLiteStatus CalibrationReader::AddCalibrationToModel(ModelT* model,
+                                                      bool update,
+                                                      float percentile) const {
   if (!model || model->subgraphs.empty()) {
     return kTfLiteError;
   }
   const auto& subgraph = model->subgraphs[0];
+  const auto& histograms = logger_->GetHistograms();
+  const double tail = (1.0 - percentile / 100.0) / 2.0;
   for (const auto& tensorid_stat : logger_->GetCalibrationValues()) {
     auto minmax = tensorid_stat.second;
     float min, max;
     TF_LITE_ENSURE_STATUS(minmax.Get(&min, &max));
+    const auto histogram = histograms.find(tensorid_stat.first);
+    if (tail > 0 && histogram != histograms.end() &&
+        histogram->second.HasValues()) {
+      min = std::min(max, std::max(min, histogram->second.Quantile(tail)));
+      max = std::max(min, std::min(max, histogram->second.Quantile(1 - tail)));
+    }
     if (update) {
       auto tensor = subgraph->tensors[tensorid_stat.first].get();
       if (tensor->quantization) {
@@ -61,6 +77,10 @@ TfLiteStatus CalibrationReader::AddCalibrationToModel(ModelT* model,
 
   return kTfLiteOk;
 }
+
+TfLiteStatus CalibrationReader::AddLoggedValuesTo(Logger* logger) const {
+  return logger->Merge(*logger_);
+}
 }  // namespace calibration
 }  // namespace optimize
 }  // namespace tflite
@@ -45,6 +45,17 @@ class CalibrationReader {
   // being overwritten.
   virtual TfLiteStatus AddCalibrationToModel(ModelT* model, bool update) const;
 
+  // Same as above, but if the logger counted the values of a tensor in a
+  // histogram, its range is narrowed to the central |percentile| percent of
+  // those values. Clipping rare outliers usually lowers the quantization error
+  // of activations with long tails.
+  virtual TfLiteStatus AddCalibrationToModel(ModelT* model, bool update,
+                                             float percentile) const;
+
+  // Adds the values logged so far to |logger|, e.g. to combine the statistics
+  // of interpreters that were calibrated in parallel.
+  TfLiteStatus AddLoggedValuesTo(Logger* logger) const;
+
   virtual ~CalibrationReader() {}
 
  private:
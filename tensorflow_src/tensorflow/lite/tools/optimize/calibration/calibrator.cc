@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/tools/optimize/calibration/calibrator.h"
 
+#include <pthread.h>
+
 #include <fstream>
 #include <memory>
 #include <string>
@@ -60,11 +62,11 @@ class Calibrator {
   Calibrator(const std::unordered_map<const TfLiteNode*, OperatorInfo>&
                  node_ptr_opinfo_map,
              std::unique_ptr<LoggingOpResolver> logging_op_resolver,
-             ErrorReporter* error_reporter)
+             int histogram_bins, ErrorReporter* error_reporter)
       : node_ptr_opinfo_map_(node_ptr_opinfo_map),
         logging_op_resolver_(std::move(logging_op_resolver)),
         error_reporter_(error_reporter) {
-    logger_ = absl::make_unique<Logger>();
+    logger_ = absl::make_unique<Logger>(histogram_bins);
   }
 
   // Returns the wrapped kernel invoke function |TfLiteRegistration.invoke|.
@@ -124,11 +126,19 @@ KernelEvalFuncPtr Calibrator::GetKernelInvoke(const TfLiteNode* node) const {
 //
 // This way the kernel invoke functions can get the access to the Calibrator
 // object associated with the |TfLiteContext|.
+//
+// The registry is thread safe, so that several logging interpreters can be
+// built and invoked concurrently. Lookups, made for every logged op, only
+// take a read lock and do not wait for each other.
 class GlobalCalibratorRegistry {
  public:
+  GlobalCalibratorRegistry() { pthread_rwlock_init(&lock_, nullptr); }
+  ~GlobalCalibratorRegistry() { pthread_rwlock_destroy(&lock_); }
+
   // Get the |Calibrator| associated with given context, returns null if no
   // calibrator is associated with the given context.
   Calibrator* GetCalibrator(const TfLiteContext* context) const {
+    ScopedLock lock(&lock_, /*exclusive=*/false);
     if (calibrator_registry_.find(context) == calibrator_registry_.cend()) {
       return nullptr;
     }
@@ -138,6 +148,7 @@ class GlobalCalibratorRegistry {
   // Removes the association between calibrator and context.
   // Note: This deletes the calibrator as well.
   void RemoveCalibrator(const TfLiteContext* context) {
+    ScopedLock lock(&lock_, /*exclusive=*/true);
     calibrator_registry_.erase(context);
   }
 
@@ -148,20 +159,40 @@ class GlobalCalibratorRegistry {
       const TfLiteContext* context,
       const std::unordered_map<const TfLiteNode*, OperatorInfo>& node_to_opinfo,
       std::unique_ptr<LoggingOpResolver> logging_op_resolver,
-      Calibrator** calibrator_ptr, ErrorReporter* reporter) {
+      int histogram_bins, Calibrator** calibrator_ptr,
+      ErrorReporter* reporter) {
+    ScopedLock lock(&lock_, /*exclusive=*/true);
     if (calibrator_registry_.find(context) != calibrator_registry_.cend()) {
       reporter->Report(
           "Failed to create calibrator, context already registered.");
       return kTfLiteError;
     }
     auto calibrator = absl::make_unique<Calibrator>(
-        node_to_opinfo, std::move(logging_op_resolver), reporter);
+        node_to_opinfo, std::move(logging_op_resolver), histogram_bins,
+        reporter);
     calibrator_registry_[context] = std::move(calibrator);
     *calibrator_ptr = calibrator_registry_.at(context).get();
     return kTfLiteOk;
   }
 
  private:
+  // Holds |lock| for writing if |exclusive|, else for reading.
+  class ScopedLock {
+   public:
+    ScopedLock(pthread_rwlock_t* lock, bool exclusive) : lock_(lock) {
+      if (exclusive) {
+        pthread_rwlock_wrlock(lock_);
+      } else {
+        pthread_rwlock_rdlock(lock_);
+      }
+    }
+    ~ScopedLock() { pthread_rwlock_unlock(lock_); }
+
+   private:
+    pthread_rwlock_t* lock_;
+  };
+
+  mutable pthread_rwlock_t lock_;
   std::unordered_map<const TfLiteContext*, std::unique_ptr<Calibrator>>
       calibrator_registry_;
 };
@@ -329,6 +360,16 @@ TfLiteStatus BuildLoggingInterpreter(
     const tflite::Model* tflite_model, ErrorReporter* error_reporter,
     const OpResolver& op_resolver, std::unique_ptr<Interpreter>* interpreter,
     std::unique_ptr<CalibrationReader>* calibration_reader) {
+  return BuildLoggingInterpreter(tflite_model, error_reporter, op_resolver,
+                                 /*histogram_bins=*/0, interpreter,
+                                 calibration_reader);
+}
+
+TfLiteStatus BuildLoggingInterpreter(
+    const tflite::Model* tflite_model, ErrorReporter* error_reporter,
+    const OpResolver& op_resolver, int histogram_bins,
+    std::unique_ptr<Interpreter>* interpreter,
+    std::unique_ptr<CalibrationReader>* calibration_reader) {
   if (error_reporter == nullptr) {
     // Make sure error_reporter is valid.
     error_reporter = DefaultErrorReporter();
@@ -413,8 +454,8 @@ TfLiteStatus BuildLoggingInterpreter(
   // Register a calibrator object for the context. This can be accessed
   // during invocations by the logging kernels.
   TF_LITE_ENSURE_STATUS(GetCalibratorRegistry()->CreateCalibrator(
-      context, node_ptr_opinfo_map, std::move(logging_op_resolver), &calibrator,
-      error_reporter));
+      context, node_ptr_opinfo_map, std::move(logging_op_resolver),
+      histogram_bins, &calibrator, error_reporter));
   *calibration_reader = std::unique_ptr<CalibrationReader>(
       new Reader(context, calibrator->GetLogger()));
 
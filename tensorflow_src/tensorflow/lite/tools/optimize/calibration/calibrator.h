@@ -65,6 +65,15 @@ TfLiteStatus BuildLoggingInterpreter(
     const OpResolver& op_resolver, std::unique_ptr<Interpreter>* interpreter,
     std::unique_ptr<CalibrationReader>* calibration_reader);
 
+// Same as above, except the logger also counts the values of every tensor in a
+// histogram of |histogram_bins| bins, from which
+// CalibrationReader::AddCalibrationToModel can derive percentile ranges.
+TfLiteStatus BuildLoggingInterpreter(
+    const tflite::Model* model, ErrorReporter* error_reporter,
+    const OpResolver& op_resolver, int histogram_bins,
+    std::unique_ptr<Interpreter>* interpreter,
+    std::unique_ptr<CalibrationReader>* calibration_reader);
+
 }  // namespace calibration
 }  // namespace optimize
 }  // namespace tflite
@@ -0,0 +1,104 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/optimize/calibration/parallel_calibrator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/tools/optimize/calibration/calibration_logger.h"
+#include "tensorflow/lite/tools/optimize/calibration/calibration_reader.h"
+#include "tensorflow/lite/tools/optimize/calibration/calibrator.h"
+#include "tensorflow/lite/tools/optimize/quantize_model.h"
+
+namespace tflite {
+namespace optimize {
+namespace calibration {
+
+TfLiteStatus CalibrateModel(const FlatBufferModel& model,
+                            const OpResolver& op_resolver, int num_samples,
+                            const CalibrationSampleLoader& load_sample,
+                            const CalibrationOptions& options,
+                            ModelT* calibrated_model) {
+  ErrorReporter* error_reporter = model.error_reporter();
+  const int num_threads =
+      std::max(1, std::min(options.num_threads, num_samples));
+  const int histogram_bins =
+      options.percentile < 100.0f ? options.histogram_bins : 0;
+
+  std::vector<std::unique_ptr<Interpreter>> interpreters(num_threads);
+  std::vector<std::unique_ptr<CalibrationReader>> readers(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    TF_LITE_ENSURE_STATUS(BuildLoggingInterpreter(
+        model.GetModel(), error_reporter, op_resolver, histogram_bins,
+        &interpreters[i], &readers[i]));
+    // The calibration threads already keep the cores busy.
+    interpreters[i]->SetNumThreads(1);
+    TF_LITE_ENSURE_STATUS(interpreters[i]->AllocateTensors());
+  }
+
+  std::atomic<int> next_sample(0);
+  std::atomic<bool> failed(false);
+  auto calibrate = [&](Interpreter* interpreter) {
+    for (int index = next_sample++; index < num_samples && !failed;
+         index = next_sample++) {
+      if (load_sample(index, interpreter) != kTfLiteOk ||
+          interpreter->Invoke() != kTfLiteOk) {
+        TF_LITE_REPORT_ERROR(error_reporter,
+                             "Calibration failed on sample %d.", index);
+        failed = true;
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_threads; ++i) {
+    threads.emplace_back(calibrate, interpreters[i].get());
+  }
+  calibrate(interpreters[0].get());
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  if (failed) return kTfLiteError;
+
+  Logger logger(histogram_bins);
+  for (const auto& reader : readers) {
+    TF_LITE_ENSURE_STATUS(reader->AddLoggedValuesTo(&logger));
+  }
+  model.GetModel()->UnPackTo(calibrated_model);
+  return CalibrationReader(&logger).AddCalibrationToModel(
+      calibrated_model, /*update=*/false, options.percentile);
+}
+
+TfLiteStatus CalibrateAndQuantizeModel(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    int num_samples, const CalibrationSampleLoader& load_sample,
+    const CalibrationOptions& options, const TensorType& input_type,
+    const TensorType& output_type, bool allow_float,
+    flatbuffers::FlatBufferBuilder* builder) {
+  ModelT calibrated_model;
+  TF_LITE_ENSURE_STATUS(CalibrateModel(model, op_resolver, num_samples,
+                                       load_sample, options,
+                                       &calibrated_model));
+  return QuantizeModel(builder, &calibrated_model, input_type, output_type,
+                       allow_float, model.error_reporter());
+}
+
+}  // namespace calibration
+}  // namespace optimize
+}  // namespace tflite
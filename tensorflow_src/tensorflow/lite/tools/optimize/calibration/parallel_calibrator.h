@@ -0,0 +1,75 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_OPTIMIZE_CALIBRATION_PARALLEL_CALIBRATOR_H_
+#define TENSORFLOW_LITE_TOOLS_OPTIMIZE_CALIBRATION_PARALLEL_CALIBRATOR_H_
+
+#include <functional>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace optimize {
+namespace calibration {
+
+// Warning: This is not a public API and subject to change.
+
+struct CalibrationOptions {
+  // Number of logging interpreters invoked concurrently, each on its own
+  // thread and with a single kernel thread.
+  int num_threads = 1;
+  // Below 100, the range of every activation is the central |percentile|
+  // percent of its values rather than its absolute min and max.
+  float percentile = 100.0f;
+  // Bins of the per tensor histograms kept when |percentile| is below 100.
+  int histogram_bins = 2048;
+};
+
+// Fills the input tensors of |interpreter| with calibration sample |index|.
+// It is called concurrently from all calibration threads, each passing its
+// own interpreter, and must be thread safe. The interpreter has its tensors
+// allocated; if inputs are resized, AllocateTensors must be called again.
+using CalibrationSampleLoader =
+    std::function<TfLiteStatus(int index, Interpreter* interpreter)>;
+
+// Runs the float |model| on samples [0, num_samples) spread over
+// |options.num_threads| logging interpreters, see BuildLoggingInterpreter.
+// Samples are loaded one at a time as threads become free, so the
+// calibration set never has to be held in memory. The statistics of the
+// threads are merged and |calibrated_model| is set to a copy of |model| with
+// the resulting ranges, ready for QuantizeModel.
+TfLiteStatus CalibrateModel(const FlatBufferModel& model,
+                            const OpResolver& op_resolver, int num_samples,
+                            const CalibrationSampleLoader& load_sample,
+                            const CalibrationOptions& options,
+                            ModelT* calibrated_model);
+
+// Same as above, but quantizes the calibrated model into |builder| with the
+// given input and output types, see QuantizeModel.
+TfLiteStatus CalibrateAndQuantizeModel(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    int num_samples, const CalibrationSampleLoader& load_sample,
+    const CalibrationOptions& options, const TensorType& input_type,
+    const TensorType& output_type, bool allow_float,
+    flatbuffers::FlatBufferBuilder* builder);
+
+}  // namespace calibration
+}  // namespace optimize
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_OPTIMIZE_CALIBRATION_PARALLEL_CALIBRATOR_H_
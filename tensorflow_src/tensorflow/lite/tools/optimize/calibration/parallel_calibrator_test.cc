@@ -0,0 +1,187 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/optimize/calibration/parallel_calibrator.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/util/command_line_flags.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model.h"
+
+namespace {
+tensorflow::string* g_test_model_dir = nullptr;
+}  // namespace
+
+namespace tflite {
+namespace optimize {
+namespace calibration {
+namespace {
+
+std::unique_ptr<FlatBufferModel> ReadModel(const string& model_name) {
+  auto model_path = tensorflow::io::JoinPath(*g_test_model_dir, model_name);
+  return FlatBufferModel::BuildFromFile(model_path.c_str());
+}
+
+// Model does the following:
+// 0        1       2        3
+// |        |__ ____|        |
+// |           |             |
+// |          Add(tensor:4)  |
+// |____ ______|______ ______|
+//      |             |
+//      Add          Add
+//      |             |
+//    Output:5      Output:6
+//
+// Sample k fills input i with (i + 1) * (k % 5 + 1).
+TfLiteStatus LoadScaledSample(int index, Interpreter* interpreter) {
+  for (size_t i = 0; i < interpreter->inputs().size(); i++) {
+    TfLiteTensor* tensor = interpreter->input_tensor(i);
+    const int size = tensor->bytes / sizeof(float);
+    for (int j = 0; j < size; j++) {
+      tensor->data.f[j] = (i + 1) * (index % 5 + 1);
+    }
+  }
+  return kTfLiteOk;
+}
+
+void ExpectRange(const ModelT& model, int tensor_index, float min, float max) {
+  const auto& quantization =
+      model.subgraphs[0]->tensors[tensor_index]->quantization;
+  ASSERT_TRUE(quantization);
+  ASSERT_EQ(quantization->min.size(), 1);
+  ASSERT_EQ(quantization->max.size(), 1);
+  EXPECT_NEAR(quantization->min[0], min, 1e-6f) << "tensor " << tensor_index;
+  EXPECT_NEAR(quantization->max[0], max, 1e-6f) << "tensor " << tensor_index;
+}
+
+TEST(ParallelCalibratorTest, ThreadsMergeMinMax) {
+  auto model = ReadModel("multi_add.bin");
+  ASSERT_TRUE(model);
+  for (int num_threads : {1, 4}) {
+    CalibrationOptions options;
+    options.num_threads = num_threads;
+    ModelT calibrated_model;
+    ASSERT_EQ(CalibrateModel(*model, ops::builtin::BuiltinOpResolver{}, 23,
+                             LoadScaledSample, options, &calibrated_model),
+              kTfLiteOk);
+    for (int tensor_idx = 0; tensor_idx < 4; tensor_idx++) {
+      ExpectRange(calibrated_model, tensor_idx, tensor_idx + 1,
+                  5 * (tensor_idx + 1));
+    }
+    ExpectRange(calibrated_model, 4, 5, 25);
+    ExpectRange(calibrated_model, 5, 6, 30);
+    ExpectRange(calibrated_model, 6, 9, 45);
+  }
+}
+
+TEST(ParallelCalibratorTest, PercentileClipsOutliers) {
+  auto model = ReadModel("multi_add.bin");
+  ASSERT_TRUE(model);
+  // Every sample has values in [-1, 1] and one outlier of 100 in each input,
+  // i.e. about half a percent of the values.
+  auto load_sample = [](int index, Interpreter* interpreter) {
+    for (size_t i = 0; i < interpreter->inputs().size(); i++) {
+      TfLiteTensor* tensor = interpreter->input_tensor(i);
+      const int size = tensor->bytes / sizeof(float);
+      for (int j = 0; j < size; j++) {
+        tensor->data.f[j] = ((j + index) % 21 - 10) / 10.0f;
+      }
+      tensor->data.f[index % size] = 100.0f;
+    }
+    return kTfLiteOk;
+  };
+  CalibrationOptions options;
+  options.num_threads = 3;
+  ModelT min_max_model;
+  ASSERT_EQ(CalibrateModel(*model, ops::builtin::BuiltinOpResolver{}, 16,
+                           load_sample, options, &min_max_model),
+            kTfLiteOk);
+  ExpectRange(min_max_model, 0, -1.0f, 100.0f);
+
+  options.percentile = 98.0f;
+  ModelT percentile_model;
+  ASSERT_EQ(CalibrateModel(*model, ops::builtin::BuiltinOpResolver{}, 16,
+                           load_sample, options, &percentile_model),
+            kTfLiteOk);
+  for (int tensor_idx = 0; tensor_idx < 4; tensor_idx++) {
+    const auto& quantization =
+        percentile_model.subgraphs[0]->tensors[tensor_idx]->quantization;
+    EXPECT_GE(quantization->min[0], -1.0f);
+    EXPECT_LT(quantization->min[0], -0.8f);
+    EXPECT_GT(quantization->max[0], 0.8f);
+    EXPECT_LT(quantization->max[0], 1.5f);
+  }
+}
+
+TEST(ParallelCalibratorTest, SampleErrorsFailCalibration) {
+  auto model = ReadModel("multi_add.bin");
+  ASSERT_TRUE(model);
+  CalibrationOptions options;
+  options.num_threads = 2;
+  auto load_sample = [](int index, Interpreter* interpreter) {
+    return index == 7 ? kTfLiteError : LoadScaledSample(index, interpreter);
+  };
+  ModelT calibrated_model;
+  EXPECT_EQ(CalibrateModel(*model, ops::builtin::BuiltinOpResolver{}, 10,
+                           load_sample, options, &calibrated_model),
+            kTfLiteError);
+}
+
+TEST(ParallelCalibratorTest, QuantizesCalibratedModel) {
+  auto model = ReadModel("multi_add.bin");
+  ASSERT_TRUE(model);
+  CalibrationOptions options;
+  options.num_threads = 2;
+  flatbuffers::FlatBufferBuilder builder;
+  ASSERT_EQ(CalibrateAndQuantizeModel(*model,
+                                      ops::builtin::BuiltinOpResolver{}, 10,
+                                      LoadScaledSample, options,
+                                      TensorType_INT8, TensorType_INT8,
+                                      /*allow_float=*/false, &builder),
+            kTfLiteOk);
+  const Model* quantized_model = GetModel(builder.GetBufferPointer());
+  const auto* subgraph = quantized_model->subgraphs()->Get(0);
+  for (int output : *subgraph->outputs()) {
+    const auto* tensor = subgraph->tensors()->Get(output);
+    EXPECT_EQ(tensor->type(), TensorType_INT8);
+    EXPECT_EQ(tensor->quantization()->scale()->size(), 1);
+  }
+}
+
+}  // namespace
+}  // namespace calibration
+}  // namespace optimize
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  tensorflow::string model_file;
+  const std::vector<tensorflow::Flag> flag_list = {
+      tensorflow::Flag("test_model_file", &model_file,
+                       "Path to test tflite model file."),
+  };
+
+  const bool parse_result = tensorflow::Flags::Parse(&argc, argv, flag_list);
+  if (!parse_result) {
+    std::cerr << "Required test_model_file\n";
+    std::abort();
+  }
+  g_test_model_dir =
+      new tensorflow::string(tensorflow::io::Dirname(model_file));
+  ::tensorflow::port::InitMain(argv[0], &argc, &argv);
+  return RUN_ALL_TESTS();
+}
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/kernels/internal/cppmath.h"
+#include "tensorflow/lite/kernels/internal/packed_int4.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/internal/types.h"
@@ -596,6 +597,52 @@ TfLiteStatus SymmetricQuantizeTensorPerChannel(ModelT* model, TensorT* tensor,
                                model, tensor, error_reporter);
 }
 
+TfLiteStatus SymmetricQuantizeTensorInt4PerChannel(
+    ModelT* model, TensorT* tensor, ErrorReporter* error_reporter) {
+  if (tensor->shape.empty() || tensor->shape[0] <= 0) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "SymmetricQuantizeTensorInt4PerChannel requires a "
+                         "non-empty first dimension.");
+    return kTfLiteError;
+  }
+  uint64_t num_elements;
+  TF_LITE_ENSURE_STATUS(NumElements(*tensor, &num_elements));
+  const int32_t channel_dim_size = tensor->shape[0];
+  const uint64_t channel_stride = num_elements / channel_dim_size;
+
+  // Copy single byte buffer data to float vector to guard against misalignment.
+  const BufferT* buffer = model->buffers[tensor->buffer].get();
+  std::vector<float> float_vector(num_elements);
+  std::copy(buffer->data.begin(), buffer->data.end(),
+            reinterpret_cast<uint8_t*>(float_vector.data()));
+
+  constexpr int kMaxInt4 = 7;
+  constexpr int kMinInt4 = -8;
+  std::vector<float> scales(channel_dim_size);
+  std::vector<int8_t> quantized(num_elements);
+  for (int32_t channel = 0; channel < channel_dim_size; ++channel) {
+    const float* channel_data = float_vector.data() + channel * channel_stride;
+    float max_abs = 0.0f;
+    for (uint64_t i = 0; i < channel_stride; ++i) {
+      max_abs = std::max(max_abs, std::abs(channel_data[i]));
+    }
+    const float scale = max_abs == 0.0f ? 1.0f : max_abs / kMaxInt4;
+    scales[channel] = scale;
+    for (uint64_t i = 0; i < channel_stride; ++i) {
+      const int value = TfLiteRound(channel_data[i] / scale);
+      quantized[channel * channel_stride + i] =
+          std::min(kMaxInt4, std::max(kMinInt4, value));
+    }
+  }
+
+  std::vector<uint8_t> packed((num_elements + 1) / 2);
+  internal::PackInt4(quantized.data(), num_elements, packed.data());
+  std::vector<int64_t> zero_point(scales.size(), 0);
+  return AddQuantizationParams(scales, zero_point, 0, packed.data(),
+                               packed.size(), TensorType_INT4, model, tensor,
+                               error_reporter);
+}
+
 template <class BiasType>
 std::vector<BiasType> SymmetricBiasQuantize(const float* data,
                                             uint64_t num_elements,
@@ -107,6 +107,11 @@ TfLiteStatus SymmetricQuantizeTensorPerChannel(ModelT* model, TensorT* tensor,
                                                int32_t channel_dim_index,
                                                ErrorReporter* error_reporter);
 
+// Symmetrically quantizes tensor to packed 4 bit integers with one scale per
+// slice of the first dimension.
+TfLiteStatus SymmetricQuantizeTensorInt4PerChannel(
+    ModelT* model, TensorT* tensor, ErrorReporter* error_reporter);
+
 // Symmetrically quantizes float to 16bits.
 TfLiteStatus SymmetricQuantizeFloatsToInt16(ModelT* model, TensorT* tensor,
                                             float scaling_factor,
@@ -719,6 +719,43 @@ TEST_F(QuantizationUtilsTest, SymmetricQuantizeFloatsToInt16Test) {
   EXPECT_EQ(model->subgraphs[0]->tensors[0]->type, TensorType_INT16);
 }
 
+TEST_F(QuantizationUtilsTest, SymmetricQuantizeTensorInt4PerChannel) {
+  // Create data.
+  auto model = absl::make_unique<ModelT>();
+  auto subgraph = absl::make_unique<tflite::SubGraphT>();
+  auto tensor = absl::make_unique<TensorT>();
+  auto buffer = absl::make_unique<tflite::BufferT>();
+  // The second channel is all zeros and should get a unit scale.
+  std::vector<float> weights = {1.4, -0.6, 0.2, 0.0, 0.0, 0.0};
+  auto weights_reinterpreted_data =
+      reinterpret_cast<const unsigned char*>(weights.data());
+  buffer->data.assign(weights_reinterpreted_data,
+                      weights_reinterpreted_data + weights.size() * 4);
+  tensor->buffer = 0;
+  tensor->shape = {2, 3};
+
+  // Wire the model.
+  model->subgraphs.push_back(std::move(subgraph));
+  model->subgraphs[0]->tensors.push_back(std::move(tensor));
+  model->buffers.push_back(std::move(buffer));
+
+  // Call and verify.
+  EXPECT_EQ(SymmetricQuantizeTensorInt4PerChannel(
+                model.get(), model->subgraphs[0]->tensors[0].get(),
+                &error_reporter_),
+            kTfLiteOk);
+
+  const TensorT* result = model->subgraphs[0]->tensors[0].get();
+  EXPECT_EQ(result->type, TensorType_INT4);
+  EXPECT_THAT(result->quantization->scale[0], testing::FloatEq(0.2));
+  EXPECT_THAT(result->quantization->scale[1], 1.0);
+  EXPECT_THAT(result->quantization->zero_point, ElementsAreArray({0, 0}));
+  EXPECT_EQ(result->quantization->quantized_dimension, 0);
+  // {7, -3, 1, 0, 0, 0} packed two to a byte, low nibble first.
+  EXPECT_THAT(model->buffers[result->buffer]->data,
+              ElementsAreArray({0xD7, 0x01, 0x00}));
+}
+
 TEST_F(QuantizationUtilsTest, SymmetricPerLayerBiasQuantize) {
   // Create data.
   auto model = absl::make_unique<ModelT>();
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/lite/model.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 #include "tensorflow/lite/schema/schema_utils.h"
+#include "tensorflow/lite/stderr_reporter.h"
 #include "tensorflow/lite/tools/optimize/model_utils.h"
 #include "tensorflow/lite/tools/optimize/quantization_utils.h"
 
@@ -622,6 +623,28 @@ TfLiteStatus QuantizeWeightsFloat16(flatbuffers::FlatBufferBuilder* builder,
   FinishModelBuffer(*builder, output_model_location);
   return kTfLiteOk;
 }
+
+// Returns true if the consumer can read the tensor as packed int4 weights.
+bool ConsumesInt4Weights(const ModelT* model, const ConsumerOpInfo& info) {
+  const OperatorT* op = info.op;
+  if (info.op_input_idx != 1) {
+    return false;
+  }
+  switch (GetBuiltinCode(model->operator_codes[op->opcode_index].get())) {
+    case BuiltinOperator_FULLY_CONNECTED: {
+      const FullyConnectedOptionsT* options =
+          op->builtin_options.AsFullyConnectedOptions();
+      return options == nullptr ||
+             options->weights_format ==
+                 FullyConnectedOptionsWeightsFormat_DEFAULT;
+    }
+    case BuiltinOperator_CONV_2D:
+    case BuiltinOperator_EMBEDDING_LOOKUP:
+      return true;
+    default:
+      return false;
+  }
+}
 }  // namespace
 
 namespace internal {
@@ -636,6 +659,80 @@ TfLiteStatus QuantizeWeights(flatbuffers::FlatBufferBuilder* builder,
                              weights_min_num_elements, custom_op_map,
                              kUseUpdatedHybridSchemeDefault);
 }
+
+TfLiteStatus QuantizeWeightsInt4(flatbuffers::FlatBufferBuilder* builder,
+                                 const Model* input_model,
+                                 uint64_t weights_min_num_elements) {
+  std::unique_ptr<ModelT> model;
+  model.reset(input_model->UnPack());
+
+  for (int subgraph_index = 0, end = model->subgraphs.size();
+       subgraph_index < end; ++subgraph_index) {
+    SubGraphT* subgraph = model->subgraphs.at(subgraph_index).get();
+
+    absl::flat_hash_map<int32_t, TensorT*> tensor_map;
+    for (int i = 0, sub_end = subgraph->operators.size(); i < sub_end; ++i) {
+      OperatorT* op = subgraph->operators[i].get();
+      if (op->inputs.size() < 2 || op->inputs[1] == kTfLiteOptionalTensor) {
+        continue;
+      }
+      const int32_t tensor_idx = op->inputs[1];
+      TensorT* tensor = subgraph->tensors[tensor_idx].get();
+      BufferT* buffer = model->buffers[tensor->buffer].get();
+      if (buffer == nullptr) {
+        return kTfLiteError;
+      }
+      uint64_t num_elements;
+      TF_LITE_ENSURE_STATUS(utils::NumElements(*tensor, &num_elements));
+      if (tensor->type != TensorType_FLOAT32 || buffer->data.empty() ||
+          num_elements < weights_min_num_elements) {
+        continue;
+      }
+      // There is no dequantize fallback for int4, so a weight shared with
+      // any other kind of consumer stays in float.
+      bool all_consumers_take_int4 = true;
+      for (const ConsumerOpInfo& info :
+           GetTensorConsumers(model.get(), subgraph, tensor_idx)) {
+        all_consumers_take_int4 &= ConsumesInt4Weights(model.get(), info);
+      }
+      if (all_consumers_take_int4) {
+        tensor_map.insert({tensor_idx, tensor});
+      }
+    }
+
+    // The hash map ensures that we quantize each tensor exactly once.
+    for (std::pair<int32_t, TensorT*> tensor_pair : tensor_map) {
+      TF_LITE_ENSURE_STATUS(utils::SymmetricQuantizeTensorInt4PerChannel(
+          model.get(), tensor_pair.second, tflite::DefaultErrorReporter()));
+    }
+
+    // Only the ops now reading packed weights need the newer kernels.
+    for (const std::unique_ptr<OperatorT>& op : subgraph->operators) {
+      if (op->inputs.size() < 2 || !tensor_map.contains(op->inputs[1])) {
+        continue;
+      }
+      OperatorCodeT* op_code = model->operator_codes[op->opcode_index].get();
+      switch (GetBuiltinCode(op_code)) {
+        case BuiltinOperator_FULLY_CONNECTED:
+          op_code->version = 10;
+          break;
+        case BuiltinOperator_CONV_2D:
+          op_code->version = 6;
+          break;
+        case BuiltinOperator_EMBEDDING_LOOKUP:
+          op_code->version = 4;
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  flatbuffers::Offset<Model> output_model_location =
+      Model::Pack(*builder, model.get());
+  FinishModelBuffer(*builder, output_model_location);
+  return kTfLiteOk;
+}
 }  // namespace internal
 
 TfLiteStatus QuantizeWeights(flatbuffers::FlatBufferBuilder* builder,
@@ -660,6 +757,9 @@ TfLiteStatus QuantizeWeights(flatbuffers::FlatBufferBuilder* builder,
     }
     case BufferType::QUANTIZED_FLOAT16:
       return QuantizeWeightsFloat16(builder, input_model);
+    case BufferType::QUANTIZED_INT4:
+      return internal::QuantizeWeightsInt4(builder, input_model,
+                                           kWeightsMinNumElementsDefault);
   }
 }
 
@@ -27,7 +27,9 @@ namespace tflite {
 namespace optimize {
 
 // Supported resulting types from quantization process.
-enum class BufferType { QUANTIZED_INT8, QUANTIZED_FLOAT16 };
+// QUANTIZED_INT4 packs the weights of FULLY_CONNECTED, CONV_2D and
+// EMBEDDING_LOOKUP two to a byte, leaving activations in float.
+enum class BufferType { QUANTIZED_INT8, QUANTIZED_FLOAT16, QUANTIZED_INT4 };
 
 // This macro is for internal use for conversions requiring previous behavior.
 #ifdef TFLITE_USE_PREVIOUS_HYBRID_SCHEME
@@ -86,6 +88,12 @@ TfLiteStatus QuantizeWeights(flatbuffers::FlatBufferBuilder* builder,
                              const Model* input_model,
                              uint64_t weights_min_num_elements,
                              bool use_hybrid_evaluation);
+
+// Same as QuantizeWeights with BufferType::QUANTIZED_INT4, but only weights
+// with greater than or equal weights_min_num_elements elements are quantized.
+TfLiteStatus QuantizeWeightsInt4(flatbuffers::FlatBufferBuilder* builder,
+                                 const Model* input_model,
+                                 uint64_t weights_min_num_elements);
 }  // namespace internal
 
 }  // namespace optimize
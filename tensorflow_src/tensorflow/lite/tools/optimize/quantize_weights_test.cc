@@ -348,6 +348,58 @@ TEST_F(QuantizeWeightsTest, DequantizeConvFloat16) {
   }
 }
 
+TEST_F(QuantizeWeightsTest, QuantizeConvInt4) {
+  LoadBasicModel();
+  flatbuffers::FlatBufferBuilder builder;
+  auto status = internal::QuantizeWeightsInt4(&builder, model_, 0);
+  EXPECT_EQ(status, kTfLiteOk);
+
+  const uint8_t* buffer = builder.GetBufferPointer();
+  const Model* output_model = GetModel(buffer);
+  ASSERT_TRUE(output_model);
+
+  ASSERT_EQ(output_model->subgraphs()->size(), model_->subgraphs()->size());
+  for (size_t subgraph_idx = 0; subgraph_idx < model_->subgraphs()->size();
+       ++subgraph_idx) {
+    const auto quantized_graph = output_model->subgraphs()->Get(subgraph_idx);
+    const auto float_graph = model_->subgraphs()->Get(subgraph_idx);
+    // The weights are consumed packed, so no dequantize op is added.
+    ASSERT_EQ(quantized_graph->tensors()->size(),
+              float_graph->tensors()->size());
+    ASSERT_EQ(quantized_graph->operators()->size(),
+              float_graph->operators()->size());
+    for (size_t i = 0; i < quantized_graph->operators()->size(); ++i) {
+      const auto op = quantized_graph->operators()->Get(i);
+      const auto op_code =
+          output_model->operator_codes()->Get(op->opcode_index());
+      ASSERT_EQ(GetBuiltinCode(op_code), BuiltinOperator_CONV_2D);
+      EXPECT_EQ(op_code->version(), 6);
+
+      const auto weights_tensor =
+          quantized_graph->tensors()->Get(op->inputs()->Get(1));
+      EXPECT_EQ(weights_tensor->type(), TensorType_INT4);
+      const auto shape = GetAsVector(weights_tensor->shape());
+      EXPECT_EQ(weights_tensor->quantization()->scale()->size(), shape[0]);
+      EXPECT_EQ(weights_tensor->quantization()->quantized_dimension(), 0);
+      int num_elements = 1;
+      for (int dim : shape) num_elements *= dim;
+      EXPECT_EQ(output_model->buffers()
+                    ->Get(weights_tensor->buffer())
+                    ->data()
+                    ->size(),
+                (num_elements + 1) / 2);
+
+      // Everything else, including the bias, stays in float.
+      for (int j = 0; j < quantized_graph->tensors()->size(); ++j) {
+        if (j != op->inputs()->Get(1)) {
+          EXPECT_EQ(quantized_graph->tensors()->Get(j)->type(),
+                    TensorType_FLOAT32);
+        }
+      }
+    }
+  }
+}
+
 TEST_F(QuantizeWeightsTest, SharedWeights_Hybrid) {
   LoadSharedWeightsModel();
   flatbuffers::FlatBufferBuilder builder;
@@ -74,6 +74,8 @@ inline TensorType TfLiteTypeToSchemaType(TfLiteType type) {
       return TensorType_UINT8;
     case kTfLiteInt8:
       return TensorType_INT8;
+    case kTfLiteInt4:
+      return TensorType_INT4;
     case kTfLiteInt64:
       return TensorType_INT64;
     case kTfLiteUInt64:
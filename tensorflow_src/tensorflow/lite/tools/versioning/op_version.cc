@@ -55,6 +55,10 @@ inline bool HaveSameShapes(const SubGraph* subgraph, const Operator* op,
 int GetBuiltinOperatorVersion(const OpSignature& op_sig) {
   switch (op_sig.op) {
     case BuiltinOperator_CONV_2D:
+      // Packed int4 filters with float activations are supported at version 6.
+      if (op_sig.input_types.at(1) == TensorType_INT4) {
+        return 6;
+      }
       // If the op has signed int16 op_sig.inputs and op_sig.outputs, its
       // version 4.
       if (op_sig.input_types.at(0) == TensorType_INT16 &&
@@ -129,6 +133,12 @@ int GetBuiltinOperatorVersion(const OpSignature& op_sig) {
       // | Quantized Int8  |                  4 |                        4 |
       // +-----------------+--------------------+--------------------------+
 
+      // Packed int4 weights with float activations are supported at version
+      // 10.
+      if (op_sig.input_types.at(1) == TensorType_INT4) {
+        return 10;
+      }
+
       // FullyConnected with sparse weight is supported at version 8.
       if (op_sig.options.fully_connected.sparse_weight) {
         return 8;
@@ -654,6 +664,12 @@ int GetBuiltinOperatorVersion(const OpSignature& op_sig) {
         return 3;
       }
       return 2;
+    case BuiltinOperator_EMBEDDING_LOOKUP:
+      // Packed int4 values are supported at version 4.
+      if (op_sig.input_types.at(1) == TensorType_INT4) {
+        return 4;
+      }
+      return 1;
     default:
       return 1;
   }
@@ -72,6 +72,7 @@ std::string FindMinimumRuntimeVersionForOp(tflite::BuiltinOperator op_code,
               {{BuiltinOperator_CONV_2D, 3}, "1.14.0"},
               {{BuiltinOperator_CONV_2D, 4}, "2.3.0"},
               {{BuiltinOperator_CONV_2D, 5}, "2.4.0"},
+              {{BuiltinOperator_CONV_2D, 6}, kPendingReleaseVersion},
               {{BuiltinOperator_DEPTHWISE_CONV_2D, 1}, "1.5.0"},
               {{BuiltinOperator_DEPTHWISE_CONV_2D, 2}, "1.12.0"},
               {{BuiltinOperator_DEPTHWISE_CONV_2D, 3}, "1.14.0"},
@@ -106,6 +107,7 @@ std::string FindMinimumRuntimeVersionForOp(tflite::BuiltinOperator op_code,
               {{BuiltinOperator_EMBEDDING_LOOKUP, 1}, "1.13.0"},
               {{BuiltinOperator_EMBEDDING_LOOKUP, 2}, "1.14.0"},
               {{BuiltinOperator_EMBEDDING_LOOKUP, 3}, "1.14.0"},
+              {{BuiltinOperator_EMBEDDING_LOOKUP, 4}, kPendingReleaseVersion},
               {{BuiltinOperator_EMBEDDING_LOOKUP_SPARSE, 1}, "1.5.0"},
               {{BuiltinOperator_FAKE_QUANT, 1}, "1.5.0"},
               {{BuiltinOperator_FAKE_QUANT, 2}, "1.10.0"},
@@ -118,6 +120,7 @@ std::string FindMinimumRuntimeVersionForOp(tflite::BuiltinOperator op_code,
               {{BuiltinOperator_FULLY_CONNECTED, 7}, "2.3.0"},
               {{BuiltinOperator_FULLY_CONNECTED, 8}, "2.3.0"},
               {{BuiltinOperator_FULLY_CONNECTED, 9}, "2.3.0"},
+              {{BuiltinOperator_FULLY_CONNECTED, 10}, kPendingReleaseVersion},
               {{BuiltinOperator_GATHER, 1}, "1.6.0"},
               {{BuiltinOperator_GATHER, 2}, "1.14.0"},
               {{BuiltinOperator_GATHER, 3}, "1.15.0"},
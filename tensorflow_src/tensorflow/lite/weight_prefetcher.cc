@@ -0,0 +1,269 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/weight_prefetcher.h"
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/lite/core/subgraph.h"
+
+namespace tflite {
+namespace {
+
+size_t PageSize() {
+#if !defined(_WIN32)
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+  return page_size;
+#else
+  return 4096;
+#endif
+}
+
+}  // namespace
+
+WeightPrefetcher::WeightPrefetcher(Interpreter* interpreter,
+                                   const Allocation* allocation)
+    : interpreter_(interpreter) {
+  const uintptr_t base = reinterpret_cast<uintptr_t>(allocation->base());
+  const uintptr_t end = base + allocation->bytes();
+  const uintptr_t page_size = PageSize();
+  // Pages already in a group, so that weights sharing pages or tensors
+  // shared by nodes are fetched once, for the first node using them.
+  std::vector<bool> seen_pages((allocation->bytes() + page_size - 1) /
+                                   page_size +
+                               1);
+  auto add_tensor = [&](const TfLiteTensor* tensor, Group* group) {
+    if (tensor == nullptr || tensor->allocation_type != kTfLiteMmapRo ||
+        tensor->bytes == 0) {
+      return;
+    }
+    const uintptr_t data = reinterpret_cast<uintptr_t>(tensor->data.raw);
+    if (data < base || data + tensor->bytes > end) return;
+    const size_t first_page = (data - (base & ~(page_size - 1))) / page_size;
+    const size_t last_page =
+        (data + tensor->bytes - 1 - (base & ~(page_size - 1))) / page_size;
+    for (size_t page = first_page; page <= last_page; ++page) {
+      if (seen_pages[page]) continue;
+      seen_pages[page] = true;
+      const char* begin = reinterpret_cast<const char*>(
+          (base & ~(page_size - 1)) + page * page_size);
+      // Extend the previous range over contiguous pages.
+      if (!group->empty() &&
+          group->back().begin + group->back().size == begin) {
+        group->back().size += page_size;
+      } else {
+        group->push_back({begin, page_size});
+      }
+      stats_.weight_bytes += page_size;
+    }
+  };
+  auto add_node = [&](Subgraph* subgraph, int node_index, Group* group) {
+    const TfLiteNode& node = subgraph->node_and_registration(node_index)->first;
+    for (int i = 0; i < node.inputs->size; ++i) {
+      const int tensor_index = node.inputs->data[i];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      add_tensor(subgraph->tensor(tensor_index), group);
+    }
+  };
+
+  Subgraph& primary = interpreter_->primary_subgraph();
+  node_groups_.assign(primary.nodes_size(), -1);
+  for (int node_index : primary.execution_plan()) {
+    node_groups_[node_index] = groups_.size();
+    groups_.emplace_back();
+    add_node(&primary, node_index, &groups_.back());
+  }
+  groups_.emplace_back();
+  for (int i = 1; i < interpreter_->subgraphs_size(); ++i) {
+    Subgraph* subgraph = interpreter_->subgraph(i);
+    for (int node_index : subgraph->execution_plan()) {
+      add_node(subgraph, node_index, &groups_.back());
+    }
+  }
+  fetched_.assign(groups_.size(), false);
+}
+
+WeightPrefetcher::~WeightPrefetcher() {
+  StopReadAhead();
+#if !defined(_WIN32)
+  for (const Range& range : locked_) munlock(range.begin, range.size);
+#endif
+}
+
+size_t WeightPrefetcher::Fetch(const Group& group, Mode mode) {
+  size_t bytes = 0;
+  for (const Range& range : group) {
+    if (mode == Mode::kTouch) {
+      const size_t page_size = PageSize();
+      // Volatile, so that the reads are not optimized away.
+      const volatile char* page = range.begin;
+      char sink = 0;
+      for (size_t offset = 0; offset < range.size; offset += page_size) {
+        sink ^= page[offset];
+      }
+      (void)sink;
+    } else {
+#if !defined(_WIN32)
+      madvise(const_cast<char*>(range.begin), range.size, MADV_WILLNEED);
+#endif
+    }
+    bytes += range.size;
+  }
+  return bytes;
+}
+
+size_t WeightPrefetcher::Prefault(Mode mode) {
+  size_t bytes = 0;
+  for (const Group& group : groups_) bytes += Fetch(group, mode);
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.prefaulted_bytes += bytes;
+  return bytes;
+}
+
+size_t WeightPrefetcher::Lock(size_t max_bytes) {
+  size_t bytes = 0;
+#if !defined(_WIN32)
+  for (const Group& group : groups_) {
+    size_t group_bytes = 0;
+    for (const Range& range : group) group_bytes += range.size;
+    if (bytes + group_bytes > max_bytes) break;
+    size_t locked = 0;
+    for (const Range& range : group) {
+      if (mlock(range.begin, range.size) != 0) break;
+      locked_.push_back(range);
+      locked += range.size;
+    }
+    bytes += locked;
+    if (locked < group_bytes) {
+      TF_LITE_REPORT_ERROR(interpreter_->error_reporter(),
+                           "Failed to lock the weights in memory after %zu "
+                           "bytes.",
+                           bytes);
+      break;
+    }
+  }
+#endif
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.locked_bytes += bytes;
+  return bytes;
+}
+
+void WeightPrefetcher::StartReadAhead(int window_nodes, Mode mode,
+                                      Profiler* next_profiler) {
+  StopReadAhead();
+  std::lock_guard<std::mutex> lock(mutex_);
+  next_profiler_ = next_profiler;
+  read_ahead_mode_ = mode;
+  window_nodes_ = std::max(window_nodes, 1);
+  next_group_ = 0;
+  target_group_ = window_nodes_;
+  stop_ = false;
+  running_ = true;
+  read_ahead_thread_ = std::thread([this]() { ReadAhead(); });
+}
+
+void WeightPrefetcher::StopReadAhead() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_up_.notify_all();
+  if (read_ahead_thread_.joinable()) read_ahead_thread_.join();
+}
+
+void WeightPrefetcher::ReadAhead() {
+  const int num_groups = groups_.size();
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_up_.wait(lock, [this, num_groups]() {
+      return stop_ || next_group_ >= num_groups ||
+             next_group_ < target_group_;
+    });
+    if (stop_ || next_group_ >= num_groups) {
+      running_ = false;
+      return;
+    }
+    const int group = next_group_++;
+    const Mode mode = read_ahead_mode_;
+    lock.unlock();
+    const size_t bytes = Fetch(groups_[group], mode);
+    lock.lock();
+    fetched_[group] = true;
+    stats_.read_ahead_bytes += bytes;
+  }
+}
+
+WeightPrefetchStats WeightPrefetcher::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+uint32_t WeightPrefetcher::BeginEvent(const char* tag, EventType event_type,
+                                      int64_t event_metadata1,
+                                      int64_t event_metadata2) {
+  // For operator events, the node and the subgraph it belongs to.
+  if (event_type == EventType::OPERATOR_INVOKE_EVENT && event_metadata2 == 0 &&
+      event_metadata1 >= 0 &&
+      static_cast<size_t>(event_metadata1) < node_groups_.size() &&
+      node_groups_[event_metadata1] >= 0) {
+    const int group = node_groups_[event_metadata1];
+    bool wake_up = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (running_ && !fetched_[group]) {
+        ++stats_.late_nodes;
+        // The node faults its own weights in, skip to the next ones.
+        fetched_[group] = true;
+        next_group_ = std::max(next_group_, group + 1);
+      }
+      if (group + 1 + window_nodes_ > target_group_) {
+        target_group_ = group + 1 + window_nodes_;
+        wake_up = true;
+      }
+    }
+    if (wake_up) wake_up_.notify_one();
+  }
+  if (next_profiler_ == nullptr) return 0;
+  return next_profiler_->BeginEvent(tag, event_type, event_metadata1,
+                                    event_metadata2);
+}
+
+void WeightPrefetcher::EndEvent(uint32_t event_handle) {
+  if (next_profiler_ != nullptr) next_profiler_->EndEvent(event_handle);
+}
+
+void WeightPrefetcher::EndEvent(uint32_t event_handle, int64_t event_metadata1,
+                                int64_t event_metadata2) {
+  if (next_profiler_ != nullptr) {
+    next_profiler_->EndEvent(event_handle, event_metadata1, event_metadata2);
+  }
+}
+
+void WeightPrefetcher::AddEvent(const char* tag, EventType event_type,
+                                uint64_t start, uint64_t end,
+                                int64_t event_metadata1,
+                                int64_t event_metadata2) {
+  if (next_profiler_ != nullptr) {
+    next_profiler_->AddEvent(tag, event_type, start, end, event_metadata1,
+                             event_metadata2);
+  }
+}
+
+}  // namespace tflite
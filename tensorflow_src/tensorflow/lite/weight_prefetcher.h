@@ -0,0 +1,157 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_WEIGHT_PREFETCHER_H_
+#define TENSORFLOW_LITE_WEIGHT_PREFETCHER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <mutex>               // NOLINT(build/c++11)
+#include <thread>              // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/allocation.h"
+#include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace tflite {
+
+struct WeightPrefetchStats {
+  // Bytes of the pages holding the weights.
+  size_t weight_bytes = 0;
+  // Bytes faulted in or advised by Prefault().
+  size_t prefaulted_bytes = 0;
+  // Bytes faulted in or advised by the read-ahead thread.
+  size_t read_ahead_bytes = 0;
+  // Nodes that started before the read-ahead thread had fetched their
+  // weights, i.e. that may have waited on page faults.
+  int late_nodes = 0;
+  // Bytes locked in memory by Lock().
+  size_t locked_bytes = 0;
+};
+
+// Brings the weights of a memory-mapped model into memory ahead of their use,
+// in the order the nodes of the interpreter execute, so that the first
+// Invoke() does not wait on page faults across all weights, e.g. with the model
+// on slow flash storage:
+//
+//   auto model = FlatBufferModel::BuildFromFile(path);
+//   ... build `interpreter`, apply delegates, AllocateTensors() ...
+//   WeightPrefetcher prefetcher(interpreter.get(), model->allocation());
+//   prefetcher.Lock(/*max_bytes=*/1 << 20);
+//   prefetcher.StartReadAhead(/*window_nodes=*/4);
+//   interpreter->SetProfiler(&prefetcher);
+//   interpreter->Invoke();
+//
+// The weights are the read-only tensors of the nodes of the primary subgraph,
+// grouped by the first node using them; those only used by other subgraphs,
+// e.g. the bodies of control flow ops, come last. Construct the prefetcher
+// once the execution plan is final, i.e. after the delegates are applied.
+class WeightPrefetcher : public Profiler {
+ public:
+  enum class Mode {
+    // Reads one byte per page, faulting the pages in and mapping them into
+    // the process, so that the nodes do not take page faults at all.
+    kTouch,
+    // Only starts reading the pages into the page cache, with
+    // madvise(MADV_WILLNEED), without waiting for the reads. The nodes still
+    // take minor page faults.
+    kAdvise,
+  };
+
+  // `interpreter` and `allocation` must outlive the prefetcher.
+  WeightPrefetcher(Interpreter* interpreter, const Allocation* allocation);
+  // Stops the read-ahead and unlocks the weights.
+  ~WeightPrefetcher() override;
+
+  WeightPrefetcher(const WeightPrefetcher&) = delete;
+  WeightPrefetcher& operator=(const WeightPrefetcher&) = delete;
+
+  // Brings all weights into memory in execution order, on the calling thread.
+  // Returns the number of bytes prefaulted.
+  size_t Prefault(Mode mode = Mode::kTouch);
+
+  // Locks the weights of the first nodes in execution order in memory with
+  // mlock, up to `max_bytes`, so that they are never paged out. Stops at the
+  // first group of weights that does not fit or that the system refuses to
+  // lock, e.g. over RLIMIT_MEMLOCK. Returns the number of bytes locked.
+  size_t Lock(size_t max_bytes);
+
+  // Starts a helper thread fetching the weights of the next `window_nodes`
+  // nodes ahead of the one executing, and of the first ones right away. The
+  // prefetcher follows the execution through the operator events of the
+  // interpreter, so it must be installed as its profiler for as long as the
+  // read-ahead runs; other events are forwarded to `next_profiler`, if any.
+  // The thread ends once every weight has been fetched.
+  void StartReadAhead(int window_nodes, Mode mode = Mode::kTouch,
+                      Profiler* next_profiler = nullptr);
+  void StopReadAhead();
+
+  WeightPrefetchStats stats() const;
+
+  // Profiler implementation.
+  uint32_t BeginEvent(const char* tag, EventType event_type,
+                      int64_t event_metadata1,
+                      int64_t event_metadata2) override;
+  void EndEvent(uint32_t event_handle) override;
+  void EndEvent(uint32_t event_handle, int64_t event_metadata1,
+                int64_t event_metadata2) override;
+  void AddEvent(const char* tag, EventType event_type, uint64_t start,
+                uint64_t end, int64_t event_metadata1,
+                int64_t event_metadata2) override;
+
+ private:
+  // Page-aligned byte range of weights.
+  struct Range {
+    const char* begin;
+    size_t size;
+  };
+  // The weights first used by a node.
+  using Group = std::vector<Range>;
+
+  // Brings the ranges of `group` into memory, returns their size.
+  static size_t Fetch(const Group& group, Mode mode);
+  void ReadAhead();
+
+  Interpreter* const interpreter_;
+  // Groups in execution order, the last one holding the weights of the other
+  // subgraphs.
+  std::vector<Group> groups_;
+  // Index in `groups_` of each node of the primary subgraph, -1 for nodes
+  // not in the execution plan.
+  std::vector<int> node_groups_;
+  std::vector<Range> locked_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_up_;
+  std::thread read_ahead_thread_;
+  Profiler* next_profiler_ = nullptr;
+  Mode read_ahead_mode_ = Mode::kTouch;
+  int window_nodes_ = 0;
+  // Next group the read-ahead thread fetches, and the end of the groups it
+  // should have fetched by now.
+  int next_group_ = 0;
+  int target_group_ = 0;
+  std::vector<bool> fetched_;
+  bool stop_ = false;
+  // Whether the read-ahead thread is fetching or waiting for nodes to run.
+  bool running_ = false;
+  WeightPrefetchStats stats_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_WEIGHT_PREFETCHER_H_
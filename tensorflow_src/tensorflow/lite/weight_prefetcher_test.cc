@@ -0,0 +1,148 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/weight_prefetcher.h"
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+// Counts the events forwarded to it.
+class CountingProfiler : public Profiler {
+ public:
+  uint32_t BeginEvent(const char* tag, EventType event_type,
+                      int64_t event_metadata1,
+                      int64_t event_metadata2) override {
+    if (event_type == EventType::OPERATOR_INVOKE_EVENT) ++operator_events;
+    ++begin_events;
+    return 1;
+  }
+  void EndEvent(uint32_t event_handle) override { ++end_events; }
+
+  int operator_events = 0;
+  int begin_events = 0;
+  int end_events = 0;
+};
+
+class WeightPrefetcherTest : public ::testing::Test {
+ protected:
+  void Build(const char* filename, const MMapOptions& options = {}) {
+    model_ = FlatBufferModel::BuildFromFile(filename, options);
+    ASSERT_TRUE(model_);
+    ASSERT_EQ(InterpreterBuilder(*model_, ops::builtin::BuiltinOpResolver())(
+                  &interpreter_, /*num_threads=*/1),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  }
+
+  std::unique_ptr<FlatBufferModel> model_;
+  std::unique_ptr<Interpreter> interpreter_;
+};
+
+constexpr char kLstmModel[] = "tensorflow/lite/testdata/lstm.bin";
+
+TEST_F(WeightPrefetcherTest, PrefaultsAllWeights) {
+  Build(kLstmModel);
+  WeightPrefetcher prefetcher(interpreter_.get(), model_->allocation());
+  const size_t weight_bytes = prefetcher.stats().weight_bytes;
+  EXPECT_GT(weight_bytes, 0);
+  EXPECT_LE(weight_bytes, model_->allocation()->bytes() + 4096);
+
+  EXPECT_EQ(prefetcher.Prefault(WeightPrefetcher::Mode::kTouch), weight_bytes);
+  EXPECT_EQ(prefetcher.Prefault(WeightPrefetcher::Mode::kAdvise),
+            weight_bytes);
+  EXPECT_EQ(prefetcher.stats().prefaulted_bytes, 2 * weight_bytes);
+}
+
+TEST_F(WeightPrefetcherTest, LocksWithinBudget) {
+  Build(kLstmModel);
+  WeightPrefetcher prefetcher(interpreter_.get(), model_->allocation());
+  EXPECT_EQ(prefetcher.Lock(/*max_bytes=*/0), 0);
+  const size_t locked = prefetcher.Lock(prefetcher.stats().weight_bytes);
+  // Locking may be refused under a low RLIMIT_MEMLOCK.
+  EXPECT_LE(locked, prefetcher.stats().weight_bytes);
+  EXPECT_EQ(prefetcher.stats().locked_bytes, locked);
+}
+
+TEST_F(WeightPrefetcherTest, ReadsAheadDuringInvoke) {
+  Build(kLstmModel);
+  WeightPrefetcher prefetcher(interpreter_.get(), model_->allocation());
+  CountingProfiler profiler;
+  prefetcher.StartReadAhead(/*window_nodes=*/1,
+                            WeightPrefetcher::Mode::kTouch, &profiler);
+  // The weights of the first node are fetched right away; let the thread
+  // get there before the node runs.
+  for (int i = 0; i < 1000 && prefetcher.stats().read_ahead_bytes == 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  interpreter_->SetProfiler(&prefetcher);
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  interpreter_->SetProfiler(nullptr);
+
+  // Events are forwarded to the next profiler.
+  EXPECT_EQ(profiler.operator_events,
+            static_cast<int>(interpreter_->execution_plan().size()));
+  EXPECT_EQ(profiler.end_events, profiler.begin_events);
+
+  // The thread ends on its own once all weights are fetched, whether ahead of
+  // the nodes or not.
+  prefetcher.StopReadAhead();
+  const WeightPrefetchStats stats = prefetcher.stats();
+  EXPECT_GT(stats.read_ahead_bytes, 0);
+  EXPECT_LE(stats.read_ahead_bytes, stats.weight_bytes);
+  EXPECT_LE(stats.late_nodes,
+            static_cast<int>(interpreter_->execution_plan().size()));
+}
+
+TEST_F(WeightPrefetcherTest, ModelWithoutWeights) {
+  Build("tensorflow/lite/testdata/multi_add.bin");
+  WeightPrefetcher prefetcher(interpreter_.get(), model_->allocation());
+  EXPECT_EQ(prefetcher.stats().weight_bytes, 0);
+  EXPECT_EQ(prefetcher.Prefault(), 0);
+  prefetcher.StartReadAhead(/*window_nodes=*/2);
+  interpreter_->SetProfiler(&prefetcher);
+  EXPECT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  interpreter_->SetProfiler(nullptr);
+  prefetcher.StopReadAhead();
+  EXPECT_EQ(prefetcher.stats().read_ahead_bytes, 0);
+}
+
+TEST_F(WeightPrefetcherTest, PopulatedMapping) {
+  MMapOptions options;
+  options.populate = true;
+  Build(kLstmModel, options);
+  ASSERT_TRUE(model_->allocation()->valid());
+  WeightPrefetcher prefetcher(interpreter_.get(), model_->allocation());
+  EXPECT_GT(prefetcher.stats().weight_bytes, 0);
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}